@@ -30,10 +30,13 @@ import androidx.appcompat.widget.Toolbar;
 import androidx.core.app.ActivityCompat;
 
 import java.io.IOException;
+import java.util.Arrays;
 import java.util.Set;
 import java.util.UUID;
+import java.util.concurrent.CompletableFuture;
 import java.util.concurrent.ExecutorService;
 import java.util.concurrent.Executors;
+import java.util.concurrent.atomic.AtomicReference;
 
 public class MainActivity extends AppCompatActivity {
 
@@ -44,7 +47,25 @@ public class MainActivity extends AppCompatActivity {
     private static final UUID MY_UUID = UUID.fromString("00001101-0000-1000-8000-00805F9B34FB");
     private static final String PREFS_NAME = "MySecurePrefs";
     private static final long RECONNECT_DELAY_MS = 5000;
+    // The keypad holds a session for a minute after the drop, retried sooner meanwhile
+    private static final long RESUME_RECONNECT_DELAY_MS = 1000;
     private static final int STATE_CHECK_INTERVAL_MS = 3000;
+    private static final long RESPONSE_TIMEOUT_MS = 3000;
+    // Link benchmark run from the menu; the keypad gives up 5 s after the last echo
+    private static final int BENCH_COUNT = 200;
+    private static final int BENCH_SIZE = 32;
+    private static final long BENCH_TIMEOUT_MS = 60000;
+    // Binary command frames: [BINARY_FLAG | opcode][payload length][payload]
+    // The opcodes are the indices of btCommands in the firmware (src/Globals.cpp)
+    private static final int BINARY_FLAG = 0x80;
+    private static final int OPCODE_LOCK = 7;
+    private static final int OPCODE_UNLOCK = 8;
+    private static final int OPCODE_LOCK_MAC = 13;
+    private static final int OPCODE_UNLOCK_MAC = 14;
+    // Challenge nonce length and the action bytes of KeyboardController::ChallengeAction
+    private static final int CHALLENGE_NONCE_LENGTH = 8;
+    private static final byte CHALLENGE_LOCK = 'L';
+    private static final byte CHALLENGE_UNLOCK = 'U';
 
     // Region: UI Components (views and controls)
     private View connectingMessage;
@@ -66,8 +87,14 @@ public class MainActivity extends AppCompatActivity {
 
     // Region: Security (CRC interface and protocol state)
     private CRCPackageInterface crcInterface;
+    private final TelemetryDecoder telemetryDecoder = new TelemetryDecoder();
     private String stateResponse;
-    private final Object threadLock = new Object();
+    // Set once the keypad reports its state changes, which ends the state polling
+    private volatile boolean stateEvents;
+    // Whether the keypad's help lists the challenge command, null until a help reply came in full
+    private volatile Boolean challengeSupported;
+    // Response of the command in flight, fed by the CRC interface as packets arrive
+    private final AtomicReference<ResponseMatcher> pendingResponse = new AtomicReference<>();
 
     // Region: Broadcast Receiver (handles Bluetooth events)
     private final BroadcastReceiver bluetoothReceiver = new BroadcastReceiver() {
@@ -107,6 +134,10 @@ public class MainActivity extends AppCompatActivity {
             }
             return true;
         }
+        if (id == R.id.action_bench) {
+            runBenchmark();
+            return true;
+        }
         return super.onOptionsItemSelected(item);
     }
 
@@ -292,17 +323,44 @@ public class MainActivity extends AppCompatActivity {
                 socket.connect();
                 // Save the socket for later cleanup
                 bluetoothSocket = socket;
-                initializeCrcInterface(socket);
-                handleSuccessfulConnection(device);
+                if (resumeCrcInterface(socket)) {
+                    handleResumedConnection(device);
+                } else {
+                    handleSuccessfulConnection(device);
+                }
             } catch (IOException e) {
                 handleConnectionFailure(e);
             }
         }
     }
 
+    /**
+     * Continues the link's session over a new socket, one round trip instead
+     * of a RESET and the handshake.
+     *
+     * @return true if the keypad resumed it; otherwise the link is reset and
+     * needs the handshake
+     */
+    private boolean resumeCrcInterface(BluetoothSocket socket) throws IOException {
+        if (crcInterface == null || !crcInterface.hasSession()) {
+            initializeCrcInterface(socket);
+            return false;
+        }
+        return crcInterface.resume(socket.getInputStream(), socket.getOutputStream()).join();
+    }
+
     private void initializeCrcInterface(BluetoothSocket socket) throws IOException {
+        if (crcInterface != null) {
+            crcInterface.stop();
+        }
         crcInterface = new CRCPackageInterface(socket.getInputStream(), socket.getOutputStream());
         crcInterface.setErrorCallback(error -> Log.e(TAG, "CRC Error: " + error));
+        crcInterface.setDataListener(CRCPackageInterface.CHANNEL_COMMAND, this::onCommandData);
+        stateEvents = false;
+        challengeSupported = null;
+        telemetryDecoder.setEventListener(this::onStateEvent);
+        crcInterface.setDataListener(CRCPackageInterface.CHANNEL_TELEMETRY, this::onTelemetryData);
+        crcInterface.setDataListener(CRCPackageInterface.CHANNEL_BENCH, this::onBenchData);
         crcInterface.start();
         crcInterface.sendResetPacket();
     }
@@ -336,6 +394,18 @@ public class MainActivity extends AppCompatActivity {
         });
     }
 
+    @RequiresPermission(allOf = {Manifest.permission.BLUETOOTH_SCAN, Manifest.permission.BLUETOOTH_CONNECT})
+    private void handleResumedConnection(BluetoothDevice device) {
+        // stateResponse may be from before the drop; the keypad's connect
+        // event, or else the next poll, brings the state
+        mainHandler.post(() -> {
+            isConnected = true;
+            showToast("Reconnected to " + device.getName(), Toast.LENGTH_SHORT);
+            updateBluetoothMenu();
+            connectingMessage.setVisibility(View.GONE);
+        });
+    }
+
     @RequiresPermission(allOf = {Manifest.permission.BLUETOOTH_SCAN, Manifest.permission.BLUETOOTH_CONNECT})
     private void handleConnectionFailure(IOException e) {
         Log.e(TAG, "Connection failed", e);
@@ -435,10 +505,20 @@ public class MainActivity extends AppCompatActivity {
                 showToast("Disconnected", Toast.LENGTH_SHORT);
                 showConnectingState();
             });
+            // Keeps the session for the reconnect
+            executor.execute(this::suspendLink);
             attemptReconnect();
         }
     }
 
+    private void suspendLink() {
+        // Unblocks the reader
+        closeSocket();
+        if (crcInterface != null) {
+            crcInterface.suspend();
+        }
+    }
+
     @RequiresPermission(allOf = {Manifest.permission.BLUETOOTH_SCAN, Manifest.permission.BLUETOOTH_CONNECT})
     private void handleAdapterStateChange(Intent intent) {
         int state = intent.getIntExtra(BluetoothAdapter.EXTRA_STATE, BluetoothAdapter.ERROR);
@@ -458,10 +538,10 @@ public class MainActivity extends AppCompatActivity {
     private boolean performCrcHandshake() {
         if (crcInterface == null) return false;
 
-        String response = sendCommand("ping\r\n");
+        String response = sendCommand("ping\r\n").join();
         if (isInvalidResponse(response, "pong")) return false;
 
-        String versionResponse = sendCommand("version\r\n");
+        String versionResponse = sendCommand("version\r\n").join();
         if (versionResponse != null && versionResponse.contains("OK")) {
             runOnUiThread(() -> {
                 versionTextView.setText(String.format(
@@ -470,7 +550,9 @@ public class MainActivity extends AppCompatActivity {
             });
         }
 
-        response = sendCommand("state\r\n");
+        queryChallengeSupport();
+
+        response = sendCommand("state\r\n").join();
         if (response == null || (!response.contains("1") && !response.contains("0"))) return false;
         stateResponse = response;
 
@@ -479,15 +561,15 @@ public class MainActivity extends AppCompatActivity {
             return true;
         }
 
-        response = sendCommand("salt\r\n");
+        response = sendCommand("salt\r\n").join();
         if (response == null || !response.contains("OK")) return false;
         String salt = response.substring(0, 2);
 
-        response = sendCommand("seed\r\n");
+        response = sendCommand("seed\r\n").join();
         if (response == null || response.length() < 32) return false;
         byte[] seed = decryptSeed(response.substring(0, 32), salt);
 
-        response = sendCommand("check\r\n");
+        response = sendCommand("check\r\n").join();
         if (isInvalidResponse(response, "OK")) return false;
 
         saveSecurityParameters(salt, seed);
@@ -515,40 +597,72 @@ public class MainActivity extends AppCompatActivity {
     }
 
     // Region: Command Handling (sends and processes commands via CRC interface)
-    private String sendCommand(String command) {
-        if (crcInterface == null) return null;
-
+    private CompletableFuture<String> sendCommand(String command) {
         Log.d(TAG, "Command: " + command.trim());
+        return sendFrame(command.getBytes());
+    }
+
+    private CompletableFuture<String> sendBinaryCommand(int opcode, byte[] argument) {
+        byte[] frame = new byte[3 + argument.length];
+        frame[0] = (byte) (BINARY_FLAG | opcode);
+        frame[1] = (byte) (argument.length + 1);
+        frame[2] = (byte) argument.length;
+        System.arraycopy(argument, 0, frame, 3, argument.length);
+
+        Log.d(TAG, "Binary command: " + opcode);
+        return sendFrame(frame);
+    }
+
+    // Completes with the response once its terminator arrives, or with what arrived after RESPONSE_TIMEOUT_MS
+    private CompletableFuture<String> sendFrame(byte[] frame) {
+        return sendFrame(frame, RESPONSE_TIMEOUT_MS);
+    }
+
+    private CompletableFuture<String> sendFrame(byte[] frame, long timeout) {
+        if (crcInterface == null) return CompletableFuture.completedFuture(null);
+
+        ResponseMatcher matcher = new ResponseMatcher(timeout);
+        ResponseMatcher previous = pendingResponse.getAndSet(matcher);
+        if (previous != null) previous.finish();
+
         crcInterface.clearData();
-        crcInterface.sendData(command.getBytes(), command.length());
-        return readResponse(3000);
+        crcInterface.sendData(frame, frame.length);
+        return matcher.response().thenApply(response -> {
+            pendingResponse.compareAndSet(matcher, null);
+            Log.d(TAG, "Response: " + response.trim());
+            return response;
+        });
     }
 
-    /** @noinspection SameParameterValue*/
-    private String readResponse(long timeout) {
-        StringBuilder response = new StringBuilder();
-        long startTime = System.currentTimeMillis();
+    private void onCommandData(byte[] data, int offset, int length) {
+        ResponseMatcher matcher = pendingResponse.get();
+        if (matcher != null) matcher.feed(data, offset, length);
+    }
 
-        while (System.currentTimeMillis() - startTime < timeout) {
-            byte[] data = crcInterface.readData();
-            if (data != null) response.append(new String(data));
-            if (response.toString().contains("OK\r\n")
-                    || (response.toString().contains("ERROR: ")
-                    && (response.toString().contains("\r\n")))) {
-                break;
-            }
+    // Region: Link Benchmark
+    // The keypad times the round trips, so the payloads go straight back from the protocol thread
+    private void onBenchData(byte[] data, int offset, int length) {
+        crcInterface.sendData(CRCPackageInterface.CHANNEL_BENCH, Arrays.copyOfRange(data, offset, offset + length), length);
+    }
 
-            synchronized (threadLock) {
-                try {
-                    threadLock.wait(10);
-                } catch (InterruptedException e) {
-                    Thread.currentThread().interrupt();
-                }
-            }
+    // The report arrives on the command channel once every payload is back; other commands queue behind it
+    private void runBenchmark() {
+        if (!isConnected) {
+            showToast("Not connected", Toast.LENGTH_SHORT);
+            return;
         }
 
-        Log.d(TAG, "Response: " + response.toString().trim());
-        return response.toString();
+        showToast("Benchmarking the link…", Toast.LENGTH_SHORT);
+        executor.execute(() -> {
+            String command = "bench " + BENCH_COUNT + " " + BENCH_SIZE + "\r\n";
+            Log.d(TAG, "Command: " + command.trim());
+            final String response = sendFrame(command.getBytes(), BENCH_TIMEOUT_MS).join();
+            mainHandler.post(() -> new AlertDialog.Builder(this)
+                    .setTitle(R.string.bench)
+                    .setMessage(response == null || response.isEmpty() ? "No response" : response.trim())
+                    .setPositiveButton("OK", null)
+                    .show());
+        });
     }
 
     private boolean isInvalidResponse(String response, String expected) {
@@ -607,7 +721,9 @@ public class MainActivity extends AppCompatActivity {
         executor.execute(() -> {
             final String securityResponse = executeSecurityCommand(command);
             mainHandler.post(() -> handleCommandResponse(command, securityResponse));
-            final String response = sendCommand("state\r\n");
+            // The event frame of the change updates the buttons
+            if (stateEvents) return;
+            final String response = sendCommand("state\r\n").join();
             mainHandler.post(() -> handleStateResponse(response));
         });
     }
@@ -623,9 +739,34 @@ public class MainActivity extends AppCompatActivity {
 
         byte[] salt = hexStringToByteArray(saltHex);
         byte[] seed = hexStringToByteArray(seedHex);
+        boolean lock = command.equals("lock");
+
+        // Nonce and tag, nothing an eavesdropper can replay
+        String challenge = sendCommand("challenge\r\n").join();
+        if (challenge != null && challenge.contains("OK") && challenge.length() >= 2 * CHALLENGE_NONCE_LENGTH) {
+            byte[] nonce = hexStringToByteArray(challenge.substring(0, 2 * CHALLENGE_NONCE_LENGTH));
+            byte[] message = new byte[CHALLENGE_NONCE_LENGTH + 1];
+            System.arraycopy(nonce, 0, message, 0, CHALLENGE_NONCE_LENGTH);
+            message[CHALLENGE_NONCE_LENGTH] = lock ? CHALLENGE_LOCK : CHALLENGE_UNLOCK;
+            return sendBinaryCommand(lock ? OPCODE_LOCK_MAC : OPCODE_UNLOCK_MAC, SipHash.mac(seed, message)).join();
+        }
+
+        // Only firmware whose help lacks the command gets the replayable seed; a lost or garbled
+        // challenge reply must not downgrade to it
+        if (!Boolean.FALSE.equals(queryChallengeSupport())) {
+            return "ERROR: No challenge, try again";
+        }
         byte[] encrypted = cypherEncryption(seed.clone(), seed, salt[0]);
+        return sendBinaryCommand(lock ? OPCODE_LOCK : OPCODE_UNLOCK, encrypted).join();
+    }
 
-        return sendCommand(command + " " + byteArrayToHexString(encrypted) + "\r\n");
+    // Reads the command list once per connection; null while no complete help reply came back
+    private Boolean queryChallengeSupport() {
+        if (challengeSupported != null) return challengeSupported;
+        String help = sendCommand("help\r\n").join();
+        if (help == null || !help.contains("OK")) return null;
+        challengeSupported = ("\n" + help).contains("\nchallenge");
+        return challengeSupported;
     }
 
     private void handleCommandResponse(String command, String response) {
@@ -637,13 +778,14 @@ public class MainActivity extends AppCompatActivity {
     }
 
     // Region: State Management
+    // Firmware without event frames is polled; the first event frame ends it
     private void startPeriodicStateCheck() {
         mainHandler.postDelayed(new Runnable() {
             @Override
             public void run() {
-                if (isConnected) {
+                if (isConnected && !stateEvents) {
                     executor.execute(() -> {
-                        String response = sendCommand("state\r\n");
+                        String response = sendCommand("state\r\n").join();
                         mainHandler.post(() -> handleStateResponse(response));
                     });
                 }
@@ -652,20 +794,39 @@ public class MainActivity extends AppCompatActivity {
         }, STATE_CHECK_INTERVAL_MS);
     }
 
+    private void onTelemetryData(byte[] data, int offset, int length) {
+        for (String frame : telemetryDecoder.feed(data, offset, length)) {
+            Log.d(TAG, "Telemetry: " + frame);
+        }
+    }
+
+    private void onStateEvent(int events, boolean unlocked, int sequence) {
+        stateEvents = true;
+        mainHandler.post(() -> showKeyboardState(unlocked));
+        if ((events & TelemetryDecoder.EVENT_FORMAT) != 0) {
+            showToast("Keypad formatting", Toast.LENGTH_LONG);
+        } else if ((events & TelemetryDecoder.EVENT_DISCONNECT_PENDING) != 0) {
+            showToast("Keypad resetting Bluetooth", Toast.LENGTH_LONG);
+        }
+    }
+
     private void handleStateResponse(String response) {
         if (response == null) return;
 
         if (response.contains("1\r\n")) {
-            lockButton.setVisibility(View.VISIBLE);
-            unlockButton.setVisibility(View.GONE);
+            showKeyboardState(true);
         } else if (response.contains("0\r\n")) {
-            lockButton.setVisibility(View.GONE);
-            unlockButton.setVisibility(View.VISIBLE);
+            showKeyboardState(false);
         } else {
             Log.e(TAG, "Invalid state response: " + response);
         }
     }
 
+    private void showKeyboardState(boolean unlocked) {
+        lockButton.setVisibility(unlocked ? View.VISIBLE : View.GONE);
+        unlockButton.setVisibility(unlocked ? View.GONE : View.VISIBLE);
+    }
+
     @RequiresPermission(allOf = {Manifest.permission.BLUETOOTH_SCAN, Manifest.permission.BLUETOOTH_CONNECT})
     private void attemptReconnect() {
         mainHandler.postDelayed(() -> {
@@ -674,7 +835,7 @@ public class MainActivity extends AppCompatActivity {
             } else {
                 startDiscovery();
             }
-        }, RECONNECT_DELAY_MS);
+        }, crcInterface != null && crcInterface.hasSession() ? RESUME_RECONNECT_DELAY_MS : RECONNECT_DELAY_MS);
     }
 
     // Region: Menu Handling
@@ -0,0 +1,104 @@
+/**
+ * Collects the response to one command from CHANNEL_COMMAND.
+ * <p>
+ * A response is complete once it holds "OK\r\n", or "ERROR: " and a line
+ * end, as the keypad's command parser ends them. The terminators are
+ * matched byte by byte as data arrives, so text split across packets is
+ * never rebuilt; the text is decoded once, when the future completes.
+ *
+ * @author Aykut ÖZDEMİR
+ */
+package com.goldenhorn.k810security;
+
+import java.io.ByteArrayOutputStream;
+import java.nio.charset.StandardCharsets;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.TimeUnit;
+
+public class ResponseMatcher {
+    private static final byte[] OK = "OK\r\n".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] ERROR = "ERROR: ".getBytes(StandardCharsets.US_ASCII);
+    private static final byte[] LINE_END = "\r\n".getBytes(StandardCharsets.US_ASCII);
+
+    private final ByteArrayOutputStream received = new ByteArrayOutputStream();
+    private final CompletableFuture<String> response = new CompletableFuture<>();
+    private final Terminator ok = new Terminator(OK);
+    private final Terminator error = new Terminator(ERROR);
+    private final Terminator lineEnd = new Terminator(LINE_END);
+    private boolean errorSeen;
+    private boolean lineEndSeen;
+
+    /**
+     * Starts collecting.
+     *
+     * @param timeout Time after which the response completes with what has arrived (milliseconds)
+     */
+    public ResponseMatcher(long timeout) {
+        CompletableFuture.delayedExecutor(timeout, TimeUnit.MILLISECONDS).execute(this::finish);
+    }
+
+    /**
+     * The response text, completed on its terminator, on timeout or by finish().
+     *
+     * @return Future of everything received for the command
+     */
+    public CompletableFuture<String> response() {
+        return response;
+    }
+
+    /**
+     * Adds received bytes; called on the protocol thread.
+     *
+     * @param data Buffer holding bytes received on CHANNEL_COMMAND
+     * @param offset First received byte in data
+     * @param length Received bytes
+     */
+    public synchronized void feed(byte[] data, int offset, int length) {
+        if (response.isDone()) return;
+        for (int i = offset; i < offset + length; i++) {
+            byte b = data[i];
+            received.write(b);
+            errorSeen |= error.feed(b);
+            lineEndSeen |= lineEnd.feed(b);
+            if (ok.feed(b) || (errorSeen && lineEndSeen)) {
+                finish();
+                return;
+            }
+        }
+    }
+
+    /**
+     * Completes the response with what has arrived so far, unless already complete.
+     */
+    public synchronized void finish() {
+        response.complete(received.toString(StandardCharsets.UTF_8));
+    }
+
+    /**
+     * Incremental match of a pattern without a border (no proper prefix is
+     * also a suffix), so a mismatch only needs to check the first byte again.
+     */
+    private static class Terminator {
+        private final byte[] pattern;
+        private int matched;
+
+        Terminator(byte[] pattern) {
+            this.pattern = pattern;
+        }
+
+        /**
+         * @param b Next received byte
+         * @return true if the pattern ends with this byte
+         */
+        boolean feed(byte b) {
+            if (b != pattern[matched]) {
+                matched = 0;
+            }
+            if (b == pattern[matched] && ++matched == pattern.length) {
+                matched = 0;
+                return true;
+            }
+            return false;
+        }
+    }
+}
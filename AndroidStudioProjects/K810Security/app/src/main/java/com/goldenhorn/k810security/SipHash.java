@@ -0,0 +1,87 @@
+/**
+ * SipHash-2-4 with a 64-bit tag, as lib/SipHash on the keypad.
+ * <p>
+ * Keyed with the 16-byte seed, it authenticates the lock/unlock challenge:
+ * the tag covers the keypad's nonce followed by the action byte, and is
+ * sent little-endian.
+ *
+ * @author Aykut ÖZDEMİR
+ */
+package com.goldenhorn.k810security;
+
+public final class SipHash {
+    public static final int KEY_LENGTH = 16;
+    public static final int TAG_LENGTH = 8;
+
+    private SipHash() {
+    }
+
+    /**
+     * Computes the tag of a message.
+     *
+     * @param key     KEY_LENGTH key bytes
+     * @param message message bytes, at most 255
+     * @return TAG_LENGTH tag bytes, the 64-bit result little-endian
+     */
+    public static byte[] mac(byte[] key, byte[] message) {
+        long k0 = readLong(key, 0, 8);
+        long k1 = readLong(key, 8, 8);
+        long[] v = {
+                k0 ^ 0x736f6d6570736575L,
+                k1 ^ 0x646f72616e646f6dL,
+                k0 ^ 0x6c7967656e657261L,
+                k1 ^ 0x7465646279746573L
+        };
+
+        int offset = 0;
+        for (; message.length - offset >= 8; offset += 8) {
+            compress(v, readLong(message, offset, 8));
+        }
+        // Last block: the remaining bytes, the length in the top byte
+        long last = readLong(message, offset, message.length - offset) | ((long) (message.length & 0xFF) << 56);
+        compress(v, last);
+
+        v[2] ^= 0xFF;
+        rounds(v, 4);
+
+        long result = v[0] ^ v[1] ^ v[2] ^ v[3];
+        byte[] tag = new byte[TAG_LENGTH];
+        for (int i = 0; i < TAG_LENGTH; i++) {
+            tag[i] = (byte) (result >>> (8 * i));
+        }
+        return tag;
+    }
+
+    private static void compress(long[] v, long m) {
+        v[3] ^= m;
+        rounds(v, 2);
+        v[0] ^= m;
+    }
+
+    private static void rounds(long[] v, int count) {
+        for (int i = 0; i < count; i++) {
+            v[0] += v[1];
+            v[1] = Long.rotateLeft(v[1], 13);
+            v[1] ^= v[0];
+            v[0] = Long.rotateLeft(v[0], 32);
+            v[2] += v[3];
+            v[3] = Long.rotateLeft(v[3], 16);
+            v[3] ^= v[2];
+            v[0] += v[3];
+            v[3] = Long.rotateLeft(v[3], 21);
+            v[3] ^= v[0];
+            v[2] += v[1];
+            v[1] = Long.rotateLeft(v[1], 17);
+            v[1] ^= v[2];
+            v[2] = Long.rotateLeft(v[2], 32);
+        }
+    }
+
+    private static long readLong(byte[] bytes, int offset, int length) {
+        long value = 0;
+        for (int i = length - 1; i >= 0; i--) {
+            value = (value << 8) | (bytes[offset + i] & 0xFFL);
+        }
+        return value;
+    }
+}
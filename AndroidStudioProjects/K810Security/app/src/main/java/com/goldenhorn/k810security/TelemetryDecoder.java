@@ -0,0 +1,200 @@
+/**
+ * Decoder for the binary telemetry frames sent on CHANNEL_TELEMETRY.
+ * <p>
+ * Frame layout (little-endian), must match TelemetryController on the keypad:
+ * - 0xC3 0x3C, version, type, payload length
+ * - payload
+ * - CRC-16-CCITT (initial 0xFFFF) over version..payload
+ * <p>
+ * Frames may arrive split across reads; bytes that do not form a valid
+ * frame are skipped. Event frames also go to the EventListener.
+ *
+ * @author Aykut ÖZDEMİR
+ */
+package com.goldenhorn.k810security;
+
+import java.io.ByteArrayOutputStream;
+import java.util.ArrayList;
+import java.util.List;
+
+public class TelemetryDecoder {
+    private static final int SYNC_0 = 0xC3;
+    private static final int SYNC_1 = 0x3C;
+    /** Layout version this decoder understands */
+    private static final int VERSION = 1;
+    private static final int HEADER_LENGTH = 5;
+    private static final int TYPE_SUMMARY = 0;
+    private static final int TYPE_HISTOGRAM = 1;
+    private static final int TYPE_EVENT = 2;
+
+    /** statistics[] order on the keypad */
+    private static final String[] STATISTIC_NAMES = {"Loop", "System", "Peripheral", "Communication", "Application"};
+    private static final String[] RESET_REASONS = {"Power-on", "External", "WDT", "Soft"};
+    /** Bits of TelemetryController::Event on the keypad */
+    public static final int EVENT_LOCK = 0x01;
+    public static final int EVENT_UNLOCK = 0x02;
+    public static final int EVENT_FORMAT = 0x04;
+    public static final int EVENT_DISCONNECT_PENDING = 0x08;
+    public static final int EVENT_CONNECT = 0x10;
+    private static final String[] EVENT_NAMES = {"lock", "unlock", "format", "disconnect-pending", "connect"};
+    private static final String[] LINK_FIELDS = {"packetsSent", "packetsReceived", "retries", "maxRetryDrops",
+            "nacksReceived", "rejectedCrc", "rejectedFrame", "rejectedType", "rejectedLength", "resyncs", "peakRtt"};
+
+    private byte[] buffer = new byte[0];
+    private EventListener eventListener;
+
+    /**
+     * Receives the event frames.
+     */
+    public interface EventListener {
+        /**
+         * @param events   EVENT_* bits since the previous event frame
+         * @param unlocked Keyboard state when the frame was sent
+         * @param sequence Frame number, one more per event frame (mod 256)
+         */
+        void onEvent(int events, boolean unlocked, int sequence);
+    }
+
+    /**
+     * Sets the listener of the event frames, called on the thread calling feed().
+     *
+     * @param listener Listener, null for none
+     */
+    public void setEventListener(EventListener listener) {
+        eventListener = listener;
+    }
+
+    /**
+     * Adds received bytes and decodes every complete frame.
+     *
+     * @param data Bytes read from the telemetry channel
+     * @return One readable line per decoded frame
+     */
+    public List<String> feed(byte[] data) {
+        return feed(data, 0, data.length);
+    }
+
+    /**
+     * Adds received bytes and decodes every complete frame.
+     *
+     * @param data   Buffer holding bytes received on the telemetry channel
+     * @param offset First received byte in data
+     * @param length Received bytes
+     * @return One readable line per decoded frame
+     */
+    public List<String> feed(byte[] data, int offset, int length) {
+        ByteArrayOutputStream joined = new ByteArrayOutputStream();
+        joined.write(buffer, 0, buffer.length);
+        joined.write(data, offset, length);
+        byte[] bytes = joined.toByteArray();
+
+        List<String> frames = new ArrayList<>();
+        int offset = 0;
+        while (bytes.length - offset >= HEADER_LENGTH) {
+            if (u8(bytes, offset) != SYNC_0 || u8(bytes, offset + 1) != SYNC_1) {
+                offset++;
+                continue;
+            }
+            int length = u8(bytes, offset + 4);
+            int end = offset + HEADER_LENGTH + length + 2;
+            if (end > bytes.length) break; // Wait for the rest of the frame
+
+            int crc = u16(bytes, offset + HEADER_LENGTH + length);
+            if (u8(bytes, offset + 2) != VERSION || crc != crc16(bytes, offset + 2, offset + HEADER_LENGTH + length)) {
+                offset++;
+                continue;
+            }
+
+            int type = u8(bytes, offset + 3);
+            int payload = offset + HEADER_LENGTH;
+            if (type == TYPE_SUMMARY) {
+                frames.add(decodeSummary(bytes, payload));
+            } else if (type == TYPE_HISTOGRAM) {
+                frames.add(decodeHistogram(bytes, payload));
+            } else if (type == TYPE_EVENT) {
+                frames.add(decodeEvent(bytes, payload));
+            }
+            offset = end;
+        }
+
+        buffer = new byte[bytes.length - offset];
+        System.arraycopy(bytes, offset, buffer, 0, buffer.length);
+        return frames;
+    }
+
+    private static String decodeSummary(byte[] bytes, int offset) {
+        long uptime = u16(bytes, offset) | ((long) u16(bytes, offset + 2) << 16);
+        int reset = u8(bytes, offset + 4);
+        StringBuilder line = new StringBuilder();
+        line.append('[').append(uptime).append("] reset:")
+                .append(reset < RESET_REASONS.length ? RESET_REASONS[reset] : String.valueOf(reset))
+                .append(" ram free:").append(u16(bytes, offset + 5))
+                .append(" min:").append(u16(bytes, offset + 7));
+
+        int count = u8(bytes, offset + 9);
+        offset += 10;
+        for (int i = 0; i < count; i++, offset += 10) {
+            line.append(' ').append(statisticName(i)).append(':')
+                    .append(u16(bytes, offset)).append('/')
+                    .append(u16(bytes, offset + 2)).append('/')
+                    .append(u16(bytes, offset + 4)).append(" self:")
+                    .append(u16(bytes, offset + 6)).append(" over:")
+                    .append(u16(bytes, offset + 8));
+        }
+        for (int i = 0; i < LINK_FIELDS.length; i++, offset += 2) {
+            line.append(' ').append(LINK_FIELDS[i]).append(':').append(u16(bytes, offset));
+        }
+        return line.toString();
+    }
+
+    private static String decodeHistogram(byte[] bytes, int offset) {
+        int index = u8(bytes, offset);
+        int firstBits = u8(bytes, offset + 1);
+        int count = u8(bytes, offset + 2);
+        StringBuilder line = new StringBuilder(statisticName(index)).append(" histogram");
+        offset += 3;
+        for (int i = 0; i < count; i++, offset += 2) {
+            // Bucket i holds intervals below 2^(firstBits + i) us
+            line.append(" <=").append((1L << (firstBits + i)) - 1).append(':').append(u16(bytes, offset));
+        }
+        return line.toString();
+    }
+
+    private String decodeEvent(byte[] bytes, int offset) {
+        int events = u8(bytes, offset);
+        boolean unlocked = u8(bytes, offset + 1) == 1; // KeyboardController::UNLOCKED
+        int sequence = u8(bytes, offset + 2);
+        StringBuilder line = new StringBuilder("event #").append(sequence);
+        for (int i = 0; i < EVENT_NAMES.length; i++) {
+            if ((events & (1 << i)) != 0) line.append(' ').append(EVENT_NAMES[i]);
+        }
+        line.append(unlocked ? " unlocked" : " locked");
+        if (eventListener != null) eventListener.onEvent(events, unlocked, sequence);
+        return line.toString();
+    }
+
+    private static String statisticName(int index) {
+        return index < STATISTIC_NAMES.length ? STATISTIC_NAMES[index] : "statistic " + index;
+    }
+
+    private static int u8(byte[] bytes, int offset) {
+        return bytes[offset] & 0xFF;
+    }
+
+    private static int u16(byte[] bytes, int offset) {
+        return u8(bytes, offset) | (u8(bytes, offset + 1) << 8);
+    }
+
+    /** CRC-16-CCITT, initial 0xFFFF, as the CRC link */
+    private static int crc16(byte[] bytes, int from, int to) {
+        int crc = 0xFFFF;
+        for (int i = from; i < to; i++) {
+            crc ^= u8(bytes, i) << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) != 0 ? (crc << 1) ^ 0x1021 : crc << 1;
+                crc &= 0xFFFF;
+            }
+        }
+        return crc;
+    }
+}
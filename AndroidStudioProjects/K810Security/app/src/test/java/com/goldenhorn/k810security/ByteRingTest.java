@@ -0,0 +1,112 @@
+package com.goldenhorn.k810security;
+
+import org.junit.Test;
+
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import static org.junit.Assert.*;
+
+/**
+ * Unit tests of the preallocated byte ring behind every stream of CRCPackageInterface
+ */
+public class ByteRingTest {
+    /**
+     * Bytes 0..length-1 plus a start value
+     *
+     * @param start  Value of the first byte
+     * @param length Bytes
+     * @return The pattern
+     */
+    private static byte[] pattern(int start, int length) {
+        byte[] data = new byte[length];
+        for (int i = 0; i < length; i++) {
+            data[i] = (byte) (start + i);
+        }
+        return data;
+    }
+
+    @Test
+    public void keepsOrderAcrossTheWrap() {
+        CRCPackageInterface.ByteRing ring = new CRCPackageInterface.ByteRing(8);
+        byte[] out = new byte[8];
+
+        assertEquals(6, ring.write(pattern(0, 6), 0, 6));
+        assertEquals(4, ring.read(out, 0, 4));
+        // Two bytes at the end, four wrapped to the front
+        assertEquals(6, ring.write(pattern(6, 6), 0, 6));
+        assertEquals(8, ring.available());
+        assertEquals(0, ring.free());
+
+        assertEquals(8, ring.read(out, 0, 8));
+        assertArrayEquals(pattern(4, 8), out);
+        assertEquals(0, ring.available());
+    }
+
+    @Test
+    public void writesOnlyWhatFits() {
+        CRCPackageInterface.ByteRing ring = new CRCPackageInterface.ByteRing(4);
+
+        assertEquals(4, ring.write(pattern(0, 6), 0, 6));
+        assertEquals(0, ring.write(pattern(0, 1), 0, 1));
+
+        byte[] out = new byte[6];
+        assertEquals(4, ring.read(out, 1, 6));
+        assertEquals(0, out[0]);
+        assertEquals(3, out[4]);
+        assertEquals(0, ring.read(out, 0, 6));
+    }
+
+    @Test
+    public void readWithoutBufferDiscards() {
+        CRCPackageInterface.ByteRing ring = new CRCPackageInterface.ByteRing(8);
+        ring.write(pattern(0, 5), 0, 5);
+
+        assertEquals(3, ring.read(null, 0, 3));
+        byte[] out = new byte[2];
+        assertEquals(2, ring.read(out, 0, 2));
+        assertArrayEquals(pattern(3, 2), out);
+    }
+
+    @Test
+    public void clearEmptiesTheRing() {
+        CRCPackageInterface.ByteRing ring = new CRCPackageInterface.ByteRing(8);
+        ring.write(pattern(0, 7), 0, 7);
+        ring.clear();
+
+        assertEquals(0, ring.available());
+        assertEquals(8, ring.free());
+        assertEquals(8, ring.write(pattern(0, 8), 0, 8));
+    }
+
+    @Test
+    public void awaitWriteWaitsForRoom() throws InterruptedException {
+        CRCPackageInterface.ByteRing ring = new CRCPackageInterface.ByteRing(4);
+        ring.write(pattern(0, 4), 0, 4);
+
+        AtomicInteger written = new AtomicInteger(-1);
+        CountDownLatch done = new CountDownLatch(1);
+        Thread writer = new Thread(() -> {
+            try {
+                written.set(ring.awaitWrite(pattern(4, 3), 0, 3));
+            } catch (InterruptedException e) {
+                // The test failed already
+            }
+            done.countDown();
+        }, "ByteRing-Writer");
+        writer.start();
+
+        // Full: the writer has to wait
+        assertFalse(done.await(100, TimeUnit.MILLISECONDS));
+        byte[] out = new byte[2];
+        assertEquals(2, ring.read(out, 0, 2));
+        assertTrue(done.await(1, TimeUnit.SECONDS));
+        assertEquals(2, written.get());
+
+        byte[] rest = new byte[4];
+        assertEquals(4, ring.read(rest, 0, 4));
+        assertArrayEquals(new byte[]{2, 3, 4, 5}, rest);
+        writer.join();
+    }
+}
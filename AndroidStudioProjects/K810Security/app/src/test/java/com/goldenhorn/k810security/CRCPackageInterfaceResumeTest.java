@@ -0,0 +1,168 @@
+package com.goldenhorn.k810security;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.IOException;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.TimeoutException;
+
+import static com.goldenhorn.k810security.CRCPackageInterfaceTest.TIMEOUT_MS;
+import static com.goldenhorn.k810security.CRCPackageInterfaceTest.waitFor;
+import static org.junit.Assert.*;
+
+/**
+ * Unit tests of suspend() and resume() against a keypad that keeps its session
+ * <p>
+ * Each test drops the connection the way MainActivity sees an ACL
+ * disconnect: the old connection closes, the interface is suspended and
+ * later resumed over a new one.
+ */
+public class CRCPackageInterfaceResumeTest {
+    /** Longer than OUTGOING_DATA_ACK_NACK_TIMEOUT, a packet left unacknowledged is resent within it */
+    private static final long RETRANSMIT_WAIT_MS = 700;
+
+    private FakeKeypad keypad;
+    private FakeKeypad.Connection connection;
+    private CRCPackageInterface phone;
+
+    @Before
+    public void setUp() throws IOException {
+        keypad = new FakeKeypad();
+        connection = keypad.connect();
+        phone = new CRCPackageInterface(connection.phoneInput, connection.phoneOutput);
+    }
+
+    @After
+    public void tearDown() {
+        phone.stop();
+        connection.close();
+    }
+
+    /**
+     * Starts the session and delivers a first payload
+     *
+     * @param text Payload
+     * @throws IOException          on communication error
+     * @throws InterruptedException if interrupted while waiting
+     */
+    private void connect(String text) throws IOException, InterruptedException {
+        phone.start();
+        phone.sendResetPacket();
+        send(text);
+        waitFor("the first payload", () -> keypad.received().length == text.length());
+    }
+
+    /**
+     * Queues a payload on CHANNEL_COMMAND
+     *
+     * @param text Payload
+     */
+    private void send(String text) {
+        byte[] data = text.getBytes();
+        phone.sendData(data, data.length);
+    }
+
+    /**
+     * Drops the connection and suspends the interface, as an ACL disconnect does
+     */
+    private void drop() {
+        connection.close();
+        phone.suspend();
+    }
+
+    /**
+     * Resumes over a new connection
+     *
+     * @return Whether the keypad resumed the session
+     * @throws IOException          on communication error
+     * @throws InterruptedException if interrupted while waiting
+     * @throws ExecutionException   if the resume failed
+     * @throws TimeoutException     if the keypad did not answer within TIMEOUT_MS
+     */
+    private boolean reconnect() throws IOException, InterruptedException, ExecutionException, TimeoutException {
+        connection = keypad.connect();
+        CompletableFuture<Boolean> resumed = phone.resume(connection.phoneInput, connection.phoneOutput);
+        return resumed.get(TIMEOUT_MS, TimeUnit.MILLISECONDS);
+    }
+
+    @Test
+    public void resumeReleasesWhatTheKeypadDelivered() throws Exception {
+        phone.start();
+        phone.sendResetPacket();
+        // Delivered, but every ACK is lost: the packet stays in the window
+        keypad.setAcknowledging(false);
+        send("abc");
+        waitFor("the payload", () -> keypad.received().length == 3);
+
+        drop();
+        assertFalse(phone.isRunning());
+        assertTrue(phone.hasSession());
+        int duplicates = keypad.duplicates();
+        // Queued while the link is down
+        send("def");
+        keypad.setAcknowledging(true);
+
+        assertTrue(reconnect());
+        assertEquals(1, keypad.resumes());
+        waitFor("the queued payload", () -> keypad.received().length == 6);
+        Thread.sleep(RETRANSMIT_WAIT_MS);
+        assertArrayEquals("abcdef".getBytes(), keypad.received());
+        // The released packet was not sent again
+        assertEquals(duplicates, keypad.duplicates());
+        assertEquals(0, keypad.badFrames());
+    }
+
+    @Test
+    public void resumeResendsWhatTheKeypadMissed() throws Exception {
+        connect("abc");
+        // Lost on the air before the drop
+        keypad.setReceiving(false);
+        send("def");
+        waitFor("the payload to be packed", () -> phone.getLaneDepth(CRCPackageInterface.LANE_CONTROL) == 0);
+
+        drop();
+        keypad.setReceiving(true);
+
+        assertTrue(reconnect());
+        waitFor("the resent payload", () -> keypad.received().length == 6);
+        assertArrayEquals("abcdef".getBytes(), keypad.received());
+    }
+
+    @Test
+    public void resumeAfterKeypadRestartStartsNewSession() throws Exception {
+        connect("abc");
+        drop();
+        keypad.restart();
+
+        assertFalse(reconnect());
+        assertEquals(0, keypad.resumes());
+        assertTrue(phone.hasSession());
+        // Numbering starts over with the keypad's
+        send("xyz");
+        waitFor("the payload of the new session", () -> keypad.received().length == 6);
+        assertArrayEquals("abcxyz".getBytes(), keypad.received());
+    }
+
+    @Test
+    public void resumeWithoutSessionSendsReset() throws Exception {
+        // Never connected: resume() is start() and sendResetPacket(), on new streams
+        assertFalse(phone.hasSession());
+        connection.close();
+        assertFalse(reconnect());
+        assertTrue(phone.isRunning());
+
+        send("abc");
+        waitFor("the payload", () -> keypad.received().length == 3);
+        assertEquals(0, keypad.resumes());
+    }
+
+    @Test(expected = IllegalStateException.class)
+    public void resumeWhileRunningIsRefused() throws Exception {
+        connect("abc");
+        phone.resume(connection.phoneInput, connection.phoneOutput);
+    }
+}
@@ -0,0 +1,222 @@
+package com.goldenhorn.k810security;
+
+import org.junit.After;
+import org.junit.Before;
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.PipedInputStream;
+import java.io.PipedOutputStream;
+import java.util.Queue;
+import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicReference;
+import java.util.function.BooleanSupplier;
+
+import static org.junit.Assert.*;
+
+/**
+ * Unit tests of CRCPackageInterface with its reader and protocol threads
+ * <p>
+ * Two interfaces talk to each other over piped streams: the phone sends
+ * the RESET, the peer answers it, as the keypad does.
+ */
+public class CRCPackageInterfaceTest {
+    /** Longest wait for anything to arrive (milliseconds) */
+    static final long TIMEOUT_MS = 5000;
+    /** Bytes a pipe buffers */
+    private static final int PIPE_SIZE = 4096;
+
+    /**
+     * One direction of a link: what one end writes the other reads
+     */
+    private static final class Pipe {
+        final PipedInputStream input;
+        final PipedOutputStream output;
+
+        Pipe() throws IOException {
+            input = new PipedInputStream(PIPE_SIZE);
+            output = new PipedOutputStream(input);
+        }
+    }
+
+    private Pipe toPeer;
+    private Pipe toPhone;
+    private CRCPackageInterface phone;
+    private CRCPackageInterface peer;
+    /** Errors both ends reported */
+    private final Queue<String> errors = new ConcurrentLinkedQueue<>();
+
+    @Before
+    public void setUp() throws IOException {
+        toPeer = new Pipe();
+        toPhone = new Pipe();
+        phone = new CRCPackageInterface(toPhone.input, toPeer.output);
+        peer = new CRCPackageInterface(toPeer.input, toPhone.output);
+        phone.setErrorCallback(errors::add);
+        peer.setErrorCallback(errors::add);
+        peer.start();
+        phone.start();
+        phone.sendResetPacket();
+    }
+
+    @After
+    public void tearDown() {
+        phone.stop();
+        peer.stop();
+    }
+
+    /**
+     * Waits until a condition holds, fails after TIMEOUT_MS
+     *
+     * @param what      Condition, for the failure message
+     * @param condition Condition
+     * @throws InterruptedException if interrupted while waiting
+     */
+    static void waitFor(String what, BooleanSupplier condition) throws InterruptedException {
+        long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(TIMEOUT_MS);
+        while (!condition.getAsBoolean()) {
+            if (System.nanoTime() > deadline) fail("Timed out waiting for " + what);
+            Thread.sleep(10);
+        }
+    }
+
+    /**
+     * Reads a number of bytes from a channel, fails after TIMEOUT_MS
+     *
+     * @param link    Receiving end
+     * @param channel Channel
+     * @param length  Bytes to read
+     * @return The bytes
+     * @throws InterruptedException if interrupted while waiting
+     */
+    static byte[] readExactly(CRCPackageInterface link, int channel, int length) throws InterruptedException {
+        byte[] data = new byte[length];
+        long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(TIMEOUT_MS);
+        int offset = 0;
+        while (offset < length) {
+            long remaining = TimeUnit.NANOSECONDS.toMillis(deadline - System.nanoTime());
+            if (remaining <= 0) fail("Timed out after " + offset + " of " + length + " bytes");
+            if (link.awaitData(channel, remaining)) {
+                offset += link.readData(channel, data, offset, length - offset);
+            }
+        }
+        return data;
+    }
+
+    /**
+     * Bytes of a counter
+     *
+     * @param seed   Value of the first byte
+     * @param length Bytes
+     * @return The pattern
+     */
+    static byte[] pattern(int seed, int length) {
+        byte[] data = new byte[length];
+        for (int i = 0; i < length; i++) {
+            data[i] = (byte) (seed + i * 7);
+        }
+        return data;
+    }
+
+    /**
+     * Checks for a live thread of a name
+     *
+     * @param name Thread name
+     * @return true if one is alive
+     */
+    private static boolean threadAlive(String name) {
+        for (Thread thread : Thread.getAllStackTraces().keySet()) {
+            if (thread.isAlive() && thread.getName().equals(name)) return true;
+        }
+        return false;
+    }
+
+    @Test
+    public void commandCrossesBothWays() throws InterruptedException {
+        byte[] request = "version".getBytes();
+        phone.sendData(request, request.length);
+        assertArrayEquals(request, readExactly(peer, CRCPackageInterface.CHANNEL_COMMAND, request.length));
+
+        byte[] reply = "OK 1.0".getBytes();
+        peer.sendData(reply, reply.length);
+        assertArrayEquals(reply, readExactly(phone, CRCPackageInterface.CHANNEL_COMMAND, reply.length));
+        assertNull(phone.readData());
+    }
+
+    @Test
+    public void largeTransfersArriveInOrderBothWaysAtOnce() throws InterruptedException {
+        // Many times the window and the payload, less than the outgoing and incoming buffers
+        byte[] up = pattern(1, 3000);
+        byte[] down = pattern(2, 3000);
+        phone.sendData(up, up.length);
+        peer.sendData(down, down.length);
+
+        assertArrayEquals(down, readExactly(phone, CRCPackageInterface.CHANNEL_COMMAND, down.length));
+        assertArrayEquals(up, readExactly(peer, CRCPackageInterface.CHANNEL_COMMAND, up.length));
+    }
+
+    @Test
+    public void listenerTakesItsChannelOnTheProtocolThread() throws InterruptedException {
+        ByteArrayOutputStream telemetry = new ByteArrayOutputStream();
+        AtomicReference<String> listenerThread = new AtomicReference<>();
+        peer.setDataListener(CRCPackageInterface.CHANNEL_TELEMETRY, (data, offset, length) -> {
+            synchronized (telemetry) {
+                telemetry.write(data, offset, length);
+            }
+            listenerThread.set(Thread.currentThread().getName());
+        });
+
+        byte[] event = pattern(3, 100);
+        byte[] command = "stats".getBytes();
+        phone.sendData(CRCPackageInterface.CHANNEL_TELEMETRY, event, event.length);
+        phone.sendData(command, command.length);
+
+        assertArrayEquals(command, readExactly(peer, CRCPackageInterface.CHANNEL_COMMAND, command.length));
+        waitFor("telemetry", () -> {
+            synchronized (telemetry) {
+                return telemetry.size() == event.length;
+            }
+        });
+        synchronized (telemetry) {
+            assertArrayEquals(event, telemetry.toByteArray());
+        }
+        assertEquals("CRC-Protocol-Thread", listenerThread.get());
+        // The listener took it instead of the ring
+        assertNull(peer.readData(CRCPackageInterface.CHANNEL_TELEMETRY));
+    }
+
+    @Test
+    public void laneDepthDrainsOnceSent() throws InterruptedException {
+        byte[] bulk = pattern(4, 1000);
+        phone.sendData(CRCPackageInterface.CHANNEL_BENCH, bulk, bulk.length);
+        assertArrayEquals(bulk, readExactly(peer, CRCPackageInterface.CHANNEL_BENCH, bulk.length));
+        waitFor("an empty bulk lane", () -> phone.getLaneDepth(CRCPackageInterface.LANE_BULK) == 0);
+        assertEquals(0, phone.getLaneDepth(CRCPackageInterface.LANE_CONTROL));
+    }
+
+    @Test
+    public void endOfStreamStopsTheReader() throws IOException, InterruptedException {
+        toPeer.output.close();
+        waitFor("the end of stream error", () -> errors.contains("CRC:ThreadEnd of stream"));
+        // The interface still runs; only its reader is gone
+        assertTrue(peer.isRunning());
+    }
+
+    @Test
+    public void stopEndsBothThreads() throws InterruptedException {
+        assertTrue(threadAlive("CRC-Reader-Thread"));
+        assertTrue(threadAlive("CRC-Protocol-Thread"));
+
+        phone.stop();
+        peer.stop();
+        assertFalse(phone.isRunning());
+        assertFalse(peer.hasSession());
+        waitFor("the reader threads to end", () -> !threadAlive("CRC-Reader-Thread"));
+        waitFor("the protocol threads to end", () -> !threadAlive("CRC-Protocol-Thread"));
+
+        // Stopped twice by tearDown(), which does nothing more
+        phone.stop();
+    }
+}
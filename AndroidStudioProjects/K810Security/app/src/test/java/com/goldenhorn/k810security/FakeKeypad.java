@@ -0,0 +1,307 @@
+package com.goldenhorn.k810security;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.PipedInputStream;
+import java.io.PipedOutputStream;
+
+/**
+ * Keypad end of the link for the resume tests
+ * <p>
+ * Speaks just enough of the firmware's side of the protocol: answers a
+ * RESET with a RESET-ACK offering stop-and-wait, 8-byte payloads and no
+ * features, keeps its session across connections like the firmware keeps
+ * it across an ACL drop, delivers DATA in sequence and acknowledges every
+ * packet, unless told to lose the DATA or the ACKs.
+ */
+final class FakeKeypad {
+    /** Start of packet marker */
+    private static final int START_BYTE = 0xAA;
+    /** End of packet marker */
+    private static final int STOP_BYTE = 0x55;
+    /** Header size */
+    private static final int HEADER_LENGTH = 4;
+    /** Payload size without negotiation, the only one this end offers */
+    private static final int PAYLOAD_LENGTH = 8;
+    /** Frame size: header, payload, CRC and stop byte */
+    private static final int FRAME_LENGTH = HEADER_LENGTH + PAYLOAD_LENGTH + 3;
+    /** Packet types */
+    private static final int DATA_TYPE = 0x00;
+    private static final int ACK_TYPE = 0x01;
+    private static final int RESET_TYPE = 0x03;
+    /** Payload length bits of the length byte */
+    private static final int LENGTH_MASK = 0x3F;
+    /** Session fields of RESET and RESET-ACK payloads */
+    private static final int SESSION_ID_INDEX = 3;
+    private static final int SESSION_FLAGS_INDEX = 5;
+    private static final int SESSION_DELIVERED_INDEX = 6;
+    private static final int SESSION_RESUME = 0x01;
+    /** Bytes a pipe buffers */
+    private static final int PIPE_SIZE = 4096;
+
+    /** Guards the session state */
+    private final Object lock = new Object();
+    /** Session in force, 0 = none */
+    private int session;
+    /** Last packet delivered in sequence */
+    private int delivered;
+    /** Payloads delivered, in order */
+    private final ByteArrayOutputStream received = new ByteArrayOutputStream();
+    /** RESETs that resumed the session */
+    private int resumes;
+    /** Frames dropped for a bad CRC, stop byte or type */
+    private int badFrames;
+    /** DATA received again after it was delivered */
+    private int duplicates;
+    /** Cleared to lose every DATA frame, as if the radio did */
+    private volatile boolean receiving = true;
+    /** Cleared to deliver DATA without acknowledging it, as if every ACK were lost */
+    private volatile boolean acknowledging = true;
+
+    /**
+     * One connection, served by its own thread until closed
+     */
+    final class Connection {
+        /** Phone's receive stream */
+        final InputStream phoneInput;
+        /** Phone's send stream */
+        final OutputStream phoneOutput;
+        /** Keypad's end of phoneOutput */
+        private final PipedInputStream fromPhone;
+        /** Keypad's end of phoneInput */
+        private final PipedOutputStream toPhone;
+        /** Reads frames and answers them */
+        private final Thread thread;
+
+        Connection() throws IOException {
+            fromPhone = new PipedInputStream(PIPE_SIZE);
+            phoneOutput = new PipedOutputStream(fromPhone);
+            PipedInputStream input = new PipedInputStream(PIPE_SIZE);
+            toPhone = new PipedOutputStream(input);
+            phoneInput = input;
+            thread = new Thread(this::serve, "FakeKeypad-Thread");
+            thread.setDaemon(true);
+            thread.start();
+        }
+
+        /**
+         * Drops the connection; bytes in flight are lost
+         */
+        void close() {
+            thread.interrupt();
+            try {
+                toPhone.close();
+                fromPhone.close();
+            } catch (IOException ignored) {
+                // Closed either way
+            }
+        }
+
+        private void serve() {
+            byte[] frame = new byte[FRAME_LENGTH];
+            try {
+                while (!Thread.currentThread().isInterrupted()) {
+                    int first = fromPhone.read();
+                    if (first < 0) return;
+                    if (first != START_BYTE) continue;
+                    frame[0] = (byte) first;
+                    for (int offset = 1; offset < FRAME_LENGTH; ) {
+                        int count = fromPhone.read(frame, offset, FRAME_LENGTH - offset);
+                        if (count < 0) return;
+                        offset += count;
+                    }
+                    byte[] reply = handle(frame);
+                    if (reply != null) {
+                        toPhone.write(reply);
+                        toPhone.flush();
+                    }
+                }
+            } catch (IOException e) {
+                // Dropped, by close() or by the phone
+            }
+        }
+    }
+
+    /**
+     * Opens a new connection to this keypad
+     *
+     * @return The connection, already served
+     * @throws IOException if the pipes cannot be connected
+     */
+    Connection connect() throws IOException {
+        return new Connection();
+    }
+
+    /**
+     * Sets whether DATA is acknowledged
+     *
+     * @param acknowledging false to deliver DATA and lose every ACK
+     */
+    void setAcknowledging(boolean acknowledging) {
+        this.acknowledging = acknowledging;
+    }
+
+    /**
+     * Sets whether DATA arrives
+     *
+     * @param receiving false to lose every DATA frame
+     */
+    void setReceiving(boolean receiving) {
+        this.receiving = receiving;
+    }
+
+    /**
+     * Forgets the session, as a keypad reset does
+     */
+    void restart() {
+        synchronized (lock) {
+            session = 0;
+            delivered = 0;
+        }
+    }
+
+    /**
+     * @return Payload bytes delivered so far, in order
+     */
+    byte[] received() {
+        synchronized (lock) {
+            return received.toByteArray();
+        }
+    }
+
+    /**
+     * @return RESETs that resumed the session
+     */
+    int resumes() {
+        synchronized (lock) {
+            return resumes;
+        }
+    }
+
+    /**
+     * @return DATA frames received again after their payload was delivered
+     */
+    int duplicates() {
+        synchronized (lock) {
+            return duplicates;
+        }
+    }
+
+    /**
+     * @return Frames dropped as malformed
+     */
+    int badFrames() {
+        synchronized (lock) {
+            return badFrames;
+        }
+    }
+
+    /**
+     * Handles one frame
+     *
+     * @param frame FRAME_LENGTH bytes from the start byte
+     * @return Frame to answer with, null for none
+     */
+    private byte[] handle(byte[] frame) {
+        int crc = ((frame[FRAME_LENGTH - 3] & 0xFF) << 8) | (frame[FRAME_LENGTH - 2] & 0xFF);
+        int type = frame[2] & 0xFF;
+        synchronized (lock) {
+            // This end offers no payload classes or cumulative ACKs, so no type flags either
+            if ((frame[FRAME_LENGTH - 1] & 0xFF) != STOP_BYTE || crc != crc16(frame, 1, FRAME_LENGTH - 4) ||
+                    type > RESET_TYPE) {
+                badFrames++;
+                return null;
+            }
+
+            if (type == RESET_TYPE) {
+                int requested = (frame[HEADER_LENGTH + SESSION_ID_INDEX] & 0xFF) |
+                        ((frame[HEADER_LENGTH + SESSION_ID_INDEX + 1] & 0xFF) << 8);
+                boolean resumed = (frame[HEADER_LENGTH + SESSION_FLAGS_INDEX] & SESSION_RESUME) != 0 &&
+                        session != 0 && requested == session;
+                if (resumed) {
+                    resumes++;
+                } else {
+                    session = requested;
+                    delivered = 0;
+                }
+                byte[] payload = new byte[PAYLOAD_LENGTH];
+                payload[0] = 1;
+                payload[1] = PAYLOAD_LENGTH;
+                payload[2] = 0;
+                payload[SESSION_ID_INDEX] = (byte) session;
+                payload[SESSION_ID_INDEX + 1] = (byte) (session >> 8);
+                payload[SESSION_FLAGS_INDEX] = (byte) (resumed ? SESSION_RESUME : 0);
+                payload[SESSION_DELIVERED_INDEX] = (byte) (resumed ? delivered : 0);
+                return frame(ACK_TYPE, 0, payload);
+            }
+
+            if (type == DATA_TYPE) {
+                if (!receiving) return null;
+                int packetNumber = frame[1] & 0xFF;
+                if (packetNumber == next(delivered)) {
+                    received.write(frame, HEADER_LENGTH, frame[3] & LENGTH_MASK);
+                    delivered = packetNumber;
+                } else {
+                    duplicates++;
+                }
+                // Duplicates are acknowledged again, their first ACK was lost
+                return acknowledging ? frame(ACK_TYPE, packetNumber, new byte[PAYLOAD_LENGTH]) : null;
+            }
+            return null;
+        }
+    }
+
+    /**
+     * Sequence number after another, 0 is reserved for RESET
+     *
+     * @param packetNumber 0-255
+     * @return 1-255
+     */
+    private static int next(int packetNumber) {
+        return (packetNumber == 255) ? 1 : packetNumber + 1;
+    }
+
+    /**
+     * Builds a control frame
+     *
+     * @param type         Packet type
+     * @param packetNumber Sequence number
+     * @param payload      PAYLOAD_LENGTH bytes
+     * @return The frame
+     */
+    private static byte[] frame(int type, int packetNumber, byte[] payload) {
+        byte[] frame = new byte[FRAME_LENGTH];
+        frame[0] = (byte) START_BYTE;
+        frame[1] = (byte) packetNumber;
+        frame[2] = (byte) type;
+        frame[3] = 0;
+        System.arraycopy(payload, 0, frame, HEADER_LENGTH, PAYLOAD_LENGTH);
+        int crc = crc16(frame, 1, FRAME_LENGTH - 4);
+        frame[FRAME_LENGTH - 3] = (byte) (crc >> 8);
+        frame[FRAME_LENGTH - 2] = (byte) crc;
+        frame[FRAME_LENGTH - 1] = (byte) STOP_BYTE;
+        return frame;
+    }
+
+    /**
+     * CRC-16-CCITT (0x1021, initial 0xFFFF), bit by bit so it does not share the interface's table
+     *
+     * @param data   Bytes
+     * @param offset First byte
+     * @param length Bytes covered
+     * @return CRC
+     */
+    private static int crc16(byte[] data, int offset, int length) {
+        int crc = 0xFFFF;
+        for (int i = offset; i < offset + length; i++) {
+            crc ^= (data[i] & 0xFF) << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = ((crc & 0x8000) != 0) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            }
+            crc &= 0xFFFF;
+        }
+        return crc;
+    }
+}
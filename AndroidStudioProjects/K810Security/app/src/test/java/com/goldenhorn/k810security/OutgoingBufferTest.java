@@ -0,0 +1,68 @@
+package com.goldenhorn.k810security;
+
+import org.junit.Test;
+
+import static org.junit.Assert.*;
+
+/**
+ * Unit tests of the per-lane queue sendData() fills
+ */
+public class OutgoingBufferTest {
+    /** OUTGOING_SEGMENT_SLOTS of CRCPackageInterface */
+    private static final int SEGMENT_SLOTS = 64;
+
+    @Test
+    public void pollStopsAtTheChannelChange() {
+        CRCPackageInterface.OutgoingBuffer lane = new CRCPackageInterface.OutgoingBuffer();
+        assertTrue(lane.offer(1, new byte[]{1, 2}, 2));
+        // Same channel: extends the segment
+        assertTrue(lane.offer(1, new byte[]{3}, 1));
+        assertTrue(lane.offer(2, new byte[]{4, 5}, 2));
+        assertEquals(5, lane.queued());
+
+        byte[] out = new byte[8];
+        assertEquals(1, lane.peekChannel());
+        assertEquals(3, lane.poll(out, out.length));
+        assertEquals(3, out[2]);
+        assertEquals(2, lane.peekChannel());
+        assertEquals(1, lane.poll(out, 1));
+        assertEquals(4, out[0]);
+        assertEquals(1, lane.poll(out, out.length));
+        assertEquals(5, out[0]);
+        assertEquals(-1, lane.peekChannel());
+        assertEquals(0, lane.poll(out, out.length));
+    }
+
+    @Test
+    public void offerIsAllOrNothing() {
+        CRCPackageInterface.OutgoingBuffer lane = new CRCPackageInterface.OutgoingBuffer();
+        byte[] block = new byte[1000];
+        int queued = 0;
+        while (lane.offer(1, block, block.length)) {
+            queued += block.length;
+        }
+        assertEquals(queued, lane.queued());
+        assertTrue(lane.offer(1, block, 1));
+
+        lane.clear();
+        assertEquals(0, lane.queued());
+        assertEquals(-1, lane.peekChannel());
+    }
+
+    @Test
+    public void segmentSlotsLimitChannelChanges() {
+        CRCPackageInterface.OutgoingBuffer lane = new CRCPackageInterface.OutgoingBuffer();
+        byte[] one = {7};
+        for (int i = 0; i < SEGMENT_SLOTS; i++) {
+            assertTrue(lane.offer(1 + (i & 1), one, 1));
+        }
+        // A new segment does not fit, more of the last channel still does
+        assertFalse(lane.offer(1, one, 1));
+        assertTrue(lane.offer(2, one, 1));
+
+        lane.dropSegment();
+        assertEquals(SEGMENT_SLOTS, lane.queued());
+        assertEquals(2, lane.peekChannel());
+        assertTrue(lane.offer(1, one, 1));
+    }
+}
@@ -20,10 +20,13 @@ def generate_disasm(source, target, env):
 def analyze_asm(source, target, env):
     import re
     import os
+    import json
 
     # Paths
     BUILD_DIR = env.subst("$BUILD_DIR")
     ASM_FILE = os.path.join(BUILD_DIR, "firmware.disasm")
+    # Written by "pio run -e sim -t simbench" (sim_benchmark.py), absent until it ran once
+    SIM_FILE = os.path.join(BUILD_DIR, "sim_cycles.json")
 
     # Standard AVR vector names lookup table
     VECTOR_NAMES = {
@@ -162,6 +165,15 @@ def analyze_asm(source, target, env):
                 "registers": used_registers  # Keep original order
             }
 
+    # Measured cycles per call, keyed by symbol in every scenario
+    sim_results = None
+    if os.path.exists(SIM_FILE):
+        try:
+            with open(SIM_FILE, "r") as f:
+                sim_results = json.load(f)
+        except (IOError, ValueError) as e:
+            print(f"Ignoring {SIM_FILE} ({e})")
+
     # Report ISR details
     for isr, details in isr_functions.items():
         # Extract vector number from ISR name (e.g., __vector_17 -> 17)
@@ -174,8 +186,74 @@ def analyze_asm(source, target, env):
         print(f"  Registers used: {', '.join(formatted_registers)}")
         if details.get("balance_issue"):
             print(f"  Balance issue: {details['push_count']} pushes, {details['pop_count']} pops")
+        if sim_results:
+            for scenario, measured in sim_results["scenarios"].items():
+                if isr in measured:
+                    cycles = measured[isr]
+                    print(f"  Simulated ({scenario}): {cycles['avg']} cycles average, {cycles['max']} max")
+
+    # Report the other measured functions
+    if sim_results:
+        print(f"Simulated at {sim_results['baud']} baud, maximum sustainable {sim_results['max_sustainable_baud']} baud")
+        for scenario, measured in sim_results["scenarios"].items():
+            for symbol, cycles in measured.items():
+                if not symbol.startswith("__vector_"):
+                    print(f"  {cycles['label']} ({scenario}): {cycles['calls']} calls, "
+                          f"{cycles['min']}/{cycles['avg']}/{cycles['max']} cycles min/avg/max")
+    report_hot_path(env)
     print("=" * 40)  # Separator after analysis
 
+def report_hot_path(env):
+    import re
+    import os
+
+    # Written by the linker (-Wl,-Map,main.map), relative to the project directory
+    MAP_FILE = os.path.join(env.subst("$PROJECT_DIR"), "main.map")
+    if not os.path.exists(MAP_FILE):
+        return
+
+    # HOT_PATH functions (lib/HotPath/HotPath.h) land in .text.hot.<symbol>;
+    # ld wraps the address and size onto the next line after a long name
+    section_pattern = re.compile(r"^ (\.text\.hot\.\S+)(?:\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+))?")
+    size_pattern = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s")
+
+    with open(MAP_FILE, "r") as f:
+        map_lines = f.readlines()
+
+    hot_sections = {}
+    in_memory_map = False
+    pending = None
+    for line in map_lines:
+        # Ignore the sections --gc-sections discarded, listed ahead of the map
+        if line.startswith("Linker script and memory map"):
+            in_memory_map = True
+            continue
+        if not in_memory_map:
+            continue
+
+        if pending:
+            match = size_pattern.match(line)
+            if match:
+                hot_sections[pending] = int(match.group(2), 16)
+            pending = None
+            continue
+
+        match = section_pattern.match(line)
+        if match:
+            if match.group(3):
+                hot_sections[match.group(1)] = int(match.group(3), 16)
+            else:
+                pending = match.group(1)
+
+    # Only sections that made it into flash
+    hot_sections = {name: size for name, size in hot_sections.items() if size > 0}
+    hot_bytes = sum(hot_sections.values())
+    budget = env.BoardConfig().get("upload.maximum_size", 0)
+    print(f"Hot path: {len(hot_sections)} functions, {hot_bytes} bytes of flash"
+          + (f" (budget {budget} bytes)" if budget else ""))
+    for name, size in sorted(hot_sections.items(), key=lambda item: -item[1]):
+        print(f"  {name[len('.text.hot.'):]}: {size} bytes")
+
 # Add custom target that can be called with "pio run -t disasm"
 env.AddCustomTarget(
     name="disasm",
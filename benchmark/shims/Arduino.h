@@ -0,0 +1,112 @@
+/**
+ * @file Arduino.h
+ * @brief Thin host stand-in for the Arduino AVR core.
+ *
+ * Just enough of the core for the libraries under benchmark to compile and
+ * run on the build machine: fixed width types, the pin and timing calls,
+ * flash string helpers that read RAM, and the Print/Stream classes. The
+ * I/O ports are plain variables (see avr/io.h), so code driving pins
+ * through FastPin can be wired up and observed by the benchmark.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <type_traits>
+
+#include <avr/pgmspace.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define NOT_A_PIN 0
+#define NOT_A_PORT 0
+
+/// Flash string literal, kept in RAM on the host
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+// The core's macros, as functions that evaluate each argument once
+template <typename T, typename U>
+constexpr typename std::common_type<T, U>::type min(const T a, const U b) { return (a < b) ? a : b; }
+template <typename T, typename U>
+constexpr typename std::common_type<T, U>::type max(const T a, const U b) { return (a > b) ? a : b; }
+
+/**
+ * @brief Milliseconds since the program started.
+ */
+unsigned long millis();
+
+/**
+ * @brief Microseconds since the program started.
+ */
+unsigned long micros();
+
+/**
+ * @brief Sleep for a number of milliseconds.
+ */
+void delay(unsigned long ms);
+
+/**
+ * @brief Busy-wait for a number of microseconds.
+ */
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// Pin to port mapping of the Pro Micro, as the variant tables provide it
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+volatile uint8_t *portOutputRegister(uint8_t port);
+volatile uint8_t *portInputRegister(uint8_t port);
+volatile uint8_t *portModeRegister(uint8_t port);
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+
+/**
+ * @brief Serial stand-in: writes go to stdout, nothing is ever received.
+ */
+class NativeSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  operator bool() { return true; }
+  bool dtr() { return true; }
+
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  int availableForWrite() override { return 64; }
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+};
+
+extern NativeSerial Serial;
+
+#endif // NATIVE_ARDUINO_H
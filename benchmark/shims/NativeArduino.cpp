@@ -0,0 +1,244 @@
+/**
+ * @file NativeArduino.cpp
+ * @brief Implementation of the host Arduino stand-in.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+volatile uint8_t SREG = 1 << SREG_I;
+
+/// Defines the registers of one port
+#define NATIVE_PORT(name)      \
+  volatile uint8_t PORT##name; \
+  volatile uint8_t PIN##name;  \
+  volatile uint8_t DDR##name;
+
+NATIVE_PORT(B)
+NATIVE_PORT(C)
+NATIVE_PORT(D)
+NATIVE_PORT(E)
+NATIVE_PORT(F)
+
+#undef NATIVE_PORT
+
+NativeSerial Serial;
+
+/// Program start, the zero of millis() and micros()
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long millis()
+{
+  return static_cast<unsigned long>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+unsigned long micros()
+{
+  return static_cast<unsigned long>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+
+void delay(unsigned long ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  const unsigned long start = micros();
+  while (micros() - start < us)
+  {
+  }
+}
+
+//---------------- Pins ----------------//
+
+// Leonardo / Pro Micro pin order, D0 to D30, as in FastPinMap
+static const char PIN_PORTS[] = "DDDDDCDEBBBBDCBBBBFFFFFFDDBBBDD";
+static const char PIN_BITS[] = "2310467645676731207654104745665";
+static constexpr uint8_t PIN_COUNT = sizeof(PIN_PORTS) - 1;
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+  // Port numbers of the AVR core: B = 2 to F = 6
+  return (pin < PIN_COUNT) ? static_cast<uint8_t>(PIN_PORTS[pin] - 'A' + 1) : NOT_A_PORT;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+  return (pin < PIN_COUNT) ? static_cast<uint8_t>(1U << (PIN_BITS[pin] - '0')) : 0;
+}
+
+volatile uint8_t *portOutputRegister(uint8_t port)
+{
+  volatile uint8_t *const registers[] = {nullptr, nullptr, &PORTB, &PORTC, &PORTD, &PORTE, &PORTF};
+  return (port < sizeof(registers) / sizeof(registers[0])) ? registers[port] : nullptr;
+}
+
+volatile uint8_t *portInputRegister(uint8_t port)
+{
+  volatile uint8_t *const registers[] = {nullptr, nullptr, &PINB, &PINC, &PIND, &PINE, &PINF};
+  return (port < sizeof(registers) / sizeof(registers[0])) ? registers[port] : nullptr;
+}
+
+volatile uint8_t *portModeRegister(uint8_t port)
+{
+  volatile uint8_t *const registers[] = {nullptr, nullptr, &DDRB, &DDRC, &DDRD, &DDRE, &DDRF};
+  return (port < sizeof(registers) / sizeof(registers[0])) ? registers[port] : nullptr;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  volatile uint8_t *const ddr = portModeRegister(digitalPinToPort(pin));
+  volatile uint8_t *const out = portOutputRegister(digitalPinToPort(pin));
+  if (ddr == nullptr)
+    return;
+
+  const uint8_t mask = digitalPinToBitMask(pin);
+  if (mode == OUTPUT)
+  {
+    *ddr |= mask;
+  }
+  else
+  {
+    *ddr &= static_cast<uint8_t>(~mask);
+    *out = (mode == INPUT_PULLUP) ? (*out | mask) : (*out & static_cast<uint8_t>(~mask));
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  volatile uint8_t *const out = portOutputRegister(digitalPinToPort(pin));
+  if (out == nullptr)
+    return;
+
+  const uint8_t mask = digitalPinToBitMask(pin);
+  *out = value ? (*out | mask) : (*out & static_cast<uint8_t>(~mask));
+}
+
+int digitalRead(uint8_t pin)
+{
+  volatile uint8_t *const in = portInputRegister(digitalPinToPort(pin));
+  return (in != nullptr && (*in & digitalPinToBitMask(pin))) ? HIGH : LOW;
+}
+
+//---------------- Print ----------------//
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+  while (size-- > 0 && write(*buffer++) == 1)
+  {
+    ++written;
+  }
+  return written;
+}
+
+size_t Print::print(const __FlashStringHelper *str)
+{
+  return write(reinterpret_cast<const char *>(str));
+}
+
+size_t Print::printSigned(long long value, int base)
+{
+  if (base == 10 && value < 0)
+  {
+    return print('-') + printNumber(static_cast<unsigned long long>(-(value + 1)) + 1, 10);
+  }
+  // Other bases print the two's complement, as the AVR core does
+  return printNumber(static_cast<unsigned long long>(value), base);
+}
+
+size_t Print::printNumber(unsigned long long value, int base)
+{
+  if (base < 2)
+    base = 10;
+
+  char digits[sizeof(value) * 8 + 1];
+  char *p = &digits[sizeof(digits) - 1];
+  *p = '\0';
+  do
+  {
+    const char digit = static_cast<char>(value % base);
+    value /= base;
+    *--p = (digit < 10) ? static_cast<char>('0' + digit) : static_cast<char>('A' + digit - 10);
+  } while (value != 0);
+  return write(p);
+}
+
+size_t Print::printFloat(double value, int digits)
+{
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", digits < 0 ? 0 : digits, value);
+  return write(text);
+}
+
+//---------------- Stream ----------------//
+
+int Stream::timedRead()
+{
+  const unsigned long start = millis();
+  do
+  {
+    const int c = read();
+    if (c >= 0)
+      return c;
+  } while (millis() - start < m_timeout);
+  return -1;
+}
+
+int Stream::timedPeek()
+{
+  const unsigned long start = millis();
+  do
+  {
+    const int c = peek();
+    if (c >= 0)
+      return c;
+  } while (millis() - start < m_timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length)
+  {
+    const int c = timedRead();
+    if (c < 0)
+      break;
+    buffer[count++] = static_cast<char>(c);
+  }
+  return count;
+}
+
+size_t Stream::readBytesUntil(char terminator, char *buffer, size_t length)
+{
+  size_t count = 0;
+  while (count < length)
+  {
+    const int c = timedRead();
+    if (c < 0 || c == terminator)
+      break;
+    buffer[count++] = static_cast<char>(c);
+  }
+  return count;
+}
+
+//---------------- Serial ----------------//
+
+size_t NativeSerial::write(uint8_t data)
+{
+  return (fputc(data, stdout) == EOF) ? 0 : 1;
+}
+
+size_t NativeSerial::write(const uint8_t *buffer, size_t size)
+{
+  return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,83 @@
+/**
+ * @file Print.h
+ * @brief Host stand-in for the Arduino Print class.
+ *
+ * Same interface as the AVR core's Print for the calls the libraries make;
+ * numbers are formatted the same way, with 64-bit variants for the wider
+ * host integer types.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_PRINT_H
+#define NATIVE_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+
+class Print;
+
+/**
+ * @brief Object that can print itself.
+ */
+class Printable
+{
+public:
+  virtual ~Printable() = default;
+  virtual size_t printTo(Print &p) const = 0;
+};
+
+/**
+ * @brief Base class of every text output, as in the Arduino core.
+ */
+class Print
+{
+public:
+  virtual ~Print() = default;
+
+  int getWriteError() { return m_writeError; }
+  void clearWriteError() { setWriteError(0); }
+
+  virtual size_t write(uint8_t data) = 0;
+  size_t write(const char *str) { return (str == nullptr) ? 0 : write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *buffer, size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper *str);
+  size_t print(const char str[]) { return write(str); }
+  size_t print(char c) { return write(static_cast<uint8_t>(c)); }
+  size_t print(unsigned char value, int base = DEC_BASE) { return printNumber(value, base); }
+  size_t print(int value, int base = DEC_BASE) { return printSigned(value, base); }
+  size_t print(unsigned int value, int base = DEC_BASE) { return printNumber(value, base); }
+  size_t print(long value, int base = DEC_BASE) { return printSigned(value, base); }
+  size_t print(unsigned long value, int base = DEC_BASE) { return printNumber(value, base); }
+  size_t print(long long value, int base = DEC_BASE) { return printSigned(value, base); }
+  size_t print(unsigned long long value, int base = DEC_BASE) { return printNumber(value, base); }
+  size_t print(double value, int digits = 2) { return printFloat(value, digits); }
+  size_t print(const Printable &printable) { return printable.printTo(*this); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T &value) { return print(value) + println(); }
+  template <typename T>
+  size_t println(const T &value, int format) { return print(value, format) + println(); }
+
+protected:
+  void setWriteError(int error = 1) { m_writeError = error; }
+
+private:
+  static constexpr int DEC_BASE = 10; ///< Same as DEC, which Arduino.h defines after this header
+
+  size_t printSigned(long long value, int base);
+  size_t printNumber(unsigned long long value, int base);
+  size_t printFloat(double value, int digits);
+
+  int m_writeError = 0; ///< Set by implementations on a failed write
+};
+
+#endif // NATIVE_PRINT_H
@@ -0,0 +1,40 @@
+/**
+ * @file Stream.h
+ * @brief Host stand-in for the Arduino Stream class.
+ *
+ * The timed reads poll millis() like the AVR core, so a stream that never
+ * delivers makes them wait out the timeout.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+#include "Print.h"
+
+/**
+ * @brief Base class of every byte input, as in the Arduino core.
+ */
+class Stream : public Print
+{
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { m_timeout = timeout; }
+  unsigned long getTimeout() const { return m_timeout; }
+
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) { return readBytes(reinterpret_cast<char *>(buffer), length); }
+  size_t readBytesUntil(char terminator, char *buffer, size_t length);
+
+protected:
+  int timedRead();
+  int timedPeek();
+
+  unsigned long m_timeout = 1000; ///< Milliseconds the timed reads wait
+};
+
+#endif // NATIVE_STREAM_H
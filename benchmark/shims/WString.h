@@ -0,0 +1,47 @@
+/**
+ * @file WString.h
+ * @brief Host stand-in for the Arduino String class.
+ *
+ * Only what the libraries under benchmark call. The text lives in a
+ * std::string, so every String allocates on the heap just as the core's
+ * does and shows up in the allocation counts.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <string>
+
+/**
+ * @brief Heap allocated string, as in the Arduino core.
+ */
+class String
+{
+public:
+  String() = default;
+  String(const char *str) : m_text(str == nullptr ? "" : str) {}
+
+  unsigned int length() const { return static_cast<unsigned int>(m_text.size()); }
+  const char *c_str() const { return m_text.c_str(); }
+  char operator[](unsigned int index) const { return index < m_text.size() ? m_text[index] : '\0'; }
+  char charAt(unsigned int index) const { return operator[](index); }
+
+  String &operator+=(const char *str)
+  {
+    m_text += str;
+    return *this;
+  }
+  String &operator+=(const char c)
+  {
+    m_text += c;
+    return *this;
+  }
+  bool operator==(const char *str) const { return m_text == str; }
+
+private:
+  std::string m_text; ///< The text
+};
+
+#endif // NATIVE_WSTRING_H
@@ -0,0 +1,24 @@
+/**
+ * @file interrupt.h
+ * @brief Host stand-in for avr-libc's interrupt control.
+ *
+ * The host build is single threaded and has no interrupts: SREG is a plain
+ * variable and the ISR bodies are called directly by the benchmarks.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_AVR_INTERRUPT_H
+#define NATIVE_AVR_INTERRUPT_H
+
+#include <stdint.h>
+
+/// Global interrupt enable bit of SREG
+#define SREG_I 7
+
+extern volatile uint8_t SREG;
+
+inline void cli() { SREG &= static_cast<uint8_t>(~(1 << SREG_I)); }
+inline void sei() { SREG |= static_cast<uint8_t>(1 << SREG_I); }
+
+#endif // NATIVE_AVR_INTERRUPT_H
@@ -0,0 +1,37 @@
+/**
+ * @file io.h
+ * @brief Host stand-in for the ATmega32U4 I/O ports.
+ *
+ * Each port register is a plain variable. Nothing drives the PIN registers,
+ * so a benchmark that needs a wire copies output bits into them itself.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_AVR_IO_H
+#define NATIVE_AVR_IO_H
+
+#include <stdint.h>
+
+/// Declares the output, input and direction registers of one port
+#define NATIVE_PORT(name)             \
+  extern volatile uint8_t PORT##name; \
+  extern volatile uint8_t PIN##name;  \
+  extern volatile uint8_t DDR##name;
+
+NATIVE_PORT(B)
+NATIVE_PORT(C)
+NATIVE_PORT(D)
+NATIVE_PORT(E)
+NATIVE_PORT(F)
+
+#undef NATIVE_PORT
+
+// Code tests for a port with #ifdef, as avr/io.h defines them as macros
+#define PORTB PORTB
+#define PORTC PORTC
+#define PORTD PORTD
+#define PORTE PORTE
+#define PORTF PORTF
+
+#endif // NATIVE_AVR_IO_H
@@ -0,0 +1,62 @@
+/**
+ * @file pgmspace.h
+ * @brief Host stand-in for avr-libc's program memory access.
+ *
+ * The host has one address space: PROGMEM data stays in RAM and the
+ * pgm_read_* calls are plain loads. pgm_read_word() and pgm_read_ptr()
+ * return the pointed-to type, so the tables of pointers the libraries keep
+ * in flash survive 64-bit addresses.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_AVR_PGMSPACE_H
+#define NATIVE_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PGM_VOID_P const void *
+#define PSTR(s) (s)
+
+class __FlashStringHelper;
+
+/// Word read through a typed pointer: the pointed-to value, which may be a pointer
+template <typename T>
+inline T pgm_read_word_native(const T *address) { return *address; }
+
+/// Word read through a byte or untyped pointer: two bytes, little-endian like the AVR
+inline uint16_t pgm_read_word_native(const void *address)
+{
+  uint16_t value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+inline uint16_t pgm_read_word_native(const char *address) { return pgm_read_word_native(static_cast<const void *>(address)); }
+inline uint16_t pgm_read_word_native(const uint8_t *address) { return pgm_read_word_native(static_cast<const void *>(address)); }
+
+inline uint32_t pgm_read_dword_native(const void *address)
+{
+  uint32_t value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+
+#define pgm_read_byte(address) (*reinterpret_cast<const uint8_t *>(address))
+#define pgm_read_word(address) pgm_read_word_native(address)
+#define pgm_read_dword(address) pgm_read_dword_native(address)
+#define pgm_read_ptr(address) pgm_read_word_native(address)
+
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strlen_P strlen
+#define strnlen_P strnlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcasecmp_P strcasecmp
+
+#endif // NATIVE_AVR_PGMSPACE_H
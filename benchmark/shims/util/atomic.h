@@ -0,0 +1,21 @@
+/**
+ * @file atomic.h
+ * @brief Host stand-in for avr-libc's ATOMIC_BLOCK.
+ *
+ * Nothing interrupts the single threaded host build, so the block only
+ * runs its body once.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_UTIL_ATOMIC_H
+#define NATIVE_UTIL_ATOMIC_H
+
+#include <avr/interrupt.h>
+
+#define ATOMIC_RESTORESTATE uint8_t atomicSavedState __attribute__((unused)) = SREG
+#define ATOMIC_FORCEON uint8_t atomicSavedState __attribute__((unused)) = SREG
+
+#define ATOMIC_BLOCK(type) for (type, atomicToDo = 1; atomicToDo; atomicToDo = 0)
+
+#endif // NATIVE_UTIL_ATOMIC_H
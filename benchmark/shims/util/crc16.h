@@ -0,0 +1,69 @@
+/**
+ * @file crc16.h
+ * @brief Host stand-in for avr-libc's CRC routines.
+ *
+ * The C equivalents avr-libc documents for its assembler routines, with the
+ * same results.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef NATIVE_UTIL_CRC16_H
+#define NATIVE_UTIL_CRC16_H
+
+#include <stdint.h>
+
+/// CRC-16 (IBM/ANSI), polynomial 0xA001 reflected
+inline uint16_t _crc16_update(uint16_t crc, const uint8_t data)
+{
+  crc ^= data;
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    crc = (crc & 1) ? static_cast<uint16_t>((crc >> 1) ^ 0xA001) : static_cast<uint16_t>(crc >> 1);
+  }
+  return crc;
+}
+
+/// CRC-XMODEM, polynomial 0x1021
+inline uint16_t _crc_xmodem_update(uint16_t crc, const uint8_t data)
+{
+  crc = crc ^ (static_cast<uint16_t>(data) << 8);
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+  }
+  return crc;
+}
+
+/// CRC-CCITT, polynomial 0x8408 reflected
+inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+  data ^= static_cast<uint8_t>(crc & 0xFF);
+  data ^= static_cast<uint8_t>(data << 4);
+  return static_cast<uint16_t>(((static_cast<uint16_t>(data) << 8) | (crc >> 8)) ^
+                               static_cast<uint8_t>(data >> 4) ^ (static_cast<uint16_t>(data) << 3));
+}
+
+/// Dallas iButton 8-bit CRC, polynomial 0x8C reflected
+inline uint8_t _crc_ibutton_update(uint8_t crc, const uint8_t data)
+{
+  crc ^= data;
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    crc = (crc & 1) ? static_cast<uint8_t>((crc >> 1) ^ 0x8C) : static_cast<uint8_t>(crc >> 1);
+  }
+  return crc;
+}
+
+/// CRC-8-CCITT, polynomial 0x07
+inline uint8_t _crc8_ccitt_update(uint8_t crc, const uint8_t data)
+{
+  crc ^= data;
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+  }
+  return crc;
+}
+
+#endif // NATIVE_UTIL_CRC16_H
@@ -0,0 +1,850 @@
+/**
+ * @file simbench.c
+ * @brief Cycle counting benchmark of the firmware image under simavr.
+ *
+ * Runs firmware.elf of the sim environment on a simulated ATmega32U4 and
+ * stands in for the HC05 module: it answers every AT line with OK on the
+ * link, raises STATE once the firmware leaves AT mode, and then drives the
+ * link RX pin with scripted traffic (CRC link frames carrying commands,
+ * clean, back-to-back and noisy). Meanwhile it follows the program counter
+ * and reports the cycles spent per call of the hot functions, and sweeps
+ * the link baud rate for the fastest one the firmware receives without
+ * frame errors.
+ *
+ * Results go to stdout and, with --json, to a file the assembly analysis
+ * of later builds annotates the disassembly with.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <gelf.h>
+
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#include <simavr/sim_io.h>
+#include <simavr/sim_cycle_timers.h>
+#include <simavr/avr_ioport.h>
+
+#define SIM_FREQUENCY 16000000UL
+
+/* Pins of the SoftSerial board configuration in include/Globals.h */
+#define LINK_RX_PORT 'D' /* HC05_RX 6 = PD7, the firmware's input */
+#define LINK_RX_BIT 7
+#define LINK_TX_PORT 'E' /* HC05_TX 7 = PE6, the firmware's output */
+#define LINK_TX_BIT 6
+#define STATE_PORT 'D' /* HC05_STATE 1 = PD3 */
+#define STATE_BIT 3
+#define KEY_PORT 'D' /* HC05_KEY 0 = PD2 */
+#define KEY_BIT 2
+
+/* PLLCSR of the 32U4; the core's USB attach waits for PLOCK */
+#define PLLCSR_ADDRESS 0x49
+#define PLLCSR_PLOCK 0x01
+
+/* struct SimProbe in include/Globals.h */
+#define SIM_PROBE_SYMBOL "simProbe"
+#define SIM_PROBE_MAGIC 0x5A
+#define SIM_PROBE_MAGIC_OFFSET 0
+#define SIM_PROBE_BAUD_OFFSET 1
+#define SIM_PROBE_RX_ERRORS_OFFSET 2
+#define SIM_PROBE_LOOP_PASSES_OFFSET 4
+#define SIM_PROBE_PACKETS_OFFSET 8
+#define SIM_PROBE_MAC_TAG_OFFSET 10
+
+/* SipHash-2-4 of message 00..0e with key 00..0f, the firmware's tag in SimProbe */
+static const uint8_t SIPHASH_REFERENCE_TAG[8] = {0xe5, 0x45, 0xbe, 0x49, 0x61, 0xca, 0x29, 0xa1};
+/* SIPHASH_CYCLE_BUDGET of lib/SipHash/SipHash.h */
+#define SIPHASH_CYCLE_BUDGET 4000
+
+/* BaudRate codes of lib/SoftSerial/SoftSerial.h */
+static const uint32_t BAUD_RATES[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200};
+#define BAUD_CODE_DEFAULT 5
+#define BAUD_CODE_SWEEP_FIRST 3
+/* SOFT_SERIAL_LINK_57600 of include/Globals.h: the rate whose Timer1 ISR budget is checked */
+#define BAUD_CODE_57600 6
+/* SoftSerial samples three times per bit, a sampling ISR must end within one tick */
+#define OVERSAMPLE 3
+
+/* Data symbols carry this offset in an AVR ELF */
+#define AVR_DATA_OFFSET 0x800000
+
+/* CRC link framing of lib/Packager/CRCPackageInterface */
+#define FRAME_START 0xAA
+#define FRAME_STOP 0x55
+#define FRAME_DATA 0
+#define FRAME_RESET 3
+#define FRAME_PAYLOAD 8
+#define FRAME_LENGTH (4 + FRAME_PAYLOAD + 3)
+
+/* Simulated time of the phases, in milliseconds */
+#define CONNECT_TIMEOUT_MS 8000
+#define STATE_DELAY_MS 200
+#define TRAFFIC_MS 1000
+#define DRAIN_MS 200
+
+#define MAX_LINE 64
+#define MAX_QUEUE 4096
+
+/**
+ * @brief One function whose calls are timed.
+ */
+typedef struct
+{
+  const char *label;   /* Name in the report */
+  const char *pattern; /* Substring of the (mangled) symbol name */
+  char symbol[128];    /* Symbol found for it */
+  uint32_t address;    /* Byte address of its first instruction, 0 when not found */
+  int active;          /* A call is running */
+  uint16_t entrySp;    /* SP at entry, above it once the call returned */
+  avr_cycle_count_t entryCycle;
+  uint32_t calls;
+  uint64_t total;
+  uint32_t min;
+  uint32_t max;
+} probe_t;
+
+static probe_t probes[] = {
+    {.label = "processISR() (TIMER1_COMPA)", .pattern = "__vector_17"},
+    {.label = "crc16()", .pattern = "CRCPackageInterface5crc16"},
+    {.label = "findCommand()", .pattern = "14SerialCommands11findCommand"},
+    {.label = "K810Security::loop()", .pattern = "12K810Security4loopEv"},
+    {.label = "SipHash::mac()", .pattern = "7SipHash3mac"},
+};
+#define PROBE_COUNT (sizeof(probes) / sizeof(probes[0]))
+/* Index of processISR() in probes, checked against the tick at 57600 baud */
+#define PROBE_TIMER1_ISR 0
+/* Index of SipHash::mac() in probes, checked against SIPHASH_CYCLE_BUDGET */
+#define PROBE_SIPHASH 4
+
+/**
+ * @brief Traffic the stand-in module sends on the link.
+ */
+typedef enum
+{
+  TRAFFIC_CLEAN,        /* Frames with an idle gap between them */
+  TRAFFIC_BACK_TO_BACK, /* Frames and filler with no idle time at all */
+  TRAFFIC_NOISY         /* Clean frames with bit errors and line glitches */
+} traffic_t;
+
+static const char *const TRAFFIC_NAMES[] = {"clean", "back-to-back", "noisy"};
+
+/**
+ * @brief Simulation state of one run.
+ */
+typedef struct
+{
+  avr_t *avr;
+  uint32_t baud;
+  avr_cycle_count_t bitCycles;
+
+  /* Bytes to the firmware */
+  uint8_t queue[MAX_QUEUE];
+  uint16_t queueHead;
+  uint16_t queueTail;
+  uint16_t txShift; /* Frame being sent, LSB first, 0 when idle */
+  uint8_t txBits;
+  avr_irq_t *rxIrq;
+  double bitErrorRate;
+
+  /* Bytes from the firmware */
+  int lineLevel;
+  int decoding;
+  uint8_t rxBits;
+  uint8_t rxByte;
+  char line[MAX_LINE];
+  uint8_t lineLength;
+
+  /* Module state */
+  int keyHigh;
+  int keyWasHigh;
+  int connected;
+  avr_irq_t *stateIrq;
+  avr_cycle_count_t connectAt;
+
+  /* Traffic */
+  traffic_t traffic;
+  int trafficOn;
+  uint8_t packetNumber;
+  uint32_t framesSent;
+  uint32_t random;
+} sim_t;
+
+static uint16_t probeAddress;
+
+//================ Firmware symbols ==================
+
+/**
+ * @brief Find the probe functions and the SimProbe block in the ELF symbol table.
+ */
+static int readSymbols(const char *path)
+{
+  if (elf_version(EV_CURRENT) == EV_NONE)
+    return -1;
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return -1;
+  Elf *elf = elf_begin(fd, ELF_C_READ, NULL);
+  Elf_Scn *section = NULL;
+  while (elf != NULL && (section = elf_nextscn(elf, section)) != NULL)
+  {
+    GElf_Shdr header;
+    if (gelf_getshdr(section, &header) == NULL || header.sh_type != SHT_SYMTAB)
+      continue;
+    Elf_Data *data = elf_getdata(section, NULL);
+    const size_t count = header.sh_size / header.sh_entsize;
+    for (size_t i = 0; i < count; ++i)
+    {
+      GElf_Sym symbol;
+      gelf_getsym(data, (int)i, &symbol);
+      const char *name = elf_strptr(elf, header.sh_link, symbol.st_name);
+      if (name == NULL || *name == '\0')
+        continue;
+
+      if (GELF_ST_TYPE(symbol.st_info) == STT_OBJECT && strcmp(name, SIM_PROBE_SYMBOL) == 0)
+      {
+        probeAddress = (uint16_t)(symbol.st_value - AVR_DATA_OFFSET);
+        continue;
+      }
+      if (GELF_ST_TYPE(symbol.st_info) != STT_FUNC)
+        continue;
+      for (size_t p = 0; p < PROBE_COUNT; ++p)
+      {
+        if (probes[p].address == 0 && strstr(name, probes[p].pattern) != NULL)
+        {
+          probes[p].address = (uint32_t)symbol.st_value;
+          snprintf(probes[p].symbol, sizeof(probes[p].symbol), "%s", name);
+        }
+      }
+    }
+  }
+  if (elf != NULL)
+    elf_end(elf);
+  close(fd);
+  return 0;
+}
+
+//================ Function timing ==================
+
+static inline uint16_t stackPointer(const avr_t *avr)
+{
+  return (uint16_t)(avr->data[R_SPL] | (avr->data[R_SPH] << 8));
+}
+
+/**
+ * @brief Follow one executed instruction: start and end timed calls.
+ *
+ * A call starts when the PC reaches the function's first instruction and
+ * ends once SP is back above its value there, i.e. the return address
+ * (or, for an ISR, the interrupted PC) has been popped. The cycles of
+ * interrupts taken during a call count towards it.
+ */
+static void profile(avr_t *avr)
+{
+  const uint16_t sp = stackPointer(avr);
+  for (size_t p = 0; p < PROBE_COUNT; ++p)
+  {
+    probe_t *probe = &probes[p];
+    if (probe->address == 0)
+      continue;
+    if (probe->active)
+    {
+      if (sp > probe->entrySp)
+      {
+        const uint32_t cycles = (uint32_t)(avr->cycle - probe->entryCycle);
+        probe->active = 0;
+        probe->calls++;
+        probe->total += cycles;
+        if (cycles < probe->min)
+          probe->min = cycles;
+        if (cycles > probe->max)
+          probe->max = cycles;
+      }
+    }
+    else if (avr->pc == probe->address)
+    {
+      probe->active = 1;
+      probe->entrySp = sp;
+      probe->entryCycle = avr->cycle;
+    }
+  }
+}
+
+static void resetProbes(void)
+{
+  for (size_t p = 0; p < PROBE_COUNT; ++p)
+  {
+    probes[p].active = 0;
+    probes[p].calls = 0;
+    probes[p].total = 0;
+    probes[p].min = UINT32_MAX;
+    probes[p].max = 0;
+  }
+}
+
+//================ SimProbe ==================
+
+static void writeProbe(avr_t *avr, const uint8_t baudCode)
+{
+  avr->data[probeAddress + SIM_PROBE_MAGIC_OFFSET] = SIM_PROBE_MAGIC;
+  avr->data[probeAddress + SIM_PROBE_BAUD_OFFSET] = baudCode;
+}
+
+static uint16_t probeRxErrors(const avr_t *avr)
+{
+  return (uint16_t)(avr->data[probeAddress + SIM_PROBE_RX_ERRORS_OFFSET] |
+                    (avr->data[probeAddress + SIM_PROBE_RX_ERRORS_OFFSET + 1] << 8));
+}
+
+static uint16_t probePackets(const avr_t *avr)
+{
+  return (uint16_t)(avr->data[probeAddress + SIM_PROBE_PACKETS_OFFSET] |
+                    (avr->data[probeAddress + SIM_PROBE_PACKETS_OFFSET + 1] << 8));
+}
+
+static int probeMacTagMatches(const avr_t *avr)
+{
+  return memcmp(&avr->data[probeAddress + SIM_PROBE_MAC_TAG_OFFSET], SIPHASH_REFERENCE_TAG,
+                sizeof(SIPHASH_REFERENCE_TAG)) == 0;
+}
+
+static uint32_t probeLoopPasses(const avr_t *avr)
+{
+  uint32_t passes = 0;
+  for (int i = 3; i >= 0; --i)
+    passes = (passes << 8) | avr->data[probeAddress + SIM_PROBE_LOOP_PASSES_OFFSET + i];
+  return passes;
+}
+
+//================ Link to the firmware ==================
+
+static uint32_t nextRandom(sim_t *sim)
+{
+  /* xorshift32, seeded per run so every run sends the same traffic */
+  sim->random ^= sim->random << 13;
+  sim->random ^= sim->random >> 17;
+  sim->random ^= sim->random << 5;
+  return sim->random;
+}
+
+static void queueBytes(sim_t *sim, const uint8_t *data, const size_t length)
+{
+  for (size_t i = 0; i < length; ++i)
+  {
+    const uint16_t next = (uint16_t)((sim->queueHead + 1) % MAX_QUEUE);
+    if (next == sim->queueTail)
+      return;
+    sim->queue[sim->queueHead] = data[i];
+    sim->queueHead = next;
+  }
+}
+
+static int queueEmpty(const sim_t *sim)
+{
+  return sim->queueHead == sim->queueTail;
+}
+
+/**
+ * @brief Send the next bit on the firmware's RX pin.
+ */
+static avr_cycle_count_t sendBit(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+  sim_t *sim = (sim_t *)param;
+  (void)avr;
+
+  if (sim->txBits == 0)
+  {
+    if (queueEmpty(sim))
+    {
+      avr_raise_irq(sim->rxIrq, 1);
+      return when + sim->bitCycles;
+    }
+    /* Start bit, 8 data bits, stop bit */
+    sim->txShift = (uint16_t)((sim->queue[sim->queueTail] << 1) | 0x200);
+    sim->queueTail = (uint16_t)((sim->queueTail + 1) % MAX_QUEUE);
+    sim->txBits = 10;
+  }
+
+  int level = sim->txShift & 1;
+  sim->txShift >>= 1;
+  sim->txBits--;
+  if (sim->bitErrorRate > 0 && (nextRandom(sim) / 4294967296.0) < sim->bitErrorRate)
+    level = !level;
+  avr_raise_irq(sim->rxIrq, (uint32_t)level);
+  return when + sim->bitCycles;
+}
+
+/**
+ * @brief Pull the idle line low for an eighth of a bit, a glitch.
+ */
+static avr_cycle_count_t endGlitch(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+  sim_t *sim = (sim_t *)param;
+  (void)avr;
+  (void)when;
+  if (sim->txBits == 0)
+    avr_raise_irq(sim->rxIrq, 1);
+  return 0;
+}
+
+static void glitch(sim_t *sim)
+{
+  if (sim->txBits != 0)
+    return;
+  avr_raise_irq(sim->rxIrq, 0);
+  avr_cycle_timer_register(sim->avr, sim->bitCycles / 8, endGlitch, sim);
+}
+
+//================ Stand-in HC05 ==================
+
+static void answerLine(sim_t *sim)
+{
+  sim->line[sim->lineLength] = '\0';
+  if (strncmp(sim->line, "AT", 2) == 0)
+  {
+    static const uint8_t ok[] = "OK\r\n";
+    queueBytes(sim, ok, sizeof(ok) - 1);
+  }
+  sim->lineLength = 0;
+}
+
+/**
+ * @brief Sample the next bit of a byte the firmware sends.
+ */
+static avr_cycle_count_t sampleBit(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+  sim_t *sim = (sim_t *)param;
+  (void)avr;
+
+  if (sim->rxBits < 8)
+  {
+    sim->rxByte = (uint8_t)((sim->rxByte >> 1) | (sim->lineLevel ? 0x80 : 0));
+    sim->rxBits++;
+    return when + sim->bitCycles;
+  }
+
+  /* Stop bit */
+  sim->decoding = 0;
+  if (sim->lineLevel)
+  {
+    if (sim->rxByte == '\n')
+      answerLine(sim);
+    else if (sim->rxByte != '\r' && sim->lineLength < MAX_LINE - 1)
+      sim->line[sim->lineLength++] = (char)sim->rxByte;
+  }
+  return 0;
+}
+
+static void linkTxChanged(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+  sim_t *sim = (sim_t *)param;
+  (void)irq;
+  sim->lineLevel = value != 0;
+  if (!sim->decoding && !sim->lineLevel)
+  {
+    /* Start bit: sample the data bits in their middle */
+    sim->decoding = 1;
+    sim->rxBits = 0;
+    sim->rxByte = 0;
+    avr_cycle_timer_register(sim->avr, sim->bitCycles + sim->bitCycles / 2, sampleBit, sim);
+  }
+}
+
+static void keyChanged(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+  sim_t *sim = (sim_t *)param;
+  (void)irq;
+  sim->keyHigh = value != 0;
+  if (sim->keyHigh)
+  {
+    sim->keyWasHigh = 1;
+  }
+  else if (sim->keyWasHigh && !sim->connected && sim->connectAt == 0)
+  {
+    /* Data mode: a phone connects a little later */
+    sim->connectAt = sim->avr->cycle + (SIM_FREQUENCY / 1000) * STATE_DELAY_MS;
+  }
+}
+
+static void pllWritten(struct avr_t *avr, avr_io_addr_t address, uint8_t value, void *param)
+{
+  (void)param;
+  avr->data[address] = (value & PLLCSR_PLOCK) ? value : (uint8_t)(value | PLLCSR_PLOCK);
+}
+
+//================ Traffic ==================
+
+static uint16_t crc16(const uint8_t *data, const size_t length)
+{
+  /* CRC-16-CCITT, initial value 0xFFFF, as CRCPackageInterface::crc16() */
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; ++i)
+  {
+    crc ^= (uint16_t)(data[i] << 8);
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+/**
+ * @brief Queue one frame of the base format: 8 byte payload, channel 0.
+ */
+static void queueFrame(sim_t *sim, const uint8_t type, const uint8_t packetNumber, const char *payload)
+{
+  uint8_t frame[FRAME_LENGTH];
+  memset(frame, 0, sizeof(frame));
+  const size_t length = (payload != NULL) ? strlen(payload) : 0;
+  frame[0] = FRAME_START;
+  frame[1] = packetNumber;
+  frame[2] = type;
+  frame[3] = (uint8_t)(length & 0x3F);
+  if (length > 0)
+    memcpy(&frame[4], payload, length);
+  const uint16_t crc = crc16(&frame[1], 3 + FRAME_PAYLOAD);
+  frame[4 + FRAME_PAYLOAD] = (uint8_t)(crc >> 8);
+  frame[5 + FRAME_PAYLOAD] = (uint8_t)crc;
+  frame[6 + FRAME_PAYLOAD] = FRAME_STOP;
+  queueBytes(sim, frame, sizeof(frame));
+  sim->framesSent++;
+}
+
+static void queueCommand(sim_t *sim, const char *command)
+{
+  sim->packetNumber = (uint8_t)((sim->packetNumber == 255) ? 1 : sim->packetNumber + 1);
+  queueFrame(sim, FRAME_DATA, sim->packetNumber, command);
+}
+
+/**
+ * @brief Keep the link busy with the scenario's traffic.
+ */
+static avr_cycle_count_t feedTraffic(avr_t *avr, avr_cycle_count_t when, void *param)
+{
+  sim_t *sim = (sim_t *)param;
+  (void)avr;
+  if (!sim->trafficOn)
+    return 0;
+
+  static const char *const COMMANDS[] = {"ping\n", "state\n", "version\n"};
+  switch (sim->traffic)
+  {
+  case TRAFFIC_CLEAN:
+  case TRAFFIC_NOISY:
+    if (queueEmpty(sim) && sim->txBits == 0)
+      queueCommand(sim, COMMANDS[sim->framesSent % 3]);
+    if (sim->traffic == TRAFFIC_NOISY && (nextRandom(sim) % 16) == 0)
+      glitch(sim);
+    /* The next frame goes out two milliseconds after this one */
+    return when + SIM_FREQUENCY / 500;
+  case TRAFFIC_BACK_TO_BACK:
+    if ((uint16_t)((sim->queueHead - sim->queueTail + MAX_QUEUE) % MAX_QUEUE) < FRAME_LENGTH * 2)
+    {
+      queueCommand(sim, COMMANDS[sim->framesSent % 3]);
+      uint8_t filler[8];
+      for (size_t i = 0; i < sizeof(filler); ++i)
+        filler[i] = (uint8_t)nextRandom(sim);
+      queueBytes(sim, filler, sizeof(filler));
+    }
+    return when + sim->bitCycles * 10;
+  }
+  return 0;
+}
+
+//================ Runs ==================
+
+typedef struct
+{
+  int crashed;
+  int connected;
+  uint16_t rxErrors;
+  uint32_t loopPasses;
+  uint32_t framesSent;
+  uint16_t packets;
+} run_result_t;
+
+/**
+ * @brief Boot the firmware, wait for the link and run one traffic scenario.
+ */
+static run_result_t runScenario(avr_t *avr, const uint8_t baudCode, const traffic_t traffic, const double bitErrorRate)
+{
+  static sim_t sim;
+  memset(&sim, 0, sizeof(sim));
+  sim.avr = avr;
+  sim.baud = BAUD_RATES[baudCode];
+  sim.bitCycles = SIM_FREQUENCY / sim.baud;
+  sim.traffic = traffic;
+  sim.bitErrorRate = bitErrorRate;
+  sim.random = 0x2545F491u;
+  sim.lineLevel = 1;
+
+  /* Clears SRAM and every cycle timer of the previous run */
+  avr_reset(avr);
+  writeProbe(avr, baudCode);
+  resetProbes();
+
+  sim.rxIrq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(LINK_RX_PORT), LINK_RX_BIT);
+  sim.stateIrq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(STATE_PORT), STATE_BIT);
+  avr_raise_irq(sim.rxIrq, 1);
+  avr_raise_irq(sim.stateIrq, 0);
+
+  static int hooked;
+  if (!hooked)
+  {
+    /* Pin notifications outlive a reset; sim is static, so they serve every run */
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(LINK_TX_PORT), LINK_TX_BIT), linkTxChanged, &sim);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(KEY_PORT), KEY_BIT), keyChanged, &sim);
+    avr_register_io_write(avr, PLLCSR_ADDRESS, pllWritten, NULL);
+    hooked = 1;
+  }
+  avr_cycle_timer_register(avr, sim.bitCycles, sendBit, &sim);
+
+  run_result_t result;
+  memset(&result, 0, sizeof(result));
+  const avr_cycle_count_t cyclesPerMs = SIM_FREQUENCY / 1000;
+  const avr_cycle_count_t connectDeadline = avr->cycle + cyclesPerMs * CONNECT_TIMEOUT_MS;
+  avr_cycle_count_t trafficEnd = 0;
+  avr_cycle_count_t runEnd = 0;
+
+  for (;;)
+  {
+    const int state = avr_run(avr);
+    if (state == cpu_Done || state == cpu_Crashed)
+    {
+      result.crashed = 1;
+      break;
+    }
+    if (avr->pc == 0)
+    {
+      /* Watchdog or software reset: calls in flight never return */
+      for (size_t p = 0; p < PROBE_COUNT; ++p)
+        probes[p].active = 0;
+    }
+    profile(avr);
+
+    if (sim.connectAt != 0 && !sim.connected && avr->cycle >= sim.connectAt)
+    {
+      sim.connected = 1;
+      avr_raise_irq(sim.stateIrq, 1);
+    }
+
+    if (!sim.trafficOn && trafficEnd == 0 && (sim.connected || avr->cycle >= connectDeadline))
+    {
+      /* RESET first so the packet numbers line up, the stop-and-wait base format */
+      queueFrame(&sim, FRAME_RESET, 0, NULL);
+      sim.trafficOn = 1;
+      trafficEnd = avr->cycle + cyclesPerMs * TRAFFIC_MS;
+      avr_cycle_timer_register(avr, cyclesPerMs, feedTraffic, &sim);
+    }
+    if (sim.trafficOn && avr->cycle >= trafficEnd)
+    {
+      sim.trafficOn = 0;
+      runEnd = avr->cycle + cyclesPerMs * DRAIN_MS;
+    }
+    if (runEnd != 0 && avr->cycle >= runEnd)
+      break;
+  }
+
+  result.connected = sim.connected;
+  result.rxErrors = probeRxErrors(avr);
+  result.loopPasses = probeLoopPasses(avr);
+  result.framesSent = sim.framesSent;
+  result.packets = probePackets(avr);
+  return result;
+}
+
+//================ Report ==================
+
+static void printProbes(FILE *json, const char *scenario, const int last)
+{
+  printf("  %-30s %8s %8s %8s %8s\n", "function", "calls", "min", "avg", "max");
+  int first = 1;
+  if (json != NULL)
+    fprintf(json, "    \"%s\": {", scenario);
+  for (size_t p = 0; p < PROBE_COUNT; ++p)
+  {
+    const probe_t *probe = &probes[p];
+    if (probe->address == 0)
+    {
+      printf("  %-30s %8s\n", probe->label, "inlined");
+      continue;
+    }
+    if (probe->calls == 0)
+    {
+      printf("  %-30s %8s\n", probe->label, "not reached");
+      continue;
+    }
+    const uint32_t average = (uint32_t)(probe->total / probe->calls);
+    printf("  %-30s %8u %8u %8u %8u\n", probe->label, probe->calls, probe->min, average, probe->max);
+    if (json != NULL)
+    {
+      fprintf(json, "%s\n      \"%s\": {\"label\": \"%s\", \"calls\": %u, \"min\": %u, \"avg\": %u, \"max\": %u}",
+              first ? "" : ",", probe->symbol, probe->label, probe->calls, probe->min, average, probe->max);
+      first = 0;
+    }
+  }
+  if (json != NULL)
+    fprintf(json, "\n    }%s\n", last ? "" : ",");
+}
+
+static void usage(const char *program)
+{
+  fprintf(stderr,
+          "usage: %s [--json file] [--ber rate] [--no-sweep] firmware.elf\n"
+          "  --json file  write the cycle counts for the assembly analysis\n"
+          "  --ber rate   bit error rate of the noisy scenario (default 0.001)\n"
+          "  --no-sweep   skip the baud rate sweep\n",
+          program);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *jsonPath = NULL;
+  double bitErrorRate = 0.001;
+  int sweep = 1;
+
+  static const struct option OPTIONS[] = {
+      {"json", required_argument, NULL, 'j'},
+      {"ber", required_argument, NULL, 'b'},
+      {"no-sweep", no_argument, NULL, 'n'},
+      {NULL, 0, NULL, 0}};
+  int option;
+  while ((option = getopt_long(argc, argv, "j:b:n", OPTIONS, NULL)) != -1)
+  {
+    switch (option)
+    {
+    case 'j':
+      jsonPath = optarg;
+      break;
+    case 'b':
+      bitErrorRate = atof(optarg);
+      break;
+    case 'n':
+      sweep = 0;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (optind != argc - 1)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+  const char *elfPath = argv[optind];
+
+  elf_firmware_t firmware;
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(elfPath, &firmware) != 0 || readSymbols(elfPath) != 0)
+  {
+    fprintf(stderr, "simbench: cannot read %s\n", elfPath);
+    return 1;
+  }
+  if (probeAddress == 0)
+  {
+    fprintf(stderr, "simbench: no %s in %s, build it with pio run -e sim\n", SIM_PROBE_SYMBOL, elfPath);
+    return 1;
+  }
+
+  avr_t *avr = avr_make_mcu_by_name("atmega32u4");
+  if (avr == NULL)
+  {
+    fprintf(stderr, "simbench: this simavr has no atmega32u4 core\n");
+    return 1;
+  }
+  avr_init(avr);
+  avr->frequency = SIM_FREQUENCY;
+  avr_load_firmware(avr, &firmware);
+  avr->log = LOG_ERROR;
+
+  FILE *json = NULL;
+  if (jsonPath != NULL)
+  {
+    json = fopen(jsonPath, "w");
+    if (json == NULL)
+    {
+      fprintf(stderr, "simbench: cannot write %s\n", jsonPath);
+      return 1;
+    }
+    fprintf(json, "{\n  \"frequency\": %lu,\n  \"baud\": %u,\n  \"scenarios\": {\n", SIM_FREQUENCY,
+            BAUD_RATES[BAUD_CODE_DEFAULT]);
+  }
+
+  printf("simavr benchmark of %s at %lu Hz, link %u baud, cycles per call\n", elfPath, SIM_FREQUENCY,
+         BAUD_RATES[BAUD_CODE_DEFAULT]);
+  int failed = 0;
+  for (int traffic = TRAFFIC_CLEAN; traffic <= TRAFFIC_NOISY; ++traffic)
+  {
+    const run_result_t result = runScenario(avr, BAUD_CODE_DEFAULT, (traffic_t)traffic,
+                                            (traffic == TRAFFIC_NOISY) ? bitErrorRate : 0.0);
+    printf("\n%s: %u frames sent, %u packets received, %s, %u loop passes, %u frame errors%s\n",
+           TRAFFIC_NAMES[traffic], result.framesSent, result.packets,
+           result.connected ? "connected" : "never connected", result.loopPasses, result.rxErrors,
+           result.crashed ? ", CRASHED" : "");
+    printProbes(json, TRAFFIC_NAMES[traffic], traffic == TRAFFIC_NOISY);
+  }
+
+  /* setup() runs the reference vector at every boot, the last scenario's call counts (with any interrupt taken in it) */
+  const probe_t *mac = &probes[PROBE_SIPHASH];
+  const int tagMatches = probeMacTagMatches(avr);
+  printf("\nSipHash-2-4 reference tag: %s", tagMatches ? "ok" : "MISMATCH");
+  if (mac->calls != 0)
+  {
+    printf(", %u cycles, budget %u%s", mac->max, SIPHASH_CYCLE_BUDGET,
+           mac->max > SIPHASH_CYCLE_BUDGET ? ", OVER BUDGET" : "");
+    failed |= mac->max > SIPHASH_CYCLE_BUDGET;
+  }
+  printf("\n");
+  failed |= !tagMatches;
+
+  /* Back-to-back frames keep every tick of the run sampling or decoding */
+  {
+    const uint32_t tick = SIM_FREQUENCY / (BAUD_RATES[BAUD_CODE_57600] * OVERSAMPLE);
+    const run_result_t result = runScenario(avr, BAUD_CODE_57600, TRAFFIC_BACK_TO_BACK, 0.0);
+    const probe_t *isr = &probes[PROBE_TIMER1_ISR];
+    printf("\nTimer1 ISR at %u baud, back-to-back: ", BAUD_RATES[BAUD_CODE_57600]);
+    if (isr->calls == 0 || result.crashed)
+    {
+      printf("not measured%s, budget %u cycles per tick\n", result.crashed ? ", CRASHED" : "", tick);
+    }
+    else
+    {
+      const uint32_t average = (uint32_t)(isr->total / isr->calls);
+      printf("max %u, avg %u cycles, budget %u cycles per tick, load %u%%, %u frame errors%s\n", isr->max, average,
+             tick, average * 100 / tick, result.rxErrors, isr->max > tick ? ", OVER BUDGET" : "");
+    }
+  }
+
+  uint32_t sustainable = 0;
+  if (sweep)
+  {
+    printf("\nbaud sweep, back-to-back traffic:\n");
+    for (uint8_t code = BAUD_CODE_SWEEP_FIRST; code < sizeof(BAUD_RATES) / sizeof(BAUD_RATES[0]); ++code)
+    {
+      const run_result_t result = runScenario(avr, code, TRAFFIC_BACK_TO_BACK, 0.0);
+      // A rate SoftSerial refuses in begin() receives nothing and reports no errors either
+      const int clean = !result.crashed && result.rxErrors == 0 && result.packets > 0;
+      printf("  %6u baud: %5u frame errors, %u packets, %u loop passes%s\n", BAUD_RATES[code],
+             result.rxErrors, result.packets, result.loopPasses, result.crashed ? ", CRASHED" : "");
+      if (!clean)
+        break;
+      sustainable = BAUD_RATES[code];
+    }
+    printf("maximum sustainable baud: %u\n", sustainable);
+  }
+
+  if (json != NULL)
+  {
+    fprintf(json, "  },\n  \"max_sustainable_baud\": %u\n}\n", sustainable);
+    fclose(json);
+  }
+  return failed ? 1 : 0;
+}
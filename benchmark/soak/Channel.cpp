@@ -0,0 +1,187 @@
+/**
+ * @file Channel.cpp
+ * @brief Implementation of the simulated lossy link.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "Channel.h"
+#include <string.h>
+#include <algorithm>
+
+/// Frame start marker of the CRC link
+constexpr uint8_t FRAME_START = 0xAA;
+/// Header bytes: start, packet number, type, length and channel
+constexpr size_t FRAME_HEADER = 4;
+/// Footer bytes: CRC and stop
+constexpr size_t FRAME_FOOTER = 3;
+/// Payload of control frames and of DATA of payload size class 0
+constexpr size_t FRAME_BASE_PAYLOAD = 8;
+/// Type byte: packet type bits
+constexpr uint8_t TYPE_MASK = 0x0F;
+/// Type byte: DATA
+constexpr uint8_t TYPE_DATA = 0x00;
+/// Type byte: ACK
+constexpr uint8_t TYPE_ACK = 0x01;
+/// Type byte: RESET
+constexpr uint8_t TYPE_RESET = 0x03;
+/// Type byte: ackNumber follows the payload of a DATA frame
+constexpr uint8_t TYPE_ACK_FLAG = 0x40;
+/// Type byte: payload size class position
+constexpr uint8_t TYPE_CLASS_SHIFT = 4;
+/// Largest payload size class
+constexpr uint8_t TYPE_MAX_CLASS = 2;
+/// Line bits per byte: start, 8 data, stop
+constexpr double BITS_PER_BYTE = 10.0;
+
+Channel::Channel(const ChannelConfig &config, const uint32_t seed)
+    : m_config(config), m_statistic(), m_random(seed), m_lineFreeAt(0), m_lastDelivery(0)
+{
+}
+
+void Channel::send(const uint8_t *data, const size_t length, const double now)
+{
+  m_statistic.bytes += length;
+  for (size_t i = 0; i < length; ++i)
+  {
+    if (m_assembly.empty() && data[i] != FRAME_START)
+    {
+      // Nothing to cut on, pass the byte on by itself
+      ++m_statistic.unframed;
+      transmit(std::vector<uint8_t>(1, data[i]), now);
+      continue;
+    }
+
+    m_assembly.push_back(data[i]);
+    const size_t frameSize = frameLength();
+    if (frameSize != 0 && m_assembly.size() == frameSize)
+    {
+      ++m_statistic.frames;
+      const uint8_t type = m_assembly[2] & TYPE_MASK;
+      if (type == TYPE_RESET)
+      {
+        ++m_statistic.resets;
+      }
+      else if (type == TYPE_ACK && m_assembly[1] == 0)
+      {
+        ++m_statistic.resetAcks;
+      }
+      transmit(m_assembly, now);
+      m_assembly.clear();
+    }
+  }
+} // end send
+
+size_t Channel::receive(uint8_t *buffer, const size_t length, const double now)
+{
+  size_t count = 0;
+  while (count < length && !m_inFlight.empty() && m_inFlight.front().deliverAt <= now)
+  {
+    Frame &frame = m_inFlight.front();
+    const size_t chunk = std::min(length - count, frame.bytes.size() - frame.offset);
+    memcpy(buffer + count, frame.bytes.data() + frame.offset, chunk);
+    count += chunk;
+    frame.offset += chunk;
+    if (frame.offset == frame.bytes.size())
+    {
+      m_inFlight.pop_front();
+    }
+  }
+  return count;
+} // end receive
+
+void Channel::disconnect(const double now)
+{
+  m_statistic.cut += static_cast<uint32_t>(m_inFlight.size() + (m_assembly.empty() ? 0 : 1));
+  m_inFlight.clear();
+  m_assembly.clear();
+  // The new connection starts on an idle line
+  m_lineFreeAt = std::min(m_lineFreeAt, now);
+  m_lastDelivery = std::min(m_lastDelivery, now);
+} // end disconnect
+
+size_t Channel::frameLength() const
+{
+  if (m_assembly.size() < 3)
+  {
+    return 0;
+  }
+
+  // Same rules as CRCPackageInterface::payloadLength() and hasAckNumber()
+  const uint8_t type = m_assembly[2];
+  const uint8_t payloadClass = (type >> TYPE_CLASS_SHIFT) & 0x03;
+  const size_t payload = FRAME_BASE_PAYLOAD << ((payloadClass <= TYPE_MAX_CLASS) ? payloadClass : 0);
+  const size_t ackNumber = ((type & TYPE_MASK) == TYPE_DATA && (type & TYPE_ACK_FLAG)) ? 1 : 0;
+  return FRAME_HEADER + payload + ackNumber + FRAME_FOOTER;
+} // end frameLength
+
+void Channel::transmit(const std::vector<uint8_t> &frame, const double now)
+{
+  if (chance() < m_config.dropRate)
+  {
+    // Lost in the air, the line time is spent all the same
+    ++m_statistic.dropped;
+    if (m_config.baudRate != 0)
+    {
+      m_lineFreeAt = std::max(m_lineFreeAt, now) + frame.size() * BITS_PER_BYTE * 1000.0 / m_config.baudRate;
+    }
+    return;
+  }
+
+  const uint8_t copies = (chance() < m_config.duplicateRate) ? 2 : 1;
+  if (copies == 2)
+  {
+    ++m_statistic.duplicated;
+  }
+
+  for (uint8_t copy = 0; copy < copies; ++copy)
+  {
+    std::vector<uint8_t> delivered(frame);
+    bool flipped = false;
+    if (m_config.bitErrorRate > 0)
+    {
+      for (uint8_t &byte : delivered)
+      {
+        for (uint8_t bit = 0; bit < 8; ++bit)
+        {
+          if (chance() < m_config.bitErrorRate)
+          {
+            byte ^= static_cast<uint8_t>(1 << bit);
+            flipped = true;
+          }
+        }
+      }
+    }
+    if (flipped)
+    {
+      ++m_statistic.corrupted;
+    }
+    schedule(delivered, now);
+  }
+} // end transmit
+
+void Channel::schedule(const std::vector<uint8_t> &frame, const double now)
+{
+  double endOnLine = now;
+  if (m_config.baudRate != 0)
+  {
+    endOnLine = std::max(m_lineFreeAt, now) + frame.size() * BITS_PER_BYTE * 1000.0 / m_config.baudRate;
+    m_lineFreeAt = endOnLine;
+  }
+
+  // A serial link reorders nothing, so jitter only ever delays
+  const double jitter = (m_config.jitterMs > 0) ? chance() * m_config.jitterMs : 0;
+  m_lastDelivery = std::max(m_lastDelivery, endOnLine + m_config.latencyMs + jitter);
+
+  Frame queued;
+  queued.bytes = frame;
+  queued.deliverAt = m_lastDelivery;
+  queued.offset = 0;
+  m_inFlight.push_back(queued);
+} // end schedule
+
+double Channel::chance()
+{
+  return std::uniform_real_distribution<double>(0.0, 1.0)(m_random);
+} // end chance
@@ -0,0 +1,144 @@
+/**
+ * @file Channel.h
+ * @brief Simulated lossy link for the protocol soak test.
+ *
+ * This file defines the Channel class, one direction of the Bluetooth link
+ * between the keypad and the phone: it cuts the sender's bytes into CRC
+ * link frames, spends line time on them at the link baud rate, and drops,
+ * duplicates, corrupts and delays them before the receiver gets them. A
+ * disconnect cuts every frame on its way.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Impairments of one link direction.
+ */
+struct ChannelConfig
+{
+  double bitErrorRate;  ///< Probability of each delivered bit being flipped
+  double dropRate;      ///< Probability of a frame being lost
+  double duplicateRate; ///< Probability of a frame being delivered twice
+  double latencyMs;     ///< Delay between the end of a frame on the line and its delivery
+  double jitterMs;      ///< Uniform extra delay, 0 to this; frames stay in order
+  uint32_t baudRate;    ///< Line rate, 10 bits per byte; 0 for no limit
+};
+
+/**
+ * @brief Counters of one link direction.
+ */
+struct ChannelStatistic
+{
+  uint32_t frames;     ///< Frames the sender wrote
+  uint32_t bytes;      ///< Bytes the sender wrote
+  uint32_t dropped;    ///< Frames lost
+  uint32_t duplicated; ///< Frames delivered twice
+  uint32_t corrupted;  ///< Frames delivered with at least one flipped bit
+  uint32_t resets;     ///< RESET frames the sender wrote
+  uint32_t resetAcks;  ///< RESET-ACKs (ACK frames of packet number 0) the sender wrote
+  uint32_t unframed;   ///< Bytes written outside a frame (framing bug of the sender)
+  uint32_t cut;        ///< Frames on their way or half sent when the link dropped
+};
+
+/**
+ * @brief Class carrying one direction of the simulated link.
+ *
+ * send() takes the bytes a protocol end wrote; the frame layout (the
+ * payload size class and the ACK flag in the type byte) tells where each
+ * frame ends, so impairments hit whole frames the way a radio loses them.
+ * Delivered bytes come out of receive() once their time has come. Times are
+ * in milliseconds of the caller's clock.
+ */
+class Channel final
+{
+public:
+  /**
+   * @brief Constructor.
+   * @param config Impairments, copied.
+   * @param seed Seed of the random generator, so a run can be repeated.
+   */
+  Channel(const ChannelConfig &config, const uint32_t seed);
+
+  /**
+   * @brief Put bytes the sender wrote on the line.
+   * @param data The bytes.
+   * @param length Number of bytes.
+   * @param now Current time.
+   */
+  void send(const uint8_t *data, const size_t length, const double now);
+
+  /**
+   * @brief Take delivered bytes whose time has come.
+   * @param buffer Destination.
+   * @param length Room in buffer.
+   * @param now Current time.
+   * @return Bytes copied to buffer.
+   */
+  size_t receive(uint8_t *buffer, const size_t length, const double now);
+
+  /**
+   * @brief Drop the link: frames on their way are lost, half delivered ones too.
+   * @param now Current time.
+   */
+  void disconnect(const double now);
+
+  /**
+   * @brief Counters since construction.
+   */
+  const ChannelStatistic &getStatistic() const { return m_statistic; }
+
+private:
+  /**
+   * @brief A frame on its way.
+   */
+  struct Frame
+  {
+    std::vector<uint8_t> bytes; ///< Frame as delivered
+    double deliverAt;           ///< Time the receiver gets it
+    size_t offset;              ///< Bytes already taken by receive()
+  };
+
+  /**
+   * @brief Length of the frame starting in m_assembly, once its type byte is in.
+   * @return Frame length in bytes, 0 if the header is incomplete.
+   */
+  size_t frameLength() const;
+
+  /**
+   * @brief Impair a complete frame and queue it for delivery.
+   * @param frame The frame as sent.
+   * @param now Current time.
+   */
+  void transmit(const std::vector<uint8_t> &frame, const double now);
+
+  /**
+   * @brief Queue one copy of a frame after the line time it takes.
+   * @param frame The frame as delivered.
+   * @param now Current time.
+   */
+  void schedule(const std::vector<uint8_t> &frame, const double now);
+
+  /**
+   * @brief Draw a uniform number in [0, 1).
+   */
+  double chance();
+
+  ChannelConfig m_config;          ///< Impairments
+  ChannelStatistic m_statistic;    ///< Counters
+  std::mt19937 m_random;           ///< Impairment generator
+  std::vector<uint8_t> m_assembly; ///< Bytes of the frame being sent
+  std::deque<Frame> m_inFlight;    ///< Frames on their way, in order
+  double m_lineFreeAt;             ///< Time the line finishes the frames sent so far
+  double m_lastDelivery;           ///< Delivery time of the newest frame
+}; // end Channel class
+
+#endif
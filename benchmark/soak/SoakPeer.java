@@ -0,0 +1,191 @@
+/**
+ * Phone end of the protocol soak test.
+ * <p>
+ * Runs the app's CRCPackageInterface on stdin/stdout, which the soak
+ * harness connects to its simulated link, and sends every byte received on
+ * CHANNEL_COMMAND straight back. Protocol errors go to stderr, one line
+ * each, prefixed with "error ", for the harness to count; "ready" follows
+ * the first RESET.
+ * <p>
+ * File descriptor 3 carries the link drops of --disconnect: on "down" the
+ * connection closes and the interface is suspended ("suspended"), on "up"
+ * it resumes over a new connection, as MainActivity does after an ACL
+ * disconnect, and reports "resumed true" or "resumed false".
+ * <p>
+ * Build: javac -d .pio/soak lib/Packager/CRCPackageInterface.java benchmark/soak/SoakPeer.java
+ *
+ * @author Aykut ÖZDEMİR
+ */
+package com.goldenhorn.k810security;
+
+import java.io.BufferedReader;
+import java.io.FileDescriptor;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.io.OutputStream;
+import java.io.PipedInputStream;
+import java.io.PipedOutputStream;
+import java.io.PrintStream;
+
+public class SoakPeer {
+    /** Longest wait for received data before waiting again (milliseconds) */
+    private static final long AWAIT_TIMEOUT_MS = 1000;
+    /** Bytes echoed per read, without allocating */
+    private static final int ECHO_BUFFER_SIZE = 256;
+    /** Bytes moved from stdin to the connection per read */
+    private static final int PUMP_BUFFER_SIZE = 256;
+    /** Bytes a connection buffers between stdin and the interface's reader */
+    private static final int CONNECTION_BUFFER_SIZE = 4096;
+    /** Harness commands, one line per link drop and reconnect */
+    private static final String CONTROL_PATH = "/dev/fd/3";
+
+    /**
+     * One connection over stdin/stdout, like the socket of an ACL link
+     * <p>
+     * The stdin pump feeds it while it is open. Once closed, bytes from
+     * stdin are dropped and bytes written go nowhere, the way a radio link
+     * that is gone loses them; a reconnect brings a new one.
+     */
+    private static final class Connection {
+        /** Interface's receive stream */
+        final PipedInputStream input;
+        /** Pump's end of input */
+        final PipedOutputStream feed;
+        /** Interface's send stream, stdout while open */
+        final OutputStream output;
+        /** Cleared by close() */
+        volatile boolean open = true;
+
+        Connection(OutputStream line) throws IOException {
+            input = new PipedInputStream(CONNECTION_BUFFER_SIZE);
+            feed = new PipedOutputStream(input);
+            output = new OutputStream() {
+                @Override
+                public void write(int b) throws IOException {
+                    if (open) line.write(b);
+                }
+
+                @Override
+                public void write(byte[] b, int off, int len) throws IOException {
+                    if (open) line.write(b, off, len);
+                }
+            };
+        }
+
+        /**
+         * Stops both directions; call before the interface is suspended
+         */
+        void close() {
+            open = false;
+        }
+
+        /**
+         * Fails a pump blocked on a full connection; call once the interface's reader is gone
+         */
+        void release() {
+            try {
+                input.close();
+            } catch (IOException ignored) {
+                // Nothing left to read it
+            }
+        }
+    }
+
+    /** Connection in use, replaced on every reconnect */
+    private static volatile Connection connection;
+
+    public static void main(String[] args) throws IOException, InterruptedException {
+        // Unbuffered, the protocol flushes every frame itself
+        FileInputStream input = new FileInputStream(FileDescriptor.in);
+        FileOutputStream output = new FileOutputStream(FileDescriptor.out);
+        PrintStream report = new PrintStream(new FileOutputStream(FileDescriptor.err), true);
+
+        connection = new Connection(output);
+        Thread pump = new Thread(() -> pumpInput(input), "Soak-Input-Thread");
+        pump.setDaemon(true);
+        pump.start();
+
+        CRCPackageInterface link = new CRCPackageInterface(connection.input, connection.output);
+        link.setErrorCallback(error -> report.println("error " + error));
+        link.start();
+        // As MainActivity does once the socket is up
+        link.sendResetPacket();
+        report.println("ready");
+
+        Thread control = new Thread(() -> followLink(link, output, report), "Soak-Control-Thread");
+        control.setDaemon(true);
+        control.start();
+
+        // The harness ends the test by killing the process
+        byte[] received = new byte[ECHO_BUFFER_SIZE];
+        while (true) {
+            if (!link.awaitData(CRCPackageInterface.CHANNEL_COMMAND, AWAIT_TIMEOUT_MS)) continue;
+            int length = link.readData(CRCPackageInterface.CHANNEL_COMMAND, received, 0, received.length);
+            if (length > 0) {
+                link.sendData(received, length);
+            }
+        }
+    }
+
+    /**
+     * Moves stdin to the open connection, dropping what arrives while it is closed
+     *
+     * @param input stdin
+     */
+    private static void pumpInput(FileInputStream input) {
+        byte[] buffer = new byte[PUMP_BUFFER_SIZE];
+        try {
+            int count;
+            while ((count = input.read(buffer)) >= 0) {
+                Connection current = connection;
+                if (!current.open) continue;
+                try {
+                    current.feed.write(buffer, 0, count);
+                } catch (IOException e) {
+                    // Closed while writing: the bytes were in the air
+                }
+            }
+        } catch (IOException e) {
+            // The harness is gone
+        }
+    }
+
+    /**
+     * Follows the harness's "down" and "up" lines on CONTROL_PATH
+     *
+     * @param link   The interface
+     * @param output stdout, the send line of every connection
+     * @param report stderr
+     */
+    private static void followLink(CRCPackageInterface link, FileOutputStream output, PrintStream report) {
+        try (BufferedReader commands = new BufferedReader(new InputStreamReader(new FileInputStream(CONTROL_PATH)))) {
+            String command;
+            while ((command = commands.readLine()) != null) {
+                if (command.equals("down")) {
+                    Connection dropped = connection;
+                    dropped.close();
+                    link.suspend();
+                    dropped.release();
+                    // Nothing reaches stdout after this line
+                    report.println("suspended");
+                } else if (command.equals("up")) {
+                    Connection next = new Connection(output);
+                    connection = next;
+                    try {
+                        link.resume(next.input, next.output)
+                                .thenAccept(resumed -> report.println("resumed " + resumed));
+                    } catch (IOException e) {
+                        report.println("error Resume: " + e.getMessage());
+                        report.println("resumed false");
+                    }
+                } else {
+                    report.println("unknown control " + command);
+                }
+            }
+        } catch (IOException e) {
+            // Started without the control descriptor: the link never drops
+        }
+    }
+}
@@ -0,0 +1,699 @@
+/**
+ * @file main.cpp
+ * @brief Protocol soak test: the firmware's CRCPackageInterface against the app's.
+ *
+ * The keypad end is the C++ CRCPackageInterface, built for the host with
+ * the benchmark shims. The phone end is CRCPackageInterface.java, run by
+ * SoakPeer in a JVM whose stdin and stdout are the two directions of a
+ * simulated link (see Channel) with the rate of the HC05 link, bit errors,
+ * frame loss, duplication and latency. The peer echoes everything it
+ * receives, so each command the keypad end sends comes back through both
+ * implementations; the harness checks it byte for byte and times it.
+ *
+ * With --disconnect the link drops while commands are in flight, as an ACL
+ * link does: the keypad end sees setConnected(false), the peer suspends its
+ * interface, and every frame on its way is lost. After --down the link comes
+ * back, the peer calls resume() on a new connection, and the session must
+ * carry on: no command lost, none delivered twice.
+ *
+ * The report gives the goodput, the command round-trip percentiles, the
+ * retries of both ends, RESET and resync events, the drops and resumed
+ * sessions, and every command that was lost, corrupted or delivered twice.
+ * Exit status 1 means the two implementations disagreed: a command came
+ * back corrupted or twice, or a sender wrote bytes outside a frame. With
+ * --disconnect a lost command or a session the keypad did not resume fails
+ * the run as well.
+ *
+ * Window, payload size and timeouts of the keypad end are the build flags
+ * of the soak environment (CRC_PACKAGE_MAX_WINDOW, CRC_PACKAGE_MAX_PAYLOAD);
+ * the run's options are listed by --help.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <Arduino.h>
+
+// Third-party libraries
+#include <CRCPackageInterface.h>
+#include <LoopClock.h>
+#include <PipedStream.h>
+
+// System
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Project headers
+#include "Channel.h"
+
+/// Time between the keypad's first RESET-ACK and the first command
+constexpr double WARMUP_MS = 500;
+
+/// Bytes moved per pipe read or write
+constexpr size_t CHUNK_SIZE = 256;
+
+/// Shortest command: 8 hex digits of sequence number, a space and the newline
+constexpr size_t MIN_COMMAND_SIZE = 10;
+
+/**
+ * @brief Options of one run.
+ */
+struct SoakConfig
+{
+  double durationS;      ///< Length of the load phase
+  size_t commandSize;    ///< Bytes per command, newline included
+  size_t outstanding;    ///< Commands in flight at once
+  double timeoutMs;      ///< Round trip after which a command counts as lost
+  double disconnectMs;   ///< Time from a reconnect to the next drop, 0 for none
+  double downMs;         ///< Time the link stays down
+  uint32_t seed;         ///< Seed of both channels
+  const char *peer;      ///< Shell command starting SoakPeer
+  ChannelConfig channel; ///< Impairments, the same both ways
+};
+
+/**
+ * @brief Counts of the commands sent.
+ */
+struct CommandStatistic
+{
+  uint32_t sent;       ///< Commands written to the keypad end
+  uint32_t answered;   ///< Came back intact
+  uint32_t lost;       ///< Not back within the timeout
+  uint32_t late;       ///< Came back intact after its timeout
+  uint32_t corrupted;  ///< Came back with different bytes
+  uint32_t duplicated; ///< Came back more than once
+};
+
+/**
+ * @brief Protocol errors the Java end reported, by message.
+ */
+struct PeerStatistic
+{
+  uint32_t retries;      ///< "Retry": retransmission
+  uint32_t maxRetry;     ///< "MaxRetry": window or RESET given up
+  uint32_t numberResets; ///< "ResetNum": sequence numbers reset
+  uint32_t rejected;     ///< NackReason names: frame rejected
+  uint32_t other;        ///< Anything else, printed as it comes
+  uint32_t suspended;    ///< "suspended": interface suspended after a drop
+  uint32_t resumed;      ///< "resumed true": the keypad continued the session
+  uint32_t newSessions;  ///< "resumed false": the keypad started a new session
+};
+
+/**
+ * @brief The JVM running SoakPeer and our ends of its standard streams.
+ */
+struct PeerProcess
+{
+  pid_t pid;  ///< Process ID
+  int input;  ///< Its stdin, the phone's receive line
+  int output; ///< Its stdout, the phone's send line
+  int errors;  ///< Its stderr, one report line per event
+  int control; ///< Its file descriptor 3, one "down" or "up" line per link drop and reconnect
+};
+
+static PipedStreamPairN<256> keypadPipes;
+static CRCPackageInterface keypadLink(keypadPipes);
+
+//================ Peer ==================
+
+/**
+ * @brief Start the peer through the shell, its three streams non-blocking on our side.
+ * @param command Shell command.
+ * @param peer Filled in.
+ * @return false if the process could not be started.
+ */
+static bool startPeer(const char *command, PeerProcess &peer)
+{
+  int input[2], output[2], errors[2], control[2];
+  if (pipe(input) != 0 || pipe(output) != 0 || pipe(errors) != 0 || pipe(control) != 0)
+  {
+    perror("pipe");
+    return false;
+  }
+
+  peer.pid = fork();
+  if (peer.pid < 0)
+  {
+    perror("fork");
+    return false;
+  }
+  if (peer.pid == 0)
+  {
+    dup2(input[0], STDIN_FILENO);
+    dup2(output[1], STDOUT_FILENO);
+    dup2(errors[1], STDERR_FILENO);
+    dup2(control[0], 3);
+    close(input[1]);
+    close(output[0]);
+    close(errors[0]);
+    close(control[1]);
+    execl("/bin/sh", "sh", "-c", command, static_cast<char *>(nullptr));
+    _exit(127);
+  }
+
+  close(input[0]);
+  close(output[1]);
+  close(errors[1]);
+  close(control[0]);
+  peer.input = input[1];
+  peer.output = output[0];
+  peer.errors = errors[0];
+  peer.control = control[1];
+  fcntl(peer.input, F_SETFL, O_NONBLOCK);
+  fcntl(peer.output, F_SETFL, O_NONBLOCK);
+  fcntl(peer.errors, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+/**
+ * @brief Stop the peer and collect it.
+ * @param peer The peer.
+ */
+static void stopPeer(PeerProcess &peer)
+{
+  kill(peer.pid, SIGTERM);
+  waitpid(peer.pid, nullptr, 0);
+  close(peer.input);
+  close(peer.output);
+  close(peer.errors);
+  close(peer.control);
+}
+
+/**
+ * @brief Tell the peer the link dropped ("down") or came back ("up").
+ * @param peer The peer.
+ * @param line The line, without newline.
+ */
+static void signalPeer(const PeerProcess &peer, const char *line)
+{
+  // A few bytes into an empty pipe, they always fit
+  const std::string text = std::string(line) + '\n';
+  if (write(peer.control, text.data(), text.size()) != static_cast<ssize_t>(text.size()))
+  {
+    perror("soak: peer control");
+  }
+}
+
+/**
+ * @brief Count one report line of the peer.
+ * @param line The line, without newline.
+ * @param statistic Counters.
+ * @param ready Set on "ready".
+ */
+static void parsePeerLine(const std::string &line, PeerStatistic &statistic, bool &ready)
+{
+  static const char *const REJECT_REASONS[] = {"INVALID_CRC", "INVALID_START_STOP", "INVALID_TYPE", "INVALID_LENGTH",
+                                               "UNKNOWN_ERROR"};
+  if (line == "ready")
+  {
+    ready = true;
+    return;
+  }
+  if (line == "suspended")
+  {
+    ++statistic.suspended;
+    return;
+  }
+  if (line == "resumed true")
+  {
+    ++statistic.resumed;
+    return;
+  }
+  if (line == "resumed false")
+  {
+    ++statistic.newSessions;
+    return;
+  }
+  if (line.compare(0, 6, "error ") == 0)
+  {
+    const std::string error = line.substr(6);
+    if (error.find("MaxRetry") != std::string::npos)
+    {
+      ++statistic.maxRetry;
+      return;
+    }
+    if (error.find("Retry") != std::string::npos)
+    {
+      ++statistic.retries;
+      return;
+    }
+    if (error.find("ResetNum") != std::string::npos)
+    {
+      ++statistic.numberResets;
+      return;
+    }
+    for (const char *reason : REJECT_REASONS)
+    {
+      if (error.find(reason) != std::string::npos)
+      {
+        ++statistic.rejected;
+        return;
+      }
+    }
+  }
+  ++statistic.other;
+  fprintf(stderr, "peer: %s\n", line.c_str());
+}
+
+//================ Commands ==================
+
+/**
+ * @brief Byte @p index of command @p sequence, so every byte can be checked.
+ */
+static char commandFiller(const uint32_t sequence, const size_t index)
+{
+  return static_cast<char>('a' + (sequence + index) % 26);
+}
+
+/**
+ * @brief Build command @p sequence: its number in hex, a space, filler and a newline.
+ * @param sequence Sequence number.
+ * @param size Bytes, newline included.
+ * @return The command.
+ */
+static std::string makeCommand(const uint32_t sequence, const size_t size)
+{
+  char number[9];
+  snprintf(number, sizeof(number), "%08X", sequence);
+  std::string command(number);
+  command += ' ';
+  while (command.size() < size - 1)
+  {
+    command += commandFiller(sequence, command.size());
+  }
+  command += '\n';
+  return command;
+}
+
+/**
+ * @brief Check a line that came back against the command it names.
+ * @param line The line, without newline.
+ * @param size Bytes per command, newline included.
+ * @param sequence Set to the command's sequence number.
+ * @return false if the line is no command of this run.
+ */
+static bool parseCommand(const std::string &line, const size_t size, uint32_t &sequence)
+{
+  if (line.size() != size - 1 || line[8] != ' ')
+  {
+    return false;
+  }
+  char *end = nullptr;
+  const std::string number = line.substr(0, 8);
+  sequence = static_cast<uint32_t>(strtoul(number.c_str(), &end, 16));
+  if (*end != '\0')
+  {
+    return false;
+  }
+  return line + '\n' == makeCommand(sequence, size);
+}
+
+//================ Report ==================
+
+/**
+ * @brief Percentile of sorted samples, nearest rank.
+ */
+static double percentile(const std::vector<double> &sorted, const double fraction)
+{
+  if (sorted.empty())
+  {
+    return 0;
+  }
+  const size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+  return sorted[rank];
+}
+
+static void printChannel(const char *name, const ChannelStatistic &statistic)
+{
+  printf("%-16s %u frames, %u bytes, %u RESET, %u RESET-ACK, %u dropped, %u duplicated, %u corrupted",
+         name, statistic.frames, statistic.bytes, statistic.resets, statistic.resetAcks, statistic.dropped,
+         statistic.duplicated, statistic.corrupted);
+  if (statistic.unframed != 0)
+  {
+    printf(", %u bytes outside a frame", statistic.unframed);
+  }
+  if (statistic.cut != 0)
+  {
+    printf(", %u cut by drops", statistic.cut);
+  }
+  printf("\n");
+}
+
+static void printReport(const SoakConfig &config, const double elapsedMs, const CommandStatistic &commands,
+                        std::vector<double> &latencies, const Channel &toPhone, const Channel &toKeypad,
+                        const PeerStatistic &peer, const uint32_t drops)
+{
+  std::sort(latencies.begin(), latencies.end());
+  const double seconds = elapsedMs / 1000.0;
+  const double goodput = commands.answered * config.commandSize / seconds;
+  const CRCPackageInterface::LinkStatistic &link = keypadLink.getLinkStatistic();
+
+  printf("\n%-16s %.1f s at %u baud, BER %g, drop %g, duplicate %g, latency %.1f+%.1f ms\n", "run", seconds,
+         config.channel.baudRate, config.channel.bitErrorRate, config.channel.dropRate,
+         config.channel.duplicateRate, config.channel.latencyMs, config.channel.jitterMs);
+  printf("%-16s %u sent, %u answered, %u lost, %u late, %u corrupted, %u duplicated\n", "commands",
+         commands.sent, commands.answered, commands.lost, commands.late, commands.corrupted, commands.duplicated);
+  printf("%-16s %.1f B/s each way", "goodput", goodput);
+  if (config.channel.baudRate != 0)
+  {
+    printf(" (%.1f%% of the line)", goodput * 1000.0 / config.channel.baudRate);
+  }
+  printf("\n");
+  printf("%-16s p50 %.1f, p90 %.1f, p99 %.1f, max %.1f ms\n", "round trip", percentile(latencies, 0.5),
+         percentile(latencies, 0.9), percentile(latencies, 0.99), latencies.empty() ? 0.0 : latencies.back());
+  if (drops != 0)
+  {
+    printf("%-16s %u drops of %.0f ms, %u resumed, %u new sessions\n", "sessions", drops, config.downMs,
+           peer.resumed, peer.newSessions);
+  }
+  printChannel("keypad->phone", toPhone.getStatistic());
+  printChannel("phone->keypad", toKeypad.getStatistic());
+  printf("%-16s %u retries, %u gave up, %u NACKs, %u resyncs, rejected %u CRC %u framing %u type %u length, "
+         "peak RTT %u ms\n",
+         "keypad (C++)", link.retries, link.maxRetryDrops, link.nacksReceived, link.resyncs, link.rejected[0],
+         link.rejected[1], link.rejected[2], link.rejected[3], link.peakRtt);
+  printf("%-16s %u retries, %u gave up, %u numbering resets, %u rejected, %u other errors\n", "phone (Java)",
+         peer.retries, peer.maxRetry, peer.numberResets, peer.rejected, peer.other);
+}
+
+//================ Run ==================
+
+static void usage(const char *program)
+{
+  fprintf(stderr,
+          "usage: %s [options]\n"
+          "  --duration s      load phase (default 30)\n"
+          "  --ber rate        bit error rate (default 0)\n"
+          "  --drop rate       frame loss rate (default 0)\n"
+          "  --duplicate rate  frame duplication rate (default 0)\n"
+          "  --latency ms      one-way delay (default 20)\n"
+          "  --jitter ms       extra delay up to this (default 10)\n"
+          "  --baud rate       link rate, 0 = unlimited (default 38400)\n"
+          "  --size bytes      command size, newline included (default 16)\n"
+          "  --outstanding n   commands in flight (default 1)\n"
+          "  --timeout ms      round trip counted as lost (default 5000)\n"
+          "  --disconnect ms   drop the link this long after each reconnect, 0 = never (default 0)\n"
+          "  --down ms         time the link stays down (default 1000)\n"
+          "  --seed n          channel seed (default 1)\n"
+          "  --peer command    shell command starting SoakPeer\n",
+          program);
+}
+
+int main(int argc, char *argv[])
+{
+  SoakConfig config;
+  config.durationS = 30;
+  config.commandSize = 16;
+  config.outstanding = 1;
+  config.timeoutMs = 5000;
+  config.disconnectMs = 0;
+  config.downMs = 1000;
+  config.seed = 1;
+  config.peer = "java -cp .pio/soak com.goldenhorn.k810security.SoakPeer";
+  config.channel.bitErrorRate = 0;
+  config.channel.dropRate = 0;
+  config.channel.duplicateRate = 0;
+  config.channel.latencyMs = 20;
+  config.channel.jitterMs = 10;
+  config.channel.baudRate = 38400;
+
+  static const struct option OPTIONS[] = {
+      {"duration", required_argument, nullptr, 'd'},
+      {"ber", required_argument, nullptr, 'b'},
+      {"drop", required_argument, nullptr, 'l'},
+      {"duplicate", required_argument, nullptr, 'u'},
+      {"latency", required_argument, nullptr, 't'},
+      {"jitter", required_argument, nullptr, 'j'},
+      {"baud", required_argument, nullptr, 'r'},
+      {"size", required_argument, nullptr, 's'},
+      {"outstanding", required_argument, nullptr, 'o'},
+      {"timeout", required_argument, nullptr, 'w'},
+      {"disconnect", required_argument, nullptr, 'c'},
+      {"down", required_argument, nullptr, 'n'},
+      {"seed", required_argument, nullptr, 'e'},
+      {"peer", required_argument, nullptr, 'p'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  int option;
+  while ((option = getopt_long(argc, argv, "d:b:l:u:t:j:r:s:o:w:c:n:e:p:h", OPTIONS, nullptr)) != -1)
+  {
+    switch (option)
+    {
+    case 'd':
+      config.durationS = atof(optarg);
+      break;
+    case 'b':
+      config.channel.bitErrorRate = atof(optarg);
+      break;
+    case 'l':
+      config.channel.dropRate = atof(optarg);
+      break;
+    case 'u':
+      config.channel.duplicateRate = atof(optarg);
+      break;
+    case 't':
+      config.channel.latencyMs = atof(optarg);
+      break;
+    case 'j':
+      config.channel.jitterMs = atof(optarg);
+      break;
+    case 'r':
+      config.channel.baudRate = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+      break;
+    case 's':
+      config.commandSize = std::max(MIN_COMMAND_SIZE, static_cast<size_t>(strtoul(optarg, nullptr, 10)));
+      break;
+    case 'o':
+      config.outstanding = std::max(static_cast<size_t>(1), static_cast<size_t>(strtoul(optarg, nullptr, 10)));
+      break;
+    case 'w':
+      config.timeoutMs = atof(optarg);
+      break;
+    case 'c':
+      config.disconnectMs = atof(optarg);
+      break;
+    case 'n':
+      config.downMs = atof(optarg);
+      break;
+    case 'e':
+      config.seed = static_cast<uint32_t>(strtoul(optarg, nullptr, 10));
+      break;
+    case 'p':
+      config.peer = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+  PeerProcess peer;
+  if (!startPeer(config.peer, peer))
+  {
+    return 2;
+  }
+
+  // Different streams of impairments each way
+  Channel toPhone(config.channel, config.seed);
+  Channel toKeypad(config.channel, config.seed * 2654435761u + 1);
+
+  CommandStatistic commands = {};
+  PeerStatistic peerStatistic = {};
+  std::vector<double> latencies;
+  std::map<uint32_t, double> inFlight;
+  std::set<uint32_t> expired;
+  std::vector<uint8_t> toPeer;
+  std::string peerLines;
+  std::string echoed;
+  bool ready = false;
+  double loadStart = -1;
+  uint32_t nextSequence = 0;
+  uint8_t buffer[CHUNK_SIZE];
+  bool linkUp = true;
+  uint32_t drops = 0;
+  double nextDrop = -1;
+  double downUntil = 0;
+
+  printf("soak: waiting for the peer (%s)\n", config.peer);
+  while (true)
+  {
+    const double now = micros() / 1000.0;
+    LoopClock::tick();
+    keypadLink.loop();
+
+    // Keypad to phone; what the keypad wrote as the link dropped is lost in the air
+    const size_t sent = keypadLink.getEncodedStream().readBytes(buffer, sizeof(buffer));
+    if (linkUp)
+    {
+      toPhone.send(buffer, sent, now);
+    }
+    if (toPeer.empty())
+    {
+      const size_t delivered = toPhone.receive(buffer, sizeof(buffer), now);
+      toPeer.assign(buffer, buffer + delivered);
+    }
+    if (!toPeer.empty())
+    {
+      const ssize_t written = write(peer.input, toPeer.data(), toPeer.size());
+      if (written > 0)
+      {
+        toPeer.erase(toPeer.begin(), toPeer.begin() + written);
+      }
+    }
+
+    // Phone to keypad, no faster than the keypad's encoded stream takes it
+    const ssize_t received = read(peer.output, buffer, sizeof(buffer));
+    if (received > 0 && linkUp)
+    {
+      toKeypad.send(buffer, static_cast<size_t>(received), now);
+    }
+    const int room = keypadLink.getEncodedStream().availableForWrite();
+    if (room > 0)
+    {
+      const size_t delivered = toKeypad.receive(buffer, std::min(sizeof(buffer), static_cast<size_t>(room)), now);
+      keypadLink.getEncodedStream().write(buffer, delivered);
+    }
+
+    // Peer report lines
+    char text[CHUNK_SIZE];
+    const ssize_t reported = read(peer.errors, text, sizeof(text));
+    if (reported > 0)
+    {
+      peerLines.append(text, static_cast<size_t>(reported));
+      size_t newline;
+      while ((newline = peerLines.find('\n')) != std::string::npos)
+      {
+        parsePeerLine(peerLines.substr(0, newline), peerStatistic, ready);
+        peerLines.erase(0, newline + 1);
+      }
+    }
+    else if (reported == 0 || (reported < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+      fprintf(stderr, "soak: the peer exited\n");
+      stopPeer(peer);
+      return 2;
+    }
+
+    // Like the app, which only sends commands once the handshake ping came back
+    if (ready && loadStart < 0 && toPhone.getStatistic().resetAcks != 0)
+    {
+      loadStart = now + WARMUP_MS;
+      printf("soak: peer ready, %.0f s of load\n", config.durationS);
+    }
+    const bool loading = loadStart >= 0 && now >= loadStart && now < loadStart + config.durationS * 1000.0;
+
+    // Drop the link under load, so the window holds unacknowledged frames
+    if (config.disconnectMs > 0 && nextDrop < 0 && loadStart >= 0)
+    {
+      nextDrop = loadStart + config.disconnectMs;
+    }
+    if (linkUp && loading && nextDrop >= 0 && now >= nextDrop && !inFlight.empty())
+    {
+      linkUp = false;
+      ++drops;
+      downUntil = now + config.downMs;
+      toPhone.disconnect(now);
+      toKeypad.disconnect(now);
+      toPeer.clear();
+      keypadLink.setConnected(false);
+      signalPeer(peer, "down");
+    }
+    else if (!linkUp && now >= downUntil && peerStatistic.suspended == drops)
+    {
+      // The peer wrote nothing after "suspended"; what it wrote before is gone with the old connection
+      while (read(peer.output, buffer, sizeof(buffer)) > 0)
+      {
+      }
+      linkUp = true;
+      nextDrop = now + config.disconnectMs;
+      keypadLink.setConnected(true);
+      signalPeer(peer, "up");
+    }
+
+    // Commands that came back
+    const size_t count = keypadPipes.first.readBytes(buffer, sizeof(buffer));
+    echoed.append(reinterpret_cast<const char *>(buffer), count);
+    size_t newline;
+    while ((newline = echoed.find('\n')) != std::string::npos)
+    {
+      uint32_t sequence;
+      if (!parseCommand(echoed.substr(0, newline), config.commandSize, sequence))
+      {
+        ++commands.corrupted;
+      }
+      else if (inFlight.count(sequence) != 0)
+      {
+        latencies.push_back(now - inFlight[sequence]);
+        inFlight.erase(sequence);
+        ++commands.answered;
+      }
+      else if (expired.erase(sequence) != 0)
+      {
+        ++commands.late;
+      }
+      else
+      {
+        ++commands.duplicated;
+      }
+      echoed.erase(0, newline + 1);
+    }
+
+    // Give up on commands past the timeout, keep the load going
+    for (std::map<uint32_t, double>::iterator it = inFlight.begin(); it != inFlight.end();)
+    {
+      if (now - it->second > config.timeoutMs)
+      {
+        ++commands.lost;
+        expired.insert(it->first);
+        it = inFlight.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    // New commands
+    while (loading && inFlight.size() < config.outstanding &&
+           static_cast<size_t>(keypadPipes.first.availableForWrite()) >= config.commandSize)
+    {
+      const std::string command = makeCommand(nextSequence, config.commandSize);
+      keypadPipes.first.write(reinterpret_cast<const uint8_t *>(command.data()), command.size());
+      inFlight[nextSequence++] = now;
+      ++commands.sent;
+    }
+
+    // Done once the load phase is over, the last commands are back or lost and the last resume is answered
+    const bool settled = linkUp && peerStatistic.resumed + peerStatistic.newSessions == drops;
+    if (loadStart >= 0 && !loading && now >= loadStart && inFlight.empty() && settled)
+    {
+      printReport(config, now - loadStart, commands, latencies, toPhone, toKeypad, peerStatistic, drops);
+      break;
+    }
+
+    struct pollfd fds[2] = {{peer.output, POLLIN, 0}, {peer.errors, POLLIN, 0}};
+    poll(fds, 2, 1);
+  }
+
+  stopPeer(peer);
+  const bool disagreed = commands.corrupted != 0 || commands.duplicated != 0 ||
+                         toPhone.getStatistic().unframed != 0 || toKeypad.getStatistic().unframed != 0;
+  // A resumed session loses nothing, the drop only delays it
+  const bool resumeFailed = drops != 0 && (commands.lost != 0 || peerStatistic.newSessions != 0 ||
+                                           peerStatistic.resumed != drops);
+  return (disagreed || resumeFailed) ? 1 : 0;
+}
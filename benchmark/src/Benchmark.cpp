@@ -0,0 +1,75 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Implementation of the host benchmark harness.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "Benchmark.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+uint32_t Benchmark::s_allocations = 0;
+
+void Benchmark::printHeader()
+{
+  printf("%-40s %12s %12s %12s\n", "benchmark", "ns/op", "MB/s", "allocs/op");
+} // end printHeader
+
+void Benchmark::report(const char *name, const size_t bytesPerOperation, const uint32_t operations,
+                       const double nanoseconds, const uint32_t allocations)
+{
+  const double perOperation = nanoseconds / operations;
+  if (bytesPerOperation == 0)
+  {
+    printf("%-40s %12.1f %12s %12.2f\n", name, perOperation, "-",
+           static_cast<double>(allocations) / operations);
+  }
+  else
+  {
+    // Bytes per nanosecond times 1000 is MB/s
+    printf("%-40s %12.1f %12.2f %12.2f\n", name, perOperation,
+           bytesPerOperation * 1000.0 / perOperation,
+           static_cast<double>(allocations) / operations);
+  }
+  fflush(stdout);
+} // end report
+
+// Every heap allocation of the program goes through these
+void *operator new(size_t size)
+{
+  Benchmark::countAllocation();
+  void *block = malloc(size == 0 ? 1 : size);
+  if (block == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return block;
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *block) noexcept
+{
+  free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+  free(block);
+}
+
+void operator delete(void *block, size_t) noexcept
+{
+  free(block);
+}
+
+void operator delete[](void *block, size_t) noexcept
+{
+  free(block);
+}
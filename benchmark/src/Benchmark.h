@@ -0,0 +1,100 @@
+/**
+ * @file Benchmark.h
+ * @brief Minimal host benchmark harness.
+ *
+ * This file defines the Benchmark class, which times a loop body on the
+ * build machine and reports nanoseconds per operation, throughput and heap
+ * allocations per operation.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+
+/// Shortest run a measurement is scaled up to, in milliseconds
+#ifndef BENCHMARK_MIN_TIME_MS
+#define BENCHMARK_MIN_TIME_MS 200
+#endif
+
+/**
+ * @brief Class timing benchmark bodies and printing one line per result.
+ *
+ * run() calls the body with a growing operation count until one call takes
+ * BENCHMARK_MIN_TIME_MS, then reports that call. Heap allocations are
+ * counted through the global operator new, which Benchmark.cpp replaces.
+ */
+class Benchmark final
+{
+public:
+  /**
+   * @brief Print the column header.
+   */
+  static void printHeader();
+
+  /**
+   * @brief Time a body and print its result.
+   *
+   * @tparam Body Callable taking the number of operations to perform.
+   * @param name Result name.
+   * @param bytesPerOperation Payload bytes one operation moves, 0 for none.
+   * @param body The code under test.
+   */
+  template <typename Body>
+  static void run(const char *name, const size_t bytesPerOperation, Body body)
+  {
+    uint32_t operations = 1;
+    while (true)
+    {
+      const uint32_t allocations = s_allocations;
+      const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      body(operations);
+      const std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+      const double nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+
+      if (nanoseconds >= BENCHMARK_MIN_TIME_MS * 1e6 || operations >= (UINT32_MAX / 2))
+      {
+        report(name, bytesPerOperation, operations, nanoseconds, s_allocations - allocations);
+        return;
+      }
+      // Aim a little past the minimum so the next call is the last
+      const double scale = (nanoseconds > 0) ? (BENCHMARK_MIN_TIME_MS * 1.2e6 / nanoseconds) : 100.0;
+      operations = static_cast<uint32_t>(operations * ((scale < 2.0) ? 2.0 : (scale > 100.0 ? 100.0 : scale)));
+    }
+  }
+
+  /**
+   * @brief Keep a value alive so the compiler cannot drop the code computing it.
+   * @param value The value.
+   */
+  template <typename T>
+  static inline void keep(const T &value)
+  {
+    asm volatile("" : : "g"(&value) : "memory");
+  }
+
+  /**
+   * @brief Count one heap allocation, called by the replaced operator new.
+   */
+  static void countAllocation() { ++s_allocations; }
+
+private:
+  /**
+   * @brief Print one result line.
+   * @param name Result name.
+   * @param bytesPerOperation Payload bytes per operation.
+   * @param operations Operations timed.
+   * @param nanoseconds Time they took.
+   * @param allocations Heap allocations they made.
+   */
+  static void report(const char *name, const size_t bytesPerOperation, const uint32_t operations,
+                     const double nanoseconds, const uint32_t allocations);
+
+  static uint32_t s_allocations; ///< Heap allocations since start
+}; // end Benchmark class
+
+#endif
@@ -0,0 +1,687 @@
+/**
+ * @file main.cpp
+ * @brief Host benchmarks of the core libraries.
+ *
+ * Each suite drives one library the way the firmware does: the queues and
+ * buffers byte by byte, the pipes in blocks, two CRCPackageInterface ends
+ * connected back to back, SoftSerial looped from its TX pin to its RX pin
+ * through the emulated port registers, once with the firmware's fixed 8N1
+ * frame format and once with the runtime one, SerialCommands fed whole lines, and
+ * SipHash over lock/unlock challenges.
+ *
+ * Before its benchmarks the SoftSerial suite checks the ISR frame decode
+ * against a sender driven on the RX pin: every start phase, a fast and a slow
+ * bit clock, a broken stop bit and a glitch on the idle line. The program
+ * exits with 1 when a check fails or the loopback loses a byte.
+ *
+ * Run with `pio run -e native -t exec`. The numbers compare changes on the
+ * build machine; they are not AVR cycle counts.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <Arduino.h>
+
+// Third-party libraries
+#include <FastCircularQueue.h>
+#include <StringBuffer.h>
+#include <LoopbackStream.h>
+#include <PipedStream.h>
+#include <CRCPackageInterface.h>
+#include <LoopClock.h>
+#include <SoftSerial.h>
+#include <StaticSerialCommands.h>
+#include <SipHash.h>
+
+// Project headers
+#include "Benchmark.h"
+
+//================ FastCircularQueue ==================
+
+static void benchmarkFastCircularQueue()
+{
+  static FastCircularQueue<uint8_t, 64> bytes;
+  Benchmark::run("FastCircularQueue<uint8_t,64> push+pop", 1, [](uint32_t operations)
+                 {
+    uint8_t value = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      bytes.push(static_cast<uint8_t>(i));
+      bytes.pop(value);
+    }
+    Benchmark::keep(value); });
+
+  Benchmark::run("FastCircularQueue<uint8_t,64> fill+drain", 64, [](uint32_t operations)
+                 {
+    uint8_t value = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      while (bytes.push(value))
+      {
+        ++value;
+      }
+      while (bytes.pop(value))
+      {
+      }
+    }
+    Benchmark::keep(value); });
+
+  static FastCircularQueue<uint32_t, 256> words;
+  Benchmark::run("FastCircularQueue<uint32_t,256> push+pop", 4, [](uint32_t operations)
+                 {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      words.push(i);
+      words.pop(value);
+    }
+    Benchmark::keep(value); });
+}
+
+//================ StringBuffer ==================
+
+static void benchmarkStringBuffer()
+{
+  static const char line[] = "settrace crc 3\r\n";
+  static StringBuffer<32> buffer;
+
+  Benchmark::run("StringBuffer<32> append+indexOf+endsWith", sizeof(line) - 1, [](uint32_t operations)
+                 {
+    int found = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      buffer.clear();
+      buffer.append(line);
+      found += buffer.indexOf(' ');
+      found += buffer.indexOf("crc");
+      found += buffer.endsWith("\r\n");
+    }
+    Benchmark::keep(found); });
+
+  Benchmark::run("StringBuffer<32> append(F())+trim", sizeof(line) - 1, [](uint32_t operations)
+                 {
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      buffer.clear();
+      buffer.append(F("  settrace crc 3\r\n"));
+      buffer.trim();
+    }
+    Benchmark::keep(buffer); });
+
+  Benchmark::run("StringBuffer<32> toString", sizeof(line) - 1, [](uint32_t operations)
+                 {
+    buffer.clear();
+    buffer.append(line);
+    unsigned int length = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      length += buffer.toString().length();
+    }
+    Benchmark::keep(length); });
+}
+
+//================ LoopbackStream / PipedStream ==================
+
+/// Block size of the stream benchmarks, the size of a telemetry burst chunk
+constexpr size_t STREAM_BLOCK_SIZE = 64;
+
+static void benchmarkStreams()
+{
+  static uint8_t block[STREAM_BLOCK_SIZE];
+  for (size_t i = 0; i < sizeof(block); ++i)
+  {
+    block[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  static LoopbackStreamN<256> loopback;
+  Benchmark::run("LoopbackStream<256> write+read bytewise", STREAM_BLOCK_SIZE, [](uint32_t operations)
+                 {
+    int sum = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      for (size_t j = 0; j < sizeof(block); ++j)
+      {
+        loopback.write(block[j]);
+      }
+      while (loopback.available())
+      {
+        sum += loopback.read();
+      }
+    }
+    Benchmark::keep(sum); });
+
+  Benchmark::run("LoopbackStream<256> write+readBytes", STREAM_BLOCK_SIZE, [](uint32_t operations)
+                 {
+    uint8_t copy[STREAM_BLOCK_SIZE];
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      loopback.write(block, sizeof(block));
+      loopback.readBytes(copy, sizeof(copy));
+    }
+    Benchmark::keep(copy); });
+
+  static PipedStreamPairN<256> pipes;
+  Benchmark::run("PipedStream<256> write+readBytes", STREAM_BLOCK_SIZE, [](uint32_t operations)
+                 {
+    uint8_t copy[STREAM_BLOCK_SIZE];
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      pipes.first.write(block, sizeof(block));
+      pipes.second.readBytes(copy, sizeof(copy));
+    }
+    Benchmark::keep(copy); });
+
+  static PipedStreamPairN<256> downstream;
+  Benchmark::run("PipedStream<256> transfer pipe to pipe", STREAM_BLOCK_SIZE, [](uint32_t operations)
+                 {
+    uint8_t copy[STREAM_BLOCK_SIZE];
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      pipes.first.write(block, sizeof(block));
+      downstream.first.transfer(pipes.second, sizeof(block));
+      downstream.second.readBytes(copy, sizeof(copy));
+    }
+    Benchmark::keep(copy); });
+}
+
+//================ CRCPackageInterface ==================
+
+/// Plain bytes one link benchmark operation sends
+constexpr size_t LINK_MESSAGE_SIZE = 48;
+
+/// Pump rounds a message may take before the link counts as stuck
+constexpr uint16_t LINK_MAX_ROUNDS = 1000;
+
+static PipedStreamPairN<256> keypadPipes;
+static PipedStreamPairN<256> phonePipes;
+static CRCPackageInterface keypadLink(keypadPipes);
+static CRCPackageInterface phoneLink(phonePipes);
+
+/**
+ * @brief One main loop pass of both ends, the wire moving every byte at once.
+ */
+static void pumpLink()
+{
+  LoopClock::tick();
+  keypadLink.loop();
+  phoneLink.loop();
+  phoneLink.getEncodedStream().transfer(keypadLink.getEncodedStream(), 256);
+  keypadLink.getEncodedStream().transfer(phoneLink.getEncodedStream(), 256);
+}
+
+/**
+ * @brief Send a message from the keypad end and pump until the phone end has it.
+ * @param message The plain bytes.
+ * @param received Destination of the bytes the phone end delivers.
+ * @return false if the message did not arrive whole.
+ */
+static bool sendOverLink(const uint8_t *message, uint8_t *received)
+{
+  keypadPipes.first.write(message, LINK_MESSAGE_SIZE);
+  size_t count = 0;
+  for (uint16_t round = 0; round < LINK_MAX_ROUNDS && count < LINK_MESSAGE_SIZE; ++round)
+  {
+    pumpLink();
+    count += phonePipes.first.readBytes(received + count, LINK_MESSAGE_SIZE - count);
+  }
+  return count == LINK_MESSAGE_SIZE;
+}
+
+static void benchmarkCRCPackageInterface()
+{
+  // RESET handshake, so window, payload size and cumulative ACKs are negotiated
+  keypadLink.sendResetPacket();
+  for (uint16_t round = 0; round < LINK_MAX_ROUNDS; ++round)
+  {
+    pumpLink();
+  }
+
+  static uint8_t message[LINK_MESSAGE_SIZE];
+  for (size_t i = 0; i < sizeof(message); ++i)
+  {
+    message[i] = static_cast<uint8_t>('a' + i % 26);
+  }
+
+  static bool lost;
+  lost = false;
+  Benchmark::run("CRCPackageInterface send+receive", LINK_MESSAGE_SIZE, [](uint32_t operations)
+                 {
+    uint8_t received[LINK_MESSAGE_SIZE];
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      if (!sendOverLink(message, received) || memcmp(received, message, sizeof(message)) != 0)
+      {
+        lost = true;
+      }
+    }
+    Benchmark::keep(received); });
+
+  if (lost)
+  {
+    printf("  CRCPackageInterface: message lost or corrupted\n");
+  }
+
+  Benchmark::run("CRCPackageInterface idle pass", 0, [](uint32_t operations)
+                 {
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      pumpLink();
+    }
+  });
+}
+
+//================ SoftSerial ==================
+
+/// TX queue of the loopback ports, in bytes
+constexpr uint16_t SOFT_SERIAL_TX_BUFFER = 32;
+
+/// Loopback port: TX on pin 9 wired back to RX on pin 8, 8N1 fixed at compile time as in the firmware
+typedef SoftSerial<8, 9, 32, SOFT_SERIAL_TX_BUFFER, FixedFrameFormat<NONE, 1>> LoopbackSerial;
+
+/// The same port with the format chosen at run time, to show what the fixed format saves
+typedef SoftSerial<8, 9, 32, SOFT_SERIAL_TX_BUFFER, RuntimeFrameFormat> RuntimeLoopbackSerial;
+
+/// Bytes one SoftSerial benchmark operation sends
+constexpr uint8_t SOFT_SERIAL_BURST = 16;
+
+/// Timer ticks a burst may take: 10 bits of 3 ticks per byte, with margin
+constexpr uint16_t SOFT_SERIAL_MAX_TICKS = SOFT_SERIAL_BURST * 10 * 3 * 2;
+
+/// Timer ticks a burst takes on the line: 10 bits of 3 ticks per byte
+constexpr uint16_t SOFT_SERIAL_BURST_TICKS = SOFT_SERIAL_BURST * 10 * 3;
+
+static LoopbackSerial softSerial;
+static RuntimeLoopbackSerial runtimeSoftSerial;
+
+/**
+ * @brief Copy the TX pin's output bit to the RX pin's input bit.
+ */
+static inline void loopSoftSerialWire()
+{
+  static volatile uint8_t *const txPort = portOutputRegister(digitalPinToPort(9));
+  static volatile uint8_t *const rxPin = portInputRegister(digitalPinToPort(8));
+  static const uint8_t txMask = digitalPinToBitMask(9);
+  static const uint8_t rxMask = digitalPinToBitMask(8);
+
+  if (*txPort & txMask)
+  {
+    *rxPin |= rxMask;
+  }
+  else
+  {
+    *rxPin &= static_cast<uint8_t>(~rxMask);
+  }
+}
+
+/// Sender bit period of the decode checks in 1/256 timer ticks: 3 ticks per bit
+constexpr uint16_t SOFT_SERIAL_BIT_PERIOD = 3 * 256;
+
+/// Sender clock error of the fast and slow checks, 3% of the bit period
+constexpr uint16_t SOFT_SERIAL_CLOCK_SKEW = 23;
+
+/// Bit periods the line stays idle after the frames of a decode check
+constexpr uint8_t SOFT_SERIAL_IDLE_BITS = 20;
+
+/**
+ * @brief Build a 8N1 frame, start bit first.
+ * @param data Data byte.
+ * @param stop Level of the stop bit; false sends a framing error.
+ * @return Frame bits, bit 0 on the line first.
+ */
+static constexpr uint16_t softSerialFrame(const uint8_t data, const bool stop = true)
+{
+  return static_cast<uint16_t>((static_cast<uint16_t>(data) << 1) | (stop ? (1U << 9) : 0U));
+}
+
+/**
+ * @brief Drive frames back to back on the RX pin and run processISR() once per tick.
+ *
+ * The sender has its own bit clock: bitPeriod is in 1/256 ticks and its first
+ * start edge falls phase/256 ticks after the first tick. A tick reads the level
+ * the sender drives at that moment, the line idles high before and after.
+ *
+ * @param frames Frames from softSerialFrame().
+ * @param count Number of frames.
+ * @param bitPeriod Sender bit period in 1/256 ticks.
+ * @param phase Start edge offset in 1/256 ticks.
+ */
+static void driveSoftSerialRx(const uint16_t *frames, const uint8_t count, const uint16_t bitPeriod, const uint8_t phase)
+{
+  static volatile uint8_t *const rxPin = portInputRegister(digitalPinToPort(8));
+  static const uint8_t rxMask = digitalPinToBitMask(8);
+
+  const uint32_t frameBits = static_cast<uint32_t>(count) * 10;
+  const uint32_t end = phase + (frameBits + SOFT_SERIAL_IDLE_BITS) * bitPeriod;
+  for (uint32_t now = 0; now < end; now += 256)
+  {
+    bool level = true;
+    if (now >= phase)
+    {
+      const uint32_t bit = (now - phase) / bitPeriod;
+      if (bit < frameBits)
+      {
+        level = (frames[bit / 10] >> (bit % 10)) & 1;
+      }
+    }
+
+    if (level)
+    {
+      *rxPin |= rxMask;
+    }
+    else
+    {
+      *rxPin &= static_cast<uint8_t>(~rxMask);
+    }
+    softSerial.processISR();
+  }
+}
+
+/**
+ * @brief Check the received bytes and the bad frames counted since the last check.
+ * @param name Check printed on a failure.
+ * @param expected Bytes that must arrive, in order.
+ * @param count Number of expected bytes.
+ * @param errors True when the check must count at least one bad frame, false for none.
+ * @return True when the check passed.
+ */
+static bool expectSoftSerialRx(const char *name, const uint8_t *expected, const uint8_t count, const bool errors)
+{
+  static uint16_t errorCount = 0;
+
+  bool passed = softSerial.available() == count;
+  for (uint8_t i = 0; passed && i < count; ++i)
+  {
+    passed = softSerial.read() == expected[i];
+  }
+  while (softSerial.read() >= 0)
+  {
+  }
+
+  softSerial.loop();
+  const uint16_t counted = softSerial.getRxErrorCount();
+  passed &= (counted != errorCount) == errors;
+  errorCount = counted;
+
+  if (!passed)
+  {
+    printf("  SoftSerial decode: %s failed\n", name);
+  }
+  return passed;
+}
+
+/**
+ * @brief Regression checks of the ISR frame decode, run on an idle line after begin().
+ * @return True when every check passed.
+ */
+static bool checkSoftSerialDecode()
+{
+  static const uint8_t pattern[] = {0x00, 0xFF, 0x55, 0xAA, 0x01, 0x80, 0x0F, 0xF0};
+  constexpr uint8_t patternSize = sizeof(pattern);
+  uint16_t frames[patternSize];
+  for (uint8_t i = 0; i < patternSize; ++i)
+  {
+    frames[i] = softSerialFrame(pattern[i]);
+  }
+
+  bool passed = true;
+
+  // The start edge may fall anywhere between two ticks
+  for (uint8_t phase = 0; phase < 16; ++phase)
+  {
+    driveSoftSerialRx(frames, patternSize, SOFT_SERIAL_BIT_PERIOD, phase * 16);
+    passed &= expectSoftSerialRx("start phase", pattern, patternSize, false);
+  }
+
+  // A sender clock 3% off takes the edge corrections and the drift average
+  for (uint8_t round = 0; round < 4; ++round)
+  {
+    driveSoftSerialRx(frames, patternSize, SOFT_SERIAL_BIT_PERIOD + SOFT_SERIAL_CLOCK_SKEW, round * 64);
+    passed &= expectSoftSerialRx("slow sender", pattern, patternSize, false);
+  }
+  for (uint8_t round = 0; round < 4; ++round)
+  {
+    driveSoftSerialRx(frames, patternSize, SOFT_SERIAL_BIT_PERIOD - SOFT_SERIAL_CLOCK_SKEW, round * 64);
+    passed &= expectSoftSerialRx("fast sender", pattern, patternSize, false);
+  }
+
+  // A frame with a low stop bit is counted, not delivered, and the next frame still arrives
+  const uint16_t broken[] = {softSerialFrame(0x3C, false)};
+  driveSoftSerialRx(broken, 1, SOFT_SERIAL_BIT_PERIOD, 0);
+  passed &= expectSoftSerialRx("broken stop bit", nullptr, 0, true);
+  driveSoftSerialRx(frames, patternSize, SOFT_SERIAL_BIT_PERIOD, 0);
+  passed &= expectSoftSerialRx("frame after broken stop bit", pattern, patternSize, false);
+
+  // A one-tick low pulse on the idle line fails its start bit check
+  driveSoftSerialRx(broken, 0, SOFT_SERIAL_BIT_PERIOD, 0);
+  *portInputRegister(digitalPinToPort(8)) &= static_cast<uint8_t>(~digitalPinToBitMask(8));
+  softSerial.processISR();
+  driveSoftSerialRx(broken, 0, SOFT_SERIAL_BIT_PERIOD, 0);
+  passed &= expectSoftSerialRx("idle line glitch", nullptr, 0, true);
+
+  return passed;
+}
+
+/**
+ * @brief Loopback and idle benchmarks of one port.
+ *
+ * @tparam Port SoftSerial type.
+ * @param port The port, begun on the loopback pins.
+ * @param loopbackName Name of the loopback result.
+ * @param idleName Name of the idle line result.
+ * @return True when the loopback lost no byte.
+ */
+template <typename Port>
+static bool benchmarkSoftSerialLoopback(Port &port, const char *loopbackName, const char *idleName)
+{
+  loopSoftSerialWire();
+
+  bool lost = false;
+  Benchmark::run(loopbackName, SOFT_SERIAL_BURST, [&](uint32_t operations)
+                 {
+    uint8_t received = 0;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      for (uint8_t j = 0; j < SOFT_SERIAL_BURST; ++j)
+      {
+        port.write(static_cast<uint8_t>(i + j));
+      }
+      uint16_t tick = 0;
+      while (port.available() < SOFT_SERIAL_BURST && tick < SOFT_SERIAL_MAX_TICKS)
+      {
+        port.processISR();
+        loopSoftSerialWire();
+        ++tick;
+      }
+      for (uint8_t j = 0; j < SOFT_SERIAL_BURST; ++j)
+      {
+        const int data = port.read();
+        if (data != static_cast<uint8_t>(i + j))
+        {
+          lost = true;
+        }
+        received = static_cast<uint8_t>(data);
+      }
+      port.loop();
+    }
+    Benchmark::keep(received); });
+
+  if (lost)
+  {
+    printf("  SoftSerial: byte lost or corrupted\n");
+  }
+
+  Benchmark::run(idleName, 0, [&](uint32_t operations)
+                 {
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      port.processISR();
+    }
+  });
+
+  return !lost;
+}
+
+/**
+ * @brief SoftSerial decode checks, then the loopback and idle benchmarks of the fixed and the runtime format.
+ * @return True when the decode checks passed and neither loopback lost a byte.
+ */
+static bool benchmarkSoftSerial()
+{
+  // The firmware's timer runs at the oversampled bit period; here each processISR() call is one tick
+  softSerial.begin([](const unsigned long) {}, BAUD_38400);
+  const bool decoded = checkSoftSerialDecode();
+  const bool fixedPassed = benchmarkSoftSerialLoopback(softSerial,
+                                                       "SoftSerial loopback frame encode+decode",
+                                                       "SoftSerial processISR idle line");
+
+  // The ISR takes every byte from the TX queue itself, so a burst leaves without loop()
+  static bool stalled;
+  stalled = false;
+  Benchmark::run("SoftSerial processISR TX burst", SOFT_SERIAL_BURST, [](uint32_t operations)
+                 {
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      for (uint8_t j = 0; j < SOFT_SERIAL_BURST; ++j)
+      {
+        softSerial.write(static_cast<uint8_t>(i + j));
+      }
+      for (uint16_t tick = 0; tick < SOFT_SERIAL_BURST_TICKS; ++tick)
+      {
+        softSerial.processISR();
+      }
+      // The queue keeps one slot free
+      if (softSerial.availableForWrite() != SOFT_SERIAL_TX_BUFFER - 1)
+      {
+        stalled = true;
+      }
+    }
+  });
+
+  if (stalled)
+  {
+    printf("  SoftSerial: TX burst stalled without loop()\n");
+  }
+
+  // Both ports drive the same pins, one at a time
+  runtimeSoftSerial.begin([](const unsigned long) {}, BAUD_38400);
+  const bool runtimePassed = benchmarkSoftSerialLoopback(runtimeSoftSerial,
+                                                         "SoftSerial loopback, RuntimeFrameFormat",
+                                                         "SoftSerial idle line, RuntimeFrameFormat");
+
+  return decoded && fixedPassed && !stalled && runtimePassed;
+}
+
+//================ SerialCommands ==================
+
+static uint32_t pingCount;
+static int32_t setTotal;
+
+static void benchmarkPing(SerialCommands &sender, Args &args)
+{
+  (void)sender;
+  (void)args;
+  ++pingCount;
+}
+
+static void benchmarkSet(SerialCommands &sender, Args &args)
+{
+  (void)sender;
+  setTotal += args[0].getInt() + static_cast<int32_t>(strlen(args[1].getString()));
+}
+
+static const Command benchmarkCommands[] = {
+    COMMAND(benchmarkPing, "ping", NULL, "ping"),
+    COMMAND(benchmarkPing, "version", NULL, "display the version"),
+    COMMAND(benchmarkPing, "state", NULL, "state of the keypad"),
+    COMMAND(benchmarkSet, "settrace", ARG(ArgType::Int, 0, 100), ARG(ArgType::String), NULL, "set trace level for a component")};
+
+static PipedStreamPairN<128> commandPipes;
+static char commandBuffer[48];
+static SerialCommands commands(
+    commandPipes.second,
+    benchmarkCommands,
+    sizeof(benchmarkCommands) / sizeof(Command),
+    commandBuffer,
+    sizeof(commandBuffer) / sizeof(char));
+
+/**
+ * @brief Feed text lines to the parser and drain its replies.
+ * @param lines The lines, each ending in a newline.
+ * @param operations Times to feed them.
+ */
+static void feedCommands(const char *lines, const uint32_t operations)
+{
+  const size_t length = strlen(lines);
+  for (uint32_t i = 0; i < operations; ++i)
+  {
+    commandPipes.first.write(lines, length);
+    commands.readSerial();
+    while (commandPipes.first.read() >= 0)
+    {
+    }
+  }
+}
+
+static void benchmarkSerialCommands()
+{
+  static const char ping[] = "ping\n";
+  static const char settrace[] = "settrace 42 crc\n";
+
+  Benchmark::run("SerialCommands no-argument line", sizeof(ping) - 1, [](uint32_t operations)
+                 { feedCommands(ping, operations); });
+
+  Benchmark::run("SerialCommands two-argument line", sizeof(settrace) - 1, [](uint32_t operations)
+                 { feedCommands(settrace, operations); });
+
+  Benchmark::keep(pingCount);
+  Benchmark::keep(setTotal);
+}
+
+//================ SipHash ==================
+
+static void benchmarkSipHash()
+{
+  static uint8_t key[SipHash::KEY_LENGTH];
+  for (uint8_t i = 0; i < sizeof(key); ++i)
+  {
+    key[i] = i;
+  }
+
+  // A challenge: 8-byte nonce and the action byte
+  Benchmark::run("SipHash::mac() challenge", 9, [](uint32_t operations)
+                 {
+    uint8_t message[9] = {0};
+    uint8_t tag[SipHash::TAG_LENGTH];
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      message[0] = static_cast<uint8_t>(i);
+      SipHash::mac(key, message, sizeof(message), tag);
+    }
+    Benchmark::keep(tag); });
+
+  Benchmark::run("SipHash::equal() tag", SipHash::TAG_LENGTH, [](uint32_t operations)
+                 {
+    uint8_t tag[SipHash::TAG_LENGTH] = {0};
+    bool same = true;
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+      tag[0] = static_cast<uint8_t>(i);
+      same &= SipHash::equal(tag, key, sizeof(tag));
+    }
+    Benchmark::keep(same); });
+}
+
+int main()
+{
+  Benchmark::printHeader();
+  benchmarkFastCircularQueue();
+  benchmarkStringBuffer();
+  benchmarkStreams();
+  benchmarkCRCPackageInterface();
+  const bool softSerialPassed = benchmarkSoftSerial();
+  benchmarkSerialCommands();
+  benchmarkSipHash();
+  return softSerialPassed ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+import json
+import os
+import sys
+from SCons.Script import Import
+
+# Import PlatformIO's build environment
+Import("env")
+
+# Site table for trace_decoder.py, regenerated with every build so line numbers stay in sync
+project_dir = env.subst("$PROJECT_DIR")
+build_dir = env.subst("$BUILD_DIR")
+sys.path.insert(0, project_dir)
+from trace_decoder import build_site_table
+
+sites = build_site_table(project_dir)
+os.makedirs(build_dir, exist_ok=True)
+try:
+    with open(os.path.join(build_dir, "trace_sites.json"), "w") as f:
+        json.dump(sites, f, indent=1)
+    print(f"Generated trace site table with {len(sites)} sites")
+except IOError as e:
+    print(f"Error: Could not write trace site table ({e}).")
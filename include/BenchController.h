@@ -0,0 +1,97 @@
+/**
+ * @file BenchController.h
+ * @brief Loopback throughput and latency benchmark of the CRC link.
+ *
+ * This file defines the BenchController class behind the bench command,
+ * which sends numbered payloads on the bench channel, times their echoes
+ * from the app and reports goodput, round trips, retries and the CPU time
+ * the link spent per byte.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef BENCHCONTROLLER_H
+#define BENCHCONTROLLER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Class running one link benchmark at a time.
+ *
+ * Payload n of a run is S bytes with byte i set to (n + i) mod 256, so its
+ * first byte is the low byte of its number and the echo can be checked
+ * as it arrives. The channel is a byte stream, so the echo is cut back into
+ * payloads by counting. Up to MAX_IN_FLIGHT payloads are out at a time,
+ * each written whole and flushed at once, so the round trip covers the link
+ * and the app only, not the coalescing delay.
+ *
+ * Retries and dropped windows are the differences of the link counters
+ * over the run, and the CPU time is that of the communication tasks, the
+ * link, the telemetry and the fast lock, so other link traffic during the
+ * run adds to both. The report follows through the ReportWriter and ends
+ * with OK; a run that hears no echo for TIMEOUT_MS ends early and says so.
+ */
+class BenchController final
+{
+public:
+  static constexpr uint8_t MIN_SIZE = 1;         ///< Smallest payload in bytes
+  static constexpr uint8_t MAX_SIZE = 64;        ///< Largest payload in bytes, the bench pipe holds it whole
+  static constexpr uint16_t MAX_COUNT = 10000;   ///< Most payloads of a run
+  static constexpr uint8_t MAX_IN_FLIGHT = 4;    ///< Payloads sent and not yet echoed
+  static constexpr uint8_t RTT_BUCKETS = 8;      ///< Round trip histogram buckets, see RTT_BOUNDS_MS
+  static constexpr uint16_t TIMEOUT_MS = 5000;   ///< Time without an echo after which a run ends
+
+  /**
+   * @brief Start a run whose report goes to an output.
+   *
+   * @param output Destination of the report.
+   * @param count Payloads to send, 1 to MAX_COUNT.
+   * @param size Payload size in bytes, MIN_SIZE to MAX_SIZE.
+   * @return false if a run is still going or its report waits.
+   */
+  bool start(Print &output, const uint16_t count, const uint8_t size);
+
+  /**
+   * @brief Check whether a run or its report belongs to an output.
+   *
+   * @param output The output to check.
+   * @return True from start() until the report has been handed to the ReportWriter.
+   */
+  bool isRunningFor(const Print &output) const { return p_output == &output; }
+
+  /**
+   * @brief Send due payloads, take in the echoes and hand over the report.
+   */
+  void loop();
+
+private:
+  static bool renderReport(Print &print, const uint8_t block);
+
+  void send();
+  void receive();
+  void finish(const bool timedOut);
+
+  uint32_t m_sentMicros[MAX_IN_FLIGHT] = {}; ///< Send time of each payload in flight, by number mod MAX_IN_FLIGHT
+  uint16_t m_rttBuckets[RTT_BUCKETS] = {};   ///< Round trips per RTT_BOUNDS_MS bucket
+  uint32_t m_rttTotalUs = 0;                 ///< Sum of the round trips
+  uint32_t m_rttMinUs = 0;                   ///< Shortest round trip
+  uint32_t m_rttMaxUs = 0;                   ///< Longest round trip
+  uint32_t m_startMicros = 0;                ///< Time the first payload went out
+  uint32_t m_elapsedUs = 0;                  ///< Duration of the finished run
+  uint32_t m_cpuUs = 0;                      ///< Communication task time, at start then over the run
+  uint16_t m_retries = 0;                    ///< Link retransmissions, at start then over the run
+  uint16_t m_drops = 0;                      ///< Windows given up, at start then over the run
+  uint16_t m_lastEchoMillis = 0;             ///< LoopClock time of the last echo byte or the start
+  uint16_t m_count = 0;                      ///< Payloads of the run
+  uint16_t m_sent = 0;                       ///< Payloads sent
+  uint16_t m_echoed = 0;                     ///< Payloads echoed whole
+  uint16_t m_corrupt = 0;                    ///< Echoed payloads with a wrong byte
+  uint8_t m_size = 0;                        ///< Payload size
+  uint8_t m_echoOffset = 0;                  ///< Bytes of the current echo received
+  bool m_echoCorrupt = false;                ///< The current echo had a wrong byte
+  bool m_timedOut = false;                   ///< The run ended for lack of echoes
+  bool m_finished = false;                   ///< The run is over, the report waits for the ReportWriter
+  Print *p_output = nullptr;                 ///< Report destination, nullptr when idle
+};
+
+#endif
@@ -11,8 +11,12 @@
 #ifndef __BUTTONCONTROLLER_H__
 #define __BUTTONCONTROLLER_H__
 
+// Arduino core
+#include <Arduino.h>
+
 // Third-party libraries
-#include <ezButton.h>
+#include <LoopClock.h>
+#include <FastCircularQueue.h>
 
 /// Duration in milliseconds for a very long button press
 constexpr uint16_t VERY_LONG_PRESS_DURATION = 10000;
@@ -20,6 +24,10 @@ constexpr uint16_t VERY_LONG_PRESS_DURATION = 10000;
 constexpr uint16_t LONG_PRESS_DURATION = 3000;
 /// Debounce time in milliseconds to eliminate button noise
 constexpr uint8_t DEBOUNCE_TIME = 30;
+/// Button edges the pin change interrupt can queue between two loop() calls (power of 2)
+#ifndef BUTTON_EDGE_QUEUE_SIZE
+#define BUTTON_EDGE_QUEUE_SIZE 16
+#endif
 
 /**
  * @brief Class for handling button input with duration detection.
@@ -27,6 +35,14 @@ constexpr uint8_t DEBOUNCE_TIME = 30;
  * This class provides functionality to detect different types of button presses
  * based on their duration. It handles debouncing internally and categorizes
  * presses as short, long, or very long.
+ *
+ * The pin change interrupt stamps every edge with millis() and queues it;
+ * loop() debounces and times presses from those stamps, so a press shorter
+ * than a loop stall is still seen and its duration does not depend on when
+ * loop() ran. A level is accepted once no edge followed it for
+ * DEBOUNCE_TIME. loop() also compares the pin with the last queued level,
+ * which recovers edges lost to a full queue and covers pins without a pin
+ * change interrupt.
  */
 class ButtonController final
 {
@@ -48,6 +64,11 @@ public:
    */
   explicit ButtonController(const uint8_t buttonPin);
 
+  /**
+   * @brief Configure the pin and enable its pin change interrupt.
+   */
+  void begin();
+
   /**
    * @brief Check if the button is currently being pressed.
    * @return True if the button is pressed, false otherwise.
@@ -69,14 +90,50 @@ public:
   /**
    * @brief Update button state and detect press durations.
    *
-   * This should be called regularly in the main program loop.
+   * This should be called regularly in the main program loop. A pass reports
+   * at most one press; further queued presses follow on the next passes.
    */
   void loop();
 
+  /**
+   * @brief Queue the current pin level, called from the pin change interrupt.
+   */
+  void processEdgeISR();
+
 private:
-  ezButton m_button;      ///< Button instance from ezButton library
-  uint16_t m_pressedTime; ///< Duration of the current press in milliseconds
-  State m_state;          ///< Current state of the button press
+  /**
+   * @brief One pin level change.
+   */
+  struct Edge
+  {
+    uint16_t time; ///< millis() of the change, low 16 bits
+    uint8_t level; ///< Pin level after the change
+  };
+
+  /**
+   * @brief Debounce one edge.
+   *
+   * @param edge Edge in time order.
+   * @return true if it completed a press and set m_state.
+   */
+  bool processEdge(const Edge &edge);
+
+  /**
+   * @brief Accept the pending level if nothing has changed it for DEBOUNCE_TIME.
+   *
+   * @param now Time of the check, low 16 bits of millis().
+   * @return true if it completed a press and set m_state.
+   */
+  bool settle(const uint16_t now);
+
+  FastCircularQueue<Edge, BUTTON_EDGE_QUEUE_SIZE> m_edges; ///< Edges from the interrupt
+  const uint8_t m_pin;                                     ///< Button pin
+  volatile uint8_t m_queuedLevel;                          ///< Level of the newest queued edge
+  uint8_t m_pendingLevel;                                  ///< Level waiting for the debounce time
+  uint16_t m_pendingTime;                                  ///< Time the pending level started
+  uint8_t m_stableLevel;                                   ///< Debounced level
+  uint16_t m_pressedTime;                                  ///< Time the current press started
+  State m_state;                                           ///< Current state of the button press
 }; // end ButtonController class
 
 #endif // __BUTTONCONTROLLER_H__
\ No newline at end of file
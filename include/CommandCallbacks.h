@@ -27,6 +27,19 @@ void commandHelp(SerialCommands &sender, Args &args);
  */
 void commandPing(SerialCommands &sender, Args &args);
 
+/**
+ * @brief Ping with device timestamps for a latency breakdown.
+ *
+ * Replies `pong <token> rx <us> link <us> cmd <us> reply <us>`, all micros():
+ * rx the start of the SoftSerial RX burst carrying the request ("-" when
+ * not known), link its delivery by the CRC link, cmd the dispatch by the
+ * parser and reply the hand-over of this reply to the link.
+ *
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (host token, echoed as is).
+ */
+void commandPingTime(SerialCommands &sender, Args &args);
+
 /**
  * @brief Display RAM usage information.
  * @param sender Reference to the SerialCommands instance.
@@ -41,6 +54,69 @@ void commandRam(SerialCommands &sender, Args &args);
  */
 void commandStatistics(SerialCommands &sender, Args &args);
 
+/**
+ * @brief Report link-quality counters as one compact line.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandLinkStatistics(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Display recorded loop stalls.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandStalls(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Set the loop stall threshold.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (threshold in microseconds, 0 disables).
+ */
+void commandSetStallThreshold(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Display the main loop task schedule and run times.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandTasks(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Allow or forbid sleeping between main loop passes.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (1 to sleep when idle, 0 to keep spinning).
+ */
+void commandSetIdleSleep(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Queue a binary telemetry burst to the sender.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandTelemetry(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Stream the event journal records, oldest first.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandJournal(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Set the periodic telemetry intervals.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (link and USB interval in seconds, 0 disables).
+ */
+void commandSetTelemetryRate(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Run the link benchmark, the app echoing the payloads; the report follows.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (payload count and size in bytes).
+ */
+void commandBench(SerialCommands &sender, Args &args);
+
 /**
  * @brief Generate and display a random salt value for encryption.
  * @param sender Reference to the SerialCommands instance.
@@ -83,6 +159,27 @@ void commandLock(SerialCommands &sender, Args &args);
  */
 void commandUnlock(SerialCommands &sender, Args &args);
 
+/**
+ * @brief Issue a lock/unlock challenge and display its nonce.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandChallenge(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Lock the keyboard with the tag answering the pending challenge.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (SipHash-2-4 tag, raw or hexadecimal).
+ */
+void commandLockMac(SerialCommands &sender, Args &args);
+
+/**
+ * @brief Unlock the keyboard with the tag answering the pending challenge.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments (SipHash-2-4 tag, raw or hexadecimal).
+ */
+void commandUnlockMac(SerialCommands &sender, Args &args);
+
 /**
  * @brief Reset the microcontroller.
  * @param sender Reference to the SerialCommands instance.
@@ -118,4 +215,11 @@ void commandListTraceables(SerialCommands &sender, Args &args);
  */
 void commandSetTraceLevel(SerialCommands &sender, Args &args);
 
+/**
+ * @brief Route a component's trace output through the non-blocking sink or straight to Serial.
+ * @param sender Reference to the SerialCommands instance.
+ * @param args Command arguments.
+ */
+void commandSetTraceSink(SerialCommands &sender, Args &args);
+
 #endif
\ No newline at end of file
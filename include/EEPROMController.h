@@ -11,14 +11,35 @@
 #ifndef EEPROMCONTROLLER_H
 #define EEPROMCONTROLLER_H
 
+#include <SimpleTimer.h>
 #include "I2C.h"
 #include "Traceable.h"
+#include "EEPROMWriter.h"
+
+/// I2C address of the external EEPROM
+constexpr uint8_t EXT_EEPROM_I2C_ADDRESS = 0x50;
+/// Page size of the external EEPROM in bytes
+constexpr uint8_t EXT_EEPROM_PAGE_SIZE = 32;
+/// Capacity of the external EEPROM in bytes
+constexpr uint16_t EXT_EEPROM_TOTAL_SIZE = 8192;
+/// Pages of the external EEPROM
+constexpr uint16_t EXT_EEPROM_PAGE_COUNT = EXT_EEPROM_TOTAL_SIZE / EXT_EEPROM_PAGE_SIZE;
+/// Page write cycle time (tWR) in milliseconds before the first acknowledge poll
+constexpr uint8_t EXT_EEPROM_WRITE_CYCLE_MS = 5;
 
 /**
  * @brief Class for managing operations on EEPROM memory.
  *
  * This class provides functionality to interact with EEPROM memory via I2C,
  * including formatting operations for both internal and external memory areas.
+ * The internal EEPROM is cleared by one EEPROMWriter fill in the background.
+ *
+ * The external EEPROM is cleared a page at a time over 400 kHz I2C, as
+ * queued I2C transactions that run from the TWI interrupt. With read-verify
+ * on, a page is read back in one bulk read first and only written when it
+ * is not blank; the read callback queues the next page read itself, so
+ * blank pages go by back to back without loop(). After a page write the
+ * acknowledge polling waits on a timer for the write cycle.
  */
 class EEPROMController final : public Traceable
 {
@@ -36,8 +57,9 @@ public:
   /**
    * @brief Constructor that initializes the EEPROM controller.
    * @param i2c Reference to the I2C interface used for communication.
+   * @param writer Writer that clears the internal EEPROM.
    */
-  explicit EEPROMController(I2C &i2c);
+  EEPROMController(I2C &i2c, EEPROMWriter &writer);
 
   /**
    * @brief Get the current state of the controller.
@@ -47,8 +69,9 @@ public:
 
   /**
    * @brief Initiate formatting of the EEPROM memory.
+   * @param verify Read each external page and skip the write if it is blank.
    */
-  void format();
+  void format(const bool verify = true);
 
   /**
    * @brief Perform ongoing EEPROM operations.
@@ -60,24 +83,45 @@ public:
 
 private:
   /**
-   * @brief Check if a write operation to EEPROM has completed.
-   * @return True if write is complete, false if still in progress.
+   * @brief Transaction the external format has in flight.
    */
-  bool checkWriteComplete() const;
+  enum ExternalPhase : uint_fast8_t
+  {
+    PAGE_READ,  ///< Reading pages until one is not blank
+    PAGE_WRITE, ///< Writing a zero page, then waiting out the write cycle
+    WRITE_POLL  ///< Probing for the acknowledge that ends the write cycle
+  };
 
   /**
-   * @brief Format the internal EEPROM pages.
+   * @brief Queue the transaction of a phase for the current page.
+   * @param phase Phase to enter.
    */
-  void formatInternalPages();
+  void startExternal(const ExternalPhase phase);
 
   /**
-   * @brief Format the external EEPROM page.
+   * @brief Continue with the current page, or finish the external format.
+   */
+  void startNextPage();
+
+  /**
+   * @brief Check the page read, queue the next one if it is blank.
+   *
+   * Runs in the TWI interrupt.
+   *
+   * @param transaction The page read that completed.
    */
-  void formatExternalPage();
+  static void pageReadCallback(I2CTransaction &transaction);
 
-  I2C *p_i2c;                ///< Pointer to the I2C interface
-  State m_state;             ///< Current state of the controller
-  uint16_t m_currentCounter; ///< Counter used during formatting operations
+  I2C *p_i2c;                             ///< Pointer to the I2C interface
+  EEPROMWriter *p_writer;                 ///< Pointer to the internal EEPROM writer
+  State m_state;                          ///< Current state of the controller
+  volatile uint16_t m_currentCounter;     ///< External page being formatted, advanced by pageReadCallback() too
+  volatile uint16_t m_skippedPages;       ///< External pages found blank during the format
+  bool m_verify;                          ///< Read-verify external pages before writing
+  ExternalPhase m_phase;                  ///< Transaction the external format has in flight
+  I2CTransaction m_transaction;           ///< Page read, page write or acknowledge probe
+  uint8_t m_page[EXT_EEPROM_PAGE_SIZE];   ///< Page read back, or the zero page being written
+  SimpleTimer<uint8_t> m_writeCycleTimer; ///< Started by a page write, gates the acknowledge polling
 }; // end EEPROMController class
 
 #endif
\ No newline at end of file
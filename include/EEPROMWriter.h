@@ -0,0 +1,131 @@
+/**
+ * @file EEPROMWriter.h
+ * @brief Background writer for the internal EEPROM.
+ *
+ * This file defines the EEPROMWriter class, which queues internal EEPROM
+ * writes and performs them from the EE_READY interrupt, so the main loop
+ * never waits for an EEPROM write cycle.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef EEPROMWRITER_H
+#define EEPROMWRITER_H
+
+// Arduino core
+#include <Arduino.h>
+
+// Third-party libraries
+#include <FastCircularQueue.h>
+
+/// Byte writes the writer can hold before write() waits (power of 2)
+#ifndef EEPROM_WRITE_QUEUE_SIZE
+#define EEPROM_WRITE_QUEUE_SIZE 32
+#endif
+
+/**
+ * @brief Class writing the internal EEPROM from the EE_READY interrupt.
+ *
+ * write() queues one byte and fill() one range of equal bytes; the
+ * interrupt fires whenever the EEPROM is ready and starts the next write
+ * that changes a cell. Writes land in the order they were made: those
+ * queued before a fill() go first, one queued while the fill runs waits
+ * until the fill has passed its cell. A write cycle takes about 3.4 ms,
+ * during which the CPU runs on.
+ *
+ * All internal EEPROM access goes through this class while it is in use:
+ * read() pauses the interrupt so it cannot retarget the address register
+ * mid-read, and answers with the queued value when the cell still has a
+ * write pending.
+ */
+class EEPROMWriter final
+{
+public:
+  /**
+   * @brief Constructor that initializes an idle writer.
+   */
+  EEPROMWriter();
+
+  /**
+   * @brief Queue a byte write.
+   *
+   * Returns at once unless EEPROM_WRITE_QUEUE_SIZE writes are pending, then
+   * it waits for the oldest one to start. Called with interrupts disabled,
+   * it starts that write itself once the EEPROM is ready.
+   *
+   * @param address EEPROM address.
+   * @param value Byte to store.
+   */
+  void write(const uint16_t address, const uint8_t value);
+
+  /**
+   * @brief Queue a range of equal bytes behind the pending writes.
+   *
+   * Writes queued after it go to cells outside the range at once and to
+   * cells inside it once the fill has stored them.
+   *
+   * @param address First EEPROM address.
+   * @param length Number of bytes.
+   * @param value Byte to store in each.
+   * @return false if a previous fill is still running.
+   */
+  bool fill(const uint16_t address, const uint16_t length, const uint8_t value);
+
+  /**
+   * @brief Read a byte, including writes that are still queued.
+   *
+   * Waits for a running write cycle to end.
+   *
+   * @param address EEPROM address.
+   * @return The byte the cell holds once the queue has drained.
+   */
+  uint8_t read(const uint16_t address);
+
+  /**
+   * @brief Check whether every queued write has completed.
+   * @return True if nothing is queued and no write cycle is running.
+   */
+  bool isIdle() const;
+
+  /**
+   * @brief Start the next write, called from the EE_READY interrupt.
+   */
+  void processISR();
+
+private:
+  /**
+   * @brief One queued byte write.
+   */
+  struct Write
+  {
+    uint16_t address; ///< EEPROM address
+    uint8_t value;    ///< Byte to store
+  };
+
+  /**
+   * @brief Write queue that read() can search while the interrupt is paused.
+   */
+  class WriteQueue : public FastCircularQueue<Write, EEPROM_WRITE_QUEUE_SIZE>
+  {
+  public:
+    using FastCircularQueue<Write, EEPROM_WRITE_QUEUE_SIZE>::peekAt;
+  };
+
+  /**
+   * @brief Enable the EE_READY interrupt.
+   */
+  static void resume();
+
+  /**
+   * @brief Disable the EE_READY interrupt.
+   */
+  static void pause();
+
+  WriteQueue m_queue;              ///< Byte writes, oldest first
+  volatile uint16_t m_fillAddress; ///< Next address of the running fill
+  volatile uint16_t m_fillLength;  ///< Bytes left in the running fill
+  volatile uint8_t m_fillValue;    ///< Byte the running fill stores
+  volatile uint8_t m_fillAhead;    ///< Queued writes made before the running fill, they go first
+}; // end EEPROMWriter class
+
+#endif
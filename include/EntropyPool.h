@@ -0,0 +1,143 @@
+/**
+ * @file EntropyPool.h
+ * @brief Background entropy collection for the seed and the salt.
+ *
+ * This file defines the EntropyPool class, which gathers timing and ADC
+ * noise from the main loop and interrupts into a small pool, so random
+ * bytes are available at once when the pairing asks for them.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef ENTROPYPOOL_H
+#define ENTROPYPOOL_H
+
+// Arduino core
+#include <Arduino.h>
+
+// Third-party libraries
+#include <SipHash.h>
+#include <Statistic.h>
+
+#ifndef ENTROPY_ADC_PIN
+/// Unconnected analog pin whose conversion noise is sampled (A0 on the Pro Micro)
+#define ENTROPY_ADC_PIN 18
+#endif
+#ifndef ENTROPY_ADC_CHANNEL
+/// ADC channel of ENTROPY_ADC_PIN (A0 is ADC7)
+#define ENTROPY_ADC_CHANNEL 7
+#endif
+
+/// Credited bits after which the pool counts as seeded
+#define ENTROPY_POOL_READY_BITS 128
+
+/// Credit of an ADC sample that differs from the last one, in 1/8 bit
+constexpr uint8_t ENTROPY_CREDIT_ADC = 2;
+/// Credit of a link event whose spacing differs from the last one, in 1/8 bit
+constexpr uint8_t ENTROPY_CREDIT_LINK = 2;
+/// Credit of the timer byte at a scheduled call: Timer0 and Timer3 run from the same crystal
+constexpr uint8_t ENTROPY_CREDIT_TICK = 0;
+
+/**
+ * @brief Class collecting entropy in the background.
+ *
+ * Every loop() call takes a few samples and returns: the low byte of the
+ * last conversion of the floating ADC pin (the next one runs meanwhile),
+ * the Statistic clock at the call, and the clock at the latest link data
+ * and RX start edges. Every sample is mixed in, but the credit depends on
+ * the source, in 1/8 bit: ENTROPY_CREDIT_ADC for a conversion,
+ * ENTROPY_CREDIT_LINK for a link event, whose time the phone's clock sets,
+ * and nothing for the clock at the call, which the scheduler derives from
+ * the same crystal. A source that repeats itself is credited nothing: an
+ * ADC result equal to the last one, or link events with the same spacing
+ * as the last two, as a stuck pin or a periodic sender gives.
+ *
+ * Eight samples at a time are whitened into the 16-byte pool with SipHash
+ * keyed by the pool itself. read() derives its output from the pool with
+ * SipHash and a counter, then replaces the pool by a one-way function of
+ * itself, so it never blocks and later pool states do not reveal earlier
+ * output.
+ */
+class EntropyPool final
+{
+public:
+  /**
+   * @brief Constructor that initializes an empty pool.
+   */
+  EntropyPool();
+
+  /**
+   * @brief Set up the ADC on ENTROPY_ADC_CHANNEL and start the first conversion.
+   */
+  void begin();
+
+  /**
+   * @brief Take one round of samples, called from a periodic task.
+   */
+  void loop();
+
+  /**
+   * @brief Record the time of a link event in interrupt context.
+   *
+   * Folds the clock's low byte into an accumulator loop() picks up, a few
+   * cycles per call.
+   */
+  inline void addTimingFromISR()
+  {
+    m_isrTiming = static_cast<uint8_t>((m_isrTiming << 1) | (m_isrTiming >> 7)) ^ static_cast<uint8_t>(Statistic::now());
+    ++m_isrEvents;
+  }
+
+  /**
+   * @brief Record the time of a link event from the main loop.
+   */
+  void addTiming();
+
+  /**
+   * @brief Check whether ENTROPY_POOL_READY_BITS have been credited since boot.
+   * @return True once the pool is seeded.
+   */
+  bool isReady() const { return m_credit >= ENTROPY_POOL_READY_BITS * 8U; }
+
+  /**
+   * @brief Derive random bytes from the pool, without waiting.
+   * @param data Destination.
+   * @param length Number of bytes.
+   * @return True if the pool was seeded, false if the bytes come from less entropy.
+   */
+  bool read(byte *const data, const uint8_t length);
+
+private:
+  /**
+   * @brief Add one raw sample, whitening the block into the pool when it is full.
+   * @param sample The sample.
+   * @param credit Entropy the sample adds, in 1/8 bit.
+   */
+  void addSample(const uint8_t sample, const uint8_t credit);
+
+  /**
+   * @brief Add a link event time, credited if its spacing differs from the last one.
+   * @param timing Clock low byte, or accumulator of several, at the event.
+   */
+  void addLinkSample(const uint8_t timing);
+
+  /**
+   * @brief Replace the pool with a one-way function of itself.
+   */
+  void rekey();
+
+  uint8_t m_pool[SipHash::KEY_LENGTH]; ///< Pool, the SipHash key of every step
+  uint8_t m_block[8];                  ///< Raw samples waiting to be whitened
+  uint8_t m_blockFill;                 ///< Samples in m_block
+  uint8_t m_poolHalf;                  ///< Half of m_pool the next block goes into
+  uint16_t m_credit;                   ///< 1/8 bits credited since boot, saturating at ENTROPY_POOL_READY_BITS * 8
+  uint8_t m_lastAdc;                   ///< Last ADC sample, a repeat is not credited
+  uint8_t m_lastLink;                  ///< Last link event sample
+  uint8_t m_lastLinkSpacing;           ///< Difference of the last two link event samples
+  uint32_t m_outputCount;              ///< Output blocks derived so far
+  volatile uint8_t m_isrTiming;        ///< Timing accumulator of addTimingFromISR()
+  volatile uint8_t m_isrEvents;        ///< Calls of addTimingFromISR(), wrapping
+  uint8_t m_seenIsrEvents;             ///< m_isrEvents when loop() last took m_isrTiming
+}; // end EntropyPool class
+
+#endif
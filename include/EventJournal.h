@@ -0,0 +1,247 @@
+/**
+ * @file EventJournal.h
+ * @brief Append-only event journal on the external EEPROM.
+ *
+ * This file defines the EventJournal class, which records lock, unlock,
+ * connect, reset and watchdog events and periodic statistics snapshots as
+ * page sized records in a ring over the whole external EEPROM, and streams
+ * them back on request.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef EVENTJOURNAL_H
+#define EVENTJOURNAL_H
+
+#include <Arduino.h>
+#include <SimpleTimer.h>
+#include "I2C.h"
+#include "Traceable.h"
+#include "EEPROMController.h"
+
+/// Seconds an event waits in RAM for the rest of its page before it is written anyway
+#ifndef JOURNAL_FLUSH_INTERVAL_S
+#define JOURNAL_FLUSH_INTERVAL_S 30
+#endif
+
+/// Seconds between statistics snapshots, 0 = off
+#ifndef JOURNAL_SNAPSHOT_INTERVAL_S
+#define JOURNAL_SNAPSHOT_INTERVAL_S 900
+#endif
+
+/// Events per journal page
+#define JOURNAL_ENTRIES_PER_PAGE 3
+
+/**
+ * @brief Class keeping an event journal in the external EEPROM.
+ *
+ * Every record is one EEPROM page: a sequence number, the boot it was
+ * written in, its events or a statistics snapshot, and a CRC-16. Records
+ * go to the pages in turn and wrap at the end, so each page takes one
+ * write per lap of the ring. begin() finds the newest record with a binary
+ * search: from page 0 up to the newest one the sequence numbers rise, the
+ * pages after it are older or blank. A page failing its CRC counts as
+ * blank; only the page being written can be torn, and it is the one after
+ * the newest record.
+ *
+ * record() collects events in RAM; a page is written once it is full or
+ * JOURNAL_FLUSH_INTERVAL_S after its first event. The writes, and the page
+ * reads of dump(), are queued I2C transactions polled from loop().
+ */
+class EventJournal final : public Traceable
+{
+public:
+  /**
+   * @brief Journal event types.
+   */
+  enum Event : uint8_t
+  {
+    EVENT_RESET,      ///< Boot, arg: reset reason
+    EVENT_WATCHDOG,   ///< Boot after a watchdog reset
+    EVENT_LOCK,       ///< Keyboard locked, value: latency in microseconds
+    EVENT_UNLOCK,     ///< Keyboard unlocked
+    EVENT_CONNECT,    ///< Bluetooth link connected
+    EVENT_DISCONNECT  ///< Bluetooth link disconnected
+  };
+
+  /**
+   * @brief Constructor that initializes an unavailable journal.
+   * @param i2c Reference to the I2C interface of the external EEPROM.
+   */
+  explicit EventJournal(I2C &i2c);
+
+  /**
+   * @brief Start the I2C bus and find the newest record.
+   *
+   * Blocks for about ten page reads.
+   *
+   * @return false if the external EEPROM does not answer.
+   */
+  bool begin();
+
+  /**
+   * @brief Add an event to the page being collected.
+   *
+   * Not for interrupt context. Dropped while a full page waits for the bus.
+   *
+   * @param event Event type.
+   * @param arg Event specific byte.
+   * @param value Event specific word.
+   */
+  void record(const Event event, const uint8_t arg = 0, const uint16_t value = 0);
+
+  /**
+   * @brief Stream every record, oldest first, and OK at the end.
+   *
+   * Records written after the call are not part of the dump.
+   *
+   * @param output Destination, queried with availableForWrite().
+   * @return false if the journal is unavailable or a dump is running.
+   */
+  bool dump(Print &output);
+
+  /**
+   * @brief Check whether a dump is being written to an output.
+   *
+   * @param output The output to check.
+   * @return True until the dump's OK has been written to @p output.
+   */
+  bool isDumpingTo(const Print &output) const { return p_dumpOutput == &output; }
+
+  /**
+   * @brief Write due pages and advance a dump.
+   *
+   * Keep it from running while something else formats the EEPROM.
+   */
+  void loop();
+
+private:
+  /// Page count value marking a statistics snapshot
+  static constexpr uint8_t SNAPSHOT = 0xFF;
+
+  /**
+   * @brief One journal event.
+   */
+  struct Entry
+  {
+    uint32_t timestamp; ///< millis() when recorded
+    uint8_t event;      ///< Event
+    uint8_t arg;        ///< Event specific byte
+    uint16_t value;     ///< Event specific word
+  };
+
+  /**
+   * @brief Statistics at one point of a boot.
+   */
+  struct Snapshot
+  {
+    uint32_t timestamp;      ///< millis() when taken
+    uint16_t lowestFreeRam;  ///< Least free RAM seen
+    uint16_t loopAverage;    ///< Average loop time in microseconds
+    uint16_t loopMax;        ///< Longest loop time in microseconds
+    uint16_t lockLatencyMax; ///< Longest lock latency in microseconds
+  };
+
+  /**
+   * @brief One journal record, exactly one EEPROM page.
+   */
+  struct Page
+  {
+    uint32_t sequence; ///< Record number, 0 on a blank page
+    uint8_t boot;      ///< Boot the record was written in
+    uint8_t count;     ///< Events in entries, SNAPSHOT for a snapshot
+    union
+    {
+      Entry entries[JOURNAL_ENTRIES_PER_PAGE]; ///< Events, oldest first
+      Snapshot snapshot;                       ///< Statistics snapshot
+    };
+    uint16_t crc; ///< CRC-16-CCITT over the bytes before it
+  };
+  static_assert(sizeof(Page) == EXT_EEPROM_PAGE_SIZE, "A journal record is one EEPROM page");
+
+  /**
+   * @brief Transaction the journal has in flight.
+   */
+  enum Operation : uint_fast8_t
+  {
+    NONE,     ///< No transaction
+    WRITE,    ///< Writing the next record
+    DUMP_READ ///< Reading a page for dump()
+  };
+
+  /**
+   * @brief Read a page, blocking.
+   * @param index Page index.
+   * @param valid Set to whether the page holds a record.
+   * @return false if the read failed.
+   */
+  bool readPage(const uint16_t index, bool &valid);
+
+  /**
+   * @brief Queue the write of the collected events or of a snapshot.
+   * @param snapshot Write a statistics snapshot instead of the events.
+   */
+  void startWrite(const bool snapshot);
+
+  /**
+   * @brief Queue the page read of a dump step.
+   */
+  void startDumpRead();
+
+  /**
+   * @brief Handle the transaction that completed.
+   */
+  void finishOperation();
+
+  /**
+   * @brief Print what fits of the page the dump has read.
+   */
+  void continueDump();
+
+  /**
+   * @brief Print one line of the page in m_page.
+   * @param print The output stream.
+   * @param line 0 for the page header, then one per event.
+   */
+  void printLine(Print &print, const uint8_t line) const;
+
+  /**
+   * @brief CRC-16 of a page.
+   * @param page The page.
+   * @return CRC over every byte before the crc field.
+   */
+  static uint16_t pageCrc(const Page &page);
+
+  /**
+   * @brief Check whether a page holds a record.
+   * @param page The page.
+   * @return True if the page has a sequence number, a count in range and a matching CRC.
+   */
+  static bool isValid(const Page &page);
+
+  I2C *p_i2c;                                    ///< Pointer to the I2C interface
+  bool m_available;                              ///< The external EEPROM answered in begin()
+  Operation m_operation;                         ///< Transaction in flight
+  I2CTransaction m_transaction;                  ///< Page write or dump page read
+  bool m_retryWrite;                             ///< The last page write failed, m_page still holds it
+  Page m_page;                                   ///< Page being written, or read by a dump
+  Entry m_entries[JOURNAL_ENTRIES_PER_PAGE];     ///< Events not written yet
+  uint8_t m_entryCount;                          ///< Events in m_entries
+  uint16_t m_dropped;                            ///< Events lost because the page was full
+  uint16_t m_nextPage;                           ///< Page the next record goes to
+  uint32_t m_sequence;                           ///< Sequence number of the next record
+  uint8_t m_boot;                                ///< Boot number of this boot
+  SimpleTimer<uint8_t> m_writeCycleTimer;        ///< Started by every transaction, holds the bus off during a write cycle
+  SimpleTimer<uint16_t, LoopClock> m_flushTimer; ///< Started by the first event of a page
+  SimpleTimer<uint32_t, LoopClock> m_snapshotTimer; ///< Snapshot interval
+  Print *p_dumpOutput;                           ///< Dump destination, nullptr when no dump runs
+  uint16_t m_dumpFirst;                          ///< Oldest page of the dump
+  uint16_t m_dumpPages;                          ///< Pages the dump has finished
+  uint32_t m_dumpLimit;                          ///< First sequence number not part of the dump
+  bool m_dumpLoaded;                             ///< m_page holds the dump page
+  uint8_t m_dumpLines;                           ///< Lines of the dump page
+  uint8_t m_dumpLine;                            ///< Lines of the dump page printed
+  SimpleTimer<uint16_t, LoopClock> m_dumpTimer;  ///< Started by dump progress, ends a dump nobody reads
+}; // end EventJournal class
+
+#endif
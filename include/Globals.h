@@ -14,15 +14,24 @@
 
 #include "StatisticController.h"
 #include "WatchdogController.h"
+#include "LEDPatternEngine.h"
 #include "LEDController.h"
 #include "ButtonController.h"
 #include "KeyboardController.h"
 #include "HC05.h"
 #include "SoftSerial.h"
+#include "EEPROMWriter.h"
 #include "EEPROMController.h"
+#include "EventJournal.h"
+#include "EntropyPool.h"
 #include "CRCPackageInterface.h"
-#include "DefaultPackageInterface.h"
 #include "Utilities.h"
+#include "TraceSink.h"
+#include "ReportWriter.h"
+#include "StallRecorder.h"
+#include "TelemetryController.h"
+#include "BenchController.h"
+#include "TaskScheduler.h"
 #include "I2C.h"
 #include <StaticSerialCommands.h>
 #include <PipedStream.h>
@@ -36,14 +45,38 @@
 #define GREEN_LED_PIN 8
 /// Red status LED pin
 #define RED_LED_PIN 9
+/// LED pattern channel of the green status LED
+#define LED_CHANNEL_GREEN 0
+/// LED pattern channel of the red status LED
+#define LED_CHANNEL_RED 1
+/// LED pattern channel of the built-in RX LED
+#define LED_CHANNEL_RX 2
+/// LED pattern channel of the built-in TX LED
+#define LED_CHANNEL_TX 3
 /// User input button pin
 #define BUTTON_PIN 10
-/// Pin controlling power to the keyboard
-#define KEYBOARD_POWER_PIN 19
-/// Pin controlling D+ pin of usb of the keyboard
-#define KEYBOARD_DP_PIN 4
-/// Pin controlling D- pin of usb of the keyboard
-#define KEYBOARD_DM_PIN 5
+/// Set to 1 to run the HC05 link on the hardware USART (Serial1) instead of SoftSerial on Timer1
+#define HC05_HARDWARE_UART 0
+/// Set to 1 to try 57600 baud first on the SoftSerial link; the Timer1 ISR must then fit a
+/// 92 cycle tick, which `pio run -e sim -t simbench` checks
+#ifndef SOFT_SERIAL_LINK_57600
+#define SOFT_SERIAL_LINK_57600 0
+#endif
+
+#if HC05_HARDWARE_UART
+/// HC05 Bluetooth module RX pin (USART1 RXD1)
+#define HC05_RX 0
+/// HC05 Bluetooth module TX pin (USART1 TXD1)
+#define HC05_TX 1
+/// HC05 Bluetooth module reset pin
+#define HC05_RESET 16
+/// HC05 Bluetooth module state pin
+#define HC05_STATE 7
+/// HC05 Bluetooth module key pin
+#define HC05_KEY 6
+/// Baud rate of the HC05 data link on Serial1
+#define HC05_BAUD_RATE 38400
+#else
 /// HC05 Bluetooth module RX pin
 #define HC05_RX 6
 /// HC05 Bluetooth module TX pin
@@ -54,6 +87,22 @@
 #define HC05_STATE 1
 /// HC05 Bluetooth module key pin
 #define HC05_KEY 0
+/// Set to 1 when HC05_RX is wired to an external interrupt pin so Timer1 only runs while a frame is in flight
+#define HC05_RX_EDGE_TRIGGERED 0
+#endif
+
+/// Set to 1 to lock the keyboard straight from the HC05 STATE pin interrupt on disconnect
+#define HC05_STATE_FAST_LOCK 0
+
+/// Set to 1 (env:sim) to build for the simavr benchmark in benchmark/sim
+#ifndef SIM_BENCHMARK
+#define SIM_BENCHMARK 0
+#endif
+
+/// Set to 1 to build the bench command's link benchmark: its pipes (2 x 64 byte buffers) and controller take about 250 bytes of SRAM
+#ifndef LINK_BENCH
+#define LINK_BENCH 0
+#endif
 
 /// EEPROM address for storing the encryption salt
 #define EEPROM_SALT_ADDRESS 0
@@ -61,11 +110,34 @@
 #define EEPROM_SEED_CHECKED_ADDRESS 1
 /// EEPROM address for storing the encryption seed
 #define EEPROM_SEED_ADDRESS 2
+/// EEPROM address for storing the hashes of the applied HC05 configuration commands (after the 16 byte seed)
+#define EEPROM_HC05_CONFIG_ADDRESS 18
+/// EEPROM address for storing the 4 byte challenge epoch, one step per boot that issues a challenge (after the 5 config hashes)
+#define EEPROM_CHALLENGE_EPOCH_ADDRESS 23
+/// EEPROM address for storing the confirmed HC05 data mode rate, its BaudRate code plus one, 0 for none (after the epoch)
+#define EEPROM_HC05_BAUD_ADDRESS 27
+
+/// Set to 1 to accept lock/unlock with the replayable seed, for apps that predate the challenge-response lockmac/unlockmac
+#ifndef AUTH_SEED_COMMANDS
+#define AUTH_SEED_COMMANDS 0
+#endif
 
 /// Size of software serial RX buffer
-constexpr uint8_t SOFTWARE_SERIAL_RX_BUFFER = 32;
+constexpr uint16_t SOFTWARE_SERIAL_RX_BUFFER = 32;
 /// Size of software serial TX buffer
-constexpr uint8_t SOFTWARE_SERIAL_TX_BUFFER = 32;
+constexpr uint16_t SOFTWARE_SERIAL_TX_BUFFER = 32;
+/// Set to 1 to choose the link's frame format at run time, to measure what the fixed format saves (sim_runtime)
+#ifndef SOFT_SERIAL_RUNTIME_FORMAT
+#define SOFT_SERIAL_RUNTIME_FORMAT 0
+#endif
+
+#if SOFT_SERIAL_RUNTIME_FORMAT
+/// Frame format of the HC05 link, 8N1 set by begin()
+typedef RuntimeFrameFormat SoftwareSerialFormat;
+#else
+/// Frame format of the HC05 link (8N1), fixed at compile time
+typedef FixedFrameFormat<NONE, 1> SoftwareSerialFormat;
+#endif
 
 /**
  * @brief Enumeration of possible system states.
@@ -79,37 +151,79 @@ enum State : uint_fast8_t
 
 /// Global statistics controller
 extern StatisticController statisticController;
+/// Non-blocking trace output to Serial, selected per component with "tracesink"
+extern TraceSink traceSink;
+/// Writer for reports too long to send in one loop pass, used by "stats" and "ram"
+extern ReportWriter reportWriter;
+/// Timer driven patterns of all LEDs
+extern LEDPatternEngine ledPatterns;
 /// Global LED status controller
 extern LEDController ledController;
-/// RX activity indicator LED
-extern ezLED rxLED;
-/// TX activity indicator LED
-extern ezLED txLED;
 /// User input button controller
 extern ButtonController buttonController;
 /// Keyboard security controller
 extern KeyboardController keyboardController;
+#if !HC05_HARDWARE_UART
 /// Software serial interface for auxiliary communication
-extern SoftSerial<SOFTWARE_SERIAL_RX_BUFFER, SOFTWARE_SERIAL_TX_BUFFER> softwareSerial;
+extern SoftSerial<HC05_RX, HC05_TX, SOFTWARE_SERIAL_RX_BUFFER, SOFTWARE_SERIAL_TX_BUFFER, SoftwareSerialFormat> softwareSerial;
+#endif
 /// HC05 Bluetooth module controller
 extern HC05 hc05;
+/// Serial port of the HC05 link (Serial1 or softwareSerial)
+extern Stream &streamBluetoothLink;
+/// Interrupt driven internal EEPROM writer, all internal EEPROM access goes through it
+extern EEPROMWriter eepromWriter;
 /// EEPROM operations controller
 extern EEPROMController eepromController;
+/// Event journal in the external EEPROM
+extern EventJournal eventJournal;
+/// Background entropy for the seed and the salt
+extern EntropyPool entropyPool;
+
+/// CRC link channel carrying commands and their responses
+constexpr uint8_t CHANNEL_COMMAND = 0;
+/// CRC link channel carrying unsolicited telemetry
+constexpr uint8_t CHANNEL_TELEMETRY = 1;
+/// CRC link channel carrying the bench command's payloads, echoed by the app
+constexpr uint8_t CHANNEL_BENCH = 2;
+
+/// Command pipe buffer size, each direction (power of two)
+constexpr uint16_t COMMAND_PIPES_BUFFER_SIZE = 256;
+/// Command pipe room a Bluetooth command waits for, the longest reply not written as a report fits
+constexpr uint8_t COMMAND_OUTPUT_RESERVE = 96;
+/// Telemetry pipe buffer size towards the link, holds a whole telemetry frame (power of two)
+constexpr uint16_t TELEMETRY_PIPES_BUFFER_SIZE = 128;
+/// Telemetry pipe buffer size from the link, one DATA payload (power of two)
+constexpr uint16_t TELEMETRY_PIPES_RETURN_BUFFER_SIZE = 32;
+#if LINK_BENCH
+/// Bench pipe buffer size, each direction, holds the largest bench payload (power of two)
+constexpr uint16_t BENCH_PIPES_BUFFER_SIZE = 64;
+#endif
 
-/// Piped stream pair for command routing
-extern PipedStreamPair commandPipes;
+/// Piped stream pair for command routing (CHANNEL_COMMAND)
+extern PipedStreamPairN<COMMAND_PIPES_BUFFER_SIZE> commandPipes;
+/// Piped stream pair for telemetry (CHANNEL_TELEMETRY)
+extern PipedStreamPairN<TELEMETRY_PIPES_BUFFER_SIZE, TELEMETRY_PIPES_RETURN_BUFFER_SIZE> telemetryPipes;
+#if LINK_BENCH
+/// Piped stream pair for the link benchmark (CHANNEL_BENCH)
+extern PipedStreamPairN<BENCH_PIPES_BUFFER_SIZE> benchPipes;
+#endif
 /// Stream for Bluetooth data communication
 extern PipedStream &streamBluetoothData;
-/// Stream for Bluetooth command communication
-extern PipedStream &streamBluetoothCommand;
 /// Stream for command interpretation
 extern PipedStream &streamCommander;
+/// Stream for telemetry output
+extern PipedStream &streamTelemetry;
+#if LINK_BENCH
+/// Stream for the bench payloads and their echoes
+extern PipedStream &streamBench;
+#endif
 
 /// CRC-based package interface for secure communication
 extern CRCPackageInterface crcPackageInterface;
-/// Default package interface for standard communication
-extern DefaultPackageInterface defaultPackageInterface;
 
+/// Performance statistics for a whole loop pass, parent of the others
+extern Statistic loopStatistic;
 /// Performance statistics for system operations
 extern Statistic systemStatistic;
 /// Performance statistics for peripheral operations
@@ -119,14 +233,80 @@ extern Statistic communicationStatistic;
 /// Performance statistics for application-specific operations
 extern Statistic applicationStatistic;
 
-/// Array of all statistics objects for reporting
+/// Array of all statistics objects for reporting, loopStatistic first
 extern const Statistic *statistics[];
 /// Number of statistics objects in the array
 extern const uint8_t lengthOfStatistics;
 
+/// Recorder for loop iterations longer than its threshold
+extern StallRecorder stallRecorder;
+/// Binary telemetry frames on request and on the telemetry channel or USB
+extern TelemetryController telemetryController;
+#if LINK_BENCH
+/// Link benchmark of the bench command
+extern BenchController benchController;
+#endif
+/// Runs the main loop tasks, table in K810Security
+extern TaskScheduler taskScheduler;
+
+#if STATISTIC_ISR_LOAD
+#if !HC05_HARDWARE_UART
+/// CPU load of the software serial sampling interrupt
+extern IsrStatistic timer1IsrStatistic;
+/// CPU load of the software serial RX start edge interrupt
+extern IsrStatistic rxEdgeIsrStatistic;
+#endif
+/// CPU load of the HC05 STATE pin edge interrupt
+extern IsrStatistic stateEdgeIsrStatistic;
+/// CPU load of the button pin change interrupt
+extern IsrStatistic buttonEdgeIsrStatistic;
+/// CPU load of the LED pattern timer interrupt
+extern IsrStatistic ledTimerIsrStatistic;
+/// CPU load of the EEPROM ready interrupt
+extern IsrStatistic eepromIsrStatistic;
+
+/// Array of all ISR statistics objects for reporting
+extern IsrStatistic *const isrStatistics[];
+/// Number of ISR statistics objects in the array
+extern const uint8_t lengthOfIsrStatistics;
+#endif
+
 /// Serial command parser for USB/serial communication
 extern SerialCommands serialCommands;
 /// Serial command parser for Bluetooth communication
 extern SerialCommands bluetoothCommands;
 
+#if SERIAL_COMMANDS_STATISTICS
+/// Dispatch statistics of the serial commands, by command index
+extern CommandStatistic serCommandStatistics[];
+/// Dispatch statistics of the Bluetooth commands, by binary opcode
+extern CommandStatistic btCommandStatistics[];
+#endif
+
+#if SIM_BENCHMARK
+/// SimProbe::magic value the simulator writes before the firmware starts
+constexpr uint8_t SIM_PROBE_MAGIC = 0x5A;
+
+/**
+ * @brief Mailbox between the firmware and benchmark/sim/simbench.c.
+ *
+ * The simulator finds it by symbol name, fills in magic and baudRate after
+ * reset and reads the counters at the end of each scenario. The layout is
+ * mirrored in simbench.c.
+ */
+struct SimProbe
+{
+  uint8_t magic;       ///< SIM_PROBE_MAGIC when the simulator set baudRate
+  uint8_t baudRate;    ///< BaudRate of the HC05 link to run at
+  uint16_t rxErrors;   ///< SoftSerial bad frames since begin()
+  uint32_t loopPasses; ///< K810Security::loop() passes since boot
+  uint16_t packets;    ///< Valid CRC link frames received
+  uint8_t macTag[8];   ///< SipHash-2-4 tag of the reference vector, computed in setup()
+  int8_t rxDrift;      ///< SoftSerial RX drift, see SoftSerial::getRxDrift()
+};
+
+/// Simulator mailbox, not cleared at reset
+extern volatile SimProbe simProbe;
+#endif
+
 #endif // GLOBALS_H
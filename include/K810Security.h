@@ -29,35 +29,87 @@ public:
 
     /**
      * @brief Main application loop
-     * Handles all periodic tasks including system monitoring, peripheral updates,
-     * communication processing, and business logic
+     * Runs one pass of the task table: the communication path on every pass,
+     * system monitoring, peripherals and business logic on their periods
      */
     void loop();
 
 private:
+    // Bluetooth AT command constants stored in program memory
+    static const char PROGMEM CMD_AT[];         ///< AT command
+    static const char PROGMEM CMD_RMAAD[];      ///< Factory reset command
+    static const char PROGMEM CMD_ROLE[];       ///< Set role command (slave)
+    static const char PROGMEM CMD_CMODE[];      ///< Set connection mode command (any address)
+    static const char PROGMEM CMD_NAME[];       ///< Set device name command
+    static const char PROGMEM CMD_PSWD[];       ///< Set pairing password command
+    static const char PROGMEM CMD_UART[];       ///< Set UART parameters command
+    static const char PROGMEM CMD_INIT[];       ///< Initialize command
+    static const char PROGMEM CMD_RESET[];      ///< Reset command
+    static const char PROGMEM CMD_UART_QUERY[]; ///< Query UART parameters command
+    static const char PROGMEM REPLY_UART[];     ///< Reply to the UART query when CMD_UART is applied
+    static const char PROGMEM CMD_UART_57600[];    ///< Set the 57600 baud data mode rate
+    static const char PROGMEM REPLY_UART_57600[];  ///< Reply to the UART query at 57600 baud
+    static const char PROGMEM CMD_UART_115200[];   ///< Set the 115200 baud data mode rate
+    static const char PROGMEM REPLY_UART_115200[]; ///< Reply to the UART query at 115200 baud
+
+    // Script step timings in milliseconds, steps advance as soon as the reply arrives
+    static constexpr uint16_t SETTLE_BASIC_CMD = 20;        ///< Settle time after a basic command reply
+    static constexpr uint16_t SETTLE_FACTORY_RESET = 200;   ///< Settle time after the factory reset reply
+    static constexpr uint16_t SETTLE_UART_CMD = 100;        ///< Settle time after the UART configuration reply
+    static constexpr uint16_t TIMEOUT_BASIC_CMD = 1000;     ///< Reply timeout for basic commands
+    static constexpr uint16_t TIMEOUT_FACTORY_RESET = 3000; ///< Reply timeout for the factory reset
+    static constexpr uint16_t TIMEOUT_RESET_CMD = 2000;     ///< Reply timeout for the module reset
+
+    // AT scripts stored in program memory
+    static const HC05::ScriptStep PROGMEM RESET_SCRIPT[]; ///< Factory reset and configuration script, a link rate script follows
+    static const HC05::ScriptStep PROGMEM LINK_RATE_SCRIPT_38400[];  ///< Data mode rate script, 38400 baud
+    static const HC05::ScriptStep PROGMEM LINK_RATE_SCRIPT_57600[];  ///< Data mode rate script, 57600 baud
+    static const HC05::ScriptStep PROGMEM LINK_RATE_SCRIPT_115200[]; ///< Data mode rate script, 115200 baud
+
+    // RESET_SCRIPT step selection
+    static constexpr uint8_t CONFIG_FIRST_STEP = 2;      ///< Index of the first configuration step (ROLE)
+    static constexpr uint8_t CONFIG_STEP_COUNT = 5;      ///< Configuration steps, ROLE to UART
+    static constexpr uint16_t STEP_MASK_AT = 0x0001;     ///< AT probe step
+    static constexpr uint16_t STEP_MASK_RMAAD = 0x0002;  ///< Factory reset step
+    static constexpr uint16_t STEP_MASK_CONFIG = 0x007C; ///< Configuration steps
+    static_assert(STEP_MASK_CONFIG == (((1U << CONFIG_STEP_COUNT) - 1) << CONFIG_FIRST_STEP),
+                  "STEP_MASK_CONFIG must cover the configuration steps");
+
+    static uint16_t appliedConfigSteps; ///< Configuration steps of the running script, stored on success
+
+    // Link rate script step selection, each script sets, verifies and resets
+    static constexpr uint8_t LINK_RATE_STEP_COUNT = 3;      ///< Steps of a link rate script
+    static constexpr uint16_t LINK_RATE_MASK_SET = 0x0001;  ///< AT+UART step
+    static constexpr uint16_t LINK_RATE_MASK_QUERY = 0x0002; ///< AT+UART? step, checks the reply
+    static constexpr uint16_t LINK_RATE_MASK_RESET = 0x0004; ///< Final reset step
+
     /**
-     * @brief Name of the class
+     * @brief Data mode rate of the HC05 link, the AT mode always runs at 38400
      */
-    static const char PROGMEM CLASS_NAME[];
+    struct LinkRate
+    {
+        uint32_t baud;                  ///< Rate in baud
+        BaudRate code;                  ///< SoftSerial code of the rate
+        const HC05::ScriptStep *script; ///< Script that applies the rate, LINK_RATE_STEP_COUNT steps
+    };
+    static const LinkRate PROGMEM LINK_RATES[]; ///< Rates, fastest first, the last one is the AT mode rate
+    static constexpr uint8_t LINK_RATE_COUNT = 3; ///< Entries of LINK_RATES
+    static constexpr uint8_t LINK_RATE_AT = LINK_RATE_COUNT - 1; ///< Index of 38400, the rate every module starts from
+    /// First rate tried; at 115200 SoftSerial would sample every 47 cycles, so it stays with the USART,
+    /// and 57600 (92 cycles) waits for SOFT_SERIAL_LINK_57600
+    static constexpr uint8_t LINK_RATE_FASTEST = HC05_HARDWARE_UART ? 0 : (SOFT_SERIAL_LINK_57600 ? 1 : LINK_RATE_AT);
 
-    // Bluetooth AT command constants stored in program memory
-    static const char PROGMEM CMD_AT[];    ///< AT command
-    static const char PROGMEM CMD_RMAAD[]; ///< Factory reset command
-    static const char PROGMEM CMD_ROLE[];  ///< Set role command (slave)
-    static const char PROGMEM CMD_CMODE[]; ///< Set connection mode command (any address)
-    static const char PROGMEM CMD_NAME[];  ///< Set device name command
-    static const char PROGMEM CMD_PSWD[];  ///< Set pairing password command
-    static const char PROGMEM CMD_UART[];  ///< Set UART parameters command
-    static const char PROGMEM CMD_INIT[];  ///< Initialize command
-    static const char PROGMEM CMD_RESET[]; ///< Reset command
-
-    // Command execution delays in milliseconds
-    static constexpr uint16_t DELAY_FACTORY_RESET = 1500; ///< Delay after factory reset
-    static constexpr uint16_t DELAY_BASIC_CMD = 300;      ///< Delay for basic commands
-    static constexpr uint16_t DELAY_UART_CMD = 500;       ///< Delay for UART configuration
-    static constexpr uint16_t DELAY_INIT_CMD = 2000;      ///< Delay after initialization
-    static constexpr uint16_t DELAY_RESET_CMD = 3000;     ///< Delay after reset
-    static constexpr uint16_t DELAY_FINAL_RESET = 1500;   ///< Delay after final reset
+    // Probe of an unconfirmed rate, counted in the CRC link statistic once the peer connects
+    static constexpr uint16_t LINK_PROBE_FRAMES = 8;        ///< Valid frames that confirm the rate
+    static constexpr uint16_t LINK_PROBE_MAX_FAULTS = 3;    ///< Rejected frames and resyncs that fail it
+    static constexpr uint16_t LINK_PROBE_TIMEOUT = 10000;   ///< Time to reach LINK_PROBE_FRAMES (milliseconds)
+
+    static uint8_t linkRateIndex;     ///< Entry of LINK_RATES the module is set to
+    static bool linkRateConfirmed;    ///< The rate carried the link, or there is nothing slower to try
+    static bool linkSerialDataMode;   ///< The serial runs at the data mode rate
+    static uint32_t linkProbeMillis;  ///< millis() when the probe started, 0 while no peer was connected
+    static uint16_t linkProbeFrames;  ///< Valid frames in the link statistic when the probe started
+    static uint16_t linkProbeFaults;  ///< Faults in the link statistic when the probe started
 
     /**
      * @brief Application state enumeration
@@ -71,14 +123,24 @@ private:
 
     // Member variables
     State state;                            ///< Current application state
-    SimpleTimer<uint16_t> operationTimeout; ///< Bluetooth connection timeout timer
+    SimpleTimer<uint16_t, LoopClock> operationTimeout; ///< Bluetooth connection timeout timer
+    uint32_t bootLockedMillis;              ///< millis() when the lock state and LEDs were applied
+    uint32_t bootConnectableMillis;         ///< millis() when the HC05 first reached data mode, 0 before
+    bool bootReported;                      ///< The banner went out to a USB host
 
     // Private methods
     /**
      * @brief Handles incoming Bluetooth data
-     * @param data The received data byte
+     * @param data The received bytes
+     * @param length Number of received bytes
+     */
+    static void bluetoothDataCallback(const uint8_t *data, const uint8_t length);
+
+    /**
+     * @brief Runs the binary telemetry frames on the telemetry channel and USB
+     * Bytes the peer sends on the channel are discarded
      */
-    static void bluetoothDataCallback(const char data);
+    void sendTelemetry();
 
     /**
      * @brief Handles Bluetooth command responses
@@ -86,15 +148,103 @@ private:
      * @param result Success status of the command
      * @param response Response text from the device
      */
-    static void bluetoothCallback(const __FlashStringHelper *command, const bool result, const String &response);
+    static void bluetoothCallback(const __FlashStringHelper *command, const bool result, const HC05::ResponseBuffer &response);
 
     /**
-     * @brief Handles Bluetooth reset command responses
-     * @param command The command that was executed
-     * @param result Success status of the command
-     * @param response Response text from the device
+     * @brief Handles Bluetooth script completion
+     * Forces data mode once the module has been reset
+     * @param success Whether the script completed
+     * @param failedStep Index of the failed step
+     */
+    static void bluetoothScriptCallback(const bool success, const uint8_t failedStep);
+
+    /**
+     * @brief Handles completion of the start-up configuration verify
+     * Falls back to replaying the whole configuration if the module does not match
+     * @param success Whether the script completed
+     * @param failedStep Index of the failed step
+     */
+    static void bluetoothVerifyCallback(const bool success, const uint8_t failedStep);
+
+    /**
+     * @brief Handles completion of a link rate script
+     * Falls back to the next slower rate if the module refuses this one
+     * @param success Whether the script completed
+     * @param failedStep Index of the failed step
+     */
+    static void bluetoothLinkRateCallback(const bool success, const uint8_t failedStep);
+
+    /**
+     * @brief Runs the script of the current link rate
+     * @param steps Mask of link rate script steps to run
+     * @param callback Function to call when the script finishes
+     */
+    static void runLinkRateScript(const uint16_t steps, const HC05::ScriptCallback callback);
+
+    /**
+     * @brief Selects the link rate to start from, the one confirmed earlier or the fastest
+     */
+    static void loadLinkRate();
+
+    /**
+     * @brief Retunes the serial to LINK_RATES[index]
+     * @param index Entry of LINK_RATES
      */
-    static void bluetoothResetCallback(const __FlashStringHelper *command, const bool result, const String &response);
+    static void setLinkSerialRate(const uint8_t index);
+
+    /**
+     * @brief Confirms or falls back from an unconfirmed link rate by the link statistic
+     */
+    static void checkLinkRate();
+
+    /**
+     * @brief Stores the current link rate in EEPROM
+     */
+    static void storeLinkRate();
+
+    /**
+     * @brief Moves to the next slower link rate, storing the AT mode rate once reached
+     */
+    static void stepDownLinkRate();
+
+    /**
+     * @brief STATE pin change interrupt handler of the HC05 module
+     */
+    static void hc05StateEdge();
+
+    /**
+     * @brief Locks the keyboard on disconnect from the STATE pin interrupt
+     * @param connected Level of the STATE pin after the edge
+     */
+    static void hc05StateFastLock(const bool connected);
+
+    static volatile bool fastLockArmed; ///< Set by loop() while a disconnect must lock the keyboard
+    static bool linkConnected;          ///< Link state last recorded in the event journal
+
+    /**
+     * @brief Runs the configuration steps of RESET_SCRIPT
+     * @param steps Mask of RESET_SCRIPT steps to run
+     */
+    static void runConfigScript(const uint16_t steps);
+
+    /**
+     * @brief Finds configuration steps whose stored hash does not match the firmware
+     * @return Mask of RESET_SCRIPT configuration steps to replay
+     */
+    static uint16_t staleConfigSteps();
+
+    /**
+     * @brief Stores the hashes of applied configuration steps in EEPROM
+     * @param steps Mask of RESET_SCRIPT configuration steps that were applied
+     */
+    static void storeConfigHashes(const uint16_t steps);
+
+    /**
+     * @brief Hashes the command of a configuration step
+     * @param step Index of the step in RESET_SCRIPT
+     * @return Non-zero hash of the command text
+     */
+    static uint8_t configHash(const uint8_t step);
 
     /**
      * @brief Sends a Bluetooth command with callback
@@ -102,7 +252,7 @@ private:
      * @param callback Function to call when command completes
      * @param delayMs Delay before next command
      */
-    void sendBluetoothCommand(const char *cmd_progmem, HC05::CommandCallback callback, uint16_t delayMs);
+    void sendBluetoothCommand(const char *cmd_progmem, HC05::ResponseCallback callback, uint16_t delayMs);
 
     /**
      * @brief Executes the Bluetooth reset sequence
@@ -122,11 +272,50 @@ private:
      */
     void handleBusinessLogic();
 
+    /**
+     * @brief Runs the boot stages that wait on something
+     * Takes the connectable time and prints the banner once a USB host opens the port
+     */
+    void advanceBoot();
+
+#if !HC05_HARDWARE_UART
     /**
      * @brief Sets up Timer1 for software serial communication
      * @param oversampleBitPeriod Timer period for bit sampling
      */
     static void timer1Setup(const unsigned long oversampleBitPeriod);
+
+    /**
+     * @brief Stops or restarts Timer1 sampling for edge-triggered RX
+     * @param run True to restart the timer, false to wait for a start edge
+     */
+    static void timer1Gate(const bool run);
+
+    /**
+     * @brief Start-edge interrupt handler for the HC05 RX pin
+     */
+    HOT_PATH static void rxStartEdge();
+#endif
+
+    // Main loop tasks, the context is the K810Security instance
+    static const TaskScheduler::Task PROGMEM TASKS[]; ///< Task table, grouped by statistic
+
+    static void taskWatchdog(void *context);   ///< Feeds the watchdog
+    static void taskStatistics(void *context); ///< Stack scan and ISR load windows
+    static void taskOutput(void *context);     ///< Drains trace, report and binary trace output to USB
+    static void taskBoot(void *context);       ///< Boot stages waiting on USB and the HC05
+    static void taskKeyboard(void *context);   ///< Keyboard controller
+    static void taskLink(void *context);       ///< Software serial, HC05, CRC link and the encoded splice
+    static void taskTelemetry(void *context);  ///< Telemetry frames
+    static void taskFastLock(void *context);   ///< Locks the keyboard on disconnect
+    static void taskCommands(void *context);   ///< Bluetooth command parser
+    static void taskConsole(void *context);    ///< USB command parser
+    static void taskInput(void *context);      ///< Button and business logic
+    static void taskEEPROM(void *context);     ///< EEPROM formatting and the event journal
+    static void taskEntropy(void *context);    ///< Entropy pool sampling
+#if LINK_BENCH
+    static void taskBench(void *context);      ///< Link benchmark payloads and echoes
+#endif
 };
 
 #endif // K810_SECURITY_H
\ No newline at end of file
@@ -16,6 +16,7 @@
 
 // Third-party libraries
 #include <FastPin.h>
+#include <Statistic.h>
 #include <Traceable.h>
 
 /**
@@ -23,12 +24,40 @@
  */
 #define SEED_LENGTH 16
 
+/// Bytes of a lock/unlock challenge nonce
+#define CHALLENGE_NONCE_LENGTH 8
+
+#ifndef CHALLENGE_TIMEOUT_MS
+/// Time the tag of a challenge has to arrive in
+#define CHALLENGE_TIMEOUT_MS 5000
+#endif
+
+/// Longest wait for the stepped challenge epoch to reach EEPROM before the first nonce of a boot
+constexpr uint16_t CHALLENGE_EPOCH_WRITE_TIMEOUT_MS = 100;
+
+#ifndef KEYBOARD_POWER_PIN
+/// Pin controlling power to the keyboard
+#define KEYBOARD_POWER_PIN 19
+#endif
+#ifndef KEYBOARD_DP_PIN
+/// Pin controlling D+ pin of usb of the keyboard
+#define KEYBOARD_DP_PIN 4
+#endif
+#ifndef KEYBOARD_DM_PIN
+/// Pin controlling D- pin of usb of the keyboard
+#define KEYBOARD_DM_PIN 5
+#endif
+
 /**
  * @brief Class to control keyboard power and manage encryption for secure communication.
  *
  * This class provides functionality to control the power state of the keyboard,
  * manage locking/unlocking, and handle encryption/decryption of data for secure
  * communication with the keyboard.
+ *
+ * The control pins are fixed at compile time (KEYBOARD_POWER_PIN, KEYBOARD_DP_PIN,
+ * KEYBOARD_DM_PIN), so every pin access is a single sbi/cbi instruction and
+ * lockFromISR() cannot corrupt a port write of the main loop.
  */
 class KeyboardController final : public Traceable
 {
@@ -42,15 +71,21 @@ public:
     UNLOCKED   ///< Keyboard is unlocked (accessible)
   };
 
+  /**
+   * @brief Action a challenge tag authorizes, the last byte of the MAC message.
+   */
+  enum ChallengeAction : uint8_t
+  {
+    CHALLENGE_LOCK = 'L',  ///< Lock the keyboard
+    CHALLENGE_UNLOCK = 'U' ///< Unlock the keyboard
+  };
+
   /**
    * @brief Constructor that initializes the keyboard controller.
-   * @param keyboardPowerPin The pin used to control power to the keyboard.
-   * @param keyboardDpPin The pin used to control d+ pin of the keyboard.
-   * @param keyboardDmPin The pin used to control d- pin of the keyboard.
+   *
+   * Drives the power, D+ and D- pins low, leaving the keyboard locked.
    */
-  explicit KeyboardController(const uint8_t keyboardPowerPin,
-                              const uint8_t keyboardDpPin,
-                              const uint8_t keyboardDmPin);
+  KeyboardController();
 
   /**
    * @brief Get the current state of the keyboard.
@@ -60,8 +95,23 @@ public:
 
   /**
    * @brief Lock the keyboard by cutting power.
+   *
+   * Same bounded path as lockFromISR(), the trace follows from loop().
+   *
+   * @param triggerMicros micros() stamp of the event that asked for the lock.
+   */
+  void lock(const uint32_t triggerMicros = micros());
+
+  /**
+   * @brief Lock the keyboard from interrupt context.
+   *
+   * Only direct port writes: power, D+ and D- low and both data lines
+   * driven. The trigger-to-blocked latency is handed to loop(), which adds it
+   * to lockLatency() and traces the lock.
+   *
+   * @param triggerMicros micros() stamp of the event that asked for the lock.
    */
-  void lock();
+  void lockFromISR(const uint32_t triggerMicros);
 
   /**
    * @brief Unlock the keyboard by providing power.
@@ -69,6 +119,21 @@ public:
    */
   void unlock(const bool releaseUSBFlag = true);
 
+  /**
+   * @brief Load the salt, the seed checked flag and the seed from EEPROM.
+   *
+   * Called once at boot. The accessors below then answer from RAM, and
+   * generation and seedChecked() write through to EEPROM.
+   */
+  static void loadSecurityState();
+
+  /**
+   * @brief Drop the cached security state, e.g. while EEPROM is formatted.
+   *
+   * The next accessor reloads it from EEPROM.
+   */
+  static void invalidateSecurityState();
+
   /**
    * @brief Generate a random seed for encryption.
    * @param seedArr Pointer to the array to store the generated seed.
@@ -94,6 +159,33 @@ public:
    */
   static void seedChecked();
 
+  /**
+   * @brief Issue a new lock/unlock challenge, replacing an unanswered one.
+   *
+   * The nonce is the challenge epoch, stepped in EEPROM at the first
+   * challenge of each boot, and a counter of this boot, so no nonce repeats
+   * across resets. No nonce leaves before the stepped epoch is written:
+   * the first challenge of a boot waits for the EEPROM writer to go idle,
+   * up to CHALLENGE_EPOCH_WRITE_TIMEOUT_MS.
+   *
+   * @param nonce Destination of CHALLENGE_NONCE_LENGTH bytes.
+   * @return false if the epoch is not written yet; no challenge was issued.
+   */
+  static bool createChallenge(byte *const nonce);
+
+  /**
+   * @brief Check the tag answering the pending challenge.
+   *
+   * The tag is SipHash-2-4 keyed with the seed over the nonce followed by
+   * the action byte, compared in constant time. The challenge is used up
+   * whatever the result, and expires after CHALLENGE_TIMEOUT_MS.
+   *
+   * @param action The action the tag has to authorize.
+   * @param tag SipHash::TAG_LENGTH bytes received.
+   * @return True if the tag is valid for the pending challenge and action.
+   */
+  static bool verifyChallenge(const ChallengeAction action, const byte *const tag);
+
   /**
    * @brief Encrypt data using the internal seed.
    * @param dataArr Pointer to the data array to encrypt.
@@ -148,10 +240,17 @@ public:
    */
   static uint16_t getVersion();
 
+  /**
+   * @brief Trigger-to-USB-blocked latency of the locks so far.
+   * @return The statistic, shown by the "stats" command.
+   */
+  const Statistic &lockLatency() const { return m_lockLatency; }
+
   /**
    * @brief Perform regular maintenance tasks.
    *
-   * This should be called in the main program loop.
+   * This should be called in the main program loop. Records and traces a
+   * lock taken since the last call.
    */
   void loop();
 
@@ -166,15 +265,53 @@ public:
   void releaseUSB();
 
 private:
+  /**
+   * @brief RAM copy of the security bytes in EEPROM, 0 meaning not set.
+   */
+  struct SecurityState
+  {
+    byte salt;              ///< Encryption salt
+    byte seedChecked;       ///< Seed verification flag
+    byte seed[SEED_LENGTH]; ///< Encryption seed
+  };
+
+  /**
+   * @brief Outstanding lock/unlock challenge.
+   */
+  struct Challenge
+  {
+    uint32_t epoch;                     ///< Challenge epoch of this boot
+    uint32_t count;                     ///< Challenges issued in this boot
+    uint32_t issuedMillis;              ///< millis() when the pending one was issued
+    byte nonce[CHALLENGE_NONCE_LENGTH]; ///< Nonce of the pending one
+    bool pending;                       ///< A challenge waits for its tag
+    bool epochStepped;                  ///< epoch was read and stepped in EEPROM
+    bool epochStored;                   ///< The stepped epoch has reached EEPROM
+  };
+
   /**
    * @brief Reset the I2C communication.
    */
   void resetI2C();
 
-  FastPin m_keyboardPowerOutput; ///< Pin controlling keyboard power
-  FastPin m_keyboardDpControl;   ///< Pin controlling d+ pin of keyboard
-  FastPin m_keyboardDmControl;   ///< Pin controlling d- pin of keyboard
-  State m_state;                 ///< Current state of the keyboard controller
+  /**
+   * @brief Get the cached security state, loading it first if needed.
+   * @return The cache, written through by its callers.
+   */
+  static SecurityState &securityState();
+
+  typedef StaticFastPin<KEYBOARD_POWER_PIN> PowerPin; ///< Pin controlling keyboard power
+  typedef StaticFastPin<KEYBOARD_DP_PIN> DpPin;       ///< Pin controlling d+ pin of keyboard
+  typedef StaticFastPin<KEYBOARD_DM_PIN> DmPin;       ///< Pin controlling d- pin of keyboard
+
+  volatile State m_state;                 ///< Current state of the keyboard controller, also written by lockFromISR()
+  volatile bool m_lockPending;            ///< A lock happened that loop() has not traced yet
+  volatile uint32_t m_pendingLockLatency; ///< Latency of that lock in microseconds
+  Statistic m_lockLatency;                ///< Trigger-to-USB-blocked latency of the locks
+
+  static SecurityState security; ///< Cached EEPROM security state
+  static bool securityLoaded;    ///< Whether security mirrors EEPROM
+  static Challenge challenge;    ///< Lock/unlock challenge state
 }; // end KeyboardController class
 
 #endif
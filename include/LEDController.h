@@ -12,8 +12,8 @@
 #ifndef LEDCONTROLLER_H
 #define LEDCONTROLLER_H
 
-// Third-party libraries
-#include <ezLED.h>
+// Project headers
+#include "LEDPatternEngine.h"
 
 /// Duration in milliseconds for fast LED blinking
 #ifndef LED_FAST_BLINK_DURATION
@@ -29,8 +29,9 @@
  * @brief Class for managing LED indicators to show system state.
  *
  * This class controls green and red LEDs to indicate various system states
- * through different blinking patterns and colors. It uses the ezLED library
- * for efficient LED control.
+ * through different blinking patterns and colors. The patterns are played by
+ * an LEDPatternEngine from its timer interrupt, so setState() is all the
+ * main loop does.
  */
 class LEDController final
 {
@@ -50,11 +51,18 @@ public:
 
   /**
    * @brief Constructor that initializes the LED controller.
-   * @param greenLEDPin The pin connected to the green LED.
-   * @param redLEDPin The pin connected to the red LED.
+   * @param engine The pattern engine driving the LEDs.
+   * @param greenChannel The engine channel of the green LED.
+   * @param redChannel The engine channel of the red LED.
    */
-  LEDController(const uint8_t greenLEDPin,
-                const uint8_t redLEDPin);
+  LEDController(LEDPatternEngine &engine,
+                const uint8_t greenChannel,
+                const uint8_t redChannel);
+
+  /**
+   * @brief Show the current state, once the channels are attached.
+   */
+  void begin();
 
   /**
    * @brief Get the current state being displayed by the LEDs.
@@ -68,18 +76,16 @@ public:
    */
   void setState(const State state);
 
+private:
   /**
-   * @brief Update LED patterns based on the current state.
-   *
-   * This should be called regularly in the main program loop to
-   * maintain LED blinking patterns.
+   * @brief Start the patterns of the current state.
    */
-  void loop();
+  void show();
 
-private:
-  ezLED m_greenLED; ///< Green LED controller
-  ezLED m_redLED;   ///< Red LED controller
-  State m_state;    ///< Current display state
+  LEDPatternEngine &m_engine;   ///< Engine playing the patterns
+  const uint8_t m_greenChannel; ///< Green LED channel
+  const uint8_t m_redChannel;   ///< Red LED channel
+  State m_state;                ///< Current display state
 }; // end LEDController class
 
 #endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * @file LEDPatternEngine.h
+ * @brief Timer driven LED patterns.
+ *
+ * This file defines the LEDPatternEngine class, which plays LED patterns
+ * described as PROGMEM step tables from the Timer4 overflow interrupt, so
+ * blink cadence does not depend on the main loop.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef LEDPATTERNENGINE_H
+#define LEDPATTERNENGINE_H
+
+// Arduino core
+#include <Arduino.h>
+
+/// Number of LEDs the engine drives
+#ifndef LED_PATTERN_CHANNELS
+#define LED_PATTERN_CHANNELS 4
+#endif
+
+/// Length of one pattern tick in milliseconds
+#ifndef LED_PATTERN_TICK_MS
+#define LED_PATTERN_TICK_MS 10
+#endif
+
+/// Timer4 TOP for one tick with the clock divided by 1024
+#define LED_PATTERN_TIMER4_TOP (F_CPU / 1024 * LED_PATTERN_TICK_MS / 1000 - 1)
+
+/**
+ * @brief Class playing LED step tables from a timer interrupt.
+ *
+ * Each channel drives one pin through a table of steps, a level held for a
+ * number of ticks. A step with 0 ticks ends the table and the pattern starts
+ * over, so a steady level is one step followed by the end marker. The table
+ * must hold at least one step.
+ *
+ * Timer4 runs in normal mode with its outputs disconnected; the LEDs are on
+ * plain port pins, so the overflow interrupt writes them. Changing a
+ * pattern is the only main loop work.
+ */
+class LEDPatternEngine final
+{
+public:
+  /**
+   * @brief One step of a pattern, stored in PROGMEM.
+   */
+  struct Step
+  {
+    uint8_t level; ///< Pin level, 1 for HIGH
+    uint8_t ticks; ///< Ticks to hold the level, 0 to end the table
+  };
+
+  /**
+   * @brief Assign a pin to a channel and make it an output.
+   *
+   * @param channel Channel index, below LED_PATTERN_CHANNELS.
+   * @param pin Arduino pin of the LED.
+   */
+  void attach(const uint8_t channel, const uint8_t pin);
+
+  /**
+   * @brief Start the Timer4 tick.
+   */
+  void begin();
+
+  /**
+   * @brief Start a pattern on a channel from its first step.
+   *
+   * The first level is written right away.
+   *
+   * @param channel Channel index.
+   * @param pattern Step table in PROGMEM, nullptr to stop the channel.
+   */
+  void play(const uint8_t channel, const Step *pattern);
+
+  /**
+   * @brief Advance every channel by one tick, called from the Timer4 interrupt.
+   */
+  void processISR();
+
+private:
+  /**
+   * @brief Playback state of one LED.
+   */
+  struct Channel
+  {
+    volatile uint8_t *port; ///< Port output register, nullptr until attached
+    const Step *pattern;    ///< First step of the pattern
+    const Step *step;       ///< Next step to play
+    uint8_t mask;           ///< Pin bit in the port
+    uint8_t ticksLeft;      ///< Ticks until the next step
+  };
+
+  /**
+   * @brief Write the next step of a channel and load its duration.
+   *
+   * @param channel Channel with a pattern.
+   */
+  static void advance(Channel &channel);
+
+  Channel m_channels[LED_PATTERN_CHANNELS] = {};
+};
+
+#endif
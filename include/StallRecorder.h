@@ -0,0 +1,121 @@
+/**
+ * @file StallRecorder.h
+ * @brief Recorder for main loop iterations that overrun.
+ *
+ * This file defines the StallRecorder class, which captures the region
+ * timings and the link state of loop iterations longer than a threshold
+ * into a small ring, and keeps the last record across watchdog resets.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef STALLRECORDER_H
+#define STALLRECORDER_H
+
+#include <Arduino.h>
+#include <Statistic.h>
+
+/// Loop time in microseconds above which an iteration is recorded
+#ifndef STALL_THRESHOLD_US
+#define STALL_THRESHOLD_US 20000
+#endif
+
+/// Number of stall records kept in RAM
+#ifndef STALL_RECORD_COUNT
+#define STALL_RECORD_COUNT 4
+#endif
+
+/// Entries of statistics[] whose times are kept per record, the loop first
+#define STALL_REGION_COUNT 5
+
+/**
+ * @brief Class for recording loop stalls with their context.
+ *
+ * loop() checks the last loopStatistic interval after every iteration and,
+ * above the threshold, stores the time of each statistics[] region, the
+ * slowest one, the HC05 and CRC state and the queue fill levels. The
+ * watchdog interrupt stores the same from inside the stalled iteration with
+ * the region still open, which is the one that hangs; regions it has not
+ * reached yet show the previous iteration's time, and it adds the heartbeat
+ * it blames and the interrupted address. The newest record is
+ * mirrored to non-initialized RAM and shows up again after the reset.
+ */
+class StallRecorder final
+{
+public:
+  /// Record captured by the watchdog interrupt
+  static constexpr uint8_t FLAG_WATCHDOG = 0x01;
+  /// Record restored after a reset
+  static constexpr uint8_t FLAG_PREVIOUS_BOOT = 0x02;
+  /// The heartbeat was overdue, the loop itself kept running
+  static constexpr uint8_t FLAG_HEARTBEAT_OVERDUE = 0x04;
+  /// No region was open or slower than the others
+  static constexpr uint8_t NO_REGION = 0xFF;
+
+  /**
+   * @brief Context of one stalled loop iteration.
+   */
+  struct Record
+  {
+    uint32_t timestamp;                       ///< millis() at capture
+    uint16_t regionTimes[STALL_REGION_COUNT]; ///< Time of each statistics[] entry in microseconds
+    uint8_t region;                           ///< Index of the open or slowest region, NO_REGION if none
+    uint8_t flags;                            ///< FLAG_* bits
+    uint8_t hc05State;                        ///< HC05::State
+    uint8_t crcIncoming;                      ///< CRC incoming state machine
+    uint8_t crcOutgoing;                      ///< CRC window slots in use
+    uint8_t linkRx;                           ///< Bytes waiting in the Bluetooth link
+    uint8_t linkTxFree;                       ///< Free bytes towards the Bluetooth link
+    uint8_t dataPending;                      ///< Encoded bytes waiting for the link
+    uint8_t usbTxFree;                        ///< Free bytes in the USB CDC endpoint
+    uint8_t heartbeat;                        ///< WatchdogController::Heartbeat blamed by the watchdog
+    uint16_t address;                         ///< Byte address of the interrupted instruction, 0 if not from the watchdog
+  };
+
+  /**
+   * @brief Restore the record kept across the last reset.
+   */
+  void setup();
+
+  /**
+   * @brief Record the iteration that just ended if it overran.
+   *
+   * Call right after the loopStatistic measurement closes.
+   */
+  void loop();
+
+  /**
+   * @brief Record the stalled iteration from the watchdog interrupt.
+   *
+   * @param heartbeat The overdue heartbeat, or the last one to beat.
+   * @param overdue True if the heartbeat was overdue rather than the loop hung.
+   * @param address Byte address of the interrupted instruction.
+   */
+  void captureFromWatchdog(const uint8_t heartbeat, const bool overdue, const uint16_t address);
+
+  /**
+   * @brief Set the loop time that counts as a stall.
+   *
+   * @param threshold Threshold in microseconds, 0 disables recording.
+   */
+  void setThreshold(const uint16_t threshold) { m_threshold = threshold; }
+
+  /**
+   * @brief Display the threshold and all records, oldest first.
+   *
+   * @param print The output stream to display the records on.
+   */
+  void print(Print &print) const;
+
+private:
+  void capture(const uint8_t flags, const uint8_t heartbeat, const uint16_t address);
+  void store(const Record &record);
+  static void printRecord(Print &print, const Record &record);
+
+  Record m_records[STALL_RECORD_COUNT]; ///< Ring of records
+  uint8_t m_next = 0;                   ///< Ring index of the next record
+  uint8_t m_count = 0;                  ///< Records in the ring
+  uint16_t m_threshold = STALL_THRESHOLD_US; ///< Stall threshold in microseconds
+};
+
+#endif
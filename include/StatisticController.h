@@ -14,6 +14,16 @@
 #include <Arduino.h>
 #include <SimpleTimer.h>
 #include <Statistic.h>
+#include <IsrStatistic.h>
+
+class CRCPackageInterface;
+
+/**
+ * @brief Bytes of the painted stack gap checked per loop pass.
+ */
+#ifndef STACK_SCAN_BYTES
+#define STACK_SCAN_BYTES 16
+#endif
 
 /**
  * @brief Class for managing and displaying performance statistics.
@@ -33,7 +43,8 @@ public:
    * @brief Periodically update and display statistics.
    *
    * This method should be called regularly in the main program loop to
-   * update statistics and display them at defined intervals.
+   * update statistics and display them at defined intervals. Each call
+   * advances the stack high-water scan by STACK_SCAN_BYTES.
    *
    * @param print The output stream to display statistics on.
    */
@@ -45,17 +56,80 @@ public:
    * @param print The output stream to display the table on.
    * @param statistics Array of Statistic pointers to display.
    * @param statisticSize Number of statistics in the array.
+   * @param packageInterface Link whose counters follow the timings (optional).
    */
   void printStatisticTable(Print &print,
                            const Statistic *statistics[],
-                           const uint8_t statisticSize) const;
+                           const uint8_t statisticSize,
+                           const CRCPackageInterface *packageInterface = nullptr) const;
+
+  /**
+   * @brief Display one block of the statistics table.
+   *
+   * Blocks are the opening stars, one per statistic with the separator
+   * before it, the link counters, the RAM budget and the closing stars, so a
+   * ReportWriter can emit the table a line at a time.
+   *
+   * @param print The output stream to display the block on.
+   * @param block Block index, see statisticBlockCount().
+   * @param statistics Array of Statistic pointers to display.
+   * @param statisticSize Number of statistics in the array.
+   * @param packageInterface Link whose counters follow the timings (optional).
+   * @return false if @p block is past the table.
+   */
+  bool printStatisticBlock(Print &print,
+                           const uint8_t block,
+                           const Statistic *statistics[],
+                           const uint8_t statisticSize,
+                           const CRCPackageInterface *packageInterface = nullptr) const;
+
+  /**
+   * @brief Number of blocks printStatisticBlock() draws for a table.
+   *
+   * @param statisticSize Number of statistics in the table.
+   */
+  static uint8_t statisticBlockCount(const uint8_t statisticSize) { return statisticSize + 4; }
+
+#if STATISTIC_ISR_LOAD
+  /**
+   * @brief Close the load window of every ISR statistic.
+   *
+   * @param statistics Array of IsrStatistic pointers to update.
+   * @param statisticSize Number of statistics in the array.
+   */
+  void loopIsrStatistics(IsrStatistic *const statistics[], const uint8_t statisticSize);
+
+  /**
+   * @brief Display a formatted table of ISR statistics.
+   *
+   * @param print The output stream to display the table on.
+   * @param statistics Array of IsrStatistic pointers to display.
+   * @param statisticSize Number of statistics in the array.
+   */
+  void printIsrStatisticTable(Print &print,
+                              IsrStatistic *const statistics[],
+                              const uint8_t statisticSize) const;
+#endif
 
   /**
    * @brief Display RAM usage information.
    *
+   * The memory map followed by the RAM budget; printed once at boot.
+   *
    * @param print The output stream to display RAM information on.
    */
   void printRam(Print &print) const;
+
+  /**
+   * @brief Display the RAM budget.
+   *
+   * Free RAM now and at the stack high-water mark, the heap arena and its
+   * free list, the fill of every StaticPool and StaticArena, and with
+   * MEMORY_USAGE_HEAP_TAGS the heap bytes held per owner.
+   *
+   * @param print The output stream to display the budget on.
+   */
+  void printRamBudget(Print &print) const;
 }; // end StatisticController class
 
 #endif
\ No newline at end of file
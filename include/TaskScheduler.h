@@ -0,0 +1,148 @@
+/**
+ * @file TaskScheduler.h
+ * @brief Cooperative scheduler for the main loop tasks.
+ *
+ * This file defines the TaskScheduler class, which runs a static table of
+ * tasks from the main loop: time-critical ones on every pass, the others
+ * when their period has elapsed, and times each run against its budget.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <Arduino.h>
+#include <Statistic.h>
+#include <LoopClock.h>
+
+/// Tasks a scheduler can hold
+#ifndef TASK_SCHEDULER_MAX_TASKS
+#define TASK_SCHEDULER_MAX_TASKS 14
+#endif
+
+/// Time in microseconds a pass may spend before normal tasks wait for the next one
+#ifndef TASK_SCHEDULER_PASS_BUDGET_US
+#define TASK_SCHEDULER_PASS_BUDGET_US 2000
+#endif
+
+/// Set to 0 to leave out sleeping between passes
+#ifndef TASK_SCHEDULER_IDLE_SLEEP
+#define TASK_SCHEDULER_IDLE_SLEEP 1
+#endif
+
+/**
+ * @brief Class for running the main loop from a static task table.
+ *
+ * Tasks run in table order. A task with period 0 runs on every pass, others
+ * when their deadline has passed; a deadline that has fallen a whole period
+ * behind restarts from now, so a late task runs once instead of catching up.
+ * Initial deadlines are staggered by one millisecond per task, so tasks with
+ * the same period do not all fall due in the same pass.
+ *
+ * Once a pass has used TASK_SCHEDULER_PASS_BUDGET_US, due PRIORITY_NORMAL
+ * tasks are deferred to the next pass, where they run whatever the budget,
+ * so they are at most one pass late; PRIORITY_CRITICAL tasks always run.
+ * Every run is timed: the slowest one and the runs over the task's budget
+ * are kept per task.
+ *
+ * When a pass ends with no task deferred and no deadline reached, the MCU
+ * sleeps in SLEEP_MODE_IDLE until the next interrupt. Every peripheral keeps
+ * running in that mode, and the Timer0 millis() tick wakes it within about
+ * a millisecond, so no deadline is missed by more than that. Every-pass
+ * tasks must therefore only wait on interrupt-fed sources: serial RX, USB,
+ * pin edges or timers.
+ *
+ * Each task names the Statistic its time goes to. Consecutive tasks with the
+ * same Statistic form one measurement per pass, so keep them together in the
+ * table; a Statistic gets no sample in a pass where none of its tasks ran.
+ */
+class TaskScheduler final
+{
+public:
+  /// Task body, called with the context given to setup()
+  typedef void (*TaskFunction)(void *context);
+
+  /**
+   * @brief What happens to a due task once the pass budget is spent.
+   */
+  enum Priority : uint8_t
+  {
+    PRIORITY_CRITICAL, ///< Runs regardless of the pass budget
+    PRIORITY_NORMAL    ///< Waits for the next pass
+  };
+
+  /**
+   * @brief One entry of the task table, stored in PROGMEM.
+   */
+  struct Task
+  {
+    const char *name;     ///< PROGMEM name shown by print()
+    TaskFunction run;     ///< Task body
+    Statistic *statistic; ///< Measurement the run time goes to, nullptr for none
+    uint16_t periodMs;    ///< Time between runs in milliseconds, 0 for every pass
+    uint16_t budgetUs;    ///< Run time in microseconds above which a run counts as an overrun
+    Priority priority;    ///< Behaviour once the pass budget is spent
+  };
+
+  /**
+   * @brief Take over a task table.
+   *
+   * @param tasks Task table in PROGMEM, at most TASK_SCHEDULER_MAX_TASKS entries.
+   * @param taskCount Number of entries.
+   * @param context Passed to every task body.
+   */
+  void setup(const Task *tasks, const uint8_t taskCount, void *context);
+
+  /**
+   * @brief Run one pass over the task table.
+   */
+  void loop();
+
+  /**
+   * @brief Display the schedule and the run time of each task.
+   *
+   * @param print The output stream to display the table on.
+   */
+  void print(Print &print) const;
+
+  /**
+   * @brief Clear the run time, overrun, deferral and idle counters.
+   */
+  void resetCounters();
+
+  /**
+   * @brief Allow or forbid sleeping between passes.
+   *
+   * @param enabled true to sleep when idle, the default.
+   */
+  void setIdleSleep(const bool enabled) { m_idleSleep = enabled; }
+
+private:
+  /**
+   * @brief Run time state of one task.
+   */
+  struct TaskState
+  {
+    uint16_t deadline;  ///< LoopClock::millis16() at which the task is due next
+    uint16_t maxUs;     ///< Slowest run in microseconds
+    uint16_t overruns;  ///< Runs over the task's budget
+    uint16_t deferrals; ///< Passes the task was due but deferred
+    bool deferred;      ///< Deferred on the last pass it was due
+  };
+
+  /**
+   * @brief Sleep until the next interrupt if no task needs to run now.
+   */
+  void idle();
+
+  const Task *p_tasks = nullptr;
+  void *p_context = nullptr;
+  uint8_t m_taskCount = 0;
+  TaskState m_states[TASK_SCHEDULER_MAX_TASKS];
+  bool m_idleSleep = true;      ///< Sleeping between passes is allowed
+  uint32_t m_idleUs = 0;        ///< Time asleep since the counters were cleared, saturating
+  uint32_t m_countersSince = 0; ///< millis() at which the counters were cleared
+};
+
+#endif
@@ -0,0 +1,138 @@
+/**
+ * @file TelemetryController.h
+ * @brief Compact binary telemetry frames for the CRC link and USB.
+ *
+ * This file defines the TelemetryController class, which packs the loop
+ * statistics, their histograms, the link counters, RAM usage and the reset
+ * reason into small versioned frames, sent on request or periodically,
+ * and reports lock state changes as they happen. telemetry_decoder.py and
+ * the Android app decode them.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef TELEMETRYCONTROLLER_H
+#define TELEMETRYCONTROLLER_H
+
+#include <Arduino.h>
+#include <SimpleTimer.h>
+
+/// Default interval of the frames on the telemetry channel in seconds, 0 = off
+#ifndef TELEMETRY_LINK_INTERVAL_S
+#define TELEMETRY_LINK_INTERVAL_S 5
+#endif
+
+/// Default interval of the frames on USB CDC in seconds, 0 = off
+#ifndef TELEMETRY_USB_INTERVAL_S
+#define TELEMETRY_USB_INTERVAL_S 0
+#endif
+
+/**
+ * @brief Class for building and sending binary telemetry frames.
+ *
+ * Frame layout, little-endian:
+ * - SYNC_0, SYNC_1, VERSION, type, payload length
+ * - payload
+ * - CRC-16-CCITT (initial 0xFFFF, as the link) over version..payload
+ *
+ * A burst is a TYPE_SUMMARY frame followed by the TYPE_HISTOGRAM frame of
+ * the next statistic in turn. Frames are built in RAM and drained as far as
+ * the output reports room, so neither USB CDC nor the link pipe blocks the
+ * loop. On the telemetry channel a frame is only written when the pipe takes
+ * all of it, otherwise the burst is skipped, so a peer that never reads the
+ * channel cannot wedge it. A frame cut by other output on a shared stream
+ * fails its CRC and the decoders skip it.
+ *
+ * notify() collects events until a TYPE_EVENT frame takes them to the
+ * telemetry channel, ahead of the next burst. Events wait while the pipe
+ * is short of room instead of being dropped, and coalesce meanwhile; the
+ * frame carries the keyboard state at sending, so the peer needs no query.
+ * Decoders skip types they do not know, so the new type left VERSION alone.
+ */
+class TelemetryController final
+{
+public:
+  static constexpr uint8_t SYNC_0 = 0xC3;         ///< First frame byte
+  static constexpr uint8_t SYNC_1 = 0x3C;         ///< Second frame byte
+  static constexpr uint8_t VERSION = 1;           ///< Layout version, bumped on any change to an existing type
+  static constexpr uint8_t TYPE_SUMMARY = 0;      ///< Uptime, reset, RAM, statistics, link counters
+  static constexpr uint8_t TYPE_HISTOGRAM = 1;    ///< Histogram of one statistic
+  static constexpr uint8_t TYPE_EVENT = 2;        ///< Events since the last event frame and the keyboard state
+  static constexpr uint8_t HEADER_LENGTH = 5;     ///< Sync, version, type, length
+  static constexpr uint8_t FRAME_SIZE = 96;       ///< Largest frame
+
+  /**
+   * @brief Event bits of a TYPE_EVENT frame.
+   */
+  enum Event : uint8_t
+  {
+    EVENT_LOCK = 0x01,               ///< Keyboard locked
+    EVENT_UNLOCK = 0x02,             ///< Keyboard unlocked
+    EVENT_FORMAT = 0x04,             ///< Formatting started, the keypad resets when it is done
+    EVENT_DISCONNECT_PENDING = 0x08, ///< Bluetooth reset started, the link is about to drop
+    EVENT_CONNECT = 0x10             ///< Bluetooth link connected
+  };
+
+  /**
+   * @brief Queue events for the next TYPE_EVENT frame on the telemetry channel.
+   *
+   * @param events Event bits.
+   */
+  void notify(const uint8_t events) { m_pendingEvents |= events; }
+
+  /**
+   * @brief Queue a burst to an output unless one is being sent.
+   *
+   * @param output Destination, queried with availableForWrite().
+   * @return false if a burst is still being sent.
+   */
+  bool request(Print &output);
+
+  /**
+   * @brief Check whether a requested burst is still being sent to an output.
+   *
+   * @param output The output to check.
+   * @return True while request() frames for @p output are pending.
+   */
+  bool isSendingTo(const Print &output) const { return p_output == &output; }
+
+  /**
+   * @brief Set the periodic intervals.
+   *
+   * @param linkSeconds Interval on the telemetry channel, 0 disables.
+   * @param usbSeconds Interval on USB CDC, 0 disables.
+   */
+  void setIntervals(const uint16_t linkSeconds, const uint16_t usbSeconds);
+
+  /**
+   * @brief Start due bursts and drain the current frame.
+   *
+   * @param linkConnected The telemetry channel has a peer.
+   * @param usbConnected A host has the USB CDC port open.
+   */
+  void loop(const bool linkConnected, const bool usbConnected);
+
+private:
+  bool busy() const { return p_output != nullptr; }
+  void begin(const uint8_t type);
+  void put8(const uint8_t value);
+  void put16(const uint16_t value);
+  void put32(const uint32_t value);
+  void finish();
+  void buildSummary();
+  void buildHistogram();
+  void buildEvent();
+
+  uint8_t m_frame[FRAME_SIZE];              ///< Frame being sent
+  uint8_t m_length = 0;                     ///< Bytes in m_frame
+  uint8_t m_sent = 0;                       ///< Bytes of m_frame written
+  bool m_histogramPending = false;          ///< Burst continues with a histogram frame
+  uint8_t m_histogramIndex = 0;             ///< Statistic of the next histogram frame
+  uint8_t m_pendingEvents = 0;              ///< Event bits waiting for a TYPE_EVENT frame
+  uint8_t m_eventSequence = 0;              ///< Number of the last TYPE_EVENT frame, wrapping
+  Print *p_output = nullptr;                ///< Burst destination, nullptr when idle
+  SimpleTimer<uint32_t, LoopClock> m_linkTimer{TELEMETRY_LINK_INTERVAL_S * 1000ul}; ///< Telemetry channel interval
+  SimpleTimer<uint32_t, LoopClock> m_usbTimer{TELEMETRY_USB_INTERVAL_S * 1000ul};   ///< USB CDC interval
+};
+
+#endif
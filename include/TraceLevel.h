@@ -19,6 +19,18 @@
 #define TRACE_LEVEL_DEBUG   4
 #define TRACE_LEVEL_TRACE   5
 
+/**
+ * @brief Binary trace mode.
+ *
+ * When enabled, TRACE_*() calls queue compact binary records (component, level,
+ * timestamp, raw arguments) in a RAM ring instead of formatting text, and
+ * Traceable::flush() drains the ring in the background. Decode the stream
+ * on the host with trace_decoder.py.
+ */
+#ifndef TRACE_BINARY
+#define TRACE_BINARY 0
+#endif
+
 // Class-specific Debug Settings
 #define DEBUG_K810_SECURITY         TRACE_LEVEL_OFF
 #define DEBUG_HC05                  TRACE_LEVEL_OFF
@@ -28,5 +40,22 @@
 #define DEBUG_UTILITIES             TRACE_LEVEL_OFF
 #define DEBUG_I2C                   TRACE_LEVEL_OFF
 #define DEBUG_KEYBOARD_CONTROLLER   TRACE_LEVEL_OFF
+#define DEBUG_EVENT_JOURNAL         TRACE_LEVEL_OFF
+
+/**
+ * @brief Registry of trace components: X(id, name, compile time level).
+ *
+ * The position of an entry is its component ID, indexing the static name,
+ * level and output tables of Traceable. Add new components here.
+ */
+#define TRACE_COMPONENTS(X)                                                \
+    X(K810_SECURITY, "K810Security", DEBUG_K810_SECURITY)                  \
+    X(HC05, "HC05", DEBUG_HC05)                                            \
+    X(SOFT_SERIAL, "SoftSerial", DEBUG_SOFT_SERIAL)                        \
+    X(EEPROM_CONTROLLER, "EEPROMController", DEBUG_EEPROM_CONTROLLER)      \
+    X(CRC_PACKAGE, "CRCPackageInterface", DEBUG_CRC_PACKAGE)               \
+    X(I2C, "I2C", DEBUG_I2C)                                               \
+    X(KEYBOARD_CONTROLLER, "KeyboardController", DEBUG_KEYBOARD_CONTROLLER) \
+    X(EVENT_JOURNAL, "EventJournal", DEBUG_EVENT_JOURNAL)
 
 #endif // TRACE_LEVEL_H
\ No newline at end of file
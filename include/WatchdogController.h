@@ -14,12 +14,25 @@
 #include <Arduino.h>
 #include <avr/wdt.h>
 
+/// Milliseconds a heartbeat may stay silent before the supervisor stops kicking the watchdog
+#ifndef WATCHDOG_HEARTBEAT_TIMEOUT_MS
+#define WATCHDOG_HEARTBEAT_TIMEOUT_MS 1000
+#endif
+
 /**
  * @brief Singleton class to manage the microcontroller's watchdog timer.
  *
  * This class provides a safe interface to enable, disable, and interact with
  * the AVR watchdog timer. It also tracks the reason for the last microcontroller
  * reset and provides functionality for controlled resets.
+ *
+ * The supervised tasks call beat() each time they run. loop() kicks the
+ * watchdog only while every heartbeat seen so far is younger than
+ * WATCHDOG_HEARTBEAT_TIMEOUT_MS, so a task the loop stops running ends in a
+ * reset just like a hung loop. The watchdog runs in interrupt-then-reset
+ * mode: its interrupt saves the stalled heartbeat, the interrupted program
+ * counter and the statistics through the stall recorder, then waits for the
+ * reset.
  */
 class WatchdogController
 {
@@ -35,6 +48,19 @@ public:
     SOFT_RESET      ///< Reset triggered by software
   };
 
+  /**
+   * @brief Supervised tasks.
+   */
+  enum Heartbeat : uint8_t
+  {
+    HEARTBEAT_SOFT_SERIAL, ///< Software serial bit engine, unused with the hardware UART
+    HEARTBEAT_HC05,        ///< HC05 state machine
+    HEARTBEAT_CRC,         ///< CRC package interface
+    HEARTBEAT_EEPROM,      ///< EEPROM controller and event journal
+    HEARTBEAT_COUNT,       ///< Number of heartbeats
+    NO_HEARTBEAT = 0xFF    ///< No heartbeat beat yet
+  };
+
   // Delete copy constructor and assignment operator to ensure singleton pattern
   WatchdogController(const WatchdogController &) = delete;
   WatchdogController &operator=(const WatchdogController &) = delete;
@@ -76,13 +102,45 @@ public:
    */
   void printResetReason(Stream &stream) const;
 
+  /**
+   * @brief Get the reason for the last reset.
+   * @return The reset reason.
+   */
+  ResetReason getResetReason() const { return m_resetReason; }
+
+  /**
+   * @brief Mark a supervised task as alive.
+   *
+   * The heartbeat is supervised from its first beat on.
+   *
+   * @param heartbeat The task that runs now.
+   */
+  void beat(const Heartbeat heartbeat);
+
+  /**
+   * @brief Get the name of a heartbeat.
+   * @param heartbeat The heartbeat.
+   * @return Its name, "?" if out of range.
+   */
+  static const __FlashStringHelper *getHeartbeatName(const uint8_t heartbeat);
+
   /**
    * @brief Periodically service the watchdog timer.
    *
-   * This should be called regularly in the main program loop.
+   * This should be called regularly in the main program loop. The watchdog
+   * is only kicked while no heartbeat is overdue.
    */
   void loop();
 
+  /**
+   * @brief Save the stall context and wait for the reset.
+   *
+   * Called from the watchdog interrupt, never returns.
+   *
+   * @param stackPointer SP on entry to the interrupt, the return address sits above it.
+   */
+  void handleTimeout(const uint8_t *stackPointer);
+
 private:
   /**
    * @brief Private constructor to enforce singleton pattern.
@@ -94,7 +152,11 @@ private:
    */
   void setup();
 
-  ResetReason m_resetReason; ///< Stores the reason for the last reset
+  ResetReason m_resetReason;         ///< Stores the reason for the last reset
+  uint16_t m_beats[HEARTBEAT_COUNT]; ///< LoopClock::millis16() of each heartbeat's last beat
+  uint8_t m_armed;                   ///< Bit per heartbeat that has beaten
+  volatile uint8_t m_lastBeat;       ///< Heartbeat that beat last, NO_HEARTBEAT before the first
+  volatile uint8_t m_overdue;        ///< Heartbeat loop() withholds the kick for, NO_HEARTBEAT if none
 };
 
 /**
@@ -3,8 +3,26 @@
 
 #include <Arduino.h>
 #include "Pair.h"
+#include <new>
+
+#if MEMORY_USAGE_HEAP_TAGS
+#include <HeapAccount.h>
+// Default node allocator, counted under HeapTag::Map
+typedef TaggedHeapAllocator<HeapTag::Map> ArduinoMapHeapAllocator;
+#else
+// Default node allocator, plain malloc/free
+struct ArduinoMapHeapAllocator
+{
+    static const size_t MAX_SIZE = SIZE_MAX;
+
+    static void *allocate(size_t size) { return malloc(size); }
+    static void deallocate(void *block, size_t) { free(block); }
+};
+#endif
 
-template <typename KeyType, typename ValueType>
+// Nodes come from Allocator, a type with static allocate(size), deallocate(block, size)
+// and a MAX_SIZE constant; PoolAllocator over a StaticPool of NODE_SIZE blocks keeps the map off the heap
+template <typename KeyType, typename ValueType, typename Allocator = ArduinoMapHeapAllocator>
 class ArduinoMap
 {
 private:
@@ -18,10 +36,22 @@ private:
         Node(const KeyType &k, const ValueType &v) : key(k), value(v), next(nullptr) {}
     };
 
+    static_assert(sizeof(Node) <= Allocator::MAX_SIZE, "Allocator blocks are too small for a map node");
+
     Node *head;
     size_t mapSize;
 
+    // Destroy a node and give its memory back to the allocator
+    static void destroy(Node *node)
+    {
+        node->~Node();
+        Allocator::deallocate(node, sizeof(Node));
+    }
+
 public:
+    // Size of one node, the block size a pool for this map needs
+    static const size_t NODE_SIZE = sizeof(Node);
+
     // Constructor
     ArduinoMap() : head(nullptr), mapSize(0) {}
 
@@ -75,9 +105,10 @@ public:
         }
 
         // Create new node
-        Node *new_node = new Node(key, value);
-        if (!new_node)
+        void *memory = Allocator::allocate(sizeof(Node));
+        if (!memory)
             return false;
+        Node *new_node = new (memory) Node(key, value);
 
         // Insert at the beginning
         new_node->next = head;
@@ -121,7 +152,7 @@ public:
                     head = current->next;
                 }
 
-                delete current;
+                destroy(current);
                 mapSize--;
                 return true;
             }
@@ -140,7 +171,7 @@ public:
         while (current)
         {
             Node *next = current->next;
-            delete current;
+            destroy(current);
             current = next;
         }
         head = nullptr;
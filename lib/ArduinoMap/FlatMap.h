@@ -0,0 +1,181 @@
+/**
+ * @file FlatMap.h
+ * @brief Fixed-capacity map over a sorted array, without allocation
+ */
+
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#endif
+
+#include <stddef.h>
+#include "Pair.h"
+
+// Drop-in for ArduinoMap when the number of keys has a bound: up to Capacity entries
+// kept sorted by key in the object itself, found by binary search.
+// Keys need operator< (pointers compare by address), which also decides equality.
+template <typename KeyType, typename ValueType, size_t Capacity>
+class FlatMap
+{
+public:
+    typedef Pair<KeyType, ValueType> Entry;
+
+    // Most entries the map holds
+    static const size_t CAPACITY = Capacity;
+
+    static_assert(Capacity > 0, "A FlatMap needs room for one entry");
+
+    // Constructor
+    FlatMap() : mapSize(0) {}
+
+    // Insert a key-value pair, or update the value of a present key;
+    // false if the key is new and the map is full
+    bool insert(const KeyType &key, const ValueType &value)
+    {
+        const size_t index = lowerBound(key);
+        if (matches(index, key))
+        {
+            entries[index].second = value;
+            return true;
+        }
+        if (mapSize == Capacity)
+            return false;
+
+        // Make room, entries after the key move up one place
+        for (size_t i = mapSize; i > index; --i)
+        {
+            entries[i] = entries[i - 1];
+        }
+        entries[index] = Entry(key, value);
+        mapSize++;
+        return true;
+    }
+
+    // Get value by key
+    ValueType *get(const KeyType &key)
+    {
+        const size_t index = lowerBound(key);
+        return matches(index, key) ? &entries[index].second : nullptr;
+    }
+
+    // Get value by key
+    const ValueType *get(const KeyType &key) const
+    {
+        const size_t index = lowerBound(key);
+        return matches(index, key) ? &entries[index].second : nullptr;
+    }
+
+    // Remove a key-value pair from the map
+    bool remove(const KeyType &key)
+    {
+        const size_t index = lowerBound(key);
+        if (!matches(index, key))
+            return false;
+
+        for (size_t i = index + 1; i < mapSize; ++i)
+        {
+            entries[i - 1] = entries[i];
+        }
+        mapSize--;
+        // The vacated entry lets go of what it held, e.g. a String buffer
+        entries[mapSize] = Entry();
+        return true;
+    }
+
+    // Clear all entries from the map
+    void clear()
+    {
+        for (size_t i = 0; i < mapSize; ++i)
+        {
+            entries[i] = Entry();
+        }
+        mapSize = 0;
+    }
+
+    // Get the size of the map
+    size_t size() const
+    {
+        return mapSize;
+    }
+
+    // Check if map is empty
+    bool empty() const
+    {
+        return mapSize == 0;
+    }
+
+    // Check if map is full
+    bool full() const
+    {
+        return mapSize == Capacity;
+    }
+
+    // Iterator support, in key order; keys are read-only, values change through get()
+    class Iterator
+    {
+    private:
+        const Entry *current;
+
+    public:
+        explicit Iterator(const Entry *entry) : current(entry) {}
+
+        Iterator &operator++()
+        {
+            ++current;
+            return *this;
+        }
+
+        bool operator!=(const Iterator &other) const
+        {
+            return current != other.current;
+        }
+
+        const Entry &operator*() const
+        {
+            return *current;
+        }
+    };
+
+    Iterator begin() const { return Iterator(entries); }
+    Iterator end() const { return Iterator(entries + mapSize); }
+
+    // ConstIterator support, same as Iterator
+    typedef Iterator ConstIterator;
+
+    ConstIterator cbegin() const { return begin(); }
+    ConstIterator cend() const { return end(); }
+
+private:
+    Entry entries[Capacity];
+    size_t mapSize;
+
+    // Index of the first entry whose key is not less than key, mapSize if none
+    size_t lowerBound(const KeyType &key) const
+    {
+        size_t low = 0;
+        size_t high = mapSize;
+        while (low < high)
+        {
+            const size_t middle = low + (high - low) / 2;
+            if (entries[middle].first < key)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    // Check whether the entry at a lowerBound() result holds key
+    bool matches(const size_t index, const KeyType &key) const
+    {
+        return index < mapSize && !(key < entries[index].first);
+    }
+};
+
+#endif // FLAT_MAP_H
@@ -0,0 +1,144 @@
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include <FlatMap.h>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Map is empty", "[FlatMap]")
+{
+  FlatMap<int, int, 4> map;
+  REQUIRE(map.empty());
+  REQUIRE(map.size() == 0);
+  REQUIRE(map.get(1) == nullptr);
+  REQUIRE(!(map.begin() != map.end()));
+}
+
+TEST_CASE("Insert and get", "[FlatMap]")
+{
+  FlatMap<int, int, 4> map;
+  REQUIRE(map.insert(3, 30));
+  REQUIRE(map.insert(1, 10));
+  REQUIRE(map.insert(2, 20));
+
+  REQUIRE(map.size() == 3);
+  REQUIRE(*map.get(1) == 10);
+  REQUIRE(*map.get(2) == 20);
+  REQUIRE(*map.get(3) == 30);
+  REQUIRE(map.get(0) == nullptr);
+  REQUIRE(map.get(4) == nullptr);
+}
+
+TEST_CASE("Insert of a present key updates its value", "[FlatMap]")
+{
+  FlatMap<int, int, 2> map;
+  REQUIRE(map.insert(1, 10));
+  REQUIRE(map.insert(2, 20));
+  REQUIRE(map.insert(1, 11));
+
+  REQUIRE(map.size() == 2);
+  REQUIRE(*map.get(1) == 11);
+
+  *map.get(2) = 22;
+  REQUIRE(*map.get(2) == 22);
+}
+
+TEST_CASE("Full map refuses new keys only", "[FlatMap]")
+{
+  FlatMap<int, int, 2> map;
+  REQUIRE(map.insert(5, 50));
+  REQUIRE(map.insert(7, 70));
+  REQUIRE(map.full());
+
+  REQUIRE(!map.insert(6, 60));
+  REQUIRE(map.size() == 2);
+  REQUIRE(map.get(6) == nullptr);
+  REQUIRE(map.insert(5, 55));
+  REQUIRE(*map.get(5) == 55);
+}
+
+TEST_CASE("Remove", "[FlatMap]")
+{
+  FlatMap<int, int, 4> map;
+  for (int i = 0; i < 4; ++i)
+  {
+    REQUIRE(map.insert(i, i * 10));
+  }
+
+  REQUIRE(map.remove(1));
+  REQUIRE(!map.remove(1));
+  REQUIRE(!map.remove(9));
+  REQUIRE(map.size() == 3);
+  REQUIRE(map.get(1) == nullptr);
+  REQUIRE(*map.get(0) == 0);
+  REQUIRE(*map.get(2) == 20);
+  REQUIRE(*map.get(3) == 30);
+
+  // The freed slot takes a new key
+  REQUIRE(map.insert(8, 80));
+  REQUIRE(map.full());
+
+  map.clear();
+  REQUIRE(map.empty());
+  REQUIRE(map.get(0) == nullptr);
+}
+
+TEST_CASE("Iteration is in key order", "[FlatMap]")
+{
+  FlatMap<int, int, 8> map;
+  const int keys[] = {42, -3, 17, 0, 99, 5};
+  for (const int key : keys)
+  {
+    REQUIRE(map.insert(key, key * 2));
+  }
+  REQUIRE(map.remove(17));
+
+  const int expected[] = {-3, 0, 5, 42, 99};
+  size_t count = 0;
+  for (const auto &entry : map)
+  {
+    REQUIRE(count < 5);
+    REQUIRE(entry.first == expected[count]);
+    REQUIRE(entry.second == expected[count] * 2);
+    ++count;
+  }
+  REQUIRE(count == 5);
+
+  count = 0;
+  for (FlatMap<int, int, 8>::ConstIterator it = map.cbegin(); it != map.cend(); ++it)
+  {
+    REQUIRE((*it).first == expected[count]);
+    ++count;
+  }
+  REQUIRE(count == 5);
+}
+
+TEST_CASE("Pointer keys compare by address", "[FlatMap]")
+{
+  static const char names[3][4] = {"abc", "abc", "xyz"};
+  FlatMap<const char *, int, 4> map;
+  REQUIRE(map.insert(names[2], 2));
+  REQUIRE(map.insert(names[0], 0));
+  REQUIRE(map.insert(names[1], 1));
+
+  // Equal text at another address is another key
+  REQUIRE(map.size() == 3);
+  REQUIRE(*map.get(names[0]) == 0);
+  REQUIRE(*map.get(names[1]) == 1);
+  REQUIRE(*map.get(names[2]) == 2);
+
+  const char other[] = "abc";
+  REQUIRE(map.get(other) == nullptr);
+}
+
+TEST_CASE("Copies are independent", "[FlatMap]")
+{
+  FlatMap<int, int, 4> map;
+  REQUIRE(map.insert(1, 10));
+  FlatMap<int, int, 4> copy = map;
+  REQUIRE(map.insert(2, 20));
+
+  REQUIRE(copy.size() == 1);
+  REQUIRE(copy.get(2) == nullptr);
+  REQUIRE(*copy.get(1) == 10);
+}
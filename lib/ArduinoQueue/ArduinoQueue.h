@@ -23,12 +23,38 @@
 #define nullptr NULL
 #endif
 
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+
+#if MEMORY_USAGE_HEAP_TAGS
+#include <HeapAccount.h>
+/// Default node allocator, counted under HeapTag::Queue.
+typedef TaggedHeapAllocator<HeapTag::Queue> ArduinoQueueHeapAllocator;
+#else
+/**
+ * @brief Default node allocator, plain malloc/free.
+ */
+struct ArduinoQueueHeapAllocator
+{
+  static const size_t MAX_SIZE = SIZE_MAX;
+
+  static void *allocate(size_t size) { return malloc(size); }
+  static void deallocate(void *block, size_t) { free(block); }
+};
+#endif
+
 /**
  * @brief Lightweight queue implementation for Arduino.
  *
+ * Nodes come from @p Allocator, a type with static allocate(size),
+ * deallocate(block, size) and a MAX_SIZE constant. PoolAllocator over a
+ * StaticPool of NODE_SIZE blocks keeps the queue off the heap.
+ *
  * @tparam T Type of items stored in the queue.
+ * @tparam Allocator Source of the nodes.
  */
-template <typename T>
+template <typename T, typename Allocator = ArduinoQueueHeapAllocator>
 class ArduinoQueue
 {
 private:
@@ -41,13 +67,29 @@ private:
     Node *next; ///< Pointer to the next node in the linked list.
   };
 
+  static_assert(sizeof(Node) <= Allocator::MAX_SIZE, "Allocator blocks are too small for a queue node");
+
   Node *head;         ///< Pointer to the first node in the queue.
   Node *tail;         ///< Pointer to the last node in the queue.
   uint16_t maxItems;  ///< Maximum number of items the queue can store.
   uint16_t maxMemory; ///< Maximum memory (in bytes) the queue can use.
   uint16_t count;     ///< Current number of items in the queue.
 
+  /**
+   * @brief Destroy a node and give its memory back to the allocator.
+   */
+  static void destroy(Node *node)
+  {
+    node->~Node();
+    Allocator::deallocate(node, sizeof(Node));
+  }
+
 public:
+  /**
+   * @brief Size of one node, the block size a pool for this queue needs.
+   */
+  static const size_t NODE_SIZE = sizeof(Node);
+
   /**
    * @brief Constructor with optional maximum sizes.
    *
@@ -80,7 +122,7 @@ public:
     for (Node *node = head; node != nullptr; node = head)
     {
       head = node->next;
-      delete node;
+      destroy(node);
     }
   }
 
@@ -97,12 +139,13 @@ public:
       return false;
     }
 
-    Node *node = new Node;
-    if (node == nullptr)
+    void *memory = Allocator::allocate(sizeof(Node));
+    if (memory == nullptr)
     {
       return false;
     }
 
+    Node *node = new (memory) Node;
     node->item = item;
     node->next = nullptr;
 
@@ -137,7 +180,7 @@ public:
     head = node->next;
     T item = node->item;
     node->next = nullptr;
-    delete node;
+    destroy(node);
     node = nullptr;
 
     if (head == nullptr)
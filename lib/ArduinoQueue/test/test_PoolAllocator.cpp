@@ -0,0 +1,141 @@
+// Let Catch provide main():
+#define CATCH_CONFIG_MAIN
+
+#include <ArduinoQueue.h>
+#include <StaticPool.h>
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+// Pools register for good and are never unregistered, so they live as long as the program
+static const char POOL_NAME[] PROGMEM = "Test pool";
+static const char QUEUE_POOL_NAME[] PROGMEM = "Queue nodes";
+static const char ARENA_NAME[] PROGMEM = "Test arena";
+
+static StaticPool<8, 3> pool(POOL_NAME);
+typedef StaticPool<ArduinoQueue<uint8_t>::NODE_SIZE, 3> QueuePool;
+static QueuePool queuePool(QUEUE_POOL_NAME);
+static StaticArena<16> arena(ARENA_NAME);
+
+typedef ArduinoQueue<uint8_t, PoolAllocator<QueuePool, queuePool>> PooledQueue;
+
+// Print into a string, for MemoryPool::printAll()
+class StringPrint : public Print
+{
+public:
+  std::string text;
+
+  size_t write(uint8_t c) override
+  {
+    text += static_cast<char>(c);
+    return 1;
+  }
+};
+
+TEST_CASE("Pool hands out distinct blocks until it is empty", "[StaticPool]")
+{
+  const uint16_t block = pool.getCapacity() / 3;
+  void *a = pool.allocate(8);
+  void *b = pool.allocate(1);
+  void *c = pool.allocate(8);
+  REQUIRE(a != nullptr);
+  REQUIRE(b != nullptr);
+  REQUIRE(c != nullptr);
+  REQUIRE(a != b);
+  REQUIRE(b != c);
+  REQUIRE(a != c);
+  REQUIRE(pool.getUsed() == 3 * block);
+
+  REQUIRE(pool.allocate(1) == nullptr);
+  REQUIRE(pool.getFailures() == 1);
+  REQUIRE(pool.getUsed() == 3 * block);
+  REQUIRE(pool.getPeak() == pool.getCapacity());
+
+  // Freed blocks are reused, last freed first
+  pool.deallocate(b, 1);
+  pool.deallocate(a, 8);
+  REQUIRE(pool.getUsed() == block);
+  REQUIRE(pool.allocate(4) == a);
+  REQUIRE(pool.allocate(4) == b);
+  REQUIRE(pool.allocate(4) == nullptr);
+  REQUIRE(pool.getFailures() == 2);
+
+  // Requests larger than a block are refused even with blocks free
+  pool.deallocate(c, 8);
+  REQUIRE(pool.allocate(9) == nullptr);
+  REQUIRE(pool.getFailures() == 3);
+  REQUIRE(pool.getUsed() == 2 * block);
+
+  // Everything goes back, the peak stays
+  pool.deallocate(nullptr, 8);
+  pool.deallocate(a, 8);
+  pool.deallocate(b, 8);
+  REQUIRE(pool.getUsed() == 0);
+  REQUIRE(pool.getPeak() == pool.getCapacity());
+}
+
+TEST_CASE("Queue nodes come from the pool", "[PoolAllocator]")
+{
+  const uint16_t block = queuePool.getCapacity() / 3;
+  {
+    PooledQueue queue;
+    REQUIRE(queue.enqueue(1));
+    REQUIRE(queue.enqueue(2));
+    REQUIRE(queue.enqueue(3));
+    REQUIRE(queuePool.getUsed() == 3 * block);
+
+    // The pool is empty, the queue refuses the item
+    REQUIRE(!queue.enqueue(4));
+    REQUIRE(queuePool.getFailures() == 1);
+    REQUIRE(queue.itemCount() == 3);
+
+    REQUIRE(queue.dequeue() == 1);
+    REQUIRE(queuePool.getUsed() == 2 * block);
+    REQUIRE(queue.enqueue(4));
+    REQUIRE(queue.dequeue() == 2);
+    REQUIRE(queue.dequeue() == 3);
+    REQUIRE(queue.dequeue() == 4);
+    REQUIRE(queue.isEmpty());
+    REQUIRE(queuePool.getUsed() == 0);
+
+    REQUIRE(queue.enqueue(5));
+  }
+
+  // The destructor gives the remaining node back
+  REQUIRE(queuePool.getUsed() == 0);
+  REQUIRE(queuePool.getPeak() == queuePool.getCapacity());
+  REQUIRE(queuePool.getFailures() == 1);
+}
+
+TEST_CASE("Arena carves buffers once", "[StaticArena]")
+{
+  uint8_t *first = static_cast<uint8_t *>(arena.allocate(10));
+  REQUIRE(first != nullptr);
+  REQUIRE(arena.allocate(7) == nullptr);
+  REQUIRE(arena.getFailures() == 1);
+
+  uint8_t *second = static_cast<uint8_t *>(arena.allocate(6));
+  REQUIRE(second == first + 10);
+  REQUIRE(arena.getUsed() == 16);
+
+  // Nothing comes back before a reset
+  arena.deallocate(first, 10);
+  REQUIRE(arena.getUsed() == 16);
+  REQUIRE(arena.allocate(1) == nullptr);
+  REQUIRE(arena.getFailures() == 2);
+  REQUIRE(arena.getPeak() == 16);
+}
+
+TEST_CASE("Every pool is listed with its counters", "[MemoryPool]")
+{
+  StringPrint out;
+  MemoryPool::printAll(out);
+
+  const std::string arenaLine = std::string(ARENA_NAME) + ":" + std::to_string(arena.getUsed()) + "/16 B, peak:" +
+                                std::to_string(arena.getPeak()) + " B, failed:" +
+                                std::to_string(arena.getFailures()) + "\r\n";
+  REQUIRE(out.text.find(arenaLine) != std::string::npos);
+  REQUIRE(out.text.find(std::string(POOL_NAME) + ":") != std::string::npos);
+  REQUIRE(out.text.find(std::string(QUEUE_POOL_NAME) + ":") != std::string::npos);
+}
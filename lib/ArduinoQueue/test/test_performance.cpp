@@ -23,7 +23,7 @@ TEST_CASE("Enqueue and dequeue performance", "[single-file]")
     auto duration =
         std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
             .count();
-    avgEnDuration = avgEnDuration + ((duration - avgEnDuration) / i);
+    avgEnDuration = avgEnDuration + ((duration - avgEnDuration) / j);
 
     begin = std::chrono::steady_clock::now();
     for (int k = 0; k < 1000000; ++k)
@@ -34,7 +34,7 @@ TEST_CASE("Enqueue and dequeue performance", "[single-file]")
 
     duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
                    .count();
-    avgDeDuration = avgDeDuration + ((duration - avgDeDuration) / i);
+    avgDeDuration = avgDeDuration + ((duration - avgDeDuration) / j);
   }
 
   REQUIRE(avgEnDuration < 2000000000);
@@ -37,7 +37,7 @@ const char *ex_text = "This text goes to ";
 const char *ex_text2 = "Serial";
 const char *ex_text3 = "Console";
 
-LoopbackStream buffer(DEBUGBUFFER); // Loopback buffer for Serial & Telnet console debug output
+LoopbackStreamN<DEBUGBUFFER> buffer; // Loopback buffer for Serial & Telnet console debug output
 void setup()
 {
   Serial.begin(115200);
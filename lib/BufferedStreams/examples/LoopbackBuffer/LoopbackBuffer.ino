@@ -1,6 +1,6 @@
 #include <LoopbackStream.h>
 
-LoopbackStream buffer;
+LoopbackStreamN<> buffer;
 int clickCount2 = 0;
 int clickCount3 = 0;
 
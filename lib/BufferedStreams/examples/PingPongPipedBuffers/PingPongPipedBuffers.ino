@@ -1,6 +1,6 @@
 #include <PipedStream.h>
 
-PipedStreamPair pipes;
+PipedStreamPairN<> pipes;
 PipedStream &streamPing = pipes.first;
 PipedStream &streamPong = pipes.second;
 
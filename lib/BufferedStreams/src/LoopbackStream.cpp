@@ -9,74 +9,75 @@
  * @date 2025
  */
 #include "LoopbackStream.h"
+#include <string.h>
 
 /**
- * @brief Constructor that allocates memory for the internal buffer.
+ * @brief Constructor over a ring buffer owned by LoopbackStreamN.
  *
- * @param buffer_size Size of the buffer to allocate.
+ * @param buffer Ring buffer storage.
+ * @param buffer_size Size of the storage, a power of two.
  */
-LoopbackStream::LoopbackStream(uint16_t buffer_size)
+LoopbackStream::LoopbackStream(uint8_t *buffer, const uint16_t buffer_size)
+    : buffer(buffer), mask(buffer_size - 1), pos(0), size(0)
+{
+}
+
+/**
+ * @brief Clears the internal buffer by resetting read position and size.
+ */
+void LoopbackStream::clear()
 {
-  this->buffer = static_cast<uint8_t *>(malloc(buffer_size));
-  this->buffer_size = buffer_size;
   this->pos = 0;
   this->size = 0;
 }
 
 /**
- * @brief Destructor that frees the allocated buffer.
+ * @brief Gets the contiguous filled region starting at the read position.
+ *
+ * @param region Set to the first readable byte.
+ * @return The number of bytes in the region.
  */
-LoopbackStream::~LoopbackStream()
+uint16_t LoopbackStream::readableRegion(const uint8_t *&region) const
 {
-  free(buffer);
+  region = buffer + pos;
+  const uint16_t head = bufferSize() - pos;
+  return (size < head) ? size : head;
 }
 
 /**
- * @brief Move constructor that transfers ownership of the buffer.
+ * @brief Releases bytes read through readableRegion().
  *
- * @param other The LoopbackStream to move from.
+ * @param count The number of bytes to release.
  */
-LoopbackStream::LoopbackStream(LoopbackStream &&other) noexcept
-    : buffer(other.buffer), buffer_size(other.buffer_size), pos(other.pos), size(other.size)
+void LoopbackStream::consume(const uint16_t count)
 {
-  other.buffer = nullptr;
-  other.buffer_size = 0;
-  other.pos = 0;
-  other.size = 0;
+  pos = (pos + count) & mask;
+  size -= count;
 }
 
 /**
- * @brief Move assignment operator that transfers ownership of the buffer.
+ * @brief Gets the contiguous free region after the last byte written.
  *
- * @param other The LoopbackStream to move from.
- * @return Reference to this object.
+ * @param region Set to the first writable byte.
+ * @return The number of bytes in the region.
  */
-LoopbackStream &LoopbackStream::operator=(LoopbackStream &&other) noexcept
+uint16_t LoopbackStream::writableRegion(uint8_t *&region)
 {
-  if (this != &other)
-  {
-    free(buffer);
-
-    buffer = other.buffer;
-    buffer_size = other.buffer_size;
-    pos = other.pos;
-    size = other.size;
-
-    other.buffer = nullptr;
-    other.buffer_size = 0;
-    other.pos = 0;
-    other.size = 0;
-  }
-  return *this;
+  const uint16_t write_pos = (pos + size) & mask;
+  region = buffer + write_pos;
+  const uint16_t space = bufferSize() - size;
+  const uint16_t head = bufferSize() - write_pos;
+  return (space < head) ? space : head;
 }
 
 /**
- * @brief Clears the internal buffer by resetting read position and size.
+ * @brief Publishes bytes written through writableRegion().
+ *
+ * @param count The number of bytes to publish.
  */
-void LoopbackStream::clear()
+void LoopbackStream::commit(const uint16_t count)
 {
-  this->pos = 0;
-  this->size = 0;
+  size += count;
 }
 
 /**
@@ -93,16 +94,40 @@ int LoopbackStream::read()
   else
   {
     int ret = buffer[pos];
-    pos++;
+    pos = (pos + 1) & mask;
     size--;
-    if (pos == buffer_size)
-    {
-      pos = 0;
-    }
     return ret;
   }
 }
 
+/**
+ * @brief Reads a block of bytes from the buffer without waiting.
+ *
+ * @param data Destination of the bytes.
+ * @param length Maximum number of bytes to read.
+ * @return The number of bytes read.
+ */
+size_t LoopbackStream::readBytes(uint8_t *data, size_t length)
+{
+  if (length > size)
+  {
+    length = size;
+  }
+
+  // Up to the end of the buffer, then the rest from its start
+  size_t head = bufferSize() - pos;
+  if (head > length)
+  {
+    head = length;
+  }
+  memcpy(data, buffer + pos, head);
+  memcpy(data + head, buffer, length - head);
+
+  pos = (pos + length) & mask;
+  size -= length;
+  return length;
+}
+
 /**
  * @brief Writes a byte to the buffer.
  *
@@ -111,17 +136,45 @@ int LoopbackStream::read()
  */
 size_t LoopbackStream::write(uint8_t v)
 {
-  if (size == buffer_size)
+  if (size == bufferSize())
   {
     return 0;
   }
 
-  uint16_t write_pos = (pos + size) % buffer_size;
-  buffer[write_pos] = v;
+  buffer[(pos + size) & mask] = v;
   size++;
   return 1;
 }
 
+/**
+ * @brief Writes a block of bytes to the buffer.
+ *
+ * @param data The bytes to write.
+ * @param length The number of bytes to write.
+ * @return The number of bytes written, short if the buffer was full.
+ */
+size_t LoopbackStream::write(const uint8_t *data, size_t length)
+{
+  const uint16_t space = bufferSize() - size;
+  if (length > space)
+  {
+    length = space;
+  }
+
+  // Up to the end of the buffer, then the rest from its start
+  const uint16_t write_pos = (pos + size) & mask;
+  size_t head = bufferSize() - write_pos;
+  if (head > length)
+  {
+    head = length;
+  }
+  memcpy(buffer + write_pos, data, head);
+  memcpy(buffer, data + head, length - head);
+
+  size += length;
+  return length;
+}
+
 /**
  * @brief Returns the number of bytes available for reading.
  *
@@ -139,7 +192,7 @@ int LoopbackStream::available()
  */
 int LoopbackStream::availableForWrite()
 {
-  return buffer_size - size;
+  return bufferSize() - size;
 }
 
 /**
@@ -159,11 +212,7 @@ bool LoopbackStream::contains(char ch)
     {
       return true;
     }
-    current++;
-    if (current == buffer_size)
-    {
-      current = 0;
-    }
+    current = (current + 1) & mask;
     remaining--;
   }
   return false;
@@ -11,20 +11,37 @@
 #pragma once
 
 #include <Stream.h>
+#include <HotPath.h>
 
 /**
  * @brief A stream that stores written data and returns it when read.
  *
- * A LoopbackStream stores all data written in an internal buffer and returns it back
+ * A LoopbackStream stores all data written in a ring buffer and returns it back
  * when the stream is read. If the buffer overflows, the last bytes written are lost.
  * It can be used as a buffering layer between components.
+ *
+ * The ring buffer is not allocated here: LoopbackStreamN<N> owns it as a member,
+ * so every buffer shows up in the RAM map at link time. Its size is a power of
+ * two, which turns the wrap-around into a mask.
+ *
+ * The Stream overrides are final, so calls made through a LoopbackStream
+ * (as PipedStream does) bind directly instead of through the vtable.
  */
 class LoopbackStream : public Stream
 {
-  uint8_t *buffer;      ///< Pointer to the internal buffer.
-  uint16_t buffer_size; ///< Size of the internal buffer.
-  uint16_t pos;         ///< Current read position in the buffer.
-  uint16_t size;        ///< Number of bytes currently in the buffer.
+  uint8_t *buffer; ///< Ring buffer, owned by LoopbackStreamN.
+  uint16_t mask;   ///< Size of the ring buffer minus one.
+  uint16_t pos;    ///< Current read position in the buffer.
+  uint16_t size;   ///< Number of bytes currently in the buffer.
+
+protected:
+  /**
+   * @brief Constructor over an external buffer.
+   *
+   * @param buffer Ring buffer storage.
+   * @param buffer_size Size of the storage, a power of two.
+   */
+  LoopbackStream(uint8_t *buffer, const uint16_t buffer_size);
 
 public:
   /**
@@ -32,51 +49,62 @@ public:
    */
   static const uint16_t DEFAULT_SIZE = 64;
 
+  // The buffer lives in the derived object, so it can be neither copied nor moved
+  LoopbackStream(const LoopbackStream &) = delete;
+  LoopbackStream &operator=(const LoopbackStream &) = delete;
+
   /**
-   * @brief Constructor with optional buffer size.
+   * @brief Get the size of the internal buffer.
    *
-   * @param buffer_size Size of the internal buffer (default is DEFAULT_SIZE).
+   * @return Size of the internal buffer in bytes.
    */
-  explicit LoopbackStream(const uint16_t buffer_size = LoopbackStream::DEFAULT_SIZE);
+  inline uint16_t bufferSize() const
+  {
+    return mask + 1;
+  }
 
   /**
-   * @brief Destructor that frees the internal buffer.
+   * @brief Clear the internal buffer.
    */
-  ~LoopbackStream();
+  void clear();
 
   /**
-   * @brief Move constructor.
+   * @brief Get the contiguous filled region starting at the read position.
    *
-   * @param other The LoopbackStream to move from.
+   * The region ends at the wrap-around or at the last byte written,
+   * whichever comes first. Release it with consume().
+   *
+   * @param region Set to the first readable byte.
+   * @return Number of bytes in the region.
    */
-  LoopbackStream(LoopbackStream &&other) noexcept;
+  uint16_t readableRegion(const uint8_t *&region) const;
 
   /**
-   * @brief Move assignment operator.
+   * @brief Release bytes read through readableRegion().
    *
-   * @param other The LoopbackStream to move from.
-   * @return Reference to this object.
+   * @param count Number of bytes to release, at most the region's length.
    */
-  LoopbackStream &operator=(LoopbackStream &&other) noexcept;
-
-  // Delete copy operations
-  LoopbackStream(const LoopbackStream &) = delete;
-  LoopbackStream &operator=(const LoopbackStream &) = delete;
+  void consume(const uint16_t count);
 
   /**
-   * @brief Get the size of the internal buffer.
+   * @brief Get the contiguous free region after the last byte written.
    *
-   * @return Size of the internal buffer in bytes.
+   * The region ends at the wrap-around or at the read position, whichever
+   * comes first. Publish what was stored in it with commit().
+   *
+   * @param region Set to the first writable byte.
+   * @return Number of bytes in the region.
    */
-  inline uint16_t bufferSize() const
-  {
-    return buffer_size;
-  }
+  uint16_t writableRegion(uint8_t *&region);
 
   /**
-   * @brief Clear the internal buffer.
+   * @brief Publish bytes written through writableRegion().
+   *
+   * @param count Number of bytes to publish, at most the region's length.
    */
-  void clear();
+  void commit(const uint16_t count);
+
+  using Print::write;
 
   /**
    * @brief Write a byte to the buffer.
@@ -84,21 +112,32 @@ public:
    * @param data The byte to write.
    * @return Number of bytes written (1 on success, 0 if buffer is full).
    */
-  virtual size_t write(uint8_t data) override;
+  HOT_PATH virtual size_t write(uint8_t data) override final;
+
+  /**
+   * @brief Write a block of bytes to the buffer.
+   *
+   * Copies with at most two memcpy() calls across the wrap-around.
+   *
+   * @param data The bytes to write.
+   * @param length Number of bytes to write.
+   * @return Number of bytes written, short if the buffer fills up.
+   */
+  virtual size_t write(const uint8_t *data, size_t length) override final;
 
   /**
    * @brief Get the number of bytes available for writing.
    *
    * @return Number of bytes that can be written before the buffer is full.
    */
-  virtual int availableForWrite(void) override;
+  virtual int availableForWrite(void) override final;
 
   /**
    * @brief Get the number of bytes available for reading.
    *
    * @return Number of bytes available to read.
    */
-  virtual int available() override;
+  HOT_PATH virtual int available() override final;
 
   /**
    * @brief Check if the buffer contains a specific character.
@@ -106,26 +145,64 @@ public:
    * @param ch The character to search for.
    * @return true if the character is found, false otherwise.
    */
-  virtual bool contains(char ch);
+  bool contains(char ch);
 
   /**
    * @brief Read a byte from the buffer.
    *
    * @return The next byte in the buffer, or -1 if the buffer is empty.
    */
-  virtual int read() override;
+  HOT_PATH virtual int read() override final;
+
+  /**
+   * @brief Read a block of bytes from the buffer.
+   *
+   * Unlike Stream::readBytes() this never waits: it returns what is
+   * buffered, up to length bytes.
+   *
+   * @param data Destination of the bytes.
+   * @param length Maximum number of bytes to read.
+   * @return Number of bytes read.
+   */
+  size_t readBytes(uint8_t *data, size_t length);
+
+  /**
+   * @brief Read a block of bytes from the buffer.
+   *
+   * @see readBytes(uint8_t *, size_t)
+   */
+  size_t readBytes(char *data, size_t length)
+  {
+    return readBytes(reinterpret_cast<uint8_t *>(data), length);
+  }
 
   /**
    * @brief Peek at the next byte in the buffer without removing it.
    *
    * @return The next byte in the buffer, or -1 if the buffer is empty.
    */
-  virtual int peek() override;
+  HOT_PATH virtual int peek() override final;
 
   /**
    * @brief Flush the stream.
    *
    * This is a no-op for LoopbackStream as there is no external connection to flush.
    */
-  virtual void flush() override;
+  virtual void flush() override final;
+};
+
+/**
+ * @brief A LoopbackStream with a statically allocated ring buffer.
+ *
+ * @tparam N Buffer size in bytes, a power of two.
+ */
+template <uint16_t N = LoopbackStream::DEFAULT_SIZE>
+class LoopbackStreamN : public LoopbackStream
+{
+  static_assert(N > 0 && (N & (N - 1)) == 0, "LoopbackStreamN size must be a power of two");
+
+  uint8_t storage[N]; ///< Ring buffer.
+
+public:
+  LoopbackStreamN() : LoopbackStream(storage, N) {}
 };
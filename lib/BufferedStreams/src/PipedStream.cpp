@@ -9,6 +9,7 @@
  * @date 2025
  */
 #include "PipedStream.h"
+#include <string.h>
 
 /**
  * @brief Constructor that sets up the stream with input and output channels.
@@ -30,6 +31,108 @@ void PipedStream::clear()
   out->clear();
 }
 
+/**
+ * @brief Moves bytes from a stream into the output buffer.
+ *
+ * @param from The stream to read from.
+ * @param max The maximum number of bytes to move.
+ * @return The number of bytes moved.
+ */
+size_t PipedStream::transfer(Stream &from, size_t max)
+{
+  size_t moved = 0;
+  while (moved < max)
+  {
+    uint8_t *region;
+    size_t count = out->writableRegion(region);
+    if (count > max - moved)
+    {
+      count = max - moved;
+    }
+
+    size_t stored = 0;
+    while (stored < count)
+    {
+      const int data = from.read();
+      if (data < 0)
+        break;
+      region[stored++] = data;
+    }
+    out->commit(stored);
+    moved += stored;
+
+    if (stored == 0 || stored < count)
+      break;
+  }
+  return moved;
+}
+
+/**
+ * @brief Moves bytes from another pipe into the output buffer.
+ *
+ * @param from The pipe end to read from.
+ * @param max The maximum number of bytes to move.
+ * @return The number of bytes moved.
+ */
+size_t PipedStream::transfer(PipedStream &from, size_t max)
+{
+  size_t moved = 0;
+  while (moved < max)
+  {
+    const uint8_t *source;
+    uint8_t *target;
+    size_t count = from.in->readableRegion(source);
+    const size_t space = out->writableRegion(target);
+    if (count > space)
+    {
+      count = space;
+    }
+    if (count > max - moved)
+    {
+      count = max - moved;
+    }
+    if (count == 0)
+      break;
+
+    memcpy(target, source, count);
+    from.in->consume(count);
+    out->commit(count);
+    moved += count;
+  }
+  return moved;
+}
+
+/**
+ * @brief Moves bytes from the input buffer to a Print.
+ *
+ * @param to The destination of the bytes.
+ * @param max The maximum number of bytes to move.
+ * @return The number of bytes moved.
+ */
+size_t PipedStream::transferTo(Print &to, size_t max)
+{
+  size_t moved = 0;
+  while (moved < max)
+  {
+    const uint8_t *region;
+    size_t count = in->readableRegion(region);
+    if (count > max - moved)
+    {
+      count = max - moved;
+    }
+    if (count == 0)
+      break;
+
+    const size_t written = to.write(region, count);
+    in->consume(written);
+    moved += written;
+
+    if (written < count)
+      break;
+  }
+  return moved;
+}
+
 /**
  * @brief Reads a byte from the input buffer.
  *
@@ -60,12 +163,7 @@ size_t PipedStream::write(uint8_t v)
  */
 size_t PipedStream::write(const uint8_t *buffer, size_t size)
 {
-  size_t bytes_written = 0;
-  for (size_t i = 0; i < size; ++i)
-  {
-    bytes_written += out->write(buffer[i]);
-  }
-  return bytes_written;
+  return out->write(buffer, size);
 }
 
 /**
@@ -107,14 +205,25 @@ void PipedStream::flush()
 }
 
 /**
- * @brief Constructor that creates a pair of connected PipedStreams.
+ * @brief Constructor that connects a pair of PipedStreams over two buffers.
+ *
+ * @param forward The buffer first writes to and second reads from.
+ * @param backward The buffer second writes to and first reads from.
+ */
+PipedStreamPair::PipedStreamPair(LoopbackStream &forward, LoopbackStream &backward)
+    : first(backward, forward),
+      second(forward, backward)
+{
+}
+
+/**
+ * @brief Constructor that views two existing ends.
  *
- * @param buffer_size The size of both internal buffers.
+ * @param first The stream to use as the first end.
+ * @param second The stream to use as the second end.
  */
-PipedStreamPair::PipedStreamPair(const uint16_t buffer_size)
-    : buffer1(buffer_size),
-      buffer2(buffer_size),
-      first(buffer1, buffer2),
-      second(buffer2, buffer1)
+PipedStreamPair::PipedStreamPair(const PipedStream &first, const PipedStream &second)
+    : first(first),
+      second(second)
 {
 }
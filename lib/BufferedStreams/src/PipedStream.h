@@ -45,13 +45,50 @@ public:
    */
   void clear();
 
+  /**
+   * @brief Moves bytes from a stream into this end's output buffer.
+   *
+   * The bytes are read straight into the buffer, one read() each,
+   * with no intermediate copy.
+   *
+   * @param from Stream to read from.
+   * @param max Maximum number of bytes to move.
+   * @return Number of bytes moved, short when from runs dry or the buffer fills.
+   */
+  size_t transfer(Stream &from, size_t max);
+
+  /**
+   * @brief Moves bytes from another pipe into this end's output buffer.
+   *
+   * Copies between the two ring buffers in contiguous chunks.
+   *
+   * @param from Pipe end to read from.
+   * @param max Maximum number of bytes to move.
+   * @return Number of bytes moved.
+   */
+  size_t transfer(PipedStream &from, size_t max);
+
+  /**
+   * @brief Moves bytes from this end's input buffer to a Print.
+   *
+   * Hands contiguous chunks of the buffer to to.write(), so a destination
+   * with a bulk write (such as a queue-backed serial port) copies once.
+   *
+   * @param to Destination of the bytes.
+   * @param max Maximum number of bytes to move.
+   * @return Number of bytes moved, short when to accepts fewer.
+   */
+  size_t transferTo(Print &to, size_t max);
+
+  using Print::write;
+
   /**
    * @brief Writes a byte to the output stream.
    *
    * @param data The byte to write.
    * @return Number of bytes written (1 on success, 0 if buffer is full).
    */
-  virtual size_t write(uint8_t data) override;
+  HOT_PATH virtual size_t write(uint8_t data) override final;
 
   /**
    * @brief Writes a buffer of bytes to the output stream.
@@ -60,40 +97,62 @@ public:
    * @param size The number of bytes to write.
    * @return Number of bytes successfully written.
    */
-  virtual size_t write(const uint8_t *buffer, size_t size) override;
+  virtual size_t write(const uint8_t *buffer, size_t size) override final;
 
   /**
    * @brief Gets the number of bytes available for writing.
    *
    * @return Number of bytes that can be written before the output buffer is full.
    */
-  virtual int availableForWrite(void) override;
+  virtual int availableForWrite(void) override final;
 
   /**
    * @brief Gets the number of bytes available for reading.
    *
    * @return Number of bytes available to read from the input buffer.
    */
-  virtual int available() override;
+  HOT_PATH virtual int available() override final;
 
   /**
    * @brief Reads a byte from the input stream.
    *
    * @return The next byte in the input buffer, or -1 if the buffer is empty.
    */
-  virtual int read() override;
+  HOT_PATH virtual int read() override final;
+
+  /**
+   * @brief Reads a block of bytes from the input stream without waiting.
+   *
+   * @param buffer Destination of the bytes.
+   * @param length Maximum number of bytes to read.
+   * @return Number of bytes read.
+   */
+  size_t readBytes(uint8_t *buffer, size_t length)
+  {
+    return in->readBytes(buffer, length);
+  }
+
+  /**
+   * @brief Reads a block of bytes from the input stream without waiting.
+   *
+   * @see readBytes(uint8_t *, size_t)
+   */
+  size_t readBytes(char *buffer, size_t length)
+  {
+    return in->readBytes(buffer, length);
+  }
 
   /**
    * @brief Peeks at the next byte in the input stream without removing it.
    *
    * @return The next byte in the input buffer, or -1 if the buffer is empty.
    */
-  virtual int peek() override;
+  HOT_PATH virtual int peek() override final;
 
   /**
    * @brief Flushes the output stream.
    */
-  virtual void flush() override;
+  virtual void flush() override final;
 
   /**
    * @brief Creates a reversed view of this pipe (the other end).
@@ -109,23 +168,65 @@ public:
 /**
  * @brief A pair of connected PipedStreams that can communicate with each other.
  *
- * This class creates and manages a pair of PipedStreams that are connected to each other.
  * Data written to one stream can be read from the other, and vice versa.
+ * The buffers belong to the derived PipedStreamPairN, which is what gets
+ * instantiated; everything else takes a PipedStreamPair reference.
  */
 class PipedStreamPair
 {
-private:
-  LoopbackStream buffer1; ///< Buffer for first→second communication.
-  LoopbackStream buffer2; ///< Buffer for second→first communication.
+protected:
+  /**
+   * @brief Constructor that connects two streams over the given buffers.
+   *
+   * @param forward Buffer for first→second communication.
+   * @param backward Buffer for second→first communication.
+   */
+  PipedStreamPair(LoopbackStream &forward, LoopbackStream &backward);
 
 public:
   /**
-   * @brief Constructor that creates a pair of connected streams.
+   * @brief Constructor that views two ends of existing pipes.
+   *
+   * No buffers are created, the pair shares those behind the given ends.
+   * The two ends of one pair, swapped, give that pair seen from the other side.
    *
-   * @param buffer_size Size of the internal buffers (default is LoopbackStream::DEFAULT_SIZE).
+   * @param first Stream to use as the first end.
+   * @param second Stream to use as the second end.
    */
-  explicit PipedStreamPair(const uint16_t buffer_size = LoopbackStream::DEFAULT_SIZE);
+  PipedStreamPair(const PipedStream &first, const PipedStream &second);
+
+  PipedStreamPair(const PipedStreamPair &) = delete;
+  PipedStreamPair &operator=(const PipedStreamPair &) = delete;
 
   PipedStream first;  ///< First end of the pipe.
   PipedStream second; ///< Second end of the pipe.
 };
+
+namespace impl
+{
+  /**
+   * @brief Buffers of a PipedStreamPairN.
+   *
+   * Inherited ahead of PipedStreamPair so that they are constructed before
+   * the pair takes references to them.
+   */
+  template <uint16_t N, uint16_t M>
+  struct PipedStreamBuffers
+  {
+    LoopbackStreamN<N> forward;  ///< Buffer for first→second communication.
+    LoopbackStreamN<M> backward; ///< Buffer for second→first communication.
+  };
+}
+
+/**
+ * @brief A PipedStreamPair with statically allocated buffers.
+ *
+ * @tparam N Size of the first→second buffer, a power of two.
+ * @tparam M Size of the second→first buffer, a power of two (default N).
+ */
+template <uint16_t N = LoopbackStream::DEFAULT_SIZE, uint16_t M = N>
+class PipedStreamPairN : private impl::PipedStreamBuffers<N, M>, public PipedStreamPair
+{
+public:
+  PipedStreamPairN() : PipedStreamPair(this->forward, this->backward) {}
+};
@@ -6,6 +6,14 @@
  * performance in embedded systems. It provides efficient FIFO operations with a fixed
  * size buffer, suitable for interrupt-safe data passing between ISRs and main code.
  *
+ * Single-producer/single-consumer contract: one context (ISR or loop) only
+ * calls the push side (push, pushBulk, writableRegion/commit) and one other
+ * context only calls the pop side (pop, peek, popBulk, readableRegion/consume).
+ * Under that contract no critical section is needed: each side owns one index,
+ * element stores are fenced before the index is published, and indices wider
+ * than one byte are published and loaded atomically. pushOverwrite() and
+ * clear() touch both indices and are only safe with the other side quiescent.
+ *
  * @author Aykut ÖZDEMİR
  * @date 2025
  */
@@ -14,6 +22,28 @@
 #define FASTCIRCULARQUEUE_H
 
 #include <Arduino.h>
+#include <util/atomic.h>
+#include <HotPath.h>
+
+/**
+ * @brief Selects the narrowest index type able to address a queue buffer
+ *
+ * @tparam BUFFER_SIZE The size of the buffer
+ */
+template <uint16_t BUFFER_SIZE, bool NARROW = (BUFFER_SIZE <= 256)>
+struct FastCircularQueueIndex
+{
+  typedef uint8_t Type; ///< One byte index, loads and stores are naturally atomic
+};
+
+/**
+ * @brief 16-bit index for buffers larger than 256 elements
+ */
+template <uint16_t BUFFER_SIZE>
+struct FastCircularQueueIndex<BUFFER_SIZE, false>
+{
+  typedef uint16_t Type; ///< Two byte index, published under ATOMIC_BLOCK
+};
 
 /**
  * @brief High-performance circular queue implementation with fixed size
@@ -25,20 +55,22 @@
  * @tparam T The type of elements stored in the queue
  * @tparam BUFFER_SIZE The size of the buffer (must be a power of 2)
  */
-template <typename T, uint8_t BUFFER_SIZE>
+template <typename T, uint16_t BUFFER_SIZE>
 class FastCircularQueue
 {
   static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "BUFFER_SIZE must be a power of 2!");
-  static_assert(BUFFER_SIZE <= 256, "BUFFER_SIZE must be <= 256 due to uint8_t index type!");
+  static_assert(BUFFER_SIZE >= 2, "BUFFER_SIZE must be at least 2!");
 
 public:
+  typedef typename FastCircularQueueIndex<BUFFER_SIZE>::Type Index; ///< Index and length type
+
   /**
    * @brief Constructs an empty circular queue
    */
   FastCircularQueue()
       : head(0), tail(0)
   {
-    for (uint8_t i = 0; i < BUFFER_SIZE; ++i)
+    for (uint16_t i = 0; i < BUFFER_SIZE; ++i)
     {
       buffer[i] = T();
     }
@@ -50,14 +82,14 @@ public:
    * @param value The value to push
    * @return true if the value was successfully pushed, false if the queue is full
    */
-  inline bool push(const T &value)
+  HOT_PATH inline bool push(const T &value)
   {
-    const uint8_t currentHead = head; // Take a snapshot of head
-    const uint8_t next = (currentHead + 1) & (BUFFER_SIZE - 1);
-    if (next == tail)
+    const Index currentHead = head; // Only the producer writes head
+    const Index next = (currentHead + 1) & (BUFFER_SIZE - 1);
+    if (next == loadIndex(tail))
       return false;
     buffer[currentHead] = value;
-    head = next; // Memory barrier might be needed here for thread safety
+    publishIndex(head, next);
     return true;
   }
 
@@ -68,15 +100,16 @@ public:
    */
   inline void pushOverwrite(const T &value)
   {
-    const uint8_t currentHead = head;
-    const uint8_t next = (currentHead + 1) & (BUFFER_SIZE - 1);
-    if (next == tail)
+    const Index currentHead = head;
+    const Index next = (currentHead + 1) & (BUFFER_SIZE - 1);
+    const Index currentTail = loadIndex(tail);
+    if (next == currentTail)
     {
       // Overwrite mode: move tail to discard oldest data
-      tail = (tail + 1) & (BUFFER_SIZE - 1);
+      publishIndex(tail, (currentTail + 1) & (BUFFER_SIZE - 1));
     }
     buffer[currentHead] = value;
-    head = next; // Memory barrier might be needed here for thread safety
+    publishIndex(head, next);
   }
 
   /**
@@ -85,12 +118,13 @@ public:
    * @param value Reference to store the popped value
    * @return true if a value was successfully popped, false if the queue is empty
    */
-  inline bool pop(T &value)
+  HOT_PATH inline bool pop(T &value)
   {
-    if (head == tail)
+    const Index currentTail = tail; // Only the consumer writes tail
+    if (loadIndex(head) == currentTail)
       return false;
-    value = buffer[tail];
-    tail = (tail + 1) & (BUFFER_SIZE - 1);
+    value = buffer[currentTail];
+    publishIndex(tail, (currentTail + 1) & (BUFFER_SIZE - 1));
     return true;
   }
 
@@ -102,9 +136,10 @@ public:
    */
   inline bool peek(T &value) const
   {
-    if (head == tail)
+    const Index currentTail = tail;
+    if (loadIndex(head) == currentTail)
       return false;
-    value = buffer[tail];
+    value = buffer[currentTail];
     return true;
   }
 
@@ -115,7 +150,7 @@ public:
    */
   inline bool isEmpty() const
   {
-    return head == tail;
+    return loadIndex(head) == loadIndex(tail);
   }
 
   /**
@@ -125,7 +160,7 @@ public:
    */
   inline bool isFull() const
   {
-    return ((head + 1) & (BUFFER_SIZE - 1)) == tail;
+    return ((loadIndex(head) + 1) & (BUFFER_SIZE - 1)) == loadIndex(tail);
   }
 
   /**
@@ -133,9 +168,127 @@ public:
    *
    * @return The number of elements in the queue
    */
-  inline uint8_t available() const
+  inline Index available() const
+  {
+    return (loadIndex(head) - loadIndex(tail)) & (BUFFER_SIZE - 1);
+  }
+
+  /**
+   * @brief Gets the number of free slots in the queue
+   *
+   * @return The number of values that can still be pushed
+   */
+  inline Index space() const
+  {
+    return (loadIndex(tail) - loadIndex(head) - 1) & (BUFFER_SIZE - 1);
+  }
+
+  /**
+   * @brief Pushes a block of values to the queue
+   *
+   * Copies as many values as fit and publishes them with a single head update.
+   *
+   * @param values Pointer to the values to push
+   * @param count Number of values to push
+   * @return The number of values actually pushed
+   */
+  inline Index pushBulk(const T *values, Index count)
+  {
+    const Index currentTail = loadIndex(tail);
+    Index currentHead = head;
+    const Index space = (currentTail - currentHead - 1) & (BUFFER_SIZE - 1);
+    if (count > space)
+      count = space;
+    for (Index i = 0; i < count; ++i)
+    {
+      buffer[currentHead] = values[i];
+      currentHead = (currentHead + 1) & (BUFFER_SIZE - 1);
+    }
+    publishIndex(head, currentHead);
+    return count;
+  }
+
+  /**
+   * @brief Pops a block of values from the queue
+   *
+   * Copies as many values as are available and releases them with a single tail update.
+   *
+   * @param values Pointer to store the popped values
+   * @param count Maximum number of values to pop
+   * @return The number of values actually popped
+   */
+  inline Index popBulk(T *values, Index count)
+  {
+    const Index currentHead = loadIndex(head);
+    Index currentTail = tail;
+    const Index used = (currentHead - currentTail) & (BUFFER_SIZE - 1);
+    if (count > used)
+      count = used;
+    for (Index i = 0; i < count; ++i)
+    {
+      values[i] = buffer[currentTail];
+      currentTail = (currentTail + 1) & (BUFFER_SIZE - 1);
+    }
+    publishIndex(tail, currentTail);
+    return count;
+  }
+
+  /**
+   * @brief Gets the contiguous free region starting at head
+   *
+   * The region ends at the wrap point or just before tail, whichever comes first.
+   * Fill it in place and publish the values with commit().
+   *
+   * @param region Reference to store the start of the region
+   * @return The number of values that can be written to the region
+   */
+  inline Index writableRegion(T *&region)
+  {
+    const Index currentHead = head;
+    const Index currentTail = loadIndex(tail);
+    region = &buffer[currentHead];
+    if (currentTail > currentHead)
+      return currentTail - currentHead - 1;
+    return BUFFER_SIZE - currentHead - (currentTail == 0 ? 1 : 0);
+  }
+
+  /**
+   * @brief Publishes values written through writableRegion()
+   *
+   * @param count Number of values written, must not exceed the region length
+   */
+  inline void commit(Index count)
+  {
+    publishIndex(head, (head + count) & (BUFFER_SIZE - 1));
+  }
+
+  /**
+   * @brief Gets the contiguous filled region starting at tail
+   *
+   * The region ends at the wrap point or at head, whichever comes first.
+   * Parse it in place and release the values with consume().
+   *
+   * @param region Reference to store the start of the region
+   * @return The number of values readable from the region
+   */
+  inline Index readableRegion(const T *&region) const
   {
-    return (head - tail) & (BUFFER_SIZE - 1);
+    const Index currentHead = loadIndex(head);
+    const Index currentTail = tail;
+    region = &buffer[currentTail];
+    if (currentHead >= currentTail)
+      return currentHead - currentTail;
+    return BUFFER_SIZE - currentTail;
+  }
+
+  /**
+   * @brief Releases values read through readableRegion()
+   *
+   * @param count Number of values read, must not exceed the region length
+   */
+  inline void consume(Index count)
+  {
+    publishIndex(tail, (tail + count) & (BUFFER_SIZE - 1));
   }
 
   /**
@@ -143,7 +296,8 @@ public:
    */
   inline void clear()
   {
-    head = tail = 0;
+    publishIndex(head, 0);
+    publishIndex(tail, 0);
   }
 
 protected:
@@ -152,9 +306,9 @@ protected:
    *
    * @return The current tail index
    */
-  inline uint8_t getTail() const
+  inline Index getTail() const
   {
-    return tail;
+    return loadIndex(tail);
   } // Allow derived classes to access tail safely
 
   /**
@@ -164,18 +318,67 @@ protected:
    * @param value Reference to store the peeked value
    * @return true if a value was successfully peeked, false if the index is out of bounds
    */
-  inline bool peekAt(uint8_t index, T &value) const
+  inline bool peekAt(Index index, T &value) const
   { // Provide safe indexed access
     if (index >= available())
       return false;
-    uint8_t pos = (tail + index) & (BUFFER_SIZE - 1);
+    const Index pos = (loadIndex(tail) + index) & (BUFFER_SIZE - 1);
     value = buffer[pos];
     return true;
   }
 
 private:
-  T buffer[BUFFER_SIZE];       ///< The circular buffer
-  volatile uint8_t head, tail; ///< Head and tail indices
+  /**
+   * @brief Loads an index owned by the other side
+   *
+   * The compiler barrier keeps buffer loads from being hoisted above the index load.
+   *
+   * @param index The index to load
+   * @return The index value, never torn
+   */
+  static inline Index loadIndex(const volatile Index &index)
+  {
+    Index value;
+    if (sizeof(Index) == 1)
+    {
+      value = index;
+    }
+    else
+    {
+      ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+      {
+        value = index;
+      }
+    }
+    asm volatile("" ::: "memory");
+    return value;
+  }
+
+  /**
+   * @brief Publishes an index after the element accesses it covers
+   *
+   * The compiler barrier keeps buffer stores from sinking past the index store.
+   *
+   * @param index The index to update
+   * @param value The new index value
+   */
+  static inline void publishIndex(volatile Index &index, const Index value)
+  {
+    asm volatile("" ::: "memory");
+    if (sizeof(Index) == 1)
+    {
+      index = value;
+      return;
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      index = value;
+    }
+  }
+
+  T buffer[BUFFER_SIZE];     ///< The circular buffer
+  volatile Index head, tail; ///< Head and tail indices
 };
 
 #endif
@@ -146,6 +146,14 @@ public:
    */
   String toString() const;
 
+  /**
+   * @brief Prints the buffer contents without building a String
+   *
+   * @param printer The output to print to
+   * @return The number of characters printed
+   */
+  size_t printTo(Print &printer) const;
+
   /**
    * @brief Clears the buffer
    */
@@ -159,5 +167,15 @@ public:
   uint8_t size() const;
 };
 
+/**
+ * @brief Overloads the << operator to stream a StringBuffer in place
+ */
+template <uint8_t BUFFER_SIZE>
+inline Print &operator<<(Print &stream, const StringBuffer<BUFFER_SIZE> &buffer)
+{
+  buffer.printTo(stream);
+  return stream;
+}
+
 #include "StringBuffer.hpp" // Include template implementation
 #endif                      // STRINGBUFFER_H
@@ -281,6 +281,20 @@ String StringBuffer<BUFFER_SIZE>::toString() const
   return String(output);
 }
 
+// Print buffer contents character by character
+template <uint8_t BUFFER_SIZE>
+size_t StringBuffer<BUFFER_SIZE>::printTo(Print &printer) const
+{
+  size_t count = 0;
+  for (uint8_t i = 0; i < this->available(); i++)
+  {
+    char temp;
+    this->peekAt(i, temp);
+    count += printer.write(temp);
+  }
+  return count;
+}
+
 // Get buffer size
 template <uint8_t BUFFER_SIZE>
 uint8_t StringBuffer<BUFFER_SIZE>::size() const
@@ -0,0 +1,60 @@
+/**
+ * @file StringMatcher.h
+ * @brief Streaming multi-pattern matcher for embedded systems.
+ *
+ * This file defines the StringMatcher class, which recognises a fixed set of
+ * PROGMEM patterns in a character stream one character at a time, without
+ * buffering or rescanning the received text.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef STRINGMATCHER_H
+#define STRINGMATCHER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Incremental matcher over a fixed set of PROGMEM patterns
+ *
+ * Keeps one progress byte per pattern and reports a pattern the moment its
+ * last character is fed. After a mismatch a pattern restarts from its first
+ * character, so patterns must not begin with a repeat of their own prefix
+ * (e.g. "OK\r\n", "ERROR:" and "FAIL" are fine, "AAB" is not).
+ *
+ * @tparam PATTERN_COUNT Number of patterns, at most 8
+ */
+template <uint8_t PATTERN_COUNT>
+class StringMatcher
+{
+  static_assert(PATTERN_COUNT > 0 && PATTERN_COUNT <= 8, "PATTERN_COUNT must be in 1..8!");
+
+public:
+  /**
+   * @brief Constructs a matcher over the given patterns
+   *
+   * @param patterns Array of PROGMEM strings, bit i of feed() results refers to patterns[i]
+   */
+  explicit StringMatcher(const char *const (&patterns)[PATTERN_COUNT]);
+
+  /**
+   * @brief Feeds one received character
+   *
+   * @param c The character
+   * @return Bit mask of the patterns completed by this character
+   */
+  uint8_t feed(const char c);
+
+  /**
+   * @brief Forgets any partial matches
+   */
+  void reset();
+
+private:
+  const char *const *const p_patterns; ///< PROGMEM patterns
+  uint8_t m_progress[PATTERN_COUNT];   ///< Characters of each pattern matched so far
+};
+
+#include "StringMatcher.hpp" // Include template implementation
+#endif                       // STRINGMATCHER_H
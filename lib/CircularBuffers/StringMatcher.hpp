@@ -0,0 +1,65 @@
+/**
+ * @file StringMatcher.hpp
+ * @brief Implementation of the StringMatcher class.
+ *
+ * This file contains the implementation of the StringMatcher class methods for
+ * incremental pattern detection in a character stream.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef STRINGMATCHER_HPP
+#define STRINGMATCHER_HPP
+
+// Constructor
+template <uint8_t PATTERN_COUNT>
+StringMatcher<PATTERN_COUNT>::StringMatcher(const char *const (&patterns)[PATTERN_COUNT])
+    : p_patterns(patterns)
+{
+  reset();
+}
+
+// Advance every pattern by one character
+template <uint8_t PATTERN_COUNT>
+uint8_t StringMatcher<PATTERN_COUNT>::feed(const char c)
+{
+  uint8_t matched = 0;
+
+  for (uint8_t i = 0; i < PATTERN_COUNT; i++)
+  {
+    PGM_P pattern = p_patterns[i];
+    uint8_t progress = m_progress[i];
+
+    if (c == static_cast<char>(pgm_read_byte(pattern + progress)))
+    {
+      progress++;
+      if (pgm_read_byte(pattern + progress) == '\0')
+      {
+        matched |= (1 << i);
+        progress = 0;
+      }
+    }
+    else
+    {
+      // Restart, the mismatching character may begin a new match
+      progress = (c == static_cast<char>(pgm_read_byte(pattern))) ? 1 : 0;
+    }
+
+    m_progress[i] = progress;
+  }
+
+  return matched;
+}
+
+// Drop partial matches
+template <uint8_t PATTERN_COUNT>
+void StringMatcher<PATTERN_COUNT>::reset()
+{
+  for (uint8_t i = 0; i < PATTERN_COUNT; i++)
+  {
+    m_progress[i] = 0;
+  }
+}
+
+#endif // STRINGMATCHER_HPP
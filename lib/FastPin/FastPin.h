@@ -6,6 +6,9 @@
  * operations for Arduino. It uses direct port manipulation for faster read/write
  * operations compared to standard Arduino digital I/O functions.
  *
+ * StaticFastPin<PIN> resolves the port and bit at compile time, so every
+ * operation is a single sbi/cbi/sbis-style instruction on a fixed register.
+ *
  * @author Aykut ÖZDEMİR
  * @date 2025
  */
@@ -137,4 +140,141 @@ private:
   uint8_t bitMask;          ///< Bit mask for this pin
 };
 
+/**
+ * @brief Compile-time Arduino pin to port and bit mapping.
+ *
+ * Mirrors the digital_pin_to_port and digital_pin_to_bit_mask tables of the
+ * board variant, which live in PROGMEM and cannot be read at compile time.
+ */
+namespace FastPinMap
+{
+#if defined(__AVR_ATmega32U4__)
+  // Leonardo / Pro Micro pin order, D0 to D30
+  constexpr uint8_t PIN_COUNT = 31;
+  constexpr char portLetter(const uint8_t pin) { return "DDDDDCDEBBBBDCBBBBFFFFFFDDBBBDD"[pin]; }
+  constexpr uint8_t bitIndex(const uint8_t pin) { return "2310467645676731207654104745665"[pin] - '0'; }
+#elif defined(__AVR_ATmega328P__)
+  // Uno / Nano pin order, D0 to D19
+  constexpr uint8_t PIN_COUNT = 20;
+  constexpr char portLetter(const uint8_t pin) { return "DDDDDDDDBBBBBBCCCCCC"[pin]; }
+  constexpr uint8_t bitIndex(const uint8_t pin) { return "01234567012345012345"[pin] - '0'; }
+#else
+  constexpr uint8_t PIN_COUNT = 0;
+  constexpr char portLetter(const uint8_t) { return 0; }
+  constexpr uint8_t bitIndex(const uint8_t) { return 0; }
+#endif
+} // namespace FastPinMap
+
+/**
+ * @brief Register set of one I/O port, specialised per port letter.
+ *
+ * @tparam PORT Port letter, 'B' for PORTB/PINB/DDRB.
+ */
+template <char PORT>
+struct FastPinPort;
+
+/// Defines FastPinPort for a port the MCU has
+#define FAST_PIN_PORT(letter, name)                              \
+  template <>                                                    \
+  struct FastPinPort<letter>                                     \
+  {                                                              \
+    static inline volatile uint8_t &out() { return PORT##name; } \
+    static inline volatile uint8_t &in() { return PIN##name; }   \
+    static inline volatile uint8_t &ddr() { return DDR##name; }  \
+  };
+
+#ifdef PORTB
+FAST_PIN_PORT('B', B)
+#endif
+#ifdef PORTC
+FAST_PIN_PORT('C', C)
+#endif
+#ifdef PORTD
+FAST_PIN_PORT('D', D)
+#endif
+#ifdef PORTE
+FAST_PIN_PORT('E', E)
+#endif
+#ifdef PORTF
+FAST_PIN_PORT('F', F)
+#endif
+
+#undef FAST_PIN_PORT
+
+/**
+ * @brief Pin with its port and bit fixed at compile time.
+ *
+ * All members are static: the registers are constant addresses in the low
+ * I/O space, so the compiler emits sbi, cbi and sbis/sbic. Those single
+ * instructions cannot be torn by an interrupt, unlike the load-modify-store
+ * of the runtime FastPin. toggle() writes the PIN register, which flips the
+ * output in one instruction as well.
+ *
+ * @tparam PIN Arduino pin number, known at compile time.
+ */
+template <uint8_t PIN>
+class StaticFastPin
+{
+  static_assert(PIN < FastPinMap::PIN_COUNT, "No compile-time port mapping for this pin or MCU");
+
+  typedef FastPinPort<FastPinMap::portLetter(PIN)> Port;
+
+  static constexpr uint8_t mask() { return static_cast<uint8_t>(1U << FastPinMap::bitIndex(PIN)); }
+
+public:
+  /**
+   * @brief Sets the pin to HIGH state
+   */
+  static inline void high() { Port::out() |= mask(); }
+
+  /**
+   * @brief Sets the pin to LOW state
+   */
+  static inline void low() { Port::out() &= static_cast<uint8_t>(~mask()); }
+
+  /**
+   * @brief Toggles the pin's output state
+   */
+  static inline void toggle() { Port::in() = mask(); }
+
+  /**
+   * @brief Sets the pin to a specific state
+   *
+   * @param value The value to set (0 for LOW, non-zero for HIGH)
+   */
+  static inline void set(const uint8_t value)
+  {
+    if (value)
+      high();
+    else
+      low();
+  }
+
+  /**
+   * @brief Reads the pin's current state
+   *
+   * @return uint8_t 1 if the pin is HIGH, 0 if the pin is LOW
+   */
+  static inline uint8_t read() { return (Port::in() & mask()) ? 1 : 0; }
+
+  /**
+   * @brief Changes the pin mode (input/output) and optionally configures pull-up
+   *
+   * @param isOutput Whether to set the pin as output (true) or input (false)
+   * @param pullup Whether to enable internal pull-up resistor (for input pins)
+   */
+  static inline void setMode(const bool isOutput, const bool pullup = false)
+  {
+    if (isOutput)
+    {
+      Port::ddr() |= mask(); // Set as output
+    }
+    else
+    {
+      Port::ddr() &= static_cast<uint8_t>(~mask()); // Set as input
+      set(pullup);
+    }
+  }
+};
+
 #endif // FASTPIN_H
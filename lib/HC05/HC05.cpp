@@ -11,6 +11,7 @@
 
 #include "HC05.h"
 #include <Arduino.h>
+#include <util/atomic.h>
 
 #include "../../include/TraceLevel.h"
 #undef CLASS_TRACE_LEVEL
@@ -31,10 +32,19 @@ const char HC05::DISC_STR[] PROGMEM = "Disconnected";
 const char HC05::CMD_STR[] PROGMEM = "Command: ";
 const char HC05::ERROR_STR[] PROGMEM = "ERROR:";
 const char HC05::FAIL_STR[] PROGMEM = "FAIL";
+const char HC05::LINE_END_STR[] PROGMEM = "\n";
+const char HC05::SCRIPT_STR[] PROGMEM = "Script: ";
+const char HC05::SCRIPT_FAIL_STR[] PROGMEM = "Script fail: ";
 
 // Define a PROGMEM variable for the OK response string
 const char HC05::OK_RESPONSE[] PROGMEM = "OK\r\n";
 
+const char *const HC05::RESPONSE_PATTERNS[RESPONSE_PATTERN_COUNT] = {
+    OK_RESPONSE,
+    ERROR_STR,
+    FAIL_STR,
+    LINE_END_STR};
+
 /**
  * @brief Constructor for the HC05 class
  *
@@ -47,14 +57,29 @@ HC05::HC05(Stream &stream,
            const uint8_t keyPin,
            const uint8_t statePin,
            const uint8_t resetPin)
-    : DriverBase(F("HC05"), static_cast<Level>(DEBUG_HC05)),
+    : DriverBase(TraceComponent::HC05),
       p_stream(&stream),
       m_keyPin(keyPin),
       m_statePin(statePin),
       m_resetPin(resetPin),
-      m_status{true, false, 0},
+      m_responseMatcher(RESPONSE_PATTERNS),
+      m_responseFlags(0),
+      m_status{true, false, false, 0},
       m_stateManager(INITIALIZING),
-      m_dataReceivedCallback(nullptr)
+      m_dataReceivedCallback(nullptr),
+      m_dataBlockReceivedCallback(nullptr),
+      p_script(nullptr),
+      m_scriptStep{},
+      m_scriptCallback(nullptr),
+      m_scriptLength(0),
+      m_scriptIndex(0),
+      m_scriptRetries(0),
+      m_scriptMask(0),
+      m_stateEdgeCallback(nullptr),
+      m_stateEdgeMicros(0),
+      m_stateEdges(0),
+      m_stateEdgesSeen(0),
+      m_atProbesLeft(0)
 {
 }
 
@@ -91,8 +116,7 @@ void HC05::sendCommand(const Command &command)
     return;
   }
 
-  const Command *newCommand = new Command(command);
-  m_commandQueue.enqueue(newCommand);
+  m_commandQueue.push(command);
 }
 
 /**
@@ -102,13 +126,53 @@ void HC05::sendCommand(const Command &command)
  */
 void HC05::clearCommandQueue()
 {
-  while (!m_commandQueue.isEmpty())
+  m_commandQueue.clear();
+}
+
+/**
+ * @brief Run an AT script
+ *
+ * @param script PROGMEM array of steps
+ * @param stepCount Number of steps in the array
+ * @param callback Function to call when the script finishes
+ * @param stepMask Bit i set runs step i
+ */
+void HC05::runScript(const ScriptStep *script, const uint8_t stepCount, const ScriptCallback callback,
+                     const uint16_t stepMask)
+{
+  p_script = script;
+  m_scriptLength = stepCount;
+  m_scriptIndex = 0;
+  m_scriptRetries = SCRIPT_MAX_RETRIES;
+  m_scriptCallback = callback;
+  m_scriptMask = stepMask;
+
+  if (!seekScriptStep())
   {
-    const Command *const command = m_commandQueue.dequeue();
-    delete command;
+    finishScript(true);
   }
 }
 
+/**
+ * @brief Check if a script is in progress
+ *
+ * @return true if a script is running
+ */
+bool HC05::isScriptRunning() const
+{
+  return p_script != nullptr;
+}
+
+/**
+ * @brief Get the current state of the driver
+ *
+ * @return Current state
+ */
+HC05::State HC05::getState() const
+{
+  return m_stateManager.state();
+}
+
 /**
  * @brief Send string data over Bluetooth
  *
@@ -145,6 +209,70 @@ void HC05::sendData(const char data)
   p_stream->print(data);
 }
 
+/**
+ * @brief Send a block of bytes over Bluetooth
+ *
+ * @param data The bytes to send
+ * @param length Number of bytes to send
+ * @return Number of bytes accepted by the stream
+ */
+size_t HC05::sendData(const uint8_t *data, const size_t length)
+{
+  if (m_status.inCommandMode)
+  {
+    TRACE_ERROR()
+        << PGMT(CMD_MODE_NO_DATA_STR)
+        << endl;
+
+    return 0;
+  }
+  return p_stream->write(data, length);
+}
+
+/**
+ * @brief Move bytes from a source stream to the link
+ *
+ * Stops when the source is empty or the link's TX buffer is full.
+ *
+ * @param source Stream to drain
+ * @return Number of bytes moved
+ */
+size_t HC05::pump(Stream &source)
+{
+  if (m_status.inCommandMode)
+    return 0;
+
+  uint8_t chunk[PUMP_CHUNK_SIZE];
+  size_t moved = 0;
+
+  while (true)
+  {
+    int count = min(source.available(), p_stream->availableForWrite());
+    if (count <= 0)
+      break;
+    if (count > PUMP_CHUNK_SIZE)
+      count = PUMP_CHUNK_SIZE;
+
+    for (int i = 0; i < count; i++)
+    {
+      chunk[i] = source.read();
+    }
+    moved += p_stream->write(chunk, count);
+  }
+
+  return moved;
+}
+
+/**
+ * @brief Get the free space in the link's TX buffer
+ *
+ * @return Number of bytes that can be sent without blocking
+ */
+int HC05::availableForWrite()
+{
+  return m_status.inCommandMode ? 0 : p_stream->availableForWrite();
+}
+
 /**
  * @brief Set callback for received data
  *
@@ -155,6 +283,16 @@ void HC05::onDataReceived(const DataCallback callback)
   m_dataReceivedCallback = callback;
 }
 
+/**
+ * @brief Set callback for blocks of received data
+ *
+ * @param callback Function to call with the received bytes
+ */
+void HC05::onDataBlockReceived(const DataBlockCallback callback)
+{
+  m_dataBlockReceivedCallback = callback;
+}
+
 /**
  * @brief Check if the module is connected
  *
@@ -186,6 +324,7 @@ void HC05::appendStreamData()
   {
     char c = p_stream->read();
     m_responseBuffer.append(c);
+    m_responseFlags |= m_responseMatcher.feed(c);
   }
 }
 
@@ -199,6 +338,8 @@ void HC05::clearResponseBuffer()
     p_stream->read();
   }
   m_responseBuffer.clear();
+  m_responseMatcher.reset();
+  m_responseFlags = 0;
 }
 
 /**
@@ -208,43 +349,28 @@ void HC05::clearResponseBuffer()
  */
 bool HC05::processResponseBufferForCommand()
 {
-  bool success = false;
-  bool errorDetected = false;
-
-  if (m_responseBuffer.endsWith(PGMT(OK_RESPONSE)))
-  {
-    success = true;
-  }
-  else if (m_responseBuffer.indexOf(PGMT(ERROR_STR)) != -1 ||
-           m_responseBuffer.indexOf(PGMT(FAIL_STR)) != -1)
-  {
-    errorDetected = true;
-  }
+  const bool success = (m_responseFlags & RESPONSE_OK) != 0;
+  const bool errorDetected = !success && ((m_responseFlags & (RESPONSE_ERROR | RESPONSE_FAIL)) != 0);
 
   if (success || errorDetected)
   {
-    if (!m_commandQueue.isEmpty())
+    Command command;
+    if (m_commandQueue.pop(command))
     {
-      const Command *const command = m_commandQueue.dequeue();
-      if (command != nullptr)
+      if (command.responseCallback != nullptr)
+      {
+        command.responseCallback(command.commandText, success, m_responseBuffer);
+      }
+
+      if (success && (m_stateManager.state() == WAITING_FOR_RESPONSE))
+      {
+        m_commandDelayTimer.setInterval(command.delayMs);
+        m_commandDelayTimer.reset();
+        m_stateManager.setState(WAITING_FOR_COMMAND_DELAY);
+      }
+      else
       {
-        if (command->callback != nullptr)
-        {
-          command->callback(command->commandText, success, m_responseBuffer.toString());
-        }
-
-        if (success && (m_stateManager.state() == WAITING_FOR_RESPONSE))
-        {
-          m_commandDelayTimer.setInterval(command->delayMs);
-          m_commandDelayTimer.reset();
-          m_stateManager.setState(WAITING_FOR_COMMAND_DELAY);
-        }
-        else
-        {
-          m_stateManager.setState(IDLE);
-        }
-
-        delete command;
+        m_stateManager.setState(IDLE);
       }
     }
     return true;
@@ -253,6 +379,102 @@ bool HC05::processResponseBufferForCommand()
   return false;
 }
 
+/**
+ * @brief Send the current script step
+ */
+void HC05::processScriptStep()
+{
+  memcpy_P(&m_scriptStep, &p_script[m_scriptIndex], sizeof(ScriptStep));
+
+  clearResponseBuffer();
+  TRACE_INFO()
+      << PGMT(SCRIPT_STR)
+      << PGMT(m_scriptStep.command)
+      << endl;
+  p_stream->println(PGMT(m_scriptStep.command));
+  m_stateManager.setState(WAITING_FOR_SCRIPT_REPLY);
+}
+
+/**
+ * @brief Advance to the next step selected by the step mask
+ *
+ * @return true if a step is left to run
+ */
+bool HC05::seekScriptStep()
+{
+  while ((m_scriptIndex < m_scriptLength) && !(m_scriptMask & (1U << m_scriptIndex)))
+  {
+    m_scriptIndex++;
+  }
+  return m_scriptIndex < m_scriptLength;
+}
+
+/**
+ * @brief Finish the current script step and pick what runs next
+ *
+ * @param success Whether the expected reply arrived
+ */
+void HC05::completeScriptStep(const bool success)
+{
+  if (!success)
+  {
+    TRACE_ERROR()
+        << PGMT(SCRIPT_FAIL_STR)
+        << PGMT(m_scriptStep.command)
+        << ' '
+        << m_responseBuffer
+        << endl;
+
+    if ((m_scriptStep.onFail == SCRIPT_RETRY) && (m_scriptRetries > 0))
+    {
+      m_scriptRetries--;
+      m_stateManager.setState(IDLE);
+      return;
+    }
+
+    if (m_scriptStep.onFail != SCRIPT_SKIP)
+    {
+      m_stateManager.setState(IDLE);
+      finishScript(false);
+      return;
+    }
+  }
+
+  m_scriptIndex++;
+  m_scriptRetries = SCRIPT_MAX_RETRIES;
+
+  if (!seekScriptStep())
+  {
+    // The callback may pick the next state, e.g. force data mode
+    m_stateManager.setState(IDLE);
+    finishScript(true);
+    return;
+  }
+
+  m_commandDelayTimer.setInterval(m_scriptStep.minWaitMs);
+  m_commandDelayTimer.reset();
+  m_stateManager.setState(WAITING_FOR_COMMAND_DELAY);
+}
+
+/**
+ * @brief Stop the script and report the result
+ *
+ * @param success Whether the script completed
+ */
+void HC05::finishScript(const bool success)
+{
+  const ScriptCallback callback = m_scriptCallback;
+  const uint8_t index = m_scriptIndex;
+
+  p_script = nullptr;
+  m_scriptCallback = nullptr;
+
+  if (callback != nullptr)
+  {
+    callback(success, index);
+  }
+}
+
 //---------------- State Handler Methods ----------------//
 
 /**
@@ -280,6 +502,7 @@ void HC05::handleResetting()
   {
     digitalWrite(m_keyPin, HIGH);
     digitalWrite(m_resetPin, HIGH);
+    m_atProbesLeft = AT_PROBE_COUNT;
     m_stateManager.setState(INITIALIZING_WAIT);
   }
 }
@@ -297,11 +520,11 @@ void HC05::handleResettingPermanently()
 /**
  * @brief Handle initializing wait state
  *
- * Waits for initialization delay then transitions to checking AT mode
+ * Waits for the module to start booting then transitions to checking AT mode
  */
 void HC05::handleInitializingWait()
 {
-  if (m_stateManager.isStateTimeElapsed(INIT_WAIT_DELAY_MS))
+  if (m_stateManager.isStateTimeElapsed(AT_PROBE_DELAY_MS))
   {
     m_stateManager.setState(CHECKING_AT_MODE);
   }
@@ -322,12 +545,15 @@ void HC05::handleCheckingATMode()
 /**
  * @brief Handle waiting for AT response state
  *
- * Waits for response to AT command to verify command mode
+ * Waits for response to AT command to verify command mode. While the
+ * module boots, it ignores AT or answers garbage, so the probe repeats every
+ * AT_PROBE_INTERVAL_MS; the module is ready as soon as it boots instead of
+ * after a fixed INIT_WAIT_DELAY_MS.
  */
 void HC05::handleWaitingForATResponse()
 {
   appendStreamData();
-  if (m_responseBuffer.endsWith(PGMT(OK_RESPONSE)))
+  if (m_responseFlags & RESPONSE_OK)
   {
     m_commandDelayTimer.setInterval(DEFAULT_COMMAND_DELAY_MS);
     m_stateManager.setState(WAITING_FOR_COMMAND_DELAY);
@@ -338,11 +564,20 @@ void HC05::handleWaitingForATResponse()
 
     return;
   }
+  if (m_atProbesLeft > 0 && m_stateManager.isStateTimeElapsed(AT_PROBE_INTERVAL_MS))
+  {
+    --m_atProbesLeft;
+    m_stateManager.setState(CHECKING_AT_MODE);
+    return;
+  }
   if (m_stateManager.isStateTimeElapsed(AT_RESPONSE_TIMEOUT_MS))
   {
+    char response[RESPONSE_BUFFER_SIZE + 1];
+    m_responseBuffer.toCString(response, sizeof(response));
+
     TRACE_ERROR()
         << PGMT(AT_FAIL_STR)
-        << m_responseBuffer.toString().c_str()
+        << response
         << endl;
 
     m_stateManager.setState(RESETTING);
@@ -395,22 +630,54 @@ void HC05::handleWaitingForDataMode()
 void HC05::handleWaitingForResponse()
 {
   appendStreamData();
-  if (m_responseBuffer.indexOf('\n') != -1)
+  if (m_responseFlags & RESPONSE_LINE)
   {
     if (processResponseBufferForCommand())
       return;
   }
   if (m_stateManager.isStateTimeElapsed(COMMAND_RESPONSE_TIMEOUT_MS))
   {
+    char response[RESPONSE_BUFFER_SIZE + 1];
+    m_responseBuffer.toCString(response, sizeof(response));
+
     TRACE_ERROR()
         << PGMT(CMD_TIMEOUT_STR)
-        << m_responseBuffer.toString().c_str()
+        << response
         << endl;
 
     m_stateManager.setState(RESETTING);
   }
 }
 
+/**
+ * @brief Handle waiting for script reply state
+ *
+ * Completes the step on the expected reply, fails it on an error reply or timeout
+ */
+void HC05::handleWaitingForScriptReply()
+{
+  appendStreamData();
+
+  if (m_responseFlags & RESPONSE_OK)
+  {
+    // Query replies carry their value on a line before the OK
+    completeScriptStep((m_scriptStep.expectedReply == nullptr) ||
+                       (m_responseBuffer.indexOf(PGMT(m_scriptStep.expectedReply)) != -1));
+    return;
+  }
+
+  if ((m_responseFlags & (RESPONSE_ERROR | RESPONSE_FAIL)) && (m_responseFlags & RESPONSE_LINE))
+  {
+    completeScriptStep(false);
+    return;
+  }
+
+  if (m_stateManager.isStateTimeElapsed(m_scriptStep.maxWaitMs))
+  {
+    completeScriptStep(false);
+  }
+}
+
 /**
  * @brief Handle waiting for command delay state
  *
@@ -431,15 +698,38 @@ void HC05::handleWaitingForCommandDelay()
  */
 void HC05::handleDataMode()
 {
-  while (p_stream->available())
+  if (m_dataBlockReceivedCallback != nullptr)
   {
-    char c = p_stream->read();
-    if (m_status.connected && m_dataReceivedCallback)
+    // Hand over what was received before this pass, in as few calls as the chunk allows
+    uint8_t chunk[RX_CHUNK_SIZE];
+    int pending = p_stream->available();
+    while (pending > 0)
     {
-      m_dataReceivedCallback(c);
+      const uint8_t count = (pending > RX_CHUNK_SIZE) ? RX_CHUNK_SIZE : pending;
+      for (uint8_t i = 0; i < count; i++)
+      {
+        chunk[i] = p_stream->read();
+      }
+      pending -= count;
+
+      if (m_status.connected)
+      {
+        m_dataBlockReceivedCallback(chunk, count);
+      }
     }
   }
-  if (!m_commandQueue.isEmpty())
+  else
+  {
+    while (p_stream->available())
+    {
+      char c = p_stream->read();
+      if (m_status.connected && m_dataReceivedCallback)
+      {
+        m_dataReceivedCallback(c);
+      }
+    }
+  }
+  if (!m_commandQueue.isEmpty() || isScriptRunning())
   {
     m_stateManager.setState(WAITING_FOR_COMMAND_MODE);
   }
@@ -456,6 +746,10 @@ void HC05::handleIdle()
   {
     processNextCommand();
   }
+  else if (isScriptRunning())
+  {
+    processScriptStep();
+  }
   else
   {
     m_stateManager.setState(WAITING_FOR_DATA_MODE);
@@ -505,6 +799,9 @@ void HC05::loop()
   case WAITING_FOR_RESPONSE:
     handleWaitingForResponse();
     break;
+  case WAITING_FOR_SCRIPT_REPLY:
+    handleWaitingForScriptReply();
+    break;
   case WAITING_FOR_COMMAND_DELAY:
     handleWaitingForCommandDelay();
     break;
@@ -517,6 +814,51 @@ void HC05::loop()
   }
 }
 
+/**
+ * @brief Switch connection tracking to STATE pin edges
+ *
+ * @param callback Function called from the interrupt on every edge
+ */
+void HC05::useStateInterrupt(const StateEdgeCallback callback)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    m_stateEdgeCallback = callback;
+    // Pretend one edge is pending so loop() picks up the current level once
+    m_stateEdgesSeen = m_stateEdges - 1;
+    m_status.stateInterrupt = true;
+  }
+}
+
+/**
+ * @brief STATE pin edge Interrupt Service Routine
+ */
+void HC05::processStateEdge()
+{
+  m_stateEdgeMicros = micros();
+  m_stateEdges++;
+
+  if (m_stateEdgeCallback != nullptr)
+  {
+    m_stateEdgeCallback(digitalRead(m_statePin) == HIGH);
+  }
+}
+
+/**
+ * @brief Get the time of the last STATE pin edge
+ *
+ * @return micros() timestamp of the last edge
+ */
+uint32_t HC05::lastStateEdgeMicros() const
+{
+  uint32_t timestamp;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    timestamp = m_stateEdgeMicros;
+  }
+  return timestamp;
+}
+
 /**
  * @brief Reset the HC-05 module
  *
@@ -558,15 +900,15 @@ void HC05::forceDataMode()
  */
 void HC05::processNextCommand()
 {
-  if (!m_commandQueue.isEmpty())
+  Command nextCommand;
+  if (m_commandQueue.peek(nextCommand))
   {
-    const Command *const nextCommand = m_commandQueue.getHead();
     clearResponseBuffer();
     TRACE_INFO()
         << PGMT(CMD_STR)
-        << nextCommand->commandText
+        << nextCommand.commandText
         << endl;
-    p_stream->println(nextCommand->commandText);
+    p_stream->println(nextCommand.commandText);
     m_stateManager.setState(WAITING_FOR_RESPONSE);
   }
 }
@@ -578,6 +920,15 @@ void HC05::processNextCommand()
  */
 void HC05::updateConnectionState()
 {
+  if (m_status.stateInterrupt)
+  {
+    // Only look at the pin after the ISR has seen an edge
+    const uint8_t edges = m_stateEdges;
+    if (edges == m_stateEdgesSeen)
+      return;
+    m_stateEdgesSeen = edges;
+  }
+
   const bool connectionStatus = (digitalRead(m_statePin) == HIGH);
   if (connectionStatus != m_status.connected)
   {
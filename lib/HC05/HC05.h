@@ -14,7 +14,8 @@
 #define HC05_H
 
 #include <StringBuffer.h>
-#include <ArduinoQueue.h>
+#include <StringMatcher.h>
+#include <FastCircularQueue.h>
 #include <Stream.h>
 #include <SimpleTimer.h>
 #include <Utilities.h>
@@ -29,13 +30,19 @@
 class HC05 : public DriverBase
 {
 public:
+  /// Response buffer size
+  static constexpr uint8_t RESPONSE_BUFFER_SIZE = 64;
+
+  /// Buffer holding the response of the command in flight
+  typedef StringBuffer<RESPONSE_BUFFER_SIZE> ResponseBuffer;
+
   /**
-   * @brief Callback function type for command responses
+   * @brief Allocation-free callback function type for command responses
    * @param command The command that was sent
    * @param success Whether the command was successful
-   * @param response The response received from the module
+   * @param response Read-only view of the response buffer, valid during the call only
    */
-  typedef void (*CommandCallback)(const __FlashStringHelper *, bool, const String &);
+  typedef void (*ResponseCallback)(const __FlashStringHelper *, bool, const ResponseBuffer &);
 
   /**
    * @brief Callback function type for received data
@@ -43,6 +50,19 @@ public:
    */
   typedef void (*DataCallback)(const char);
 
+  /**
+   * @brief Callback function type for blocks of received data
+   * @param data The bytes received, valid during the call only
+   * @param length Number of bytes
+   */
+  typedef void (*DataBlockCallback)(const uint8_t *, uint8_t);
+
+  /**
+   * @brief Callback function type for STATE pin edges (interrupt context)
+   * @param connected Level of the STATE pin after the edge
+   */
+  typedef void (*StateEdgeCallback)(const bool);
+
   /**
    * @brief HC05 module states
    */
@@ -59,7 +79,8 @@ public:
     CHECKING_AT_MODE,          ///< Checking if AT mode is accessible
     WAITING_FOR_AT_RESPONSE,   ///< Waiting for response to AT command
     WAITING_FOR_COMMAND_MODE,  ///< Waiting for command mode to be activated
-    WAITING_FOR_DATA_MODE      ///< Waiting for data mode to be activated
+    WAITING_FOR_DATA_MODE,     ///< Waiting for data mode to be activated
+    WAITING_FOR_SCRIPT_REPLY   ///< Waiting for the reply to the current script step
   };
 
   /**
@@ -68,10 +89,39 @@ public:
   struct Command
   {
     const __FlashStringHelper *commandText; ///< The command text to send
-    CommandCallback callback;               ///< Callback to execute when response is received
+    ResponseCallback responseCallback;      ///< Callback to execute when response is received, gets the buffer itself
     uint16_t delayMs;                       ///< Delay after command execution (ms)
   };
 
+  /**
+   * @brief What a script does when a step fails or times out
+   */
+  enum ScriptFailAction : uint8_t
+  {
+    SCRIPT_ABORT = 0, ///< Stop the script and report failure
+    SCRIPT_SKIP,      ///< Carry on with the next step
+    SCRIPT_RETRY      ///< Send the step again, abort after SCRIPT_MAX_RETRIES
+  };
+
+  /**
+   * @brief One step of an AT script, stored in PROGMEM
+   */
+  struct ScriptStep
+  {
+    const char *command;       ///< PROGMEM command text to send
+    const char *expectedReply; ///< PROGMEM text the reply must contain before its "OK\r\n", nullptr for none
+    uint16_t minWaitMs;        ///< Settle time after the reply before the next step (ms)
+    uint16_t maxWaitMs;        ///< Time allowed for the reply (ms)
+    ScriptFailAction onFail;   ///< Action on error reply or timeout
+  };
+
+  /**
+   * @brief Callback function type for script completion
+   * @param success Whether every step completed or was skipped
+   * @param failedStep Index of the step that aborted the script, the step count on success
+   */
+  typedef void (*ScriptCallback)(bool, uint8_t);
+
   /**
    * @brief Constructor
    *
@@ -103,6 +153,34 @@ public:
    */
   void clearCommandQueue();
 
+  /**
+   * @brief Run an AT script
+   *
+   * Each step advances as soon as its expected reply arrives. Queued commands
+   * are sent first, and a script already running is replaced.
+   *
+   * @param script PROGMEM array of steps
+   * @param stepCount Number of steps in the array, at most 16
+   * @param callback Function to call when the script finishes, may be nullptr
+   * @param stepMask Bit i set runs step i, cleared steps are skipped
+   */
+  void runScript(const ScriptStep *script, const uint8_t stepCount, const ScriptCallback callback,
+                 const uint16_t stepMask = 0xFFFF);
+
+  /**
+   * @brief Check if a script is in progress
+   *
+   * @return true if a script is running
+   */
+  bool isScriptRunning() const;
+
+  /**
+   * @brief Get the current state of the driver
+   *
+   * @return Current state
+   */
+  State getState() const;
+
   /**
    * @brief Send data string to connected device
    *
@@ -117,6 +195,30 @@ public:
    */
   void sendData(const char data);
 
+  /**
+   * @brief Send a block of bytes to connected device
+   *
+   * @param data Bytes to send
+   * @param length Number of bytes to send
+   * @return Number of bytes accepted by the stream
+   */
+  size_t sendData(const uint8_t *data, const size_t length);
+
+  /**
+   * @brief Move as many bytes from a source stream as the link can take now
+   *
+   * @param source Stream to drain
+   * @return Number of bytes moved
+   */
+  size_t pump(Stream &source);
+
+  /**
+   * @brief Get the free space in the link's TX buffer
+   *
+   * @return Number of bytes that can be sent without blocking, 0 in command mode
+   */
+  int availableForWrite();
+
   /**
    * @brief Set callback for received data
    *
@@ -124,6 +226,38 @@ public:
    */
   void onDataReceived(const DataCallback callback);
 
+  /**
+   * @brief Set callback for blocks of received data
+   *
+   * Takes precedence over the per-character callback.
+   *
+   * @param callback Function to call with everything drained from the stream in one pass
+   */
+  void onDataBlockReceived(const DataBlockCallback callback);
+
+  /**
+   * @brief Switch connection tracking from polling to STATE pin edges
+   *
+   * The caller attaches a CHANGE interrupt on the STATE pin that calls processStateEdge().
+   *
+   * @param callback Function called from the interrupt on every edge, may be nullptr
+   */
+  void useStateInterrupt(const StateEdgeCallback callback);
+
+  /**
+   * @brief STATE pin edge Interrupt Service Routine
+   *
+   * Timestamps the edge and runs the edge callback.
+   */
+  void processStateEdge();
+
+  /**
+   * @brief Get the time of the last STATE pin edge
+   *
+   * @return micros() timestamp of the last edge
+   */
+  uint32_t lastStateEdgeMicros() const;
+
   /**
    * @brief Reset the HC-05 module
    *
@@ -182,12 +316,34 @@ private:
   static const char CMD_STR[] PROGMEM;              ///< Command message
   static const char ERROR_STR[] PROGMEM;            ///< Error message
   static const char FAIL_STR[] PROGMEM;             ///< Fail message
+  static const char SCRIPT_STR[] PROGMEM;           ///< Script step message
+  static const char SCRIPT_FAIL_STR[] PROGMEM;      ///< Script step failed message
+  static const char LINE_END_STR[] PROGMEM;         ///< Response line terminator
+
+  /// Number of response patterns tracked by the matcher
+  static constexpr uint8_t RESPONSE_PATTERN_COUNT = 4;
+  /// Response patterns, in the bit order of the RESPONSE_* flags
+  static const char *const RESPONSE_PATTERNS[RESPONSE_PATTERN_COUNT];
+  /// Response flag: "OK\r\n" received
+  static constexpr uint8_t RESPONSE_OK = 0x01;
+  /// Response flag: "ERROR:" received
+  static constexpr uint8_t RESPONSE_ERROR = 0x02;
+  /// Response flag: "FAIL" received
+  static constexpr uint8_t RESPONSE_FAIL = 0x04;
+  /// Response flag: a complete line received
+  static constexpr uint8_t RESPONSE_LINE = 0x08;
 
   // Add timing constants
   /// Reset delay in milliseconds
   static constexpr uint16_t RESET_DELAY_MS = 500;
-  /// Initialization wait delay in milliseconds
+  /// Longest wait for the module to boot after a reset, in milliseconds
   static constexpr uint16_t INIT_WAIT_DELAY_MS = 3000;
+  /// Delay before the first AT probe after a reset, in milliseconds
+  static constexpr uint16_t AT_PROBE_DELAY_MS = 500;
+  /// Interval between AT probes while the module boots, in milliseconds
+  static constexpr uint16_t AT_PROBE_INTERVAL_MS = 250;
+  /// AT probes that fit into INIT_WAIT_DELAY_MS before the last one waits AT_RESPONSE_TIMEOUT_MS
+  static constexpr uint8_t AT_PROBE_COUNT = (INIT_WAIT_DELAY_MS - AT_PROBE_DELAY_MS) / AT_PROBE_INTERVAL_MS;
   /// AT response timeout in milliseconds
   static constexpr uint16_t AT_RESPONSE_TIMEOUT_MS = 4000;
   /// Command mode delay in milliseconds
@@ -199,17 +355,24 @@ private:
   /// Default command delay in milliseconds
   static constexpr uint16_t DEFAULT_COMMAND_DELAY_MS = 200;
   // Add buffer size constants
-  /// Response buffer size
-  static constexpr uint8_t RESPONSE_BUFFER_SIZE = 64;
+  /// Command queue size, holds up to COMMAND_QUEUE_SIZE - 1 pending commands
+  static constexpr uint8_t COMMAND_QUEUE_SIZE = 16;
+  /// Resends allowed for a SCRIPT_RETRY step
+  static constexpr uint8_t SCRIPT_MAX_RETRIES = 2;
+  /// Bytes moved per stream write in pump()
+  static constexpr uint8_t PUMP_CHUNK_SIZE = 16;
+  /// Bytes handed over per DataBlockCallback call
+  static constexpr uint8_t RX_CHUNK_SIZE = 32;
 
   /**
    * @brief Status flags struct
    */
   struct Status
   {
-    uint8_t inCommandMode : 1; ///< Whether module is in command mode
-    uint8_t connected : 1;     ///< Whether module is connected to another device
-    uint8_t unused : 6;        ///< Unused bits
+    uint8_t inCommandMode : 1;  ///< Whether module is in command mode
+    uint8_t connected : 1;      ///< Whether module is connected to another device
+    uint8_t stateInterrupt : 1; ///< Whether STATE pin edges are reported by interrupt
+    uint8_t unused : 5;         ///< Unused bits
   };
 
   /**
@@ -217,6 +380,32 @@ private:
    */
   void processNextCommand();
 
+  /**
+   * @brief Send the current script step
+   */
+  void processScriptStep();
+
+  /**
+   * @brief Advance to the first step at or after the current index that is in the step mask
+   *
+   * @return true if such a step exists
+   */
+  bool seekScriptStep();
+
+  /**
+   * @brief Finish the current script step and pick what runs next
+   *
+   * @param success Whether the expected reply arrived
+   */
+  void completeScriptStep(const bool success);
+
+  /**
+   * @brief Stop the script and report the result
+   *
+   * @param success Whether the script completed
+   */
+  void finishScript(const bool success);
+
   /**
    * @brief Update connection state based on STATE pin
    */
@@ -286,6 +475,11 @@ private:
    */
   void handleWaitingForResponse();
 
+  /**
+   * @brief Handle waiting for script reply state
+   */
+  void handleWaitingForScriptReply();
+
   /**
    * @brief Handle waiting for command delay state
    */
@@ -306,12 +500,27 @@ private:
   const uint8_t m_statePin; ///< Pin connected to STATE pin of HC-05
   const uint8_t m_resetPin; ///< Pin connected to RESET pin of HC-05
 
-  ArduinoQueue<const Command *> m_commandQueue;        ///< Queue of commands to send
-  StringBuffer<RESPONSE_BUFFER_SIZE> m_responseBuffer; ///< Buffer for responses
-  Status m_status;                                     ///< Current status flags
-  StateManager<State> m_stateManager{INITIALIZING};    ///< State manager
-  DataCallback m_dataReceivedCallback;                 ///< Callback for received data
-  SimpleTimer<uint16_t> m_commandDelayTimer;           ///< Timer for command delays
+  FastCircularQueue<Command, COMMAND_QUEUE_SIZE> m_commandQueue; ///< Statically allocated queue of commands to send
+  ResponseBuffer m_responseBuffer;                               ///< Buffer for responses
+  StringMatcher<RESPONSE_PATTERN_COUNT> m_responseMatcher;       ///< Detects response patterns as characters arrive
+  uint8_t m_responseFlags;                                       ///< RESPONSE_* flags seen since the buffer was cleared
+  Status m_status;                                               ///< Current status flags
+  StateManager<State, LoopClock> m_stateManager{INITIALIZING};  ///< State manager
+  DataCallback m_dataReceivedCallback;                           ///< Callback for received data
+  DataBlockCallback m_dataBlockReceivedCallback;                 ///< Callback for blocks of received data
+  SimpleTimer<uint16_t, LoopClock> m_commandDelayTimer;          ///< Timer for command delays
+  const ScriptStep *p_script;                                    ///< PROGMEM steps of the running script, nullptr when idle
+  ScriptStep m_scriptStep;                                       ///< RAM copy of the current script step
+  ScriptCallback m_scriptCallback;                               ///< Callback for script completion
+  uint8_t m_scriptLength;                                        ///< Number of steps in the running script
+  uint8_t m_scriptIndex;                                         ///< Index of the current script step
+  uint8_t m_scriptRetries;                                       ///< Resends left for the current script step
+  uint16_t m_scriptMask;                                         ///< Steps of the running script to execute
+  StateEdgeCallback m_stateEdgeCallback;                         ///< Interrupt-context callback for STATE pin edges
+  volatile uint32_t m_stateEdgeMicros;                           ///< Timestamp of the last STATE pin edge
+  volatile uint8_t m_stateEdges;                                 ///< STATE pin edge counter, written by the ISR only
+  uint8_t m_stateEdgesSeen;                                      ///< Edge counter value handled by loop()
+  uint8_t m_atProbesLeft;                                        ///< Early AT probes left before the full response timeout
 };
 
 #endif
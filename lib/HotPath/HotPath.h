@@ -0,0 +1,41 @@
+/**
+ * @file HotPath.h
+ * @brief Speed optimization of single functions in the size-optimized firmware.
+ *
+ * The firmware builds with -Os -fno-inline-small-functions, which keeps it
+ * small but also slows the few functions run for every bit or byte of the
+ * link. HOT_PATH compiles one function with -O2 and small-function
+ * inlining instead, and marks it hot so GCC puts it in a .text.hot.*
+ * section. The build output adds those sections up (asembly_analyzer.py),
+ * so the flash spent on speed is visible with every build.
+ *
+ * Use it on the declaration, before the return type, or as an ISR attribute:
+ * @code
+ * HOT_PATH inline void processISR();
+ * ISR(TIMER1_COMPA_vect, HOT_PATH) { softwareSerial.processISR(); }
+ * @endcode
+ * GCC does not inline a function with its own optimization options into a
+ * caller built with others, so -Os callers get a real call instead. Put it on
+ * the ISR as well; a call from an ISR saves every call-clobbered register.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef HOTPATH_H
+#define HOTPATH_H
+
+/// Set to 0 to build the hot path like the rest of the firmware (env:sim_cold compares the two)
+#ifndef HOT_PATH_ENABLE
+#define HOT_PATH_ENABLE 1
+#endif
+
+#if HOT_PATH_ENABLE
+/// Compile the function for speed and place it in .text.hot.*; -O2 alone would keep -fno-inline-small-functions
+#define HOT_PATH __attribute__((hot, optimize("O2", "inline-small-functions")))
+#else
+/// Hot path disabled: the function builds with the global flags
+#define HOT_PATH
+#endif
+
+#endif // HOTPATH_H
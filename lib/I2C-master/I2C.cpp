@@ -60,6 +60,7 @@
 #endif
 
 #include <inttypes.h>
+#include <util/atomic.h>
 #include "I2C.h"
 
 #include "../../include/TraceLevel.h"
@@ -74,8 +75,16 @@ uint8_t I2C::bytesAvailable = 0;
 uint8_t I2C::bufferIndex = 0;
 uint8_t I2C::totalBytes = 0;
 SimpleTimer<uint8_t> I2C::timeoutTimer(0);
+I2CTransaction *volatile I2C::queueHead = nullptr;
+I2CTransaction *I2C::queueTail = nullptr;
+uint16_t I2C::transferIndex = 0;
+bool I2C::finishing = false;
+SimpleTimer<uint8_t> I2C::transactionTimer(0);
 
-I2C::I2C() : Traceable(F("I2C"), static_cast<Level>(DEBUG_I2C))
+/// TWCR value that clears TWINT and keeps the TWI interrupt on
+static const uint8_t TWCR_QUEUED = _BV(TWINT) | _BV(TWEN) | _BV(TWIE);
+
+I2C::I2C() : Traceable(TraceComponent::I2C)
 {
 }
 
@@ -315,30 +324,9 @@ uint8_t I2C::receive()
 
 uint8_t I2C::write(uint8_t address)
 {
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
+  I2CTransaction transaction = {};
+  transaction.address = address;
+  returnStatus = transfer(transaction);
   return (returnStatus);
 }
 
@@ -1354,66 +1342,18 @@ uint8_t I2C::write16(uint8_t address, uint16_t registerAddress, const char *data
 
 /*
  *  Same as I2c.write(address, registerAddress, *data, numberBytes), but writes
- *  to a slave device that takes 16-bit address
+ *  to a slave device that takes 16-bit address. Runs as a queued transaction,
+ *  so the return value is that of transfer() instead of the list above
  */
 uint8_t I2C::write16(uint8_t address, uint16_t registerAddress, const uint8_t *data, uint8_t numberBytes)
 {
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
-  {
-    return (returnStatus);
-  }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (2);
-    }
-    return (returnStatus);
-  }
-  // Send MSB of register address
-  returnStatus = _sendByte(registerAddress >> 8);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  // Send LSB of register address
-  returnStatus = _sendByte(registerAddress & 0xFF);
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
-  }
-  for (uint8_t i = 0; i < numberBytes; i++)
-  {
-    returnStatus = _sendByte(data[i]);
-    if (returnStatus)
-    {
-      if (returnStatus == 1)
-      {
-        return (3);
-      }
-      return (returnStatus);
-    }
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
-    {
-      return (7);
-    }
-    return (returnStatus);
-  }
+  I2CTransaction transaction = {};
+  transaction.address = address;
+  transaction.registerAddress = registerAddress;
+  transaction.registerBytes = 2;
+  transaction.txData = data;
+  transaction.txLength = numberBytes;
+  returnStatus = transfer(transaction);
   return (returnStatus);
 }
 
@@ -1589,7 +1529,9 @@ uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberByt
 
 /*
  *  Same as I2c.read(address, registerAddress, numberBytes, *dataBuffer), but
- *  reads from a slave device that takes 16-bit register addresses
+ *  reads from a slave device that takes 16-bit register addresses. Runs as a
+ *  queued transaction, so the return value is that of transfer() instead of
+ *  the list above
  */
 uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberBytes, uint8_t *dataBuffer)
 {
@@ -1599,100 +1541,215 @@ uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberByt
   {
     numberBytes++;
   }
-  nack = numberBytes - 1;
-  returnStatus = 0;
-  returnStatus = _start();
-  if (returnStatus)
+  I2CTransaction transaction = {};
+  transaction.address = address;
+  transaction.registerAddress = registerAddress;
+  transaction.registerBytes = 2;
+  transaction.rxData = dataBuffer;
+  transaction.rxLength = numberBytes;
+  returnStatus = transfer(transaction);
+  if (returnStatus == 0)
   {
-    return (returnStatus);
+    bytesAvailable = numberBytes;
+    totalBytes = numberBytes;
   }
-  returnStatus = _sendAddress(SLA_W(address));
-  if (returnStatus)
+  return (returnStatus);
+}
+
+//////////// QUEUED TRANSACTIONS
+
+/*
+ *  Description:
+ *      Appends a transaction to the queue and starts it when the bus is idle.
+ *      The TWI interrupt then walks it through its phases and the ones
+ *      queued behind it. A transaction submitted from a completion callback
+ *      is started once the callback returns.
+ *  Parameters:
+ *      transaction - I2CTransaction
+ *          The transaction, left untouched by the caller until its status
+ *          is no longer I2C_PENDING
+ *  Returns:
+ *      bool
+ *          false if the transaction is already queued
+ */
+bool I2C::submit(I2CTransaction &transaction)
+{
+  bool queued = false;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    if (returnStatus == 1)
+    if (transaction.status != I2C_PENDING)
     {
-      return (2);
+      transaction.status = I2C_PENDING;
+      transaction.next = nullptr;
+      queued = true;
+      if (queueHead == nullptr)
+      {
+        queueHead = &transaction;
+        queueTail = &transaction;
+        if (!finishing)
+        {
+          transferIndex = 0;
+          transactionTimer.reset();
+          TWCR = TWCR_QUEUED | _BV(TWSTA);
+        }
+      }
+      else
+      {
+        queueTail->next = &transaction;
+        queueTail = &transaction;
+      }
     }
-    return (returnStatus);
   }
-  // Send MSB of register address
-  returnStatus = _sendByte(registerAddress >> 8);
-  if (returnStatus)
+  return queued;
+}
+
+/*
+ *  Description:
+ *      Submits a transaction and waits for it, failing it after timeOut()
+ *      milliseconds. Interrupts must be enabled.
+ *  Parameters:
+ *      transaction - I2CTransaction
+ *          The transaction to run
+ *  Returns:
+ *      uint8_t
+ *          0: The transaction completed
+ *          1: The transaction timed out
+ *          2 - 0xFE: The TWI status that ended it, see the datasheet
+ *          0xFF: The transaction was already queued
+ */
+uint8_t I2C::transfer(I2CTransaction &transaction)
+{
+  if (!submit(transaction))
   {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
+    return (I2C_PENDING);
   }
-  // Send LSB of register address
-  returnStatus = _sendByte(registerAddress & 0xFF);
-  if (returnStatus)
+  while (transaction.status == I2C_PENDING)
   {
-    if (returnStatus == 1)
-    {
-      return (3);
-    }
-    return (returnStatus);
+    loop();
   }
-  returnStatus = _start();
-  if (returnStatus)
+  return (transaction.status);
+}
+
+bool I2C::isBusy() const
+{
+  return queueHead != nullptr;
+}
+
+/*
+ *  Description:
+ *      Fails the running transaction once it has run for timeOut()
+ *      milliseconds, resets the TWI hardware and starts the next one.
+ *  Parameters:
+ *      none
+ *  Returns:
+ *      none
+ */
+void I2C::loop()
+{
+  if (queueHead == nullptr || !timeoutTimer.isEnabled())
   {
-    if (returnStatus == 1)
-    {
-      return (4);
-    }
-    return (returnStatus);
+    return;
   }
-  returnStatus = _sendAddress(SLA_R(address));
-  if (returnStatus)
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    if (returnStatus == 1)
+    if (queueHead != nullptr && transactionTimer.elapsed() >= timeoutTimer.getInterval())
     {
-      return (5);
+      lockUp();
+      finishTransaction(1);
     }
-    return (returnStatus);
   }
-  for (uint8_t i = 0; i < numberBytes; i++)
+}
+
+/*
+ *  Description:
+ *      Advances the running transaction by one bus event. Called from the
+ *      TWI interrupt with TWINT set.
+ *  Parameters:
+ *      none
+ *  Returns:
+ *      none
+ */
+void I2C::processISR()
+{
+  I2CTransaction *transaction = queueHead;
+  if (transaction == nullptr)
   {
-    if (i == nack)
+    TWCR = _BV(TWEN) | _BV(TWEA);
+    return;
+  }
+
+  switch (TWI_STATUS)
+  {
+  case START:
+    transferIndex = 0;
+    // Address probes and transfers with something to send start in transmit mode
+    if (transaction->registerBytes != 0 || transaction->txLength != 0 || transaction->rxLength == 0)
     {
-      returnStatus = _receiveByte(0);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_NACK)
-      {
-        return (returnStatus);
-      }
+      TWDR = SLA_W(transaction->address);
     }
     else
     {
-      returnStatus = _receiveByte(1);
-      if (returnStatus == 1)
-      {
-        return (6);
-      }
-      if (returnStatus != MR_DATA_ACK)
-      {
-        return (returnStatus);
-      }
+      TWDR = SLA_R(transaction->address);
     }
-    dataBuffer[i] = TWDR;
-    bytesAvailable = i + 1;
-    totalBytes = i + 1;
-  }
-  returnStatus = _stop();
-  if (returnStatus)
-  {
-    if (returnStatus == 1)
+    TWCR = TWCR_QUEUED;
+    break;
+
+  case REPEATED_START:
+    transferIndex = 0;
+    TWDR = SLA_R(transaction->address);
+    TWCR = TWCR_QUEUED;
+    break;
+
+  case MT_SLA_ACK:
+  case MT_DATA_ACK:
+    if (transferIndex < transaction->registerBytes)
     {
-      return (7);
+      // MSB first
+      TWDR = static_cast<uint8_t>(transaction->registerAddress >> (8 * (transaction->registerBytes - 1 - transferIndex)));
+      ++transferIndex;
+      TWCR = TWCR_QUEUED;
     }
-    return (returnStatus);
+    else if (transferIndex - transaction->registerBytes < transaction->txLength)
+    {
+      TWDR = transaction->txData[transferIndex - transaction->registerBytes];
+      ++transferIndex;
+      TWCR = TWCR_QUEUED;
+    }
+    else if (transaction->rxLength != 0)
+    {
+      TWCR = TWCR_QUEUED | _BV(TWSTA);
+    }
+    else
+    {
+      finishTransaction(0);
+    }
+    break;
+
+  case MR_SLA_ACK:
+    // Acknowledge every byte but the last, so the slave releases the bus
+    TWCR = (transaction->rxLength > 1) ? (TWCR_QUEUED | _BV(TWEA)) : TWCR_QUEUED;
+    break;
+
+  case MR_DATA_ACK:
+    transaction->rxData[transferIndex++] = TWDR;
+    TWCR = (transferIndex + 1 < transaction->rxLength) ? (TWCR_QUEUED | _BV(TWEA)) : TWCR_QUEUED;
+    break;
+
+  case MR_DATA_NACK:
+    transaction->rxData[transferIndex] = TWDR;
+    finishTransaction(0);
+    break;
+
+  case LOST_ARBTRTN:
+    lockUp();
+    finishTransaction(LOST_ARBTRTN);
+    break;
+
+  default:
+    // NACK on the address or a data byte
+    finishTransaction(TWI_STATUS);
+    break;
   }
-  return (returnStatus);
 }
 
 //////////// LOW-LEVEL METHODS
@@ -1713,6 +1770,8 @@ uint8_t I2C::read16(uint8_t address, uint16_t registerAddress, uint8_t numberByt
  */
 uint8_t I2C::_start()
 {
+  // The polled calls need the TWI to themselves
+  waitIdle();
   timeoutTimer.reset();
   TWCR = (1 << TWINT) | (1 << TWSTA) | (1 << TWEN);
   while (!(TWCR & (1 << TWINT)))
@@ -1973,6 +2032,52 @@ inline void I2C::lockUp()
   TWCR = _BV(TWEN) | _BV(TWEA); // reinitialize TWI
 }
 
+void I2C::waitIdle()
+{
+  while (queueHead != nullptr)
+  {
+    loop();
+  }
+}
+
+void I2C::finishTransaction(const uint8_t status)
+{
+  I2CTransaction *transaction = queueHead;
+  queueHead = transaction->next;
+  if (queueHead == nullptr)
+  {
+    queueTail = nullptr;
+  }
+  transaction->status = status;
+  if (transaction->callback != nullptr)
+  {
+    finishing = true;
+    transaction->callback(*transaction);
+    finishing = false;
+  }
+
+  if (queueHead != nullptr)
+  {
+    transferIndex = 0;
+    transactionTimer.reset();
+    // STOP, then START for the next transaction as soon as the bus is free
+    TWCR = TWCR_QUEUED | _BV(TWSTO) | _BV(TWSTA);
+  }
+  else
+  {
+    TWCR = _BV(TWINT) | _BV(TWEN) | _BV(TWEA) | _BV(TWSTO);
+  }
+}
+
+/*
+ *  Description:
+ *      TWI event of the running queued transaction
+ */
+ISR(TWI_vect)
+{
+  I2c.processISR();
+}
+
 I2C I2c = I2C();
 
 uint8_t I2C::sendData(uint8_t address, const uint8_t *data, uint8_t length)
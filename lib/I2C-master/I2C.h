@@ -104,12 +104,47 @@
 
 #define MAX_BUFFER_SIZE 32 ///< Maximum buffer size for I2C data
 
+#define I2C_PENDING 0xFF ///< Status of a transaction that is queued or running
+
+/**
+ * @brief One queued I2C transaction, owned by the caller until it completes
+ *
+ * Sent as START, SLA+W, the register address bytes and the transmit bytes,
+ * then, when there is something to receive, a repeated START, SLA+R and the
+ * receive bytes, and a STOP. With no register, transmit or receive bytes it
+ * is an address probe. The fields must not change while status is
+ * I2C_PENDING.
+ */
+struct I2CTransaction
+{
+  /// Completion callback, runs in the TWI interrupt and may resubmit the transaction
+  typedef void (*Callback)(I2CTransaction &transaction);
+
+  uint8_t address;          ///< 7-bit I2C address
+  uint16_t registerAddress; ///< Register address, sent MSB first
+  uint8_t registerBytes;    ///< Register address bytes to send, 0 to 2
+  const uint8_t *txData;    ///< Bytes to send after the register address
+  uint8_t txLength;         ///< Number of bytes to send
+  uint8_t *rxData;          ///< Buffer for the received bytes
+  uint8_t rxLength;         ///< Number of bytes to receive
+  Callback callback;        ///< Called on completion, nullptr for none
+  void *context;            ///< Free for the callback
+  volatile uint8_t status;  ///< I2C_PENDING, 0 when done, 1 on timeout, else the TWI status that ended it
+  I2CTransaction *next;     ///< Queue link
+};
+
 /**
  * @brief Enhanced I2C master library for Arduino
  *
  * This class provides I2C master functionality with support for repeated start
  * conditions, timeouts to detect and recover from bus lockups, and utility functions
  * for common I2C operations.
+ *
+ * Transactions can also be queued with submit() and run in the background
+ * from the TWI interrupt, one after the other. write(address), write16()
+ * with a buffer and read16() with a buffer are thin wrappers that submit a
+ * transaction and wait for it. The other blocking calls poll the hardware
+ * directly and first wait for the queue to drain.
  */
 class I2C : public Traceable
 {
@@ -384,6 +419,52 @@ public:
   uint8_t read16(uint8_t address, uint16_t registerAddress, uint8_t numberBytes, uint8_t *dataBuffer);
   /** @} */
 
+  /**
+   * @name Queued Transactions
+   * @brief Interrupt driven transfers that run while the caller goes on
+   * @{
+   */
+
+  /**
+   * @brief Queue a transaction behind the ones already submitted
+   *
+   * Safe from the completion callback. The bus must have been opened with
+   * begin().
+   *
+   * @param transaction Transaction to run; status becomes I2C_PENDING
+   * @return false if the transaction is already queued
+   */
+  bool submit(I2CTransaction &transaction);
+
+  /**
+   * @brief Run a transaction and wait for it
+   *
+   * @param transaction Transaction to run
+   * @return The final status of the transaction
+   */
+  uint8_t transfer(I2CTransaction &transaction);
+
+  /**
+   * @brief Check whether queued transactions are still running
+   *
+   * @return true while the queue is not empty
+   */
+  bool isBusy() const;
+
+  /**
+   * @brief Fail the running transaction once it exceeds timeOut()
+   *
+   * Call regularly while transactions are queued; the bus is reset and the
+   * queue moves on.
+   */
+  void loop();
+
+  /**
+   * @brief Advance the running transaction, called from the TWI interrupt
+   */
+  void processISR();
+  /** @} */
+
   /**
    * @name Low-level I2C Methods
    * @brief Low-level functions for I2C communication
@@ -444,6 +525,18 @@ private:
    */
   void lockUp();
 
+  /**
+   * @brief Wait until the transaction queue has drained
+   */
+  void waitIdle();
+
+  /**
+   * @brief Complete the running transaction and start the next one
+   *
+   * @param status Final status of the running transaction
+   */
+  static void finishTransaction(const uint8_t status);
+
   static uint8_t returnStatus;          ///< Status code from last operation
   static uint8_t nack;                  ///< Whether a NACK was received
   static uint8_t data[MAX_BUFFER_SIZE]; ///< Buffer for received data
@@ -451,6 +544,11 @@ private:
   static uint8_t bufferIndex;           ///< Current index in buffer
   static uint8_t totalBytes;            ///< Total bytes in current transaction
   static SimpleTimer<uint8_t> timeoutTimer;  ///< Timer for timeout operations
+  static I2CTransaction *volatile queueHead;    ///< Running transaction, nullptr when idle
+  static I2CTransaction *queueTail;             ///< Last queued transaction
+  static uint16_t transferIndex;                ///< Bytes of the running phase already on the bus
+  static bool finishing;                        ///< A completion callback is running
+  static SimpleTimer<uint8_t> transactionTimer; ///< Started with every transaction, checked by loop()
 };
 
 /** Global instance of the I2C class */
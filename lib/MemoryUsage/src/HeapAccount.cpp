@@ -0,0 +1,108 @@
+/**
+ * @file HeapAccount.cpp
+ * @brief Implementation of the HeapAccount class.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "HeapAccount.h"
+
+HeapAccount::Counter HeapAccount::counters[static_cast<uint8_t>(HeapTag::Count)];
+
+/**
+ * @brief Printed name of a tag
+ */
+static const __FlashStringHelper *tagName(HeapTag tag)
+{
+	switch (tag)
+	{
+#define X(key, name)     \
+	case HeapTag::key: \
+		return F(name);
+		HEAP_TAGS
+#undef X
+	default:
+		return F("?");
+	}
+}
+
+/**
+ * @brief Allocate a block for a tag
+ *
+ * @param tag Owner of the block
+ * @param size Requested size in bytes
+ * @return The block, or NULL if the heap is exhausted
+ */
+void *HeapAccount::allocate(HeapTag tag, size_t size)
+{
+	Counter &counter = counters[static_cast<uint8_t>(tag)];
+	void *block = malloc(size);
+
+	if (block == NULL)
+	{
+		if (counter.failures < UINT16_MAX)
+			++counter.failures;
+		return NULL;
+	}
+
+	++counter.blocks;
+	counter.bytes += size;
+	if (counter.bytes > counter.peakBytes)
+		counter.peakBytes = counter.bytes;
+	return block;
+}
+
+/**
+ * @brief Free a block allocated with allocate()
+ *
+ * @param tag Owner given to allocate()
+ * @param block The block, NULL is ignored
+ * @param size Size given to allocate()
+ */
+void HeapAccount::release(HeapTag tag, void *block, size_t size)
+{
+	if (block == NULL)
+		return;
+
+	Counter &counter = counters[static_cast<uint8_t>(tag)];
+	--counter.blocks;
+	counter.bytes -= size;
+	free(block);
+}
+
+/**
+ * @brief Bytes currently allocated by all tags
+ */
+uint16_t HeapAccount::taggedBytes(void)
+{
+	uint16_t bytes = 0;
+
+	for (uint8_t i = 0; i < static_cast<uint8_t>(HeapTag::Count); ++i)
+		bytes += counters[i].bytes;
+	return bytes;
+}
+
+/**
+ * @brief Print one line per tag
+ *
+ * Format: "name:blocks blk, bytes B, peak:bytes B, failed:count".
+ *
+ * @param out Print stream to output information to (e.g., Serial)
+ */
+void HeapAccount::print(Print &out)
+{
+	for (uint8_t i = 0; i < static_cast<uint8_t>(HeapTag::Count); ++i)
+	{
+		const Counter &counter = counters[i];
+		out.print(tagName(static_cast<HeapTag>(i)));
+		out.print(':');
+		out.print(counter.blocks);
+		out.print(F(" blk, "));
+		out.print(counter.bytes);
+		out.print(F(" B, peak:"));
+		out.print(counter.peakBytes);
+		out.print(F(" B, failed:"));
+		out.println(counter.failures);
+	}
+}
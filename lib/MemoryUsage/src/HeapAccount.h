@@ -0,0 +1,118 @@
+/**
+ * @file HeapAccount.h
+ * @brief Per-owner heap allocation counters.
+ *
+ * Containers that allocate from the heap give their blocks a tag through
+ * TaggedHeapAllocator, which counts blocks and bytes per tag. Allocations
+ * made elsewhere (String buffers, the Arduino core) stay untagged; they are
+ * the heap in use minus the tagged bytes.
+ *
+ * Containers only use it as their default allocator when built with
+ * -DMEMORY_USAGE_HEAP_TAGS=1.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef __HeapAccount_h__
+#define __HeapAccount_h__
+
+#include "Arduino.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Registry of heap tags
+ *
+ * X(key, name): key names the HeapTag value, name is printed by HeapAccount::print().
+ */
+#define HEAP_TAGS        \
+    X(Queue, "Queue")    \
+    X(Map, "Map")
+
+/**
+ * @brief Owner of a heap block
+ */
+enum class HeapTag : uint8_t
+{
+#define X(key, name) key,
+    HEAP_TAGS
+#undef X
+    Count
+};
+
+/**
+ * @brief Heap allocation counters, one set per HeapTag
+ *
+ * Counters saturate at 0xFFFF. Not interrupt-safe, like malloc itself.
+ */
+class HeapAccount
+{
+public:
+    /**
+     * @brief Counters of one tag
+     */
+    struct Counter
+    {
+        uint16_t blocks;    ///< Blocks currently allocated
+        uint16_t bytes;     ///< Bytes currently allocated, malloc headers excluded
+        uint16_t peakBytes; ///< Highest value of bytes
+        uint16_t failures;  ///< Allocations malloc refused
+    };
+
+    /**
+     * @brief Allocate a block for a tag
+     *
+     * @param tag Owner of the block
+     * @param size Requested size in bytes
+     * @return The block, or NULL if the heap is exhausted
+     */
+    static void *allocate(HeapTag tag, size_t size);
+
+    /**
+     * @brief Free a block allocated with allocate()
+     *
+     * @param tag Owner given to allocate()
+     * @param block The block, NULL is ignored
+     * @param size Size given to allocate()
+     */
+    static void release(HeapTag tag, void *block, size_t size);
+
+    /**
+     * @brief Counters of a tag
+     */
+    static const Counter &get(HeapTag tag) { return counters[static_cast<uint8_t>(tag)]; }
+
+    /**
+     * @brief Bytes currently allocated by all tags
+     */
+    static uint16_t taggedBytes(void);
+
+    /**
+     * @brief Print one line per tag
+     *
+     * @param out Print stream to output information to (e.g., Serial)
+     */
+    static void print(Print &out);
+
+private:
+    static Counter counters[static_cast<uint8_t>(HeapTag::Count)];
+};
+
+/**
+ * @brief Allocator type counting its heap blocks under a tag
+ *
+ * Same interface as PoolAllocator (see StaticPool.h).
+ *
+ * @tparam TAG HeapTag owning the blocks
+ */
+template <HeapTag TAG>
+struct TaggedHeapAllocator
+{
+    static const size_t MAX_SIZE = SIZE_MAX;
+
+    static void *allocate(size_t size) { return HeapAccount::allocate(TAG, size); }
+    static void deallocate(void *block, size_t size) { HeapAccount::release(TAG, block, size); }
+};
+
+#endif
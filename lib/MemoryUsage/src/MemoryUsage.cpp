@@ -19,24 +19,141 @@
  */
 #define STACK_CANARY 0xc5
 
+/**
+ * @brief Block header of the avr-libc malloc free list
+ */
+struct __freelist
+{
+	size_t sz;
+	struct __freelist *nx;
+};
+
+/** @brief Head of the malloc free list */
+extern struct __freelist *__flp;
+
+/** @brief Next byte stackScan() checks */
+static uint8_t *scanCursor = NULL;
+
+/** @brief Start of the canary run under the scan cursor, NULL outside a run */
+static uint8_t *scanRunStart = NULL;
+
+/** @brief Longest canary run of the current sweep */
+static int scanLongest = 0;
+
+/** @brief Smallest longest run of all completed sweeps */
+static int scanLowest = 0;
+
 /**
  * @brief Paint the stack with a canary pattern
  *
  * Fills unused memory between the heap break and stack pointer with a canary value
  * to help detect maximum stack usage. This is called early in program execution to
- * establish a baseline.
+ * establish a baseline. Bytes above the stack pointer are live frames and stay as
+ * they are.
  */
 void MemoryUsage::stackPaint(void)
 {
 	uint8_t *p = (__brkval == 0 ? (uint8_t *)&__heap_start : __brkval);
+	uint8_t *const end = (uint8_t *)SP;
 
-	while (p < &__stack)
+	scanLowest = end - p;
+	while (p < end)
 	{
 		*p = STACK_CANARY;
 		++p;
 	}
 }
 
+/**
+ * @brief Scan the next part of the painted gap
+ *
+ * A sweep runs from the heap break up to the stack pointer of the call that
+ * finishes it. It restarts whenever the heap has grown past the cursor.
+ *
+ * @param bytes Number of bytes to check in this call
+ */
+void MemoryUsage::stackScan(uint8_t bytes)
+{
+	uint8_t *const heap_end = (__brkval == 0 ? (uint8_t *)&__heap_start : __brkval);
+	uint8_t *const scan_end = (uint8_t *)SP;
+
+	if (scanCursor < heap_end) // First call, or the heap grew over the cursor
+	{
+		scanCursor = heap_end;
+		scanRunStart = NULL;
+		scanLongest = 0;
+	}
+
+	for (; bytes > 0 && scanCursor < scan_end; --bytes, ++scanCursor)
+	{
+		if (*scanCursor == STACK_CANARY)
+		{
+			if (scanRunStart == NULL)
+				scanRunStart = scanCursor;
+		}
+		else if (scanRunStart != NULL)
+		{
+			if (scanCursor - scanRunStart > scanLongest)
+				scanLongest = scanCursor - scanRunStart;
+			scanRunStart = NULL;
+		}
+	}
+
+	if (scanCursor >= scan_end) // Sweep complete
+	{
+		if (scanRunStart != NULL && scan_end - scanRunStart > scanLongest)
+			scanLongest = scan_end - scanRunStart;
+		if (scanLongest < scanLowest)
+			scanLowest = scanLongest;
+		scanCursor = heap_end;
+		scanRunStart = NULL;
+		scanLongest = 0;
+	}
+}
+
+/**
+ * @brief Smallest free gap seen by the stack scan
+ *
+ * @return Lowest number of free bytes since stackPaint(), as of the last completed sweep
+ */
+int MemoryUsage::lowestFreeRam(void)
+{
+	return scanLowest;
+}
+
+/**
+ * @brief Size of the heap arena
+ *
+ * @return Number of bytes between the heap start and the heap break, including free blocks
+ */
+int MemoryUsage::heapSize(void)
+{
+	const uint8_t *heap_end = (__brkval == 0 ? (uint8_t *)&__heap_start : __brkval);
+
+	return heap_end - (uint8_t *)&__heap_start;
+}
+
+/**
+ * @brief Walk the malloc free list
+ *
+ * Each free block is its size word plus sz bytes.
+ *
+ * @param blocks Set to the number of free blocks below the heap break
+ * @return Number of bytes held by those blocks, headers included
+ */
+int MemoryUsage::heapFree(uint8_t &blocks)
+{
+	int free_bytes = 0;
+
+	blocks = 0;
+	for (const struct __freelist *block = __flp; block != NULL; block = block->nx)
+	{
+		free_bytes += block->sz + sizeof(block->sz);
+		++blocks;
+	}
+	return free_bytes;
+}
+
 /**
  * @brief Calculate the current free RAM
  *
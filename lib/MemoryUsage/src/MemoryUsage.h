@@ -75,11 +75,45 @@ public:
     /**
      * @brief Paint the stack with a canary pattern
      *
-     * Fills unused memory (between heap and stack) with a canary value (0xc5)
+     * Fills unused memory (between heap and stack pointer) with a canary value (0xc5)
      * to help detect maximum stack usage.
      */
     static void stackPaint(void);
 
+    /**
+     * @brief Scan the next part of the painted gap
+     *
+     * Call once per loop pass. Each call checks @p bytes more of the gap between the
+     * heap and the stack pointer; when a sweep reaches the stack pointer, its longest
+     * canary run lowers the mark returned by lowestFreeRam(). The whole gap is covered
+     * every gap / @p bytes calls without the cost of minimumFreeRam().
+     *
+     * @param bytes Number of bytes to check in this call
+     */
+    static void stackScan(uint8_t bytes);
+
+    /**
+     * @brief Smallest free gap seen by the stack scan
+     *
+     * @return Lowest number of free bytes since stackPaint(), as of the last completed sweep
+     */
+    static int lowestFreeRam(void);
+
+    /**
+     * @brief Size of the heap arena
+     *
+     * @return Number of bytes between the heap start and the heap break, including free blocks
+     */
+    static int heapSize(void);
+
+    /**
+     * @brief Walk the malloc free list
+     *
+     * @param blocks Set to the number of free blocks below the heap break
+     * @return Number of bytes held by those blocks, headers included
+     */
+    static int heapFree(uint8_t &blocks);
+
     /**
      * @brief Calculate the current free RAM
      *
@@ -0,0 +1,63 @@
+/**
+ * @file StaticPool.cpp
+ * @brief Implementation of the MemoryPool registry.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "StaticPool.h"
+
+MemoryPool *MemoryPool::s_first = nullptr;
+
+/**
+ * @brief Register a pool
+ *
+ * @param name PROGMEM name printed by printAll()
+ * @param capacity Bytes of storage the pool owns
+ */
+MemoryPool::MemoryPool(const char *name, uint16_t capacity)
+	: p_next(s_first), p_name(name), m_capacity(capacity)
+{
+	s_first = this;
+}
+
+/**
+ * @brief Count bytes handed out
+ */
+void MemoryPool::take(uint16_t bytes)
+{
+	m_used += bytes;
+	if (m_used > m_peak)
+		m_peak = m_used;
+}
+
+/**
+ * @brief Count a refused request
+ */
+void MemoryPool::fail()
+{
+	if (m_failures < UINT16_MAX)
+		++m_failures;
+}
+
+/**
+ * @brief Print one line per registered pool
+ *
+ * @param out Print stream to output information to (e.g., Serial)
+ */
+void MemoryPool::printAll(Print &out)
+{
+	for (const MemoryPool *pool = s_first; pool != nullptr; pool = pool->p_next)
+	{
+		out.print(reinterpret_cast<const __FlashStringHelper *>(pool->p_name));
+		out.print(':');
+		out.print(pool->m_used);
+		out.print('/');
+		out.print(pool->m_capacity);
+		out.print(F(" B, peak:"));
+		out.print(pool->m_peak);
+		out.print(F(" B, failed:"));
+		out.println(pool->m_failures);
+	}
+}
@@ -0,0 +1,220 @@
+/**
+ * @file StaticPool.h
+ * @brief Fixed-size block pools and a bump arena in static storage.
+ *
+ * StaticPool hands out blocks of one size from an array it owns, so a
+ * container that allocates nodes never touches the heap and cannot fail
+ * from fragmentation. StaticArena hands out buffers once, at init time, and
+ * never takes them back. Both keep their storage inside the object, so it
+ * shows up in the RAM map at link time, and both register themselves for
+ * MemoryPool::printAll().
+ *
+ * Containers take an allocator type parameter: a type with static
+ * allocate(size)/deallocate(block, size) and a MAX_SIZE constant.
+ * PoolAllocator turns a global pool or arena into one.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef __StaticPool_h__
+#define __StaticPool_h__
+
+#include "Arduino.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @brief Usage counters and registry of static pools and arenas
+ *
+ * Counters saturate at 0xFFFF. Not interrupt-safe.
+ */
+class MemoryPool
+{
+public:
+    /**
+     * @brief Print one line per registered pool
+     *
+     * Format: "name:used/capacity B, peak:bytes B, failed:count".
+     *
+     * @param out Print stream to output information to (e.g., Serial)
+     */
+    static void printAll(Print &out);
+
+    uint16_t getUsed() const { return m_used; }
+    uint16_t getPeak() const { return m_peak; }
+    uint16_t getCapacity() const { return m_capacity; }
+    uint16_t getFailures() const { return m_failures; }
+
+protected:
+    /**
+     * @brief Register a pool
+     *
+     * @param name PROGMEM name printed by printAll()
+     * @param capacity Bytes of storage the pool owns
+     */
+    MemoryPool(const char *name, uint16_t capacity);
+
+    MemoryPool(const MemoryPool &) = delete;
+    MemoryPool &operator=(const MemoryPool &) = delete;
+
+    /** @brief Count bytes handed out */
+    void take(uint16_t bytes);
+
+    /** @brief Count bytes given back */
+    void give(uint16_t bytes) { m_used -= bytes; }
+
+    /** @brief Count a refused request */
+    void fail();
+
+private:
+    static MemoryPool *s_first; ///< Most recently registered pool
+
+    MemoryPool *const p_next;
+    const char *const p_name;
+    const uint16_t m_capacity;
+    uint16_t m_used = 0;
+    uint16_t m_peak = 0;
+    uint16_t m_failures = 0;
+};
+
+/**
+ * @brief Pool of BLOCK_COUNT blocks of BLOCK_SIZE bytes
+ *
+ * Allocation and release are O(1): freed blocks go on an intrusive free
+ * list, blocks never handed out are taken in order.
+ *
+ * @tparam BLOCK_SIZE Largest request served, at least the size of a pointer
+ * @tparam BLOCK_COUNT Number of blocks
+ */
+template <size_t BLOCK_SIZE, uint8_t BLOCK_COUNT>
+class StaticPool : public MemoryPool
+{
+public:
+    static const size_t MAX_SIZE = BLOCK_SIZE;
+
+    /**
+     * @param name PROGMEM name printed by MemoryPool::printAll()
+     */
+    explicit StaticPool(const char *name) : MemoryPool(name, sizeof(Block) * BLOCK_COUNT) {}
+
+    /**
+     * @brief Take a block
+     *
+     * @param size Requested size, at most BLOCK_SIZE
+     * @return The block, or nullptr if the pool is empty or @p size is too large
+     */
+    void *allocate(size_t size)
+    {
+        Block *block = p_free;
+        if (size > BLOCK_SIZE)
+            block = nullptr;
+        else if (block != nullptr)
+            p_free = block->next;
+        else if (m_fresh < BLOCK_COUNT)
+            block = &m_blocks[m_fresh++];
+
+        if (block == nullptr)
+        {
+            fail();
+            return nullptr;
+        }
+        take(sizeof(Block));
+        return block;
+    }
+
+    /**
+     * @brief Give a block back
+     *
+     * @param block Block from allocate(), nullptr is ignored
+     */
+    void deallocate(void *block, size_t)
+    {
+        if (block == nullptr)
+            return;
+        Block *freed = static_cast<Block *>(block);
+        freed->next = p_free;
+        p_free = freed;
+        give(sizeof(Block));
+    }
+
+private:
+    union Block
+    {
+        Block *next; ///< Next free block while on the free list
+        uint8_t bytes[BLOCK_SIZE];
+    };
+
+    Block m_blocks[BLOCK_COUNT];
+    Block *p_free = nullptr; ///< Free list of released blocks
+    uint8_t m_fresh = 0;     ///< Blocks at the front of m_blocks handed out at least once
+};
+
+/**
+ * @brief Bump arena of SIZE bytes for buffers allocated once at init time
+ *
+ * deallocate() does nothing; the space is only reused after a reset.
+ *
+ * @tparam SIZE Bytes of storage
+ */
+template <uint16_t SIZE>
+class StaticArena : public MemoryPool
+{
+public:
+    static const size_t MAX_SIZE = SIZE;
+
+    /**
+     * @param name PROGMEM name printed by MemoryPool::printAll()
+     */
+    explicit StaticArena(const char *name) : MemoryPool(name, SIZE) {}
+
+    /**
+     * @brief Carve a buffer from the arena
+     *
+     * @param size Requested size in bytes
+     * @return The buffer, or nullptr if the arena is exhausted
+     */
+    void *allocate(size_t size)
+    {
+        if (size > static_cast<size_t>(SIZE - getUsed()))
+        {
+            fail();
+            return nullptr;
+        }
+        void *buffer = &m_storage[getUsed()];
+        take(size);
+        return buffer;
+    }
+
+    /**
+     * @brief Buffers stay allocated until reset
+     */
+    void deallocate(void *, size_t) {}
+
+private:
+    uint8_t m_storage[SIZE];
+};
+
+/**
+ * @brief Allocator type for a global pool or arena
+ *
+ * @tparam Pool Type of the pool
+ * @tparam POOL The pool, with static storage duration
+ *
+ * Example:
+ * @code
+ * static const char NODE_POOL_NAME[] PROGMEM = "Queue nodes";
+ * StaticPool<4, 8> nodePool(NODE_POOL_NAME);
+ * ArduinoQueue<uint8_t, PoolAllocator<StaticPool<4, 8>, nodePool>> queue;
+ * @endcode
+ */
+template <typename Pool, Pool &POOL>
+struct PoolAllocator
+{
+    static const size_t MAX_SIZE = Pool::MAX_SIZE;
+
+    static void *allocate(size_t size) { return POOL.allocate(size); }
+    static void deallocate(void *block, size_t size) { POOL.deallocate(block, size); }
+};
+
+#endif
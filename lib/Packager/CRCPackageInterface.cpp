@@ -7,9 +7,11 @@
  * @details Implements a robust communication protocol optimized for embedded systems:
  *
  * Protocol Features:
- * - Fixed 15-byte packet format (4B header + 8B payload + 3B footer)
+ * - 15-byte packet format (4B header + 8B payload + 3B footer)
+ * - Payload size negotiated on RESET (8/16/32 bytes)
  * - CRC-16-CCITT error detection
  * - Automatic retransmission
+ * - Sliding window with selective retransmit (negotiated on RESET)
  * - Connection state monitoring
  *
  * Implementation Highlights:
@@ -37,6 +39,54 @@
 #define CLASS_TRACE_LEVEL DEBUG_CRC_PACKAGE
 #include "../Utilities/TraceHelper.h"
 
+#if CRC_PACKAGE_CRC_METHOD == CRC_PACKAGE_CRC_ASM
+#include <util/crc16.h>
+#elif CRC_PACKAGE_CRC_METHOD == CRC_PACKAGE_CRC_NIBBLE_TABLE
+/// CRC-16-CCITT (0x1021) remainders of every 4-bit value
+static const uint16_t CRC16_NIBBLE_TABLE[16] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+#elif CRC_PACKAGE_CRC_METHOD == CRC_PACKAGE_CRC_BYTE_TABLE
+/// CRC-16-CCITT (0x1021) remainders of every 8-bit value
+static const uint16_t CRC16_BYTE_TABLE[256] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0,
+};
+#else
+#error "Unknown CRC_PACKAGE_CRC_METHOD"
+#endif
+
 // Flash String Constants
 // Error message prefixes stored in flash memory to minimize RAM usage
 const char CRCPackageInterface::PREFIX_I_STR[] PROGMEM = "I:"; ///< Incoming channel errors
@@ -66,32 +116,64 @@ const char CRCPackageInterface::RESET_NUM_STR[] PROGMEM = "Reset number";
  * - Timers (data, ACK/NACK, reset)
  * - Message queues (cleared)
  * - Packet buffers (zeroed)
+ * - Window size 1 and 8-byte payloads until a RESET handshake negotiates more
  *
  * Note: Starting packet number is 1 (not 0) for outgoing packets
  * to distinguish from reset packets.
  */
-CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize)
-    : PackageInterface(pipedStreamPair, encodedBufferSize),
-      Traceable(F("CRCPackageInterface"), static_cast<Level>(DEBUG_CRC_PACKAGE)),
+CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair)
+    : PackageInterface(pipedStreamPair, m_packagerStreamPair),
+      Traceable(TraceComponent::CRC_PACKAGE),
       m_outgoingTimer(OUTGOING_DATA_READ_TIMEOUT),
       m_incomingTimer(INCOMING_DATA_WAIT_TIMEOUT),
       m_resetDetectionTimer(RESET_DETECTION_TIMEOUT),
       m_outgoingPacketNumber(1),
-      m_lastIncomingPacketNumber(0)
+      m_lastIncomingPacketNumber(0),
+      m_outgoingHead(0),
+      m_outgoingCount(0),
+      m_windowSize(1),
+      m_payloadClass(0),
+      m_features(0),
+      m_pendingAckCount(0),
+      m_ackDelayTimer(ACK_DELAY_TIMEOUT),
+      m_smoothedRtt(0),
+      m_rttVariation(0),
+      m_retransmitTimeout(OUTGOING_DATA_ACK_NACK_TIMEOUT),
+      m_resetAttempts(0),
+      m_sessionId(0),
+      m_connected(true),
+      m_coalesceDelay(OUTGOING_DATA_READ_TIMEOUT),
+      m_flushChannels(0),
+      m_lineFlushChannels(0),
+      m_creditProbeTimer(CREDIT_PROBE_TIMEOUT),
+      m_bulkChannels(0),
+      m_outOfWindowCount(0),
+      m_nextOutgoingChannel(0),
+      m_incomingCrc(CRC_INITIAL_VALUE),
+      m_plainDeliveryMicros(0)
 {
     // Zero packet buffers
-    memset(&m_outgoingPackage, 0, sizeof(m_outgoingPackage));
+    for (uint8_t i = 0; i < MAX_WINDOW_SIZE; i++)
+    {
+        memset(&m_outgoingSlots[i].package, 0, sizeof(m_outgoingSlots[i].package));
+        memset(&m_outgoingSlots[i].flags, 0, sizeof(m_outgoingSlots[i].flags));
+        m_outgoingSlots[i].timer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+    }
+    memset(m_receivedSlots, 0, sizeof(m_receivedSlots));
+    memset(p_channelPipes, 0, sizeof(p_channelPipes));
+    memset(m_laneDepth, 0, sizeof(m_laneDepth));
+    memset(m_peakLaneDepth, 0, sizeof(m_peakLaneDepth));
     memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
+    memset(&m_linkStatistic, 0, sizeof(m_linkStatistic));
+    resetCredit();
 
     // Clear status flags
-    memset(&m_outgoingFlags, 0, sizeof(m_outgoingFlags));
     memset(&m_incomingFlags, 0, sizeof(m_incomingFlags));
 
     // Clear message queue
     m_messageQueue.clear();
 
     // Set initial states
-    m_outgoingFlags.m_currentState = OutgoingState::READ_DATA;
     m_incomingFlags.m_currentState = IncomingState::WAIT_FOR_START_BYTE;
 }
 
@@ -109,23 +191,40 @@ CRCPackageInterface::CRCPackageInterface(PipedStreamPair &pipedStreamPair, const
  *    - Limits state transitions
  *    - Reports excessive transitions
  *
- * 3. Incoming Channel:
+ * 3. Delayed ACK:
+ *    - Sends the cumulative ACK outgoing DATA did not carry
+ *    - Sends one as window update once a reader made room again
+ *
+ * 4. Incoming Channel:
  *    - Processes state machine
  *    - Limits state transitions
  *    - Reports excessive transitions
  *
  * Note: State machine transitions are limited to prevent
- * infinite loops in case of corruption.
+ * infinite loops in case of corruption. While the link is down (see
+ * setConnected()) only the connection timeout runs.
  */
 void CRCPackageInterface::loop()
 {
-    // Check for connection timeout
+    // Check for connection timeout; state that was reset cannot be resumed
     if (m_resetDetectionTimer.isReady())
     {
-        resetPacketNumbering();
+        if (resetPacketNumbering())
+        {
+            m_sessionId = 0;
+        }
         m_resetDetectionTimer.reset();
     }
 
+    if (!m_connected)
+    {
+        return;
+    }
+
+    // Hand over buffered packets the plain stream had no room for earlier
+    deliverReceivedSlots();
+    sampleLaneDepths();
+
     {
         // Process outgoing channel with transition limit
         uint8_t outgoingStateChanges = 0;
@@ -149,6 +248,10 @@ void CRCPackageInterface::loop()
         }
     }
 
+    // Outgoing DATA had its chance to carry the ACK
+    flushPendingAck();
+    flushCreditUpdate();
+
     {
         // Process incoming channel with transition limit
         uint8_t incomingStateChanges = 0;
@@ -173,13 +276,117 @@ void CRCPackageInterface::loop()
     }
 }
 
+/**
+ * @brief Routes a channel to its own stream pair
+ *
+ * @details Out-of-range channels are ignored; channel 0 always belongs
+ * to the constructor's pair.
+ *
+ * @param channel Channel ID (1 to CHANNEL_COUNT - 1)
+ * @param pipedStreamPair Bidirectional stream for the channel's plain data
+ */
+void CRCPackageInterface::attachChannel(const uint8_t channel, PipedStreamPair &pipedStreamPair)
+{
+    if (channel == 0 || channel >= CHANNEL_COUNT)
+    {
+        return;
+    }
+    p_channelPipes[channel - 1] = &pipedStreamPair;
+}
+
+/**
+ * @brief Holds or restarts the protocol around a link drop
+ *
+ * @details Down: the connection timeout becomes SESSION_RESUME_TIMEOUT.
+ * Up: the timeout returns to RESET_DETECTION_TIMEOUT, the retransmit and
+ * RESET timers restart, and a frame cut by the drop is discarded.
+ *
+ * @param connected true once the link is back, false when it dropped
+ */
+void CRCPackageInterface::setConnected(const bool connected)
+{
+    if (connected == m_connected)
+    {
+        return;
+    }
+    m_connected = connected;
+    m_resetDetectionTimer.setInterval(connected ? RESET_DETECTION_TIMEOUT : SESSION_RESUME_TIMEOUT);
+    m_resetDetectionTimer.reset();
+    if (!connected)
+    {
+        return;
+    }
+
+    for (uint8_t offset = 0; offset < m_outgoingCount; offset++)
+    {
+        outgoingSlot(offset).timer.reset();
+    }
+    m_outgoingTimer.reset();
+    resetIncomingState();
+}
+
+void CRCPackageInterface::setCoalesceDelay(const uint16_t delay)
+{
+    m_coalesceDelay = delay;
+    // The timer times the RESET while one is pending
+    if (m_resetAttempts == 0)
+    {
+        m_outgoingTimer.setInterval(delay);
+    }
+}
+
+void CRCPackageInterface::flush(const uint8_t channel)
+{
+    if (channel < CHANNEL_COUNT)
+    {
+        m_flushChannels |= (1 << channel);
+    }
+}
+
+void CRCPackageInterface::setLineFlush(const uint8_t channel, const bool enabled)
+{
+    if (channel >= CHANNEL_COUNT)
+    {
+        return;
+    }
+    if (enabled)
+    {
+        m_lineFlushChannels |= (1 << channel);
+    }
+    else
+    {
+        m_lineFlushChannels &= static_cast<uint8_t>(~(1 << channel));
+    }
+}
+
+void CRCPackageInterface::setChannelLane(const uint8_t channel, const Lane lane)
+{
+    if (channel >= CHANNEL_COUNT)
+    {
+        return;
+    }
+    if (lane == LANE_BULK)
+    {
+        m_bulkChannels |= (1 << channel);
+    }
+    else
+    {
+        m_bulkChannels &= static_cast<uint8_t>(~(1 << channel));
+    }
+}
+
 /**
  * @brief Initiates connection reset
  *
  * @details Performs connection reset sequence:
  * 1. Checks buffer capacity
- * 2. Sends RESET packet (type: 3, number: 0)
- * 3. Resets local protocol state
+ * 2. Sends RESET packet (type: 3, number: 0) offering MAX_WINDOW_SIZE,
+ *    MAX_DATA_LENGTH, cumulative ACKs and channels, naming a new session
+ * 3. Resets local protocol state, window back to 1, payload back to
+ *    BASE_DATA_LENGTH, per-packet ACKs and channel 0 only until the peer's RESET-ACK
+ *    states what it supports
+ * 4. Holds outgoing data, resending the RESET until the RESET-ACK
+ *    arrives or MAX_RETRY_COUNT is exhausted
  *
  * Used to recover from:
  * - Connection loss
@@ -187,6 +394,36 @@ void CRCPackageInterface::loop()
  * - Peer reset/restart
  */
 void CRCPackageInterface::sendResetPacket()
+{
+    const uint16_t previousSession = m_sessionId;
+    m_sessionId = nextSessionId();
+    if (!transmitResetPacket())
+    {
+        m_sessionId = previousSession;
+        return;
+    }
+
+    // Reset local state
+    resetPacketNumbering();
+    m_windowSize = 1;
+    m_payloadClass = 0;
+    m_features = 0;
+    m_pendingAckCount = 0;
+
+    // Hold data until the peer confirms, resending the RESET meanwhile
+    m_resetAttempts = 1;
+    m_outgoingTimer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+    m_outgoingTimer.reset();
+}
+
+/**
+ * @brief Writes a RESET packet offering MAX_WINDOW_SIZE, MAX_DATA_LENGTH
+ * and SUPPORTED_FEATURES for session m_sessionId
+ *
+ * @return true if sent
+ * @return false if the encoded stream had no room
+ */
+bool CRCPackageInterface::transmitResetPacket()
 {
     PipedStream &encodedStream = getInternalEncodedStream();
 
@@ -197,17 +434,20 @@ void CRCPackageInterface::sendResetPacket()
             << PGMT(PREFIX_O_STR)
             << PGMT(BUFFER_FULL_STR)
             << endl;
-        return;
+        return false;
     }
 
     // Send reset packet
     Package resetPackage;
     memset(&resetPackage, 0, sizeof(resetPackage));
+    resetPackage.data[CAPABILITY_WINDOW_INDEX] = MAX_WINDOW_SIZE;
+    resetPackage.data[CAPABILITY_PAYLOAD_INDEX] = MAX_DATA_LENGTH;
+    resetPackage.data[CAPABILITY_FEATURE_INDEX] = SUPPORTED_FEATURES;
+    resetPackage.data[SESSION_ID_INDEX] = m_sessionId & 0xFF;
+    resetPackage.data[SESSION_ID_INDEX + 1] = m_sessionId >> 8;
     preparePackage(resetPackage, RESET_TYPE, 0);
     sendPackage(resetPackage);
-
-    // Reset local state
-    resetPacketNumbering();
+    return true;
 }
 
 /**
@@ -216,49 +456,52 @@ void CRCPackageInterface::sendResetPacket()
  * @details Performs complete protocol reset:
  * 1. Resets packet counters (out: 1, in: 0)
  * 2. Clears message queues
- * 3. Resets state machines
+ * 3. Resets state machines and the round-trip estimate
  * 4. Reports reset event
  *
- * Note: Only resets if outgoing number isn't already 1
- * to avoid unnecessary operations.
+ * Note: Only resets if the link has carried traffic since the
+ * last reset, to avoid unnecessary operations. m_sessionId is left to
+ * the caller.
+ *
+ * @return true if there was state to reset
  */
-void CRCPackageInterface::resetPacketNumbering()
+bool CRCPackageInterface::resetPacketNumbering()
 {
-    if (m_outgoingPacketNumber == 1)
+    if (m_outgoingPacketNumber == 1 && m_outgoingCount == 0 && m_lastIncomingPacketNumber == 0)
     {
-        return;
+        return false;
     }
 
     // Reset packet sequence
     m_outgoingPacketNumber = 1;
     m_lastIncomingPacketNumber = 0;
+    m_pendingAckCount = 0;
 
     // Clear queues and states
     m_messageQueue.clear();
+    memset(m_receivedSlots, 0, sizeof(m_receivedSlots));
+    m_outOfWindowCount = 0;
     resetOutgoingState();
     resetIncomingState();
+    resetRoundTrip();
 
     TRACE_INFO()
         << PGMT(PREFIX_STR)
         << PGMT(RESET_NUM_STR)
         << endl;
+    return true;
 }
 
 /**
  * @brief Calculates CRC-16-CCITT checksum
  *
- * @details Implements CRC-16-CCITT algorithm:
+ * @details Parameters:
  * - Polynomial: 0x1021 (x^16 + x^12 + x^5 + 1)
  * - Initial value: 0xFFFF
- * - No final XOR
+ * - No final XOR, MSB first
  *
- * Algorithm steps:
- * 1. Initialize CRC to 0xFFFF
- * 2. For each byte:
- *    - XOR byte into high byte of CRC
- *    - For each bit:
- *      - If MSB set: shift left and XOR with polynomial
- *      - If MSB clear: shift left only
+ * The per-byte step is crc16Update(), so block and incremental
+ * results are identical.
  *
  * @param data Input data buffer
  * @param length Number of bytes to process
@@ -266,15 +509,57 @@ void CRCPackageInterface::resetPacketNumbering()
  */
 uint16_t CRCPackageInterface::crc16(const uint8_t *const data, const uint8_t length)
 {
-    uint16_t crc = 0xFFFF;
+    uint16_t crc = CRC_INITIAL_VALUE;
     for (uint8_t i = 0; i < length; i++)
     {
-        crc ^= (uint16_t)data[i] << 8;
+        crc = crc16Update(crc, data[i]);
+    }
+    return crc;
+}
 
-        for (uint8_t bit = 0; bit < 8; bit++)
-        {
-            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
-        }
+/**
+ * @brief Folds one byte into a running CRC-16-CCITT value
+ *
+ * @details Engines (CRC_PACKAGE_CRC_METHOD):
+ * - ASM: avr-libc _crc_xmodem_update(), no table, ~20 cycles
+ * - NIBBLE_TABLE: two PROGMEM lookups, 32 bytes of flash
+ * - BYTE_TABLE: one PROGMEM lookup, 512 bytes of flash
+ *
+ * All three replace the original 8-iteration bit loop.
+ *
+ * @param crc Running CRC value
+ * @param data Next input byte
+ * @return uint16_t Updated CRC value
+ */
+uint16_t CRCPackageInterface::crc16Update(uint16_t crc, const uint8_t data)
+{
+#if CRC_PACKAGE_CRC_METHOD == CRC_PACKAGE_CRC_ASM
+    return _crc_xmodem_update(crc, data);
+#elif CRC_PACKAGE_CRC_METHOD == CRC_PACKAGE_CRC_NIBBLE_TABLE
+    crc = (crc << 4) ^ pgm_read_word(&CRC16_NIBBLE_TABLE[(crc >> 12) ^ (data >> 4)]);
+    crc = (crc << 4) ^ pgm_read_word(&CRC16_NIBBLE_TABLE[(crc >> 12) ^ (data & 0x0F)]);
+    return crc;
+#else
+    return (crc << 8) ^ pgm_read_word(&CRC16_BYTE_TABLE[(crc >> 8) ^ data]);
+#endif
+}
+
+/**
+ * @brief CRC-16 over a frame's CRC scope
+ *
+ * @details Covers the header from the packet number on and the frame's
+ * payload size, then ackNumber when the frame carries it. The receiver
+ * folds in the same bytes in wire order.
+ *
+ * @param package Packet to checksum
+ * @return uint16_t Calculated CRC-16 value
+ */
+uint16_t CRCPackageInterface::frameCrc(const Package &package)
+{
+    uint16_t crc = crc16(&package.header.packetNumber, CRC_HEADER_SCOPE_LENGTH + payloadLength(package.header));
+    if (hasAckNumber(package.header))
+    {
+        crc = crc16Update(crc, package.ackNumber);
     }
     return crc;
 }
@@ -287,16 +572,19 @@ uint16_t CRCPackageInterface::crc16(const uint8_t *const data, const uint8_t len
  * - LSB stored second
  *
  * This approach works correctly regardless of
- * platform endianness.
+ * platform endianness. The result is assigned rather than written through
+ * a reference, which a packed field cannot bind on hosts with alignment.
  *
- * @param dest Destination CRC variable
  * @param src Source CRC value
+ * @return uint16_t CRC in wire byte order, for the footer field
  */
-inline void storeCRC(uint16_t &dest, const uint16_t src)
+inline uint16_t storeCRC(const uint16_t src)
 {
+    uint16_t dest;
     uint8_t *const destBytes = (uint8_t *)&dest;
     destBytes[0] = (src >> 8) & 0xFF; // MSB
     destBytes[1] = src & 0xFF;        // LSB
+    return dest;
 }
 
 /**
@@ -312,7 +600,7 @@ inline void storeCRC(uint16_t &dest, const uint16_t src)
  * @param src Source CRC variable
  * @return uint16_t Retrieved CRC value
  */
-inline uint16_t retrieveCRC(const uint16_t &src)
+inline uint16_t retrieveCRC(const uint16_t src)
 {
     const uint8_t *const srcBytes = (const uint8_t *)&src;
     return ((uint16_t)srcBytes[0] << 8) | srcBytes[1];
@@ -354,17 +642,25 @@ const __FlashStringHelper *CRCPackageInterface::toString(const NackReason reason
  * @brief Resets outgoing channel state
  *
  * @details Performs complete outgoing reset:
- * 1. Clears packet buffer
- * 2. Resets state to READ_DATA
- * 3. Clears retry counter
+ * 1. Empties the window (packets not yet acked are dropped)
+ * 2. Resets every slot to READ_DATA
+ * 3. Clears retry counters
  * 4. Resets timeout timer
+ *
+ * m_outgoingPacketNumber is left alone, so the next packet reuses the
+ * number of the oldest one dropped.
  */
 void CRCPackageInterface::resetOutgoingState()
 {
-    memset(&m_outgoingPackage, 0, sizeof(m_outgoingPackage));
-    m_outgoingFlags.m_currentState = OutgoingState::READ_DATA;
-    m_outgoingFlags.m_retryCount = 0;
-    m_outgoingTimer.setInterval(OUTGOING_DATA_READ_TIMEOUT);
+    for (uint8_t i = 0; i < MAX_WINDOW_SIZE; i++)
+    {
+        memset(&m_outgoingSlots[i].package, 0, sizeof(m_outgoingSlots[i].package));
+        m_outgoingSlots[i].flags.m_currentState = OutgoingState::READ_DATA;
+        m_outgoingSlots[i].flags.m_retryCount = 0;
+    }
+    m_outgoingHead = 0;
+    m_outgoingCount = 0;
+    m_outgoingTimer.setInterval(m_coalesceDelay);
     m_outgoingTimer.reset();
 }
 
@@ -382,6 +678,7 @@ void CRCPackageInterface::resetIncomingState()
     memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
     m_incomingFlags.m_incomingDataLength = 0;
     m_incomingFlags.m_currentState = IncomingState::WAIT_FOR_START_BYTE;
+    m_incomingCrc = CRC_INITIAL_VALUE;
     m_incomingTimer.setInterval(INCOMING_DATA_WAIT_TIMEOUT);
     m_incomingTimer.reset();
 }
@@ -393,17 +690,18 @@ void CRCPackageInterface::resetIncomingState()
  * 1. Sets header fields
  *    - Start byte (0xAA)
  *    - Packet number
- *    - Type
+ *    - Type (DATA carries the negotiated payload class and, with
+ *      FEATURE_CUMULATIVE_ACK, ACK_FLAG and the current ackNumber)
  *    - Length
  * 2. Copies payload data (if any)
  * 3. Sets footer fields
- *    - CRC-16 over header+data
+ *    - CRC-16 over header+data(+ackNumber)
  *    - Stop byte (0x55)
  *
  * @param package Packet structure to prepare
- * @param type Packet type (DATA/ACK/NACK/RESET)
+ * @param type Packet type (DATA/ACK/NACK/RESET), ACK may add ACK_FLAG
  * @param packetNumber Sequence number
- * @param dataLength Payload length (0-8 bytes)
+ * @param dataLength Payload length (0 to the frame's payload size)
  * @param data Payload buffer (nullptr if no data)
  */
 void CRCPackageInterface::preparePackage(Package &package, const uint8_t type, const uint8_t packetNumber,
@@ -415,6 +713,20 @@ void CRCPackageInterface::preparePackage(Package &package, const uint8_t type, c
     package.header.type = type;
     package.header.length = dataLength;
 
+    if (type != DATA_TYPE)
+    {
+        package.header.channel = 0;
+    }
+    else
+    {
+        package.header.type |= m_payloadClass << PAYLOAD_CLASS_SHIFT;
+        if (m_features & FEATURE_CUMULATIVE_ACK)
+        {
+            package.header.type |= ACK_FLAG;
+            package.ackNumber = m_lastIncomingPacketNumber;
+        }
+    }
+
     // Copy data if provided
     if (data && dataLength > 0)
     {
@@ -425,57 +737,84 @@ void CRCPackageInterface::preparePackage(Package &package, const uint8_t type, c
     package.footer.stopByte = STOP_BYTE;
 
     // Calculate and store CRC
-    const uint16_t calculatedCrc = crc16((uint8_t *)&package.header.packetNumber, CRC_SCOPE_LENGTH);
-    storeCRC(package.footer.crc, calculatedCrc);
+    package.footer.crc = storeCRC(frameCrc(package));
 }
 
 /**
- * @brief Validates received packet
+ * @brief Validates a received header as soon as its last byte arrives
  *
- * @details Performs comprehensive validation:
- * 1. Frame markers (0xAA/0x55)
- * 2. Packet type (0-3)
+ * @details Checks everything the header alone decides, so a corrupted
+ * frame is dropped before its payload is read:
+ * 1. Packet type (0-3), payload class only on DATA, ACK_FLAG only on
+ *    DATA and ACK
+ * 2. Payload class within our buffers
  * 3. Length constraints:
- *    - DATA: 0-8 bytes
+ *    - DATA: 0 to the frame's payload size
  *    - ACK: 0 bytes
  *    - NACK: 1 byte
  *    - RESET: 0 bytes
- * 4. CRC-16 integrity
  *
- * @param package Packet to validate
+ * @param header Header of the frame being received
  * @return NackReason Error code (NO_ERROR if valid)
  */
-CRCPackageInterface::NackReason CRCPackageInterface::validatePackage(const Package &package) const
+CRCPackageInterface::NackReason CRCPackageInterface::validateHeader(const PackageHeader &header)
 {
-    // Check frame markers
-    if (package.header.startByte != START_BYTE || package.footer.stopByte != STOP_BYTE)
+    // Check packet type
+    const uint8_t type = packageType(header);
+    const uint8_t allowedFlags = (type == DATA_TYPE)  ? ((PAYLOAD_CLASS_MASK << PAYLOAD_CLASS_SHIFT) | ACK_FLAG)
+                                 : (type == ACK_TYPE) ? ACK_FLAG
+                                                      : 0;
+    if (type > RESET_TYPE || (header.type & ~(TYPE_MASK | allowedFlags)))
     {
-        return NackReason::INVALID_START_STOP;
+        return NackReason::INVALID_TYPE;
     }
 
-    // Check packet type
-    if (package.header.type > RESET_TYPE)
+    // Size class beyond our buffers - the frame cannot be read
+    if (((header.type >> PAYLOAD_CLASS_SHIFT) & PAYLOAD_CLASS_MASK) > MAX_PAYLOAD_CLASS)
     {
-        return NackReason::INVALID_TYPE;
+        return NackReason::INVALID_LENGTH;
     }
 
     // Validate length based on type
-    if (package.header.type == DATA_TYPE && package.header.length > MAX_DATA_LENGTH)
+    if (type == DATA_TYPE && header.length > payloadLength(header))
     {
         return NackReason::INVALID_LENGTH;
     }
-    else if ((package.header.type == NACK_TYPE && package.header.length != 1) ||
-             (package.header.type == ACK_TYPE && package.header.length != 0) ||
-             (package.header.type == RESET_TYPE && package.header.length != 0))
+    else if ((type != DATA_TYPE && header.channel != 0) ||
+             (type == NACK_TYPE && header.length != 1) ||
+             (type == ACK_TYPE && header.length != 0) ||
+             (type == RESET_TYPE && header.length != 0))
     {
         return NackReason::INVALID_LENGTH;
     }
 
-    // Validate CRC
-    const uint16_t calculatedCrc = crc16((uint8_t *)&package.header.packetNumber, CRC_SCOPE_LENGTH);
-    const uint16_t packageCrc = retrieveCRC(package.footer.crc);
+    return NackReason::NO_ERROR;
+}
+
+/**
+ * @brief Validates a complete received packet
+ *
+ * @details The header already passed validateHeader() during reception,
+ * so only what arrives last is left:
+ * 1. Frame markers (0xAA/0x55)
+ * 2. CRC-16 integrity (checksum supplied by the caller, normally
+ *    accumulated byte-by-byte during reception)
+ *
+ * @param package Packet to validate
+ * @param calculatedCrc CRC-16 computed over the packet's CRC scope
+ * @return NackReason Error code (NO_ERROR if valid)
+ */
+CRCPackageInterface::NackReason CRCPackageInterface::validatePackage(const Package &package,
+                                                                     const uint16_t calculatedCrc) const
+{
+    // Check frame markers
+    if (package.header.startByte != START_BYTE || package.footer.stopByte != STOP_BYTE)
+    {
+        return NackReason::INVALID_START_STOP;
+    }
 
-    if (calculatedCrc != packageCrc)
+    // Validate CRC
+    if (calculatedCrc != retrieveCRC(package.footer.crc))
     {
         return NackReason::INVALID_CRC;
     }
@@ -484,319 +823,1472 @@ CRCPackageInterface::NackReason CRCPackageInterface::validatePackage(const Packa
 }
 
 /**
- * @brief Transmits packet over encoded stream
+ * @brief Restarts reception after a rejected header
  *
- * @details Sends complete packet:
- * 1. Serializes to byte array
- * 2. Writes to encoded stream
- * 3. No buffering/queueing
+ * @details The bytes after a false start may hold the real one, so the
+ * header bytes already consumed are searched for 0xAA first. The frame
+ * restarts there with its CRC folded in again; without one the decoder
+ * goes back to WAIT_FOR_START_BYTE.
+ */
+void CRCPackageInterface::resyncIncoming()
+{
+    m_linkStatistic.resyncs++;
+
+    uint8_t *buffer = reinterpret_cast<uint8_t *>(&m_incomingPackage);
+    const uint8_t length = m_incomingFlags.m_incomingDataLength;
+
+    for (uint8_t start = 1; start < length; start++)
+    {
+        if (buffer[start] != START_BYTE)
+        {
+            continue;
+        }
+
+        const uint8_t kept = length - start;
+        memmove(buffer, buffer + start, kept);
+        memset(buffer + kept, 0, HEADER_LENGTH - kept);
+
+        m_incomingCrc = CRC_INITIAL_VALUE;
+        for (uint8_t i = 1; i < kept; i++)
+        {
+            m_incomingCrc = crc16Update(m_incomingCrc, buffer[i]);
+        }
+        m_incomingFlags.m_incomingDataLength = kept;
+        m_incomingTimer.reset();
+        return;
+    }
+
+    resetIncomingState();
+}
+
+/**
+ * @brief Payload bytes carried by a frame
  *
- * @param package Prepared packet to send
+ * @details Bits 4-5 of the type byte select 8 << class bytes.
+ * Only DATA packets use a class other than 0, and only once the RESET
+ * handshake agreed on it, so older peers never see one. Classes beyond
+ * MAX_PAYLOAD_CLASS are reported as 0; validateHeader() rejects them
+ * before any payload byte is read.
+ *
+ * @param header Header of the frame
+ * @return uint8_t Payload size of the frame
  */
-void CRCPackageInterface::sendPackage(const Package &package)
+uint8_t CRCPackageInterface::payloadLength(const PackageHeader &header)
 {
-    getInternalEncodedStream().write(reinterpret_cast<const uint8_t *>(&package), PACKAGE_LENGTH);
+    const uint8_t payloadClass = (header.type >> PAYLOAD_CLASS_SHIFT) & PAYLOAD_CLASS_MASK;
+    return (payloadClass <= MAX_PAYLOAD_CLASS) ? (BASE_DATA_LENGTH << payloadClass) : BASE_DATA_LENGTH;
 }
 
 /**
- * @brief Processes complete received packet
+ * @brief Packet type without the payload size class
  *
- * @details Handles packet based on type:
+ * @param header Header of the frame
+ * @return uint8_t DATA/ACK/NACK/RESET
+ */
+uint8_t CRCPackageInterface::packageType(const PackageHeader &header)
+{
+    return header.type & TYPE_MASK;
+}
+
+/**
+ * @brief Whether a DATA frame carries the ackNumber byte
  *
- * DATA:
- * 1. Validate packet
- * 2. Check sequence number
- * 3. Store payload
- * 4. Send ACK
+ * @details The byte sits between the payload and the footer on the wire.
+ * On ACK frames ACK_FLAG marks the packet number as cumulative instead.
  *
- * ACK/NACK:
- * 1. Verify packet number
- * 2. Queue for outgoing state machine
+ * @param header Header of the frame
+ * @return true if ackNumber follows the payload
+ */
+bool CRCPackageInterface::hasAckNumber(const PackageHeader &header)
+{
+    return packageType(header) == DATA_TYPE && (header.type & ACK_FLAG);
+}
+
+/**
+ * @brief Next sequence number after @p packetNumber
  *
- * RESET:
- * 1. Reset protocol state
- * 2. Send ACK
+ * @details DATA packets are numbered 1..255; 0 is reserved for RESET and
+ * its ACK, so 255 wraps to 1.
  *
- * @return true if processing successful
- * @return false if error occurred
+ * @param packetNumber Current sequence number
+ * @return uint8_t Following sequence number
  */
-bool CRCPackageInterface::processPackage()
+uint8_t CRCPackageInterface::nextPacketNumber(const uint8_t packetNumber)
 {
-    PipedStream &plainStream = getInternalPlainStream();
-    PipedStream &encodedStream = getInternalEncodedStream();
+    return (packetNumber >= MAX_PACKET_NUMBER) ? 1 : packetNumber + 1;
+}
 
-    // Reset detection timer
-    m_resetDetectionTimer.reset();
+/**
+ * @brief Forward distance between two sequence numbers
+ *
+ * @details Counts nextPacketNumber() steps from @p from to @p to, so a
+ * packet just behind @p from yields a distance close to 255.
+ *
+ * @param from Reference sequence number
+ * @param to Sequence number to measure
+ * @return uint8_t Steps from @p from to @p to (0-254)
+ */
+uint8_t CRCPackageInterface::packetDistance(const uint8_t from, const uint8_t to)
+{
+    return (to >= from) ? (to - from) : (MAX_PACKET_NUMBER - (from - to));
+}
 
-    // Validate packet
-    const NackReason validationResult = validatePackage(m_incomingPackage);
+/**
+ * @brief Window slot relative to the oldest unacked packet
+ *
+ * @param offset Slot position (0 = oldest)
+ * @return OutgoingSlot& Slot in the ring
+ */
+CRCPackageInterface::OutgoingSlot &CRCPackageInterface::outgoingSlot(const uint8_t offset)
+{
+    return m_outgoingSlots[(m_outgoingHead + offset) % MAX_WINDOW_SIZE];
+}
 
-    if (validationResult == NackReason::NO_ERROR)
+/**
+ * @brief Finds the window slot that carries a sequence number
+ *
+ * @param packetNumber Sequence number from an ACK/NACK
+ * @return OutgoingSlot* Matching slot, nullptr if not in the window
+ */
+CRCPackageInterface::OutgoingSlot *CRCPackageInterface::findOutgoingSlot(const uint8_t packetNumber)
+{
+    if (packetNumber == 0)
     {
-        if (m_incomingPackage.header.type == DATA_TYPE)
-        {
-            // Check buffer space for response
-            if (PACKAGE_LENGTH > encodedStream.availableForWrite())
-            {
-                TRACE_WARN()
-                    << PGMT(PREFIX_I_STR)
-                    << PGMT(BUFFER_FULL_STR)
-                    << endl;
-                return false;
-            }
-
-            // Process if new packet
-            if (m_incomingPackage.header.packetNumber > m_lastIncomingPacketNumber)
-            {
-                const uint8_t safeLength = min(m_incomingPackage.header.length, MAX_DATA_LENGTH);
+        return nullptr;
+    }
 
-                // Check buffer space for payload
-                if (safeLength > plainStream.availableForWrite())
-                {
-                    TRACE_WARN()
-                        << PGMT(PREFIX_I_STR)
-                        << PGMT(BUFFER_FULL_STR)
-                        << endl;
-                    return false;
-                }
+    const uint8_t offset = packetDistance(m_outgoingPacketNumber, packetNumber);
+    if (offset >= m_outgoingCount)
+    {
+        return nullptr;
+    }
+    return &outgoingSlot(offset);
+}
 
-                // Store payload and update sequence
-                plainStream.write(m_incomingPackage.data, safeLength);
-                m_lastIncomingPacketNumber = m_incomingPackage.header.packetNumber;
-            }
+/**
+ * @brief Releases acked slots from the front of the window
+ *
+ * @details Slots acked out of order stay in ACKNOWLEDGED until every
+ * older slot is acked, then they are all released at once.
+ */
+void CRCPackageInterface::slideOutgoingWindow()
+{
+    while (m_outgoingCount > 0 &&
+           outgoingSlot(0).flags.m_currentState == OutgoingState::ACKNOWLEDGED)
+    {
+        OutgoingSlot &slot = outgoingSlot(0);
+        memset(&slot.package, 0, sizeof(slot.package));
+        slot.flags.m_currentState = OutgoingState::READ_DATA;
+        slot.flags.m_retryCount = 0;
+
+        m_outgoingHead = (m_outgoingHead + 1) % MAX_WINDOW_SIZE;
+        m_outgoingCount--;
+        m_outgoingPacketNumber = nextPacketNumber(m_outgoingPacketNumber);
+    }
+}
 
-            // Send ACK
-            const uint8_t packetNumber = m_incomingPackage.header.packetNumber;
-            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
-            preparePackage(m_incomingPackage, ACK_TYPE, packetNumber);
-            sendPackage(m_incomingPackage);
-        }
-        else if (m_incomingPackage.header.type == RESET_TYPE)
-        {
-            // Handle reset request
-            TRACE_INFO()
-                << PGMT(PREFIX_I_STR)
+/**
+ * @brief Folds a round-trip sample into SRTT/RTTVAR and derives the RTO
+ *
+ * @details Jacobson/Karels in 16-bit integers: SRTT is kept scaled by 8
+ * and RTTVAR by 4, so the 1/8 and 1/4 gains are plain shifts and
+ * RTO = SRTT + 4 * RTTVAR needs no multiply. The first sample seeds
+ * SRTT with the sample and RTTVAR with half of it. Samples are capped
+ * at MAX_RETRANSMIT_TIMEOUT, so the scaled values stay below 32000.
+ *
+ * A fresh sample also undoes any backoff.
+ *
+ * @param sample Time from transmission to ACK (milliseconds)
+ */
+void CRCPackageInterface::updateRoundTrip(uint16_t sample)
+{
+    if (sample == 0)
+    {
+        sample = 1;
+    }
+    else if (sample > MAX_RETRANSMIT_TIMEOUT)
+    {
+        sample = MAX_RETRANSMIT_TIMEOUT;
+    }
+    if (sample > m_linkStatistic.peakRtt)
+    {
+        m_linkStatistic.peakRtt = sample;
+    }
+
+    if (m_smoothedRtt == 0)
+    {
+        m_smoothedRtt = sample << RTT_SHIFT;
+        m_rttVariation = sample << (RTTVAR_SHIFT - 1);
+    }
+    else
+    {
+        int16_t delta = static_cast<int16_t>(sample) - static_cast<int16_t>(m_smoothedRtt >> RTT_SHIFT);
+        m_smoothedRtt += delta;
+        if (delta < 0)
+        {
+            delta = -delta;
+        }
+        m_rttVariation += delta - static_cast<int16_t>(m_rttVariation >> RTTVAR_SHIFT);
+    }
+
+    m_retransmitTimeout = (m_smoothedRtt >> RTT_SHIFT) + m_rttVariation;
+    if (m_retransmitTimeout < MIN_RETRANSMIT_TIMEOUT)
+    {
+        m_retransmitTimeout = MIN_RETRANSMIT_TIMEOUT;
+    }
+    else if (m_retransmitTimeout > MAX_RETRANSMIT_TIMEOUT)
+    {
+        m_retransmitTimeout = MAX_RETRANSMIT_TIMEOUT;
+    }
+}
+
+/**
+ * @brief Forgets the round-trip estimate
+ *
+ * @details A new peer may sit behind a very different link, so the RTO
+ * starts from OUTGOING_DATA_ACK_NACK_TIMEOUT again until it is measured.
+ */
+void CRCPackageInterface::resetRoundTrip()
+{
+    m_smoothedRtt = 0;
+    m_rttVariation = 0;
+    m_retransmitTimeout = OUTGOING_DATA_ACK_NACK_TIMEOUT;
+}
+
+/**
+ * @brief Prints the link statistics to the specified output
+ *
+ * @details Smoothed RTT / RTT variation / retransmit timeout in
+ * milliseconds (the first two read 0 until an ACK has been timed) and
+ * peak RTT, followed by the frame counters and the bytes waiting per lane.
+ *
+ * @param print The Print object to use for output (e.g., Serial)
+ */
+void CRCPackageInterface::printStatistic(Print &print) const
+{
+    print.print(F("CRC RTT:"));
+    print.print(m_smoothedRtt >> RTT_SHIFT);
+    print.print('/');
+    print.print(m_rttVariation >> RTTVAR_SHIFT);
+    print.print('/');
+    print.print(m_retransmitTimeout);
+    print.print(F(" ms, peak "));
+    print.print(m_linkStatistic.peakRtt);
+    print.println(F(" ms"));
+
+    print.print(F("CRC tx/rx:"));
+    print.print(m_linkStatistic.packetsSent);
+    print.print('/');
+    print.println(m_linkStatistic.packetsReceived);
+
+    print.print(F("CRC retry/drop/nack:"));
+    print.print(m_linkStatistic.retries);
+    print.print('/');
+    print.print(m_linkStatistic.maxRetryDrops);
+    print.print('/');
+    print.println(m_linkStatistic.nacksReceived);
+
+    print.print(F("CRC bad crc/frame/type/len/resync:"));
+    for (uint8_t i = 0; i < REJECT_REASON_COUNT; i++)
+    {
+        print.print(m_linkStatistic.rejected[i]);
+        print.print('/');
+    }
+    print.println(m_linkStatistic.resyncs);
+
+    print.print(F("CRC lane ctl/bulk:"));
+    print.print(m_laneDepth[LANE_CONTROL]);
+    print.print('/');
+    print.print(m_laneDepth[LANE_BULK]);
+    print.print(F(" B, peak "));
+    print.print(m_peakLaneDepth[LANE_CONTROL]);
+    print.print('/');
+    print.print(m_peakLaneDepth[LANE_BULK]);
+    print.println(F(" B"));
+}
+
+/**
+ * @brief Prints the link statistics as one comma-separated line
+ *
+ * @details Numbers only, in LinkStatistic order with the current RTT
+ * before peakRtt, so a remote client can parse it cheaply.
+ *
+ * @param print The Print object to use for output
+ */
+void CRCPackageInterface::printCompactStatistic(Print &print) const
+{
+    print.print(m_linkStatistic.packetsSent);
+    print.print(',');
+    print.print(m_linkStatistic.packetsReceived);
+    print.print(',');
+    print.print(m_linkStatistic.retries);
+    print.print(',');
+    print.print(m_linkStatistic.maxRetryDrops);
+    print.print(',');
+    print.print(m_linkStatistic.nacksReceived);
+    for (uint8_t i = 0; i < REJECT_REASON_COUNT; i++)
+    {
+        print.print(',');
+        print.print(m_linkStatistic.rejected[i]);
+    }
+    print.print(',');
+    print.print(m_linkStatistic.resyncs);
+    print.print(',');
+    print.print(m_smoothedRtt >> RTT_SHIFT);
+    print.print(',');
+    print.println(m_linkStatistic.peakRtt);
+}
+
+/**
+ * @brief Counts a frame rejected for @p reason
+ *
+ * @param reason Validation result other than NO_ERROR
+ */
+void CRCPackageInterface::countRejected(const NackReason reason)
+{
+    if (reason >= INVALID_CRC && reason <= INVALID_LENGTH)
+    {
+        m_linkStatistic.rejected[reason - 1]++;
+    }
+}
+
+/**
+ * @brief Marks every window slot up to @p packetNumber acknowledged
+ *
+ * @details A cumulative ACK outside the window is stale (an ACK for a
+ * packet already released, or for 0 before anything arrived) and is
+ * ignored. The newest packet covered is timed if it was sent once only;
+ * older ones waited for the peer's delayed ACK.
+ *
+ * @param packetNumber Last packet the peer delivered in sequence
+ * @return true if any slot was acknowledged
+ */
+bool CRCPackageInterface::acknowledgeUpTo(const uint8_t packetNumber)
+{
+    if (packetNumber == 0)
+    {
+        return false;
+    }
+
+    const uint8_t lastOffset = packetDistance(m_outgoingPacketNumber, packetNumber);
+    if (lastOffset >= m_outgoingCount)
+    {
+        return false;
+    }
+
+    OutgoingSlot &newest = outgoingSlot(lastOffset);
+    if (newest.flags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK && newest.flags.m_retryCount == 0)
+    {
+        updateRoundTrip(newest.timer.elapsed());
+    }
+
+    for (uint8_t offset = 0; offset <= lastOffset; offset++)
+    {
+        outgoingSlot(offset).flags.m_currentState = OutgoingState::ACKNOWLEDGED;
+    }
+    return true;
+}
+
+/**
+ * @brief Gives up on the window after MAX_RETRY_COUNT attempts
+ *
+ * @details Stop-and-wait drops the packet and reuses its number, as it
+ * always has. With a wider window the peer may already hold later
+ * packets, so the link is resynchronised with a RESET instead.
+ */
+void CRCPackageInterface::abandonOutgoingWindow()
+{
+    TRACE_ERROR()
+        << PGMT(PREFIX_O_STR)
+        << PGMT(MAX_RETRY_STR)
+        << endl;
+    m_linkStatistic.maxRetryDrops++;
+
+    resetOutgoingState();
+    if (m_windowSize > 1)
+    {
+        sendResetPacket();
+    }
+}
+
+/**
+ * @brief Applies a peer's window, payload and feature offers
+ *
+ * @details Peers without negotiation leave the capability bytes zero,
+ * which keeps the link in stop-and-wait with 8-byte payloads and
+ * per-packet ACKs. The payload offer is rounded down to the largest class
+ * both ends can buffer; a feature is used only if both ends offer it.
+ *
+ * @param package RESET or RESET-ACK carrying the capability bytes
+ */
+void CRCPackageInterface::applyCapabilities(const Package &package)
+{
+    const uint8_t windowOffer = package.data[CAPABILITY_WINDOW_INDEX];
+    m_windowSize = (windowOffer == 0) ? 1 : min(windowOffer, MAX_WINDOW_SIZE);
+
+    const uint8_t payloadOffer = package.data[CAPABILITY_PAYLOAD_INDEX];
+    m_payloadClass = 0;
+    while (m_payloadClass < MAX_PAYLOAD_CLASS &&
+           (BASE_DATA_LENGTH << (m_payloadClass + 1)) <= payloadOffer)
+    {
+        m_payloadClass++;
+    }
+
+    m_features = package.data[CAPABILITY_FEATURE_INDEX] & SUPPORTED_FEATURES;
+    if (!(m_features & FEATURE_CUMULATIVE_ACK))
+    {
+        // Credit rides on cumulative ACKs only
+        m_features &= ~FEATURE_CREDIT;
+    }
+    resetCredit();
+}
+
+/**
+ * @brief Continues the session after the link came back
+ *
+ * @details Slots up to @p delivered reached the peer before the drop and
+ * are released; the others go out again at once, their retries cleared as
+ * the drop lost them, not the line. Nothing is timed, a round trip over
+ * the drop says nothing about the link.
+ *
+ * @param delivered Last packet the peer delivered in sequence
+ */
+void CRCPackageInterface::resumeSession(const uint8_t delivered)
+{
+    const uint8_t lastOffset = packetDistance(m_outgoingPacketNumber, delivered);
+    const bool covers = delivered != 0 && lastOffset < m_outgoingCount;
+    for (uint8_t offset = 0; offset < m_outgoingCount; offset++)
+    {
+        OutgoingSlot &slot = outgoingSlot(offset);
+        if (covers && offset <= lastOffset)
+        {
+            slot.flags.m_currentState = OutgoingState::ACKNOWLEDGED;
+        }
+        else if (slot.flags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK)
+        {
+            slot.flags.m_retryCount = 0;
+            slot.flags.m_currentState = OutgoingState::SEND_PACKAGE;
+        }
+    }
+    slideOutgoingWindow();
+    m_outOfWindowCount = 0;
+    m_pendingAckCount = 0;
+}
+
+/**
+ * @brief Picks the ID of a new session
+ *
+ * @details The clock only keeps consecutive sessions apart, so a RESET
+ * resent or crossing ours is not mistaken for the session before it.
+ *
+ * @return uint16_t Session ID, never 0 or m_sessionId
+ */
+uint16_t CRCPackageInterface::nextSessionId() const
+{
+    uint16_t session = static_cast<uint16_t>(micros());
+    while (session == 0 || session == m_sessionId)
+    {
+        session++;
+    }
+    return session;
+}
+
+/**
+ * @brief Transmits packet over encoded stream
+ *
+ * @details Sends complete packet:
+ * 1. Writes header and the frame's payload size
+ * 2. Writes ackNumber if the frame carries one, then the footer, so
+ *    unused buffer bytes stay off the air
+ * 3. No buffering/queueing
+ *
+ * @param package Prepared packet to send
+ */
+void CRCPackageInterface::sendPackage(const Package &package)
+{
+    PipedStream &encodedStream = getInternalEncodedStream();
+    m_linkStatistic.packetsSent++;
+    encodedStream.write(reinterpret_cast<const uint8_t *>(&package), HEADER_LENGTH + payloadLength(package.header));
+    if (hasAckNumber(package.header))
+    {
+        encodedStream.write(package.ackNumber);
+    }
+    encodedStream.write(reinterpret_cast<const uint8_t *>(&package.footer), FOOTER_LENGTH);
+}
+
+/**
+ * @brief Processes complete received packet
+ *
+ * @details Handles packet based on type:
+ *
+ * DATA:
+ * 1. Validate packet
+ * 2. Deliver, buffer (inside the window) or drop as duplicate
+ * 3. Send (or delay) the ACK
+ * 4. Queue a piggybacked cumulative ACK for the outgoing state machine
+ *
+ * ACK/NACK:
+ * 1. Queue for outgoing state machine, which matches the window slot
+ *    (ACK_FLAG: every slot up to the packet number)
+ * 2. ACK 0 answers our RESET and carries the peer's window, payload size
+ *    and features
+ *
+ * RESET:
+ * 1. Resume if it asks for our session, else reset protocol state,
+ *    agree on a window and payload size and take its session
+ * 2. Send ACK carrying them, the session and what we delivered
+ *
+ * @return true if processing successful
+ * @return false if error occurred
+ */
+bool CRCPackageInterface::processPackage()
+{
+    PipedStream &encodedStream = getInternalEncodedStream();
+
+    // Reset detection timer
+    m_resetDetectionTimer.reset();
+
+    // Validate packet
+    const NackReason validationResult = validatePackage(m_incomingPackage, m_incomingCrc);
+
+    const uint8_t type = packageType(m_incomingPackage.header);
+
+    if (validationResult == NackReason::NO_ERROR)
+    {
+        if (type == DATA_TYPE)
+        {
+            const uint8_t ackNumber = hasAckNumber(m_incomingPackage.header) ? m_incomingPackage.ackNumber : 0;
+            if (!processDataPackage())
+            {
+                return false;
+            }
+
+            if (ackNumber != 0)
+            {
+                PendingMessage message;
+                message.type = PendingMessageType::CUMULATIVE_ACK_RECEIVED;
+                message.packetNumber = ackNumber;
+                message.nackReason = NackReason::NO_ERROR;
+                m_messageQueue.push(message);
+            }
+        }
+        else if (type == RESET_TYPE)
+        {
+            // Handle reset request
+            TRACE_INFO()
+                << PGMT(PREFIX_I_STR)
                 << PGMT(RESET_NUM_STR)
                 << endl;
 
-            resetPacketNumbering();
+            const uint16_t session = m_incomingPackage.data[SESSION_ID_INDEX] |
+                                     (m_incomingPackage.data[SESSION_ID_INDEX + 1] << 8);
+            const bool resume = (m_incomingPackage.data[SESSION_FLAGS_INDEX] & SESSION_RESUME) &&
+                                session != 0 && session == m_sessionId;
+            if (resume)
+            {
+                // Same window, payload and features as before the drop
+                resumeSession(m_incomingPackage.data[SESSION_DELIVERED_INDEX]);
+            }
+            else
+            {
+                applyCapabilities(m_incomingPackage);
+                resetPacketNumbering();
+                m_sessionId = session;
+            }
+
+            // Send ACK carrying the agreed window, payload size and features
+            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
+            m_incomingPackage.data[CAPABILITY_WINDOW_INDEX] = m_windowSize;
+            m_incomingPackage.data[CAPABILITY_PAYLOAD_INDEX] = BASE_DATA_LENGTH << m_payloadClass;
+            m_incomingPackage.data[CAPABILITY_FEATURE_INDEX] = m_features;
+            m_incomingPackage.data[SESSION_ID_INDEX] = m_sessionId & 0xFF;
+            m_incomingPackage.data[SESSION_ID_INDEX + 1] = m_sessionId >> 8;
+            m_incomingPackage.data[SESSION_FLAGS_INDEX] = resume ? SESSION_RESUME : 0;
+            m_incomingPackage.data[SESSION_DELIVERED_INDEX] = m_lastIncomingPacketNumber;
+            preparePackage(m_incomingPackage, ACK_TYPE, 0);
+            sendPackage(m_incomingPackage);
+        }
+        else if (type == ACK_TYPE &&
+                 m_incomingPackage.header.packetNumber == 0)
+        {
+            // RESET-ACK: the peer's answer to our offer
+            applyCapabilities(m_incomingPackage);
+            if (m_resetAttempts > 0)
+            {
+                // The peer restarted its numbering when it took the RESET;
+                // anything it sent before that has already been delivered
+                m_resetAttempts = 0;
+                m_sessionId = m_incomingPackage.data[SESSION_ID_INDEX] |
+                              (m_incomingPackage.data[SESSION_ID_INDEX + 1] << 8);
+                m_lastIncomingPacketNumber = 0;
+                memset(m_receivedSlots, 0, sizeof(m_receivedSlots));
+                resetOutgoingState();
+            }
+        }
+        else if (type == ACK_TYPE)
+        {
+            if ((m_features & FEATURE_CREDIT) && (m_incomingPackage.header.type & ACK_FLAG))
+            {
+                takeCredit(m_incomingPackage);
+            }
+
+            // Queue ACK
+            PendingMessage message;
+            message.type = (m_incomingPackage.header.type & ACK_FLAG) ? PendingMessageType::CUMULATIVE_ACK_RECEIVED
+                                                                      : PendingMessageType::ACK_RECEIVED;
+            message.packetNumber = m_incomingPackage.header.packetNumber;
+            message.nackReason = NackReason::NO_ERROR;
+            m_messageQueue.push(message);
+        }
+        else if (type == NACK_TYPE &&
+                 m_incomingPackage.header.packetNumber != 0)
+        {
+            // Extract and report NACK reason
+            NackReason nackReason = NackReason::NO_ERROR;
+            if (m_incomingPackage.header.length > 0)
+            {
+                nackReason = static_cast<NackReason>(m_incomingPackage.data[0]);
+                TRACE_ERROR()
+                    << PGMT(PREFIX_O_STR)
+                    << toString(nackReason)
+                    << endl;
+            }
+
+            // Queue NACK
+            m_linkStatistic.nacksReceived++;
+            PendingMessage message;
+            message.type = PendingMessageType::NACK_RECEIVED;
+            message.packetNumber = m_incomingPackage.header.packetNumber;
+            message.nackReason = nackReason;
+            m_messageQueue.push(message);
+        }
+    }
+    else
+    {
+        // Report validation failure
+        TRACE_ERROR()
+            << PGMT(PREFIX_I_STR)
+            << toString(validationResult)
+            << endl;
+
+        // Send NACK if DATA packet
+        if (type == DATA_TYPE)
+        {
+            if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+            {
+                TRACE_WARN()
+                    << PGMT(PREFIX_I_STR)
+                    << PGMT(BUFFER_FULL_STR)
+                    << endl;
+
+                return false;
+            }
+
+            const uint8_t packetNumber = m_incomingPackage.header.packetNumber;
+            const uint8_t reasonData[1] = {validationResult};
+            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
+            preparePackage(m_incomingPackage, NACK_TYPE, packetNumber, 1, reasonData);
+            sendPackage(m_incomingPackage);
+        }
+    }
+
+    // Counted once the frame is consumed - a full stream retries it
+    if (validationResult == NackReason::NO_ERROR)
+    {
+        m_linkStatistic.packetsReceived++;
+    }
+    else
+    {
+        countRejected(validationResult);
+    }
+
+    resetIncomingState();
+    return true;
+}
+
+/**
+ * @brief Handles a validated DATA packet
+ *
+ * @details Classifies the packet by its distance from the next expected
+ * sequence number:
+ * - 0: deliver, then flush any buffered packets now in sequence; with
+ *   cumulative ACKs the ACK is left to flushPendingAck() or the next
+ *   outgoing DATA
+ * - inside our receive window: hold in m_receivedSlots until the gap
+ *   fills (sized by what we can buffer, not by the negotiated window,
+ *   so a lost RESET-ACK only slows the peer down), ACK it at once
+ * - up to MAX_WINDOW_SIZE behind: duplicate, re-acknowledge only (with
+ *   cumulative ACKs, everything delivered so far - the ACK it repeats
+ *   may have covered more than this one packet)
+ * - anything else: ahead of our window, drop without ACK so the
+ *   sender retransmits it later; more than MAX_RETRY_COUNT in a row
+ *   resynchronise the link with a RESET
+ *
+ * @return true if the packet was consumed
+ * @return false if a stream was full and processing must be retried
+ */
+bool CRCPackageInterface::processDataPackage()
+{
+    PipedStream *plainStream = channelStream(m_incomingPackage.header.channel);
+    PipedStream &encodedStream = getInternalEncodedStream();
+
+    // Check buffer space for response
+    if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+    {
+        TRACE_WARN()
+            << PGMT(PREFIX_I_STR)
+            << PGMT(BUFFER_FULL_STR)
+            << endl;
+        return false;
+    }
+
+    const uint8_t packetNumber = m_incomingPackage.header.packetNumber;
+    const uint8_t distance = packetDistance(nextPacketNumber(m_lastIncomingPacketNumber), packetNumber);
+    const uint8_t safeLength = min(m_incomingPackage.header.length, MAX_DATA_LENGTH);
+
+    if (distance == 0)
+    {
+        // Check buffer space for payload
+        if (plainStream != nullptr && safeLength > plainStream->availableForWrite())
+        {
+            TRACE_WARN()
+                << PGMT(PREFIX_I_STR)
+                << PGMT(BUFFER_FULL_STR)
+                << endl;
+            return false;
+        }
+
+        // Store payload (dropped on an unattached channel) and update sequence
+        if (plainStream != nullptr)
+        {
+            plainStream->write(m_incomingPackage.data, safeLength);
+            m_deliveredSinceCredit[m_incomingPackage.header.channel] += safeLength;
+            if (m_incomingPackage.header.channel == 0)
+            {
+                m_plainDeliveryMicros = micros();
+            }
+        }
+        m_lastIncomingPacketNumber = packetNumber;
+        deliverReceivedSlots();
+        m_outOfWindowCount = 0;
+
+        if (m_features & FEATURE_CUMULATIVE_ACK)
+        {
+            // Delay the ACK so one covers several packets
+            if (m_pendingAckCount++ == 0)
+            {
+                m_ackDelayTimer.reset();
+            }
+            return true;
+        }
+    }
+    else if (distance < MAX_WINDOW_SIZE)
+    {
+        // Ahead of a gap - hold it unless already held
+        bool held = false;
+        ReceivedSlot *freeSlot = nullptr;
+        for (uint8_t i = 0; i < RECEIVE_BUFFER_SLOTS; i++)
+        {
+            if (m_receivedSlots[i].packetNumber == packetNumber)
+            {
+                held = true;
+            }
+            else if (freeSlot == nullptr && m_receivedSlots[i].packetNumber == 0)
+            {
+                freeSlot = &m_receivedSlots[i];
+            }
+        }
+
+        if (!held)
+        {
+            if (freeSlot == nullptr)
+            {
+                // Nowhere to keep it - let the sender retry
+                return true;
+            }
+
+            freeSlot->packetNumber = packetNumber;
+            freeSlot->channel = m_incomingPackage.header.channel;
+            freeSlot->length = safeLength;
+            memcpy(freeSlot->data, m_incomingPackage.data, safeLength);
+        }
+    }
+    else if (distance < MAX_PACKET_NUMBER - MAX_WINDOW_SIZE)
+    {
+        // Beyond our window - drop, the sender will retry. A run of these
+        // means the two ends disagree on numbering (a RESET went missing)
+        if (++m_outOfWindowCount > MAX_RETRY_COUNT)
+        {
+            m_outOfWindowCount = 0;
+            sendResetPacket();
+        }
+        return true;
+    }
+    m_outOfWindowCount = 0;
+
+    // Duplicate - repeat the cumulative ACK it may have missed
+    if (distance >= MAX_WINDOW_SIZE &&
+        (m_features & FEATURE_CUMULATIVE_ACK) && m_lastIncomingPacketNumber != 0)
+    {
+        return sendCumulativeAck();
+    }
+
+    // Send ACK
+    memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
+    preparePackage(m_incomingPackage, ACK_TYPE, packetNumber);
+    sendPackage(m_incomingPackage);
+    return true;
+}
+
+/**
+ * @brief Sends the delayed cumulative ACK once it is due
+ *
+ * @details Due when half the negotiated window is waiting for it, so the
+ * sender never stalls on a full window, or when ACK_DELAY_TIMEOUT expired
+ * without outgoing DATA to carry it.
+ */
+void CRCPackageInterface::flushPendingAck()
+{
+    if (m_pendingAckCount == 0)
+    {
+        return;
+    }
+
+    if (m_pendingAckCount < (m_windowSize + 1) / 2 && !m_ackDelayTimer.isReady())
+    {
+        return;
+    }
+
+    sendCumulativeAck();
+}
+
+/**
+ * @brief Writes a stand-alone cumulative ACK for m_lastIncomingPacketNumber
+ *
+ * @return true if sent
+ * @return false if the encoded stream had no room
+ */
+bool CRCPackageInterface::sendCumulativeAck()
+{
+    PipedStream &encodedStream = getInternalEncodedStream();
+
+    if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+    {
+        TRACE_WARN()
+            << PGMT(PREFIX_I_STR)
+            << PGMT(BUFFER_FULL_STR)
+            << endl;
+        return false;
+    }
+
+    Package ackPackage;
+    memset(&ackPackage, 0, sizeof(ackPackage));
+    if (m_features & FEATURE_CREDIT)
+    {
+        // Covered by the CRC although the length stays 0
+        for (uint8_t channel = 0; channel < CHANNEL_COUNT; channel++)
+        {
+            const uint8_t credit = receiveCredit(channel);
+            ackPackage.data[CREDIT_INDEX + channel] = credit;
+            m_advertisedCredit[channel] = credit;
+            m_deliveredSinceCredit[channel] = 0;
+        }
+    }
+    preparePackage(ackPackage, ACK_TYPE | ACK_FLAG, m_lastIncomingPacketNumber);
+    sendPackage(ackPackage);
+    m_pendingAckCount = 0;
+    return true;
+}
+
+/**
+ * @brief Sends a cumulative ACK as window update once credit reopened
+ *
+ * @details The peer's view of a channel is our last advertisement less
+ * what it sent since, which is at least what we delivered since. Below one
+ * payload the peer may be holding data back, so once the stream has room
+ * for a full payload again the reader's progress is advertised, without
+ * waiting for the probe.
+ */
+void CRCPackageInterface::flushCreditUpdate()
+{
+    if (!(m_features & FEATURE_CREDIT) || m_lastIncomingPacketNumber == 0)
+    {
+        return;
+    }
+
+    const uint8_t payloadSize = BASE_DATA_LENGTH << m_payloadClass;
+    for (uint8_t channel = 0; channel < CHANNEL_COUNT; channel++)
+    {
+        const uint8_t advertised = m_advertisedCredit[channel];
+        if (advertised == CREDIT_UNLIMITED)
+        {
+            continue;
+        }
+
+        const uint8_t delivered = m_deliveredSinceCredit[channel];
+        const uint8_t peerView = advertised > delivered ? advertised - delivered : 0;
+        if (peerView < payloadSize && receiveCredit(channel) >= payloadSize)
+        {
+            sendCumulativeAck();
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Room of a channel's plain stream, as advertised to the peer
+ *
+ * @details Packets held ahead of a gap are not subtracted: they were
+ * numbered after the acknowledged packet, so the peer counts them itself.
+ *
+ * @param channel Channel ID
+ * @return uint8_t Bytes, CREDIT_UNLIMITED if no stream is attached
+ */
+uint8_t CRCPackageInterface::receiveCredit(const uint8_t channel)
+{
+    PipedStream *plainStream = channelStream(channel);
+    if (plainStream == nullptr)
+    {
+        return CREDIT_UNLIMITED;
+    }
+
+    const int room = plainStream->availableForWrite();
+    return room >= CREDIT_UNLIMITED ? CREDIT_UNLIMITED : static_cast<uint8_t>(max(room, 0));
+}
+
+/**
+ * @brief Credit the peer granted a channel that we have not used yet
+ *
+ * @param channel Channel ID
+ * @return uint8_t Bytes, CREDIT_UNLIMITED without FEATURE_CREDIT
+ */
+uint8_t CRCPackageInterface::sendCredit(const uint8_t channel) const
+{
+    const uint8_t credit = m_peerCredit[channel];
+    if (!(m_features & FEATURE_CREDIT) || credit == CREDIT_UNLIMITED)
+    {
+        return CREDIT_UNLIMITED;
+    }
+    return credit > m_creditUsed[channel] ? credit - m_creditUsed[channel] : 0;
+}
+
+/**
+ * @brief Takes the credit bytes of a received cumulative ACK
+ *
+ * @details The credit counts from the acknowledged packet, so the
+ * payloads of the window slots numbered after it are still charged
+ * against the new credit.
+ *
+ * @param package The ACK; its packet number is what the credit counts from
+ */
+void CRCPackageInterface::takeCredit(const Package &package)
+{
+    const uint8_t acked = package.header.packetNumber;
+    memset(m_creditUsed, 0, sizeof(m_creditUsed));
+    uint8_t packetNumber = m_outgoingPacketNumber;
+    for (uint8_t offset = 0; offset < m_outgoingCount; offset++)
+    {
+        const uint8_t distance = packetDistance(acked, packetNumber);
+        if (distance != 0 && distance <= MAX_WINDOW_SIZE)
+        {
+            const PackageHeader &header = outgoingSlot(offset).package.header;
+            m_creditUsed[header.channel] += header.length;
+        }
+        packetNumber = nextPacketNumber(packetNumber);
+    }
+
+    memcpy(m_peerCredit, package.data + CREDIT_INDEX, sizeof(m_peerCredit));
+    m_creditProbeTimer.reset();
+}
+
+/**
+ * @brief Forgets credit in both directions, as after a new handshake
+ *
+ * @details Until the first cumulative ACK both ends assume no limit, which
+ * is what a peer without FEATURE_CREDIT gets throughout.
+ */
+void CRCPackageInterface::resetCredit()
+{
+    memset(m_peerCredit, CREDIT_UNLIMITED, sizeof(m_peerCredit));
+    memset(m_creditUsed, 0, sizeof(m_creditUsed));
+    memset(m_advertisedCredit, CREDIT_UNLIMITED, sizeof(m_advertisedCredit));
+    memset(m_deliveredSinceCredit, 0, sizeof(m_deliveredSinceCredit));
+}
+
+/**
+ * @brief Delivers buffered out-of-order payloads that are now in sequence
+ *
+ * @details Stops at the first gap or when the plain stream is full; the
+ * remaining slots are retried on the next loop().
+ */
+void CRCPackageInterface::deliverReceivedSlots()
+{
+    if (MAX_WINDOW_SIZE == 1)
+    {
+        return;
+    }
+
+    uint8_t i = 0;
+    while (i < RECEIVE_BUFFER_SLOTS)
+    {
+        ReceivedSlot &slot = m_receivedSlots[i];
+        if (slot.packetNumber != 0 && slot.packetNumber == nextPacketNumber(m_lastIncomingPacketNumber))
+        {
+            PipedStream *plainStream = channelStream(slot.channel);
+            if (plainStream != nullptr)
+            {
+                if (slot.length > plainStream->availableForWrite())
+                {
+                    return;
+                }
+                plainStream->write(slot.data, slot.length);
+                m_deliveredSinceCredit[slot.channel] += slot.length;
+                if (slot.channel == 0)
+                {
+                    m_plainDeliveryMicros = micros();
+                }
+            }
+            m_lastIncomingPacketNumber = slot.packetNumber;
+            slot.packetNumber = 0;
+
+            // The next one may sit in an earlier slot
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+}
+
+/**
+ * @brief Internal plain stream of a channel
+ *
+ * @param channel Channel ID
+ * @return PipedStream* Stream, nullptr if no pair is attached
+ */
+PipedStream *CRCPackageInterface::channelStream(const uint8_t channel)
+{
+    if (channel == 0)
+    {
+        return &getInternalPlainStream();
+    }
+    if (channel < CHANNEL_COUNT && p_channelPipes[channel - 1] != nullptr)
+    {
+        return &p_channelPipes[channel - 1]->second;
+    }
+    return nullptr;
+}
 
-            // Send ACK
-            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
-            preparePackage(m_incomingPackage, ACK_TYPE, 0);
-            sendPackage(m_incomingPackage);
-        }
-        else if (m_incomingPackage.header.type == ACK_TYPE &&
-                 m_incomingPackage.header.packetNumber == m_outgoingPacketNumber)
+/**
+ * @brief Lane a channel was assigned to with setChannelLane()
+ */
+CRCPackageInterface::Lane CRCPackageInterface::channelLane(const uint8_t channel) const
+{
+    return (m_bulkChannels & (1 << channel)) ? LANE_BULK : LANE_CONTROL;
+}
+
+/**
+ * @brief Whether a control channel has data it may send
+ */
+bool CRCPackageInterface::hasControlData()
+{
+    const uint8_t channelCount = (m_features & FEATURE_CHANNELS) ? CHANNEL_COUNT : 1;
+    for (uint8_t channel = 0; channel < channelCount; channel++)
+    {
+        if (channelLane(channel) != LANE_CONTROL)
         {
-            // Queue ACK
-            PendingMessage message;
-            message.type = PendingMessageType::ACK_RECEIVED;
-            message.packetNumber = m_incomingPackage.header.packetNumber;
-            message.nackReason = NackReason::NO_ERROR;
-            m_messageQueue.push(message);
+            continue;
         }
-        else if (m_incomingPackage.header.type == NACK_TYPE &&
-                 m_incomingPackage.header.packetNumber == m_outgoingPacketNumber)
+        PipedStream *stream = channelStream(channel);
+        if (stream != nullptr && stream->available() > 0 && sendCredit(channel) > 0)
         {
-            // Extract and report NACK reason
-            NackReason nackReason = NackReason::NO_ERROR;
-            if (m_incomingPackage.header.length > 0)
-            {
-                nackReason = static_cast<NackReason>(m_incomingPackage.data[0]);
-                TRACE_ERROR()
-                    << PGMT(PREFIX_O_STR)
-                    << toString(nackReason)
-                    << endl;
-            }
+            return true;
+        }
+    }
+    return false;
+}
 
-            // Queue NACK
-            PendingMessage message;
-            message.type = PendingMessageType::NACK_RECEIVED;
-            message.packetNumber = m_incomingPackage.header.packetNumber;
-            message.nackReason = nackReason;
-            m_messageQueue.push(message);
+/**
+ * @brief Samples the lane depths and their peaks
+ *
+ * @details Counts the bytes waiting in the channels' plain streams, not
+ * those already in the window.
+ */
+void CRCPackageInterface::sampleLaneDepths()
+{
+    memset(m_laneDepth, 0, sizeof(m_laneDepth));
+    for (uint8_t channel = 0; channel < CHANNEL_COUNT; channel++)
+    {
+        PipedStream *stream = channelStream(channel);
+        if (stream != nullptr)
+        {
+            m_laneDepth[channelLane(channel)] += stream->available();
         }
     }
-    else
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
     {
-        // Report validation failure
-        TRACE_ERROR()
-            << PGMT(PREFIX_I_STR)
-            << toString(validationResult)
-            << endl;
-
-        // Send NACK if DATA packet
-        if (m_incomingPackage.header.type == DATA_TYPE)
+        if (m_laneDepth[lane] > m_peakLaneDepth[lane])
         {
-            if (PACKAGE_LENGTH > encodedStream.availableForWrite())
-            {
-                TRACE_WARN()
-                    << PGMT(PREFIX_I_STR)
-                    << PGMT(BUFFER_FULL_STR)
-                    << endl;
+            m_peakLaneDepth[lane] = m_laneDepth[lane];
+        }
+    }
+}
 
-                return false;
-            }
+/**
+ * @brief Picks the channel the next DATA packet is filled from
+ *
+ * @details The control lane first, then the bulk lane, which may not
+ * take the last free window slot (unless the window is 1), so control
+ * data never waits for a slot behind bulk data. Within a lane it starts
+ * at m_nextOutgoingChannel so channels take turns; only channel 0 is
+ * served until the peer agreed to FEATURE_CHANNELS, the others stay
+ * buffered in their pipes meanwhile. A channel out of credit is passed
+ * over, so it cannot hold up the others.
+ *
+ * @param channel Set to the picked channel; with nullptr returned, a
+ * channel whose data waits (for credit first, else for a window slot
+ * bulk may take), or CHANNEL_COUNT if none has data
+ * @return PipedStream* Stream with data waiting and credit, nullptr if none
+ */
+PipedStream *CRCPackageInterface::nextOutgoingStream(uint8_t &channel)
+{
+    const uint8_t channelCount = (m_features & FEATURE_CHANNELS) ? CHANNEL_COUNT : 1;
 
-            const uint8_t packetNumber = m_incomingPackage.header.packetNumber;
-            const uint8_t reasonData[1] = {validationResult};
-            memset(&m_incomingPackage, 0, sizeof(m_incomingPackage));
-            preparePackage(m_incomingPackage, NACK_TYPE, packetNumber, 1, reasonData);
-            sendPackage(m_incomingPackage);
+    uint8_t bulkSlots = 0;
+    for (uint8_t offset = 0; offset < m_outgoingCount; offset++)
+    {
+        if (channelLane(outgoingSlot(offset).package.header.channel) == LANE_BULK)
+        {
+            bulkSlots++;
         }
     }
+    const bool bulkAllowed = m_windowSize == 1 || bulkSlots < m_windowSize - 1;
 
-    resetIncomingState();
-    return true;
+    uint8_t creditWaiting = CHANNEL_COUNT;
+    uint8_t slotWaiting = CHANNEL_COUNT;
+    for (uint8_t lane = 0; lane < LANE_COUNT; lane++)
+    {
+        for (uint8_t i = 0; i < channelCount; i++)
+        {
+            const uint8_t candidate = (m_nextOutgoingChannel + i) % channelCount;
+            if (channelLane(candidate) != lane)
+            {
+                continue;
+            }
+            PipedStream *stream = channelStream(candidate);
+            if (stream == nullptr || stream->available() == 0)
+            {
+                continue;
+            }
+            if (sendCredit(candidate) == 0)
+            {
+                if (creditWaiting == CHANNEL_COUNT)
+                {
+                    creditWaiting = candidate;
+                }
+            }
+            else if (lane == LANE_BULK && !bulkAllowed)
+            {
+                if (slotWaiting == CHANNEL_COUNT)
+                {
+                    slotWaiting = candidate;
+                }
+            }
+            else
+            {
+                channel = candidate;
+                return stream;
+            }
+        }
+    }
+    channel = (creditWaiting != CHANNEL_COUNT) ? creditWaiting : slotWaiting;
+    return nullptr;
 }
 
 /**
  * @brief Handles outgoing state machine
  *
- * @details Processes one state machine iteration:
+ * @details Processes one state machine iteration over the window:
  *
- * READ_DATA:
- * - Collect data until timeout or buffer full
- * - Reset timer on first byte
- * - Move to SEND_PACKAGE when ready
+ * ACK/NACK messages:
+ * - ACK: time the round trip (first transmissions only, Karn's rule),
+ *   mark the matching slot, slide the window past acked slots
+ * - Cumulative ACK: mark every slot up to it, slide the window
+ * - NACK: resend only the matching slot
  *
- * SEND_PACKAGE:
- * - Prepare packet with CRC
+ * SEND_PACKAGE (oldest first):
+ * - Refresh the piggybacked ackNumber, which also covers our pending ACK
  * - Transmit over encoded stream
- * - Move to WAIT_FOR_ACK_OR_NACK
+ * - Move to WAIT_FOR_ACK_OR_NACK, timed out after the current RTO
  *
  * WAIT_FOR_ACK_OR_NACK:
- * - Wait for response with timeout
- * - On ACK: Increment sequence, reset state
- * - On NACK: Retry if attempts remain
- * - On timeout: Retry if attempts remain
+ * - On timeout: Retry if attempts remain, otherwise abandon
+ * - The oldest packet timing out doubles the RTO until a new sample
+ *
+ * READ_DATA (next free slot, while the window has room):
+ * - Take the next channel with data and credit, control lane first,
+ *   round-robin within the lane; bulk data leaves the last slot free
+ * - Collect that channel's data until the coalescing delay expires or
+ *   the buffer is full, at most the peer's credit, which also ends it
+ * - Data left without credit for CREDIT_PROBE_TIMEOUT sends an empty
+ *   DATA, whose ACK brings the credit again should an update be lost
+ * - Reset timer on first byte
+ * - A flushed channel, or a line end on a setLineFlush() channel, ends
+ *   the delay once the packet holds everything written; so does control
+ *   data waiting behind a bulk packet
+ * - Number the packet and move to SEND_PACKAGE when ready
+ *
+ * A window of 1 behaves exactly like the original stop-and-wait.
  *
  * @return true if state changed
  * @return false if no state change
  */
 bool CRCPackageInterface::handleOutgoingState()
 {
-    PipedStream &plainStream = getInternalPlainStream();
     PipedStream &encodedStream = getInternalEncodedStream();
 
-    // Check pending ACK/NACK messages
-    PendingMessage message;
-    if (m_messageQueue.pop(message))
+    // RESET awaiting its ACK - no data until the peer has reset too
+    if (m_resetAttempts > 0)
     {
-        if (message.type == PendingMessageType::ACK_RECEIVED &&
-            message.packetNumber == m_outgoingPacketNumber &&
-            m_outgoingFlags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK)
+        if (!m_outgoingTimer.isReady())
         {
-            // Process ACK - advance sequence and reset state
-            m_outgoingPacketNumber++;
-            if (m_outgoingPacketNumber == 0) // Handle overflow
-            {
-                m_outgoingPacketNumber = 1;
-                m_lastIncomingPacketNumber = 0;
-                TRACE_INFO()
-                    << PGMT(PREFIX_O_STR)
-                    << PGMT(RESET_NUM_STR)
-                    << endl;
-            }
-            resetOutgoingState();
-            return true;
+            return false;
         }
-        else if (message.type == PendingMessageType::NACK_RECEIVED &&
-                 message.packetNumber == m_outgoingPacketNumber &&
-                 m_outgoingFlags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK)
+
+        if (m_resetAttempts > MAX_RETRY_COUNT)
         {
-            // Process NACK - retry if attempts remain
-            m_outgoingFlags.m_retryCount++;
             TRACE_ERROR()
                 << PGMT(PREFIX_O_STR)
-                << PGMT(NACK_STR)
+                << PGMT(MAX_RETRY_STR)
                 << endl;
-            m_outgoingFlags.m_currentState = OutgoingState::SEND_PACKAGE;
+            m_linkStatistic.maxRetryDrops++;
+            m_resetAttempts = 0;
+            resetOutgoingState();
             return true;
         }
+
+        if (!transmitResetPacket())
+        {
+            return false;
+        }
+
+        TRACE_ERROR()
+            << PGMT(PREFIX_O_STR)
+            << PGMT(RETRY_STR)
+            << endl;
+        m_linkStatistic.retries++;
+        m_resetAttempts++;
+        m_outgoingTimer.reset();
+        return true;
     }
 
-    switch (m_outgoingFlags.m_currentState)
+    // Check pending ACK/NACK messages
+    PendingMessage message;
+    if (m_messageQueue.pop(message))
     {
-    case OutgoingState::READ_DATA:
-        if (m_outgoingPackage.header.length == 0)
+        if (message.type == PendingMessageType::CUMULATIVE_ACK_RECEIVED)
         {
-            m_outgoingTimer.reset();
+            if (acknowledgeUpTo(message.packetNumber))
+            {
+                slideOutgoingWindow();
+                return true;
+            }
         }
 
-        // Collect data until full or timeout
-        while (plainStream.available() &&
-               m_outgoingPackage.header.length < MAX_DATA_LENGTH)
+        OutgoingSlot *const slot = findOutgoingSlot(message.packetNumber);
+        if (slot != nullptr && slot->flags.m_currentState == OutgoingState::WAIT_FOR_ACK_OR_NACK)
         {
-            m_outgoingPackage.data[m_outgoingPackage.header.length++] = plainStream.read();
+            if (message.type == PendingMessageType::ACK_RECEIVED)
+            {
+                // Process ACK - release every acked slot at the front
+                if (slot->flags.m_retryCount == 0)
+                {
+                    updateRoundTrip(slot->timer.elapsed());
+                }
+                slot->flags.m_currentState = OutgoingState::ACKNOWLEDGED;
+                slideOutgoingWindow();
+                return true;
+            }
+            else if (message.type == PendingMessageType::NACK_RECEIVED)
+            {
+                TRACE_ERROR()
+                    << PGMT(PREFIX_O_STR)
+                    << PGMT(NACK_STR)
+                    << endl;
+
+                if (slot->flags.m_retryCount >= MAX_RETRY_COUNT)
+                {
+                    abandonOutgoingWindow();
+                    return true;
+                }
+
+                // Process NACK - resend just this packet
+                m_linkStatistic.retries++;
+                slot->flags.m_retryCount++;
+                slot->flags.m_currentState = OutgoingState::SEND_PACKAGE;
+                return true;
+            }
         }
+    }
+
+    // Transmit and time out packets already in the window
+    for (uint8_t offset = 0; offset < m_outgoingCount; offset++)
+    {
+        OutgoingSlot &slot = outgoingSlot(offset);
 
-        // Move to SEND_PACKAGE if data ready
-        if (m_outgoingTimer.isReady() && (m_outgoingPackage.header.length > 0))
+        switch (slot.flags.m_currentState)
         {
-            m_outgoingFlags.m_retryCount = 0;
-            m_outgoingFlags.m_currentState = OutgoingState::SEND_PACKAGE;
+        case OutgoingState::SEND_PACKAGE:
+            // Verify buffer space
+            if (PACKAGE_LENGTH > encodedStream.availableForWrite())
+            {
+                TRACE_WARN()
+                    << PGMT(PREFIX_O_STR)
+                    << PGMT(BUFFER_FULL_STR)
+                    << endl;
+                return false;
+            }
+
+            // A retransmission carries what we have received since
+            if (hasAckNumber(slot.package.header))
+            {
+                slot.package.ackNumber = m_lastIncomingPacketNumber;
+                slot.package.footer.crc = storeCRC(frameCrc(slot.package));
+                m_pendingAckCount = 0;
+            }
+
+            sendPackage(slot.package);
+
+            // Move to wait state
+            slot.flags.m_currentState = OutgoingState::WAIT_FOR_ACK_OR_NACK;
+            slot.timer.setInterval(m_retransmitTimeout);
+            slot.timer.reset();
             return true;
-        }
-        break;
 
-    case OutgoingState::SEND_PACKAGE:
-        // Verify buffer space
-        if (PACKAGE_LENGTH > encodedStream.availableForWrite())
-        {
-            TRACE_WARN()
+        case OutgoingState::WAIT_FOR_ACK_OR_NACK:
+            // Check for timeout
+            if (slot.timer.isReady())
+            {
+                if (slot.flags.m_retryCount >= MAX_RETRY_COUNT)
+                {
+                    abandonOutgoingWindow();
+                }
+                else
+                {
+                    // Back off - the link is slower than estimated or congested
+                    if (offset == 0)
+                    {
+                        m_retransmitTimeout = (m_retransmitTimeout >= MAX_RETRANSMIT_TIMEOUT / 2)
+                                                  ? MAX_RETRANSMIT_TIMEOUT
+                                                  : m_retransmitTimeout * 2;
+                    }
+
+                    // Retry transmission
+                    m_linkStatistic.retries++;
+                    slot.flags.m_retryCount++;
+                    TRACE_ERROR()
+                        << PGMT(PREFIX_O_STR)
+                        << PGMT(RETRY_STR)
+                        << endl;
+                    slot.flags.m_currentState = OutgoingState::SEND_PACKAGE;
+                }
+                return true;
+            }
+            break;
+
+        case OutgoingState::ACKNOWLEDGED:
+            break;
+
+        default:
+            // Invalid state - reset
+            TRACE_ERROR()
                 << PGMT(PREFIX_O_STR)
-                << PGMT(BUFFER_FULL_STR)
+                << PGMT(UNKNOWN_STATE_STR)
                 << endl;
-            return false;
+            resetOutgoingState();
+            return true;
         }
+    }
 
-        // Prepare and send packet
-        preparePackage(m_outgoingPackage, DATA_TYPE, m_outgoingPacketNumber,
-                       m_outgoingPackage.header.length);
-        sendPackage(m_outgoingPackage);
+    // Window full - nothing new may be sent
+    if (m_outgoingCount >= m_windowSize)
+    {
+        return false;
+    }
 
-        // Move to wait state
-        m_outgoingFlags.m_currentState = OutgoingState::WAIT_FOR_ACK_OR_NACK;
-        m_outgoingTimer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+    // READ_DATA on the next free slot
+    OutgoingSlot &slot = outgoingSlot(m_outgoingCount);
+    Package &package = slot.package;
+
+    PipedStream *plainStream;
+    if (package.header.length == 0)
+    {
         m_outgoingTimer.reset();
-        return true;
 
-    case OutgoingState::WAIT_FOR_ACK_OR_NACK:
-        // Check for timeout
-        if (m_outgoingTimer.isReady())
+        // An empty packet takes the next channel with data and credit
+        uint8_t channel = 0;
+        plainStream = nextOutgoingStream(channel);
+        if (plainStream == nullptr)
         {
-            if (m_outgoingFlags.m_retryCount >= MAX_RETRY_COUNT)
+            if (channel == CHANNEL_COUNT)
             {
-                // Max retries reached - reset state
-                TRACE_ERROR()
-                    << PGMT(PREFIX_O_STR)
-                    << PGMT(MAX_RETRY_STR)
-                    << endl;
-                resetOutgoingState();
+                // Everything flushed went out
+                m_flushChannels = 0;
+                return false;
             }
-            else
+
+            // Out of credit - probe with an empty packet now and then;
+            // bulk data held for a window slot just waits
+            if (sendCredit(channel) > 0 || !m_creditProbeTimer.isReady())
             {
-                // Retry transmission
-                m_outgoingFlags.m_retryCount++;
-                TRACE_ERROR()
-                    << PGMT(PREFIX_O_STR)
-                    << PGMT(RETRY_STR)
-                    << endl;
-                m_outgoingFlags.m_currentState = OutgoingState::SEND_PACKAGE;
+                return false;
             }
-            return true;
+            m_creditProbeTimer.reset();
         }
-        break;
+        package.header.channel = channel;
+    }
+    else
+    {
+        plainStream = channelStream(package.header.channel);
+    }
 
-    default:
-        // Invalid state - reset
-        TRACE_ERROR()
-            << PGMT(PREFIX_O_STR)
-            << PGMT(UNKNOWN_STATE_STR)
-            << endl;
-        resetOutgoingState();
+    // Collect data until full or timeout, within the peer's credit
+    const uint8_t payloadSize = min(static_cast<uint8_t>(BASE_DATA_LENGTH << m_payloadClass),
+                                    sendCredit(package.header.channel));
+    if (plainStream != nullptr && package.header.length < payloadSize)
+    {
+        package.header.length += plainStream->readBytes(package.data + package.header.length,
+                                                        payloadSize - package.header.length);
+    }
+
+    // Move to SEND_PACKAGE once the payload is full (a probe is full at
+    // once) or the delay expires; a partial payload has drained the stream,
+    // so a flush may end the delay
+    const uint8_t length = package.header.length;
+    const uint8_t channelBit = 1 << package.header.channel;
+    bool ready = length >= payloadSize;
+    if (!ready && length > 0)
+    {
+        const bool lineEnd = (m_lineFlushChannels & channelBit) && (package.data[length - 1] == '\n');
+        // Control data must not wait behind a bulk packet still filling
+        const bool preempted = channelLane(package.header.channel) == LANE_BULK && hasControlData();
+        ready = (m_flushChannels & channelBit) || lineEnd || preempted || m_outgoingTimer.isReady();
+        m_flushChannels &= ~channelBit;
+    }
+    if (ready)
+    {
+        uint8_t packetNumber = m_outgoingPacketNumber;
+        for (uint8_t i = 0; i < m_outgoingCount; i++)
+        {
+            packetNumber = nextPacketNumber(packetNumber);
+        }
+
+        preparePackage(package, DATA_TYPE, packetNumber, package.header.length);
+        m_creditUsed[package.header.channel] += package.header.length;
+        m_creditProbeTimer.reset();
+        m_nextOutgoingChannel = (package.header.channel + 1) % CHANNEL_COUNT;
+        slot.flags.m_retryCount = 0;
+        slot.flags.m_currentState = OutgoingState::SEND_PACKAGE;
+        m_outgoingCount++;
         return true;
     }
     return false;
@@ -805,7 +2297,8 @@ bool CRCPackageInterface::handleOutgoingState()
 /**
  * @brief Handles incoming state machine
  *
- * @details Processes one state machine iteration:
+ * @details Processes one state machine iteration, consuming every byte
+ * already in the encoded stream until the state changes:
  *
  * WAIT_FOR_START_BYTE:
  * - Discard bytes until 0xAA found
@@ -814,11 +2307,15 @@ bool CRCPackageInterface::handleOutgoingState()
  *
  * READ_INCOMING_DATA:
  * - Collect bytes until complete packet
+ * - Update the running CRC as each scope byte arrives
+ * - Map ackNumber and the footer to their struct fields
+ * - Check the header the moment its last byte arrives; a bad one is
+ *   dropped before its payload and the decoder resyncs on the next 0xAA
  * - Handle timeout if reception stalls
  * - Move to PROCESS_INCOMING_DATA when done
  *
  * PROCESS_INCOMING_DATA:
- * - Validate packet integrity
+ * - Validate stop byte and CRC
  * - Handle based on packet type
  * - Send ACK/NACK as appropriate
  *
@@ -833,21 +2330,19 @@ bool CRCPackageInterface::handleIncomingState()
     switch (m_incomingFlags.m_currentState)
     {
     case IncomingState::WAIT_FOR_START_BYTE:
-        if (encodedStream.available())
+        while (encodedStream.available())
         {
             const uint8_t peekByte = static_cast<uint8_t>(encodedStream.peek());
-            if (peekByte != START_BYTE)
-            {
-                // Discard non-start bytes
-                encodedStream.read();
-            }
-            else
+            if (peekByte == START_BYTE)
             {
                 // Start byte found - begin packet reception
                 m_incomingFlags.m_currentState = IncomingState::READ_INCOMING_DATA;
                 m_incomingTimer.reset();
                 return true;
             }
+
+            // Discard non-start bytes
+            encodedStream.read();
         }
         break;
 
@@ -855,18 +2350,63 @@ bool CRCPackageInterface::handleIncomingState()
         // Check for reception timeout
         if (m_incomingTimer.isReady() && !encodedStream.available())
         {
+            m_linkStatistic.resyncs++;
             resetIncomingState();
             return true;
         }
 
-        // Store next byte
-        buffer[m_incomingFlags.m_incomingDataLength++] = encodedStream.read();
-
-        // Check if packet complete
-        if (m_incomingFlags.m_incomingDataLength == PACKAGE_LENGTH)
+        // Store each byte, folding CRC-scope bytes into the running checksum.
+        // Header and payload land in place; ackNumber and the footer follow
+        // the frame's payload size on the wire but live at fixed offsets in
+        // the struct
+        while (encodedStream.available())
         {
-            m_incomingFlags.m_currentState = IncomingState::PROCESS_INCOMING_DATA;
-            return true;
+            const uint8_t index = m_incomingFlags.m_incomingDataLength;
+            const uint8_t incomingByte = static_cast<uint8_t>(encodedStream.read());
+            const uint8_t payloadEnd = HEADER_LENGTH + payloadLength(m_incomingPackage.header);
+            const uint8_t footerIndex = payloadEnd + (hasAckNumber(m_incomingPackage.header) ? 1 : 0);
+
+            if (index < payloadEnd)
+            {
+                buffer[index] = incomingByte;
+                if (index >= 1)
+                {
+                    m_incomingCrc = crc16Update(m_incomingCrc, incomingByte);
+                }
+            }
+            else if (index < footerIndex)
+            {
+                m_incomingPackage.ackNumber = incomingByte;
+                m_incomingCrc = crc16Update(m_incomingCrc, incomingByte);
+            }
+            else
+            {
+                reinterpret_cast<uint8_t *>(&m_incomingPackage.footer)[index - footerIndex] = incomingByte;
+            }
+            m_incomingFlags.m_incomingDataLength = index + 1;
+
+            // Header complete - reject a bad one before reading its payload
+            if (index == HEADER_LENGTH - 1)
+            {
+                const NackReason headerResult = validateHeader(m_incomingPackage.header);
+                if (headerResult != NackReason::NO_ERROR)
+                {
+                    TRACE_ERROR()
+                        << PGMT(PREFIX_I_STR)
+                        << toString(headerResult)
+                        << endl;
+                    countRejected(headerResult);
+                    resyncIncoming();
+                    return true;
+                }
+            }
+
+            // Check if packet complete
+            if (index + 1 == footerIndex + FOOTER_LENGTH)
+            {
+                m_incomingFlags.m_currentState = IncomingState::PROCESS_INCOMING_DATA;
+                return true;
+            }
         }
         break;
 
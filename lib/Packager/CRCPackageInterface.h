@@ -5,6 +5,34 @@
 #include "SimpleTimer.h"
 #include "FastCircularQueue.h"
 #include "Traceable.h"
+#include <HotPath.h>
+
+/// CRC-16 engine: avr-libc's hand-written _crc_xmodem_update() routine
+#define CRC_PACKAGE_CRC_ASM 0
+/// CRC-16 engine: 16-entry nibble table in flash (32 bytes, two lookups per byte)
+#define CRC_PACKAGE_CRC_NIBBLE_TABLE 1
+/// CRC-16 engine: 256-entry byte table in flash (512 bytes, one lookup per byte)
+#define CRC_PACKAGE_CRC_BYTE_TABLE 2
+
+/// Selected CRC-16 engine (override with -DCRC_PACKAGE_CRC_METHOD=...)
+#ifndef CRC_PACKAGE_CRC_METHOD
+#define CRC_PACKAGE_CRC_METHOD CRC_PACKAGE_CRC_ASM
+#endif
+
+/// Largest sliding window offered in the RESET handshake (1 = stop-and-wait only)
+#ifndef CRC_PACKAGE_MAX_WINDOW
+#define CRC_PACKAGE_MAX_WINDOW 4
+#endif
+
+/// Largest payload offered in the RESET handshake (8, 16 or 32 bytes; sizes every packet buffer)
+#ifndef CRC_PACKAGE_MAX_PAYLOAD
+#define CRC_PACKAGE_MAX_PAYLOAD 16
+#endif
+
+/// Size of each encoded stream buffer (power of two, default: the largest frame rounded up)
+#ifndef CRC_PACKAGE_ENCODED_BUFFER_SIZE
+#define CRC_PACKAGE_ENCODED_BUFFER_SIZE (2 * CRC_PACKAGE_MAX_PAYLOAD)
+#endif
 /**
  * @file CRCPackageInterface.h
  * @brief Reliable packet-based communication protocol with CRC-16 validation
@@ -14,10 +42,11 @@
  * @details Implements a robust communication protocol for reliable data exchange between
  * microcontrollers and external devices. Key features:
  * - CRC-16 error detection for data integrity
- * - 8-byte packet payload with minimal overhead
+ * - 8-byte packet payload, 16/32 bytes when both ends negotiate it
  * - Automatic retransmission with ACK/NACK
  * - Bidirectional flow control
  * - Connection state synchronization
+ * - Up to four logical channels multiplexed over the one link
  * - Flash memory optimization for embedded systems
  */
 
@@ -28,16 +57,39 @@
  * @details Provides a complete communication stack with the following features:
  *
  * Protocol Structure:
- * - Fixed 15-byte packet format (4B header + 8B payload + 3B footer)
+ * - 15-byte packet format (4B header + 8B payload + 3B footer)
+ * - DATA payload widened to 16/32 bytes by the RESET handshake
  * - CRC-16-CCITT error detection (polynomial: 0x1021)
  * - Start/stop byte framing (0xAA/0x55)
  *
  * Reliability Features:
  * - Automatic packet acknowledgment (ACK/NACK)
+ * - Retransmit timeout adapted to the measured round-trip time,
+ *   doubled on every expiry
  * - Configurable retry mechanism
  * - Sequence number tracking
  * - Connection state monitoring
  *
+ * Acknowledgments:
+ * - Cumulative ACKs (one ACK covers every packet delivered in sequence)
+ * - Piggybacked on outgoing DATA, otherwise delayed and coalesced
+ * - Both negotiated on RESET, per-packet ACKs otherwise
+ *
+ * Channels:
+ * - DATA carries a 2-bit channel ID next to its length
+ * - Channel 0 is the constructor's stream pair, others via attachChannel()
+ * - Outgoing channels served round-robin, one channel per packet
+ * - Control lane channels ahead of bulk ones, see setChannelLane()
+ * - Partial payloads coalesced for setCoalesceDelay(), or until flush()
+ *   or a line end on a setLineFlush() channel
+ * - Negotiated on RESET, channel 0 only against peers without it
+ *
+ * Window Mode:
+ * - Up to CRC_PACKAGE_MAX_WINDOW packets in flight, negotiated on RESET
+ * - Selective retransmit of the NACKed/timed-out packet only
+ * - Out-of-order packets buffered and delivered in sequence
+ * - Falls back to stop-and-wait (window 1) against peers without it
+ *
  * Performance Optimizations:
  * - Zero-copy buffer management
  * - Interrupt-safe operation
@@ -53,7 +105,9 @@
  * @note Designed for single-threaded environments with interrupt safety
  * @note All packet operations are non-blocking
  */
-class CRCPackageInterface : public PackageInterface, public Traceable
+class CRCPackageInterface : private PackageInterfaceBuffers<CRC_PACKAGE_ENCODED_BUFFER_SIZE>,
+                            public PackageInterface,
+                            public Traceable
 {
 public:
     /**
@@ -74,6 +128,47 @@ public:
         UNKNOWN_ERROR = 0xFF       ///< Unclassified protocol error
     };
 
+    /// Logical channels a DATA packet can be addressed to
+    static constexpr uint8_t CHANNEL_COUNT = 4;
+
+    /**
+     * @enum Lane
+     * @brief Priority classes of outgoing channel data
+     *
+     * @details Control channels are served before bulk channels, and bulk
+     * data never takes the last free window slot, so a control packet gets
+     * a slot as soon as its data is written. Within a lane the channels
+     * take turns as before.
+     */
+    enum Lane : uint8_t
+    {
+        LANE_CONTROL = 0, ///< Commands and their replies, the default of every channel
+        LANE_BULK = 1,    ///< Streams that may wait, such as telemetry
+        LANE_COUNT
+    };
+
+    /// Rejected-frame counters, indexed by NackReason - 1 (INVALID_CRC..INVALID_LENGTH)
+    static constexpr uint8_t REJECT_REASON_COUNT = INVALID_LENGTH;
+
+    /**
+     * @struct LinkStatistic
+     * @brief Link-quality counters since power-up
+     *
+     * @details Counted alongside the TRACE_* messages, so the link can be
+     * watched without text tracing. Counters wrap at 65535.
+     */
+    struct __attribute__((packed)) LinkStatistic
+    {
+        uint16_t packetsSent;                   ///< Frames written (DATA, ACK, NACK, RESET, retransmissions)
+        uint16_t packetsReceived;               ///< Valid frames received
+        uint16_t retries;                       ///< Retransmissions (timeout or NACK) and repeated RESETs
+        uint16_t maxRetryDrops;                 ///< Windows or RESETs given up after MAX_RETRY_COUNT
+        uint16_t nacksReceived;                 ///< NACKs from the peer
+        uint16_t rejected[REJECT_REASON_COUNT]; ///< Frames we rejected, by NackReason
+        uint16_t resyncs;                       ///< Frame sync lost (header rejected or reception timed out)
+        uint16_t peakRtt;                       ///< Longest round-trip sample (milliseconds)
+    };
+
     /**
      * @struct PackageHeader
      * @brief Packet framing and control information
@@ -82,16 +177,18 @@ public:
      * - Frame start marker (1B)
      * - Sequence number for ordering (1B)
      * - Packet type identifier (1B)
-     * - Payload length indicator (1B)
+     * - Payload length (bits 0-5) and channel ID (bits 6-7) (1B)
      *
-     * Memory layout is guaranteed by packed attribute for cross-platform compatibility.
+     * Memory layout is guaranteed by packed attribute for cross-platform compatibility;
+     * GCC allocates the bit-fields from the least significant bit.
      */
     struct __attribute__((packed)) PackageHeader
     {
         uint8_t startByte;    ///< Frame start marker (constant: 0xAA)
         uint8_t packetNumber; ///< Sequence number (1-255, 0 reserved)
-        uint8_t type;         ///< Packet type (DATA/ACK/NACK/RESET)
-        uint8_t length;       ///< Payload length (0-8 bytes)
+        uint8_t type;         ///< Packet type (DATA/ACK/NACK/RESET) | payload size class << 4 | ACK_FLAG
+        uint8_t length : 6;   ///< Payload length (0 to the frame's payload size)
+        uint8_t channel : 2;  ///< Channel of a DATA payload (0 on every other type)
     };
 
     /**
@@ -110,8 +207,13 @@ public:
         uint8_t stopByte; ///< Frame end marker (constant: 0x55)
     };
 
+    /** @brief Payload size of every control packet and of DATA before negotiation */
+    static constexpr uint8_t BASE_DATA_LENGTH = 8;
+
     /** @brief Maximum allowed payload size per packet */
-    static constexpr uint8_t MAX_DATA_LENGTH = 8;
+    static constexpr uint8_t MAX_DATA_LENGTH = CRC_PACKAGE_MAX_PAYLOAD;
+    static_assert(MAX_DATA_LENGTH == 8 || MAX_DATA_LENGTH == 16 || MAX_DATA_LENGTH == 32,
+                  "CRC_PACKAGE_MAX_PAYLOAD must be 8, 16 or 32");
 
     /**
      * @struct Package
@@ -119,21 +221,25 @@ public:
      *
      * @details Represents a complete protocol packet with:
      * - 4-byte header (framing, control)
-     * - 8-byte payload (data)
+     * - Payload buffer sized for the largest payload
      * - 3-byte footer (integrity check)
      *
-     * Total packet size is fixed at 15 bytes for predictable behavior.
+     * On the wire the footer follows the frame's payload size (8 bytes
+     * unless negotiated, see sendPackage()), so a 15-byte frame is still
+     * a 15-byte frame whatever MAX_DATA_LENGTH is.
      * Memory layout is guaranteed by packed attribute for cross-platform compatibility.
      */
     struct __attribute__((packed)) Package
     {
         PackageHeader header;          ///< Packet control information (4B)
-        uint8_t data[MAX_DATA_LENGTH]; ///< Payload buffer (8B)
+        uint8_t data[MAX_DATA_LENGTH]; ///< Payload buffer
+        uint8_t ackNumber;             ///< Piggybacked cumulative ACK (on the wire only with ACK_FLAG)
         PackageFooter footer;          ///< Integrity verification (3B)
     };
 
-    /** @brief Total packet size including header, payload, and footer */
+    /** @brief Largest packet size including header, payload, and footer */
     static constexpr uint8_t PACKAGE_LENGTH = sizeof(Package);
+    static_assert(PACKAGE_LENGTH <= CRC_PACKAGE_ENCODED_BUFFER_SIZE, "Encoded buffers must hold a whole frame");
 
     /**
      * @brief Constructs a new CRC package interface
@@ -145,9 +251,8 @@ public:
      * - Timers for timeout management
      *
      * @param pipedStreamPair Bidirectional stream for raw/encoded data
-     * @param encodedBufferSize Size of encoded data buffer (default: PACKAGE_LENGTH)
      */
-    explicit CRCPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize = PACKAGE_LENGTH);
+    explicit CRCPackageInterface(PipedStreamPair &pipedStreamPair);
 
     /**
      * @brief Destructor
@@ -184,6 +289,138 @@ public:
      */
     void sendResetPacket();
 
+    /**
+     * @brief Routes channel @p channel to its own stream pair
+     *
+     * @details Channel 0 is always the pair given to the constructor. Data
+     * written to the plain stream of @p pipedStreamPair is sent on
+     * @p channel, DATA received on it is delivered there. DATA for a
+     * channel without a pair is acknowledged and dropped.
+     *
+     * @param channel Channel ID (1 to CHANNEL_COUNT - 1)
+     * @param pipedStreamPair Bidirectional stream for the channel's plain data
+     */
+    void attachChannel(const uint8_t channel, PipedStreamPair &pipedStreamPair);
+
+    /**
+     * @brief Tells the interface whether the link below carries frames
+     *
+     * @details While the link is down nothing is sent and nothing times
+     * out: the window, the packet numbers and the received slots are kept
+     * for a peer that resumes the session (see processPackage()). A link
+     * down for SESSION_RESUME_TIMEOUT drops the session, as an idle link
+     * resets its numbering. Coming back up restarts the retransmit timers,
+     * so the time spent down does not count against MAX_RETRY_COUNT.
+     * Without calls the link counts as up.
+     *
+     * @param connected true once the link is back, false when it dropped
+     */
+    void setConnected(const bool connected);
+
+    /**
+     * @brief Sets how long a partial payload waits for more data
+     *
+     * @details A packet goes out once its payload is full; data that does
+     * not fill it waits for this long after its first byte, so replies
+     * printed in pieces share packets and ACK round trips. flush() and
+     * setLineFlush() end the wait early.
+     *
+     * @param delay Coalescing delay in ms, 0 sends whatever is there at once
+     *              (default OUTGOING_DATA_READ_TIMEOUT)
+     */
+    void setCoalesceDelay(const uint16_t delay);
+
+    /**
+     * @brief Sends the data written to a channel without the coalescing delay
+     *
+     * @details The partial payload that ends the data written so far goes
+     * out as soon as the window has room for it; full payloads are not
+     * held anyway.
+     *
+     * @param channel Channel ID (0 to CHANNEL_COUNT - 1)
+     */
+    void flush(const uint8_t channel);
+
+    /**
+     * @brief Makes a line end flush a channel
+     *
+     * @details For text channels: a partial payload that ends with '\n'
+     * and takes everything written so far goes out at once. A line
+     * followed by more data still shares its packet.
+     *
+     * @param channel Channel ID (0 to CHANNEL_COUNT - 1)
+     * @param enabled true to flush on line ends (default off)
+     */
+    void setLineFlush(const uint8_t channel, const bool enabled);
+
+    /**
+     * @brief Assigns a channel to a priority lane
+     *
+     * @param channel Channel ID (0 to CHANNEL_COUNT - 1)
+     * @param lane LANE_CONTROL (default) or LANE_BULK
+     */
+    void setChannelLane(const uint8_t channel, const Lane lane);
+
+    /**
+     * @brief Bytes waiting in the channels of a lane, as of the last loop()
+     *
+     * @param lane The lane
+     */
+    uint16_t getLaneDepth(const Lane lane) const { return m_laneDepth[lane]; }
+
+    /**
+     * @brief Most bytes seen waiting in the channels of a lane since power-up
+     *
+     * @param lane The lane
+     */
+    uint16_t getPeakLaneDepth(const Lane lane) const { return m_peakLaneDepth[lane]; }
+
+    /**
+     * @brief Session agreed in the last RESET handshake, 0 for none
+     */
+    uint16_t getSessionId() const { return m_sessionId; }
+
+    /**
+     * @brief Link-quality counters since power-up
+     */
+    const LinkStatistic &getLinkStatistic() const { return m_linkStatistic; }
+
+    /**
+     * @brief micros() when the latest payload reached the plain stream (channel 0), 0 before the first
+     */
+    uint32_t getPlainDeliveryMicros() const { return m_plainDeliveryMicros; }
+
+    /**
+     * @brief Current state of the incoming state machine (IncomingState)
+     */
+    uint8_t getIncomingState() const { return m_incomingFlags.m_currentState; }
+
+    /**
+     * @brief Outgoing window slots sent or queued for sending
+     */
+    uint8_t getOutgoingCount() const { return m_outgoingCount; }
+
+    /**
+     * @brief Prints the link statistics to the specified output
+     *
+     * @details Lines in the style of Statistic::print(); the first is
+     * smoothed RTT / RTT variation / retransmit timeout, in milliseconds.
+     *
+     * @param print The Print object to use for output (e.g., Serial)
+     */
+    void printStatistic(Print &print) const;
+
+    /**
+     * @brief Prints the link statistics as one comma-separated line
+     *
+     * @details For remote queries: packetsSent, packetsReceived, retries,
+     * maxRetryDrops, nacksReceived, rejected (CRC, start/stop, type,
+     * length), resyncs, current RTT, peakRtt.
+     *
+     * @param print The Print object to use for output
+     */
+    void printCompactStatistic(Print &print) const;
+
 private:
     // Protocol Constants
     static constexpr uint8_t START_BYTE = 0xAA; ///< Packet frame start marker
@@ -195,8 +432,66 @@ private:
     static constexpr uint8_t NACK_TYPE = 2;  ///< Negative acknowledgment
     static constexpr uint8_t RESET_TYPE = 3; ///< Connection reset request
 
+    // Type Byte Layout
+    static constexpr uint8_t TYPE_MASK = 0x0F;          ///< Packet type bits
+    static constexpr uint8_t PAYLOAD_CLASS_SHIFT = 4;   ///< Payload size class: BASE_DATA_LENGTH << class
+    static constexpr uint8_t PAYLOAD_CLASS_MASK = 0x03; ///< Payload size class bits (after the shift)
+    static constexpr uint8_t ACK_FLAG = 0x40;           ///< Cumulative ACK: in ackNumber on DATA, in packetNumber on ACK
+    static constexpr uint8_t MAX_PAYLOAD_CLASS = MAX_DATA_LENGTH == 32 ? 2 : (MAX_DATA_LENGTH == 16 ? 1 : 0); ///< Class of MAX_DATA_LENGTH
+
+    // Sliding Window Parameters
+    static constexpr uint8_t MAX_WINDOW_SIZE = CRC_PACKAGE_MAX_WINDOW;                           ///< Largest window this build supports
+    static constexpr uint8_t RECEIVE_BUFFER_SLOTS = MAX_WINDOW_SIZE > 1 ? MAX_WINDOW_SIZE - 1 : 1; ///< Out-of-order packets held by the receiver
+    static constexpr uint8_t MAX_PACKET_NUMBER = 255;                                            ///< Sequence numbers run 1..255, 0 is reserved for RESET
+    static_assert(MAX_WINDOW_SIZE >= 1 && MAX_WINDOW_SIZE <= BASE_DATA_LENGTH, "CRC_PACKAGE_MAX_WINDOW must be 1..8");
+
+    /**
+     * @brief Capability bytes of RESET and RESET-ACK packets
+     *
+     * @details Carried in the payload while header.length stays 0, so peers
+     * that predate negotiation still accept the packet and simply ignore
+     * them (the CRC covers the whole payload). A zero offer means window 1
+     * and BASE_DATA_LENGTH payloads.
+     */
+    static constexpr uint8_t CAPABILITY_WINDOW_INDEX = 0;  ///< data[] index of the window size offer
+    static constexpr uint8_t CAPABILITY_PAYLOAD_INDEX = 1; ///< data[] index of the payload size offer (bytes)
+    static constexpr uint8_t CAPABILITY_FEATURE_INDEX = 2; ///< data[] index of the FEATURE_* bits
+    static constexpr uint8_t FEATURE_CUMULATIVE_ACK = 0x01; ///< Cumulative, piggybacked and delayed ACKs
+    static constexpr uint8_t FEATURE_CHANNELS = 0x02;       ///< DATA on channels other than 0
+    static constexpr uint8_t FEATURE_CREDIT = 0x04;         ///< Receive credit on cumulative ACKs, needs FEATURE_CUMULATIVE_ACK
+    static constexpr uint8_t SUPPORTED_FEATURES = FEATURE_CUMULATIVE_ACK | FEATURE_CHANNELS | FEATURE_CREDIT; ///< Offered on RESET
+
+    /**
+     * @brief Credit bytes of cumulative ACK packets
+     *
+     * @details With FEATURE_CREDIT a cumulative ACK carries, per channel,
+     * the bytes its plain stream can still take beyond the acknowledged
+     * packet, carried like the capability bytes. The sender counts the
+     * payloads it numbered after that packet against it and holds a
+     * channel's data once the credit is used up, so a slow reader no longer
+     * turns into drops and retries. CREDIT_UNLIMITED means no limit.
+     */
+    static constexpr uint8_t CREDIT_INDEX = 0;       ///< data[] index of channel 0's credit
+    static constexpr uint8_t CREDIT_UNLIMITED = 255; ///< Credit of a channel with room to spare or no stream attached
+    static_assert(CREDIT_INDEX + CHANNEL_COUNT <= BASE_DATA_LENGTH, "Credit bytes must fit an ACK payload");
+
+    /**
+     * @brief Session bytes of RESET and RESET-ACK packets
+     *
+     * @details Follow the capability bytes the same way, zero from peers
+     * that predate sessions, which never resume. A RESET names the session
+     * it starts, or with SESSION_RESUME the one it wants back together with
+     * the last packet it delivered in sequence; the RESET-ACK echoes the
+     * session in force, SESSION_RESUME if it was resumed, and the
+     * responder's last packet delivered in sequence.
+     */
+    static constexpr uint8_t SESSION_ID_INDEX = 3;        ///< data[] index of the session ID, 16 bits little-endian
+    static constexpr uint8_t SESSION_FLAGS_INDEX = 5;     ///< data[] index of the SESSION_* bits
+    static constexpr uint8_t SESSION_DELIVERED_INDEX = 6; ///< data[] index of the last packet delivered in sequence
+    static constexpr uint8_t SESSION_RESUME = 0x01;       ///< RESET: resume the session; RESET-ACK: resumed
+
     // Protocol Parameters
-    static constexpr uint8_t MAX_PENDING_MESSAGES = 4;              ///< ACK/NACK queue size
+    static constexpr uint8_t MAX_PENDING_MESSAGES = MAX_WINDOW_SIZE * 2 > 4 ? MAX_WINDOW_SIZE * 2 : 4; ///< ACK/NACK queue size
     static constexpr uint8_t MAX_RETRY_COUNT = 5;                   ///< Max retransmission attempts
     static constexpr uint8_t MAX_REPLAY_COUNT = PACKAGE_LENGTH + 2; ///< Max state transitions per loop
 
@@ -209,9 +504,10 @@ private:
      */
     enum class PendingMessageType : uint8_t
     {
-        NONE = 0,     ///< No pending message
-        ACK_RECEIVED, ///< Positive acknowledgment received
-        NACK_RECEIVED ///< Negative acknowledgment received
+        NONE = 0,                ///< No pending message
+        ACK_RECEIVED,            ///< Positive acknowledgment received
+        NACK_RECEIVED,           ///< Negative acknowledgment received
+        CUMULATIVE_ACK_RECEIVED  ///< Every packet up to packetNumber acknowledged
     };
 
     /**
@@ -249,10 +545,17 @@ private:
     static const char RESET_NUM_STR[] PROGMEM;          ///< Sequence number reset
 
     // Protocol Timeouts (milliseconds)
-    static constexpr uint16_t OUTGOING_DATA_READ_TIMEOUT = 100;     ///< Max time to collect outgoing data
+    static constexpr uint16_t OUTGOING_DATA_READ_TIMEOUT = 100;     ///< Default max time to collect outgoing data
     static constexpr uint16_t OUTGOING_DATA_ACK_NACK_TIMEOUT = 500; ///< Max time to wait for ACK/NACK
     static constexpr uint16_t INCOMING_DATA_WAIT_TIMEOUT = 500;     ///< Max time to receive complete packet
+    static constexpr uint16_t ACK_DELAY_TIMEOUT = 120;              ///< Max time a cumulative ACK waits for DATA to ride on
+    static constexpr uint16_t CREDIT_PROBE_TIMEOUT = 500;           ///< Time data waits for credit before an empty DATA asks again
+    static constexpr uint16_t MIN_RETRANSMIT_TIMEOUT = 150;         ///< RTO floor, above ACK_DELAY_TIMEOUT
+    static constexpr uint16_t MAX_RETRANSMIT_TIMEOUT = 4000;        ///< RTO ceiling, also caps backoff and samples
+    static constexpr uint8_t RTT_SHIFT = 3;                         ///< SRTT gain 1/8, kept scaled by 8
+    static constexpr uint8_t RTTVAR_SHIFT = 2;                      ///< RTTVAR gain 1/4, kept scaled by 4
     static constexpr uint16_t RESET_DETECTION_TIMEOUT = 10000;      ///< Connection timeout threshold
+    static constexpr uint16_t SESSION_RESUME_TIMEOUT = 60000;       ///< Time a session waits for a dropped link to come back
 
     // Packet Structure Constants
     static constexpr uint8_t HEADER_LENGTH = sizeof(PackageHeader); ///< Header size (4B)
@@ -262,25 +565,27 @@ private:
      * @brief CRC calculation scope
      * @details CRC-16 is computed over:
      * - Header fields after startByte
-     * - Complete payload
-     * Total: packetNumber + type + length + data (11 bytes)
+     * - Complete payload of the frame's size class
+     * Total: packetNumber + type + length + data (11 bytes for 8-byte payloads)
      */
-    static constexpr uint8_t CRC_SCOPE_LENGTH = HEADER_LENGTH - 1 + MAX_DATA_LENGTH;
+    static constexpr uint8_t CRC_HEADER_SCOPE_LENGTH = HEADER_LENGTH - 1;
 
     /**
      * @enum OutgoingState
      * @brief State machine for outgoing packets
      *
-     * @details Controls the transmission sequence:
+     * @details Controls the transmission sequence of each window slot:
      * 1. READ_DATA: Collect data until timeout or buffer full
      * 2. SEND_PACKAGE: Transmit packet with CRC
      * 3. WAIT_FOR_ACK_OR_NACK: Wait for response, retry if needed
+     * 4. ACKNOWLEDGED: Acked, released once every older slot is acked too
      */
     enum OutgoingState : uint8_t
     {
-        READ_DATA = 0,       ///< Collecting outgoing data
-        SEND_PACKAGE,        ///< Transmitting packet
-        WAIT_FOR_ACK_OR_NACK ///< Awaiting acknowledgment
+        READ_DATA = 0,        ///< Collecting outgoing data
+        SEND_PACKAGE,         ///< Transmitting packet
+        WAIT_FOR_ACK_OR_NACK, ///< Awaiting acknowledgment
+        ACKNOWLEDGED          ///< Acked ahead of an older slot
     };
 
     /**
@@ -289,8 +594,8 @@ private:
      *
      * @details Controls the reception sequence:
      * 1. WAIT_FOR_START_BYTE: Frame synchronization
-     * 2. READ_INCOMING_DATA: Receive complete packet
-     * 3. PROCESS_INCOMING_DATA: Validate and handle packet
+     * 2. READ_INCOMING_DATA: Receive complete packet, header checked on arrival
+     * 3. PROCESS_INCOMING_DATA: Validate stop byte and CRC, handle packet
      */
     enum IncomingState : uint8_t
     {
@@ -321,16 +626,43 @@ private:
      *
      * @details Bit-field structure containing:
      * - Current state (2 bits, 0-3)
-     * - Received data length (5 bits, 0-31)
+     * - Received data length (6 bits, 0-63)
      *
      * Memory layout is guaranteed by packed attribute.
      */
     struct __attribute__((packed)) IncomingFlags
     {
         uint8_t m_currentState : 2;       ///< Current state (0-3)
-        uint8_t m_incomingDataLength : 5; ///< Bytes received (0-31)
+        uint8_t m_incomingDataLength : 6; ///< Bytes received (0-63)
+    };
+    static_assert(PACKAGE_LENGTH < 64, "IncomingFlags::m_incomingDataLength is 6 bits");
+
+    /**
+     * @struct OutgoingSlot
+     * @brief One packet of the outgoing window
+     */
+    struct OutgoingSlot
+    {
+        Package package;                        ///< Packet as sent (kept for retransmission)
+        SimpleTimer<uint16_t, LoopClock> timer; ///< ACK/NACK timeout
+        OutgoingFlags flags;                    ///< Retry counter and slot state
     };
 
+    /**
+     * @struct ReceivedSlot
+     * @brief Out-of-order payload waiting for the gap before it to fill
+     */
+    struct ReceivedSlot
+    {
+        uint8_t packetNumber;          ///< Sequence number (0 = slot free)
+        uint8_t channel;               ///< Channel the payload is delivered to
+        uint8_t length;                ///< Payload length
+        uint8_t data[MAX_DATA_LENGTH]; ///< Payload bytes
+    };
+
+    /// Initial CRC-16 register value
+    static constexpr uint16_t CRC_INITIAL_VALUE = 0xFFFF;
+
     /**
      * @brief Handles outgoing state machine
      *
@@ -365,8 +697,10 @@ private:
      * 2. Clears message queues
      * 3. Resets state machines
      * 4. Resets timers
+     *
+     * @return true if there was state to reset
      */
-    void resetPacketNumbering();
+    bool resetPacketNumbering();
 
     /**
      * @brief Calculates CRC-16-CCITT checksum
@@ -380,27 +714,282 @@ private:
      * @param length Number of bytes to process
      * @return uint16_t Calculated CRC-16 value
      */
-    static uint16_t crc16(const uint8_t *const data, const uint8_t length);
+    HOT_PATH static uint16_t crc16(const uint8_t *const data, const uint8_t length);
+
+    /**
+     * @brief Folds one byte into a running CRC-16-CCITT value
+     *
+     * @details Uses the engine selected by CRC_PACKAGE_CRC_METHOD. Lets the
+     * receiver checksum each byte as it arrives, so no pass over the packet
+     * is needed once the stop byte is in.
+     *
+     * @param crc Running CRC value
+     * @param data Next input byte
+     * @return uint16_t Updated CRC value
+     */
+    HOT_PATH static uint16_t crc16Update(uint16_t crc, const uint8_t data);
+
+    /**
+     * @brief CRC-16 over a frame's CRC scope
+     *
+     * @details Header from the packet number on, the frame's payload size
+     * and ackNumber when the frame carries it.
+     *
+     * @param package Packet to checksum
+     * @return uint16_t Calculated CRC-16 value
+     */
+    static uint16_t frameCrc(const Package &package);
+
+    /**
+     * @brief Validates a received header as soon as its last byte arrives
+     *
+     * @details Packet type, payload class and length constraints, so a
+     * corrupted frame is dropped before its payload is read.
+     *
+     * @param header Header of the frame being received
+     * @return NackReason Error code (NO_ERROR if valid)
+     */
+    static NackReason validateHeader(const PackageHeader &header);
 
     /**
-     * @brief Validates received packet
+     * @brief Validates a complete received packet
      *
-     * @details Performs comprehensive packet validation:
+     * @details What validateHeader() could not check yet:
      * 1. Frame markers (start/stop bytes)
-     * 2. Packet type validity
-     * 3. Length constraints
-     * 4. CRC-16 integrity
+     * 2. CRC-16 integrity
      *
      * @param package Packet to validate
+     * @param calculatedCrc CRC-16 computed over the packet's CRC scope
      * @return NackReason Error code (NO_ERROR if valid)
      */
-    NackReason validatePackage(const Package &package) const;
+    NackReason validatePackage(const Package &package, const uint16_t calculatedCrc) const;
+
+    /**
+     * @brief Next sequence number after @p packetNumber (255 wraps to 1)
+     */
+    static uint8_t nextPacketNumber(const uint8_t packetNumber);
+
+    /**
+     * @brief Forward distance from @p from to @p to in the 1..255 sequence space
+     */
+    static uint8_t packetDistance(const uint8_t from, const uint8_t to);
+
+    /**
+     * @brief Window slot @p offset positions after the oldest unacked one
+     */
+    OutgoingSlot &outgoingSlot(const uint8_t offset);
+
+    /**
+     * @brief Finds the in-flight slot carrying @p packetNumber
+     *
+     * @return OutgoingSlot* Matching slot, nullptr if not in the window
+     */
+    OutgoingSlot *findOutgoingSlot(const uint8_t packetNumber);
+
+    /**
+     * @brief Releases acked slots from the front of the window
+     *
+     * @details Advances m_outgoingPacketNumber past every consecutively
+     * acknowledged slot, making room for new data.
+     */
+    void slideOutgoingWindow();
+
+    /**
+     * @brief Gives up on a packet after MAX_RETRY_COUNT attempts
+     *
+     * @details Stop-and-wait drops the packet and reuses its number, as
+     * before. With a wider window the peer may hold later packets, so the
+     * link is resynchronised with a RESET instead.
+     */
+    void abandonOutgoingWindow();
+
+    /**
+     * @brief Payload bytes carried by a frame
+     *
+     * @param header Header of the frame (type byte holds the size class)
+     * @return uint8_t BASE_DATA_LENGTH << payload class
+     */
+    static uint8_t payloadLength(const PackageHeader &header);
+
+    /**
+     * @brief Packet type without the payload size class
+     */
+    static uint8_t packageType(const PackageHeader &header);
+
+    /**
+     * @brief Whether a DATA frame carries the ackNumber byte
+     */
+    static bool hasAckNumber(const PackageHeader &header);
+
+    /**
+     * @brief Sends the delayed cumulative ACK once it is due
+     *
+     * @details Due when ACK_DELAY_TIMEOUT expired without outgoing DATA to
+     * carry it, or half a window of packets is waiting for it.
+     */
+    void flushPendingAck();
+
+    /**
+     * @brief Writes a stand-alone cumulative ACK for m_lastIncomingPacketNumber
+     *
+     * @return true if sent
+     * @return false if the encoded stream had no room
+     */
+    bool sendCumulativeAck();
+
+    /**
+     * @brief Sends a cumulative ACK as window update once credit reopened
+     *
+     * @details Due when the peer, by our last advertisement, has less than
+     * one payload of credit left on a channel whose stream has room for a
+     * full one again.
+     */
+    void flushCreditUpdate();
+
+    /**
+     * @brief Room of a channel's plain stream, as advertised to the peer
+     *
+     * @param channel Channel ID
+     * @return uint8_t Bytes, CREDIT_UNLIMITED if no stream is attached
+     */
+    uint8_t receiveCredit(const uint8_t channel);
+
+    /**
+     * @brief Credit the peer granted a channel that we have not used yet
+     *
+     * @param channel Channel ID
+     * @return uint8_t Bytes, CREDIT_UNLIMITED without FEATURE_CREDIT
+     */
+    uint8_t sendCredit(const uint8_t channel) const;
+
+    /**
+     * @brief Takes the credit bytes of a received cumulative ACK
+     *
+     * @param package The ACK; its packet number is what the credit counts from
+     */
+    void takeCredit(const Package &package);
+
+    /**
+     * @brief Forgets credit in both directions, as after a new handshake
+     */
+    void resetCredit();
+
+    /**
+     * @brief Folds a round-trip sample into SRTT/RTTVAR and derives the RTO
+     *
+     * @param sample Time from transmission to ACK (milliseconds), taken
+     *               from packets sent once only
+     */
+    void updateRoundTrip(uint16_t sample);
+
+    /**
+     * @brief Forgets the round-trip estimate, back to OUTGOING_DATA_ACK_NACK_TIMEOUT
+     */
+    void resetRoundTrip();
+
+    /**
+     * @brief Counts a frame rejected for @p reason
+     */
+    void countRejected(const NackReason reason);
+
+    /**
+     * @brief Marks every window slot up to @p packetNumber acknowledged
+     *
+     * @param packetNumber Last packet the peer delivered in sequence
+     * @return true if any slot was acknowledged
+     */
+    bool acknowledgeUpTo(const uint8_t packetNumber);
+
+    /**
+     * @brief Writes a RESET packet offering MAX_WINDOW_SIZE and MAX_DATA_LENGTH
+     *
+     * @return true if sent
+     * @return false if the encoded stream had no room
+     */
+    bool transmitResetPacket();
+
+    /**
+     * @brief Applies a peer's window, payload and feature offers
+     *
+     * @param package RESET or RESET-ACK carrying the capability bytes
+     */
+    void applyCapabilities(const Package &package);
+
+    /**
+     * @brief Continues the session after the link came back
+     *
+     * @details Releases what the peer delivered meanwhile and queues the
+     * rest of the window for retransmission; numbering and received slots
+     * stay as they are.
+     *
+     * @param delivered Last packet the peer delivered in sequence
+     */
+    void resumeSession(const uint8_t delivered);
+
+    /**
+     * @brief Picks the ID of a new session, never 0 or the current one
+     */
+    uint16_t nextSessionId() const;
+
+    /**
+     * @brief Handles a validated DATA packet
+     *
+     * @details Delivers the next expected packet, buffers later ones inside
+     * the window, and re-acknowledges duplicates.
+     *
+     * @return true if the packet was consumed (ACK sent)
+     * @return false if a stream was full and processing must be retried
+     */
+    bool processDataPackage();
+
+    /**
+     * @brief Delivers buffered out-of-order payloads that are now in sequence
+     */
+    void deliverReceivedSlots();
+
+    /**
+     * @brief Internal plain stream of @p channel
+     *
+     * @return PipedStream* Stream, nullptr if no pair is attached
+     */
+    PipedStream *channelStream(const uint8_t channel);
+
+    /**
+     * @brief Lane a channel was assigned to with setChannelLane()
+     */
+    Lane channelLane(const uint8_t channel) const;
+
+    /**
+     * @brief Whether a control channel has data it may send
+     */
+    bool hasControlData();
+
+    /**
+     * @brief Samples the lane depths and their peaks
+     */
+    void sampleLaneDepths();
+
+    /**
+     * @brief Picks the channel the next DATA packet is filled from
+     *
+     * @details Control lane first, then bulk; round-robin within a lane
+     * from the channel after the last one sent, so a busy channel cannot
+     * starve the others; channel 0 only until FEATURE_CHANNELS is
+     * negotiated.
+     *
+     * @param channel Set to the picked channel; with nullptr returned, a
+     * channel whose data waits (for credit first, else for a window slot
+     * bulk may take), or CHANNEL_COUNT if none has data
+     * @return PipedStream* Stream with data waiting and credit, nullptr if none
+     */
+    PipedStream *nextOutgoingStream(uint8_t &channel);
 
     /**
      * @brief Prepares packet for transmission
      *
      * @details Assembles a complete packet:
-     * 1. Sets header fields
+     * 1. Sets header fields (DATA gets the negotiated payload class and,
+     *    with FEATURE_CUMULATIVE_ACK, the current cumulative ACK)
      * 2. Copies payload data
      * 3. Calculates CRC-16
      * 4. Sets footer fields
@@ -408,7 +997,7 @@ private:
      * @param package Packet structure to prepare
      * @param type Packet type (DATA/ACK/NACK/RESET)
      * @param packetNumber Sequence number
-     * @param dataLength Payload length (0-8 bytes)
+     * @param dataLength Payload length (0 to the frame's payload size)
      * @param data Payload buffer (nullptr if no data)
      */
     void preparePackage(Package &package, const uint8_t type, const uint8_t packetNumber,
@@ -444,12 +1033,20 @@ private:
      */
     void resetIncomingState();
 
+    /**
+     * @brief Restarts reception after a rejected header
+     *
+     * @details Continues from a 0xAA among the header bytes already read,
+     * otherwise returns to WAIT_FOR_START_BYTE.
+     */
+    void resyncIncoming();
+
     /**
      * @brief Transmits packet over encoded stream
      *
      * @details Sends complete packet:
-     * 1. Serializes to byte array
-     * 2. Writes to encoded stream
+     * 1. Writes header and the frame's payload size
+     * 2. Writes ackNumber if the frame carries one, then the footer
      * 3. No buffering/queueing
      *
      * @param package Prepared packet to send
@@ -462,7 +1059,7 @@ private:
      * @details Handles received packet based on type:
      * - DATA: Validate, store, send ACK
      * - ACK/NACK: Queue for outgoing state machine
-     * - RESET: Reset protocol state, send ACK
+     * - RESET: Reset protocol state, or resume the session, send ACK
      *
      * @return true if processing successful
      * @return false if error occurred
@@ -470,18 +1067,49 @@ private:
     bool processPackage();
 
     // Member variables
-    SimpleTimer<uint16_t> m_outgoingTimer;       /**< Timer for outgoing data handling */
-    SimpleTimer<uint16_t> m_incomingTimer;       /**< Timer for incoming data handling */
-    SimpleTimer<uint16_t> m_resetDetectionTimer; /**< Timer for detecting communication resets */
+    SimpleTimer<uint16_t, LoopClock> m_outgoingTimer;       /**< Timer for outgoing data handling */
+    SimpleTimer<uint16_t, LoopClock> m_incomingTimer;       /**< Timer for incoming data handling */
+    SimpleTimer<uint16_t, LoopClock> m_resetDetectionTimer; /**< Timer for detecting communication resets */
+
+    uint8_t m_outgoingPacketNumber;     /**< Sequence number of the oldest unacked outgoing packet */
+    uint8_t m_lastIncomingPacketNumber; /**< Last incoming packet delivered in sequence */
 
-    uint8_t m_outgoingPacketNumber;     /**< Current outgoing packet sequence number */
-    uint8_t m_lastIncomingPacketNumber; /**< Last received incoming packet sequence number */
+    OutgoingSlot m_outgoingSlots[MAX_WINDOW_SIZE];   /**< Outgoing window (ring) */
+    uint8_t m_outgoingHead;                          /**< Ring index of the oldest unacked slot */
+    uint8_t m_outgoingCount;                         /**< Slots sent or queued for sending */
+    uint8_t m_windowSize;                            /**< Negotiated window (1 = stop-and-wait) */
+    uint8_t m_payloadClass;                          /**< Negotiated DATA payload class (0 = BASE_DATA_LENGTH) */
+    uint8_t m_features;                              /**< Negotiated FEATURE_* bits */
+    uint8_t m_pendingAckCount;                       /**< Packets delivered since the last ACK we sent */
+    SimpleTimer<uint16_t, LoopClock> m_ackDelayTimer; /**< Bounds how long a cumulative ACK is held */
+    uint16_t m_smoothedRtt;                          /**< SRTT << RTT_SHIFT (0 = no sample yet) */
+    uint16_t m_rttVariation;                         /**< RTTVAR << RTTVAR_SHIFT */
+    uint16_t m_retransmitTimeout;                    /**< Current RTO including backoff (milliseconds) */
+    LinkStatistic m_linkStatistic;                   /**< Link-quality counters */
+    uint8_t m_resetAttempts;                         /**< RESETs sent without a RESET-ACK (0 = none pending) */
+    uint16_t m_sessionId;                            /**< Session of the last RESET handshake (0 = none) */
+    bool m_connected;                                /**< Link below carries frames, see setConnected() */
+    uint16_t m_coalesceDelay;                        /**< Time a partial payload waits for more data */
+    uint8_t m_flushChannels;                         /**< Channels flushed until their data is packetised (bits) */
+    uint8_t m_lineFlushChannels;                     /**< Channels flushed by a line end (bits) */
+    uint8_t m_peerCredit[CHANNEL_COUNT];             /**< Credit of the peer's last cumulative ACK, per channel */
+    uint8_t m_creditUsed[CHANNEL_COUNT];             /**< Payload bytes numbered beyond that ACK, per channel */
+    uint8_t m_advertisedCredit[CHANNEL_COUNT];       /**< Credit of our last cumulative ACK, per channel */
+    uint8_t m_deliveredSinceCredit[CHANNEL_COUNT];   /**< Payload bytes delivered since that ACK, per channel */
+    SimpleTimer<uint16_t, LoopClock> m_creditProbeTimer; /**< Paces empty DATA asking for credit */
+    uint8_t m_bulkChannels;                          /**< Channels in LANE_BULK (bits) */
+    uint16_t m_laneDepth[LANE_COUNT];                /**< Bytes waiting per lane at the last loop() */
+    uint16_t m_peakLaneDepth[LANE_COUNT];            /**< Peak of m_laneDepth per lane */
+    uint8_t m_outOfWindowCount;                      /**< Consecutive DATA packets outside the receive window */
+    ReceivedSlot m_receivedSlots[RECEIVE_BUFFER_SLOTS]; /**< Out-of-order incoming payloads */
+    PipedStreamPair *p_channelPipes[CHANNEL_COUNT - 1];  /**< Stream pairs of channels 1.. (nullptr = not attached) */
+    uint8_t m_nextOutgoingChannel;                   /**< Channel served first by the next DATA packet */
 
-    Package m_outgoingPackage; /**< Buffer for outgoing packet */
     Package m_incomingPackage; /**< Buffer for incoming packet */
 
-    OutgoingFlags m_outgoingFlags; /**< State flags for outgoing channel */
     IncomingFlags m_incomingFlags; /**< State flags for incoming channel */
+    uint16_t m_incomingCrc;        /**< Running CRC of the packet being received */
+    uint32_t m_plainDeliveryMicros; /**< micros() at the latest payload written to the plain stream */
 
     FastCircularQueue<PendingMessage, MAX_PENDING_MESSAGES> m_messageQueue; /**< Queue for ACK/NACK messages */
 };
@@ -2,14 +2,24 @@
  * Recommented CRC Package Interface – Reliable packet-based communication protocol.
  * <p>
  * Features (updated comments):
- * - Format: fixed 15-byte packet (4B header, 8B payload, 3B footer)
+ * - Format: 15-byte packet (4B header, 8B payload, 3B footer)
+ * - DATA payload widened to 16/32 bytes when negotiated on RESET
  * - Error detection via CRC-16-CCITT
  * - Automatic retransmission using ACK/NACK
+ * - Sliding window with selective retransmit (negotiated on RESET)
+ * - Cumulative ACKs, piggybacked on DATA or delayed (negotiated on RESET)
+ * - Up to four channels multiplexed over the link (negotiated on RESET)
+ * - Sessions resumed over a new connection without a reset (resume())
  * - Connection state monitoring and thread-safe operations
  * <p>
  * State machines:
- * Outgoing: READ_DATA → SEND_PACKAGE → WAIT_FOR_ACK_OR_NACK
+ * Outgoing: READ_DATA → SEND_PACKAGE → WAIT_FOR_ACK_OR_NACK (per window slot)
  * Incoming: WAIT_FOR_START_BYTE → READ_INCOMING_DATA → PROCESS_INCOMING_DATA
+ * <p>
+ * Threads: a reader blocks on the input stream and hands every read to the
+ * protocol executor, which runs both state machines and all writes. Received
+ * bytes, sendData() and the earliest pending timeout each schedule a run, so
+ * nothing waits for a polling period.
  *
  * @author Aykut ÖZDEMİR
  */
@@ -19,7 +29,13 @@ import java.io.IOException;
 import java.io.InputStream;
 import java.io.OutputStream;
 import java.util.Arrays;
-import java.util.concurrent.ConcurrentLinkedQueue;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.Executors;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ThreadLocalRandom;
+import java.util.concurrent.TimeUnit;
 import java.util.concurrent.atomic.AtomicBoolean;
 
 public class CRCPackageInterface {
@@ -30,16 +46,108 @@ public class CRCPackageInterface {
     private static final byte STOP_BYTE = (byte) 0x55;
 
     // Protocol parameters and timeouts (in milliseconds)
-    /** Maximum payload size per packet */
-    private static final int MAX_DATA_LENGTH = 8;
-    /** Total packet size: Header(4) + Data(8) + Footer(3) */
-    private static final int PACKAGE_LENGTH = 15;
+    /** Payload size of every control packet and of DATA before negotiation */
+    private static final int BASE_DATA_LENGTH = 8;
+    /** Maximum payload size per packet (offered in the RESET handshake) */
+    private static final int MAX_DATA_LENGTH = 32;
+    /** Header size */
+    private static final int HEADER_LENGTH = 4;
+    /** Footer size */
+    private static final int FOOTER_LENGTH = 3;
+    /** Largest packet size: Header(4) + Data(32) + ackNumber(1) + Footer(3) */
+    private static final int PACKAGE_LENGTH = HEADER_LENGTH + MAX_DATA_LENGTH + 1 + FOOTER_LENGTH;
     /** Maximum retransmission attempts */
     private static final int MAX_RETRY_COUNT = 5;
     /** Maximum state transitions per loop */
     private static final int MAX_REPLAY_COUNT = 17;
-    /** Main loop delay (milliseconds) */
-    private static final int LOOP_DELAY_MS = 10;
+    /** Delay before the next run once the outgoing state machine hit MAX_REPLAY_COUNT (milliseconds) */
+    private static final long REPLAY_DELAY_MS = 10;
+    /** Bytes taken from the input stream per read */
+    private static final int READ_BUFFER_SIZE = 64;
+    /** Bytes the reader may hand over before it waits for the protocol */
+    private static final int RECEIVE_BUFFER_SIZE = 1024;
+    /** Bytes queued by sendData() across the channels of a lane */
+    private static final int OUTGOING_BUFFER_SIZE = 4096;
+    /** Channel changes the outgoing buffer can hold */
+    private static final int OUTGOING_SEGMENT_SLOTS = 64;
+    /** Bytes received and not yet read, per channel */
+    private static final int INCOMING_BUFFER_SIZE = 4096;
+    /** ACK/NACK messages waiting for the outgoing state machine */
+    private static final int PENDING_MESSAGE_SLOTS = 16;
+    /** Time stop() waits for each thread (milliseconds) */
+    private static final long STOP_TIMEOUT_MS = 1000;
+
+    // Sliding window parameters
+    /** Largest window offered in the RESET handshake (1 = stop-and-wait only) */
+    private static final int MAX_WINDOW_SIZE = 4;
+    /** Out-of-order packets held by the receiver */
+    private static final int RECEIVE_BUFFER_SLOTS = MAX_WINDOW_SIZE - 1;
+    /** Sequence numbers run 1..255, 0 is reserved for RESET */
+    private static final int MAX_PACKET_NUMBER = 255;
+    /**
+     * Payload index of the window size offer in RESET and RESET-ACK packets.
+     * header.length stays 0, so peers without negotiation ignore it; a zero
+     * offer means window 1 and BASE_DATA_LENGTH payloads.
+     */
+    private static final int CAPABILITY_WINDOW_INDEX = 0;
+    /** Payload index of the payload size offer (bytes) */
+    private static final int CAPABILITY_PAYLOAD_INDEX = 1;
+    /** Payload index of the FEATURE_* bits */
+    private static final int CAPABILITY_FEATURE_INDEX = 2;
+    /** Cumulative, piggybacked and delayed ACKs */
+    private static final int FEATURE_CUMULATIVE_ACK = 0x01;
+    /** DATA on channels other than 0 */
+    private static final int FEATURE_CHANNELS = 0x02;
+    /** Receive credit on cumulative ACKs, needs FEATURE_CUMULATIVE_ACK */
+    private static final int FEATURE_CREDIT = 0x04;
+    /** FEATURE_* bits offered on RESET */
+    private static final int SUPPORTED_FEATURES = FEATURE_CUMULATIVE_ACK | FEATURE_CHANNELS | FEATURE_CREDIT;
+    /**
+     * Payload index of channel 0's credit in cumulative ACKs with
+     * FEATURE_CREDIT, one byte per channel: what the receiver can still
+     * queue beyond the acknowledged packet. The sender counts the payloads
+     * it numbered after that packet against it and holds the channel's data
+     * once it is used up.
+     */
+    private static final int CREDIT_INDEX = 0;
+    /** Credit meaning no limit: room to spare, or a listener takes the data */
+    private static final int CREDIT_UNLIMITED = 255;
+    /**
+     * Payload index of the session ID (16 bits little-endian, 0 = none) in
+     * RESET and RESET-ACK packets, zero from peers without sessions. A
+     * RESET names the session it starts, or with SESSION_RESUME the one it
+     * wants back; the RESET-ACK echoes the session in force and sets
+     * SESSION_RESUME if it was resumed.
+     */
+    private static final int SESSION_ID_INDEX = 3;
+    /** Payload index of the SESSION_* bits */
+    private static final int SESSION_FLAGS_INDEX = 5;
+    /** Payload index of the sender's last packet delivered in sequence */
+    private static final int SESSION_DELIVERED_INDEX = 6;
+    /** RESET: resume the session; RESET-ACK: resumed */
+    private static final int SESSION_RESUME = 0x01;
+
+    // Channels
+    /** Channel carrying commands and their responses */
+    public static final int CHANNEL_COMMAND = 0;
+    /** Channel carrying unsolicited telemetry from the keypad */
+    public static final int CHANNEL_TELEMETRY = 1;
+    /** Channel carrying the keypad's bench payloads, echoed back as they arrive */
+    public static final int CHANNEL_BENCH = 2;
+    /** Logical channels a DATA packet can be addressed to */
+    private static final int CHANNEL_COUNT = 4;
+
+    // Priority lanes of outgoing data
+    /** Lane of CHANNEL_COMMAND, always served first */
+    public static final int LANE_CONTROL = 0;
+    /** Lane of the other channels, which never takes the last free window slot */
+    public static final int LANE_BULK = 1;
+    /** Number of lanes */
+    private static final int LANE_COUNT = 2;
+    /** Payload length bits of the length byte */
+    private static final int LENGTH_MASK = 0x3F;
+    /** Channel ID in bits 6-7 of the length byte */
+    private static final int CHANNEL_SHIFT = 6;
 
     // Protocol timeouts (milliseconds)
     /** Timeout for collecting outgoing data */
@@ -48,6 +156,10 @@ public class CRCPackageInterface {
     private static final long OUTGOING_DATA_ACK_NACK_TIMEOUT = 500;
     /** Timeout for receiving complete packet */
     private static final long INCOMING_DATA_WAIT_TIMEOUT = 500;
+    /** Max time a cumulative ACK waits for DATA to ride on */
+    private static final long ACK_DELAY_TIMEOUT = 120;
+    /** Time data waits for credit before an empty DATA asks again */
+    private static final long CREDIT_PROBE_TIMEOUT = 500;
     /** Connection reset detection timeout */
     private static final long RESET_DETECTION_TIMEOUT = 10000;
 
@@ -61,26 +173,72 @@ public class CRCPackageInterface {
     /** Connection reset request */
     private static final byte RESET_TYPE = 0x03;
 
+    // Type byte layout
+    /** Packet type bits */
+    private static final int TYPE_MASK = 0x0F;
+    /** Payload size class (BASE_DATA_LENGTH << class) in bits 4-5 */
+    private static final int PAYLOAD_CLASS_SHIFT = 4;
+    /** Payload size class bits (after the shift) */
+    private static final int PAYLOAD_CLASS_MASK = 0x03;
+    /** Cumulative ACK: in ackNumber on DATA, in packetNumber on ACK */
+    private static final int ACK_FLAG = 0x40;
+    /** Class of MAX_DATA_LENGTH */
+    private static final int MAX_PAYLOAD_CLASS = 2;
+    /** NACK reasons by wire value, values() copies the array on every call */
+    private static final NackReason[] NACK_REASONS = NackReason.values();
+
+    // CRC-16-CCITT lookup table (built once per class load)
+    /** Initial CRC-16 register value */
+    private static final int CRC16_INITIAL_VALUE = 0xFFFF;
+    /** CRC-16-CCITT (0x1021) remainders of every byte value */
+    private static final int[] CRC16_TABLE = new int[256];
+
+    static {
+        for (int i = 0; i < 256; i++) {
+            int crc = i << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = ((crc & 0x8000) != 0) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            }
+            CRC16_TABLE[i] = crc & 0xFFFF;
+        }
+    }
+
     // Queues and thread control for asynchronous communication
     // Communication streams
-    /** Raw input stream for receiving data */
-    private final InputStream inputStream;
-    /** Raw output stream for sending data */
-    private final OutputStream outputStream;
-
-    // Thread-safe message queues
-    /** Queue for outgoing data chunks */
-    private final ConcurrentLinkedQueue<byte[]> outgoingDataQueue;
-    /** Queue for received data chunks */
-    private final ConcurrentLinkedQueue<byte[]> incomingDataQueue;
-    /** Queue for ACK/NACK messages */
-    private final ConcurrentLinkedQueue<PendingMessage> messageQueue;
+    /** Raw input stream for receiving data, replaced by resume() */
+    private InputStream inputStream;
+    /** Raw output stream for sending data, replaced by resume() */
+    private OutputStream outputStream;
+
+    // Thread-safe buffers, preallocated so steady traffic does not allocate
+    /** Data queued for transmission, one buffer per lane, in order across its channels */
+    private final OutgoingBuffer[] outgoingLanes;
+    /** Received data, one ring per channel */
+    private final ByteRing[] incomingData;
+    /** Listeners taking a channel's payloads instead of its ring, one per channel */
+    private final DataListener[] dataListeners;
+    /** ACK/NACK messages (ring, used under threadLock) */
+    private final PendingMessage[] pendingMessages;
+    /** Ring index of the oldest pending message */
+    private int pendingMessageHead;
+    /** Pending messages */
+    private int pendingMessageCount;
+    /** Bytes handed over by the reader thread, in order */
+    private final ByteRing receivedBytes;
+    /** Bytes taken from receivedBytes for the incoming state machine */
+    private final byte[] receiveBuffer;
+    /** Valid bytes in receiveBuffer */
+    private int receivedLength;
+    /** Bytes of receiveBuffer already consumed */
+    private int receivedOffset;
 
     // Thread control
     /** Protocol running state flag */
     private final AtomicBoolean isRunning;
     /** Lock for thread synchronization */
     private final Object threadLock;
+    /** Notified whenever a payload is queued on any channel */
+    private final Object incomingDataLock;
 
     // Protocol timers
     /** Timer for outgoing operations */
@@ -89,34 +247,82 @@ public class CRCPackageInterface {
     private final Timer incomingTimer;
     /** Timer for connection monitoring */
     private final Timer resetDetectionTimer;
+    /** Bounds how long a cumulative ACK is held */
+    private final Timer ackDelayTimer;
+    /** Paces empty DATA asking for credit */
+    private final Timer creditProbeTimer;
 
     // Sequence tracking
-    /** Current outgoing packet number (1-255) */
-    private byte outgoingPacketNumber;
-    /** Last received packet number */
-    private byte lastIncomingPacketNumber;
+    /** Sequence number of the oldest unacked outgoing packet (1-255) */
+    private int outgoingPacketNumber;
+    /** Last incoming packet delivered in sequence (0-255) */
+    private int lastIncomingPacketNumber;
 
     // Protocol state machines
-    /** Current state of outgoing channel */
-    private OutgoingState outgoingState;
     /** Current state of incoming channel */
     private IncomingState incomingState;
 
+    // Sliding window
+    /** Outgoing window (ring) */
+    private final OutgoingSlot[] outgoingSlots;
+    /** Ring index of the oldest unacked slot */
+    private int outgoingHead;
+    /** Slots sent or queued for sending */
+    private int outgoingCount;
+    /** Negotiated window (1 = stop-and-wait) */
+    private int windowSize;
+    /** Negotiated DATA payload class (0 = BASE_DATA_LENGTH) */
+    private int payloadClass;
+    /** Negotiated FEATURE_* bits */
+    private int features;
+    /** Packets delivered since the last ACK we sent */
+    private int pendingAckCount;
+    /** RESETs sent without a RESET-ACK (0 = none pending) */
+    private int resetAttempts;
+    /** Session of the last RESET handshake (0 = none) */
+    private int sessionId;
+    /** Result of the resume() in progress, null if none */
+    private CompletableFuture<Boolean> resumeResult;
+    /** Consecutive DATA packets outside the receive window */
+    private int outOfWindowCount;
+
+    // Receive credit (FEATURE_CREDIT), per channel
+    /** Credit of the peer's last cumulative ACK */
+    private final int[] peerCredit = new int[CHANNEL_COUNT];
+    /** Payload bytes numbered beyond that ACK */
+    private final int[] creditUsed = new int[CHANNEL_COUNT];
+    /** Credit of our last cumulative ACK */
+    private final int[] advertisedCredit = new int[CHANNEL_COUNT];
+    /** Payload bytes queued since that ACK */
+    private final int[] deliveredSinceCredit = new int[CHANNEL_COUNT];
+    /** Out-of-order incoming payloads */
+    private final ReceivedSlot[] receivedSlots;
+
     // Packet buffers
-    /** Buffer for outgoing packet */
-    private Package outgoingPackage;
     /** Buffer for incoming packet */
-    private Package incomingPackage;
+    private final Package incomingPackage;
+    /** ACK, NACK and RESET packets, reused as each is sent once built */
+    private final Package controlPackage;
+    /** Serialized frame on its way to the output stream */
+    private final byte[] transmitBuffer;
+    /** Raw bytes of the frame being received */
+    private final byte[] incomingBuffer;
     /** Bytes received for current incoming packet */
     private int incomingDataLength;
-    /** Current retransmission attempt count */
-    private int retryCount;
 
     /** Callback for error notifications */
     private ErrorCallback errorCallback;
 
-    /** Background communication thread */
-    private Thread communicationThread;
+    /** Blocking reader of the input stream */
+    private Thread readerThread;
+    /** Runs the protocol: state machines, writes and timeouts */
+    private volatile ScheduledExecutorService protocolExecutor;
+    /** Run scheduled for the earliest pending timeout */
+    private ScheduledFuture<?> deadlineTask;
+    /** service() as a task, created once */
+    private final Runnable serviceTask = this::service;
+    /** A run for wake() is queued and has not started */
+    private final AtomicBoolean wakePending = new AtomicBoolean(false);
 
     // Constructs and initializes the CRC package interface
     /**
@@ -128,56 +334,200 @@ public class CRCPackageInterface {
     public CRCPackageInterface(InputStream inputStream, OutputStream outputStream) {
         this.inputStream = inputStream;
         this.outputStream = outputStream;
-        this.outgoingDataQueue = new ConcurrentLinkedQueue<>();
-        this.incomingDataQueue = new ConcurrentLinkedQueue<>();
-        this.messageQueue = new ConcurrentLinkedQueue<>();
+        this.outgoingLanes = new OutgoingBuffer[LANE_COUNT];
+        for (int i = 0; i < LANE_COUNT; i++) {
+            outgoingLanes[i] = new OutgoingBuffer();
+        }
+        this.incomingData = new ByteRing[CHANNEL_COUNT];
+        for (int i = 0; i < CHANNEL_COUNT; i++) {
+            incomingData[i] = new ByteRing(INCOMING_BUFFER_SIZE);
+        }
+        this.dataListeners = new DataListener[CHANNEL_COUNT];
+        this.pendingMessages = new PendingMessage[PENDING_MESSAGE_SLOTS];
+        for (int i = 0; i < PENDING_MESSAGE_SLOTS; i++) {
+            pendingMessages[i] = new PendingMessage();
+        }
+        this.receivedBytes = new ByteRing(RECEIVE_BUFFER_SIZE);
+        this.receiveBuffer = new byte[READ_BUFFER_SIZE];
         this.isRunning = new AtomicBoolean(false);
         this.threadLock = new Object();
+        this.incomingDataLock = new Object();
         this.outgoingPacketNumber = 1;
         this.lastIncomingPacketNumber = 0;
-        this.outgoingState = OutgoingState.READ_DATA;
         this.incomingState = IncomingState.WAIT_FOR_START_BYTE;
         this.outgoingTimer = new Timer(OUTGOING_DATA_READ_TIMEOUT);
         this.incomingTimer = new Timer(INCOMING_DATA_WAIT_TIMEOUT);
         this.resetDetectionTimer = new Timer(RESET_DETECTION_TIMEOUT);
-        this.outgoingPackage = new Package();
+        this.ackDelayTimer = new Timer(ACK_DELAY_TIMEOUT);
+        this.creditProbeTimer = new Timer(CREDIT_PROBE_TIMEOUT);
+        resetCredit();
+        this.outgoingSlots = new OutgoingSlot[MAX_WINDOW_SIZE];
+        for (int i = 0; i < MAX_WINDOW_SIZE; i++) {
+            outgoingSlots[i] = new OutgoingSlot();
+        }
+        this.receivedSlots = new ReceivedSlot[RECEIVE_BUFFER_SLOTS];
+        for (int i = 0; i < RECEIVE_BUFFER_SLOTS; i++) {
+            receivedSlots[i] = new ReceivedSlot();
+        }
+        this.windowSize = 1;
         this.incomingPackage = new Package();
+        this.controlPackage = new Package();
+        this.transmitBuffer = new byte[PACKAGE_LENGTH];
+        this.incomingBuffer = new byte[PACKAGE_LENGTH];
     }
 
     /**
      * Starts protocol operation
      * <p>
-     * Creates and starts background communication thread
+     * Creates and starts the protocol executor and the reader thread
      * if not already running. Thread-safe.
      */
     public void start() {
         synchronized (threadLock) {
             if (isRunning.get()) return;
             isRunning.set(true);
-            communicationThread = new Thread(new CommunicationRunnable());
-            communicationThread.setName("CRC-Communication-Thread");
-            communicationThread.start();
+            protocolExecutor = Executors.newSingleThreadScheduledExecutor(
+                    runnable -> new Thread(runnable, "CRC-Protocol-Thread"));
+            readerThread = new Thread(new ReaderRunnable());
+            readerThread.setName("CRC-Reader-Thread");
+            readerThread.start();
+            // Arms the timeouts
+            wakePending.set(false);
+            wake();
         }
     }
 
     /**
      * Stops protocol operation
      * <p>
-     * Gracefully stops background thread and waits for completion.
-     * Thread-safe.
+     * Gracefully stops the executor and the reader and waits for
+     * completion. A reader blocked on the stream only returns once the
+     * stream is closed. Thread-safe.
      */
     public void stop() {
+        stopThreads();
+        synchronized (threadLock) {
+            try {
+                // Clean up once the threads are gone
+                receivedBytes.clear();
+                receivedLength = 0;
+                receivedOffset = 0;
+                resetPacketNumbering();
+                sessionId = 0;
+                finishResume(false);
+            } catch (Exception e) {
+                reportError("CRC:Thread", "Cleanup Error: " + e.getMessage());
+            }
+        }
+    }
+
+    /**
+     * Stops protocol operation, keeping the session for resume()
+     * <p>
+     * For a connection that dropped: the threads stop as in stop(), while
+     * the window, the packet numbers and the queued data stay. A frame cut
+     * by the drop is discarded. Thread-safe.
+     */
+    public void suspend() {
+        stopThreads();
+        synchronized (threadLock) {
+            receivedBytes.clear();
+            receivedLength = 0;
+            receivedOffset = 0;
+            resetIncomingState();
+            finishResume(false);
+        }
+    }
+
+    /**
+     * Continues the session over a new connection
+     * <p>
+     * Starts on the new streams with a RESET asking for the session agreed
+     * last; data is held until the RESET-ACK, one round trip. A peer that
+     * still has the session keeps its numbering: the packets it delivered
+     * are released and the rest of the window is resent, nothing queued is
+     * lost. A peer that lost it answers as to any RESET, which starts a new
+     * session as sendResetPacket() would. Without a session this is start()
+     * followed by sendResetPacket(). Must be called while stopped or
+     * suspended.
+     *
+     * @param inputStream Stream for receiving data
+     * @param outputStream Stream for sending data
+     * @return Completes with true once the session resumed, false if the
+     * peer started a new one or did not answer within MAX_RETRY_COUNT
+     * @throws IOException on communication error
+     */
+    public CompletableFuture<Boolean> resume(InputStream inputStream, OutputStream outputStream) throws IOException {
+        CompletableFuture<Boolean> result = new CompletableFuture<>();
+        synchronized (threadLock) {
+            if (isRunning.get()) throw new IllegalStateException("Resumed while running");
+            this.inputStream = inputStream;
+            this.outputStream = outputStream;
+            // Idle since the drop, which is not a reason to reset
+            resetDetectionTimer.reset();
+            start();
+            if (sessionId == 0) {
+                sendResetPacket();
+                result.complete(false);
+                return result;
+            }
+            resumeResult = result;
+            transmitResetPacket();
+            resetAttempts = 1;
+            outgoingTimer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+            outgoingTimer.reset();
+        }
+        return result;
+    }
+
+    /**
+     * Checks for a session resume() could continue
+     *
+     * @return true once a RESET handshake agreed on a session
+     */
+    public boolean hasSession() {
+        synchronized (threadLock) {
+            return sessionId != 0;
+        }
+    }
+
+    /**
+     * Completes the resume() in progress, if any
+     *
+     * @param resumed true if the peer resumed the session
+     */
+    private void finishResume(boolean resumed) {
+        if (resumeResult == null) return;
+        CompletableFuture<Boolean> result = resumeResult;
+        resumeResult = null;
+        result.complete(resumed);
+    }
+
+    /**
+     * Shuts the executor down and joins the reader
+     */
+    private void stopThreads() {
+        ScheduledExecutorService executor;
+        Thread reader;
         synchronized (threadLock) {
             isRunning.set(false);
-            if (communicationThread != null) {
-                communicationThread.interrupt();
-                try {
-                    communicationThread.join(1000);
-                } catch (InterruptedException e) {
-                    Thread.currentThread().interrupt();
-                }
-                communicationThread = null;
+            executor = protocolExecutor;
+            reader = readerThread;
+            protocolExecutor = null;
+            readerThread = null;
+        }
+        // Outside the lock, a run in progress needs it to finish
+        try {
+            if (executor != null) {
+                executor.shutdownNow();
+                executor.awaitTermination(STOP_TIMEOUT_MS, TimeUnit.MILLISECONDS);
+            }
+            if (reader != null) {
+                reader.interrupt();
+                reader.join(STOP_TIMEOUT_MS);
             }
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
         }
     }
 
@@ -190,23 +540,69 @@ public class CRCPackageInterface {
         return isRunning.get();
     }
 
+    /**
+     * Schedules a protocol run on the executor
+     * <p>
+     * Called for received bytes, queued data and RESETs; does nothing
+     * while stopped. Wake-ups before the queued run starts share it.
+     */
+    private void wake() {
+        ScheduledExecutorService executor = protocolExecutor;
+        if (executor == null || !wakePending.compareAndSet(false, true)) return;
+        try {
+            executor.execute(serviceTask);
+        } catch (RejectedExecutionException e) {
+            // Stopping
+            wakePending.set(false);
+        }
+    }
+
+    /**
+     * One protocol run on the executor
+     * <p>
+     * Runs loop() under the lock, then schedules the next run for the
+     * earliest pending timeout.
+     */
+    private void service() {
+        synchronized (threadLock) {
+            // Wake-ups from here on need another run
+            wakePending.set(false);
+            if (!isRunning.get()) return;
+            boolean replay = false;
+            try {
+                replay = loop();
+            } catch (IOException e) {
+                reportError("CRC:Thread", "IO Error: " + e.getMessage());
+            }
+            scheduleDeadline(replay);
+        }
+    }
+
     /**
      * Main protocol processing loop
      * <p>
      * Performs one iteration of protocol processing:
      * 1. Check connection timeout
-     * 2. Process outgoing state machine
-     * 3. Process incoming state machine
+     * 2. Process incoming state machine over every byte received
+     * 3. Process outgoing state machine, which sees the ACKs just received
      * 4. Handle error conditions
      *
+     * @return true if the outgoing state machine hit MAX_REPLAY_COUNT
      * @throws IOException on communication error
      */
-    private void loop() throws IOException {
+    private boolean loop() throws IOException {
+        // State that was reset cannot be resumed
         if (resetDetectionTimer.isReady()) {
-            resetPacketNumbering();
+            if (resetPacketNumbering()) sessionId = 0;
             resetDetectionTimer.reset();
         }
 
+        // Incoming state machine - every change consumes received bytes or ends a frame
+        boolean incomingChanged;
+        do {
+            incomingChanged = handleIncomingState();
+        } while (incomingChanged);
+
         // Outgoing state machine
         int outgoingStateChanges = 0;
         boolean outgoingChanged;
@@ -219,16 +615,58 @@ public class CRCPackageInterface {
             reportError("CRC:O:", "MaxStateChg");
         }
 
-        // Incoming state machine
-        int incomingStateChanges = 0;
-        boolean incomingChanged;
-        do {
-            incomingChanged = handleIncomingState();
-            if (incomingChanged) incomingStateChanges++;
-        } while (incomingChanged && incomingStateChanges < MAX_REPLAY_COUNT);
+        // Outgoing DATA had its chance to carry the ACK
+        flushPendingAck();
+        flushCreditUpdate();
+        return outgoingStateChanges == MAX_REPLAY_COUNT;
+    }
 
-        if (incomingStateChanges == MAX_REPLAY_COUNT) {
-            reportError("CRC:I:", "MaxStateChg");
+    /**
+     * Schedules the next run for the earliest pending timeout
+     * <p>
+     * Connection monitoring always runs; the frame, RESET, ACK/NACK and
+     * delayed ACK timeouts only while they are armed.
+     *
+     * @param replay true to run again after REPLAY_DELAY_MS, work is left over
+     */
+    private void scheduleDeadline(boolean replay) {
+        ScheduledExecutorService executor = protocolExecutor;
+        if (executor == null) return;
+
+        long delay;
+        if (replay) {
+            // Expired timeouts are part of the leftover work, do not spin on them
+            delay = TimeUnit.MILLISECONDS.toNanos(REPLAY_DELAY_MS);
+        } else {
+            delay = resetDetectionTimer.remainingNanos();
+            if (incomingState == IncomingState.READ_INCOMING_DATA) {
+                delay = Math.min(delay, incomingTimer.remainingNanos());
+            }
+            if (resetAttempts > 0) {
+                delay = Math.min(delay, outgoingTimer.remainingNanos());
+            }
+            for (int offset = 0; offset < outgoingCount; offset++) {
+                OutgoingSlot slot = outgoingSlot(offset);
+                if (slot.state == OutgoingState.WAIT_FOR_ACK_OR_NACK) {
+                    delay = Math.min(delay, slot.timer.remainingNanos());
+                }
+            }
+            if (pendingAckCount > 0) {
+                delay = Math.min(delay, ackDelayTimer.remainingNanos());
+            }
+            OutgoingBuffer lane = nextOutgoingLane();
+            if (lane != null && outgoingCount < windowSize && sendCredit(lane.peekChannel()) == 0) {
+                delay = Math.min(delay, creditProbeTimer.remainingNanos());
+            }
+        }
+
+        if (deadlineTask != null) {
+            deadlineTask.cancel(false);
+        }
+        try {
+            deadlineTask = executor.schedule(serviceTask, delay, TimeUnit.NANOSECONDS);
+        } catch (RejectedExecutionException e) {
+            // Stopping
         }
     }
 
@@ -242,99 +680,309 @@ public class CRCPackageInterface {
     }
 
     /**
-     * Queues data for transmission
+     * Registers a listener for the payloads of a channel
      * <p>
-     * Splits data into chunks of maximum payload size
-     * and queues for transmission.
+     * While set, the channel's payloads go to the listener as they are
+     * delivered, in order, instead of to readData() and awaitData(). It runs
+     * on the protocol thread and must not block; the bytes it is handed are
+     * only valid during the call.
+     *
+     * @param channel Channel to listen to (0 to CHANNEL_COUNT - 1)
+     * @param listener Listener, null to queue the payloads again
+     */
+    public void setDataListener(int channel, DataListener listener) {
+        if (channel < 0 || channel >= CHANNEL_COUNT) return;
+        synchronized (threadLock) {
+            dataListeners[channel] = listener;
+        }
+    }
+
+    /**
+     * Queues data for transmission on CHANNEL_COMMAND
      *
      * @param data Data buffer to send
      * @param length Number of bytes to send
      */
     public void sendData(byte[] data, int length) {
-        if (data == null || length <= 0) return;
-        int offset = 0;
-        while (offset < length) {
-            int chunkSize = Math.min(MAX_DATA_LENGTH, length - offset);
-            byte[] chunk = new byte[chunkSize];
-            System.arraycopy(data, offset, chunk, 0, chunkSize);
-            outgoingDataQueue.offer(chunk);
-            offset += chunkSize;
+        sendData(CHANNEL_COMMAND, data, length);
+    }
+
+    /**
+     * Queues data for transmission
+     * <p>
+     * Copies the data into the outgoing buffer of the channel's lane. The
+     * outgoing state machine packs it into packets of the negotiated
+     * payload size, one channel per packet, CHANNEL_COMMAND ahead of the
+     * others. Data that does not fit in OUTGOING_BUFFER_SIZE is dropped as
+     * a whole and reported.
+     *
+     * @param channel Channel to send on (0 to CHANNEL_COUNT - 1)
+     * @param data Data buffer to send
+     * @param length Number of bytes to send
+     */
+    public void sendData(int channel, byte[] data, int length) {
+        if (data == null || length <= 0 || channel < 0 || channel >= CHANNEL_COUNT) return;
+        if (!outgoingLanes[laneOf(channel)].offer(channel, data, length)) {
+            reportError("CRC:O:", "Overflow");
+            return;
         }
+        wake();
+    }
+
+    /**
+     * Retrieves data received on CHANNEL_COMMAND
+     *
+     * @return Combined received data or null if none
+     */
+    public byte[] readData() {
+        return readData(CHANNEL_COMMAND);
     }
 
     /**
      * Retrieves received data
      * <p>
-     * Combines all received chunks into single buffer.
+     * Returns everything received on the channel in a new array; the
+     * overload taking a buffer does not allocate.
      *
+     * @param channel Channel to read (0 to CHANNEL_COUNT - 1)
      * @return Combined received data or null if none
      */
-    public byte[] readData() {
-        if (incomingDataQueue.isEmpty()) return null;
-        int totalSize = 0;
-        for (byte[] chunk : incomingDataQueue) totalSize += chunk.length;
-        byte[] combined = new byte[totalSize];
-        int offset = 0;
-        while (!incomingDataQueue.isEmpty()) {
-            byte[] chunk = incomingDataQueue.poll();
-            if (chunk == null) continue;
-            System.arraycopy(chunk, 0, combined, offset, chunk.length);
-            offset += chunk.length;
+    public byte[] readData(int channel) {
+        if (channel < 0 || channel >= CHANNEL_COUNT) return null;
+        ByteRing ring = incomingData[channel];
+        synchronized (ring) {
+            int available = ring.available();
+            if (available == 0) return null;
+            byte[] combined = new byte[available];
+            ring.read(combined, 0, available);
+            wake();
+            return combined;
+        }
+    }
+
+    /**
+     * Retrieves received data into a caller's buffer
+     *
+     * @param channel Channel to read (0 to CHANNEL_COUNT - 1)
+     * @param buffer Destination
+     * @param offset First index written in buffer
+     * @param length Most bytes to read
+     * @return Bytes read, 0 if none
+     */
+    public int readData(int channel, byte[] buffer, int offset, int length) {
+        if (channel < 0 || channel >= CHANNEL_COUNT) return 0;
+        int read = incomingData[channel].read(buffer, offset, length);
+        // The room may reopen credit the keypad waits for
+        if (read > 0) wake();
+        return read;
+    }
+
+    /**
+     * Waits until data has been received on a channel
+     * <p>
+     * Returns at once when data is already queued; readData() takes it.
+     *
+     * @param channel Channel to wait for (0 to CHANNEL_COUNT - 1)
+     * @param timeout Longest wait (milliseconds)
+     * @return true if data is queued on the channel
+     * @throws InterruptedException if interrupted while waiting
+     */
+    public boolean awaitData(int channel, long timeout) throws InterruptedException {
+        if (channel < 0 || channel >= CHANNEL_COUNT) return false;
+        ByteRing ring = incomingData[channel];
+        long deadline = System.nanoTime() + TimeUnit.MILLISECONDS.toNanos(timeout);
+        synchronized (incomingDataLock) {
+            while (ring.available() == 0) {
+                long remaining = deadline - System.nanoTime();
+                if (remaining <= 0) return false;
+                TimeUnit.NANOSECONDS.timedWait(incomingDataLock, remaining);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Hands a received payload to the channel's listener, or queues it and wakes awaitData()
+     * <p>
+     * A full ring drops what does not fit; the packet is acknowledged
+     * already, so the loss is reported.
+     *
+     * @param channel Channel the payload arrived on
+     * @param data Buffer holding the payload
+     * @param offset First payload byte in data
+     * @param length Payload bytes
+     */
+    private void deliverPayload(int channel, byte[] data, int offset, int length) {
+        DataListener listener = dataListeners[channel];
+        if (listener != null) {
+            listener.onData(data, offset, length);
+            return;
+        }
+        if (incomingData[channel].write(data, offset, length) < length) {
+            reportError("CRC:I:", "Overflow");
+        }
+        deliveredSinceCredit[channel] += length;
+        synchronized (incomingDataLock) {
+            incomingDataLock.notifyAll();
         }
-        return combined;
     }
 
     /**
      * Clears all queued data
      * <p>
-     * Empties both incoming and outgoing data queues.
+     * Empties both incoming and outgoing data buffers.
      */
     public void clearData() {
-        incomingDataQueue.clear();
-        outgoingDataQueue.clear();
+        synchronized (threadLock) {
+            for (ByteRing ring : incomingData) ring.clear();
+            for (OutgoingBuffer lane : outgoingLanes) lane.clear();
+        }
+    }
+
+    /**
+     * Bytes queued by sendData() and not yet packed, per lane
+     *
+     * @param lane LANE_CONTROL or LANE_BULK
+     * @return Queued bytes of the lane's channels
+     */
+    public int getLaneDepth(int lane) {
+        if (lane < 0 || lane >= LANE_COUNT) return 0;
+        return outgoingLanes[lane].queued();
+    }
+
+    /**
+     * Lane of a channel's outgoing data
+     *
+     * @param channel Channel ID
+     * @return LANE_CONTROL for CHANNEL_COMMAND, LANE_BULK otherwise
+     */
+    private static int laneOf(int channel) {
+        return channel == CHANNEL_COMMAND ? LANE_CONTROL : LANE_BULK;
     }
 
     /**
      * Initiates connection reset
      * <p>
-     * Sends reset packet and resets local state.
+     * Sends a reset packet offering MAX_WINDOW_SIZE, MAX_DATA_LENGTH and
+     * cumulative ACKs and resets local state. The window drops to 1, the
+     * payload to BASE_DATA_LENGTH and ACKs to per-packet until the peer's
+     * RESET-ACK states what it supports; outgoing data is held and the
+     * RESET resent meanwhile.
      *
      * @throws IOException on communication error
      */
     public void sendResetPacket() throws IOException {
-        Package resetPackage = new Package();
-        preparePackage(resetPackage, RESET_TYPE, (byte) 0, (byte) 0, null);
-        sendPackage(resetPackage);
-        resetPacketNumbering();
+        synchronized (threadLock) {
+            finishResume(false);
+            sessionId = nextSessionId();
+            transmitResetPacket();
+            resetPacketNumbering();
+            windowSize = 1;
+            payloadClass = 0;
+            features = 0;
+            pendingAckCount = 0;
+            resetAttempts = 1;
+            outgoingTimer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+            outgoingTimer.reset();
+        }
+        // Arms the RESET retry
+        wake();
+    }
+
+    /**
+     * Writes a reset packet offering MAX_WINDOW_SIZE, MAX_DATA_LENGTH and
+     * SUPPORTED_FEATURES for sessionId, asking to resume it while resume()
+     * waits
+     *
+     * @throws IOException on communication error
+     */
+    private void transmitResetPacket() throws IOException {
+        controlPackage.clear();
+        controlPackage.data[CAPABILITY_WINDOW_INDEX] = (byte) MAX_WINDOW_SIZE;
+        controlPackage.data[CAPABILITY_PAYLOAD_INDEX] = (byte) MAX_DATA_LENGTH;
+        controlPackage.data[CAPABILITY_FEATURE_INDEX] = (byte) SUPPORTED_FEATURES;
+        writeSession(controlPackage, resumeResult != null ? SESSION_RESUME : 0);
+        preparePackage(controlPackage, RESET_TYPE, (byte) 0, (byte) 0, null);
+        sendPackage(controlPackage);
+    }
+
+    /**
+     * Fills the session bytes of a RESET or RESET-ACK
+     *
+     * @param pkg Packet being built
+     * @param flags SESSION_* bits
+     */
+    private void writeSession(Package pkg, int flags) {
+        pkg.data[SESSION_ID_INDEX] = (byte) sessionId;
+        pkg.data[SESSION_ID_INDEX + 1] = (byte) (sessionId >> 8);
+        pkg.data[SESSION_FLAGS_INDEX] = (byte) flags;
+        pkg.data[SESSION_DELIVERED_INDEX] = (byte) lastIncomingPacketNumber;
+    }
+
+    /**
+     * Session ID a RESET or RESET-ACK carries
+     *
+     * @param pkg Received packet
+     * @return Session ID, 0 from peers without sessions
+     */
+    private static int sessionOf(Package pkg) {
+        return (pkg.data[SESSION_ID_INDEX] & 0xFF) | ((pkg.data[SESSION_ID_INDEX + 1] & 0xFF) << 8);
+    }
+
+    /**
+     * Picks the ID of a new session
+     *
+     * @return Session ID, never 0 or the current one
+     */
+    private int nextSessionId() {
+        int session;
+        do {
+            session = ThreadLocalRandom.current().nextInt(1, 0x10000);
+        } while (session == sessionId);
+        return session;
     }
 
     /**
      * Resets protocol state
      * <p>
      * Resets packet numbering, clears queues,
-     * and resets state machines.
+     * and resets state machines. Skipped if the link has
+     * carried no traffic since the last reset. sessionId is left to the
+     * caller.
+     *
+     * @return true if there was state to reset
      */
-    private void resetPacketNumbering() {
-        if (outgoingPacketNumber == 1) return;
+    private boolean resetPacketNumbering() {
+        if (outgoingPacketNumber == 1 && outgoingCount == 0 && lastIncomingPacketNumber == 0) return false;
         outgoingPacketNumber = 1;
         lastIncomingPacketNumber = 0;
-        messageQueue.clear();
-        outgoingDataQueue.clear();
-        incomingDataQueue.clear();
+        pendingAckCount = 0;
+        pendingMessageCount = 0;
+        for (OutgoingBuffer lane : outgoingLanes) lane.clear();
+        for (ByteRing ring : incomingData) ring.clear();
+        for (ReceivedSlot slot : receivedSlots) {
+            slot.packetNumber = 0;
+        }
+        outOfWindowCount = 0;
         resetOutgoingState();
         resetIncomingState();
         reportError("CRC:", "ResetNum");
+        return true;
     }
 
     /**
      * Resets outgoing channel state
      * <p>
-     * Clears packet buffer and resets state machine.
+     * Empties the window (packets not yet acked are dropped) and resets
+     * every slot. outgoingPacketNumber is left alone, so the next packet
+     * reuses the number of the oldest one dropped.
      */
     private void resetOutgoingState() {
-        outgoingPackage = new Package();
-        outgoingState = OutgoingState.READ_DATA;
-        retryCount = 0;
+        for (OutgoingSlot slot : outgoingSlots) {
+            slot.clear();
+        }
+        outgoingHead = 0;
+        outgoingCount = 0;
         outgoingTimer.setInterval(OUTGOING_DATA_READ_TIMEOUT);
         outgoingTimer.reset();
     }
@@ -345,7 +993,7 @@ public class CRCPackageInterface {
      * Clears packet buffer and resets state machine.
      */
     private void resetIncomingState() {
-        incomingPackage = new Package();
+        incomingPackage.clear();
         incomingDataLength = 0;
         incomingState = IncomingState.WAIT_FOR_START_BYTE;
         incomingTimer.setInterval(INCOMING_DATA_WAIT_TIMEOUT);
@@ -355,11 +1003,12 @@ public class CRCPackageInterface {
     /**
      * Prepares packet for transmission
      * <p>
-     * Sets header fields, copies payload,
-     * and calculates CRC.
+     * Sets header fields (DATA gets the negotiated payload class and, with
+     * FEATURE_CUMULATIVE_ACK, ACK_FLAG and the current ackNumber), copies
+     * payload, and calculates CRC.
      *
      * @param pkg Packet to prepare
-     * @param type Packet type
+     * @param type Packet type, ACK may add ACK_FLAG
      * @param packetNumber Sequence number
      * @param dataLength Payload length
      * @param data Optional payload data
@@ -369,6 +1018,15 @@ public class CRCPackageInterface {
         pkg.header.packetNumber = packetNumber;
         pkg.header.type = type;
         pkg.header.length = dataLength;
+        if (type != DATA_TYPE) {
+            pkg.header.channel = 0;
+        } else {
+            pkg.header.type |= (byte) (payloadClass << PAYLOAD_CLASS_SHIFT);
+            if ((features & FEATURE_CUMULATIVE_ACK) != 0) {
+                pkg.header.type |= (byte) ACK_FLAG;
+                pkg.ackNumber = (byte) lastIncomingPacketNumber;
+            }
+        }
         if (data != null && dataLength > 0) {
             System.arraycopy(data, 0, pkg.data, 0, dataLength);
         }
@@ -379,112 +1037,418 @@ public class CRCPackageInterface {
     /**
      * Transmits packet
      * <p>
-     * Serializes and sends packet over output stream.
+     * Serializes and sends packet over output stream; ackNumber (if
+     * carried) and the footer follow the frame's payload size.
      *
      * @param pkg Packet to send
      * @throws IOException on communication error
      */
     private void sendPackage(Package pkg) throws IOException {
-        byte[] buffer = pkg.toByteArray();
-        outputStream.write(buffer);
+        int length = pkg.writeTo(transmitBuffer);
+        outputStream.write(transmitBuffer, 0, length);
         outputStream.flush();
     }
 
     /**
      * Calculates CRC-16-CCITT checksum
      * <p>
-     * Uses polynomial 0x1021 (x^16 + x^12 + x^5 + 1)
+     * Uses polynomial 0x1021 (x^16 + x^12 + x^5 + 1), initial value 0xFFFF.
+     * Reads the header, the frame's payload and ackNumber (if carried)
+     * directly instead of serializing the packet first.
      *
      * @param pkg Packet to checksum
      * @return Calculated CRC value
      */
     private int calculateCRC16(Package pkg) {
-        byte[] data = pkg.toByteArray();
-        int crc = 0xFFFF;
-        for (int i = 1; i < (data.length - 3); i++) {
-            int currentByte = data[i] & 0xFF;
-            crc ^= (currentByte << 8);
-            crc &= 0xFFFF;
-            for (int bit = 0; bit < 8; bit++) {
-                int msb = crc & 0x8000;
-                crc = (crc << 1) & 0xFFFF;
-                if (msb != 0) {
-                    crc ^= 0x1021;
-                    crc &= 0xFFFF;
+        int crc = CRC16_INITIAL_VALUE;
+        crc = updateCRC16(crc, pkg.header.packetNumber);
+        crc = updateCRC16(crc, pkg.header.type);
+        crc = updateCRC16(crc, pkg.header.lengthByte());
+        int payloadLength = payloadLength(pkg.header);
+        for (int i = 0; i < payloadLength; i++) {
+            crc = updateCRC16(crc, pkg.data[i]);
+        }
+        if (hasAckNumber(pkg.header)) {
+            crc = updateCRC16(crc, pkg.ackNumber);
+        }
+        return crc;
+    }
+
+    /**
+     * Payload bytes carried by a frame
+     * <p>
+     * Bits 4-5 of the type byte select BASE_DATA_LENGTH &lt;&lt; class
+     * bytes; only DATA uses a class other than 0, and only once negotiated.
+     *
+     * @param header Header of the frame
+     * @return Payload size of the frame
+     */
+    private static int payloadLength(Header header) {
+        return payloadLength(header.type);
+    }
+
+    /**
+     * Payload bytes carried by a frame
+     *
+     * @param type Type byte of the frame
+     * @return Payload size of the frame
+     */
+    private static int payloadLength(byte type) {
+        int payloadClass = ((type & 0xFF) >>> PAYLOAD_CLASS_SHIFT) & PAYLOAD_CLASS_MASK;
+        return (payloadClass <= MAX_PAYLOAD_CLASS) ? (BASE_DATA_LENGTH << payloadClass) : BASE_DATA_LENGTH;
+    }
+
+    /**
+     * Packet type without the payload size class
+     *
+     * @param header Header of the frame
+     * @return DATA/ACK/NACK/RESET
+     */
+    private static int packageType(Header header) {
+        return header.type & TYPE_MASK;
+    }
+
+    /**
+     * Whether a DATA frame carries the ackNumber byte
+     * <p>
+     * On ACK frames ACK_FLAG marks the packet number as cumulative instead.
+     *
+     * @param header Header of the frame
+     * @return true if ackNumber follows the payload
+     */
+    private static boolean hasAckNumber(Header header) {
+        return hasAckNumber(header.type);
+    }
+
+    /**
+     * Whether a DATA frame carries the ackNumber byte
+     *
+     * @param type Type byte of the frame
+     * @return true if ackNumber follows the payload
+     */
+    private static boolean hasAckNumber(byte type) {
+        return (type & TYPE_MASK) == DATA_TYPE && (type & ACK_FLAG) != 0;
+    }
+
+    /**
+     * Folds one byte into a running CRC-16-CCITT value
+     *
+     * @param crc Running CRC value
+     * @param value Next input byte
+     * @return Updated CRC value
+     */
+    private static int updateCRC16(int crc, byte value) {
+        return ((crc << 8) ^ CRC16_TABLE[((crc >>> 8) ^ value) & 0xFF]) & 0xFFFF;
+    }
+
+    /**
+     * Next sequence number (255 wraps to 1, 0 is reserved for RESET)
+     *
+     * @param packetNumber Current sequence number
+     * @return Following sequence number
+     */
+    private static int nextPacketNumber(int packetNumber) {
+        return (packetNumber >= MAX_PACKET_NUMBER) ? 1 : packetNumber + 1;
+    }
+
+    /**
+     * Forward distance between two sequence numbers
+     * <p>
+     * A packet just behind {@code from} yields a distance close to 255.
+     *
+     * @param from Reference sequence number
+     * @param to Sequence number to measure
+     * @return Steps from {@code from} to {@code to} (0-254)
+     */
+    private static int packetDistance(int from, int to) {
+        return (to >= from) ? (to - from) : (MAX_PACKET_NUMBER - (from - to));
+    }
+
+    /**
+     * Window slot relative to the oldest unacked packet
+     *
+     * @param offset Slot position (0 = oldest)
+     * @return Slot in the ring
+     */
+    private OutgoingSlot outgoingSlot(int offset) {
+        return outgoingSlots[(outgoingHead + offset) % MAX_WINDOW_SIZE];
+    }
+
+    /**
+     * Finds the window slot that carries a sequence number
+     *
+     * @param packetNumber Sequence number from an ACK/NACK
+     * @return Matching slot, null if not in the window
+     */
+    private OutgoingSlot findOutgoingSlot(int packetNumber) {
+        if (packetNumber == 0) return null;
+        int offset = packetDistance(outgoingPacketNumber, packetNumber);
+        return (offset < outgoingCount) ? outgoingSlot(offset) : null;
+    }
+
+    /**
+     * Releases acked slots from the front of the window
+     * <p>
+     * Slots acked out of order stay ACKNOWLEDGED until every older
+     * slot is acked, then they are all released at once.
+     */
+    private void slideOutgoingWindow() {
+        while (outgoingCount > 0 && outgoingSlot(0).state == OutgoingState.ACKNOWLEDGED) {
+            outgoingSlot(0).clear();
+            outgoingHead = (outgoingHead + 1) % MAX_WINDOW_SIZE;
+            outgoingCount--;
+            outgoingPacketNumber = nextPacketNumber(outgoingPacketNumber);
+        }
+    }
+
+    /**
+     * Marks every window slot up to {@code packetNumber} acknowledged
+     * <p>
+     * A cumulative ACK outside the window is stale and ignored.
+     *
+     * @param packetNumber Last packet the peer delivered in sequence
+     * @return true if any slot was acknowledged
+     */
+    private boolean acknowledgeUpTo(int packetNumber) {
+        if (packetNumber == 0) return false;
+        int lastOffset = packetDistance(outgoingPacketNumber, packetNumber);
+        if (lastOffset >= outgoingCount) return false;
+        for (int offset = 0; offset <= lastOffset; offset++) {
+            outgoingSlot(offset).state = OutgoingState.ACKNOWLEDGED;
+        }
+        return true;
+    }
+
+    /**
+     * Gives up on the window after MAX_RETRY_COUNT attempts
+     * <p>
+     * Stop-and-wait drops the packet and reuses its number. With a wider
+     * window the peer may already hold later packets, so the link is
+     * resynchronised with a RESET instead.
+     *
+     * @throws IOException on communication error
+     */
+    private void abandonOutgoingWindow() throws IOException {
+        reportError("CRC:O:", "MaxRetry");
+        resetOutgoingState();
+        if (windowSize > 1) {
+            sendResetPacket();
+        }
+    }
+
+    /**
+     * Applies a peer's window, payload and feature offers
+     * <p>
+     * Peers without negotiation leave the capability bytes zero, which
+     * keeps stop-and-wait with 8-byte payloads and per-packet ACKs. The
+     * payload offer is rounded down to the largest supported class; a
+     * feature is used only if both ends offer it.
+     *
+     * @param pkg RESET or RESET-ACK carrying the capability bytes
+     */
+    private void applyCapabilities(Package pkg) {
+        int windowOffer = pkg.data[CAPABILITY_WINDOW_INDEX] & 0xFF;
+        windowSize = (windowOffer == 0) ? 1 : Math.min(windowOffer, MAX_WINDOW_SIZE);
+
+        int payloadOffer = pkg.data[CAPABILITY_PAYLOAD_INDEX] & 0xFF;
+        payloadClass = 0;
+        while (payloadClass < MAX_PAYLOAD_CLASS && (BASE_DATA_LENGTH << (payloadClass + 1)) <= payloadOffer) {
+            payloadClass++;
+        }
+
+        features = pkg.data[CAPABILITY_FEATURE_INDEX] & SUPPORTED_FEATURES;
+        // Credit rides on cumulative ACKs only
+        if ((features & FEATURE_CUMULATIVE_ACK) == 0) features &= ~FEATURE_CREDIT;
+        resetCredit();
+    }
+
+    /**
+     * Continues the session once the peer resumed it
+     * <p>
+     * Slots up to {@code delivered} reached the peer before the drop and are
+     * released; the others are resent at once with their retries cleared,
+     * as the drop lost them, not the line.
+     *
+     * @param delivered Last packet the peer delivered in sequence
+     */
+    private void resumeSession(int delivered) {
+        int lastOffset = packetDistance(outgoingPacketNumber, delivered);
+        boolean covers = delivered != 0 && lastOffset < outgoingCount;
+        for (int offset = 0; offset < outgoingCount; offset++) {
+            OutgoingSlot slot = outgoingSlot(offset);
+            if (covers && offset <= lastOffset) {
+                slot.state = OutgoingState.ACKNOWLEDGED;
+            } else if (slot.state == OutgoingState.WAIT_FOR_ACK_OR_NACK) {
+                slot.retryCount = 0;
+                slot.state = OutgoingState.SEND_PACKAGE;
+            }
+        }
+        slideOutgoingWindow();
+        outOfWindowCount = 0;
+        pendingAckCount = 0;
+    }
+
+    /**
+     * Handles outgoing state machine
+     * <p>
+     * Processes one state machine iteration over the window:
+     * - ACK: mark the matching slot, slide past acked slots
+     * - Cumulative ACK: mark every slot up to it, slide the window
+     * - NACK: resend only the matching slot
+     * - SEND_PACKAGE: Refresh the piggybacked ackNumber, transmit packet (oldest first)
+     * - WAIT_FOR_ACK_OR_NACK: Retry on timeout
+     * - READ_DATA: Pack queued chunks into the next packet while the window
+     *   has room, control lane first, at most the peer's credit; data left without credit for
+     *   CREDIT_PROBE_TIMEOUT sends an empty DATA, whose ACK brings the
+     *   credit again should an update be lost
+     * <p>
+     * A window of 1 behaves exactly like stop-and-wait.
+     *
+     * @return true if state changed
+     * @throws IOException on communication error
+     */
+    private boolean handleOutgoingState() throws IOException {
+        // RESET awaiting its ACK - no data until the peer has reset too
+        if (resetAttempts > 0) {
+            if (!outgoingTimer.isReady()) return false;
+            if (resetAttempts > MAX_RETRY_COUNT) {
+                reportError("CRC:O:", "MaxRetry");
+                resetAttempts = 0;
+                resetOutgoingState();
+                finishResume(false);
+                return true;
+            }
+            transmitResetPacket();
+            reportError("CRC:O:", "Retry");
+            resetAttempts++;
+            outgoingTimer.reset();
+            return true;
+        }
+
+        PendingMessage message = pollMessage();
+        if (message != null) {
+            if (message.type == PendingMessageType.CUMULATIVE_ACK_RECEIVED &&
+                    acknowledgeUpTo(message.packetNumber & 0xFF)) {
+                slideOutgoingWindow();
+                return true;
+            }
+            OutgoingSlot slot = findOutgoingSlot(message.packetNumber & 0xFF);
+            if (slot != null && slot.state == OutgoingState.WAIT_FOR_ACK_OR_NACK) {
+                if (message.type == PendingMessageType.ACK_RECEIVED) {
+                    slot.state = OutgoingState.ACKNOWLEDGED;
+                    slideOutgoingWindow();
+                    return true;
+                } else if (message.type == PendingMessageType.NACK_RECEIVED) {
+                    if (slot.retryCount >= MAX_RETRY_COUNT) {
+                        abandonOutgoingWindow();
+                        return true;
+                    }
+                    slot.retryCount++;
+                    reportError("CRC:O:", "Retry");
+                    slot.state = OutgoingState.SEND_PACKAGE;
+                    return true;
                 }
             }
         }
-        return crc & 0xFFFF;
+
+        // Transmit and time out packets already in the window
+        for (int offset = 0; offset < outgoingCount; offset++) {
+            OutgoingSlot slot = outgoingSlot(offset);
+            switch (slot.state) {
+                case SEND_PACKAGE:
+                    // A retransmission carries what we have received since
+                    if (hasAckNumber(slot.pkg.header)) {
+                        slot.pkg.ackNumber = (byte) lastIncomingPacketNumber;
+                        slot.pkg.footer.crc = (short) calculateCRC16(slot.pkg);
+                        pendingAckCount = 0;
+                    }
+                    sendPackage(slot.pkg);
+                    slot.state = OutgoingState.WAIT_FOR_ACK_OR_NACK;
+                    slot.timer.reset();
+                    return true;
+
+                case WAIT_FOR_ACK_OR_NACK:
+                    if (slot.timer.isReady()) {
+                        if (slot.retryCount >= MAX_RETRY_COUNT) {
+                            abandonOutgoingWindow();
+                        } else {
+                            slot.retryCount++;
+                            reportError("CRC:O:", "Retry");
+                            slot.state = OutgoingState.SEND_PACKAGE;
+                        }
+                        return true;
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        // READ_DATA on the next free slot while the window has room
+        if (outgoingCount >= windowSize) return false;
+
+        // The packet takes the channel of the lane's oldest data - others wait for the next one
+        OutgoingBuffer lane = nextOutgoingLane();
+        if (lane == null) return false;
+        int channel = lane.peekChannel();
+        if (channel != CHANNEL_COMMAND && (features & FEATURE_CHANNELS) == 0) {
+            reportError("CRC:O:", "NoChannel");
+            lane.dropSegment();
+            return true;
+        }
+
+        // Out of credit - the data waits, probing now and then
+        int payloadSize = Math.min(BASE_DATA_LENGTH << payloadClass, sendCredit(channel));
+        if (payloadSize == 0) {
+            if (!creditProbeTimer.isReady()) return false;
+        }
+
+        OutgoingSlot slot = outgoingSlot(outgoingCount);
+        slot.clear();
+        slot.pkg.header.channel = (byte) channel;
+
+        int length = payloadSize > 0 ? lane.poll(slot.pkg.data, payloadSize) : 0;
+        creditUsed[channel] += length;
+        creditProbeTimer.reset();
+
+        int packetNumber = outgoingPacketNumber;
+        for (int i = 0; i < outgoingCount; i++) {
+            packetNumber = nextPacketNumber(packetNumber);
+        }
+
+        preparePackage(slot.pkg, DATA_TYPE, (byte) packetNumber, (byte) length, null);
+        slot.state = OutgoingState.SEND_PACKAGE;
+        outgoingCount++;
+        return true;
     }
 
     /**
-     * Handles outgoing state machine
+     * Picks the lane the next DATA packet is filled from
      * <p>
-     * Processes one state machine iteration:
-     * - READ_DATA: Collect data to send
-     * - SEND_PACKAGE: Transmit packet
-     * - WAIT_FOR_ACK_OR_NACK: Wait for response
+     * The control lane first; the bulk lane may not take the last free
+     * window slot (unless the window is 1), so a command never waits for a
+     * slot behind bulk data. A lane whose channel is out of credit is
+     * passed over, and only returned for a probe if no lane can send.
      *
-     * @return true if state changed
-     * @throws IOException on communication error
+     * @return The lane, null if none has data or bulk data waits for a slot
      */
-    private boolean handleOutgoingState() throws IOException {
-        PendingMessage message = messageQueue.poll();
-        if (message != null) {
-            if (message.type == PendingMessageType.ACK_RECEIVED &&
-                    message.packetNumber == outgoingPacketNumber &&
-                    outgoingState == OutgoingState.WAIT_FOR_ACK_OR_NACK) {
-                outgoingPacketNumber++;
-                resetOutgoingState();
-                return true;
-            } else if (message.type == PendingMessageType.NACK_RECEIVED &&
-                    message.packetNumber == outgoingPacketNumber &&
-                    outgoingState == OutgoingState.WAIT_FOR_ACK_OR_NACK) {
-                retryCount++;
-                reportError("CRC:O:", "Retry");
-                outgoingState = OutgoingState.SEND_PACKAGE;
-                return true;
-            }
+    private OutgoingBuffer nextOutgoingLane() {
+        int bulkSlots = 0;
+        for (int offset = 0; offset < outgoingCount; offset++) {
+            if (laneOf(outgoingSlot(offset).pkg.header.channel) == LANE_BULK) bulkSlots++;
         }
-
-        switch (outgoingState) {
-            case READ_DATA:
-                if (!outgoingDataQueue.isEmpty()) {
-                    byte[] nextChunk = outgoingDataQueue.poll();
-                    if (nextChunk != null) {
-                        retryCount = 0;
-                        System.arraycopy(nextChunk, 0, outgoingPackage.data, 0, nextChunk.length);
-                        outgoingPackage.header.length = (byte) nextChunk.length;
-                        outgoingState = OutgoingState.SEND_PACKAGE;
-                        return true;
-                    }
-                }
-                break;
-
-            case SEND_PACKAGE:
-                preparePackage(outgoingPackage, DATA_TYPE, outgoingPacketNumber,
-                        outgoingPackage.header.length, null);
-                sendPackage(outgoingPackage);
-                outgoingState = OutgoingState.WAIT_FOR_ACK_OR_NACK;
-                outgoingTimer.setInterval(OUTGOING_DATA_ACK_NACK_TIMEOUT);
-                outgoingTimer.reset();
-                return true;
-
-            case WAIT_FOR_ACK_OR_NACK:
-                if (outgoingTimer.isReady()) {
-                    if (retryCount >= MAX_RETRY_COUNT) {
-                        reportError("CRC:O:", "MaxRetry");
-                        resetOutgoingState();
-                    } else {
-                        retryCount++;
-                        reportError("CRC:O:", "Retry");
-                        outgoingState = OutgoingState.SEND_PACKAGE;
-                    }
-                    return true;
-                }
-                break;
+        boolean bulkAllowed = windowSize == 1 || bulkSlots < windowSize - 1;
+
+        OutgoingBuffer creditWaiting = null;
+        for (int i = 0; i < LANE_COUNT; i++) {
+            OutgoingBuffer lane = outgoingLanes[i];
+            int channel = lane.peekChannel();
+            if (channel < 0 || (i == LANE_BULK && !bulkAllowed)) continue;
+            if (sendCredit(channel) > 0) return lane;
+            if (creditWaiting == null) creditWaiting = lane;
         }
-        return false;
+        return creditWaiting;
     }
 
     /**
@@ -492,7 +1456,7 @@ public class CRCPackageInterface {
      * <p>
      * Processes one state machine iteration:
      * - WAIT_FOR_START_BYTE: Find packet start
-     * - READ_INCOMING_DATA: Receive packet
+     * - READ_INCOMING_DATA: Receive packet, sized by the type byte's payload class
      * - PROCESS_INCOMING_DATA: Handle packet
      *
      * @return true if state changed
@@ -501,34 +1465,40 @@ public class CRCPackageInterface {
     private boolean handleIncomingState() throws IOException {
         switch (incomingState) {
             case WAIT_FOR_START_BYTE:
-                if (inputStream.available() > 0) {
-                    int b = inputStream.read();
-                    if ((byte) b == START_BYTE) {
+                // Bytes between frames are skipped in one go
+                while (hasReceivedByte()) {
+                    if (nextReceivedByte() == START_BYTE) {
                         incomingState = IncomingState.READ_INCOMING_DATA;
                         incomingTimer.reset();
                         incomingDataLength = 1;
-                        incomingPackage.header.startByte = START_BYTE;
+                        incomingBuffer[0] = START_BYTE;
                         return true;
                     }
                 }
                 break;
 
             case READ_INCOMING_DATA:
-                if (incomingTimer.isReady() && inputStream.available() == 0) {
+                if (incomingTimer.isReady() && !hasReceivedByte()) {
                     resetIncomingState();
                     return true;
                 }
 
-                while (inputStream.available() > 0 && incomingDataLength < PACKAGE_LENGTH) {
-                    int b = inputStream.read();
-                    byte[] packageBytes = incomingPackage.toByteArray();
-                    packageBytes[incomingDataLength++] = (byte) b;
-                    rebuildPackageFromArray(incomingPackage, packageBytes);
-                }
+                while (hasReceivedByte()) {
+                    incomingBuffer[incomingDataLength++] = nextReceivedByte();
 
-                if (incomingDataLength == PACKAGE_LENGTH) {
-                    incomingState = IncomingState.PROCESS_INCOMING_DATA;
-                    return true;
+                    // Size class beyond our buffers - the frame cannot be read
+                    if (incomingDataLength == 3 &&
+                            (((incomingBuffer[2] & 0xFF) >>> PAYLOAD_CLASS_SHIFT) & PAYLOAD_CLASS_MASK) > MAX_PAYLOAD_CLASS) {
+                        reportError("CRC:I:", NackReason.INVALID_LENGTH.toString());
+                        resetIncomingState();
+                        return true;
+                    }
+
+                    if (incomingDataLength > 3 && incomingDataLength == frameLength(incomingBuffer[2])) {
+                        rebuildPackageFromArray(incomingPackage, incomingBuffer);
+                        incomingState = IncomingState.PROCESS_INCOMING_DATA;
+                        return true;
+                    }
                 }
                 break;
 
@@ -538,10 +1508,46 @@ public class CRCPackageInterface {
         return false;
     }
 
+    /**
+     * Checks for a received byte not yet consumed
+     * <p>
+     * Takes the next bytes handed over by the reader thread once
+     * receiveBuffer is used up.
+     *
+     * @return true if nextReceivedByte() has a byte
+     */
+    private boolean hasReceivedByte() {
+        if (receivedOffset >= receivedLength) {
+            receivedLength = receivedBytes.read(receiveBuffer, 0, receiveBuffer.length);
+            receivedOffset = 0;
+        }
+        return receivedOffset < receivedLength;
+    }
+
+    /**
+     * Consumes the next received byte, only after hasReceivedByte() returned true
+     *
+     * @return The byte
+     */
+    private byte nextReceivedByte() {
+        return receiveBuffer[receivedOffset++];
+    }
+
+    /**
+     * Frame size for a type byte
+     *
+     * @param type Type byte carrying the payload class
+     * @return Header + payload (+ ackNumber) + footer bytes
+     */
+    private static int frameLength(byte type) {
+        return HEADER_LENGTH + payloadLength(type) + (hasAckNumber(type) ? 1 : 0) + FOOTER_LENGTH;
+    }
+
     /**
      * Rebuilds packet from raw bytes
      * <p>
-     * Copies raw bytes into packet structure.
+     * Copies raw bytes into packet structure; ackNumber (if carried) and
+     * the footer follow the frame's payload size.
      *
      * @param pkg Packet to rebuild
      * @param raw Raw packet bytes
@@ -550,19 +1556,27 @@ public class CRCPackageInterface {
         pkg.header.startByte = raw[0];
         pkg.header.packetNumber = raw[1];
         pkg.header.type = raw[2];
-        pkg.header.length = raw[3];
-        System.arraycopy(raw, 4, pkg.data, 0, MAX_DATA_LENGTH);
-        pkg.footer.crc = (short) (((raw[PACKAGE_LENGTH - 3] & 0xFF) << 8) | (raw[PACKAGE_LENGTH - 2] & 0xFF));
-        pkg.footer.stopByte = raw[PACKAGE_LENGTH - 1];
+        pkg.header.length = (byte) (raw[3] & LENGTH_MASK);
+        pkg.header.channel = (byte) ((raw[3] & 0xFF) >> CHANNEL_SHIFT);
+        int payloadLength = payloadLength(pkg.header);
+        System.arraycopy(raw, HEADER_LENGTH, pkg.data, 0, payloadLength);
+        int footer = HEADER_LENGTH + payloadLength;
+        if (hasAckNumber(pkg.header)) {
+            pkg.ackNumber = raw[footer++];
+        }
+        pkg.footer.crc = (short) (((raw[footer] & 0xFF) << 8) | (raw[footer + 1] & 0xFF));
+        pkg.footer.stopByte = raw[footer + 2];
     }
 
     /**
      * Processes received packet
      * <p>
      * Validates and handles packet based on type:
-     * - DATA: Store payload, send ACK
-     * - RESET: Reset state, send ACK
-     * - ACK/NACK: Update outgoing state
+     * - DATA: Deliver, buffer (inside the window) or drop as duplicate, send
+     *   (or delay) the ACK, queue a piggybacked cumulative ACK
+     * - RESET: Reset state, agree on window, payload size and features, send ACK carrying them
+     * - ACK 0: The peer's answer to our RESET
+     * - ACK/NACK: Queue for the outgoing window (ACK_FLAG: cumulative)
      *
      * @return true if processed successfully
      * @throws IOException on communication error
@@ -572,57 +1586,82 @@ public class CRCPackageInterface {
         NackReason validationResult = validatePackage(incomingPackage);
 
         if (validationResult == NackReason.NO_ERROR) {
-            switch (incomingPackage.header.type) {
+            switch (packageType(incomingPackage.header)) {
                 case DATA_TYPE:
-                    if (incomingPackage.header.packetNumber > lastIncomingPacketNumber) {
-                        if (incomingPackage.header.length > 0) {
-                            byte[] chunk = Arrays.copyOfRange(incomingPackage.data, 0,
-                                    Math.min(incomingPackage.header.length, MAX_DATA_LENGTH));
-                            incomingDataQueue.offer(chunk);
-                        }
-                        lastIncomingPacketNumber = incomingPackage.header.packetNumber;
+                    byte ackNumber = hasAckNumber(incomingPackage.header) ? incomingPackage.ackNumber : 0;
+                    processDataPackage();
+                    if (ackNumber != 0) {
+                        offerMessage(PendingMessageType.CUMULATIVE_ACK_RECEIVED, ackNumber, NackReason.NO_ERROR);
                     }
-                    Package ackPackage = new Package();
-                    preparePackage(ackPackage, ACK_TYPE, incomingPackage.header.packetNumber, (byte) 0, null);
-                    sendPackage(ackPackage);
                     break;
 
                 case RESET_TYPE:
+                    // The keypad never asks to resume, every RESET starts its session
+                    applyCapabilities(incomingPackage);
                     resetPacketNumbering();
-                    Package resetAckPackage = new Package();
-                    preparePackage(resetAckPackage, ACK_TYPE, (byte) 0, (byte) 0, null);
-                    sendPackage(resetAckPackage);
+                    sessionId = sessionOf(incomingPackage);
+                    finishResume(false);
+                    controlPackage.clear();
+                    controlPackage.data[CAPABILITY_WINDOW_INDEX] = (byte) windowSize;
+                    controlPackage.data[CAPABILITY_PAYLOAD_INDEX] = (byte) (BASE_DATA_LENGTH << payloadClass);
+                    controlPackage.data[CAPABILITY_FEATURE_INDEX] = (byte) features;
+                    writeSession(controlPackage, 0);
+                    preparePackage(controlPackage, ACK_TYPE, (byte) 0, (byte) 0, null);
+                    sendPackage(controlPackage);
                     break;
 
                 case ACK_TYPE:
-                    if (incomingPackage.header.packetNumber == outgoingPacketNumber) {
-                        PendingMessage message = new PendingMessage();
-                        message.type = PendingMessageType.ACK_RECEIVED;
-                        message.packetNumber = incomingPackage.header.packetNumber;
-                        messageQueue.offer(message);
+                    if (incomingPackage.header.packetNumber == 0) {
+                        // RESET-ACK: the peer's answer to our offer
+                        applyCapabilities(incomingPackage);
+                        if (resetAttempts > 0) {
+                            resetAttempts = 0;
+                            int session = sessionOf(incomingPackage);
+                            boolean resumed = resumeResult != null && session == sessionId &&
+                                    (incomingPackage.data[SESSION_FLAGS_INDEX] & SESSION_RESUME) != 0;
+                            if (resumed) {
+                                resumeSession(incomingPackage.data[SESSION_DELIVERED_INDEX] & 0xFF);
+                            } else {
+                                // The peer restarted its numbering when it took the RESET;
+                                // a resume it turned down leaves ours to reset here
+                                if (resumeResult != null) resetPacketNumbering();
+                                lastIncomingPacketNumber = 0;
+                                for (ReceivedSlot slot : receivedSlots) {
+                                    slot.packetNumber = 0;
+                                }
+                                resetOutgoingState();
+                            }
+                            sessionId = session;
+                            finishResume(resumed);
+                        }
+                    } else {
+                        if ((features & FEATURE_CREDIT) != 0 && (incomingPackage.header.type & ACK_FLAG) != 0) {
+                            takeCredit(incomingPackage);
+                        }
+                        offerMessage((incomingPackage.header.type & ACK_FLAG) != 0
+                                        ? PendingMessageType.CUMULATIVE_ACK_RECEIVED
+                                        : PendingMessageType.ACK_RECEIVED,
+                                incomingPackage.header.packetNumber, NackReason.NO_ERROR);
                     }
                     break;
 
                 case NACK_TYPE:
-                    if (incomingPackage.header.packetNumber == outgoingPacketNumber) {
-                        PendingMessage message = new PendingMessage();
-                        message.type = PendingMessageType.NACK_RECEIVED;
-                        message.packetNumber = incomingPackage.header.packetNumber;
-                        message.nackReason = incomingPackage.header.length > 0
-                                ? NackReason.values()[incomingPackage.data[0]]
-                                : NackReason.NO_ERROR;
-                        messageQueue.offer(message);
+                    if (incomingPackage.header.packetNumber != 0) {
+                        offerMessage(PendingMessageType.NACK_RECEIVED, incomingPackage.header.packetNumber,
+                                incomingPackage.header.length > 0
+                                        ? NACK_REASONS[incomingPackage.data[0]]
+                                        : NackReason.NO_ERROR);
                     }
                     break;
             }
         } else {
             reportError("CRC:I:", validationResult.toString());
-            if (incomingPackage.header.type == DATA_TYPE) {
-                Package nackPackage = new Package();
-                byte[] reasonData = new byte[]{(byte) validationResult.ordinal()};
-                preparePackage(nackPackage, NACK_TYPE, incomingPackage.header.packetNumber,
-                        (byte) 1, reasonData);
-                sendPackage(nackPackage);
+            if (packageType(incomingPackage.header) == DATA_TYPE) {
+                controlPackage.clear();
+                controlPackage.data[0] = (byte) validationResult.ordinal();
+                preparePackage(controlPackage, NACK_TYPE, incomingPackage.header.packetNumber,
+                        (byte) 1, null);
+                sendPackage(controlPackage);
             }
         }
 
@@ -630,12 +1669,265 @@ public class CRCPackageInterface {
         return true;
     }
 
+    /**
+     * Queues an ACK/NACK for the outgoing state machine
+     * <p>
+     * A full ring drops its oldest message; a lost ACK only costs a
+     * retransmission, which the peer acknowledges again.
+     *
+     * @param type Message type
+     * @param packetNumber Associated packet number
+     * @param nackReason Error code if NACK
+     */
+    private void offerMessage(PendingMessageType type, byte packetNumber, NackReason nackReason) {
+        if (pendingMessageCount == PENDING_MESSAGE_SLOTS) {
+            reportError("CRC:I:", "MsgOverflow");
+            pendingMessageHead = (pendingMessageHead + 1) % PENDING_MESSAGE_SLOTS;
+            pendingMessageCount--;
+        }
+        PendingMessage message = pendingMessages[(pendingMessageHead + pendingMessageCount) % PENDING_MESSAGE_SLOTS];
+        message.type = type;
+        message.packetNumber = packetNumber;
+        message.nackReason = nackReason;
+        pendingMessageCount++;
+    }
+
+    /**
+     * Takes the oldest ACK/NACK message
+     *
+     * @return The message, valid until the next offerMessage(); null if none
+     */
+    private PendingMessage pollMessage() {
+        if (pendingMessageCount == 0) return null;
+        PendingMessage message = pendingMessages[pendingMessageHead];
+        pendingMessageHead = (pendingMessageHead + 1) % PENDING_MESSAGE_SLOTS;
+        pendingMessageCount--;
+        return message;
+    }
+
+    /**
+     * Handles a validated DATA packet
+     * <p>
+     * Classifies the packet by its distance from the next expected number:
+     * - 0: deliver, then flush buffered packets now in sequence; with
+     *   cumulative ACKs the ACK is left to flushPendingAck() or the next DATA
+     * - inside our receive window: hold until the gap fills, ACK at once
+     * - up to MAX_WINDOW_SIZE behind: duplicate, re-acknowledge only (with
+     *   cumulative ACKs, everything delivered so far)
+     * - anything else: drop without ACK so the sender retries; more than
+     *   MAX_RETRY_COUNT in a row resynchronise the link with a RESET
+     *
+     * @throws IOException on communication error
+     */
+    private void processDataPackage() throws IOException {
+        int packetNumber = incomingPackage.header.packetNumber & 0xFF;
+        int distance = packetDistance(nextPacketNumber(lastIncomingPacketNumber), packetNumber);
+        int length = Math.min(incomingPackage.header.length, MAX_DATA_LENGTH);
+        int channel = incomingPackage.header.channel;
+
+        if (distance == 0) {
+            if (length > 0) {
+                deliverPayload(channel, incomingPackage.data, 0, length);
+            }
+            lastIncomingPacketNumber = packetNumber;
+            deliverReceivedSlots();
+            outOfWindowCount = 0;
+            if ((features & FEATURE_CUMULATIVE_ACK) != 0) {
+                // Delay the ACK so one covers several packets
+                if (pendingAckCount++ == 0) {
+                    ackDelayTimer.reset();
+                }
+                return;
+            }
+        } else if (distance < MAX_WINDOW_SIZE) {
+            // Ahead of a gap - hold it unless already held
+            boolean held = false;
+            ReceivedSlot freeSlot = null;
+            for (ReceivedSlot slot : receivedSlots) {
+                if (slot.packetNumber == packetNumber) {
+                    held = true;
+                } else if (freeSlot == null && slot.packetNumber == 0) {
+                    freeSlot = slot;
+                }
+            }
+            if (!held) {
+                // Nowhere to keep it - let the sender retry
+                if (freeSlot == null) return;
+                freeSlot.packetNumber = packetNumber;
+                freeSlot.channel = channel;
+                freeSlot.length = Math.max(length, 0);
+                System.arraycopy(incomingPackage.data, 0, freeSlot.data, 0, freeSlot.length);
+            }
+        } else if (distance < MAX_PACKET_NUMBER - MAX_WINDOW_SIZE) {
+            // Beyond our window - a run of these means a RESET went missing
+            if (++outOfWindowCount > MAX_RETRY_COUNT) {
+                outOfWindowCount = 0;
+                sendResetPacket();
+            }
+            return;
+        }
+        outOfWindowCount = 0;
+
+        // Duplicate - repeat the cumulative ACK it may have missed
+        if (distance >= MAX_WINDOW_SIZE && (features & FEATURE_CUMULATIVE_ACK) != 0 && lastIncomingPacketNumber != 0) {
+            sendCumulativeAck();
+            return;
+        }
+
+        controlPackage.clear();
+        preparePackage(controlPackage, ACK_TYPE, (byte) packetNumber, (byte) 0, null);
+        sendPackage(controlPackage);
+    }
+
+    /**
+     * Sends the delayed cumulative ACK once it is due
+     * <p>
+     * Due when half the negotiated window is waiting for it, or when
+     * ACK_DELAY_TIMEOUT expired without outgoing DATA to carry it.
+     *
+     * @throws IOException on communication error
+     */
+    private void flushPendingAck() throws IOException {
+        if (pendingAckCount == 0) return;
+        if (pendingAckCount < (windowSize + 1) / 2 && !ackDelayTimer.isReady()) return;
+        sendCumulativeAck();
+    }
+
+    /**
+     * Writes a stand-alone cumulative ACK for lastIncomingPacketNumber
+     *
+     * @throws IOException on communication error
+     */
+    private void sendCumulativeAck() throws IOException {
+        controlPackage.clear();
+        if ((features & FEATURE_CREDIT) != 0) {
+            // Covered by the CRC although the length stays 0
+            for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
+                int credit = receiveCredit(channel);
+                controlPackage.data[CREDIT_INDEX + channel] = (byte) credit;
+                advertisedCredit[channel] = credit;
+                deliveredSinceCredit[channel] = 0;
+            }
+        }
+        preparePackage(controlPackage, (byte) (ACK_TYPE | ACK_FLAG), (byte) lastIncomingPacketNumber, (byte) 0, null);
+        sendPackage(controlPackage);
+        pendingAckCount = 0;
+    }
+
+    /**
+     * Sends a cumulative ACK as window update once credit reopened
+     * <p>
+     * Due when the keypad, by our last advertisement, has less than one
+     * payload of credit left on a channel whose ring has room for a full
+     * one again.
+     *
+     * @throws IOException on communication error
+     */
+    private void flushCreditUpdate() throws IOException {
+        if ((features & FEATURE_CREDIT) == 0 || lastIncomingPacketNumber == 0) return;
+        int payloadSize = BASE_DATA_LENGTH << payloadClass;
+        for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
+            if (advertisedCredit[channel] == CREDIT_UNLIMITED) continue;
+            int peerView = Math.max(advertisedCredit[channel] - deliveredSinceCredit[channel], 0);
+            if (peerView < payloadSize && receiveCredit(channel) >= payloadSize) {
+                sendCumulativeAck();
+                return;
+            }
+        }
+    }
+
+    /**
+     * Room of a channel's ring, as advertised to the keypad
+     * <p>
+     * Packets held ahead of a gap are not subtracted: they were numbered
+     * after the acknowledged packet, so the keypad counts them itself.
+     *
+     * @param channel Channel ID
+     * @return Bytes, CREDIT_UNLIMITED for a channel with a listener
+     */
+    private int receiveCredit(int channel) {
+        if (dataListeners[channel] != null) return CREDIT_UNLIMITED;
+        return Math.min(incomingData[channel].free(), CREDIT_UNLIMITED);
+    }
+
+    /**
+     * Credit the keypad granted a channel that we have not used yet
+     *
+     * @param channel Channel ID
+     * @return Bytes, CREDIT_UNLIMITED without FEATURE_CREDIT
+     */
+    private int sendCredit(int channel) {
+        int credit = peerCredit[channel];
+        if ((features & FEATURE_CREDIT) == 0 || credit == CREDIT_UNLIMITED) return CREDIT_UNLIMITED;
+        return Math.max(credit - creditUsed[channel], 0);
+    }
+
+    /**
+     * Takes the credit bytes of a received cumulative ACK
+     * <p>
+     * The credit counts from the acknowledged packet, so the payloads of
+     * the window slots numbered after it are still charged against it.
+     *
+     * @param pkg The ACK
+     */
+    private void takeCredit(Package pkg) {
+        int acked = pkg.header.packetNumber & 0xFF;
+        Arrays.fill(creditUsed, 0);
+        int packetNumber = outgoingPacketNumber;
+        for (int offset = 0; offset < outgoingCount; offset++) {
+            int distance = packetDistance(acked, packetNumber);
+            if (distance != 0 && distance <= MAX_WINDOW_SIZE) {
+                Header header = outgoingSlot(offset).pkg.header;
+                creditUsed[header.channel] += header.length;
+            }
+            packetNumber = nextPacketNumber(packetNumber);
+        }
+        for (int channel = 0; channel < CHANNEL_COUNT; channel++) {
+            peerCredit[channel] = pkg.data[CREDIT_INDEX + channel] & 0xFF;
+        }
+        creditProbeTimer.reset();
+    }
+
+    /**
+     * Forgets credit in both directions, as after a new handshake
+     * <p>
+     * Until the first cumulative ACK both ends assume no limit, which is
+     * what a peer without FEATURE_CREDIT gets throughout.
+     */
+    private void resetCredit() {
+        Arrays.fill(peerCredit, CREDIT_UNLIMITED);
+        Arrays.fill(creditUsed, 0);
+        Arrays.fill(advertisedCredit, CREDIT_UNLIMITED);
+        Arrays.fill(deliveredSinceCredit, 0);
+    }
+
+    /**
+     * Delivers buffered out-of-order payloads that are now in sequence
+     */
+    private void deliverReceivedSlots() {
+        int i = 0;
+        while (i < RECEIVE_BUFFER_SLOTS) {
+            ReceivedSlot slot = receivedSlots[i];
+            if (slot.packetNumber != 0 && slot.packetNumber == nextPacketNumber(lastIncomingPacketNumber)) {
+                if (slot.length > 0) {
+                    deliverPayload(slot.channel, slot.data, 0, slot.length);
+                }
+                lastIncomingPacketNumber = slot.packetNumber;
+                slot.packetNumber = 0;
+                // The next one may sit in an earlier slot
+                i = 0;
+                continue;
+            }
+            i++;
+        }
+    }
+
     /**
      * Validates received packet
      * <p>
      * Checks:
      * - Frame markers
-     * - Packet type
+     * - Packet type (payload class only on DATA, ACK_FLAG on DATA and ACK)
      * - Payload length
      * - CRC checksum
      *
@@ -646,14 +1938,19 @@ public class CRCPackageInterface {
         if (pkg.header.startByte != START_BYTE || pkg.footer.stopByte != STOP_BYTE) {
             return NackReason.INVALID_START_STOP;
         }
-        if (pkg.header.type > RESET_TYPE) {
+        int type = packageType(pkg.header);
+        int allowedFlags = (type == DATA_TYPE) ? ((PAYLOAD_CLASS_MASK << PAYLOAD_CLASS_SHIFT) | ACK_FLAG)
+                : (type == ACK_TYPE) ? ACK_FLAG
+                : 0;
+        if (type > RESET_TYPE || (pkg.header.type & ~(TYPE_MASK | allowedFlags)) != 0) {
             return NackReason.INVALID_TYPE;
         }
-        if (pkg.header.type == DATA_TYPE && pkg.header.length > MAX_DATA_LENGTH) {
+        if (type == DATA_TYPE && pkg.header.length > payloadLength(pkg.header)) {
             return NackReason.INVALID_LENGTH;
-        } else if ((pkg.header.type == NACK_TYPE && pkg.header.length != 1) ||
-                (pkg.header.type == ACK_TYPE && pkg.header.length != 0) ||
-                (pkg.header.type == RESET_TYPE && pkg.header.length != 0)) {
+        } else if ((type != DATA_TYPE && pkg.header.channel != 0) ||
+                (type == NACK_TYPE && pkg.header.length != 1) ||
+                (type == ACK_TYPE && pkg.header.length != 0) ||
+                (type == RESET_TYPE && pkg.header.length != 0)) {
             return NackReason.INVALID_LENGTH;
         }
 
@@ -686,7 +1983,9 @@ public class CRCPackageInterface {
         /** Preparing and transmitting packet */
         SEND_PACKAGE,
         /** Waiting for acknowledgment */
-        WAIT_FOR_ACK_OR_NACK
+        WAIT_FOR_ACK_OR_NACK,
+        /** Acked ahead of an older slot */
+        ACKNOWLEDGED
     }
 
     /**
@@ -708,7 +2007,9 @@ public class CRCPackageInterface {
         /** Positive acknowledgment received */
         ACK_RECEIVED,
         /** Negative acknowledgment received */
-        NACK_RECEIVED
+        NACK_RECEIVED,
+        /** Every packet up to packetNumber acknowledged */
+        CUMULATIVE_ACK_RECEIVED
     }
 
     /**
@@ -738,14 +2039,29 @@ public class CRCPackageInterface {
         void onError(String error);
     }
 
+    /**
+     * Interface for payloads delivered on a channel
+     */
+    public interface DataListener {
+        /**
+         * Called on the protocol thread for every payload, in order
+         * @param data Buffer holding the payload, only valid during the call
+         * @param offset First payload byte in data
+         * @param length Payload bytes
+         */
+        void onData(byte[] data, int offset, int length);
+    }
+
     /**
      * Complete packet structure
      */
     private static class Package {
         /** Packet header (4 bytes) */
         Header header;
-        /** Packet payload (8 bytes max) */
+        /** Packet payload (MAX_DATA_LENGTH bytes max) */
         byte[] data;
+        /** Piggybacked cumulative ACK (on the wire only with ACK_FLAG) */
+        byte ackNumber;
         /** Packet footer (3 bytes) */
         Footer footer;
 
@@ -759,23 +2075,44 @@ public class CRCPackageInterface {
         }
 
         /**
-         * Serializes packet to byte array
-         * @return Raw packet bytes
+         * Zeroes every field, as a new packet
+         */
+        void clear() {
+            header.startByte = 0;
+            header.packetNumber = 0;
+            header.type = 0;
+            header.length = 0;
+            header.channel = 0;
+            Arrays.fill(data, (byte) 0);
+            ackNumber = 0;
+            footer.crc = 0;
+            footer.stopByte = 0;
+        }
+
+        /**
+         * Serializes packet into a buffer
+         * @param result Buffer of at least PACKAGE_LENGTH bytes
+         * @return Frame length, which follows the payload class
          */
-        byte[] toByteArray() {
-            byte[] result = new byte[PACKAGE_LENGTH];
+        int writeTo(byte[] result) {
+            int payloadLength = payloadLength(header);
+            int ackLength = hasAckNumber(header) ? 1 : 0;
             // Copy header fields
             result[0] = header.startByte;
             result[1] = header.packetNumber;
             result[2] = header.type;
-            result[3] = header.length;
+            result[3] = header.lengthByte();
             // Copy payload
-            System.arraycopy(data, 0, result, 4, MAX_DATA_LENGTH);
-            // Copy footer fields
-            result[PACKAGE_LENGTH - 3] = (byte) ((footer.crc >> 8) & 0xFF);
-            result[PACKAGE_LENGTH - 2] = (byte) (footer.crc & 0xFF);
-            result[PACKAGE_LENGTH - 1] = footer.stopByte;
-            return result;
+            System.arraycopy(data, 0, result, HEADER_LENGTH, payloadLength);
+            // Copy ackNumber and footer fields
+            int footerIndex = HEADER_LENGTH + payloadLength;
+            if (ackLength > 0) {
+                result[footerIndex++] = ackNumber;
+            }
+            result[footerIndex] = (byte) ((footer.crc >> 8) & 0xFF);
+            result[footerIndex + 1] = (byte) (footer.crc & 0xFF);
+            result[footerIndex + 2] = footer.stopByte;
+            return footerIndex + FOOTER_LENGTH;
         }
     }
 
@@ -789,8 +2126,18 @@ public class CRCPackageInterface {
         byte packetNumber;
         /** Packet type identifier */
         byte type;
-        /** Payload length */
+        /** Payload length (bits 0-5 of the length byte) */
         byte length;
+        /** Channel of a DATA payload (bits 6-7 of the length byte) */
+        byte channel;
+
+        /**
+         * Length byte as on the wire
+         * @return Payload length | channel << CHANNEL_SHIFT
+         */
+        byte lengthByte() {
+            return (byte) ((length & LENGTH_MASK) | (channel << CHANNEL_SHIFT));
+        }
     }
 
     /**
@@ -803,6 +2150,199 @@ public class CRCPackageInterface {
         byte stopByte;
     }
 
+    /**
+     * Fixed-size byte FIFO, all methods thread-safe
+     * <p>
+     * Package-private for the unit tests.
+     */
+    static class ByteRing {
+        /** Storage */
+        private final byte[] buffer;
+        /** Index of the oldest byte */
+        private int head;
+        /** Bytes stored */
+        private int count;
+
+        /**
+         * Creates an empty ring
+         * @param capacity Bytes it holds
+         */
+        ByteRing(int capacity) {
+            buffer = new byte[capacity];
+        }
+
+        /**
+         * @return Bytes stored
+         */
+        synchronized int available() {
+            return count;
+        }
+
+        /**
+         * @return Bytes that fit
+         */
+        synchronized int free() {
+            return buffer.length - count;
+        }
+
+        /**
+         * Appends as many bytes as fit
+         * @param data Source
+         * @param offset First byte in data
+         * @param length Bytes to append
+         * @return Bytes appended
+         */
+        synchronized int write(byte[] data, int offset, int length) {
+            int copied = Math.min(length, buffer.length - count);
+            int tail = (head + count) % buffer.length;
+            int first = Math.min(copied, buffer.length - tail);
+            System.arraycopy(data, offset, buffer, tail, first);
+            System.arraycopy(data, offset + first, buffer, 0, copied - first);
+            count += copied;
+            return copied;
+        }
+
+        /**
+         * Appends as many bytes as fit, waiting until at least one does
+         * @param data Source
+         * @param offset First byte in data
+         * @param length Bytes to append, at least 1
+         * @return Bytes appended
+         * @throws InterruptedException if interrupted while waiting
+         */
+        synchronized int awaitWrite(byte[] data, int offset, int length) throws InterruptedException {
+            while (count == buffer.length) {
+                wait();
+            }
+            return write(data, offset, length);
+        }
+
+        /**
+         * Takes the oldest bytes
+         * @param data Destination, null to discard them
+         * @param offset First index written in data
+         * @param length Most bytes to take
+         * @return Bytes taken
+         */
+        synchronized int read(byte[] data, int offset, int length) {
+            int copied = Math.min(length, count);
+            if (data != null) {
+                int first = Math.min(copied, buffer.length - head);
+                System.arraycopy(buffer, head, data, offset, first);
+                System.arraycopy(buffer, 0, data, offset + first, copied - first);
+            }
+            head = (head + copied) % buffer.length;
+            count -= copied;
+            if (copied > 0) {
+                notifyAll();
+            }
+            return copied;
+        }
+
+        /**
+         * Discards every byte
+         */
+        synchronized void clear() {
+            head = 0;
+            count = 0;
+            notifyAll();
+        }
+    }
+
+    /**
+     * Data of one lane queued by sendData(), in order across its channels
+     * <p>
+     * The bytes share one ring; a segment records the channel of each
+     * run of bytes, so consecutive data for one channel packs into full
+     * packets. All methods are thread-safe. Package-private for the unit
+     * tests.
+     */
+    static class OutgoingBuffer {
+        /** Queued bytes of every channel */
+        private final ByteRing bytes = new ByteRing(OUTGOING_BUFFER_SIZE);
+        /** Channel of each segment (ring) */
+        private final int[] segmentChannels = new int[OUTGOING_SEGMENT_SLOTS];
+        /** Bytes left in each segment (ring) */
+        private final int[] segmentLengths = new int[OUTGOING_SEGMENT_SLOTS];
+        /** Ring index of the oldest segment */
+        private int segmentHead;
+        /** Segments queued */
+        private int segmentCount;
+
+        /**
+         * Queues data, all or nothing
+         * @param channel Channel to send on
+         * @param data Source
+         * @param length Bytes to queue
+         * @return false if the data does not fit
+         */
+        synchronized boolean offer(int channel, byte[] data, int length) {
+            int last = (segmentHead + segmentCount + OUTGOING_SEGMENT_SLOTS - 1) % OUTGOING_SEGMENT_SLOTS;
+            boolean extend = segmentCount > 0 && segmentChannels[last] == channel;
+            if (bytes.free() < length || (!extend && segmentCount == OUTGOING_SEGMENT_SLOTS)) return false;
+            bytes.write(data, 0, length);
+            if (extend) {
+                segmentLengths[last] += length;
+            } else {
+                int tail = (segmentHead + segmentCount) % OUTGOING_SEGMENT_SLOTS;
+                segmentChannels[tail] = channel;
+                segmentLengths[tail] = length;
+                segmentCount++;
+            }
+            return true;
+        }
+
+        /**
+         * @return Bytes queued
+         */
+        synchronized int queued() {
+            return bytes.available();
+        }
+
+        /**
+         * @return Channel of the oldest data, -1 if empty
+         */
+        synchronized int peekChannel() {
+            return (segmentCount == 0) ? -1 : segmentChannels[segmentHead];
+        }
+
+        /**
+         * Takes the oldest data of one channel
+         * @param data Destination, from index 0
+         * @param length Most bytes to take
+         * @return Bytes taken, all of the channel of peekChannel()
+         */
+        synchronized int poll(byte[] data, int length) {
+            if (segmentCount == 0) return 0;
+            int copied = bytes.read(data, 0, Math.min(length, segmentLengths[segmentHead]));
+            segmentLengths[segmentHead] -= copied;
+            if (segmentLengths[segmentHead] == 0) {
+                segmentHead = (segmentHead + 1) % OUTGOING_SEGMENT_SLOTS;
+                segmentCount--;
+            }
+            return copied;
+        }
+
+        /**
+         * Discards the oldest segment
+         */
+        synchronized void dropSegment() {
+            if (segmentCount == 0) return;
+            bytes.read(null, 0, segmentLengths[segmentHead]);
+            segmentHead = (segmentHead + 1) % OUTGOING_SEGMENT_SLOTS;
+            segmentCount--;
+        }
+
+        /**
+         * Discards all queued data
+         */
+        synchronized void clear() {
+            bytes.clear();
+            segmentHead = 0;
+            segmentCount = 0;
+        }
+    }
+
     /**
      * Queued acknowledgment message
      */
@@ -816,12 +2356,49 @@ public class CRCPackageInterface {
     }
 
     /**
-     * Protocol timer with millisecond precision
+     * One packet of the outgoing window
+     */
+    private static class OutgoingSlot {
+        /** Packet as sent (kept for retransmission) */
+        final Package pkg = new Package();
+        /** Slot state */
+        OutgoingState state = OutgoingState.READ_DATA;
+        /** Current retransmission attempt count */
+        int retryCount;
+        /** ACK/NACK timeout */
+        final Timer timer = new Timer(OUTGOING_DATA_ACK_NACK_TIMEOUT);
+
+        /**
+         * Returns the slot to READ_DATA with an empty packet
+         */
+        void clear() {
+            pkg.clear();
+            state = OutgoingState.READ_DATA;
+            retryCount = 0;
+        }
+    }
+
+    /**
+     * Out-of-order payload waiting for the gap before it to fill
+     */
+    private static class ReceivedSlot {
+        /** Sequence number (0 = slot free) */
+        int packetNumber;
+        /** Channel the payload is delivered to */
+        int channel;
+        /** Payload bytes */
+        final byte[] data = new byte[MAX_DATA_LENGTH];
+        /** Valid bytes in data */
+        int length;
+    }
+
+    /**
+     * Protocol timer on the monotonic clock
      */
     private static class Timer {
         /** Timer duration in milliseconds */
         private long interval;
-        /** Last reset timestamp */
+        /** Last reset timestamp (System.nanoTime()) */
         private long lastReset;
 
         /**
@@ -845,7 +2422,7 @@ public class CRCPackageInterface {
          * Restarts timer from current time
          */
         void reset() {
-            lastReset = System.currentTimeMillis();
+            lastReset = System.nanoTime();
         }
 
         /**
@@ -853,39 +2430,50 @@ public class CRCPackageInterface {
          * @return true if interval elapsed
          */
         boolean isReady() {
-            return System.currentTimeMillis() - lastReset >= interval;
+            return remainingNanos() == 0;
+        }
+
+        /**
+         * Time left until the timer expires
+         * @return Nanoseconds, 0 once expired
+         */
+        long remainingNanos() {
+            long remaining = TimeUnit.MILLISECONDS.toNanos(interval) - (System.nanoTime() - lastReset);
+            return Math.max(remaining, 0);
         }
     }
 
     /**
-     * Background communication thread implementation
+     * Reader thread implementation
+     * <p>
+     * Blocks on the input stream and hands every read to the protocol
+     * executor through receivedBytes; it never takes the protocol lock.
      */
-    private class CommunicationRunnable implements Runnable {
+    private class ReaderRunnable implements Runnable {
         @Override
         public void run() {
-            try {
-                // Main protocol loop
-                while (isRunning.get() && !Thread.currentThread().isInterrupted()) {
-                    try {
-                        synchronized (threadLock) {
-                            // Process one protocol iteration
-                            loop();
-                            // Wait for the next iteration or notification
-                            threadLock.wait(LOOP_DELAY_MS);
-                        }
-                    } catch (IOException e) {
-                        reportError("CRC:Thread", "IO Error: " + e.getMessage());
-                    } catch (InterruptedException e) {
-                        Thread.currentThread().interrupt();
+            byte[] buffer = new byte[READ_BUFFER_SIZE];
+            while (isRunning.get() && !Thread.currentThread().isInterrupted()) {
+                try {
+                    int count = inputStream.read(buffer);
+                    if (count < 0) {
+                        reportError("CRC:Thread", "End of stream");
                         break;
                     }
-                }
-            } finally {
-                try {
-                    // Clean up on thread exit
-                    resetPacketNumbering();
-                } catch (Exception e) {
-                    reportError("CRC:Thread", "Cleanup Error: " + e.getMessage());
+                    // Waits while the protocol is a whole ring behind, every part handed over wakes it
+                    int offset = 0;
+                    while (offset < count) {
+                        offset += receivedBytes.awaitWrite(buffer, offset, count - offset);
+                        wake();
+                    }
+                } catch (IOException e) {
+                    // A closed socket stays closed
+                    if (isRunning.get()) {
+                        reportError("CRC:Thread", "IO Error: " + e.getMessage());
+                    }
+                    break;
+                } catch (InterruptedException e) {
+                    break;
                 }
             }
         }
@@ -15,38 +15,51 @@
 #include "PackageInterface.h"
 
 /**
- * @brief Default implementation of the PackageInterface.
+ * @brief Encoded side of a DefaultPackageInterface.
  *
- * This class provides a simple pass-through implementation of the PackageInterface,
- * where data is transferred between the internal and external streams without
- * any special encoding or processing.
+ * The external pair seen from its other end: the encoded stream reads what
+ * is written to the plain stream and vice versa. Inherited ahead of
+ * PackageInterface, like PackageInterfaceBuffers.
  */
-class DefaultPackageInterface : public PackageInterface
+struct DefaultPackageInterfacePassthrough
 {
-public:
     /**
-     * @brief Default buffer size for the encoded stream.
+     * @brief Constructs the reversed view of the external pair.
      *
-     * This constant defines the default buffer size used for the encoded stream
-     * if no specific size is provided in the constructor.
+     * @param pipedStreamPair The paired streams used for external communication.
      */
-    static constexpr uint8_t DEFAULT_PACKAGE_LENGTH = 8;
+    explicit DefaultPackageInterfacePassthrough(PipedStreamPair &pipedStreamPair)
+        : m_passthroughPair(pipedStreamPair.second, pipedStreamPair.first)
+    {
+    }
 
+    PipedStreamPair m_passthroughPair; ///< External pair with its ends swapped
+};
+
+/**
+ * @brief Default implementation of the PackageInterface.
+ *
+ * This class provides a simple pass-through implementation of the PackageInterface.
+ * The plain and encoded streams are the two ends of the same pipe, so data
+ * crosses without being copied and the interface has no buffers of its own.
+ */
+class DefaultPackageInterface : private DefaultPackageInterfacePassthrough, public PackageInterface
+{
+public:
     /**
      * @brief Constructs a DefaultPackageInterface instance.
      *
      * @param pipedStreamPair The paired streams used for external communication.
-     * @param encodedBufferSize The size of the buffer for encoded data, defaults to DEFAULT_PACKAGE_LENGTH.
      */
-    explicit DefaultPackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize = DEFAULT_PACKAGE_LENGTH);
+    explicit DefaultPackageInterface(PipedStreamPair &pipedStreamPair);
 
     /**
      * @brief Main processing loop.
      *
-     * Transfers data between the internal and external streams without any special encoding.
+     * Nothing to do, the streams already alias each other.
      * This implements the pure virtual method from the base class.
      */
     virtual void loop() override;
 };
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -14,16 +14,16 @@
 /**
  * @brief Constructs a PackageInterface instance.
  *
- * Initializes the PackageInterface with the provided paired streams and buffer size.
- * The paired streams are used for external communication, while an internal paired
- * stream is created for packet processing.
+ * Initializes the PackageInterface with the provided paired streams. The external
+ * pair is used for plain data, while the internal pair, owned by the derived class,
+ * carries the encoded packets.
  *
  * @param pipedStreamPair The paired streams used for external communication.
- * @param encodedBufferSize The size of the buffer for encoded data.
+ * @param packagerStreamPair The paired streams used for encoded data.
  */
-PackageInterface::PackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t encodedBufferSize)
+PackageInterface::PackageInterface(PipedStreamPair &pipedStreamPair, PipedStreamPair &packagerStreamPair)
     : p_pipedStreamPair(&pipedStreamPair),
-      m_packagerStreamPair(encodedBufferSize)
+      p_packagerStreamPair(&packagerStreamPair)
 {
 }
 
@@ -38,6 +38,6 @@ void PackageInterface::clear()
 {
     p_pipedStreamPair->first.clear();
     p_pipedStreamPair->second.clear();
-    m_packagerStreamPair.first.clear();
-    m_packagerStreamPair.second.clear();
+    p_packagerStreamPair->first.clear();
+    p_packagerStreamPair->second.clear();
 }
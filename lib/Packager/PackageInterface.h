@@ -14,6 +14,21 @@
 
 #include "PipedStream.h"
 
+/**
+ * @brief Encoded-side buffers of a PackageInterface.
+ *
+ * Derived interfaces inherit it ahead of PackageInterface, so the buffers
+ * are constructed before the base takes a reference to them and their size
+ * is fixed at compile time.
+ *
+ * @tparam N Size of each encoded buffer, a power of two.
+ */
+template <uint16_t N>
+struct PackageInterfaceBuffers
+{
+    PipedStreamPairN<N> m_packagerStreamPair; ///< Internal paired streams for packet processing
+};
+
 /**
  * @brief Abstract interface for packet-based communication protocols.
  *
@@ -28,9 +43,10 @@ public:
      * @brief Constructs a PackageInterface instance.
      *
      * @param pipedStreamPair The paired streams used for external communication.
-     * @param maxPackageSize The maximum size allowed for a packet.
+     * @param packagerStreamPair The paired streams carrying encoded data,
+     *                           from the derived class' PackageInterfaceBuffers.
      */
-    PackageInterface(PipedStreamPair &pipedStreamPair, const uint16_t maxPackageSize);
+    PackageInterface(PipedStreamPair &pipedStreamPair, PipedStreamPair &packagerStreamPair);
 
     /**
      * @brief Main processing loop.
@@ -59,7 +75,7 @@ public:
      *
      * @return Reference to the stream containing encoded data.
      */
-    PipedStream &getEncodedStream() { return m_packagerStreamPair.first; }
+    PipedStream &getEncodedStream() { return p_packagerStreamPair->first; }
 
 protected:
     /**
@@ -74,11 +90,11 @@ protected:
      *
      * @return Reference to the internal stream for encoded data.
      */
-    PipedStream &getInternalEncodedStream() { return m_packagerStreamPair.second; }
+    PipedStream &getInternalEncodedStream() { return p_packagerStreamPair->second; }
 
 private:
-    PipedStreamPair *p_pipedStreamPair;   ///< Pointer to the external paired streams
-    PipedStreamPair m_packagerStreamPair; ///< Internal paired streams for packet processing
+    PipedStreamPair *p_pipedStreamPair;    ///< Pointer to the external paired streams
+    PipedStreamPair *p_packagerStreamPair; ///< Pointer to the internal paired streams for packet processing
 };
 
 #endif
\ No newline at end of file
@@ -54,7 +54,11 @@ public:
             if (depth == 0)
             {
                 savedSREG = SREG;
+#ifdef __AVR__
                 asm volatile("cli");
+#else
+                cli(); // Host builds clear the I bit of the emulated SREG
+#endif
                 interruptState |= STATE_MASK;
             }
             if (depth < DEPTH_MASK)
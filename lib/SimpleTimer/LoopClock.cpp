@@ -0,0 +1,8 @@
+/**
+ * @file LoopClock.cpp
+ * @brief Storage for the per-pass time stamp.
+ */
+
+#include "LoopClock.h"
+
+unsigned long LoopClock::s_millis = 0;
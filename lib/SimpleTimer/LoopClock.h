@@ -0,0 +1,70 @@
+/**
+ * @file LoopClock.h
+ * @brief Time sources for the timing classes.
+ *
+ * This file defines the clocks that SimpleTimer, DriverBase::StateManager,
+ * ezLED and ezButton take as a template parameter. MillisClock reads millis()
+ * on every call; LoopClock returns a stamp sampled once per main loop pass,
+ * so a pass costs one interrupt-guarded 32-bit read and every timing decision
+ * in it sees the same time.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef LOOP_CLOCK_H
+#define LOOP_CLOCK_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Live clock, reads millis() on every call.
+ *
+ * Use it where time must advance inside one call, such as timeouts polled
+ * in a blocking wait.
+ */
+struct MillisClock
+{
+    /**
+     * @brief Current time.
+     *
+     * @return millis()
+     */
+    static unsigned long millis() { return ::millis(); }
+};
+
+/**
+ * @brief Clock sampled once per main loop pass.
+ *
+ * tick() stores millis() at the start of a pass; millis() and millis16()
+ * return that stamp until the next tick. Both views wrap, so compare them by
+ * unsigned subtraction. A timer on this clock never expires inside a
+ * blocking wait, so only poll it from the main loop.
+ */
+class LoopClock
+{
+public:
+    /**
+     * @brief Sample the time for the pass that starts now.
+     */
+    static void tick() { s_millis = ::millis(); }
+
+    /**
+     * @brief Time at the start of the current pass.
+     *
+     * @return millis() at the last tick()
+     */
+    static unsigned long millis() { return s_millis; }
+
+    /**
+     * @brief Low 16 bits of millis(), wrapping every 65.5 s.
+     *
+     * @return millis() at the last tick(), truncated
+     */
+    static uint16_t millis16() { return static_cast<uint16_t>(s_millis); }
+
+private:
+    static unsigned long s_millis; ///< Stamp of the current pass
+};
+
+#endif // LOOP_CLOCK_H
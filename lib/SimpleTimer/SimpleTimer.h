@@ -15,17 +15,19 @@
 #define LED_LIGHTING_SIMPLETIMER_H
 
 #include <Arduino.h>
+#include "LoopClock.h"
 
 /**
  * @brief Simple timer utility for managing timing operations.
  *
  * This class provides a lightweight timer implementation for Arduino,
- * allowing scheduled operations based on time intervals. The timer uses
- * the Arduino millis() function for timing calculations.
+ * allowing scheduled operations based on time intervals. The timer reads
+ * the time from its clock, live millis() by default.
  *
  * @tparam TimeType The numeric type to use for time storage, defaults to unsigned long.
+ * @tparam Clock Time source, MillisClock or LoopClock (see LoopClock.h).
  */
-template <typename TimeType = unsigned long>
+template <typename TimeType = unsigned long, typename Clock = MillisClock>
 class SimpleTimer
 {
     TimeType _start;    ///< Start time of the timer in milliseconds
@@ -39,7 +41,7 @@ public:
      *
      * @param interval Timer interval in milliseconds, defaults to 0.
      */
-    explicit SimpleTimer(const TimeType interval = 0) : _start(millis()), _interval(interval) {}
+    explicit SimpleTimer(const TimeType interval = 0) : _start(Clock::millis()), _interval(interval) {}
 
     /**
      * @brief Checks if the timer is enabled.
@@ -53,7 +55,7 @@ public:
      *
      * @return true if the timer interval has elapsed, false otherwise.
      */
-    inline bool isReady() const { return (TimeType)(millis() - _start) >= _interval; }
+    inline bool isReady() const { return (TimeType)(Clock::millis() - _start) >= _interval; }
 
     /**
      * @brief Sets a new time interval.
@@ -69,12 +71,19 @@ public:
      */
     inline TimeType getInterval() const { return _interval; }
 
+    /**
+     * @brief Gets the time passed since the last reset.
+     *
+     * @return Elapsed time in milliseconds.
+     */
+    inline TimeType elapsed() const { return (TimeType)(Clock::millis() - _start); }
+
     /**
      * @brief Resets the timer.
      *
      * Resets the start time to the current time, effectively restarting the timer.
      */
-    inline void reset() { _start = millis(); }
+    inline void reset() { _start = Clock::millis(); }
 };
 
 #endif // LED_LIGHTING_SIMPLETIMER_H
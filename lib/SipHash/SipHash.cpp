@@ -0,0 +1,211 @@
+/**
+ * @file SipHash.cpp
+ * @brief Implementation of SipHash-2-4 for the 8-bit core.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#include "SipHash.h"
+#include <string.h>
+
+/// Compression rounds per message block
+constexpr uint8_t C_ROUNDS = 2;
+/// Finalization rounds
+constexpr uint8_t D_ROUNDS = 4;
+
+// Both targets are little-endian, so the words load and store with memcpy
+static inline void loadHalves(const uint8_t *const bytes, uint32_t &lo, uint32_t &hi)
+{
+  memcpy(&lo, bytes, sizeof(lo));
+  memcpy(&hi, bytes + sizeof(lo), sizeof(hi));
+}
+
+// a += b over 64 bits
+static inline void add(uint32_t &aLo, uint32_t &aHi, const uint32_t bLo, const uint32_t bHi)
+{
+#if defined(__AVR__)
+  asm("add %A0, %A2\n\t"
+      "adc %B0, %B2\n\t"
+      "adc %C0, %C2\n\t"
+      "adc %D0, %D2\n\t"
+      "adc %A1, %A3\n\t"
+      "adc %B1, %B3\n\t"
+      "adc %C1, %C3\n\t"
+      "adc %D1, %D3"
+      : "+r"(aLo), "+r"(aHi)
+      : "r"(bLo), "r"(bHi));
+#else
+  aLo += bLo;
+  aHi += bHi + (aLo < bLo);
+#endif
+}
+
+// Rotate left by one bit over 64 bits
+static inline void rotateLeft1(uint32_t &lo, uint32_t &hi)
+{
+#if defined(__AVR__)
+  // The carry out of the top byte comes back into bit 0
+  asm("lsl %A0\n\t"
+      "rol %B0\n\t"
+      "rol %C0\n\t"
+      "rol %D0\n\t"
+      "rol %A1\n\t"
+      "rol %B1\n\t"
+      "rol %C1\n\t"
+      "rol %D1\n\t"
+      "adc %A0, __zero_reg__"
+      : "+r"(lo), "+r"(hi));
+#else
+  const uint32_t carry = hi >> 31;
+  hi = (hi << 1) | (lo >> 31);
+  lo = (lo << 1) | carry;
+#endif
+}
+
+// Rotate right by one bit over 64 bits
+static inline void rotateRight1(uint32_t &lo, uint32_t &hi)
+{
+#if defined(__AVR__)
+  // Bit 0 waits in T while the rest shifts down
+  asm("bst %A0, 0\n\t"
+      "lsr %D1\n\t"
+      "ror %C1\n\t"
+      "ror %B1\n\t"
+      "ror %A1\n\t"
+      "ror %D0\n\t"
+      "ror %C0\n\t"
+      "ror %B0\n\t"
+      "ror %A0\n\t"
+      "bld %D1, 7"
+      : "+r"(lo), "+r"(hi));
+#else
+  const uint32_t carry = lo << 31;
+  lo = (lo >> 1) | (hi << 31);
+  hi = (hi >> 1) | carry;
+#endif
+}
+
+// Rotate left by 16 bits over 64 bits, shifts by 16 are register moves on AVR
+static inline void rotateLeft16(uint32_t &lo, uint32_t &hi)
+{
+  const uint32_t oldLo = lo;
+  lo = (lo << 16) | (hi >> 16);
+  hi = (hi << 16) | (oldLo >> 16);
+}
+
+// Rotate left by 24 bits over 64 bits, shifts by 8 and 24 are register moves on AVR
+static inline void rotateLeft24(uint32_t &lo, uint32_t &hi)
+{
+  const uint32_t oldLo = lo;
+  lo = (lo << 24) | (hi >> 8);
+  hi = (hi << 24) | (oldLo >> 8);
+}
+
+// Rotate left by 32 bits over 64 bits
+static inline void rotateLeft32(uint32_t &lo, uint32_t &hi)
+{
+  const uint32_t oldLo = lo;
+  lo = hi;
+  hi = oldLo;
+}
+
+void SipHash::rounds(Word *const v, uint8_t count)
+{
+  while (count-- != 0)
+  {
+    add(v[0].lo, v[0].hi, v[1].lo, v[1].hi);
+    // 13 = 16 - 3
+    rotateLeft16(v[1].lo, v[1].hi);
+    rotateRight1(v[1].lo, v[1].hi);
+    rotateRight1(v[1].lo, v[1].hi);
+    rotateRight1(v[1].lo, v[1].hi);
+    v[1].lo ^= v[0].lo;
+    v[1].hi ^= v[0].hi;
+    rotateLeft32(v[0].lo, v[0].hi);
+
+    add(v[2].lo, v[2].hi, v[3].lo, v[3].hi);
+    rotateLeft16(v[3].lo, v[3].hi);
+    v[3].lo ^= v[2].lo;
+    v[3].hi ^= v[2].hi;
+
+    add(v[0].lo, v[0].hi, v[3].lo, v[3].hi);
+    // 21 = 24 - 3
+    rotateLeft24(v[3].lo, v[3].hi);
+    rotateRight1(v[3].lo, v[3].hi);
+    rotateRight1(v[3].lo, v[3].hi);
+    rotateRight1(v[3].lo, v[3].hi);
+    v[3].lo ^= v[0].lo;
+    v[3].hi ^= v[0].hi;
+
+    add(v[2].lo, v[2].hi, v[1].lo, v[1].hi);
+    // 17 = 16 + 1
+    rotateLeft16(v[1].lo, v[1].hi);
+    rotateLeft1(v[1].lo, v[1].hi);
+    v[1].lo ^= v[2].lo;
+    v[1].hi ^= v[2].hi;
+    rotateLeft32(v[2].lo, v[2].hi);
+  }
+} // end rounds
+
+void SipHash::compress(Word *const v, const Word &m)
+{
+  v[3].lo ^= m.lo;
+  v[3].hi ^= m.hi;
+  rounds(v, C_ROUNDS);
+  v[0].lo ^= m.lo;
+  v[0].hi ^= m.hi;
+} // end compress
+
+void SipHash::mac(const uint8_t *const key, const uint8_t *const message, const uint8_t length, uint8_t *const tag)
+{
+  Word k0;
+  Word k1;
+  loadHalves(key, k0.lo, k0.hi);
+  loadHalves(key + 8, k1.lo, k1.hi);
+
+  // "somepseudorandomlygeneratedbytes"
+  Word v[4];
+  v[0].lo = k0.lo ^ 0x70736575UL;
+  v[0].hi = k0.hi ^ 0x736f6d65UL;
+  v[1].lo = k1.lo ^ 0x6e646f6dUL;
+  v[1].hi = k1.hi ^ 0x646f7261UL;
+  v[2].lo = k0.lo ^ 0x6e657261UL;
+  v[2].hi = k0.hi ^ 0x6c796765UL;
+  v[3].lo = k1.lo ^ 0x79746573UL;
+  v[3].hi = k1.hi ^ 0x74656462UL;
+
+  Word m;
+  uint8_t offset = 0;
+  for (; static_cast<uint8_t>(length - offset) >= 8; offset += 8)
+  {
+    loadHalves(message + offset, m.lo, m.hi);
+    compress(v, m);
+  }
+
+  // Last block: the remaining bytes, the length in the top byte
+  uint8_t last[8] = {0};
+  memcpy(last, message + offset, length - offset);
+  last[7] = length;
+  loadHalves(last, m.lo, m.hi);
+  compress(v, m);
+
+  v[2].lo ^= 0xff;
+  rounds(v, D_ROUNDS);
+
+  m.lo = v[0].lo ^ v[1].lo ^ v[2].lo ^ v[3].lo;
+  m.hi = v[0].hi ^ v[1].hi ^ v[2].hi ^ v[3].hi;
+  memcpy(tag, &m.lo, sizeof(m.lo));
+  memcpy(tag + sizeof(m.lo), &m.hi, sizeof(m.hi));
+} // end mac
+
+bool SipHash::equal(const uint8_t *const first, const uint8_t *const second, const uint8_t length)
+{
+  // No early exit, a mismatch costs as long as a match
+  uint8_t difference = 0;
+  for (uint8_t i = 0; i < length; ++i)
+  {
+    difference |= first[i] ^ second[i];
+  }
+  return difference == 0;
+} // end equal
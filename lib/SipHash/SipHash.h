@@ -0,0 +1,82 @@
+/**
+ * @file SipHash.h
+ * @brief SipHash-2-4 message authentication for the 8-bit core.
+ *
+ * This file defines the SipHash class, which computes 64-bit SipHash-2-4
+ * tags over short messages with a 128-bit key, and compares tags in
+ * constant time.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef SIPHASH_H
+#define SIPHASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Cycles one mac() over a challenge (8-byte nonce and an action byte)
+ * may take on the ATmega32U4; the simavr benchmark fails above it.
+ */
+#define SIPHASH_CYCLE_BUDGET 4000
+
+/**
+ * @brief Class computing SipHash-2-4 tags.
+ *
+ * SipHash works on 64-bit words, which avr-gcc handles poorly: 64-bit
+ * shifts are libgcc loops. The kernel keeps each word as two 32-bit halves
+ * instead; rotations by whole bytes become register moves, and the
+ * remaining 1-bit rotations and the 64-bit additions are eight-instruction
+ * carry chains in inline assembly on AVR, plain C elsewhere.
+ */
+class SipHash final
+{
+public:
+  static constexpr uint8_t KEY_LENGTH = 16; ///< Key bytes
+  static constexpr uint8_t TAG_LENGTH = 8;  ///< Tag bytes
+
+  /**
+   * @brief Compute the SipHash-2-4 tag of a message.
+   * @param key KEY_LENGTH key bytes.
+   * @param message Message bytes.
+   * @param length Number of message bytes.
+   * @param tag Destination of TAG_LENGTH bytes, the 64-bit result little-endian.
+   */
+  static void mac(const uint8_t *const key, const uint8_t *const message, const uint8_t length, uint8_t *const tag);
+
+  /**
+   * @brief Compare two byte arrays in time independent of their contents.
+   * @param first First array.
+   * @param second Second array.
+   * @param length Bytes to compare.
+   * @return True if all bytes are equal.
+   */
+  static bool equal(const uint8_t *const first, const uint8_t *const second, const uint8_t length);
+
+private:
+  /**
+   * @brief A 64-bit SipHash word as two halves.
+   */
+  struct Word
+  {
+    uint32_t lo; ///< Bits 0 to 31
+    uint32_t hi; ///< Bits 32 to 63
+  };
+
+  /**
+   * @brief Run SipRounds on the state.
+   * @param v The four state words.
+   * @param count Number of rounds.
+   */
+  static void rounds(Word *const v, uint8_t count);
+
+  /**
+   * @brief Absorb one 8-byte block.
+   * @param v The four state words.
+   * @param m The block as a word.
+   */
+  static void compress(Word *const v, const Word &m);
+}; // end SipHash class
+
+#endif
@@ -17,6 +17,7 @@
 #include <Stream.h>
 #include <FastPin.h>
 #include <FastCircularQueue.h>
+#include <HotPath.h>
 #include "DriverBase.h"
 
 /**
@@ -44,13 +45,127 @@ enum BaudRate : uint8_t
   BAUD_115200 = 7 ///< 115200 baud
 };
 
+/**
+ * @brief Frame format configured at runtime through begin().
+ *
+ * Every frame decoded or encoded branches on the stored parity and stop bits.
+ */
+class RuntimeFrameFormat
+{
+public:
+  /**
+   * @brief Constructs the default 8N1 @ 9600 format.
+   */
+  RuntimeFrameFormat() : m_expectedBits(10)
+  {
+    m_flags.parityType = NONE;
+    m_flags.stopBitCount = 1;
+    m_flags.baudRate = BAUD_9600;
+  }
+
+  /**
+   * @brief Stores the frame format.
+   *
+   * @param baudRate The baud rate for communication.
+   * @param stopBits The number of stop bits.
+   * @param parity The parity mode.
+   * @return Always true, any format is accepted.
+   */
+  bool configure(const BaudRate baudRate, const uint8_t stopBits, const ParityMode parity)
+  {
+    m_flags.stopBitCount = stopBits;
+    m_flags.parityType = parity;
+    m_flags.baudRate = baudRate;
+    m_expectedBits = 1 /*start*/ + 8 /*data*/ + ((parity != NONE) ? 1 : 0) + stopBits;
+    return true;
+  }
+
+  BaudRate baudRate() const { return static_cast<BaudRate>(m_flags.baudRate); }
+  ParityMode parity() const { return static_cast<ParityMode>(m_flags.parityType); }
+  uint8_t stopBits() const { return m_flags.stopBitCount; }
+  uint8_t expectedBits() const { return m_expectedBits; }
+
+private:
+  /**
+   * @brief Bit-packed flags structure to save RAM.
+   */
+  struct SerialFlags
+  {
+    uint8_t parityType : 2;   ///< Parity type: 0=none, 1=even, 2=odd
+    uint8_t stopBitCount : 2; ///< Number of stop bits: 1-3
+    uint8_t baudRate : 3;     ///< Encoded baud rate (see BaudRate enum)
+  } __attribute__((packed));
+
+  SerialFlags m_flags;    ///< Bit-packed structure for serial configuration flags
+  uint8_t m_expectedBits; ///< Number of expected bits per frame
+};
+
+/**
+ * @brief Frame format fixed at compile time.
+ *
+ * Parity and stop bits are template parameters, so the ISR and the decoder
+ * are generated without any format branches. Only the baud rate, which is
+ * used once in begin() to program the timer, stays configurable.
+ *
+ * @tparam PARITY The parity mode.
+ * @tparam STOP_BITS The number of stop bits.
+ */
+template <ParityMode PARITY = NONE, uint8_t STOP_BITS = 1>
+class FixedFrameFormat
+{
+  static_assert((STOP_BITS >= 1) && (STOP_BITS <= 2), "SoftSerial supports 1 or 2 stop bits");
+
+public:
+  /**
+   * @brief Constructs the format with the default 9600 baud rate.
+   */
+  FixedFrameFormat() : m_baudRate(BAUD_9600) {}
+
+  /**
+   * @brief Stores the baud rate and checks the requested frame shape.
+   *
+   * @param baudRate The baud rate for communication.
+   * @param stopBits The number of stop bits, must match STOP_BITS.
+   * @param parity The parity mode, must match PARITY.
+   * @return true if the requested frame shape matches the compiled one.
+   */
+  bool configure(const BaudRate baudRate, const uint8_t stopBits, const ParityMode parity)
+  {
+    m_baudRate = baudRate;
+    return (stopBits == STOP_BITS) && (parity == PARITY);
+  }
+
+  BaudRate baudRate() const { return m_baudRate; }
+  static constexpr ParityMode parity() { return PARITY; }
+  static constexpr uint8_t stopBits() { return STOP_BITS; }
+  static constexpr uint8_t expectedBits() { return 1 /*start*/ + 8 /*data*/ + ((PARITY != NONE) ? 1 : 0) + STOP_BITS; }
+
+private:
+  BaudRate m_baudRate; ///< Configured baud rate
+};
+
 /**
  * @brief Software serial class for asynchronous serial communication.
  *
+ * The pins are template parameters, so the sampling ISR reads and writes
+ * them with single instructions (see StaticFastPin).
+ *
+ * RX follows the sender's clock: every bit boundary should fall between two
+ * samples, and one seen a tick early or late moves the next sample point by
+ * a tick. The average of these corrections per frame is the measured drift,
+ * which also corrects frames with no edge to track, such as 0x00 and 0xFF.
+ *
+ * The first start bit after a quiet line is stamped with micros(), the only
+ * clock read in the ISR, so latency measurements can trace a request back to
+ * its arrival on the wire.
+ *
+ * @tparam RX_PIN Arduino pin number for RX.
+ * @tparam TX_PIN Arduino pin number for TX.
  * @tparam RX_BUFFER_SIZE Size of the RX buffer.
  * @tparam TX_BUFFER_SIZE Size of the TX buffer.
+ * @tparam FORMAT Frame format policy, RuntimeFrameFormat or FixedFrameFormat<>.
  */
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT = RuntimeFrameFormat>
 class SoftSerial : public Stream, public DriverBase
 {
 public:
@@ -60,12 +175,19 @@ public:
   typedef void (*TimerSetupCallback)(const unsigned long period);
 
   /**
-   * @brief Constructs a SoftSerial object with specified RX and TX pins.
+   * @brief Type definition for the timer gate callback function.
    *
-   * @param rxPin The pin number for RX.
-   * @param txPin The pin number for TX.
+   * Called with run=false when the line goes idle: the callback must stop the
+   * sampling timer interrupt and arm the RX start-edge interrupt. Called with
+   * run=true to disarm the edge interrupt and restart the timer half a tick
+   * before its next compare match.
+   */
+  typedef void (*TimerGateCallback)(const bool run);
+
+  /**
+   * @brief Constructs a SoftSerial object and configures its RX and TX pins.
    */
-  SoftSerial(const uint8_t rxPin, const uint8_t txPin);
+  SoftSerial();
 
   /**
    * @brief Initializes the SoftSerial communication with specified parameters.
@@ -85,10 +207,26 @@ public:
    */
   inline void end();
 
+  /**
+   * @brief Enables edge-triggered RX.
+   *
+   * Once set, the sampling timer only runs while a frame is in flight in either
+   * direction. The RX pin must be wired to an external interrupt whose falling
+   * edge handler calls processStartEdge().
+   *
+   * @param timerGateCallback Callback to stop/start the sampling timer.
+   */
+  inline void setTimerGate(TimerGateCallback timerGateCallback);
+
   /**
    * @brief Interrupt Service Routine to handle RX and TX bit processing.
    */
-  inline void processISR();
+  HOT_PATH inline void processISR();
+
+  /**
+   * @brief Start-edge Interrupt Service Routine for edge-triggered RX.
+   */
+  HOT_PATH inline void processStartEdge();
 
   /**
    * @brief Returns the number of bytes available for reading.
@@ -125,28 +263,79 @@ public:
   inline size_t write(uint8_t data) override;
 
   /**
-   * @brief Main loop function to handle RX and TX operations.
+   * @brief Writes a block of bytes to the TX queue.
+   *
+   * @param buffer The bytes to write.
+   * @param size The number of bytes to write.
+   * @return The number of bytes queued, less than size if the TX queue filled up.
    */
-  void loop();
+  inline size_t write(const uint8_t *buffer, size_t size) override;
+
+  using Print::write;
 
-private:
   /**
-   * @brief Bit-packed flags structure to save RAM.
+   * @brief Returns the free space in the TX queue.
+   *
+   * @return The number of bytes write() can queue without dropping.
    */
-  struct SerialFlags
-  {
-    uint8_t parityType : 2;   ///< Parity type: 0=none, 1=even, 2=odd
-    uint8_t stopBitCount : 2; ///< Number of stop bits: 1-3
-    uint8_t baudRate : 3;     ///< Encoded baud rate (see BaudRate enum)
-  } __attribute__((packed));
+  inline int availableForWrite() override;
+
+  /**
+   * @brief Returns the number of bad frames reported by loop() since begin().
+   *
+   * @return Frames with a start, stop or parity error or dropped on a full RX queue, saturating.
+   */
+  inline uint16_t getRxErrorCount() const;
+
+  /**
+   * @brief Returns the RX clock drift measured by the sampling phase tracker.
+   *
+   * @return Net phase corrections per frame, averaged, in 1/16 sampling ticks;
+   *         positive when the sender's bits are longer than ours.
+   */
+  inline int8_t getRxDrift() const { return m_rxDrift; }
+
+  /**
+   * @brief Returns the number of sampling phase corrections since begin().
+   *
+   * @return One-tick moves of the RX sample point, wrapping.
+   */
+  inline uint16_t getRxCorrectionCount() const;
+
+  /**
+   * @brief Returns when the latest RX burst began.
+   *
+   * A burst is the frames after at least RX_BURST_IDLE_TICKS idle sampling
+   * ticks. Only free-running sampling counts idle ticks, with a timer gate
+   * no burst is stamped.
+   *
+   * @return micros() at the start bit of the burst's first frame, 0 before the first burst.
+   */
+  inline uint32_t getRxBurstMicros() const;
+
+  /**
+   * @brief Prints the RX errors, phase corrections and drift on one line.
+   *
+   * @param print The output stream.
+   */
+  void printStatistic(Print &print) const;
+
+  /**
+   * @brief Main loop function to handle RX and TX operations.
+   */
+  void loop();
 
+private:
   // Declare PROGMEM strings for error messages
   static const char SOFT_SERIAL_BAUD_TOO_HIGH[] PROGMEM; ///< Error message for baud rate too high
+  static const char SOFT_SERIAL_FORMAT_ERR[] PROGMEM;    ///< Error message for unsupported frame format
   static const char SOFT_SERIAL_START_BIT_ERR[] PROGMEM; ///< Error message for start bit error
   static const char SOFT_SERIAL_STOP_BIT_ERR[] PROGMEM;  ///< Error message for stop bit error
   static const char SOFT_SERIAL_PARITY_ERR[] PROGMEM;    ///< Error message for parity error
   static const char SOFT_SERIAL_RX_BUF_FULL[] PROGMEM;   ///< Error message for RX buffer full
 
+  static constexpr uint8_t RX_ERROR_QUEUE_SIZE = 4; ///< Error reports buffered between loop() passes
+
   /**
    * @brief Helper method to convert between baud rate and code.
    *
@@ -163,24 +352,71 @@ private:
    */
   static unsigned long getBaudRateValue(const BaudRate code);
 
-  FastCircularQueue<uint8_t, RX_BUFFER_SIZE> m_rxQueue;      ///< RX buffer queue
-  FastCircularQueue<uint8_t, TX_BUFFER_SIZE> m_txQueue;      ///< TX buffer queue
-  FastCircularQueue<uint16_t, RX_BUFFER_SIZE> m_rxTempQueue; ///< Temporary RX buffer queue
+  /**
+   * @brief Builds the TX shift register word of one frame.
+   *
+   * @param data The byte to encode.
+   * @return Frame bits in transmission order, starting at the LSB.
+   */
+  HOT_PATH inline uint16_t makeTxFrame(const uint8_t data) const;
+
+  /**
+   * @brief Checks and stores one sampled RX bit (ISR context).
+   *
+   * @param position Position of the bit in the frame, counting down to 0.
+   * @param rxState Sampled line level.
+   */
+  HOT_PATH inline void sampleRxBit(const uint8_t position, const uint8_t rxState);
+
+  /**
+   * @brief Clears the frame state when a start bit is detected (ISR context).
+   */
+  HOT_PATH inline void startRxFrame();
+
+  /**
+   * @brief Pushes a completed RX frame or records why it was dropped (ISR context).
+   */
+  HOT_PATH inline void finishRxFrame();
+
+  /**
+   * @brief Stops the sampling timer and waits for a start edge (ISR context).
+   */
+  inline void sleepLine();
+
+  /**
+   * @brief Restarts the sampling timer if it is stopped.
+   */
+  inline void wakeLine();
+
+  FastCircularQueue<uint8_t, RX_BUFFER_SIZE> m_rxQueue; ///< RX buffer queue, filled directly by the ISR
+  FastCircularQueue<uint8_t, TX_BUFFER_SIZE> m_txQueue; ///< TX buffer queue, drained directly by the ISR
 
-  uint16_t m_receivedData; ///< Stores received data bits
+  FastCircularQueue<uint8_t, RX_ERROR_QUEUE_SIZE> m_rxErrorQueue; ///< RX error bits, pushed by the ISR and drained by loop()
+
+  uint8_t m_rxData;       ///< Data bits of the frame being received, shifted in LSB first
+  uint8_t m_rxFrameState; ///< Error bits and running parity of the frame being received
+  uint16_t m_rxErrorCount; ///< Bad frames popped from m_rxErrorQueue since begin()
+  uint8_t m_rxLevel;            ///< RX line level at the previous tick of the frame
+  int8_t m_rxFrameCorrection;   ///< Net phase corrections of the frame being received
+  volatile int8_t m_rxDrift;    ///< Average of m_rxFrameCorrection, in 1/16 ticks
+  uint16_t m_rxCorrectionCount; ///< Phase corrections since begin()
+  uint8_t m_rxIdleTicks;        ///< Idle ticks since the last frame, saturating at RX_BURST_IDLE_TICKS
+  uint32_t m_rxBurstMicros;     ///< micros() at the start bit opening the latest burst
 
   volatile uint8_t m_rxBitIndex; ///< Index for RX bit processing
   volatile uint8_t m_txBitIndex; ///< Index for TX bit processing
   uint8_t m_txIsrCounter;        ///< Counter for TX ISR timing
   uint8_t m_rxIsrCounter;        ///< Counter for RX ISR timing
-  uint8_t m_expectedBits;        ///< Number of expected bits per frame
 
-  SerialFlags m_flags; ///< Bit-packed structure for serial configuration flags
+  FORMAT m_format; ///< Frame format (parity, stop bits, baud rate)
+
+  uint16_t m_txFrame; ///< TX shift register, remaining frame bits LSB first (ISR only)
 
-  volatile bool m_txBitChanges[12]; ///< Array to track TX bit changes
+  TimerGateCallback m_timerGate; ///< Timer gate for edge-triggered RX, nullptr for free-running sampling
+  volatile bool m_timerStopped;  ///< True while the sampling timer is gated off waiting for a start edge
 
-  const FastPin m_rxPin; ///< RX pin object
-  const FastPin m_txPin; ///< TX pin object
+  typedef StaticFastPin<RX_PIN> RxPin; ///< RX pin, input with pull-up
+  typedef StaticFastPin<TX_PIN> TxPin; ///< TX pin, output
 };
 
 #include "SoftSerial.hpp"
@@ -17,6 +17,32 @@
 #include <Utilities.h>
 
 #include "TraceLevel.h"
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline int SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::availableForWrite()
+{
+  return m_txQueue.space();
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline uint16_t SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::getRxErrorCount() const
+{
+  return m_rxErrorCount;
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline uint16_t SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::getRxCorrectionCount() const
+{
+  SafeInterrupts::ScopedDisable guard;
+  return m_rxCorrectionCount;
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline uint32_t SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::getRxBurstMicros() const
+{
+  SafeInterrupts::ScopedDisable guard;
+  return m_rxBurstMicros;
+}
+
 #undef CLASS_TRACE_LEVEL
 #define CLASS_TRACE_LEVEL DEBUG_SOFT_SERIAL
 #include "TraceHelper.h"
@@ -40,25 +66,55 @@ constexpr uint8_t UNINITIALIZED_INDEX = 255;
 /** @brief Special index value indicating initialized but inactive state */
 constexpr uint8_t INITIALIZED_INDEX = 254;
 
+/** @brief RX status bit: start bit sampled high */
+constexpr uint8_t RX_START_ERROR = 0x01;
+
+/** @brief RX status bit: stop bit sampled low */
+constexpr uint8_t RX_STOP_ERROR = 0x02;
+
+/** @brief RX status bit: parity mismatch */
+constexpr uint8_t RX_PARITY_ERROR = 0x04;
+
+/** @brief RX status bit: frame dropped because the RX queue was full */
+constexpr uint8_t RX_OVERFLOW = 0x08;
+
+/** @brief RX frame state bit: running parity of the data and parity bits */
+constexpr uint8_t RX_PARITY_ODD = 0x80;
+
+/** @brief Fraction bits of the drift average, 1/16 tick */
+constexpr uint8_t RX_DRIFT_SHIFT = 4;
+
+/** @brief Weight of a new frame in the drift average, 1/8 */
+constexpr uint8_t RX_DRIFT_FILTER = 3;
+
+/** @brief Drift after which a frame without a correction by mid-frame gets one anyway, 1/2 tick */
+constexpr int8_t RX_DRIFT_PREEMPT = 8;
+
+/** @brief Idle sampling ticks after which a start bit opens a new burst, 85 bit times */
+constexpr uint8_t RX_BURST_IDLE_TICKS = 255;
+
 // Define PROGMEM strings for error messages
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-const char SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::SOFT_SERIAL_BAUD_TOO_HIGH[] PROGMEM = "Baud too high";
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+const char SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SOFT_SERIAL_BAUD_TOO_HIGH[] PROGMEM = "Baud too high";
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-const char SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::SOFT_SERIAL_START_BIT_ERR[] PROGMEM = "Start bit err";
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+const char SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SOFT_SERIAL_FORMAT_ERR[] PROGMEM = "Format err";
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-const char SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::SOFT_SERIAL_STOP_BIT_ERR[] PROGMEM = "Stop bit err";
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+const char SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SOFT_SERIAL_START_BIT_ERR[] PROGMEM = "Start bit err";
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-const char SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::SOFT_SERIAL_PARITY_ERR[] PROGMEM = "Parity err";
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+const char SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SOFT_SERIAL_STOP_BIT_ERR[] PROGMEM = "Stop bit err";
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-const char SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::SOFT_SERIAL_RX_BUF_FULL[] PROGMEM = "RX buf full";
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+const char SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SOFT_SERIAL_PARITY_ERR[] PROGMEM = "Parity err";
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+const char SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SOFT_SERIAL_RX_BUF_FULL[] PROGMEM = "RX buf full";
 
 // Implementation of baud rate conversion methods
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-BaudRate SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::getBaudRateCode(const unsigned long baudRate)
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+BaudRate SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::getBaudRateCode(const unsigned long baudRate)
 {
   if (baudRate <= 1200)
     return BAUD_1200;
@@ -77,8 +133,8 @@ BaudRate SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::getBaudRateCode(const unsig
   return BAUD_115200;
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-unsigned long SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::getBaudRateValue(const BaudRate code)
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+unsigned long SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::getBaudRateValue(const BaudRate code)
 {
   switch (code)
   {
@@ -103,42 +159,38 @@ unsigned long SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::getBaudRateValue(const
   }
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::SoftSerial(const uint8_t rxPin, const uint8_t txPin)
-    : Stream(), DriverBase(F("SoftSerial"), static_cast<Level>(DEBUG_SOFT_SERIAL)),
-      m_receivedData(0), m_rxBitIndex(UNINITIALIZED_INDEX), m_txBitIndex(UNINITIALIZED_INDEX),
-      m_txIsrCounter(OVERSAMPLE), m_rxIsrCounter(SAMPLE), m_expectedBits(10),
-      m_rxPin(rxPin, false, true), m_txPin(txPin, true)
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::SoftSerial()
+    : Stream(), DriverBase(TraceComponent::SOFT_SERIAL),
+      m_rxData(0), m_rxFrameState(0), m_rxErrorCount(0),
+      m_rxLevel(LOW), m_rxFrameCorrection(0), m_rxDrift(0), m_rxCorrectionCount(0),
+      m_rxIdleTicks(RX_BURST_IDLE_TICKS), m_rxBurstMicros(0),
+      m_rxBitIndex(UNINITIALIZED_INDEX), m_txBitIndex(UNINITIALIZED_INDEX),
+      m_txIsrCounter(OVERSAMPLE), m_rxIsrCounter(SAMPLE),
+      m_txFrame(0), m_timerGate(nullptr), m_timerStopped(false)
 {
-  // Initialize flags
-  m_flags.parityType = NONE;
-  m_flags.stopBitCount = 1;
-  m_flags.baudRate = BAUD_9600;
-
-  // Initialize bit changes array
-  for (uint8_t i = 0; i < sizeof(m_txBitChanges); i++)
-  {
-    m_txBitChanges[i] = false;
-  }
+  RxPin::setMode(false, true);
+  TxPin::setMode(true);
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::begin(const TimerSetupCallback timerSetupCallback,
-                                                              const BaudRate baudRate,
-                                                              const uint8_t stopBits,
-                                                              const ParityMode parity)
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::begin(const TimerSetupCallback timerSetupCallback,
+                                                                              const BaudRate baudRate,
+                                                                              const uint8_t stopBits,
+                                                                              const ParityMode parity)
 {
   SafeInterrupts::ScopedDisable guard;
 
-  // Store configuration in bit fields
-  m_flags.stopBitCount = stopBits;
-  m_flags.parityType = parity;
-  m_flags.baudRate = baudRate;
+  if (!m_format.configure(baudRate, stopBits, parity))
+  {
+    TRACE_ERROR()
+        << PGMT(SOFT_SERIAL_FORMAT_ERR)
+        << endl;
 
-  // Calculate expected bits
-  m_expectedBits = 1 /*start*/ + 8 /*data*/ + ((parity != NONE) ? 1 : 0) + stopBits;
+    return;
+  }
 
-  const unsigned long actualBaudRate = getBaudRateValue(static_cast<BaudRate>(m_flags.baudRate));
+  const unsigned long actualBaudRate = getBaudRateValue(m_format.baudRate());
   const uint32_t bitPeriod = (F_CPU + (actualBaudRate / 2UL)) / actualBaudRate;
   const uint16_t oversampleBitPeriod = ((bitPeriod + (OVERSAMPLE / 2UL)) / OVERSAMPLE) + 1;
 
@@ -153,191 +205,152 @@ inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::begin(const TimerSetupCa
 
   m_rxQueue.clear();
   m_txQueue.clear();
-  m_rxTempQueue.clear();
-
-  m_txPin.high();
+  m_rxErrorQueue.clear();
+  m_rxErrorCount = 0;
+  m_rxDrift = 0;
+  m_rxCorrectionCount = 0;
+  m_rxIdleTicks = RX_BURST_IDLE_TICKS;
+  m_rxBurstMicros = 0;
+
+  TxPin::high();
   m_txBitIndex = UNINITIALIZED_INDEX;
 
   m_rxBitIndex = INITIALIZED_INDEX;
+  m_timerStopped = false;
 
   timerSetupCallback(oversampleBitPeriod);
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::end()
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::end()
 {
   m_rxBitIndex = UNINITIALIZED_INDEX;
   m_txBitIndex = UNINITIALIZED_INDEX;
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::loop()
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::setTimerGate(const TimerGateCallback timerGateCallback)
+{
+  SafeInterrupts::ScopedDisable guard;
+  m_timerGate = timerGateCallback;
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::sleepLine()
+{
+  m_timerStopped = true;
+  m_timerGate(false);
+
+  // A start bit that began before the edge interrupt was armed would be missed
+  if (RxPin::read() == LOW)
+  {
+    processStartEdge();
+  }
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::wakeLine()
+{
+  SafeInterrupts::ScopedDisable guard;
+  if (m_timerStopped)
+  {
+    m_timerStopped = false;
+    m_timerGate(true);
+  }
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::loop()
 {
   DriverBase::loop();
 
-  for (uint8_t i = 0; (i < 8) && !m_rxQueue.isFull(); i++)
+  // Frames are decoded in the ISR; only report what went wrong since the last pass
+  uint8_t errors;
+  while (m_rxErrorQueue.pop(errors))
   {
-    uint16_t frame;
+    if (m_rxErrorCount != UINT16_MAX)
     {
-      SafeInterrupts::ScopedDisable guard;
-      if (!m_rxTempQueue.pop(frame))
-        break;
+      ++m_rxErrorCount;
     }
 
-    bool hasError = false;
-
-    // In the ISR, bits are stored with decreasing rxBitIndex:
-    // - Start bit is stored at position (m_expectedBits-1) [highest bit]
-    // - Data bits are at positions (m_expectedBits-2) down to (m_expectedBits-9)
-    // - Parity bit (if present) is at position (m_expectedBits-10)
-    // - Stop bits are at positions (m_expectedBits-11) and lower [lowest bits]
-
-    // Check start bit - should be 0 (low)
-    if ((frame & (1 << (m_expectedBits - 1))) != 0)
+    if (errors & RX_START_ERROR)
     {
       TRACE_ERROR()
           << PGMT(SOFT_SERIAL_START_BIT_ERR)
           << endl;
-
-      hasError = true;
     }
 
-    // Check stop bits - should be 1 (high)
-    if (!hasError)
+    if (errors & RX_STOP_ERROR)
     {
-      for (uint8_t s = 0; s < m_flags.stopBitCount; s++)
-      {
-        // Stop bits are at the lowest positions
-        if ((frame & (1 << s)) == 0)
-        {
-          TRACE_ERROR()
-              << PGMT(SOFT_SERIAL_STOP_BIT_ERR)
-              << endl;
-
-          hasError = true;
-          break;
-        }
-      }
-    }
-
-    if (hasError)
-      continue;
-
-    // Extract data bits and reverse their order (UART sends LSB first)
-    uint8_t data = 0;
-    for (uint8_t bitIndex = 0; bitIndex < 8; bitIndex++)
-    {
-      // Data bits are at positions (m_expectedBits-2) to (m_expectedBits-9)
-      const uint8_t isrBitPos = m_expectedBits - 2 - bitIndex;
-
-      // The bit position in the data byte (reverse order because UART sends LSB first)
-      if ((frame & (static_cast<uint16_t>(1) << isrBitPos)) != 0)
-      {
-        data |= (1 << bitIndex);
-      }
+      TRACE_ERROR()
+          << PGMT(SOFT_SERIAL_STOP_BIT_ERR)
+          << endl;
     }
 
-    if (m_flags.parityType != NONE)
+    if (errors & RX_PARITY_ERROR)
     {
-      // Parity bit is at position (m_expectedBits-10)
-      const uint8_t parityBitPos = m_expectedBits - 10;
-      const uint8_t parityBit = (frame & (1 << parityBitPos)) ? 1 : 0;
-
-      bool computedParity = __builtin_parity(data);
-      if (m_flags.parityType == EVEN)
-        computedParity = !computedParity;
-
-      if (parityBit != computedParity)
-      {
-        TRACE_ERROR()
-            << PGMT(SOFT_SERIAL_PARITY_ERR)
-            << endl;
-
-        continue;
-      }
+      TRACE_ERROR()
+          << PGMT(SOFT_SERIAL_PARITY_ERR)
+          << endl;
     }
 
-    if (!m_rxQueue.push(data))
+    if (errors & RX_OVERFLOW)
     {
       TRACE_ERROR()
           << PGMT(SOFT_SERIAL_RX_BUF_FULL)
           << endl;
     }
   }
+}
 
-  if (m_txBitIndex == UNINITIALIZED_INDEX)
-  {
-    uint8_t data;
-    if (m_txQueue.pop(data))
-    {
-      // Reset bit changes
-      for (uint8_t i = 0; i < sizeof(m_txBitChanges); i++)
-      {
-        m_txBitChanges[i] = false;
-      }
-
-      // The ISR processes txBitIndex from high to low (m_expectedBits down to 0)
-      // and toggles the pin when m_txBitChanges[txBitIndex] is true.
-      // We need to populate m_txBitChanges to create the correct UART signal.
-      uint8_t currentBit = m_expectedBits;
-
-      // Initialize with current pin state (high for idle)
-      bool currentState = true;
-
-      // Start bit always requires a transition (high→low)
-      m_txBitChanges[--currentBit] = true;
-      currentState = false; // Pin state after start bit is low
-
-      // Set transitions for data bits (LSB first in UART)
-      for (uint8_t i = 0; i < 8; i++)
-      {
-        const bool bitVal = (data & (1 << i)) != 0;
-        currentBit--;
-        if (bitVal != currentState)
-        {
-          m_txBitChanges[currentBit] = true;
-          currentState = bitVal;
-        }
-      }
-
-      // Set transition for parity bit if needed
-      if (m_flags.parityType != NONE)
-      {
-        bool parityVal = __builtin_parity(data);
-        if (m_flags.parityType == EVEN)
-          parityVal = !parityVal;
-
-        currentBit--;
-        if (parityVal != currentState)
-        {
-          m_txBitChanges[currentBit] = true;
-          currentState = parityVal;
-        }
-      }
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::printStatistic(Print &print) const
+{
+  // A tick is a third of a bit, the average spreads over one frame
+  // 32 bits: the product passes the 16-bit int of the AVR beyond a drift of 32
+  const int16_t driftPermille = static_cast<int16_t>(static_cast<int32_t>(m_rxDrift) * 1000 /
+                                                     static_cast<int16_t>((1 << RX_DRIFT_SHIFT) * OVERSAMPLE * m_format.expectedBits()));
+
+  print.print(F("Serial rx err/fix:"));
+  print.print(m_rxErrorCount);
+  print.print('/');
+  print.print(getRxCorrectionCount());
+  print.print(F(" drift "));
+  print.print(driftPermille);
+  print.println(F(" permille"));
+}
 
-      // First stop bit always transitions to high if not already high
-      currentBit--;
-      if (!currentState)
-      {
-        m_txBitChanges[currentBit] = true;
-      }
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline uint16_t SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::makeTxFrame(const uint8_t data) const
+{
+  // Bits are shifted out LSB first: start bit (0), 8 data bits, optional parity, stop bits (1)
+  uint16_t frame = static_cast<uint16_t>(data) << 1;
+  uint8_t stopShift = 9;
 
-      // TX is processed in reverse order in the ISR, so we need to set the
-      // index to the highest position in our transition array
-      m_txBitIndex = m_expectedBits;
-    }
+  if (m_format.parity() != NONE)
+  {
+    // Even parity makes the number of ones including the parity bit even
+    bool parityVal = __builtin_parity(data);
+    if (m_format.parity() == ODD)
+      parityVal = !parityVal;
+
+    if (parityVal)
+      frame |= static_cast<uint16_t>(1) << 9;
+    stopShift = 10;
   }
+
+  return frame | (((static_cast<uint16_t>(1) << m_format.stopBits()) - 1) << stopShift);
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::processISR()
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::processISR()
 {
   register uint8_t rxBitIndex = m_rxBitIndex;
 
   if (rxBitIndex == UNINITIALIZED_INDEX)
     return;
 
-  const uint8_t rxState = m_rxPin.read();
+  const uint8_t rxState = RxPin::read();
 
   register uint8_t txBitIndex = m_txBitIndex;
   if (txBitIndex != UNINITIALIZED_INDEX)
@@ -346,23 +359,69 @@ inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::processISR()
     {
       m_txIsrCounter = OVERSAMPLE;
 
-      if (txBitIndex > 0)
+      if (txBitIndex == 0)
       {
-        if (m_txBitChanges[--txBitIndex])
+        // Stop bits finished: chain the next queued byte without an idle gap
+        uint8_t data;
+        if (m_txQueue.pop(data))
+        {
+          m_txFrame = makeTxFrame(data);
+          txBitIndex = m_format.expectedBits();
+        }
+        else
         {
-          m_txPin.toggle();
+          txBitIndex = UNINITIALIZED_INDEX;
         }
       }
-      else
+
+      if (txBitIndex != UNINITIALIZED_INDEX)
       {
-        m_txPin.high();
-        txBitIndex = UNINITIALIZED_INDEX;
+        TxPin::set(static_cast<uint8_t>(m_txFrame) & 1);
+        m_txFrame >>= 1;
+        --txBitIndex;
       }
       m_txBitIndex = txBitIndex;
     }
   }
+  else
+  {
+    // Line is idle: start the next queued byte with its start bit right away
+    uint8_t data;
+    if (m_txQueue.pop(data))
+    {
+      m_txFrame = makeTxFrame(data) >> 1;
+      m_txIsrCounter = OVERSAMPLE;
+      TxPin::low();
+      m_txBitIndex = m_format.expectedBits() - 1;
+    }
+  }
+
+  register uint8_t rxIsrCounter = m_rxIsrCounter - 1;
+  register uint8_t rxReload = OVERSAMPLE;
+
+  // Bit boundaries fall midway between samples, on the tick the counter reads 1;
+  // a boundary one tick off moves the sample point one tick after it
+  if ((rxBitIndex < INITIALIZED_INDEX) && (rxState != m_rxLevel))
+  {
+    m_rxLevel = rxState;
+    if (rxIsrCounter == OVERSAMPLE - 1)
+    {
+      // Right after the sample: we sample late, take the next bit one tick early
+      --rxIsrCounter;
+      --m_rxFrameCorrection;
+      ++m_rxCorrectionCount;
+    }
+    else if (rxIsrCounter == 0)
+    {
+      // On the sample tick: we sample early, the next bit waits one tick longer
+      ++rxReload;
+      ++m_rxFrameCorrection;
+      ++m_rxCorrectionCount;
+    }
+  }
+  m_rxIsrCounter = rxIsrCounter;
 
-  if (--m_rxIsrCounter == 0)
+  if (rxIsrCounter == 0)
   {
     m_rxIsrCounter = SAMPLE;
 
@@ -370,56 +429,210 @@ inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::processISR()
     {
       if (rxState == LOW)
       {
-        rxBitIndex = m_expectedBits;
-        m_receivedData = 0;
+        rxBitIndex = m_format.expectedBits();
+        startRxFrame();
         m_rxIsrCounter = OVERSAMPLE_SHIFT;
       }
+      else if (m_rxIdleTicks != RX_BURST_IDLE_TICKS)
+      {
+        ++m_rxIdleTicks;
+      }
     }
     else if (rxBitIndex > 0)
     {
-      m_receivedData |= static_cast<uint16_t>(rxState) << (--rxBitIndex);
+      sampleRxBit(--rxBitIndex, rxState);
+
+      // A frame without an edge correction by mid-frame follows the measured drift
+      if ((rxBitIndex == (m_format.expectedBits() / 2)) && (m_rxFrameCorrection == 0))
+      {
+        const int8_t drift = m_rxDrift;
+        if (drift >= RX_DRIFT_PREEMPT)
+        {
+          ++rxReload;
+          m_rxFrameCorrection = 1;
+          ++m_rxCorrectionCount;
+        }
+        else if (drift <= -RX_DRIFT_PREEMPT)
+        {
+          --rxReload;
+          m_rxFrameCorrection = -1;
+          ++m_rxCorrectionCount;
+        }
+      }
 
       if (rxBitIndex > 0)
       {
-        m_rxIsrCounter = OVERSAMPLE;
+        m_rxIsrCounter = rxReload;
       }
       else
       {
-        m_rxTempQueue.push(m_receivedData);
+        finishRxFrame();
         rxBitIndex = INITIALIZED_INDEX;
       }
     }
     m_rxBitIndex = rxBitIndex;
   }
+
+  // Nothing in flight in either direction: stop sampling until the next start edge
+  if ((m_timerGate != nullptr) && (rxState == HIGH) && (m_rxBitIndex == INITIALIZED_INDEX) &&
+      (m_txBitIndex == UNINITIALIZED_INDEX) && m_txQueue.isEmpty())
+  {
+    sleepLine();
+  }
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::sampleRxBit(const uint8_t position, const uint8_t rxState)
+{
+  // Bits arrive with decreasing position:
+  // - Start bit at position (expectedBits-1)
+  // - Data bits at (expectedBits-2) down to (expectedBits-9), LSB first
+  // - Parity bit (if present) at (expectedBits-10)
+  // - Stop bits at the lowest positions
+  if (position >= (m_format.expectedBits() - 9))
+  {
+    if (position == (m_format.expectedBits() - 1))
+    {
+      if (rxState != LOW)
+        m_rxFrameState |= RX_START_ERROR;
+    }
+    else
+    {
+      // LSB first: shifting right leaves the first data bit in bit 0
+      m_rxData >>= 1;
+      if (rxState != LOW)
+      {
+        m_rxData |= 0x80;
+        m_rxFrameState ^= RX_PARITY_ODD;
+      }
+    }
+  }
+  else if (position >= m_format.stopBits())
+  {
+    if (rxState != LOW)
+      m_rxFrameState ^= RX_PARITY_ODD;
+  }
+  else if (rxState == LOW)
+  {
+    m_rxFrameState |= RX_STOP_ERROR;
+  }
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::finishRxFrame()
+{
+  uint8_t status = m_rxFrameState;
+
+  if (m_format.parity() != NONE)
+  {
+    // Data plus parity bit must hold an even number of ones for EVEN, odd for ODD
+    const bool odd = (status & RX_PARITY_ODD) != 0;
+    if (odd != (m_format.parity() == ODD))
+      status |= RX_PARITY_ERROR;
+  }
+
+  status &= (RX_START_ERROR | RX_STOP_ERROR | RX_PARITY_ERROR);
+  if ((status == 0) && !m_rxQueue.push(m_rxData))
+  {
+    status = RX_OVERFLOW;
+  }
+
+  if (status != 0)
+  {
+    m_rxErrorQueue.push(status);
+  }
+
+  // Loop filter: the corrections of every frame move the drift average by 1/8
+  const int16_t drift = m_rxDrift;
+  const int16_t target = static_cast<int16_t>(m_rxFrameCorrection) * (1 << RX_DRIFT_SHIFT);
+  const int16_t next = drift + ((target - drift) >> RX_DRIFT_FILTER);
+  // Many corrections in one frame must not wrap the average to the other sign
+  m_rxDrift = static_cast<int8_t>(next > INT8_MAX ? INT8_MAX : (next < INT8_MIN ? INT8_MIN : next));
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::startRxFrame()
+{
+  m_rxData = 0;
+  m_rxFrameState = 0;
+  m_rxLevel = LOW;
+  m_rxFrameCorrection = 0;
+
+  // Read the clock once per burst; with a timer gate the idle ticks are never sampled
+  if ((m_rxIdleTicks == RX_BURST_IDLE_TICKS) && (m_timerGate == nullptr))
+  {
+    m_rxBurstMicros = micros();
+  }
+  m_rxIdleTicks = 0;
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline int SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::available()
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::processStartEdge()
+{
+  // Edge flags latched while the timer was running arrive here as stale wake-ups
+  if (!m_timerStopped)
+    return;
+
+  m_timerStopped = false;
+  m_timerGate(true);
+
+  if ((m_rxBitIndex == INITIALIZED_INDEX) && (RxPin::read() == LOW))
+  {
+    // The timer restarts half a tick before its compare match, so two ticks
+    // put the first sample in the middle of the start bit.
+    m_rxBitIndex = m_format.expectedBits();
+    startRxFrame();
+    m_rxIsrCounter = OVERSAMPLE_SHIFT + SAMPLE;
+  }
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline int SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::available()
 {
   return m_rxQueue.available();
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline int SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::read()
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline int SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::read()
 {
   uint8_t data;
   return m_rxQueue.pop(data) ? data : -1;
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline int SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::peek()
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline int SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::peek()
 {
   uint8_t data;
   return m_rxQueue.peek(data) ? data : -1;
 }
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline void SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::flush() {}
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline void SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::flush() {}
 
-template <uint8_t RX_BUFFER_SIZE, uint8_t TX_BUFFER_SIZE>
-inline size_t SoftSerial<RX_BUFFER_SIZE, TX_BUFFER_SIZE>::write(uint8_t data)
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline size_t SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::write(uint8_t data)
 {
-  return m_txQueue.push(data) ? 1 : 0;
+  if (!m_txQueue.push(data))
+    return 0;
+
+  if (m_timerStopped)
+  {
+    wakeLine();
+  }
+  return 1;
+}
+
+template <uint8_t RX_PIN, uint8_t TX_PIN, uint16_t RX_BUFFER_SIZE, uint16_t TX_BUFFER_SIZE, typename FORMAT>
+inline size_t SoftSerial<RX_PIN, TX_PIN, RX_BUFFER_SIZE, TX_BUFFER_SIZE, FORMAT>::write(const uint8_t *buffer, size_t size)
+{
+  // The queue holds at most TX_BUFFER_SIZE - 1 bytes, which also keeps the count in its index type
+  const size_t count = m_txQueue.pushBulk(buffer, (size < TX_BUFFER_SIZE) ? size : (TX_BUFFER_SIZE - 1));
+
+  if ((count > 0) && m_timerStopped)
+  {
+    wakeLine();
+  }
+  return count;
 }
 
 #undef CLASS_TRACE_LEVEL
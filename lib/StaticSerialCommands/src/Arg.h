@@ -22,8 +22,13 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
 
 /**
  * @brief Maximum number of arguments that can be processed.
+ *
+ * Every SerialCommands instance keeps an Args of this size for the line
+ * being received; override with -DMAX_ARGS=... to save RAM.
  */
+#ifndef MAX_ARGS
 #define MAX_ARGS 16
+#endif
 
 /**
  * @brief Get a single character from a string at specific index.
@@ -120,7 +125,8 @@ enum class ArgType : uint8_t
   Null,  ///< Null (no value)
   Int,   ///< Integer value
   Float, ///< Floating point value
-  String ///< String value
+  String, ///< String value
+  Bytes   ///< Length-prefixed byte string received in a binary frame
 };
 
 /**
@@ -131,6 +137,11 @@ union ArgData
   int32_t num;        ///< Integer value
   float num_f;        ///< Floating point value
   const char *string; ///< String value
+  struct
+  {
+    const char *data; ///< First byte of the payload
+    uint8_t length;   ///< Number of payload bytes
+  } bytes;            ///< Byte string value
 };
 
 /**
@@ -165,6 +176,14 @@ public:
   explicit Arg(const char *value)
       : value{.string = value}, type(ArgType::String) {}
 
+  /**
+   * @brief Constructor for a byte string argument.
+   * @param value The first byte of the payload (NUL terminated by the parser).
+   * @param length Number of payload bytes; the payload may contain NUL bytes.
+   */
+  Arg(const char *value, uint8_t length)
+      : value{.bytes = {value, length}}, type(ArgType::Bytes) {}
+
   /**
    * @brief Get the argument value as an integer.
    * @return The integer value.
@@ -192,6 +211,15 @@ public:
     return value.string;
   }
 
+  /**
+   * @brief Get the length of a string or byte string argument.
+   * @return Number of payload bytes.
+   */
+  uint8_t getLength()
+  {
+    return type == ArgType::Bytes ? value.bytes.length : strlen(value.string);
+  }
+
   /**
    * @brief Get the type of the argument.
    * @return The argument type.
@@ -363,7 +391,8 @@ namespace impl
       static const char _int[] PROGMEM = "int";
       static const char _float[] PROGMEM = "float";
       static const char _string[] PROGMEM = "string";
-      static const char *const types[] PROGMEM{_null, _int, _float, _string};
+      static const char _bytes[] PROGMEM = "bytes";
+      static const char *const types[] PROGMEM{_null, _int, _float, _string, _bytes};
       return (PGM_P)pgm_read_word(&(types[(int)type]));
     }
 
@@ -28,6 +28,32 @@ class SerialCommands;
 
 namespace impl
 {
+  /**
+   * @brief One character step of the command name hash (16-bit FNV-1a).
+   * @param hash Hash of the characters so far.
+   * @param c Next character.
+   * @return Hash including c.
+   */
+  constexpr uint16_t commandHashStep(const uint16_t hash, const char c)
+  {
+    return static_cast<uint16_t>(static_cast<uint16_t>(hash ^ static_cast<uint8_t>(c)) * 0x0193u);
+  }
+
+  /**
+   * @brief Hash of a command name.
+   *
+   * Evaluated at compile time for the names given to COMMAND(), so the
+   * table carries it in PROGMEM next to the name.
+   *
+   * @param name NUL-terminated command name.
+   * @param hash Hash of the characters before name.
+   * @return Hash of the whole name.
+   */
+  constexpr uint16_t commandHash(const char *name, const uint16_t hash = 0x9DC5)
+  {
+    return (*name == '\0') ? hash : commandHash(name + 1, commandHashStep(hash, *name));
+  }
+
   /**
    * @brief Internal implementation of the Command structure.
    *
@@ -47,6 +73,7 @@ namespace impl
     void (*function)(SerialCommands &, Args &);                        ///< Callback function to execute
     const void *subcommands;                                           ///< Pointer to subcommands array
     const uint16_t subcommandsCount;                                   ///< Number of subcommands
+    const uint16_t commandHash;                                        ///< commandHash() of the name
     const char command[commandLength];                                 ///< Command name string
     const char description[descriptionLength];                         ///< Command description string
     const ArgConstraint args[argCount];                                ///< Array of argument constraints
@@ -119,6 +146,15 @@ public:
     return (*_getCommandPgmFn)(_command);
   }
 
+  /**
+   * @brief Get the precomputed hash of the command name from PROGMEM.
+   * @return impl::commandHash() of the name.
+   */
+  uint16_t getCommandHash() const
+  {
+    return pgm_read_word(&(_command->commandHash));
+  }
+
   /**
    * @brief Get the command description from PROGMEM.
    * @return The description as a PROGMEM string pointer.
@@ -41,6 +41,7 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
             function,                                                                           \
             subcommands,                                                                        \
             sizeof(subcommands) / sizeof(Command),                                              \
+            impl::commandHash(command),                                                         \
             command,                                                                            \
             description,                                                                        \
         {                                                                                       \
@@ -8,14 +8,19 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
 #include "StaticSerialCommands.h"
 
 void SerialCommands::printCommand(const Command &command)
+{
+  printCommand(*serial, command);
+}
+
+void SerialCommands::printCommand(Print &output, const Command &command)
 {
   if (command.hasParent())
   {
-    printCommand(command.getParent());
-    serial->print(' ');
+    printCommand(output, command.getParent());
+    output.print(' ');
   }
 
-  printFromPgm(command.getCommandPgm());
+  printFromPgm(output, command.getCommandPgm());
 
   uint8_t count = 0;
   const impl::ArgConstraint *argcs = command.getArgsPgm(&count);
@@ -23,16 +28,28 @@ void SerialCommands::printCommand(const Command &command)
   for (uint16_t j = 0; j < count; ++j)
   {
     memcpy_P(&argc, &argcs[j], sizeof(impl::ArgConstraint));
-    serial->print(' ');
-    serial->print('<');
-    printFromPgm(argc.getNamePgm());
-    serial->print('>');
+    output.print(' ');
+    output.print('<');
+    printFromPgm(output, argc.getNamePgm());
+    output.print('>');
   }
 }
 
 void SerialCommands::printCommandDescription(const Command &command)
 {
-  printFromPgm(command.getDescriptionPgm());
+  printFromPgm(*serial, command.getDescriptionPgm());
+}
+
+bool SerialCommands::listCommand(Print &output, uint16_t index)
+{
+  if (index >= commandsCount)
+    return false;
+
+  printCommand(output, commands[index]);
+  output.print(F(" - "));
+  printFromPgm(output, commands[index].getDescriptionPgm());
+  output.println();
+  return true;
 }
 
 void SerialCommands::listCommands(const Command *commands, uint16_t commandsCount)
@@ -68,51 +85,230 @@ void SerialCommands::listAllCommands(const Command *commands, uint16_t commandsC
 
 void SerialCommands::readSerial()
 {
-  static uint16_t index = 0;
-  static uint64_t lastTime = millis();
-
   if (timeout != 0 && lastTime + timeout < millis())
   {
-    index = 0;
+    resetLine();
+    discard = 0;
   }
 
   while (serial->available())
   {
+    // Leave the input queued until the replies so far have drained
+    if (outputReserve != 0 && serial->availableForWrite() < outputReserve)
+      return;
+
     lastTime = millis();
     int ch = serial->read();
-    if (isTerm(ch))
+    if (discard > 0)
+    {
+      discard--;
+    }
+    else if (index > 0 && (static_cast<uint8_t>(buffer[0]) & CMD_BINARY_FLAG))
     {
-      if (index > 0)
+      if (index == 1 && 2u + ch > bufferSize)
+      {
+        serial->println(F("ERROR: Buffer overflow"));
+        discard = ch;
+        index = 0;
+        continue;
+      }
+      buffer[index] = ch;
+      index++;
+      if (index == 2u + static_cast<uint8_t>(buffer[1]))
       {
-        buffer[index] = '\0';
-        parseCommand(buffer);
+        parseBinaryCommand(buffer);
         index = 0;
       }
     }
-    else if (index < bufferSize)
+    else if (index == 0 && !inToken && lineCommand == nullptr && !lineFailed && (ch & CMD_BINARY_FLAG))
     {
       buffer[index] = ch;
       index++;
     }
+    else if (isTerm(ch))
+    {
+      endLine();
+    }
+    else if (!lineFailed)
+    {
+      receiveTextByte(ch);
+    }
+  }
+}
+
+void SerialCommands::receiveTextByte(char ch)
+{
+  if ((quote != '\0') ? (ch == quote) : isDelim(ch))
+  {
+    // A delimiter ends a plain token, only its quotation char ends a quoted one
+    if (inToken)
+      endToken();
+    return;
+  }
+
+  // Leave room for the token's NUL
+  if (index + 1u >= bufferSize)
+  {
+    serial->println(F("ERROR: Buffer overflow"));
+    lineFailed = true;
+    return;
+  }
+
+  if (!inToken)
+  {
+    inToken = true;
+    tokenStart = index;
+    if (isQuotation(ch))
+    {
+      quote = ch;
+      return;
+    }
+  }
+  buffer[index] = ch;
+  index++;
+}
+
+void SerialCommands::endToken()
+{
+  buffer[index] = '\0';
+  index++;
+  inToken = false;
+  quote = '\0';
+  processToken(buffer + tokenStart);
+}
+
+void SerialCommands::processToken(const char *token)
+{
+  if (lineCommand != nullptr)
+  {
+    uint8_t argCount;
+    const impl::ArgConstraint *argcs = lineCommand->getArgsPgm(&argCount);
+    if (commandArg < argCount)
+    {
+      if (argIndex >= MAX_ARGS)
+      {
+        serial->println(F("ERROR: Too many arguments"));
+        printCommand(*lineCommand);
+        serial->println();
+        lineFailed = true;
+        return;
+      }
+
+      impl::ArgConstraint argc;
+      memcpy_P(&argc, &argcs[commandArg], sizeof(impl::ArgConstraint));
+      if (!getArg(lineArgs[argIndex], token, argc))
+      {
+        serial->print(F("ERROR: Can't parse argument "));
+        serial->println(argIndex + 1);
+        printCommand(*lineCommand);
+        serial->println();
+        lineFailed = true;
+        return;
+      }
+      if (!argc.isInRange(lineArgs[argIndex]))
+      {
+        serial->print(F("ERROR: Argument out of range "));
+        serial->print(argIndex + 1);
+        impl::Range range = argc.getRange();
+        serial->print(F(" ("));
+        serial->print(range.minimum);
+        serial->print(F(" - "));
+        serial->print(range.maximum);
+        serial->println(')');
+        printCommand(*lineCommand);
+        serial->println();
+        lineFailed = true;
+        return;
+      }
+      argIndex++;
+      commandArg++;
+      return;
+    }
+  }
+
+  // All arguments are in, so the token names a (sub)command
+  const Command *cmds = commands;
+  uint16_t cmdsCount = commandsCount;
+  if (lineCommand != nullptr)
+  {
+    lineCommand->getSubCommands(&cmds, &cmdsCount);
+    if (cmds == nullptr)
+    {
+      serial->println(F("ERROR: Too many arguments"));
+      printCommand(*lineCommand);
+      serial->println();
+      lineFailed = true;
+      return;
+    }
+  }
+
+  const Command *cmd = findCommand(token, cmds, cmdsCount);
+  if (cmd == nullptr)
+  {
+    serial->print(F("ERROR: Command does not exist \""));
+    serial->print(token);
+    serial->println('"');
+    lineFailed = true;
+    return;
+  }
+  lineCommand = cmd;
+  commandArg = 0;
+}
+
+void SerialCommands::endLine()
+{
+  if (inToken && !lineFailed)
+    endToken();
+
+  if (lineCommand != nullptr && !lineFailed)
+  {
+    uint8_t argCount;
+    lineCommand->getArgsPgm(&argCount);
+    if (commandArg < argCount)
+    {
+      serial->println(F("ERROR: Not enough arguments"));
+      printCommand(*lineCommand);
+      serial->println();
+    }
     else
     {
-      serial->println(F("ERROR: Buffer overflow"));
-      index = 0;
+      dispatch(*lineCommand, lineArgs);
     }
   }
+  resetLine();
+}
+
+void SerialCommands::resetLine()
+{
+  index = 0;
+  inToken = false;
+  quote = '\0';
+  lineFailed = false;
+  lineCommand = nullptr;
+  commandArg = 0;
+  argIndex = 0;
 }
 
 const Command *SerialCommands::findCommand(const char *const string, const Command *commands, uint16_t commandsCount)
 {
-  uint16_t len = strlen(string);
+  uint16_t len = 0;
+  uint16_t hash = impl::commandHash("");
+  for (const char *c = string; *c != '\0'; ++c, ++len)
+    hash = impl::commandHashStep(hash, *c);
+
+  // Exact match: one word compared per command, the name only on a hash hit
+  for (uint16_t i = 0; i < commandsCount; ++i)
+  {
+    if (commands[i].getCommandHash() == hash && memcmp_P(string, commands[i].getCommandPgm(), len + 1) == 0)
+      return &commands[i];
+  }
+
+  // Slow path: an unambiguous prefix
   uint16_t index;
   uint16_t count = 0;
   for (uint16_t i = 0; i < commandsCount; ++i)
   {
-    PGM_P cmd = commands[i].getCommandPgm();
-    if (memcmp_P(string, cmd, len + 1) == 0)
-      return &commands[i];
-    if (memcmp_P(string, cmd, len) == 0)
+    if (memcmp_P(string, commands[i].getCommandPgm(), len) == 0)
     {
       ++count;
       index = i;
@@ -123,140 +319,159 @@ const Command *SerialCommands::findCommand(const char *const string, const Comma
   return nullptr;
 }
 
-bool SerialCommands::processArguments(const Command *cmd, char **string, Args &args, uint8_t &argIndex)
+void SerialCommands::parseBinaryCommand(char *frame)
 {
+  const uint8_t opcode = static_cast<uint8_t>(frame[0]) & ~CMD_BINARY_FLAG;
+  if (opcode >= commandsCount)
+  {
+    serial->print(F("ERROR: Command does not exist #"));
+    serial->println(opcode);
+    return;
+  }
+
+  const Command *cmd = &commands[opcode];
+  Args args{};
+  char *data = frame + 2;
+  uint8_t remaining = static_cast<uint8_t>(frame[1]);
   uint8_t argCount;
   const impl::ArgConstraint *argcs = cmd->getArgsPgm(&argCount);
   impl::ArgConstraint argc;
   for (uint8_t i = 0; i < argCount; ++i)
   {
     memcpy_P(&argc, &argcs[i], sizeof(impl::ArgConstraint));
-    char *token = getToken(string);
-    if (token == nullptr)
+    if (!getBinaryArg(args[i], &data, remaining, argc))
     {
       serial->println(F("ERROR: Not enough arguments"));
       printCommand(*cmd);
       serial->println();
-      return false;
-    }
-    if (!getArg(args[argIndex], token, argc))
-    {
-      serial->print(F("ERROR: Can't parse argument "));
-      serial->println(argIndex + 1);
-      printCommand(*cmd);
-      serial->println();
-      return false;
+      return;
     }
-    if (!argc.isInRange(args[argIndex]))
+    if (!argc.isInRange(args[i]))
     {
       serial->print(F("ERROR: Argument out of range "));
-      serial->print(argIndex + 1);
-      impl::Range range = argc.getRange();
-      serial->print(F(" ("));
-      serial->print(range.minimum);
-      serial->print(F(" - "));
-      serial->print(range.maximum);
-      serial->println(')');
+      serial->println(i + 1);
       printCommand(*cmd);
       serial->println();
-      return false;
+      return;
     }
-    argIndex++;
   }
-  return true;
+
+  if (remaining != 0)
+  {
+    serial->println(F("ERROR: Too many arguments"));
+    printCommand(*cmd);
+    serial->println();
+    return;
+  }
+  dispatch(*cmd, args);
 }
 
-void SerialCommands::parseCommand(char *string)
+void SerialCommands::dispatch(const Command &cmd, Args &args)
 {
-  char *token;
-  uint8_t argIndex = 0;
-  Args args{};
-  const Command *cmd = nullptr;
-  const Command *cmds = this->commands;
-  uint16_t cmdsCount = commandsCount;
-
-  token = getToken(&string);
-  while (token != nullptr)
+#if SERIAL_COMMANDS_STATISTICS
+  if (statistics != nullptr)
   {
-    cmd = findCommand(token, cmds, cmdsCount);
-    if (cmd != nullptr)
-    {
-      if (!processArguments(cmd, &string, args, argIndex))
-        return;
+    // Subcommands count for the top-level command, the one with an entry
+    Command top = cmd;
+    while (top.hasParent())
+      top = top.getParent();
 
-      cmd->getSubCommands(&cmds, &cmdsCount);
-      token = getToken(&string);
-      if (cmds == nullptr)
+    for (uint16_t i = 0; i < commandsCount; ++i)
+    {
+      if (Command(commands[i]).get() == top.get())
       {
-        if (token != nullptr)
+        CommandStatistic &entry = statistics[i];
+        if (entry.count != UINT16_MAX)
+          ++entry.count;
+        MEASURE_TIME(entry.time)
         {
-          serial->println(F("ERROR: Too many arguments"));
-          printCommand(*cmd);
-          serial->println();
-          return;
+          cmd.runCommand(*this, args);
         }
-        cmd->runCommand(*this, args);
-        return;
-      }
-      else if (token == nullptr)
-      {
-        cmd->runCommand(*this, args);
         return;
       }
     }
-    else
-    {
-      serial->print(F("ERROR: Command does not exist \""));
-      serial->print(token);
-      serial->println('"');
-      return;
-    }
   }
+#endif
+  cmd.runCommand(*this, args);
 }
 
-char *SerialCommands::getToken(char **stringp)
+#if SERIAL_COMMANDS_STATISTICS
+void SerialCommands::setStatistics(CommandStatistic *statistics)
 {
-  char *begin, *end;
-  begin = *stringp;
-  if (begin == nullptr)
-    return nullptr;
+  this->statistics = statistics;
+  if (statistics == nullptr)
+    return;
 
-  while (isDelim(*begin))
-    begin++;
+  for (uint16_t i = 0; i < commandsCount; ++i)
+    statistics[i].time.setName(reinterpret_cast<const __FlashStringHelper *>(commands[i].getCommandPgm()));
+}
 
-  if (isQuotation(*begin))
-  {
-    const char quote = *begin;
-    begin++;
-    end = begin;
-    while (*end != quote && *end != '\0')
-      end++;
+bool SerialCommands::printStatistic(Print &output, uint16_t index) const
+{
+  if (statistics == nullptr || index >= commandsCount)
+    return false;
 
-    if (*end == quote)
-    {
-      *end = '\0';
-      end++;
-    }
-  }
-  else
+  const CommandStatistic &entry = statistics[index];
+  if (entry.count != 0)
   {
-    end = begin;
-    while (!isDelim(*end) && *end != '\0')
-      end++;
+    entry.time.print(output);
+    output.print(F(" runs:"));
+    output.println(entry.count);
   }
+  return true;
+}
+#endif
 
-  while (isDelim(*end))
+bool SerialCommands::getBinaryArg(Arg &out, char **data, uint8_t &remaining, const impl::ArgConstraint &arg)
+{
+  switch (arg.type)
   {
-    *end = '\0';
-    end++;
+  case ArgType::String:
+  case ArgType::Bytes:
+  {
+    if (remaining == 0)
+      return false;
+    const uint8_t length = static_cast<uint8_t>((*data)[0]);
+    if (length >= remaining)
+      return false;
+    // Shift the bytes over the length prefix so the string can be NUL terminated in place
+    memmove(*data, *data + 1, length);
+    (*data)[length] = '\0';
+    out = Arg(*data, length);
+    *data += length + 1;
+    remaining -= length + 1;
+    return true;
   }
 
-  if (*end != '\0')
-    *stringp = end;
-  else
-    *stringp = nullptr;
+  case ArgType::Int:
+  case ArgType::Float:
+  {
+    if (remaining < 4)
+      return false;
+    uint32_t raw = 0;
+    for (uint8_t i = 4; i > 0; --i)
+    {
+      raw = (raw << 8) | static_cast<uint8_t>((*data)[i - 1]);
+    }
+    if (arg.type == ArgType::Int)
+    {
+      out = Arg(static_cast<int32_t>(raw));
+    }
+    else
+    {
+      float value_f;
+      memcpy(&value_f, &raw, sizeof(value_f));
+      out = Arg(value_f);
+    }
+    *data += 4;
+    remaining -= 4;
+    return true;
+  }
 
-  return begin;
+  default:
+    break;
+  }
+  return false;
 }
 
 bool SerialCommands::getArg(Arg &out, const char *string, const impl::ArgConstraint &arg)
@@ -264,6 +479,7 @@ bool SerialCommands::getArg(Arg &out, const char *string, const impl::ArgConstra
   switch (arg.type)
   {
   case ArgType::String:
+  case ArgType::Bytes:
     out = Arg(string);
     return true;
 
@@ -295,7 +511,7 @@ bool SerialCommands::getArg(Arg &out, const char *string, const impl::ArgConstra
   return false;
 }
 
-void SerialCommands::printFromPgm(PGM_P str)
+void SerialCommands::printFromPgm(Print &output, PGM_P str)
 {
-  serial->print(reinterpret_cast<const __FlashStringHelper *>(str));
+  output.print(reinterpret_cast<const __FlashStringHelper *>(str));
 }
@@ -23,6 +23,29 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
 #include <Arduino.h>
 #include "Command.h"
 
+/**
+ * @brief Set to 1 to count and time the dispatches of each command.
+ *
+ * Each registered command then needs a CommandStatistic in RAM, about 30
+ * bytes plus two per Statistic histogram bucket, see setStatistics().
+ */
+#ifndef SERIAL_COMMANDS_STATISTICS
+#define SERIAL_COMMANDS_STATISTICS 0
+#endif
+
+#if SERIAL_COMMANDS_STATISTICS
+#include <Statistic.h>
+
+/**
+ * @brief Dispatch counters of one registered command.
+ */
+struct CommandStatistic
+{
+  uint16_t count = 0; ///< Dispatches, saturating
+  Statistic time;     ///< Handler run time, named after the command
+};
+#endif
+
 /**
  * @brief Macro to create a SerialCommands instance with a given serial port and command array.
  * @param serial The serial port to use.
@@ -50,6 +73,14 @@ Repository     : https://github.com/naszly/Arduino-StaticSerialCommands
  */
 #define CMD_TERM_2 '\r'
 
+/**
+ * @brief Marker bit of the first byte of a binary command frame.
+ *
+ * A binary frame is `[CMD_BINARY_FLAG | command index][payload length][payload]`.
+ * Text commands never start with a byte that has this bit set.
+ */
+#define CMD_BINARY_FLAG 0x80
+
 /**
  * @brief Main class for handling serial commands.
  *
@@ -108,6 +139,14 @@ public:
    */
   void printCommand(const Command &command);
 
+  /**
+   * @brief Print a command's syntax to any output.
+   *
+   * @param output Where to print.
+   * @param command The command to print.
+   */
+  void printCommand(Print &output, const Command &command);
+
   /**
    * @brief Print a command's description.
    *
@@ -147,6 +186,27 @@ public:
     listCommands(commands, commandsCount);
   }
 
+  /**
+   * @brief Print one line of listCommands() to any output.
+   *
+   * For output written a line at a time, e.g. from a report generator.
+   *
+   * @param output Where to print.
+   * @param index Index of the registered command.
+   * @return false if index is past the last command.
+   */
+  bool listCommand(Print &output, uint16_t index);
+
+  /**
+   * @brief Get the number of registered commands.
+   *
+   * @return Number of commands listCommand() prints.
+   */
+  uint16_t getCommandCount() const
+  {
+    return commandsCount;
+  }
+
   /**
    * @brief List all registered commands and subcommands recursively.
    *
@@ -161,9 +221,48 @@ public:
    * @brief Read and process commands from the serial interface.
    *
    * This method should be called regularly to check for and process incoming commands.
+   * Both text lines and binary frames (see CMD_BINARY_FLAG) are accepted.
    */
   void readSerial();
 
+  /**
+   * @brief Hold input back while the output is short of room.
+   *
+   * readSerial() stops taking bytes while fewer than @p bytes can be
+   * written, so commands wait in the input stream instead of losing their
+   * replies. The stream must report availableForWrite().
+   *
+   * @param bytes Room needed to take more input, 0 to never wait (default).
+   */
+  void setOutputReserve(uint8_t bytes)
+  {
+    outputReserve = bytes;
+  }
+
+#if SERIAL_COMMANDS_STATISTICS
+  /**
+   * @brief Count and time the dispatches of the registered commands.
+   *
+   * Entry i belongs to registered command i and is named after it. A
+   * subcommand counts for its top-level command. Only the handler is
+   * timed, output it leaves to the main loop is not.
+   *
+   * @param statistics getCommandCount() entries, nullptr to stop counting.
+   */
+  void setStatistics(CommandStatistic *statistics);
+
+  /**
+   * @brief Print the dispatch statistic of one registered command.
+   *
+   * Prints nothing for a command never dispatched.
+   *
+   * @param output Where to print.
+   * @param index Index of the registered command.
+   * @return false if index is past the last command or no statistics are set.
+   */
+  bool printStatistic(Print &output, uint16_t index) const;
+#endif
+
   /**
    * @brief Get the Stream object used for communication.
    *
@@ -244,6 +343,23 @@ private:
   const Command *commands;      ///< Array of registered commands
   const uint16_t commandsCount; ///< Number of registered commands
   const uint16_t timeout;       ///< Timeout for command input
+  uint16_t index = 0;           ///< Number of bytes collected in the buffer
+  uint16_t discard = 0;         ///< Bytes left of an oversized binary frame
+  unsigned long lastTime = 0;   ///< Time the last byte was received
+  uint8_t outputReserve = 0;    ///< Output room needed to take input, see setOutputReserve()
+#if SERIAL_COMMANDS_STATISTICS
+  CommandStatistic *statistics = nullptr; ///< Entries parallel to commands, see setStatistics()
+#endif
+
+  // Text line tokenized as it arrives
+  uint16_t tokenStart = 0;               ///< Buffer index of the token being received
+  char quote = '\0';                     ///< Quotation char of the open quoted token, '\0' if none
+  bool inToken = false;                  ///< A token is being received
+  bool lineFailed = false;               ///< An error was reported, the rest of the line is dropped
+  const Command *lineCommand = nullptr;  ///< Deepest command matched on the line
+  uint8_t commandArg = 0;                ///< Arguments of lineCommand parsed so far
+  uint8_t argIndex = 0;                  ///< Arguments parsed on the line
+  Args lineArgs{};                       ///< Arguments parsed on the line
 
   /**
    * @brief Default delimiter predicate.
@@ -266,6 +382,9 @@ private:
   /**
    * @brief Find a command by name in the command array.
    *
+   * Exact names are matched through the hash stored with each command,
+   * an unambiguous prefix of a name is the fallback.
+   *
    * @param string The command name to find.
    * @param commands Array of commands to search.
    * @param commandsCount Number of commands in the array.
@@ -274,47 +393,87 @@ private:
   const Command *findCommand(const char *const string, const Command *commands, uint16_t commandsCount);
 
   /**
-   * @brief Parse and execute a command string.
+   * @brief Store a byte of a text line, splitting it into tokens.
+   *
+   * Delimiters end the token in place with a NUL, so string arguments
+   * point into the buffer.
    *
-   * @param string The command string to parse.
+   * @param ch The received byte (not a terminator).
    */
-  void parseCommand(char *string);
+  void receiveTextByte(char ch);
 
   /**
-   * @brief Get the next token from a string.
+   * @brief End the token being received and process it.
+   */
+  void endToken();
+
+  /**
+   * @brief Match a token as a command or parse it as the next argument.
    *
-   * @param stringp Pointer to string pointer (modified).
-   * @return Pointer to the token or nullptr if no more tokens.
+   * Errors are reported right away and drop the rest of the line.
+   *
+   * @param token The NUL-terminated token.
    */
-  char *getToken(char **stringp);
+  void processToken(const char *token);
 
   /**
-   * @brief Parse an argument from a string according to a constraint.
+   * @brief Run the command of a completed text line and reset the line state.
+   */
+  void endLine();
+
+  /**
+   * @brief Forget the text line being received.
+   */
+  void resetLine();
+
+  /**
+   * @brief Parse and execute a binary command frame.
+   *
+   * The opcode is the index of the command in the registered array; subcommands
+   * are not reachable in binary mode. String arguments are encoded as
+   * `[length][bytes]` and handed to the callback as ArgType::Bytes, integer and
+   * float arguments as 4 little-endian bytes.
+   *
+   * @param frame The complete frame, including the opcode and length bytes.
+   */
+  void parseBinaryCommand(char *frame);
+
+  /**
+   * @brief Run a parsed command, counting it when statistics are set.
+   *
+   * @param cmd The command or subcommand to run.
+   * @param args Its parsed arguments.
+   */
+  void dispatch(const Command &cmd, Args &args);
+
+  /**
+   * @brief Decode an argument from a binary frame payload.
    *
    * @param out Output argument.
-   * @param string The string to parse.
+   * @param data Pointer to the payload pointer (advanced past the argument).
+   * @param remaining Number of payload bytes left (decremented).
    * @param arg The argument constraint.
-   * @return true if parsing was successful, false otherwise.
+   * @return true if enough bytes were left to decode the argument, false otherwise.
    */
-  bool getArg(Arg &out, const char *string, const impl::ArgConstraint &arg);
+  bool getBinaryArg(Arg &out, char **data, uint8_t &remaining, const impl::ArgConstraint &arg);
 
   /**
-   * @brief Process command arguments.
+   * @brief Parse an argument from a string according to a constraint.
    *
-   * @param cmd The command to process arguments for.
-   * @param string Pointer to the command string (modified).
-   * @param args Output arguments.
-   * @param argIndex Current argument index (modified).
-   * @return true if all arguments were successfully processed, false otherwise.
+   * @param out Output argument.
+   * @param string The string to parse.
+   * @param arg The argument constraint.
+   * @return true if parsing was successful, false otherwise.
    */
-  bool processArguments(const Command *cmd, char **string, Args &args, uint8_t &argIndex);
+  bool getArg(Arg &out, const char *string, const impl::ArgConstraint &arg);
 
   /**
    * @brief Print a string from program memory.
    *
+   * @param output Where to print.
    * @param str Pointer to the string in program memory.
    */
-  void printFromPgm(PGM_P str);
+  static void printFromPgm(Print &output, PGM_P str);
 
   /**
    * @brief Check if a character matches any of the specified characters.
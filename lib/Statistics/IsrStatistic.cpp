@@ -0,0 +1,117 @@
+/**
+ * @file IsrStatistic.cpp
+ * @brief Implementation of the IsrStatistic class.
+ *
+ * This file contains the implementation of the IsrStatistic class methods for
+ * accounting the CPU time spent in interrupt service routines.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#include "IsrStatistic.h"
+
+#if STATISTIC_ISR_LOAD
+
+#include <util/atomic.h>
+
+/**
+ * @brief Constructor that initializes the statistics object.
+ */
+IsrStatistic::IsrStatistic()
+    : name(nullptr), windowStart(0), entryTime(0), busyTicks(0), calls(0),
+      maxTicks(0), rate(0), load(0), peakLoad(0)
+{
+}
+
+/**
+ * @brief Sets a name for this statistic.
+ *
+ * @param n The name stored in program memory.
+ */
+void IsrStatistic::setName(const __FlashStringHelper *n)
+{
+    name = n;
+}
+
+/**
+ * @brief Closes the measurement window once it has elapsed.
+ *
+ * Takes the window's busy cycles and call count from the ISR side in one
+ * atomic step and converts them into a call rate and a load in 0.01 %.
+ * A late call only stretches the window, the figures stay exact.
+ */
+void IsrStatistic::loop()
+{
+    const uint32_t now = Statistic::now();
+    const uint32_t window = now - windowStart;
+    if (window < WINDOW_TICKS)
+        return;
+
+    uint32_t busy = 0;
+    uint16_t count = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        busy = busyTicks;
+        count = calls;
+        busyTicks = 0;
+        calls = 0;
+    }
+    windowStart = now;
+
+    // Shift both sides so busy * 10000 stays in 32 bits
+    const uint32_t share = (busy >> 8) * 10000ul / (window >> 8);
+    load = share > 10000 ? 10000 : static_cast<uint16_t>(share);
+    if (load > peakLoad)
+        peakLoad = load;
+
+    const uint32_t windowMs = window / (F_CPU / 1000L);
+    const uint32_t perSecond = static_cast<uint32_t>(count) * 1000ul / windowMs;
+    rate = perSecond > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(perSecond);
+}
+
+/**
+ * @brief Prints call rate, load and the longest handler run.
+ *
+ * Outputs the name (or "?" if not set), the calls per second and the load
+ * of the last window, the peak window load and the longest run in cycles.
+ *
+ * @param print The Print object to use for output (e.g., Serial).
+ */
+void IsrStatistic::print(Print &print) const
+{
+    uint16_t longest = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        longest = maxTicks;
+    }
+
+    print.print(name ? name : F("?"));
+    print.print(':');
+    print.print(rate);
+    print.print(F("/s, cpu:"));
+    printLoad(print, load);
+    print.print(F(", peak:"));
+    printLoad(print, peakLoad);
+    print.print(F(", max:"));
+    print.print(longest);
+    print.println(F(" cy"));
+}
+
+/**
+ * @brief Prints a load in 0.01 % as a percentage with two decimals.
+ *
+ * @param print The Print object to use for output.
+ * @param load The load in 0.01 %.
+ */
+void IsrStatistic::printLoad(Print &print, const uint16_t load)
+{
+    print.print(load / 100);
+    print.print('.');
+    const uint8_t fraction = load % 100;
+    if (fraction < 10)
+        print.print('0');
+    print.print(fraction);
+    print.print('%');
+}
+
+#endif // STATISTIC_ISR_LOAD
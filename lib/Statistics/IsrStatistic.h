@@ -0,0 +1,125 @@
+/**
+ * @file IsrStatistic.h
+ * @brief CPU load accounting for interrupt service routines.
+ *
+ * This file defines the IsrStatistic class, which counts the cycles spent in
+ * an interrupt handler with the Timer3 clock of Statistic and turns them into
+ * a rolling CPU load figure.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+#ifndef ISRSTATISTIC_H
+#define ISRSTATISTIC_H
+
+#include <Arduino.h>
+#include "Statistic.h"
+
+/**
+ * @brief Set to 1 to account the cycles spent in instrumented ISRs.
+ *
+ * Needs STATISTIC_CLOCK_TIMER3. Costs two Timer3 reads and a 32-bit add per
+ * interrupt; with 0 MEASURE_ISR() compiles to a plain block.
+ */
+#ifndef STATISTIC_ISR_LOAD
+#define STATISTIC_ISR_LOAD 0
+#endif
+
+#if STATISTIC_ISR_LOAD
+
+/**
+ * @brief Length of one ISR load window in milliseconds.
+ */
+#ifndef STATISTIC_ISR_WINDOW_MS
+#define STATISTIC_ISR_WINDOW_MS 250
+#endif
+
+static_assert(STATISTIC_CLOCK_TIMER3, "STATISTIC_ISR_LOAD needs STATISTIC_CLOCK_TIMER3");
+
+/**
+ * @brief Class for collecting the CPU load of one interrupt handler.
+ *
+ * enter() and exit() run inside the ISR with interrupts off and only touch
+ * the low Timer3 word, so a handler may take up to 65535 cycles. loop()
+ * closes a window every STATISTIC_ISR_WINDOW_MS and derives the call rate
+ * and the share of CPU time spent in the handler. The ISR prologue and, for
+ * attachInterrupt() callbacks, the core's dispatch are not included.
+ */
+class IsrStatistic
+{
+public:
+  /**
+   * @brief Constructor that initializes the statistics object.
+   */
+  IsrStatistic();
+
+  /**
+   * @brief Sets a name for this statistic.
+   *
+   * @param n The name stored in program memory.
+   */
+  void setName(const __FlashStringHelper *n);
+
+  /**
+   * @brief Marks the start of the handler, call from the ISR only.
+   */
+  inline void enter()
+  {
+    entryTime = TCNT3;
+  }
+
+  /**
+   * @brief Marks the end of the handler, call from the ISR only.
+   */
+  inline void exit()
+  {
+    const uint16_t elapsed = TCNT3 - entryTime;
+    busyTicks += elapsed;
+    ++calls;
+    if (elapsed > maxTicks)
+      maxTicks = elapsed;
+  }
+
+  /**
+   * @brief Closes the measurement window once it has elapsed.
+   */
+  void loop();
+
+  /**
+   * @brief Prints call rate, load and the longest handler run.
+   *
+   * @param print The Print object to use for output (e.g., Serial).
+   */
+  void print(Print &print) const;
+
+private:
+  static void printLoad(Print &print, const uint16_t load);
+
+  /// Length of one load window in clock ticks
+  static const uint32_t WINDOW_TICKS = static_cast<uint32_t>(STATISTIC_ISR_WINDOW_MS) * (F_CPU / 1000L);
+
+  const __FlashStringHelper *name; ///< Name of this statistic
+  uint32_t windowStart;            ///< Clock at the start of the current window
+  uint16_t entryTime;              ///< Low Timer3 word at handler entry
+  volatile uint32_t busyTicks;     ///< Handler cycles in the current window
+  volatile uint16_t calls;         ///< Handler runs in the current window
+  volatile uint16_t maxTicks;      ///< Longest handler run in cycles
+  uint16_t rate;                   ///< Handler runs per second in the last window
+  uint16_t load;                   ///< CPU share of the last window in 0.01 %
+  uint16_t peakLoad;               ///< Highest window load in 0.01 %
+};
+
+/**
+ * @brief Macro for measuring a block inside an ISR.
+ *
+ * @param obj The IsrStatistic object to use for measurement.
+ */
+#define MEASURE_ISR(obj) for (bool _run = (obj.enter(), true); _run; _run = false, obj.exit())
+
+#else
+
+#define MEASURE_ISR(obj)
+
+#endif // STATISTIC_ISR_LOAD
+
+#endif // ISRSTATISTIC_H
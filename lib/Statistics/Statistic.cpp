@@ -11,6 +11,20 @@
 #include "Statistic.h"
 #include <limits.h>
 
+Statistic *Statistic::active = nullptr;
+
+#if STATISTIC_CLOCK_TIMER3
+volatile uint16_t Statistic::clockHigh = 0;
+
+/**
+ * @brief Extends the Timer3 count to 32 bits.
+ */
+ISR(TIMER3_OVF_vect)
+{
+    ++Statistic::clockHigh;
+}
+#endif
+
 /**
  * @brief Constructor that initializes the statistics object.
  *
@@ -25,16 +39,45 @@ Statistic::Statistic()
 /**
  * @brief Resets all collected statistics.
  *
- * Sets name to nullptr, startTime to 0, minTime to maximum possible value,
- * maxTime to 0, and average to 0.
+ * Sets name and parent to nullptr, startTime to 0, minTime to maximum
+ * possible value, maxTime, the last interval, the averages, the overflow count, the
+ * total and the histogram to 0. Must not be called while a measurement is open.
  */
 void Statistic::reset()
 {
     name = nullptr;
+    parent = nullptr;
     startTime = 0;
+    childTicks = 0;
+    total = 0;
     minTime = UINT16_MAX;
     maxTime = 0;
+    last = 0;
     average = 0;
+    selfAverage = 0;
+    overflows = 0;
+    depth = 0;
+#if STATISTIC_HISTOGRAM_BUCKETS
+    memset(buckets, 0, sizeof(buckets));
+#endif
+}
+
+/**
+ * @brief Starts the Timer3 clock, a no-op with micros().
+ *
+ * Normal mode, no prescaler, overflow interrupt on. Call once from setup()
+ * before the first measurement.
+ */
+void Statistic::setupClock()
+{
+#if STATISTIC_CLOCK_TIMER3
+    TCCR3A = 0;
+    TCCR3B = 0;
+    TCNT3 = 0;
+    TIFR3 = _BV(TOV3);
+    TIMSK3 = _BV(TOIE3);
+    TCCR3B = _BV(CS30);
+#endif
 }
 
 /**
@@ -50,35 +93,86 @@ void Statistic::setName(const __FlashStringHelper *n)
 /**
  * @brief Marks the start of a timing measurement.
  *
- * Records the current time (lower 16 bits of micros()) as the start time.
+ * Records the current time as the start time and the innermost open
+ * measurement as the parent. Nested calls on an open object only count depth.
  */
 void Statistic::start()
 {
-    startTime = (uint16_t)micros(); // Store lower 16 bits
+    if (depth++ != 0)
+        return;
+
+    parent = active;
+    active = this;
+    childTicks = 0;
+    startTime = now();
 }
 
 /**
  * @brief Marks the end of a timing measurement and updates statistics.
  *
- * Calculates the elapsed time, handles timer wraparound, and updates the
- * minimum, maximum, and average statistics.
+ * Only the end() matching the outermost start() measures. Calculates the
+ * elapsed time, adds it to the parent's child time and records it.
  */
 void Statistic::end()
 {
-    uint16_t currentTime = (uint16_t)micros();
-    uint16_t elapsed;
+    // Unsigned subtraction handles clock wraparound
+    const uint32_t elapsedTicks = now() - startTime;
+    if (depth == 0 || --depth != 0)
+        return;
+
+    active = parent;
+    if (parent != nullptr)
+        parent->childTicks += elapsedTicks;
 
-    // Handle timer wraparound
-    if (currentTime >= startTime)
+    record(elapsedTicks / TICKS_PER_US, (elapsedTicks - childTicks) / TICKS_PER_US);
+}
+
+/**
+ * @brief Adds an interval measured outside start()/end().
+ *
+ * For latencies whose start and end are stamped in different contexts, e.g.
+ * an edge interrupt and the code reacting to it. The sample has no children,
+ * so its self time is the interval itself. Must not race start()/end() or
+ * another add() on the same object.
+ *
+ * @param elapsedUs The interval in microseconds.
+ */
+void Statistic::add(const uint32_t elapsedUs)
+{
+    record(elapsedUs, elapsedUs);
+}
+
+/**
+ * @brief Updates the statistics with one interval.
+ *
+ * Clamps intervals that do not fit 16 bits and counts them as overflows, and
+ * updates the minimum, maximum, average and self time statistics and the
+ * histogram. The total takes the unclamped interval.
+ *
+ * @param elapsedLong The interval in microseconds.
+ * @param selfLong The interval less child time in microseconds.
+ */
+void Statistic::record(const uint32_t elapsedLong, const uint32_t selfLong)
+{
+    uint16_t elapsed = static_cast<uint16_t>(elapsedLong);
+    total += elapsedLong;
+    const uint16_t self = selfLong > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(selfLong);
+
+    if (elapsedLong > UINT16_MAX)
     {
-        elapsed = currentTime - startTime;
+        elapsed = UINT16_MAX;
+        if (overflows < UINT16_MAX)
+            ++overflows;
     }
+#if STATISTIC_HISTOGRAM_BUCKETS
     else
     {
-        elapsed = UINT16_MAX - startTime + currentTime + 1;
+        addToHistogram(elapsed);
     }
+#endif
 
     // Update statistics
+    last = elapsed;
     if (elapsed < minTime)
         minTime = elapsed;
     if (elapsed > maxTime)
@@ -86,18 +180,43 @@ void Statistic::end()
 
     // Exponential moving average calculation
     average = average - (average >> ALPHA) + (elapsed >> ALPHA);
+    selfAverage = selfAverage - (selfAverage >> ALPHA) + (self >> ALPHA);
+}
+
+/**
+ * @brief Gets the time since the open measurement started.
+ *
+ * Safe to call from an interrupt, e.g. to see how long a stalled region has
+ * been running.
+ *
+ * @return Microseconds since start(), clamped to 65535, or 0 when not open.
+ */
+uint16_t Statistic::getRunning() const
+{
+    if (depth == 0)
+        return 0;
+
+    const uint32_t running = (now() - startTime) / TICKS_PER_US;
+    return running > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(running);
 }
 
 /**
  * @brief Prints collected statistics to the specified output.
  *
- * Outputs the name (or "?" if not set) followed by the minimum, average,
- * and maximum times in microseconds.
+ * Outputs the name (or "?" if not set), indented two spaces per parent,
+ * followed by the minimum, average, and maximum times in microseconds, the
+ * average self time without child measurements and the overflow count. With the
+ * histogram enabled a second line holds the p50/p99/p999 bucket upper
+ * bounds (65535 meaning an overflow) and a third the bucket counts.
  *
  * @param print The Print object to use for output (e.g., Serial).
  */
 void Statistic::print(Print &print) const
 {
+    for (const Statistic *p = parent; p != nullptr; p = p->parent)
+    {
+        print.print(F("  "));
+    }
     print.print(name ? name : F("?"));
     print.print(':');
     print.print(minTime);
@@ -105,5 +224,95 @@ void Statistic::print(Print &print) const
     print.print(average);
     print.print('/');
     print.print(maxTime);
+    print.print(F(" us, self:"));
+    print.print(selfAverage);
+    print.print(F(" us, over:"));
+    print.println(overflows);
+
+#if STATISTIC_HISTOGRAM_BUCKETS
+    print.print(F(" p50/p99/p999<="));
+    print.print(percentile(500));
+    print.print('/');
+    print.print(percentile(990));
+    print.print('/');
+    print.print(percentile(999));
     print.println(F(" us"));
+
+    print.print(F(" log2 from <"));
+    print.print(1u << FIRST_BUCKET_BITS);
+    print.print(':');
+    for (uint8_t i = 0; i < STATISTIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        print.print(' ');
+        print.print(buckets[i]);
+    }
+    print.println();
+#endif
+}
+
+#if STATISTIC_HISTOGRAM_BUCKETS
+/**
+ * @brief Counts an interval in its log2 bucket.
+ *
+ * The bucket is the bit length of the interval less FIRST_BUCKET_BITS, so
+ * everything below 2^FIRST_BUCKET_BITS us shares bucket 0. When a bucket
+ * saturates, all buckets are halved to keep their proportions.
+ *
+ * @param elapsed The interval in microseconds.
+ */
+void Statistic::addToHistogram(const uint16_t elapsed)
+{
+    uint8_t bits = 0;
+    uint16_t value = elapsed;
+    if (value >> 8)
+    {
+        bits = 8;
+        value >>= 8;
+    }
+    while (value)
+    {
+        ++bits;
+        value >>= 1;
+    }
+
+    const uint8_t bucket = bits <= FIRST_BUCKET_BITS ? 0 : bits - FIRST_BUCKET_BITS;
+    if (buckets[bucket] == UINT16_MAX)
+    {
+        for (uint8_t i = 0; i < STATISTIC_HISTOGRAM_BUCKETS; ++i)
+        {
+            buckets[i] >>= 1;
+        }
+    }
+    ++buckets[bucket];
+}
+
+/**
+ * @brief Finds the bucket holding a percentile.
+ *
+ * Overflows count as the slowest samples.
+ *
+ * @param perMille The percentile in 1/1000.
+ * @return The bucket's upper bound in microseconds, 65535 for overflows or no samples.
+ */
+uint16_t Statistic::percentile(const uint16_t perMille) const
+{
+    uint32_t total = overflows;
+    for (uint8_t i = 0; i < STATISTIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        total += buckets[i];
+    }
+    if (total == 0)
+        return UINT16_MAX;
+
+    // Smallest rank at or above the percentile
+    const uint32_t rank = (total * perMille + 999) / 1000;
+    uint32_t count = 0;
+    for (uint8_t i = 0; i < STATISTIC_HISTOGRAM_BUCKETS; ++i)
+    {
+        count += buckets[i];
+        if (count >= rank)
+            return static_cast<uint16_t>((1ul << (FIRST_BUCKET_BITS + i)) - 1);
+    }
+    return UINT16_MAX;
 }
+#endif
@@ -13,6 +13,37 @@
 #define STATISTIC_H
 
 #include <Arduino.h>
+#include <util/atomic.h>
+
+/**
+ * @brief Number of log2 latency buckets per Statistic, 0 disables the histogram.
+ *
+ * Bucket 0 holds every interval below 2^(17 - N) us, each following bucket one
+ * power of two more, and the last one reaches 65535 us. Longer intervals are
+ * counted as overflows.
+ */
+#ifndef STATISTIC_HISTOGRAM_BUCKETS
+#define STATISTIC_HISTOGRAM_BUCKETS 0
+#endif
+
+/**
+ * @brief Set to 1 to time with a free-running Timer3 instead of micros().
+ *
+ * Timer3 then counts CPU cycles with no prescaler and Statistic owns it along
+ * with its overflow interrupt (one every 4.096 ms at 16 MHz). Start and end
+ * stamps cost a few register reads instead of a micros() call.
+ */
+#ifndef STATISTIC_CLOCK_TIMER3
+#define STATISTIC_CLOCK_TIMER3 0
+#endif
+
+#if STATISTIC_CLOCK_TIMER3 && !defined(TCCR3B)
+#error "STATISTIC_CLOCK_TIMER3 needs a 16-bit Timer3"
+#endif
+
+static_assert(STATISTIC_HISTOGRAM_BUCKETS == 0 ||
+                  (STATISTIC_HISTOGRAM_BUCKETS >= 8 && STATISTIC_HISTOGRAM_BUCKETS <= 16),
+              "STATISTIC_HISTOGRAM_BUCKETS must be 0 or 8..16");
 
 /**
  * @brief Class for collecting timing statistics.
@@ -20,6 +51,16 @@
  * This class provides functionality to measure execution times and track
  * minimum, maximum, and average times. It uses an exponential moving average
  * for the average calculation to minimize memory usage.
+ *
+ * Intervals longer than 16 bits of microseconds are clamped to 65535 us and
+ * counted as overflows instead of wrapping. With STATISTIC_HISTOGRAM_BUCKETS
+ * set, every interval also lands in a log2 bucket and print() adds the
+ * p50/p99/p999 bucket bounds, so rare stalls stand out from steady loops.
+ *
+ * Measurements nest: a start() inside another open measurement makes that
+ * one the parent, whose time includes the child's, and print() indents the
+ * child and shows the parent's self time without it. A start() on an object
+ * that is already open only counts depth, the outermost pair is measured.
  */
 class Statistic
 {
@@ -29,6 +70,47 @@ public:
    */
   Statistic();
 
+  /**
+   * @brief Starts the Timer3 clock, a no-op with micros().
+   */
+  static void setupClock();
+
+  /**
+   * @brief Reads the measurement clock.
+   *
+   * @return Timer3 cycles or micros(), wrapping at 32 bits.
+   */
+  static inline uint32_t now()
+  {
+#if STATISTIC_CLOCK_TIMER3
+    uint16_t low = 0;
+    uint16_t high = 0;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      low = TCNT3;
+      high = clockHigh;
+      // An overflow not yet serviced belongs before a low count
+      if ((TIFR3 & _BV(TOV3)) && low < 0x8000)
+        ++high;
+    }
+    return (static_cast<uint32_t>(high) << 16) | low;
+#else
+    return micros();
+#endif
+  }
+
+  /// Clock ticks per microsecond
+#if STATISTIC_CLOCK_TIMER3
+  static const uint8_t TICKS_PER_US = F_CPU / 1000000L;
+#else
+  static const uint8_t TICKS_PER_US = 1;
+#endif
+
+#if STATISTIC_CLOCK_TIMER3
+  /// Upper clock word, advanced by the Timer3 overflow interrupt
+  static volatile uint16_t clockHigh;
+#endif
+
   /**
    * @brief Sets a name for this statistic.
    *
@@ -36,6 +118,13 @@ public:
    */
   void setName(const __FlashStringHelper *n);
 
+  /**
+   * @brief Gets the name of this statistic.
+   *
+   * @return The name stored in program memory, nullptr if not set.
+   */
+  const __FlashStringHelper *getName() const { return name; }
+
   /**
    * @brief Resets all collected statistics.
    */
@@ -51,6 +140,67 @@ public:
    */
   void end();
 
+  /**
+   * @brief Adds an interval measured outside start()/end().
+   *
+   * @param elapsedUs The interval in microseconds.
+   */
+  void add(const uint32_t elapsedUs);
+
+  /// Minimum measured time in microseconds, 65535 before the first sample
+  uint16_t getMin() const { return minTime; }
+  /// Maximum measured time in microseconds
+  uint16_t getMax() const { return maxTime; }
+  /// Exponential moving average in microseconds
+  uint16_t getAverage() const { return average; }
+  /// Exponential moving average less child time in microseconds
+  uint16_t getSelfAverage() const { return selfAverage; }
+  /// Intervals longer than 65535 us, saturating
+  uint16_t getOverflows() const { return overflows; }
+  /// Sum of all intervals in microseconds, unclamped and wrapping; differences measure a stretch of work
+  uint32_t getTotal() const { return total; }
+
+#if STATISTIC_HISTOGRAM_BUCKETS
+  /**
+   * @brief Gets one histogram bucket.
+   *
+   * @param bucket Bucket index, below STATISTIC_HISTOGRAM_BUCKETS.
+   * @return The bucket count.
+   */
+  uint16_t getBucket(const uint8_t bucket) const { return buckets[bucket]; }
+
+  /// Bucket 0 ends at 2^FIRST_BUCKET_BITS - 1 us
+  static const uint8_t FIRST_BUCKET_BITS = 17 - STATISTIC_HISTOGRAM_BUCKETS;
+#endif
+
+  /**
+   * @brief Gets the last measured interval.
+   *
+   * @return The interval in microseconds, clamped to 65535.
+   */
+  uint16_t getLast() const { return last; }
+
+  /**
+   * @brief Gets the time since the open measurement started.
+   *
+   * @return Microseconds since start(), clamped to 65535, or 0 when not open.
+   */
+  uint16_t getRunning() const;
+
+  /**
+   * @brief Gets the innermost open measurement.
+   *
+   * @return The statistic, or nullptr outside every measurement.
+   */
+  static const Statistic *getActive() { return active; }
+
+  /**
+   * @brief Gets the measurement that was open when this one last started.
+   *
+   * @return The enclosing statistic, or nullptr at the outermost level.
+   */
+  const Statistic *getParent() const { return parent; }
+
   /**
    * @brief Prints collected statistics to the specified output.
    *
@@ -59,12 +209,30 @@ public:
   void print(Print &print) const;
 
 private:
+  void record(const uint32_t elapsedLong, const uint32_t selfLong);
+#if STATISTIC_HISTOGRAM_BUCKETS
+  void addToHistogram(const uint16_t elapsed);
+  uint16_t percentile(const uint16_t perMille) const;
+#endif
+
   const __FlashStringHelper *name; ///< Name of this statistic
-  uint16_t startTime;              ///< Start time in microseconds (lower 16 bits of micros())
+  Statistic *parent;               ///< Enclosing measurement when last started
+  uint32_t startTime;              ///< Start time in clock ticks
+  uint32_t childTicks;             ///< Ticks spent in child measurements since start()
+  uint32_t total;                  ///< Sum of all intervals in microseconds, wrapping
   uint16_t minTime;                ///< Minimum measured time in microseconds
   uint16_t maxTime;                ///< Maximum measured time in microseconds
+  uint16_t last;                   ///< Last interval in microseconds
   uint16_t average;                ///< Exponential moving average in microseconds
+  uint16_t selfAverage;            ///< Exponential moving average less child time in microseconds
+  uint16_t overflows;              ///< Intervals longer than 65535 us, saturating
+  uint8_t depth;                   ///< Open start() calls on this object
+#if STATISTIC_HISTOGRAM_BUCKETS
+  uint16_t buckets[STATISTIC_HISTOGRAM_BUCKETS]; ///< log2 interval counts, halved together on saturation
+#endif
   static const uint8_t ALPHA = 4;  ///< Weight for new samples (1/16) in EMA calculation
+
+  static Statistic *active;        ///< Innermost open measurement
 };
 
 /**
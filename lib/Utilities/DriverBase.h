@@ -15,6 +15,7 @@
 #include <Arduino.h>
 #include "Utilities.h"
 #include "Traceable.h"
+#include <LoopClock.h>
 
 /**
  * @brief Base class for all drivers
@@ -27,7 +28,7 @@ public:
     /**
      * @brief Default constructor
      */
-    DriverBase(const __FlashStringHelper *const functionName, const Level compileTimeLevel) : Traceable(functionName, compileTimeLevel) {}
+    explicit DriverBase(const TraceComponent component) : Traceable(component) {}
 
     /**
      * @brief Destructor
@@ -49,8 +50,9 @@ protected:
      * @brief Template class for managing state with change time tracking
      *
      * @tparam T The type of the state enum
+     * @tparam Clock Time source, MillisClock or LoopClock (see LoopClock.h)
      */
-    template <typename T>
+    template <typename T, typename Clock = MillisClock>
     class StateManager
     {
     public:
@@ -59,7 +61,7 @@ protected:
          *
          * @param initialState The initial state
          */
-        explicit StateManager(const T initialState) : m_state(initialState), m_lastChangeTime(millis()) {}
+        explicit StateManager(const T initialState) : m_state(initialState), m_lastChangeTime(Clock::millis()) {}
 
         /**
          * @brief Get the current state
@@ -81,7 +83,7 @@ protected:
         {
             if (Utilities::changeState(m_state, newState))
             {
-                m_lastChangeTime = millis();
+                m_lastChangeTime = Clock::millis();
                 return true;
             }
             return false;
@@ -94,7 +96,7 @@ protected:
          */
         unsigned long timeInState() const
         {
-            return millis() - m_lastChangeTime;
+            return Clock::millis() - m_lastChangeTime;
         }
 
         /**
@@ -0,0 +1,93 @@
+/**
+ * @file ReportWriter.cpp
+ * @brief Implementation of the non-blocking report writer.
+ */
+
+#include "ReportWriter.h"
+
+/**
+ * @brief Reset the generator to the first line of the first block.
+ */
+bool ReportWriter::start(Print &output, RenderFunction render)
+{
+    if (isBusy())
+        return false;
+
+    p_output = &output;
+    p_render = render;
+    m_rowLength = 0;
+    m_rowSent = 0;
+    m_block = 0;
+    m_line = 0;
+    return true;
+}
+
+/**
+ * @brief Draw the next line once the current one is out, then write what fits.
+ */
+void ReportWriter::loop()
+{
+    if (!isBusy())
+        return;
+
+    if (m_rowSent == m_rowLength && !renderRow())
+    {
+        p_render = nullptr;
+        return;
+    }
+
+    const int room = p_output->availableForWrite();
+    if (room <= 0)
+        return;
+
+    size_t length = m_rowLength - m_rowSent;
+    if (length > static_cast<size_t>(room))
+        length = room;
+    m_rowSent += p_output->write(reinterpret_cast<const uint8_t *>(m_row) + m_rowSent, length);
+}
+
+/**
+ * @brief Keep only the wanted line while a block is drawn.
+ *
+ * A cut line keeps its newline in the last byte.
+ */
+size_t ReportWriter::write(uint8_t c)
+{
+    if (m_linesSeen == m_line)
+    {
+        if (m_rowLength < REPORT_WRITER_ROW_SIZE)
+            m_row[m_rowLength++] = c;
+        else if (c == '\n')
+            m_row[REPORT_WRITER_ROW_SIZE - 1] = c;
+    }
+    if (c == '\n')
+        ++m_linesSeen;
+    return 1;
+}
+
+/**
+ * @brief Draw blocks until one yields the wanted line.
+ *
+ * @return false at the end of the report.
+ */
+bool ReportWriter::renderRow()
+{
+    while (true)
+    {
+        m_rowLength = 0;
+        m_rowSent = 0;
+        m_linesSeen = 0;
+        if (!p_render(*this, m_block))
+            return false;
+
+        if (m_rowLength > 0)
+        {
+            ++m_line;
+            return true;
+        }
+
+        // Block exhausted, or drew nothing
+        ++m_block;
+        m_line = 0;
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file ReportWriter.h
+ * @brief Non-blocking, line-at-a-time report output.
+ *
+ * This file contains the ReportWriter class, which turns a multi-line report
+ * into a generator that loop() advances one line per pass, and only as far
+ * as the destination reports room through availableForWrite().
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <Arduino.h>
+#include <Print.h>
+
+/**
+ * @brief Longest report line kept, longer lines are cut.
+ */
+#ifndef REPORT_WRITER_ROW_SIZE
+#define REPORT_WRITER_ROW_SIZE 96
+#endif
+
+/**
+ * @class ReportWriter
+ * @brief Emits a report produced by a render function one line per loop pass.
+ *
+ * The report is a sequence of blocks drawn by the render function with the
+ * usual Print calls. For every line the writer draws the current block
+ * again and keeps only the wanted line in a row buffer, so no report source
+ * needs a resumable form of its own. Each line reflects the values when it
+ * was drawn.
+ */
+class ReportWriter : private Print
+{
+public:
+    /**
+     * @brief Draws one block of a report.
+     *
+     * @param print Where to draw.
+     * @param block Block index, counting from 0.
+     * @return false once @p block is past the end of the report.
+     */
+    typedef bool (*RenderFunction)(Print &print, const uint8_t block);
+
+    ReportWriter() {}
+
+    /**
+     * @brief Starts a report unless one is already running.
+     *
+     * @param output Destination, queried with availableForWrite().
+     * @param render Function drawing the report blocks.
+     * @return false if a report is still being written.
+     */
+    bool start(Print &output, RenderFunction render);
+
+    /**
+     * @brief Checks if a report is still being written.
+     */
+    bool isBusy() const { return p_render != nullptr; }
+
+    /**
+     * @brief Checks if a report is still being written to @p output.
+     */
+    bool isWritingTo(const Print &output) const { return isBusy() && p_output == &output; }
+
+    /**
+     * @brief Write as much of the current line as the destination takes.
+     */
+    void loop();
+
+private:
+    ReportWriter(const ReportWriter &) = delete;
+    ReportWriter &operator=(const ReportWriter &) = delete;
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    bool renderRow();
+
+    Print *p_output = nullptr;
+    RenderFunction p_render = nullptr;
+    char m_row[REPORT_WRITER_ROW_SIZE];
+    uint8_t m_rowLength = 0; // Bytes of the current line in m_row
+    uint8_t m_rowSent = 0;   // Bytes of the current line written
+    uint8_t m_block = 0;     // Block being written
+    uint8_t m_line = 0;      // Line of the block to write next
+    uint8_t m_linesSeen = 0; // Lines drawn so far while rendering
+};
+
+#endif // REPORT_WRITER_H
@@ -0,0 +1,67 @@
+/**
+ * @file ResponseBuilder.cpp
+ * @brief Implementation of the buffered command reply.
+ */
+
+#include "ResponseBuilder.h"
+
+static const char hexChars[] PROGMEM = "0123456789ABCDEF";
+
+void ResponseBuilder::hex(const byte value)
+{
+    if (m_capacity - m_length < 2)
+    {
+        m_overflow = true;
+        return;
+    }
+    p_buffer[m_length++] = pgm_read_byte(&hexChars[value >> 4]);
+    p_buffer[m_length++] = pgm_read_byte(&hexChars[value & 0x0F]);
+}
+
+void ResponseBuilder::hex(const byte *data, const size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        hex(data[i]);
+    }
+}
+
+void ResponseBuilder::ok()
+{
+    print(F("\r\nOK\r\n"));
+}
+
+/**
+ * @brief Hand the whole reply over at once, so the link packs it densely.
+ */
+bool ResponseBuilder::send(Print &output)
+{
+    const bool sent = output.write(p_buffer, m_length) == m_length && !m_overflow;
+    m_length = 0;
+    m_overflow = false;
+    return sent;
+}
+
+size_t ResponseBuilder::write(uint8_t c)
+{
+    if (m_length >= m_capacity)
+    {
+        m_overflow = true;
+        return 0;
+    }
+    p_buffer[m_length++] = c;
+    return 1;
+}
+
+size_t ResponseBuilder::write(const uint8_t *buffer, size_t size)
+{
+    const size_t room = m_capacity - m_length;
+    if (size > room)
+    {
+        m_overflow = true;
+        size = room;
+    }
+    memcpy(p_buffer + m_length, buffer, size);
+    m_length += size;
+    return size;
+}
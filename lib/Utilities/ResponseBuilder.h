@@ -0,0 +1,100 @@
+/**
+ * @file ResponseBuilder.h
+ * @brief Command replies composed in RAM and written in one piece.
+ *
+ * This file contains the ResponseBuilder class, a Print over a fixed buffer
+ * with hex and OK helpers, and ResponseBuilderN, which provides the buffer
+ * on the stack of the command callback.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef RESPONSE_BUILDER_H
+#define RESPONSE_BUILDER_H
+
+#include <Arduino.h>
+#include <Print.h>
+
+/**
+ * @class ResponseBuilder
+ * @brief Collects a reply, then hands it to the output with one write().
+ *
+ * Replies printed piece by piece reach a piped stream one virtual write()
+ * per byte. Composed here first, the usual print() calls, hex() and ok()
+ * only copy into the buffer; send() does the one bulk write. Bytes past
+ * the buffer are dropped and reported by send().
+ */
+class ResponseBuilder : public Print
+{
+public:
+    /**
+     * @brief Appends a byte as two upper-case hex digits.
+     *
+     * @param value The byte to append.
+     */
+    void hex(const byte value);
+
+    /**
+     * @brief Appends a byte array as hex digits, without separators.
+     *
+     * @param data The bytes to append.
+     * @param length Number of bytes.
+     */
+    void hex(const byte *data, const size_t length);
+
+    /**
+     * @brief Appends the standard OK end of a reply, as Utilities::printOK().
+     */
+    void ok();
+
+    /**
+     * @brief Writes the reply to @p output and empties the buffer.
+     *
+     * @param output Destination, written with a single write().
+     * @return false if the reply did not fit the buffer or the output.
+     */
+    bool send(Print &output);
+
+    size_t write(uint8_t c) override final;
+    size_t write(const uint8_t *buffer, size_t size) override final;
+    int availableForWrite() override final { return m_capacity - m_length; }
+    using Print::write;
+
+protected:
+    /**
+     * @brief Constructor taking the buffer of the derived class.
+     *
+     * @param buffer Reply buffer.
+     * @param capacity Size of @p buffer in bytes.
+     */
+    ResponseBuilder(uint8_t *const buffer, const uint8_t capacity)
+        : p_buffer(buffer), m_capacity(capacity), m_length(0), m_overflow(false) {}
+
+private:
+    ResponseBuilder(const ResponseBuilder &) = delete;
+    ResponseBuilder &operator=(const ResponseBuilder &) = delete;
+
+    uint8_t *const p_buffer;
+    const uint8_t m_capacity;
+    uint8_t m_length; // Bytes of the reply in p_buffer
+    bool m_overflow;  // Bytes were dropped since the last send()
+};
+
+/**
+ * @class ResponseBuilderN
+ * @brief ResponseBuilder with its own buffer of N bytes, meant for the stack.
+ *
+ * @tparam N Buffer size in bytes (at most 255).
+ */
+template <uint8_t N>
+class ResponseBuilderN final : public ResponseBuilder
+{
+public:
+    ResponseBuilderN() : ResponseBuilder(m_buffer, N) {}
+
+private:
+    uint8_t m_buffer[N];
+};
+
+#endif // RESPONSE_BUILDER_H
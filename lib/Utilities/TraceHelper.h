@@ -45,38 +45,38 @@
 #define TRACE_TRACE() dummyPrinter
 #endif
 
-// Static (per-function) logging with compile-time optimization
+// Static (per-component) logging with compile-time optimization
 #undef TRACE_ERROR_STATIC
 #if (CLASS_TRACE_LEVEL >= TRACE_LEVEL_ERROR)
-#define TRACE_ERROR_STATIC(functionName) Traceable(functionName, static_cast<Level>(CLASS_TRACE_LEVEL)).printError(__LINE__)
+#define TRACE_ERROR_STATIC(component) Traceable(component).printError(__LINE__)
 #else
-#define TRACE_ERROR_STATIC(functionName) dummyPrinter
+#define TRACE_ERROR_STATIC(component) dummyPrinter
 #endif
 
 #undef TRACE_WARN_STATIC
 #if (CLASS_TRACE_LEVEL >= TRACE_LEVEL_WARN)
-#define TRACE_WARN_STATIC(functionName) Traceable(functionName, static_cast<Level>(CLASS_TRACE_LEVEL)).printWarn(__LINE__)
+#define TRACE_WARN_STATIC(component) Traceable(component).printWarn(__LINE__)
 #else
-#define TRACE_WARN_STATIC(functionName) dummyPrinter
+#define TRACE_WARN_STATIC(component) dummyPrinter
 #endif
 
 #undef TRACE_INFO_STATIC
 #if (CLASS_TRACE_LEVEL >= TRACE_LEVEL_INFO)
-#define TRACE_INFO_STATIC(functionName) Traceable(functionName, static_cast<Level>(CLASS_TRACE_LEVEL)).printInfo(__LINE__)
+#define TRACE_INFO_STATIC(component) Traceable(component).printInfo(__LINE__)
 #else
-#define TRACE_INFO_STATIC(functionName) dummyPrinter
+#define TRACE_INFO_STATIC(component) dummyPrinter
 #endif
 
 #undef TRACE_DEBUG_STATIC
 #if (CLASS_TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
-#define TRACE_DEBUG_STATIC(functionName) Traceable(functionName, static_cast<Level>(CLASS_TRACE_LEVEL)).printDebug(__LINE__)
+#define TRACE_DEBUG_STATIC(component) Traceable(component).printDebug(__LINE__)
 #else
-#define TRACE_DEBUG_STATIC(functionName) dummyPrinter
+#define TRACE_DEBUG_STATIC(component) dummyPrinter
 #endif
 
 #undef TRACE_TRACE_STATIC
 #if (CLASS_TRACE_LEVEL >= TRACE_LEVEL_TRACE)
-#define TRACE_TRACE_STATIC(functionName) Traceable(functionName, static_cast<Level>(CLASS_TRACE_LEVEL)).printTrace(__LINE__)
+#define TRACE_TRACE_STATIC(component) Traceable(component).printTrace(__LINE__)
 #else
-#define TRACE_TRACE_STATIC(functionName) dummyPrinter
+#define TRACE_TRACE_STATIC(component) dummyPrinter
 #endif
\ No newline at end of file
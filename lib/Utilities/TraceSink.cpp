@@ -0,0 +1,91 @@
+/**
+ * @file TraceSink.cpp
+ * @brief Implementation of the non-blocking trace sink.
+ */
+
+#include "TraceSink.h"
+
+/**
+ * @brief Queue one byte, keeping one slot free to terminate a cut line.
+ */
+size_t TraceSink::write(uint8_t c)
+{
+    const bool endOfLine = c == '\n';
+    if (!m_dropping && m_ring.space() > (endOfLine ? 0 : 1))
+    {
+        m_ring.push(c);
+        m_lineQueued = !endOfLine;
+        return 1;
+    }
+
+    if (!m_dropping)
+    {
+        m_dropping = true;
+        if (m_droppedMessages < UINT16_MAX)
+            ++m_droppedMessages;
+    }
+
+    if (endOfLine)
+    {
+        m_dropping = false;
+        const bool terminated = m_lineQueued && m_ring.push(c);
+        m_lineQueued = false;
+        if (terminated)
+            return 1;
+    }
+
+    drop();
+    return 0;
+}
+
+/**
+ * @brief Queue a block with one ring update when it fits whole.
+ */
+size_t TraceSink::write(const uint8_t *buffer, size_t size)
+{
+    if (!m_dropping && size > 0 && m_ring.space() > size)
+    {
+        m_ring.pushBulk(buffer, size);
+        m_lineQueued = buffer[size - 1] != '\n';
+        return size;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        written += write(buffer[i]);
+    }
+    return written;
+}
+
+/**
+ * @brief Drain straight from the ring to the output.
+ */
+void TraceSink::loop()
+{
+    int room = p_output->availableForWrite();
+    while (room > 0)
+    {
+        const uint8_t *region;
+        size_t length = m_ring.readableRegion(region);
+        if (length == 0)
+            return;
+        if (length > static_cast<size_t>(room))
+            length = room;
+
+        length = p_output->write(region, length);
+        if (length == 0)
+            return;
+        m_ring.consume(length);
+        room -= length;
+    }
+}
+
+/**
+ * @brief Count one dropped byte.
+ */
+void TraceSink::drop()
+{
+    if (m_droppedBytes < UINT16_MAX)
+        ++m_droppedBytes;
+}
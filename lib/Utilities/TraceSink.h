@@ -0,0 +1,81 @@
+/**
+ * @file TraceSink.h
+ * @brief Non-blocking Print sink for trace output.
+ *
+ * This file contains the TraceSink class, a Print backed by a fixed RAM ring.
+ * Writes never wait for the output device: bytes that do not fit are dropped
+ * and counted, and loop() drains the ring only as far as the output reports
+ * room through availableForWrite().
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+#ifndef TRACE_SINK_H
+#define TRACE_SINK_H
+
+#include <Arduino.h>
+#include <Print.h>
+#include "../CircularBuffers/FastCircularQueue.h"
+
+/**
+ * @brief Size of the trace sink ring (power of 2).
+ */
+#ifndef TRACE_SINK_BUFFER_SIZE
+#define TRACE_SINK_BUFFER_SIZE 128
+#endif
+
+/**
+ * @class TraceSink
+ * @brief Print sink that queues trace lines and drains them without blocking.
+ *
+ * Select it per component with Traceable::setOutput(). A line that does not
+ * fit is dropped from the first byte that overflows; if part of it was queued
+ * already, its newline still goes out from a reserved slot so the next line
+ * starts clean. Dropped bytes and lines are counted, saturating at 0xFFFF.
+ */
+class TraceSink : public Print
+{
+public:
+    /**
+     * @brief Constructs a sink draining to an output device.
+     *
+     * @param output Output device, usually Serial.
+     */
+    explicit TraceSink(Print &output) : p_output(&output) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int availableForWrite() override { return m_ring.space(); }
+    using Print::write;
+
+    /**
+     * @brief Drain queued bytes as far as the output takes them without blocking.
+     */
+    void loop();
+
+    // Drop accounting
+
+    uint16_t getDroppedBytes() const { return m_droppedBytes; }
+    uint16_t getDroppedMessages() const { return m_droppedMessages; }
+    void resetDropped()
+    {
+        m_droppedBytes = 0;
+        m_droppedMessages = 0;
+    }
+
+private:
+    TraceSink(const TraceSink &) = delete;
+    TraceSink &operator=(const TraceSink &) = delete;
+
+    void drop();
+
+    FastCircularQueue<uint8_t, TRACE_SINK_BUFFER_SIZE> m_ring;
+    Print *const p_output;
+    uint16_t m_droppedBytes = 0;
+    uint16_t m_droppedMessages = 0;
+    bool m_dropping = false;    // Rest of the current line is being dropped
+    bool m_lineQueued = false;  // Part of the current line is in the ring
+};
+
+#endif // TRACE_SINK_H
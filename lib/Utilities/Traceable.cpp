@@ -12,6 +12,7 @@
 #include "Utilities.h"
 #include <Arduino.h>
 
+#if !TRACE_BINARY
 // Debug level names stored in PROGMEM to save SRAM
 static const char LEVEL_0[] PROGMEM = "OFF";
 static const char LEVEL_1[] PROGMEM = "ERROR";
@@ -22,10 +23,12 @@ static const char LEVEL_5[] PROGMEM = "TRACE";
 
 static const char *const LEVEL_NAMES[] PROGMEM = {
     LEVEL_0, LEVEL_1, LEVEL_2, LEVEL_3, LEVEL_4, LEVEL_5};
+#endif
     
 // Define the global dummy printer instance
 Traceable::DummyPrintWrapper dummyPrinter;
 
+#if !TRACE_BINARY
 // -------------------------
 // PrintWrapper implementation
 // -------------------------
@@ -33,36 +36,28 @@ Traceable::DummyPrintWrapper dummyPrinter;
 /**
  * @brief Returns the singleton instance of PrintWrapper.
  *
- * NOTE: This returns a single static instance, which may not be safe
- * for concurrent usage across multiple Traceable instances.
+ * Each call captures the output of the message about to be written and
+ * prints its header.
  */
 Traceable::PrintWrapper &Traceable::PrintWrapper::instance(
-    Traceable &traceable, const Level level, const int line)
+    const Traceable &traceable, const Level level, const int line)
 {
-    static PrintWrapper instance(traceable, level, line);
+    static PrintWrapper instance;
 
+    instance.printer = traceable.isEnabled(level) ? traceable.getOutput() : nullptr;
     traceable.print(level, line);
 
     return instance;
 }
 
-/**
- * @brief Constructs a PrintWrapper that logs file/line and level info.
- */
-Traceable::PrintWrapper::PrintWrapper(Traceable &traceable, const Level level, const int line)
-    : traceable(&traceable), level(level)
-{
-    traceable.print(level, line);
-}
-
 /**
  * @brief Write a byte to output device if level is enabled.
  */
 size_t Traceable::PrintWrapper::write(uint8_t c)
 {
-    if (traceable->isEnabled(level))
+    if (printer != nullptr)
     {
-        return traceable->settings->getPrinter()->write(c);
+        return printer->write(c);
     }
     return 0;
 }
@@ -72,57 +67,220 @@ size_t Traceable::PrintWrapper::write(uint8_t c)
  */
 size_t Traceable::PrintWrapper::write(const uint8_t *buffer, size_t size)
 {
-    if (traceable->isEnabled(level))
+    if (printer != nullptr)
     {
-        return traceable->settings->getPrinter()->write(buffer, size);
+        return printer->write(buffer, size);
     }
     return 0;
 }
+#endif
 
 // -------------------------
 // Traceable implementation
 // -------------------------
 
+// Component names in PROGMEM, indexed by component ID
+#define TRACE_COMPONENT_NAME(id, name, level) static const char NAME_##id[] PROGMEM = name;
+TRACE_COMPONENTS(TRACE_COMPONENT_NAME)
+#undef TRACE_COMPONENT_NAME
+
+#define TRACE_COMPONENT_NAME_ENTRY(id, name, level) NAME_##id,
+static const char *const COMPONENT_NAMES[] PROGMEM = {TRACE_COMPONENTS(TRACE_COMPONENT_NAME_ENTRY)};
+#undef TRACE_COMPONENT_NAME_ENTRY
+
+// Compile-time levels in PROGMEM, indexed by component ID
+#define TRACE_COMPONENT_LEVEL(id, name, level) level,
+static const uint8_t COMPILE_TIME_LEVELS[] PROGMEM = {TRACE_COMPONENTS(TRACE_COMPONENT_LEVEL)};
+#undef TRACE_COMPONENT_LEVEL
+
 /**
- * @brief Map of function names to their corresponding Traceable settings.
+ * @brief Run-time levels, every component starts at INFO.
  *
- * ArduinoMap is assumed to be a custom lightweight implementation.
- * The function name pointers are stored in flash (PROGMEM) for efficiency.
+ * Constant initialized, so nothing runs at boot.
  */
-ArduinoMap<const __FlashStringHelper *, Traceable::Settings *> Traceable::settingsMap;
+#define TRACE_COMPONENT_DEFAULT_LEVEL(id, name, level) Traceable::Level::INFO,
+Traceable::Level Traceable::levels[] = {TRACE_COMPONENTS(TRACE_COMPONENT_DEFAULT_LEVEL)};
+#undef TRACE_COMPONENT_DEFAULT_LEVEL
 
 /**
- * @brief Constructs a Traceable instance with a function name.
- *
- * If the function hasn't been registered before, a default Settings
- * object is created and added to the map.
+ * @brief Output devices, every component starts on Serial.
+ */
+#define TRACE_COMPONENT_DEFAULT_PRINTER(id, name, level) &Serial,
+Print *Traceable::printers[] = {TRACE_COMPONENTS(TRACE_COMPONENT_DEFAULT_PRINTER)};
+#undef TRACE_COMPONENT_DEFAULT_PRINTER
+
+/**
+ * @brief Get the component name from the PROGMEM table.
+ */
+const __FlashStringHelper *Traceable::getName() const
+{
+    return PGMT(pgm_read_word(&COMPONENT_NAMES[component]));
+}
+
+/**
+ * @brief Get the component's compile-time level from the PROGMEM table.
+ */
+Traceable::Level Traceable::getCompileTimeLevel() const
+{
+    return static_cast<Level>(pgm_read_byte(&COMPILE_TIME_LEVELS[component]));
+}
+
+/**
+ * @brief Linear name compare over the PROGMEM table, for commands only.
  */
-Traceable::Traceable(const __FlashStringHelper *const functionName,
-                     const Level compileTimeLevel)
+bool Traceable::find(const char *name, TraceComponent &component)
 {
-    settings = *settingsMap.get(functionName);
-    if (settings == nullptr)
+    for (uint8_t i = 0; i < COMPONENT_COUNT; ++i)
     {
-        settings = new Traceable::Settings(functionName, compileTimeLevel, &Serial, Traceable::Level::INFO);
-        settingsMap.insert(functionName, settings);
+        if (strcmp_P(name, reinterpret_cast<PGM_P>(pgm_read_word(&COMPONENT_NAMES[i]))) == 0)
+        {
+            component = static_cast<TraceComponent>(i);
+            return true;
+        }
     }
+    return false;
 }
 
 // -------------------------
 // Logging Methods
 // -------------------------
 
+#if TRACE_BINARY
+FastCircularQueue<uint8_t, TRACE_BINARY_BUFFER_SIZE> Traceable::ring;
+Traceable::Record Traceable::binaryRecord;
+uint16_t Traceable::droppedRecords = 0;
+
+/**
+ * @brief Drain queued records straight from the ring.
+ */
+size_t Traceable::flush(Print &output, size_t max)
+{
+    size_t written = 0;
+    while (written < max)
+    {
+        const uint8_t *region;
+        size_t length = ring.readableRegion(region);
+        if (length == 0)
+            break;
+        if (length > max - written)
+            length = max - written;
+
+        length = output.write(region, length);
+        if (length == 0)
+            break;
+        ring.consume(length);
+        written += length;
+    }
+    return written;
+}
+
+/**
+ * @brief Queue the record header, or count the record as dropped.
+ */
+void Traceable::Record::begin(const Traceable &traceable, const Level level, const int line)
+{
+    active = false;
+    truncated = false;
+    if (!traceable.isEnabled(level))
+        return;
+
+    const size_t dropped = droppedRecords ? 1 + sizeof(droppedRecords) : 0;
+    if (ring.space() < sizeof(Header) + dropped + RESERVE)
+    {
+        if (droppedRecords < UINT16_MAX)
+            ++droppedRecords;
+        return;
+    }
+
+    const Header header = {SYNC, static_cast<uint8_t>(level), traceable.component,
+                           static_cast<uint16_t>(line), static_cast<uint32_t>(millis())};
+    ring.pushBulk(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+    active = true;
+
+    if (droppedRecords)
+    {
+        put(TAG_DROPPED, &droppedRecords, sizeof(droppedRecords));
+        droppedRecords = 0;
+    }
+}
+
+/**
+ * @brief Close the record with TAG_END.
+ */
+void Traceable::Record::end()
+{
+    if (!active)
+        return;
+    ring.push(TAG_END);
+    active = false;
+}
+
+/**
+ * @brief Store the flash address only; the decoder reads the string from the ELF.
+ */
+void Traceable::Record::putFlash(const __FlashStringHelper *value)
+{
+    const uint16_t address = static_cast<uint16_t>(reinterpret_cast<uintptr_t>(value));
+    put(TAG_FLASH, &address, sizeof(address));
+}
+
+/**
+ * @brief Store printed bytes as TAG_TEXT chunks.
+ */
+size_t Traceable::Record::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size)
+    {
+        const uint8_t length = size - written > UINT8_MAX ? UINT8_MAX : size - written;
+        if (!reserve(2 + length))
+            break;
+        ring.push(TAG_TEXT);
+        ring.push(length);
+        ring.pushBulk(buffer + written, length);
+        written += length;
+    }
+    return written;
+}
+
+/**
+ * @brief Check room for an argument, cutting the record when it does not fit.
+ */
+bool Traceable::Record::reserve(const size_t size)
+{
+    if (!active || truncated)
+        return false;
+    if (ring.space() >= size + RESERVE)
+        return true;
+
+    ring.push(TAG_TRUNCATED);
+    truncated = true;
+    return false;
+}
+
+/**
+ * @brief Store one tagged fixed size argument.
+ */
+void Traceable::Record::put(const Tag tag, const void *payload, const uint8_t size)
+{
+    if (!reserve(1 + size))
+        return;
+    ring.push(tag);
+    ring.pushBulk(static_cast<const uint8_t *>(payload), size);
+}
+#else
+
 /**
  * @brief Output formatted log header with timestamp, level, file, and line.
  *
  * This method is called before every log message to write structured headers.
  */
-void Traceable::print(const Level level, const int line)
+void Traceable::print(const Level level, const int line) const
 {
     if (!isEnabled(level))
         return;
 
-    Print *printer = settings->getPrinter();
+    Print *printer = getOutput();
 
     // Timestamp
     printer->print('[');
@@ -136,7 +294,7 @@ void Traceable::print(const Level level, const int line)
 
     // Source Location
     printer->print('(');
-    printer->print(settings->getFunctionName());
+    printer->print(getName());
     printer->print(':');
     printer->print(line);
     printer->print(')');
@@ -144,3 +302,4 @@ void Traceable::print(const Level level, const int line)
     // Separator
     printer->print(F(": "));
 }
+#endif
@@ -19,7 +19,28 @@
 #include <Arduino.h>
 #include <Print.h>
 #include "../../include/TraceLevel.h"
-#include "../ArduinoMap/ArduinoMap.h"
+
+#if TRACE_BINARY
+#include "../CircularBuffers/FastCircularQueue.h"
+
+/**
+ * @brief Size of the RAM ring holding binary trace records (power of 2).
+ */
+#ifndef TRACE_BINARY_BUFFER_SIZE
+#define TRACE_BINARY_BUFFER_SIZE 128
+#endif
+#endif
+
+/**
+ * @brief Trace component IDs, in TRACE_COMPONENTS order.
+ */
+#define TRACE_COMPONENT_ID(id, name, level) id,
+enum class TraceComponent : uint8_t
+{
+    TRACE_COMPONENTS(TRACE_COMPONENT_ID)
+    COUNT ///< Number of registered components
+};
+#undef TRACE_COMPONENT_ID
 
 /**
  * @class Traceable
@@ -28,6 +49,15 @@
  * The Traceable class provides a flexible and efficient debug logging system.
  * It supports multiple debug levels, source code location tracking, and method chaining.
  * The implementation is optimized for both RAM and flash memory usage.
+ *
+ * Components come from the compile-time TRACE_COMPONENTS registry: names and
+ * compile-time levels live in PROGMEM tables and the run-time level and output
+ * in static arrays indexed by component ID, so no heap is used and isEnabled()
+ * is a single table lookup.
+ *
+ * With TRACE_BINARY enabled the logging methods return a Record instead of a
+ * formatting Print: the header and chained arguments are queued raw in a RAM
+ * ring and flush() sends them out when the link has room.
  */
 class Traceable
 {
@@ -54,36 +84,77 @@ public:
         TRACE = TRACE_LEVEL_TRACE
     };
 
+    /// Number of registered trace components
+    static const uint8_t COMPONENT_COUNT = static_cast<uint8_t>(TraceComponent::COUNT);
+
     /**
-     * @brief Constructs a Traceable instance with a function name.
+     * @brief Constructs a Traceable instance for a registered component.
      *
-     * Each function name will have a unique settings entry
-     * for output device and debug level.
+     * All instances of a component share its level and output device.
+     *
+     * @param component The component ID from TRACE_COMPONENTS.
+     */
+    explicit Traceable(const TraceComponent component) : component(static_cast<uint8_t>(component)) {}
+
+    // Component registry
+
+    TraceComponent getComponent() const { return static_cast<TraceComponent>(component); }
+    const __FlashStringHelper *getName() const;
+    Level getCompileTimeLevel() const;
+
+    /**
+     * @brief Find a component by name.
      *
-     * @param functionName The name of the function for tracing.
-     * @param compileTimeLevel The debug level to use at compile time.
+     * @param name The component name in RAM.
+     * @param component Receives the component ID when found.
+     * @return true if the name is registered.
      */
-    explicit Traceable(const __FlashStringHelper *const functionName,
-                       const Level compileTimeLevel);
+    static bool find(const char *name, TraceComponent &component);
 
     // Debug level setters and getters
 
-    void setLevel(const Level level) { settings->setLevel(level); }
-    Level getLevel() const { return settings->getLevel(); }
-    bool isEnabled(const Level level) const { return static_cast<uint8_t>(level) <= static_cast<uint8_t>(settings->getLevel()); }
+    void setLevel(const Level level) { levels[component] = level; }
+    Level getLevel() const { return levels[component]; }
+    bool isEnabled(const Level level) const { return static_cast<uint8_t>(level) <= static_cast<uint8_t>(levels[component]); }
 
     // Output redirection
 
-    void setOutput(Print &output) { settings->setPrinter(&output); }
-    Print *getOutput() { return settings->getPrinter(); }
+    void setOutput(Print &output) { printers[component] = &output; }
+    Print *getOutput() const { return printers[component]; }
 
     // Logging methods for each level
 
+#if TRACE_BINARY
+    class Record;
+
+    Record &printError(const int line) { return record(Level::ERROR, line); }
+    Record &printWarn(const int line) { return record(Level::WARN, line); }
+    Record &printInfo(const int line) { return record(Level::INFO, line); }
+    Record &printDebug(const int line) { return record(Level::DEBUG, line); }
+    Record &printTrace(const int line) { return record(Level::TRACE, line); }
+
+    /**
+     * @brief Drain queued binary records to an output.
+     *
+     * Call from the main loop with the room the output can take without blocking.
+     *
+     * @param output Output device, usually Serial.
+     * @param max Maximum number of bytes to write.
+     * @return The number of bytes written.
+     */
+    static size_t flush(Print &output, size_t max);
+
+    /**
+     * @brief Number of queued bytes waiting for flush().
+     */
+    static size_t pending() { return ring.available(); }
+#else
     Print &printError(const int line) { return PrintWrapper::instance(*this, Level::ERROR, line); }
     Print &printWarn(const int line) { return PrintWrapper::instance(*this, Level::WARN, line); }
     Print &printInfo(const int line) { return PrintWrapper::instance(*this, Level::INFO, line); }
     Print &printDebug(const int line) { return PrintWrapper::instance(*this, Level::DEBUG, line); }
     Print &printTrace(const int line) { return PrintWrapper::instance(*this, Level::TRACE, line); }
+#endif
 
     /**
      * @class DummyPrintWrapper
@@ -103,39 +174,83 @@ public:
         DummyPrintWrapper &operator=(const DummyPrintWrapper &) = delete;
     };
 
+#if TRACE_BINARY
     /**
-     * @class Settings
-     * @brief Stores configuration for each Traceable instance.
+     * @class Record
+     * @brief Writer for one binary trace record.
      *
-     * Each function has its own settings (printer and level).
+     * A record is a packed Header followed by tagged arguments and ends with
+     * TAG_END. Chained arguments are stored raw: integers and floats as 4 bytes,
+     * flash strings as their 2 byte address, RAM strings as length and bytes.
+     * Anything printed through write() is stored as TAG_TEXT.
+     *
+     * Records are written from the main loop only. A record that does not fit
+     * the ring is dropped whole and counted in the next record's TAG_DROPPED;
+     * an argument that does not fit cuts the record with TAG_TRUNCATED.
      */
-    class Settings
+    class Record : public Print
     {
     public:
-        Settings(const __FlashStringHelper *const functionName, const Level compileTimeLevel, 
-        Print *const printer, const Level level)
-            : functionName(functionName), compileTimeLevel(compileTimeLevel), printer(printer), level(level) {}
+        static const uint8_t SYNC = 0xA5; ///< First byte of every record
+
+        /**
+         * @brief Argument tags, each followed by its payload.
+         */
+        enum Tag : uint8_t
+        {
+            TAG_END = 0x00,       ///< End of record, no payload
+            TAG_CHAR = 0x01,      ///< char
+            TAG_SIGNED = 0x02,    ///< int32_t
+            TAG_UNSIGNED = 0x03,  ///< uint32_t
+            TAG_FLOAT = 0x04,     ///< float
+            TAG_FLASH = 0x05,     ///< uint16_t address of a PROGMEM string
+            TAG_TEXT = 0x06,      ///< uint8_t length and bytes
+            TAG_DROPPED = 0x07,   ///< uint16_t records dropped before this one
+            TAG_TRUNCATED = 0x08  ///< Remaining arguments did not fit, no payload
+        };
+
+        /**
+         * @brief Fixed record header, little endian.
+         */
+        struct Header
+        {
+            uint8_t sync;       ///< SYNC
+            uint8_t level;      ///< Level
+            uint8_t component;  ///< Component ID
+            uint16_t line;      ///< Source line
+            uint32_t timestamp; ///< millis()
+        } __attribute__((packed));
+
+        Record() = default;
 
-        const __FlashStringHelper *getFunctionName() const { return functionName; }
-        Level getCompileTimeLevel() const { return compileTimeLevel; }
-        Print *getPrinter() const { return printer; }
-        void setPrinter(Print *p) { printer = p; }
-        Level getLevel() const { return level; }
-        void setLevel(const Level l) { level = l; }
+        void begin(const Traceable &traceable, const Level level, const int line);
+        void end();
+
+        void putChar(const char value) { put(TAG_CHAR, &value, sizeof(value)); }
+        void putSigned(const int32_t value) { put(TAG_SIGNED, &value, sizeof(value)); }
+        void putUnsigned(const uint32_t value) { put(TAG_UNSIGNED, &value, sizeof(value)); }
+        void putFloat(const float value) { put(TAG_FLOAT, &value, sizeof(value)); }
+        void putFlash(const __FlashStringHelper *value);
+        void putText(const char *value) { write(reinterpret_cast<const uint8_t *>(value), strlen(value)); }
+
+        size_t write(uint8_t c) override { return write(&c, 1); }
+        size_t write(const uint8_t *buffer, size_t size) override;
 
     private:
-        const __FlashStringHelper *functionName;
-        const Level compileTimeLevel;
-        Print *printer;
-        Level level;
+        Record(const Record &) = delete;
+        Record &operator=(const Record &) = delete;
+
+        // Room kept free for TAG_TRUNCATED and TAG_END
+        static const uint8_t RESERVE = 2;
+
+        bool reserve(const size_t size);
+        void put(const Tag tag, const void *payload, const uint8_t size);
+
+        bool active = false;
+        bool truncated = false;
     };
+#endif
 
-    /**
-     * @brief Get the settings map.
-     * @return The settings map.
-     */
-    static const ArduinoMap<const __FlashStringHelper *, Settings *> &getSettingsMap() { return settingsMap; }
-    
 private:
     /**
      * @class PrintWrapper
@@ -147,24 +262,40 @@ private:
     class PrintWrapper : public Print
     {
     public:
-        static PrintWrapper &instance(Traceable &traceable, const Level level, const int line);
+        static PrintWrapper &instance(const Traceable &traceable, const Level level, const int line);
         size_t write(uint8_t c) override;
         size_t write(const uint8_t *buffer, size_t size) override;
 
     private:
-        PrintWrapper(Traceable &traceable, const Level level, const int line);
-        Traceable *const traceable;
-        const Level level;
+        PrintWrapper() = default;
+
+        // Output of the message being written, nullptr while its level is disabled
+        Print *printer = nullptr;
     };
 
+#if TRACE_BINARY
+    // Start a binary record on the shared writer
+    Record &record(const Level level, const int line)
+    {
+        binaryRecord.begin(*this, level, line);
+        return binaryRecord;
+    }
+
+    // Ring of queued records and the shared record writer
+    static FastCircularQueue<uint8_t, TRACE_BINARY_BUFFER_SIZE> ring;
+    static Record binaryRecord;
+    static uint16_t droppedRecords;
+#else
     // Internal method for printing timestamp, file, and line headers
-    void print(const Level level, const int line);
+    void print(const Level level, const int line) const;
+#endif
 
-    // Map holding settings per function name
-    static ArduinoMap<const __FlashStringHelper *, Traceable::Settings *> settingsMap;
+    // Run-time level and output per component ID
+    static Level levels[COMPONENT_COUNT];
+    static Print *printers[COMPONENT_COUNT];
 
-    // Pointer to this instance's settings
-    Settings *settings;
+    // This instance's component ID
+    const uint8_t component;
 };
 
 /**
@@ -206,4 +337,62 @@ inline Print &operator<<(Print &stream, _EndLineCode)
     return stream;
 }
 
+#if TRACE_BINARY
+// ------------------------
+// Binary Record Overloads
+// ------------------------
+
+/**
+ * @brief Store arguments raw in a binary record.
+ *
+ * Types without a dedicated overload are formatted through Print into TAG_TEXT.
+ */
+template <typename T>
+inline Traceable::Record &operator<<(Traceable::Record &record, T arg)
+{
+    record.print(arg);
+    return record;
+}
+
+inline Traceable::Record &operator<<(Traceable::Record &record, const __FlashStringHelper *arg)
+{
+    record.putFlash(arg);
+    return record;
+}
+
+inline Traceable::Record &operator<<(Traceable::Record &record, const char *arg)
+{
+    record.putText(arg);
+    return record;
+}
+
+inline Traceable::Record &operator<<(Traceable::Record &record, const String &arg)
+{
+    record.putText(arg.c_str());
+    return record;
+}
+
+inline Traceable::Record &operator<<(Traceable::Record &record, const char arg)
+{
+    record.putChar(arg);
+    return record;
+}
+
+inline Traceable::Record &operator<<(Traceable::Record &record, const int arg) { record.putSigned(arg); return record; }
+inline Traceable::Record &operator<<(Traceable::Record &record, const long arg) { record.putSigned(arg); return record; }
+inline Traceable::Record &operator<<(Traceable::Record &record, const unsigned char arg) { record.putUnsigned(arg); return record; }
+inline Traceable::Record &operator<<(Traceable::Record &record, const unsigned int arg) { record.putUnsigned(arg); return record; }
+inline Traceable::Record &operator<<(Traceable::Record &record, const unsigned long arg) { record.putUnsigned(arg); return record; }
+inline Traceable::Record &operator<<(Traceable::Record &record, const double arg) { record.putFloat(arg); return record; }
+
+/**
+ * @brief Close the binary record; nothing is written to the output here.
+ */
+inline Traceable::Record &operator<<(Traceable::Record &record, _EndLineCode)
+{
+    record.end();
+    return record;
+}
+#endif
+
 #endif // TRACEABLE_H
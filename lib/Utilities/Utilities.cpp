@@ -16,7 +16,12 @@ namespace Utilities
 
     void printOK(SerialCommands &sender)
     {
-        sender.getSerial().println(F("\r\nOK"));
+        printOK(sender.getSerial());
+    }
+
+    void printOK(Print &output)
+    {
+        output.println(F("\r\nOK"));
     }
 
     void printError(SerialCommands &sender, const __FlashStringHelper *msg)
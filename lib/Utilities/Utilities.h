@@ -34,6 +34,13 @@ namespace Utilities
      */
     void printOK(SerialCommands &sender);
 
+    /**
+     * @brief Prints a standard OK response to any output
+     *
+     * @param output The Print object to use for output
+     */
+    void printOK(Print &output);
+
     /**
      * @brief Prints an error message to the serial interface
      *
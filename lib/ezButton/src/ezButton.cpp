@@ -50,7 +50,8 @@
  *
  * @param pin Arduino pin number the button is connected to
  */
-ezButton::ezButton(int pin) : ezButton(pin, INPUT_PULLUP) {}
+template <typename Clock>
+ezButtonBase<Clock>::ezButtonBase(int pin) : ezButtonBase(pin, INPUT_PULLUP) {}
 
 /**
  * @brief Constructor with configurable input mode
@@ -60,7 +61,8 @@ ezButton::ezButton(int pin) : ezButton(pin, INPUT_PULLUP) {}
  * @param pin Arduino pin number the button is connected to
  * @param mode INPUT, INPUT_PULLUP, INTERNAL_PULLUP, INTERNAL_PULLDOWN, EXTERNAL_PULLUP, or EXTERNAL_PULLDOWN
  */
-ezButton::ezButton(int pin, int mode)
+template <typename Clock>
+ezButtonBase<Clock>::ezButtonBase(int pin, int mode)
 {
 	config.btnPin = pin;
 	debounceTime = 0;
@@ -87,7 +89,8 @@ ezButton::ezButton(int pin, int mode)
  *
  * @param time Debounce time in milliseconds
  */
-void ezButton::setDebounceTime(uint16_t time)
+template <typename Clock>
+void ezButtonBase<Clock>::setDebounceTime(uint16_t time)
 {
 	debounceTime = time;
 }
@@ -97,7 +100,8 @@ void ezButton::setDebounceTime(uint16_t time)
  *
  * @return HIGH or LOW
  */
-int ezButton::getState(void) const
+template <typename Clock>
+int ezButtonBase<Clock>::getState(void) const
 {
 	return config.flags.lastState;
 }
@@ -107,7 +111,8 @@ int ezButton::getState(void) const
  *
  * @return HIGH or LOW
  */
-int ezButton::getStateRaw(void) const
+template <typename Clock>
+int ezButtonBase<Clock>::getStateRaw(void) const
 {
 	return digitalRead(config.btnPin);
 }
@@ -119,7 +124,8 @@ int ezButton::getStateRaw(void) const
  *
  * @return true if button was just pressed, false otherwise
  */
-bool ezButton::isPressed(void) const
+template <typename Clock>
+bool ezButtonBase<Clock>::isPressed(void) const
 {
 	return (config.flags.previousState == config.flags.unpressedState &&
 			config.flags.lastState == config.flags.pressedState);
@@ -132,7 +138,8 @@ bool ezButton::isPressed(void) const
  *
  * @return true if button was just released, false otherwise
  */
-bool ezButton::isReleased(void) const
+template <typename Clock>
+bool ezButtonBase<Clock>::isReleased(void) const
 {
 	return (config.flags.previousState == config.flags.pressedState &&
 			config.flags.lastState == config.flags.unpressedState);
@@ -143,7 +150,8 @@ bool ezButton::isReleased(void) const
  *
  * @param mode COUNT_FALLING, COUNT_RISING, or COUNT_BOTH
  */
-void ezButton::setCountMode(int mode)
+template <typename Clock>
+void ezButtonBase<Clock>::setCountMode(int mode)
 {
 	config.flags.countMode = mode;
 }
@@ -153,7 +161,8 @@ void ezButton::setCountMode(int mode)
  *
  * @return Number of counted events
  */
-uint16_t ezButton::getCount(void) const
+template <typename Clock>
+uint16_t ezButtonBase<Clock>::getCount(void) const
 {
 	return count;
 }
@@ -161,7 +170,8 @@ uint16_t ezButton::getCount(void) const
 /**
  * @brief Reset the event counter to zero
  */
-void ezButton::resetCount(void)
+template <typename Clock>
+void ezButtonBase<Clock>::resetCount(void)
 {
 	count = 0;
 }
@@ -172,10 +182,11 @@ void ezButton::resetCount(void)
  * This method handles button debouncing and event counting.
  * It must be called regularly in the main loop.
  */
-void ezButton::loop(void)
+template <typename Clock>
+void ezButtonBase<Clock>::loop(void)
 {
 	uint8_t currentState = digitalRead(config.btnPin);
-	uint16_t currentTime = millis();
+	uint16_t currentTime = Clock::millis();
 
 	if (currentState != config.flags.flickerState)
 	{
@@ -199,3 +210,6 @@ void ezButton::loop(void)
 		}
 	}
 }
+
+template class ezButtonBase<MillisClock>;
+template class ezButtonBase<LoopClock>;
@@ -46,6 +46,7 @@
 #define ezButton_h
 
 #include <Arduino.h>
+#include <LoopClock.h>
 
 /**
  * @brief Constants for button counting modes
@@ -74,8 +75,11 @@
  *
  * The ezButton class provides a simple interface for button handling
  * with built-in debouncing and event counting capabilities.
+ *
+ * @tparam Clock Time source, MillisClock or LoopClock (see LoopClock.h)
  */
-class ezButton
+template <typename Clock>
+class ezButtonBase
 {
 private:
 	struct
@@ -103,7 +107,7 @@ public:
 	 *
 	 * @param pin Arduino pin number the button is connected to
 	 */
-	explicit ezButton(int pin);
+	explicit ezButtonBase(int pin);
 
 	/**
 	 * @brief Constructor with configurable input mode
@@ -111,7 +115,7 @@ public:
 	 * @param pin Arduino pin number the button is connected to
 	 * @param mode INPUT, INPUT_PULLUP, INTERNAL_PULLUP, INTERNAL_PULLDOWN, EXTERNAL_PULLUP, or EXTERNAL_PULLDOWN
 	 */
-	ezButton(int pin, int mode);
+	ezButtonBase(int pin, int mode);
 
 	/**
 	 * @brief Set the debounce time
@@ -173,4 +177,6 @@ public:
 	void loop(void);
 };
 
+typedef ezButtonBase<MillisClock> ezButton; ///< Button reading millis() on every loop
+
 #endif
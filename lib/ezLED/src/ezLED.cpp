@@ -23,7 +23,8 @@
  * @param pin Arduino pin connected to the LED
  * @param mode Control mode: CTRL_ANODE (default) or CTRL_CATHODE
  */
-ezLED::ezLED(int pin, int mode)
+template <typename Clock>
+ezLEDBase<Clock>::ezLEDBase(int pin, int mode)
 {
     _ledPin = pin;
     flags._ctrlMode = mode;
@@ -50,12 +51,13 @@ ezLED::ezLED(int pin, int mode)
  * @param offTime Time LED stays off during blink (ms)
  * @param delayTime Delay before blinking starts (ms)
  */
-void ezLED::setBlink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::setBlink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
 {
     _blink.onTime = onTime;
     _blink.offTime = offTime;
     _delayTime = delayTime;
-    _lastTime = millis();
+    _lastTime = Clock::millis();
 }
 
 /**
@@ -64,7 +66,8 @@ void ezLED::setBlink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
  * Sets the LED brightness using analogWrite, taking into account
  * the control mode (anode or cathode).
  */
-void ezLED::updateAnalog()
+template <typename Clock>
+void ezLEDBase<Clock>::updateAnalog()
 {
     analogWrite(_ledPin, flags._ctrlMode ? (255 - _brightness) : _brightness);
 }
@@ -75,7 +78,8 @@ void ezLED::updateAnalog()
  * Sets the LED state using digitalWrite, taking into account
  * the control mode (anode or cathode).
  */
-void ezLED::updateDigital()
+template <typename Clock>
+void ezLEDBase<Clock>::updateDigital()
 {
     digitalWrite(_ledPin, flags._ctrlMode ? !flags._outputState : flags._outputState);
 }
@@ -85,7 +89,8 @@ void ezLED::updateDigital()
  *
  * @param delayTime Optional delay before turning on (ms)
  */
-void ezLED::turnON(uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::turnON(uint16_t delayTime)
 {
     _delayTime = delayTime;
     flags._ledMode = LED_MODE_ON;
@@ -93,7 +98,7 @@ void ezLED::turnON(uint16_t delayTime)
     if (delayTime > 0)
     {
         flags._ledState = LED_STATE_DELAY;
-        _lastTime = millis();
+        _lastTime = Clock::millis();
     }
     else
     {
@@ -108,7 +113,8 @@ void ezLED::turnON(uint16_t delayTime)
  *
  * @param delayTime Optional delay before turning off (ms)
  */
-void ezLED::turnOFF(uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::turnOFF(uint16_t delayTime)
 {
     _delayTime = delayTime;
     flags._ledMode = LED_MODE_OFF;
@@ -116,7 +122,7 @@ void ezLED::turnOFF(uint16_t delayTime)
     if (delayTime > 0)
     {
         flags._ledState = LED_STATE_DELAY;
-        _lastTime = millis();
+        _lastTime = Clock::millis();
     }
     else
     {
@@ -131,7 +137,8 @@ void ezLED::turnOFF(uint16_t delayTime)
  *
  * @param delayTime Optional delay before toggling (ms)
  */
-void ezLED::toggle(uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::toggle(uint16_t delayTime)
 {
     _delayTime = delayTime;
     flags._ledMode = LED_MODE_TOGGLE;
@@ -139,7 +146,7 @@ void ezLED::toggle(uint16_t delayTime)
     if (delayTime > 0)
     {
         flags._ledState = LED_STATE_DELAY;
-        _lastTime = millis();
+        _lastTime = Clock::millis();
     }
     else
     {
@@ -157,14 +164,15 @@ void ezLED::toggle(uint16_t delayTime)
  * @param fadeTime Duration of fade in milliseconds
  * @param delayTime Optional delay before fading starts (ms)
  */
-void ezLED::fade(uint8_t fadeFrom, uint8_t fadeTo, uint32_t fadeTime, uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::fade(uint8_t fadeFrom, uint8_t fadeTo, uint32_t fadeTime, uint16_t delayTime)
 {
     _fade.from = fadeFrom;
     _fade.to = fadeTo;
     _fade.time = fadeTime;
     _delayTime = delayTime;
     flags._ledMode = LED_MODE_FADE;
-    _lastTime = millis();
+    _lastTime = Clock::millis();
 
     if (delayTime > 0)
         flags._ledState = LED_STATE_DELAY;
@@ -181,7 +189,8 @@ void ezLED::fade(uint8_t fadeFrom, uint8_t fadeTo, uint32_t fadeTime, uint16_t d
  * @param offTime Time LED stays off during blink (ms)
  * @param delayTime Optional delay before blinking starts (ms)
  */
-void ezLED::blink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::blink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
 {
     setBlink(onTime, offTime, delayTime);
     flags._ledMode = LED_MODE_BLINK_FOREVER;
@@ -194,7 +203,7 @@ void ezLED::blink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
         {
             flags._ledState = LED_STATE_BLINK;
             flags._outputState = LED_ON;
-            _lastTime = millis();
+            _lastTime = Clock::millis();
         }
     }
 
@@ -209,7 +218,8 @@ void ezLED::blink(uint16_t onTime, uint16_t offTime, uint16_t delayTime)
  * @param blinkTime Total time to blink (ms)
  * @param delayTime Optional delay before blinking starts (ms)
  */
-void ezLED::blinkInPeriod(uint16_t onTime, uint16_t offTime, uint16_t blinkTime, uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::blinkInPeriod(uint16_t onTime, uint16_t offTime, uint16_t blinkTime, uint16_t delayTime)
 {
     setBlink(onTime, offTime, delayTime);
     _blink.period = blinkTime;
@@ -223,8 +233,8 @@ void ezLED::blinkInPeriod(uint16_t onTime, uint16_t offTime, uint16_t blinkTime,
         {
             flags._ledState = LED_STATE_BLINK;
             flags._outputState = LED_ON;
-            _lastTime = millis();
-            _blink.timer = millis();
+            _lastTime = Clock::millis();
+            _blink.timer = Clock::millis();
         }
     }
 
@@ -239,7 +249,8 @@ void ezLED::blinkInPeriod(uint16_t onTime, uint16_t offTime, uint16_t blinkTime,
  * @param numberOfTimes Number of times to blink
  * @param delayTime Optional delay before blinking starts (ms)
  */
-void ezLED::blinkNumberOfTimes(uint16_t onTime, uint16_t offTime, uint8_t numberOfTimes, uint16_t delayTime)
+template <typename Clock>
+void ezLEDBase<Clock>::blinkNumberOfTimes(uint16_t onTime, uint16_t offTime, uint8_t numberOfTimes, uint16_t delayTime)
 {
     setBlink(onTime, offTime, delayTime);
     _blink.target = numberOfTimes;
@@ -253,7 +264,7 @@ void ezLED::blinkNumberOfTimes(uint16_t onTime, uint16_t offTime, uint8_t number
         {
             flags._ledState = LED_STATE_BLINK;
             flags._outputState = LED_ON;
-            _lastTime = millis();
+            _lastTime = Clock::millis();
             _blink.count = 1;
         }
     }
@@ -264,7 +275,8 @@ void ezLED::blinkNumberOfTimes(uint16_t onTime, uint16_t offTime, uint8_t number
 /**
  * @brief Cancel current operation and turn LED off
  */
-void ezLED::cancel(void)
+template <typename Clock>
+void ezLEDBase<Clock>::cancel(void)
 {
     turnOFF();
 }
@@ -274,7 +286,8 @@ void ezLED::cancel(void)
  *
  * @return LED_ON or LED_OFF
  */
-int ezLED::getOnOff(void)
+template <typename Clock>
+int ezLEDBase<Clock>::getOnOff(void)
 {
     return flags._outputState;
 }
@@ -284,7 +297,8 @@ int ezLED::getOnOff(void)
  *
  * @return LED_IDLE, LED_DELAY, LED_FADING, or LED_BLINKING
  */
-int ezLED::getState(void)
+template <typename Clock>
+int ezLEDBase<Clock>::getState(void)
 {
     switch (flags._ledState)
     {
@@ -308,7 +322,8 @@ int ezLED::getState(void)
  * This is the core non-blocking state machine that manages all LED operations.
  * It must be called regularly in the main loop.
  */
-void ezLED::loop(void)
+template <typename Clock>
+void ezLEDBase<Clock>::loop(void)
 {
     switch (flags._ledState)
     {
@@ -316,7 +331,7 @@ void ezLED::loop(void)
         return;
 
     case LED_STATE_DELAY:
-        if ((unsigned long)(millis() - _lastTime) >= _delayTime)
+        if ((unsigned long)(Clock::millis() - _lastTime) >= _delayTime)
         {
             switch (flags._ledMode)
             {
@@ -338,7 +353,7 @@ void ezLED::loop(void)
                 break;
             }
 
-            _lastTime = millis();
+            _lastTime = Clock::millis();
         }
         break;
 
@@ -360,9 +375,9 @@ void ezLED::loop(void)
         break;
 
     case LED_STATE_FADE:
-        if ((millis() - _lastTime) <= _fade.time)
+        if ((Clock::millis() - _lastTime) <= _fade.time)
         {
-            unsigned long progress = millis() - _lastTime;
+            unsigned long progress = Clock::millis() - _lastTime;
             _brightness = map(progress, 0, _fade.time, _fade.from, _fade.to);
         }
         else
@@ -373,16 +388,16 @@ void ezLED::loop(void)
         break;
 
     case LED_STATE_BLINK:
-        if (flags._outputState == LED_OFF && (unsigned long)(millis() - _lastTime) >= _blink.offTime)
+        if (flags._outputState == LED_OFF && (unsigned long)(Clock::millis() - _lastTime) >= _blink.offTime)
         {
             flags._outputState = LED_ON;
-            _lastTime = millis();
+            _lastTime = Clock::millis();
             _blink.count++;
         }
-        else if (flags._outputState == LED_ON && (unsigned long)(millis() - _lastTime) >= _blink.onTime)
+        else if (flags._outputState == LED_ON && (unsigned long)(Clock::millis() - _lastTime) >= _blink.onTime)
         {
             flags._outputState = LED_OFF;
-            _lastTime = millis();
+            _lastTime = Clock::millis();
             _blink.count++;
         }
 
@@ -392,7 +407,7 @@ void ezLED::loop(void)
             break;
 
         case LED_MODE_BLINK_PERIOD:
-            if ((unsigned long)(millis() - _blink.timer) >= _blink.period)
+            if ((unsigned long)(Clock::millis() - _blink.timer) >= _blink.period)
             {
                 flags._outputState = LED_OFF;
                 flags._ledState = LED_STATE_IDLE;
@@ -414,4 +429,7 @@ void ezLED::loop(void)
         updateAnalog();
     else
         updateDigital();
-}
\ No newline at end of file
+}
+
+template class ezLEDBase<MillisClock>;
+template class ezLEDBase<LoopClock>;
@@ -46,6 +46,7 @@
 #define ezLED_h
 
 #include <Arduino.h>
+#include <LoopClock.h>
 
 /**
  * @brief LED state constants
@@ -93,8 +94,11 @@
  * This class provides an easy-to-use interface for controlling LEDs
  * with built-in support for various lighting patterns without blocking
  * the main program execution.
+ *
+ * @tparam Clock Time source, MillisClock or LoopClock (see LoopClock.h)
  */
-class ezLED
+template <typename Clock>
+class ezLEDBase
 {
 private:
 	uint8_t _ledPin;	 ///< Arduino pin connected to the LED
@@ -157,7 +161,7 @@ public:
 	 * @param pin Arduino pin connected to the LED
 	 * @param mode Control mode: CTRL_ANODE (default) or CTRL_CATHODE
 	 */
-	explicit ezLED(int pin, int mode = CTRL_ANODE);
+	explicit ezLEDBase(int pin, int mode = CTRL_ANODE);
 
 	/**
 	 * @brief Turn the LED on
@@ -244,4 +248,6 @@ public:
 	void loop(void);
 };
 
+typedef ezLEDBase<MillisClock> ezLED; ///< LED reading millis() on every call
+
 #endif
@@ -0,0 +1,52 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+Import("env")
+
+# SRAM budget of the firmware, checked after every link
+# .data, .bss and .noinit are placed at build time; what is left of the
+# board's RAM holds the stack and the heap, so the build fails when less than
+# custom_ram_reserve bytes remain for them
+
+# Bytes left for the stack and the heap when the environment sets no custom_ram_reserve
+DEFAULT_RAM_RESERVE = 512
+
+def section_sizes(env, firmware):
+    import subprocess
+
+    size_tool = env.subst("$SIZETOOL") or "avr-size"
+    output = subprocess.check_output([size_tool, "-A", firmware], text=True)
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0].startswith(".") and fields[1].isdigit():
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+def check_ram(source, target, env):
+    import subprocess
+
+    firmware = str(target[0])
+    try:
+        sizes = section_sizes(env, firmware)
+    except (OSError, subprocess.CalledProcessError) as error:
+        print(f"RAM check skipped, no size tool: {error}")
+        return 0
+
+    ram = int(env.BoardConfig().get("upload.maximum_ram_size", 2560))
+    reserve = int(env.GetProjectOption("custom_ram_reserve", DEFAULT_RAM_RESERVE))
+    data = sizes.get(".data", 0)
+    bss = sizes.get(".bss", 0)
+    noinit = sizes.get(".noinit", 0)
+    static = data + bss + noinit
+    flash = sizes.get(".text", 0) + data
+
+    print(f"RAM: .data {data} + .bss {bss} + .noinit {noinit} = {static} B of {ram} B, "
+          f"{ram - static} B left for stack and heap (reserve {reserve} B); flash {flash} B")
+    if static > ram - reserve:
+        print(f"RAM check failed: {static - (ram - reserve)} B over the budget; "
+              "lower STATISTIC_HISTOGRAM_BUCKETS or the buffers, or raise custom_ram_reserve knowingly")
+        return 1
+    return 0
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_ram)
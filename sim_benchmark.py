@@ -0,0 +1,122 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+Import("env")
+
+# simavr cycle benchmark of the sim environment: pio run -e sim -t simbench
+# The sim_cold environment builds the same firmware without HOT_PATH
+# (lib/HotPath/HotPath.h), sim_runtime with the link's frame format chosen at
+# run time; once both of a pair ran, each run compares itself to the other
+# and writes the comparison to benchmark/sim/results/ for committing with the
+# change it measures
+
+# Compared environments: the one with the change, the one without it, and the change
+COMPARISONS = [
+    ("sim", "sim_cold", "HOT_PATH"),
+    ("sim", "sim_runtime", "FixedFrameFormat"),
+]
+
+def build_simbench(source, target, env):
+    import os
+    import subprocess
+
+    project_dir = env.subst("$PROJECT_DIR")
+    build_dir = env.subst("$BUILD_DIR")
+    source_file = os.path.join(project_dir, "benchmark", "sim", "simbench.c")
+    program = os.path.join(build_dir, "simbench")
+
+    # Prefer the flags of an installed simavr, fall back to the usual library names
+    try:
+        flags = subprocess.check_output(["pkg-config", "--cflags", "--libs", "simavr"], text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        flags = "-lsimavr -lelf"
+
+    # The harness needs libelf for the symbol table as well
+    if "-lelf" not in flags:
+        flags += " -lelf"
+
+    return env.Execute(f'cc -std=c99 -D_DEFAULT_SOURCE -O2 -Wall -Wextra -o "{program}" "{source_file}" {flags}')
+
+def run_simbench(source, target, env):
+    import os
+
+    build_dir = env.subst("$BUILD_DIR")
+    program = os.path.join(build_dir, "simbench")
+    firmware = os.path.join(build_dir, "firmware.elf")
+    results = os.path.join(build_dir, "sim_cycles.json")
+
+    status = env.Execute(f'"{program}" --json "{results}" "{firmware}"')
+    if not status:
+        print(f"Wrote simulator cycle counts to {results}, the next build's assembly analysis shows them")
+        current_env = env.subst("$PIOENV")
+        for changed_env, base_env, change in COMPARISONS:
+            if current_env in (changed_env, base_env):
+                compare_builds(env, changed_env, base_env, change)
+    return status
+
+def flash_size(env, firmware):
+    import subprocess
+
+    # Flash holds .text and .data, as the size check of the build counts it
+    size_tool = env.subst("$SIZETOOL") or "avr-size"
+    try:
+        output = subprocess.check_output([size_tool, firmware], text=True)
+        text, data = output.splitlines()[1].split()[:2]
+        return int(text) + int(data)
+    except (OSError, subprocess.CalledProcessError, IndexError, ValueError):
+        return None
+
+def compare_builds(env, changed_env, base_env, change):
+    import os
+    import json
+
+    build_root = env.subst("$PROJECT_BUILD_DIR")
+    changed_dir = os.path.join(build_root, changed_env)
+    base_dir = os.path.join(build_root, base_env)
+    other_env = base_env if env.subst("$PIOENV") == changed_env else changed_env
+    if not os.path.exists(os.path.join(build_root, other_env, "sim_cycles.json")):
+        print(f"Run pio run -e {other_env} -t simbench as well to compare with and without {change}")
+        return
+
+    # Always report the change minus the base, whichever environment ran last
+    with open(os.path.join(changed_dir, "sim_cycles.json"), "r") as f:
+        changed = json.load(f)
+    with open(os.path.join(base_dir, "sim_cycles.json"), "r") as f:
+        base = json.load(f)
+
+    lines = []
+    changed_flash = flash_size(env, os.path.join(changed_dir, "firmware.elf"))
+    base_flash = flash_size(env, os.path.join(base_dir, "firmware.elf"))
+    if changed_flash is not None and base_flash is not None:
+        budget = env.BoardConfig().get("upload.maximum_size", 0)
+        lines.append(f"{change} flash: {changed_flash} bytes, {changed_flash - base_flash:+d} against {base_env}"
+                     + (f", {budget - changed_flash} bytes left of {budget}" if budget else ""))
+    lines.append(f"{change} maximum sustainable baud: {changed['max_sustainable_baud']} "
+                 f"({base_env} {base['max_sustainable_baud']})")
+    for scenario, measured in changed["scenarios"].items():
+        base_measured = base["scenarios"].get(scenario, {})
+        for symbol, cycles in measured.items():
+            if symbol in base_measured:
+                base_cycles = base_measured[symbol]
+                lines.append(f"  {cycles['label']} ({scenario}): {cycles['avg']} cycles average, "
+                             f"{cycles['avg'] - base_cycles['avg']:+} against {base_cycles['avg']}; "
+                             f"max {cycles['max']}, {cycles['max'] - base_cycles['max']:+} against {base_cycles['max']}")
+
+    print("=" * 40)
+    print("\n".join(lines))
+    print("=" * 40)
+
+    results_dir = os.path.join(env.subst("$PROJECT_DIR"), "benchmark", "sim", "results")
+    os.makedirs(results_dir, exist_ok=True)
+    report = os.path.join(results_dir, f"{changed_env}-vs-{base_env}.txt")
+    with open(report, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    print(f"Wrote the {change} comparison to {report}")
+
+env.AddCustomTarget(
+    name="simbench",
+    dependencies=["$BUILD_DIR/firmware.elf"],
+    actions=[build_simbench, run_simbench],
+    title="Simulator Benchmark",
+    description="Count ISR and loop cycles of the firmware under simavr"
+)
@@ -0,0 +1,268 @@
+/**
+ * @file BenchController.cpp
+ * @brief Implementation of the link benchmark.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Third-party libraries
+#include <LoopClock.h>
+
+// Project headers
+#include "BenchController.h"
+#include "Globals.h"
+
+#if LINK_BENCH
+
+/// Upper bounds of the round trip buckets in milliseconds, the last bucket takes the rest
+static const uint16_t RTT_BOUNDS_MS[BenchController::RTT_BUCKETS - 1] PROGMEM = {10, 20, 50, 100, 200, 500, 1000};
+
+static_assert((BenchController::MAX_IN_FLIGHT & (BenchController::MAX_IN_FLIGHT - 1)) == 0, "MAX_IN_FLIGHT must be a power of two");
+
+// Prints a value given in tenths with one decimal.
+static void printTenths(Print &print, const uint32_t tenths)
+{
+  print.print(tenths / 10);
+  print.print('.');
+  print.print(static_cast<uint8_t>(tenths % 10));
+}
+
+bool BenchController::start(Print &output, const uint16_t count, const uint8_t size)
+{
+  if (p_output != nullptr)
+  {
+    return false;
+  }
+
+  // Late echoes of a run that timed out would be taken for this one's
+  while (streamBench.available())
+  {
+    streamBench.read();
+  }
+
+  memset(m_rttBuckets, 0, sizeof(m_rttBuckets));
+  m_rttTotalUs = 0;
+  m_rttMinUs = UINT32_MAX;
+  m_rttMaxUs = 0;
+  m_elapsedUs = 0;
+  m_count = count;
+  m_size = size;
+  m_sent = 0;
+  m_echoed = 0;
+  m_corrupt = 0;
+  m_echoOffset = 0;
+  m_echoCorrupt = false;
+  m_timedOut = false;
+  m_finished = false;
+
+  const CRCPackageInterface::LinkStatistic &link = crcPackageInterface.getLinkStatistic();
+  m_retries = link.retries;
+  m_drops = link.maxRetryDrops;
+  m_cpuUs = communicationStatistic.getTotal();
+  m_startMicros = micros();
+  m_lastEchoMillis = LoopClock::millis16();
+  p_output = &output;
+  return true;
+}
+
+void BenchController::loop()
+{
+  if (p_output == nullptr)
+  {
+    return;
+  }
+
+  if (!m_finished)
+  {
+    receive();
+    if (m_echoed == m_count)
+    {
+      finish(false);
+    }
+    else if (static_cast<uint16_t>(LoopClock::millis16() - m_lastEchoMillis) >= TIMEOUT_MS)
+    {
+      finish(true);
+    }
+    else
+    {
+      send();
+    }
+  }
+
+  // A report still running, on another output, goes first
+  if (m_finished && reportWriter.start(*p_output, renderReport))
+  {
+    p_output = nullptr;
+  }
+}
+
+void BenchController::send()
+{
+  bool sent = false;
+  while (m_sent < m_count && m_sent - m_echoed < MAX_IN_FLIGHT && streamBench.availableForWrite() >= m_size)
+  {
+    uint8_t payload[MAX_SIZE];
+    for (uint8_t i = 0; i < m_size; ++i)
+    {
+      payload[i] = static_cast<uint8_t>(m_sent + i);
+    }
+    m_sentMicros[m_sent & (MAX_IN_FLIGHT - 1)] = micros();
+    streamBench.write(payload, m_size);
+    ++m_sent;
+    sent = true;
+  }
+
+  // Each payload leaves at once instead of waiting to be coalesced with the next
+  if (sent)
+  {
+    crcPackageInterface.flush(CHANNEL_BENCH);
+  }
+}
+
+void BenchController::receive()
+{
+  int c;
+  while (m_echoed < m_sent && (c = streamBench.read()) >= 0)
+  {
+    m_lastEchoMillis = LoopClock::millis16();
+    if (static_cast<uint8_t>(c) != static_cast<uint8_t>(m_echoed + m_echoOffset))
+    {
+      m_echoCorrupt = true;
+    }
+    if (++m_echoOffset < m_size)
+    {
+      continue;
+    }
+
+    const uint32_t now = micros();
+    const uint32_t rtt = now - m_sentMicros[m_echoed & (MAX_IN_FLIGHT - 1)];
+    m_rttTotalUs += rtt;
+    if (rtt < m_rttMinUs)
+    {
+      m_rttMinUs = rtt;
+    }
+    if (rtt > m_rttMaxUs)
+    {
+      m_rttMaxUs = rtt;
+    }
+    const uint32_t rttMs = rtt / 1000;
+    uint8_t bucket = 0;
+    while (bucket < RTT_BUCKETS - 1 && rttMs >= pgm_read_word(&RTT_BOUNDS_MS[bucket]))
+    {
+      ++bucket;
+    }
+    ++m_rttBuckets[bucket];
+
+    if (m_echoCorrupt)
+    {
+      ++m_corrupt;
+    }
+    m_echoOffset = 0;
+    m_echoCorrupt = false;
+    ++m_echoed;
+    // Goodput counts up to the last echo, a timeout adds no idle time
+    m_elapsedUs = now - m_startMicros;
+  }
+}
+
+void BenchController::finish(const bool timedOut)
+{
+  const CRCPackageInterface::LinkStatistic &link = crcPackageInterface.getLinkStatistic();
+  m_retries = link.retries - m_retries;
+  m_drops = link.maxRetryDrops - m_drops;
+  m_cpuUs = communicationStatistic.getTotal() - m_cpuUs;
+  m_timedOut = timedOut;
+  m_finished = true;
+}
+
+// Report blocks: the run, the goodput, the round trips, their histogram, the link and CPU costs, then OK.
+bool BenchController::renderReport(Print &print, const uint8_t block)
+{
+  const BenchController &bench = benchController;
+  const uint32_t echoedBytes = static_cast<uint32_t>(bench.m_echoed) * bench.m_size;
+  switch (block)
+  {
+  case 0:
+    print.print(F("bench "));
+    print.print(bench.m_count);
+    print.print(F(" x "));
+    print.print(bench.m_size);
+    print.print(F(" B: sent "));
+    print.print(bench.m_sent);
+    print.print(F(", echoed "));
+    print.print(bench.m_echoed);
+    print.print(F(", corrupt "));
+    print.print(bench.m_corrupt);
+    if (bench.m_timedOut)
+    {
+      print.print(F(", timed out"));
+    }
+    print.println();
+    return true;
+  case 1:
+  {
+    const uint32_t elapsedMs = (bench.m_elapsedUs + 500) / 1000;
+    print.print(F("time "));
+    print.print(elapsedMs);
+    print.print(F(" ms, goodput "));
+    // Bytes are at most MAX_COUNT * MAX_SIZE, a thousand times that fits 32 bits
+    print.print(elapsedMs != 0 ? echoedBytes * 1000 / elapsedMs : 0);
+    print.println(F(" B/s each way"));
+    return true;
+  }
+  case 2:
+    if (bench.m_echoed == 0)
+    {
+      print.println(F("rtt ms min/avg/max -"));
+      return true;
+    }
+    print.print(F("rtt ms min/avg/max "));
+    printTenths(print, bench.m_rttMinUs / 100);
+    print.print('/');
+    printTenths(print, bench.m_rttTotalUs / bench.m_echoed / 100);
+    print.print('/');
+    printTenths(print, bench.m_rttMaxUs / 100);
+    print.println();
+    return true;
+  case 3:
+    print.print(F("rtt ms"));
+    for (uint8_t i = 0; i < RTT_BUCKETS; ++i)
+    {
+      print.print(i < RTT_BUCKETS - 1 ? F(" <") : F(" >="));
+      print.print(pgm_read_word(&RTT_BOUNDS_MS[i < RTT_BUCKETS - 1 ? i : RTT_BUCKETS - 2]));
+      print.print(':');
+      print.print(bench.m_rttBuckets[i]);
+    }
+    print.println();
+    return true;
+  case 4:
+    print.print(F("retries "));
+    print.print(bench.m_retries);
+    print.print(F(", dropped windows "));
+    print.println(bench.m_drops);
+    return true;
+  case 5:
+    // Every payload byte is sent once and received once
+    print.print(F("cpu "));
+    print.print(bench.m_cpuUs);
+    print.print(F(" us, "));
+    if (echoedBytes != 0)
+    {
+      printTenths(print, bench.m_cpuUs * 10ul / (2 * echoedBytes));
+    }
+    else
+    {
+      print.print('-');
+    }
+    print.println(F(" us/B"));
+    return true;
+  case 6:
+    Utilities::printOK(print);
+    return true;
+  default:
+    return false;
+  }
+}
+
+#endif // LINK_BENCH
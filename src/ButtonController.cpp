@@ -9,23 +9,51 @@
  * @date 2025
  */
 
+// Arduino core
+#include <util/atomic.h>
+
 // Project headers
 #include "ButtonController.h"
+#include "Globals.h"
 
 /**
  * @brief Constructor for the ButtonController class.
  *
  * @param buttonPin The pin connected to the button.
  *
- * Initializes the button controller with the specified pin,
- * configures debounce time, and sets initial state.
+ * Initializes the button controller with the specified pin and sets the
+ * initial state. The pin is configured by begin().
  */
 ButtonController::ButtonController(const uint8_t buttonPin)
-    : m_button(buttonPin), m_pressedTime(0), m_state(NO_PRESS)
+    : m_pin(buttonPin), m_queuedLevel(HIGH), m_pendingLevel(HIGH), m_pendingTime(0),
+      m_stableLevel(HIGH), m_pressedTime(0), m_state(NO_PRESS)
 {
-  m_button.setDebounceTime(DEBOUNCE_TIME);
 } // end ButtonController
 
+/**
+ * @brief Configure the pin and enable its pin change interrupt.
+ *
+ * Takes the current level as the debounced one, so a button held through
+ * reset does not report a press.
+ */
+void ButtonController::begin()
+{
+  pinMode(m_pin, INPUT_PULLUP);
+
+  const uint8_t level = digitalRead(m_pin);
+  m_queuedLevel = level;
+  m_pendingLevel = level;
+  m_stableLevel = level;
+  m_pendingTime = LoopClock::millis16();
+
+  volatile uint8_t *const pcicr = digitalPinToPCICR(m_pin);
+  if (pcicr != nullptr)
+  {
+    *digitalPinToPCMSK(m_pin) |= _BV(digitalPinToPCMSKbit(m_pin));
+    *pcicr |= _BV(digitalPinToPCICRbit(m_pin));
+  }
+} // end begin
+
 /**
  * @brief Get the current state of the button press.
  *
@@ -47,7 +75,7 @@ ButtonController::State ButtonController::state() const
  */
 bool ButtonController::isPressing() const
 {
-  return m_button.getState() == LOW;
+  return m_stableLevel == LOW;
 }
 
 /**
@@ -59,39 +87,116 @@ bool ButtonController::isPressing() const
  */
 bool ButtonController::isPressingRaw() const
 {
-  return m_button.getStateRaw() == LOW;
+  return digitalRead(m_pin) == LOW;
 }
 
 /**
  * @brief Update button state and detect press durations.
  *
- * This method should be called regularly in the main program loop to update
- * the button state and detect the type of press based on its duration.
- * It handles the logic for categorizing presses as short, long, or very long.
+ * This method should be called regularly in the main program loop. It
+ * debounces the queued edges in order and categorizes a completed press as
+ * short, long, or very long from the edge time stamps.
  */
 void ButtonController::loop()
 {
-  m_button.loop();
+  m_state = NO_PRESS;
 
-  if (m_button.isPressed())
+  Edge edge;
+  while (m_edges.pop(edge))
   {
-    // Button was just pressed, record the time and reset state
-    m_pressedTime = millis() & 0xFFFF;
-    m_state = NO_PRESS;
+    if (processEdge(edge))
+      return;
   }
-  else if (m_button.isReleased())
+
+  // Catch a change the interrupt did not queue
+  bool missed = false;
+  uint8_t level;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
   {
-    // Button was just released, calculate the press duration and determine type
-    const uint16_t currentTime = millis() & 0xFFFF;
-    const uint16_t pressedDuration = currentTime - m_pressedTime;
+    level = digitalRead(m_pin);
+    if (m_edges.isEmpty() && level != m_queuedLevel)
+    {
+      m_queuedLevel = level;
+      missed = true;
+    }
+  }
+  if (missed && processEdge(Edge{LoopClock::millis16(), level}))
+    return;
+
+  settle(LoopClock::millis16());
+} // end loop
+
+/**
+ * @brief Queue the current pin level, called from the pin change interrupt.
+ *
+ * A full queue drops the edge; loop() then picks the level up from the pin.
+ */
+void ButtonController::processEdgeISR()
+{
+  const uint8_t level = digitalRead(m_pin);
+  if (level == m_queuedLevel)
+    return; // Another pin of the same port changed
 
-    m_state = pressedDuration >= VERY_LONG_PRESS_DURATION ? VERY_LONG_PRESS
-              : pressedDuration >= LONG_PRESS_DURATION    ? LONG_PRESS
-                                                          : SHORT_PRESS;
+  if (m_edges.push(Edge{static_cast<uint16_t>(millis()), level}))
+    m_queuedLevel = level;
+} // end processEdgeISR
+
+/**
+ * @brief Debounce one edge.
+ *
+ * The pending level is accepted if it lasted DEBOUNCE_TIME up to this edge;
+ * the edge then starts a new pending level.
+ *
+ * @param edge Edge in time order.
+ * @return true if it completed a press and set m_state.
+ */
+bool ButtonController::processEdge(const Edge &edge)
+{
+  const bool completed = settle(edge.time);
+  m_pendingLevel = edge.level;
+  m_pendingTime = edge.time;
+  return completed;
+} // end processEdge
+
+/**
+ * @brief Accept the pending level if nothing has changed it for DEBOUNCE_TIME.
+ *
+ * Presses are timed from the edge that started each accepted level.
+ *
+ * @param now Time of the check, low 16 bits of millis().
+ * @return true if it completed a press and set m_state.
+ */
+bool ButtonController::settle(const uint16_t now)
+{
+  // Signed, an edge stamped after LoopClock::tick() is slightly in the future
+  if (m_pendingLevel == m_stableLevel || static_cast<int16_t>(now - m_pendingTime) < DEBOUNCE_TIME)
+    return false;
+
+  m_stableLevel = m_pendingLevel;
+  if (m_stableLevel == LOW)
+  {
+    // Button was pressed, record the time
+    m_pressedTime = m_pendingTime;
+    return false;
   }
-  else
+
+  // Button was released, determine the press type from its duration
+  const uint16_t pressedDuration = m_pendingTime - m_pressedTime;
+  m_state = pressedDuration >= VERY_LONG_PRESS_DURATION ? VERY_LONG_PRESS
+            : pressedDuration >= LONG_PRESS_DURATION    ? LONG_PRESS
+                                                        : SHORT_PRESS;
+  return true;
+} // end settle
+
+/**
+ * @brief Pin change interrupt of the button pin.
+ *
+ * PCINT0 is shared by the pins of port B; only the button enables it.
+ */
+ISR(PCINT0_vect)
+{
+  MEASURE_ISR(buttonEdgeIsrStatistic)
   {
-    // No change in button state
-    m_state = NO_PRESS;
+    buttonController.processEdgeISR();
   }
-} // end loop
\ No newline at end of file
+}
@@ -2,8 +2,200 @@
 #include "Globals.h"
 #include "Utilities.h"
 #include "Traceable.h"
+#include "ResponseBuilder.h"
+#include <SipHash.h>
+
+/// Reply buffer of the short commands: a seed in hex, its line end and the OK
+constexpr uint8_t REPLY_BUFFER_SIZE = 2 * SEED_LENGTH + 8;
+/// Longest host token the timed ping echoes
+constexpr uint8_t PING_TOKEN_MAX_LENGTH = 16;
+/// Reply buffer of the timed ping: the token, four labelled timestamps, the line end and the OK
+constexpr uint8_t PING_REPLY_BUFFER_SIZE = PING_TOKEN_MAX_LENGTH + 76;
+static_assert(PING_REPLY_BUFFER_SIZE <= COMMAND_OUTPUT_RESERVE, "The timed ping reply must fit the command output reserve");
+
 //================ Helper Functions for Commands ==================
 
+#if SERIAL_COMMANDS_STATISTICS
+// Stats blocks of a command table counting from index 1: the heading, one per command.
+// Returns false with the table's blocks taken off index when the block is past it.
+static bool renderCommandStatistics(Print &print, uint8_t &index, const SerialCommands &commands, const __FlashStringHelper *title)
+{
+  const uint16_t count = commands.getCommandCount();
+  if (index == 1)
+  {
+    print.println(F("--------------------"));
+    print.println(title);
+    return true;
+  }
+  if (index >= 2 && index < count + 2)
+  {
+    commands.printStatistic(print, index - 2);
+    return true;
+  }
+  index -= count + 1;
+  return false;
+}
+#endif
+
+// Report blocks of the stats command: the table, the lock latency, the serial RX, the ISR loads,
+// the command dispatches, then OK.
+static bool renderStatistics(Print &print, const uint8_t block)
+{
+  const uint8_t tableBlocks = StatisticController::statisticBlockCount(lengthOfStatistics);
+  if (block < tableBlocks)
+  {
+    return statisticController.printStatisticBlock(print, block, statistics, lengthOfStatistics, &crcPackageInterface);
+  }
+
+  uint8_t index = block - tableBlocks;
+  if (index == 0)
+  {
+    keyboardController.lockLatency().print(print);
+    return true;
+  }
+#if !HC05_HARDWARE_UART
+  if (--index == 0)
+  {
+    softwareSerial.printStatistic(print);
+    return true;
+  }
+#endif
+#if STATISTIC_ISR_LOAD
+  if (--index == 0)
+  {
+    statisticController.printIsrStatisticTable(print, isrStatistics, lengthOfIsrStatistics);
+    return true;
+  }
+#endif
+#if SERIAL_COMMANDS_STATISTICS
+  if (renderCommandStatistics(print, index, serialCommands, F("console commands")) ||
+      renderCommandStatistics(print, index, bluetoothCommands, F("bluetooth commands")))
+  {
+    return true;
+  }
+#endif
+  if (--index == 0)
+  {
+    Utilities::printOK(print);
+    return true;
+  }
+  return false;
+}
+
+// Report blocks of the ram command: the memory map, then OK.
+static bool renderRam(Print &print, const uint8_t block)
+{
+  switch (block)
+  {
+  case 0:
+    statisticController.printRam(print);
+    return true;
+  case 1:
+    Utilities::printOK(print);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Report blocks of the help command: one per command, then OK.
+static bool renderHelp(SerialCommands &commands, Print &print, const uint8_t block)
+{
+  if (commands.listCommand(print, block))
+  {
+    return true;
+  }
+  if (block == commands.getCommandCount())
+  {
+    Utilities::printOK(print);
+    return true;
+  }
+  return false;
+}
+
+static bool renderConsoleHelp(Print &print, const uint8_t block)
+{
+  return renderHelp(serialCommands, print, block);
+}
+
+static bool renderBluetoothHelp(Print &print, const uint8_t block)
+{
+  return renderHelp(bluetoothCommands, print, block);
+}
+
+// Report blocks of the listtrace command: the heading, one per component, then the sink line and OK.
+static bool renderTraceables(Print &print, const uint8_t block)
+{
+  if (block == 0)
+  {
+    print.println(F("Traceable : Compile Time Level : Run Time Level : Sink"));
+    return true;
+  }
+  if (block <= Traceable::COMPONENT_COUNT)
+  {
+    const Traceable traceable(static_cast<TraceComponent>(block - 1));
+    print.print(traceable.getName());
+    print.print(F(": "));
+    print.print(static_cast<uint8_t>(traceable.getCompileTimeLevel()));
+    print.print(F(": "));
+    print.print(static_cast<uint8_t>(traceable.getLevel()));
+    print.print(F(": "));
+    print.println(traceable.getOutput() == &traceSink ? 1 : 0);
+    return true;
+  }
+  if (block == Traceable::COMPONENT_COUNT + 1)
+  {
+    print.print(F("Sink dropped bytes: "));
+    print.print(traceSink.getDroppedBytes());
+    print.print(F(", lines: "));
+    print.println(traceSink.getDroppedMessages());
+    Utilities::printOK(print);
+    return true;
+  }
+  return false;
+}
+
+// Report blocks of the tasks command: the task table, then OK.
+static bool renderTasks(Print &print, const uint8_t block)
+{
+  switch (block)
+  {
+  case 0:
+    taskScheduler.print(print);
+    return true;
+  case 1:
+    Utilities::printOK(print);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Report blocks of the stalls command: the records, then OK.
+static bool renderStalls(Print &print, const uint8_t block)
+{
+  switch (block)
+  {
+  case 0:
+    stallRecorder.print(print);
+    return true;
+  case 1:
+    Utilities::printOK(print);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Start a report written from the main loop, the render function prints OK at its end.
+static void startReport(SerialCommands &sender, ReportWriter::RenderFunction render)
+{
+  if (!reportWriter.start(sender.getSerial(), render))
+  {
+    Utilities::printError(sender, F("Report busy"));
+  }
+}
+
 // Helper to check that the seed has not been set already.
 static inline bool requireSeedNotChecked(SerialCommands &sender)
 {
@@ -30,6 +222,57 @@ static inline bool parseSeedString(const char *str, byte *seed, size_t length)
   return true;
 }
 
+// Decode a fixed-length argument: raw bytes from a binary frame, hexadecimal from a text line.
+static inline bool parseBinaryArgument(Arg &arg, byte *data, const uint8_t length)
+{
+  if (arg.getType() == ArgType::Bytes)
+  {
+    // Binary frames carry the raw bytes, no hex decoding needed
+    if (arg.getLength() != length)
+    {
+      return false;
+    }
+    memcpy(data, arg.getString(), length);
+    return true;
+  }
+  return arg.getLength() == 2 * length && parseSeedString(arg.getString(), data, length);
+}
+
+// Check the provided tag argument against the pending challenge.
+static bool challengeCheck(SerialCommands &sender, Args &args, const KeyboardController::ChallengeAction action)
+{
+  if (!KeyboardController::isSeedChecked())
+  {
+    Utilities::printError(sender, F("Seed not checked"));
+    return false;
+  }
+
+  byte tag[SipHash::TAG_LENGTH];
+  if (!parseBinaryArgument(args[0], tag, sizeof(tag)))
+  {
+    Utilities::printError(sender, F("Invalid tag format"));
+    return false;
+  }
+  if (!KeyboardController::verifyChallenge(action, tag))
+  {
+    Utilities::printError(sender, F("Challenge failed"));
+    return false;
+  }
+  return true;
+}
+
+// Find a trace component by name, reporting an error if there is none.
+static inline bool findTraceComponent(SerialCommands &sender, const char *componentName, TraceComponent &component)
+{
+  if (!Traceable::find(componentName, component))
+  {
+    Utilities::printError(sender, F("Component not found"));
+    return false;
+  }
+  return true;
+}
+
+#if AUTH_SEED_COMMANDS
 // Check the provided seed argument against the generated seed.
 bool seedCheck(SerialCommands &sender, Args &args)
 {
@@ -40,7 +283,7 @@ bool seedCheck(SerialCommands &sender, Args &args)
   }
 
   byte seed[SEED_LENGTH];
-  if (!parseSeedString(args[0].getString(), seed, SEED_LENGTH))
+  if (!parseBinaryArgument(args[0], seed, SEED_LENGTH))
   {
     Utilities::printError(sender, F("Invalid seed format"));
     return false;
@@ -50,24 +293,15 @@ bool seedCheck(SerialCommands &sender, Args &args)
   KeyboardController::generateSeed(genSeed, SEED_LENGTH);
   KeyboardController::cypherDecryption(seed, SEED_LENGTH, genSeed, SEED_LENGTH, KeyboardController::generateSalt());
 
-  // Check index 0 first for early exit
-  if (seed[0] != genSeed[0])
+  // Constant time, how far a guess matched must not show in the reply time
+  if (!SipHash::equal(seed, genSeed, SEED_LENGTH))
   {
     Utilities::printError(sender, F("Seed not matched"));
     return false;
   }
-
-  // Only check remaining indices if first one matched
-  for (int i = 1; i < SEED_LENGTH; ++i)
-  {
-    if (seed[i] != genSeed[i])
-    {
-      Utilities::printError(sender, F("Seed not matched"));
-      return false;
-    }
-  }
   return true;
 }
+#endif
 
 //================ Command Callbacks ==================
 
@@ -75,33 +309,154 @@ void commandHelp(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  sender.listCommands();
-  Utilities::printOK(sender);
+  startReport(sender, &sender == &bluetoothCommands ? renderBluetoothHelp : renderConsoleHelp);
 }
 
 void commandPing(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  sender.getSerial().println(F("pong"));
-  Utilities::printOK(sender);
+  ResponseBuilderN<REPLY_BUFFER_SIZE> response;
+  response.println(F("pong"));
+  response.ok();
+  response.send(sender.getSerial());
+}
+
+void commandPingTime(SerialCommands &sender, Args &args)
+{
+  // The parser dispatches the command right here
+  const uint32_t dispatched = micros();
+  const char *token = args[0].getString();
+  if (strlen(token) > PING_TOKEN_MAX_LENGTH)
+  {
+    Utilities::printError(sender, F("Token too long"));
+    return;
+  }
+
+  const uint32_t delivered = crcPackageInterface.getPlainDeliveryMicros();
+  ResponseBuilderN<PING_REPLY_BUFFER_SIZE> response;
+  response.print(F("pong "));
+  response.print(token);
+  response.print(F(" rx "));
+#if HC05_HARDWARE_UART
+  response.print('-');
+#else
+  // A burst begun after the delivery is later traffic, the request's own start is lost
+  const uint32_t received = softwareSerial.getRxBurstMicros();
+  if (received != 0 && static_cast<int32_t>(delivered - received) >= 0)
+  {
+    response.print(received);
+  }
+  else
+  {
+    response.print('-');
+  }
+#endif
+  response.print(F(" link "));
+  response.print(delivered);
+  response.print(F(" cmd "));
+  response.print(dispatched);
+  response.print(F(" reply "));
+  response.println(micros());
+  response.ok();
+  response.send(sender.getSerial());
 }
 
 void commandRam(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  statisticController.printRam(sender.getSerial());
-  Utilities::printOK(sender);
+  startReport(sender, renderRam);
 }
 
 void commandStatistics(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  statisticController.printStatisticTable(sender.getSerial(),
-                                          statistics,
-                                          lengthOfStatistics);
+  startReport(sender, renderStatistics);
+}
+
+void commandStalls(SerialCommands &sender, Args &args)
+{
+  UNUSED(args);
+
+  startReport(sender, renderStalls);
+}
+
+void commandSetStallThreshold(SerialCommands &sender, Args &args)
+{
+  stallRecorder.setThreshold(static_cast<uint16_t>(args[0].getInt()));
+  Utilities::printOK(sender);
+}
+
+void commandTasks(SerialCommands &sender, Args &args)
+{
+  UNUSED(args);
+
+  startReport(sender, renderTasks);
+}
+
+void commandSetIdleSleep(SerialCommands &sender, Args &args)
+{
+  taskScheduler.setIdleSleep(args[0].getInt() != 0);
+  Utilities::printOK(sender);
+}
+
+void commandTelemetry(SerialCommands &sender, Args &args)
+{
+  UNUSED(args);
+
+  // The frames follow the OK, drained from the main loop
+  if (!telemetryController.request(sender.getSerial()))
+  {
+    Utilities::printError(sender, F("Telemetry busy"));
+    return;
+  }
+  Utilities::printOK(sender);
+}
+
+void commandJournal(SerialCommands &sender, Args &args)
+{
+  UNUSED(args);
+
+  // The records and the OK follow, read and written from the main loop
+  if (!eventJournal.dump(sender.getSerial()))
+  {
+    Utilities::printError(sender, F("Journal busy"));
+  }
+}
+
+void commandSetTelemetryRate(SerialCommands &sender, Args &args)
+{
+  telemetryController.setIntervals(static_cast<uint16_t>(args[0].getInt()), static_cast<uint16_t>(args[1].getInt()));
+  Utilities::printOK(sender);
+}
+
+void commandBench(SerialCommands &sender, Args &args)
+{
+#if LINK_BENCH
+  if (!hc05.isConnected())
+  {
+    Utilities::printError(sender, F("Not connected"));
+    return;
+  }
+  // The report and the OK follow once the run is over
+  if (!benchController.start(sender.getSerial(), static_cast<uint16_t>(args[0].getInt()), static_cast<uint8_t>(args[1].getInt())))
+  {
+    Utilities::printError(sender, F("Bench busy"));
+  }
+#else
+  // The entry keeps its place in the table, the binary opcodes of the later commands depend on it
+  UNUSED(args);
+  Utilities::printError(sender, F("Build with LINK_BENCH=1"));
+#endif
+}
+
+void commandLinkStatistics(SerialCommands &sender, Args &args)
+{
+  UNUSED(args);
+
+  crcPackageInterface.printCompactStatistic(sender.getSerial());
   Utilities::printOK(sender);
 }
 
@@ -112,9 +467,11 @@ void commandGenSalt(SerialCommands &sender, Args &args)
   if (!requireSeedNotChecked(sender))
     return;
   const byte salt = KeyboardController::generateSalt();
-  Utilities::printHexByte(sender, salt);
-  sender.getSerial().println();
-  Utilities::printOK(sender);
+  ResponseBuilderN<REPLY_BUFFER_SIZE> response;
+  response.hex(salt);
+  response.println();
+  response.ok();
+  response.send(sender.getSerial());
 }
 
 void commandGenSeed(SerialCommands &sender, Args &args)
@@ -123,16 +480,21 @@ void commandGenSeed(SerialCommands &sender, Args &args)
 
   if (!requireSeedNotChecked(sender))
     return;
+  // The seed becomes the SipHash key, which too little entropy would make guessable
+  if (!entropyPool.isReady())
+  {
+    Utilities::printError(sender, F("Entropy not ready"));
+    return;
+  }
   const byte salt = KeyboardController::generateSalt();
   byte seed[SEED_LENGTH];
   KeyboardController::generateSeed(seed, SEED_LENGTH);
   KeyboardController::cypherEncryption(seed, SEED_LENGTH, salt);
-  for (int i = 0; i < SEED_LENGTH; ++i)
-  {
-    Utilities::printHexByte(sender, seed[i]);
-  }
-  sender.getSerial().println();
-  Utilities::printOK(sender);
+  ResponseBuilderN<REPLY_BUFFER_SIZE> response;
+  response.hex(seed, SEED_LENGTH);
+  response.println();
+  response.ok();
+  response.send(sender.getSerial());
 }
 
 void commandCheck(SerialCommands &sender, Args &args)
@@ -152,24 +514,74 @@ void commandState(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  sender.getSerial().println(keyboardController.state());
-  Utilities::printOK(sender);
+  ResponseBuilderN<REPLY_BUFFER_SIZE> response;
+  response.println(keyboardController.state());
+  response.ok();
+  response.send(sender.getSerial());
 }
 
 void commandLock(SerialCommands &sender, Args &args)
 {
+#if AUTH_SEED_COMMANDS
   if (!seedCheck(sender, args))
     return;
   keyboardController.lock();
   Utilities::printOK(sender);
+#else
+  UNUSED(args);
+  Utilities::printError(sender, F("Use lockmac"));
+#endif
 }
 
 void commandUnlock(SerialCommands &sender, Args &args)
 {
+#if AUTH_SEED_COMMANDS
   if (!seedCheck(sender, args))
     return;
   keyboardController.unlock();
   Utilities::printOK(sender);
+#else
+  UNUSED(args);
+  Utilities::printError(sender, F("Use unlockmac"));
+#endif
+}
+
+void commandChallenge(SerialCommands &sender, Args &args)
+{
+  UNUSED(args);
+
+  if (!KeyboardController::isSeedChecked())
+  {
+    Utilities::printError(sender, F("Seed not checked"));
+    return;
+  }
+  byte nonce[CHALLENGE_NONCE_LENGTH];
+  if (!KeyboardController::createChallenge(nonce))
+  {
+    Utilities::printError(sender, F("EEPROM busy"));
+    return;
+  }
+  ResponseBuilderN<REPLY_BUFFER_SIZE> response;
+  response.hex(nonce, sizeof(nonce));
+  response.println();
+  response.ok();
+  response.send(sender.getSerial());
+}
+
+void commandLockMac(SerialCommands &sender, Args &args)
+{
+  if (!challengeCheck(sender, args, KeyboardController::CHALLENGE_LOCK))
+    return;
+  keyboardController.lock();
+  Utilities::printOK(sender);
+}
+
+void commandUnlockMac(SerialCommands &sender, Args &args)
+{
+  if (!challengeCheck(sender, args, KeyboardController::CHALLENGE_UNLOCK))
+    return;
+  keyboardController.unlock();
+  Utilities::printOK(sender);
 }
 
 void commandReset(SerialCommands &sender, Args &args)
@@ -192,27 +604,17 @@ void commandVersion(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  sender.getSerial().println(KeyboardController::getVersion());
-  Utilities::printOK(sender);
+  ResponseBuilderN<REPLY_BUFFER_SIZE> response;
+  response.println(KeyboardController::getVersion());
+  response.ok();
+  response.send(sender.getSerial());
 }
 
 void commandListTraceables(SerialCommands &sender, Args &args)
 {
   UNUSED(args);
 
-  sender.getSerial().println(F("Traceable : Compile Time Level : Run Time Level"));
-  for (ArduinoMap<const __FlashStringHelper *, Traceable::Settings *>::ConstIterator it =
-           Traceable::getSettingsMap().cbegin();
-       it != Traceable::getSettingsMap().cend();
-       ++it)
-  {
-    sender.getSerial().print((*it).first);
-    sender.getSerial().print(F(": "));
-    sender.getSerial().print(static_cast<uint8_t>((*it).second->getCompileTimeLevel()));
-    sender.getSerial().print(F(": "));
-    sender.getSerial().println(static_cast<uint8_t>((*it).second->getLevel()));
-  }
-  Utilities::printOK(sender);
+  startReport(sender, renderTraceables);
 }
 
 void commandSetTraceLevel(SerialCommands &sender, Args &args)
@@ -226,22 +628,20 @@ void commandSetTraceLevel(SerialCommands &sender, Args &args)
     return;
   }
 
-  Traceable::Settings *settings = nullptr;
-  for (auto it = Traceable::getSettingsMap().cbegin(); it != Traceable::getSettingsMap().cend(); ++it)
-  {
-    if (strcmp_P(componentName, (PGM_P)(*it).first) == 0)
-    {
-      settings = (*it).second;
-      break;
-    }
-  }
+  TraceComponent component;
+  if (!findTraceComponent(sender, componentName, component))
+    return;
 
-  if (!settings)
-  {
-    Utilities::printError(sender, F("Component not found"));
+  Traceable(component).setLevel(static_cast<Traceable::Level>(level));
+  Utilities::printOK(sender);
+}
+
+void commandSetTraceSink(SerialCommands &sender, Args &args)
+{
+  TraceComponent component;
+  if (!findTraceComponent(sender, args[0].getString(), component))
     return;
-  }
 
-  settings->setLevel(static_cast<Traceable::Level>(level));
+  Traceable(component).setOutput(args[1].getInt() ? static_cast<Print &>(traceSink) : Serial);
   Utilities::printOK(sender);
 }
@@ -11,14 +11,10 @@
 #undef CLASS_TRACE_LEVEL
 #define CLASS_TRACE_LEVEL DEBUG_EEPROM_CONTROLLER
 #include "TraceHelper.h"
-// Constants
-constexpr uint8_t EXT_EEPROM_I2C_ADDRESS = 0x50;
-constexpr uint8_t EXT_EEPROM_PAGE_SIZE = 32;
-constexpr uint16_t EXT_EEPROM_TOTAL_SIZE = 8192;
-constexpr uint8_t INT_EEPROM_PAGE_SIZE = 32;
-
-EEPROMController::EEPROMController(I2C &i2c)
-    : Traceable(F("EEPROMController"), static_cast<Level>(DEBUG_EEPROM_CONTROLLER)), p_i2c(&i2c), m_state(IDLE), m_currentCounter(0)
+
+EEPROMController::EEPROMController(I2C &i2c, EEPROMWriter &writer)
+    : Traceable(TraceComponent::EEPROM_CONTROLLER), p_i2c(&i2c), p_writer(&writer), m_state(IDLE), m_currentCounter(0),
+      m_skippedPages(0), m_verify(true), m_phase(PAGE_READ), m_transaction(), m_writeCycleTimer(EXT_EEPROM_WRITE_CYCLE_MS)
 {
 } // end EEPROMController
 
@@ -27,14 +23,18 @@ EEPROMController::State EEPROMController::state() const
   return m_state;
 } // end state
 
-void EEPROMController::format()
+void EEPROMController::format(const bool verify)
 {
   if (m_state == IDLE)
   {
     m_state = FORMATTING_EXTERNAL;
     p_i2c->begin();
+    p_i2c->setSpeed(true);
     p_i2c->timeOut(80);
     m_currentCounter = 0;
+    m_skippedPages = 0;
+    m_verify = verify;
+    startNextPage();
   } // end if
 } // end format
 
@@ -46,73 +46,124 @@ void EEPROMController::loop()
     break;
 
   case FORMATTING_EXTERNAL:
-    if (!checkWriteComplete())
+    p_i2c->loop();
+    if (m_transaction.status == I2C_PENDING)
     {
       break;
     }
 
-    if (m_currentCounter >= (EXT_EEPROM_TOTAL_SIZE / EXT_EEPROM_PAGE_SIZE))
+    switch (m_phase)
     {
-      p_i2c->end();
-      m_state = FORMATTING_INTERNAL;
-      m_currentCounter = 0;
-      TRACE_INFO()
-          << F("External eeprom formatting done")
-          << endl;
+    case PAGE_READ:
+      // The read chain stops past the end, at a page that is not blank or after a failed read
+      if (m_currentCounter < EXT_EEPROM_PAGE_COUNT)
+      {
+        startExternal(PAGE_WRITE);
+      }
+      else
+      {
+        startNextPage();
+      }
       break;
-    }
 
-    formatExternalPage();
+    case PAGE_WRITE:
+      if (m_writeCycleTimer.isReady())
+      {
+        startExternal(WRITE_POLL);
+      }
+      break;
+
+    case WRITE_POLL:
+      if (m_transaction.status != 0)
+      {
+        // Still in the write cycle
+        startExternal(WRITE_POLL);
+        break;
+      }
+      ++m_currentCounter;
+      startNextPage();
+      break;
+    } // end switch
     break;
 
   case FORMATTING_INTERNAL:
-    if (m_currentCounter >= EEPROM.length())
+    if (p_writer->isIdle())
     {
       m_state = IDLE;
-      m_currentCounter = 0;
       TRACE_INFO()
           << F("Internal eeprom formatting done")
           << endl;
-      break;
     }
-
-    formatInternalPages();
     break;
   } // end switch
 } // end loop
 
-bool EEPROMController::checkWriteComplete() const
+void EEPROMController::startNextPage()
 {
-  const uint8_t result = p_i2c->write(EXT_EEPROM_I2C_ADDRESS);
+  if (m_currentCounter < EXT_EEPROM_PAGE_COUNT)
+  {
+    startExternal(m_verify ? PAGE_READ : PAGE_WRITE);
+    return;
+  }
 
-  return result == 0;
+  p_i2c->end();
+  m_state = FORMATTING_INTERNAL;
+  m_currentCounter = 0;
+  p_writer->fill(0, EEPROM.length(), 0x00);
+  TRACE_INFO()
+      << F("External eeprom formatting done, blank pages: ")
+      << m_skippedPages
+      << endl;
 }
 
-void EEPROMController::formatExternalPage()
+void EEPROMController::startExternal(const ExternalPhase phase)
 {
-  const uint16_t startAddress = m_currentCounter * EXT_EEPROM_PAGE_SIZE;
-  const uint8_t pageData[EXT_EEPROM_PAGE_SIZE] = {0x00};
-
-  p_i2c->write16(EXT_EEPROM_I2C_ADDRESS, startAddress, pageData, EXT_EEPROM_PAGE_SIZE);
-
-  TRACE_DEBUG()
-      << F("External eeprom page: ")
-      << m_currentCounter
-      << endl;
+  m_phase = phase;
+  m_transaction.address = EXT_EEPROM_I2C_ADDRESS;
+  m_transaction.registerAddress = m_currentCounter * EXT_EEPROM_PAGE_SIZE;
+  m_transaction.registerBytes = (phase == WRITE_POLL) ? 0 : 2;
+  m_transaction.txData = m_page;
+  m_transaction.txLength = (phase == PAGE_WRITE) ? EXT_EEPROM_PAGE_SIZE : 0;
+  m_transaction.rxData = m_page;
+  m_transaction.rxLength = (phase == PAGE_READ) ? EXT_EEPROM_PAGE_SIZE : 0;
+  m_transaction.callback = (phase == PAGE_READ) ? pageReadCallback : nullptr;
+  m_transaction.context = this;
+
+  if (phase == PAGE_WRITE)
+  {
+    memset(m_page, 0x00, sizeof(m_page));
+    m_writeCycleTimer.reset();
+    TRACE_DEBUG()
+        << F("External eeprom page: ")
+        << m_currentCounter
+        << endl;
+  }
 
-  ++m_currentCounter;
+  p_i2c->submit(m_transaction);
 }
 
-void EEPROMController::formatInternalPages()
+void EEPROMController::pageReadCallback(I2CTransaction &transaction)
 {
-  for (int i = 0; (i < INT_EEPROM_PAGE_SIZE) && (m_currentCounter < EEPROM.length()); ++i)
+  EEPROMController *const self = static_cast<EEPROMController *>(transaction.context);
+  if (transaction.status != 0)
   {
-    EEPROM.update(m_currentCounter, 0x00);
-    ++m_currentCounter;
+    return;
   }
 
-  TRACE_DEBUG()
-      << F("Internal eeprom counter: ")
-      << m_currentCounter
-      << endl;
-}
\ No newline at end of file
+  uint8_t bits = 0;
+  for (uint8_t i = 0; i < EXT_EEPROM_PAGE_SIZE; ++i)
+  {
+    bits |= self->m_page[i];
+  }
+  if (bits != 0)
+  {
+    return;
+  }
+
+  ++self->m_skippedPages;
+  if (++self->m_currentCounter < EXT_EEPROM_PAGE_COUNT)
+  {
+    transaction.registerAddress = self->m_currentCounter * EXT_EEPROM_PAGE_SIZE;
+    self->p_i2c->submit(transaction);
+  }
+}
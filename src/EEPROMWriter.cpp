@@ -0,0 +1,176 @@
+/**
+ * @file EEPROMWriter.cpp
+ * @brief Implementation of the interrupt driven internal EEPROM writer.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+
+// Project headers
+#include "EEPROMWriter.h"
+#include "Globals.h"
+
+/// Cells already holding their value that one interrupt skips before it returns
+constexpr uint8_t EEPROM_WRITER_SKIPS_PER_ISR = 8;
+
+EEPROMWriter::EEPROMWriter()
+    : m_fillAddress(0), m_fillLength(0), m_fillValue(0), m_fillAhead(0)
+{
+} // end EEPROMWriter
+
+void EEPROMWriter::write(const uint16_t address, const uint8_t value)
+{
+  const Write entry = {address, value};
+  while (!m_queue.push(entry))
+  {
+    // Full: the interrupt frees a slot when the running write cycle ends
+    if (!(SREG & _BV(SREG_I)) && !(EECR & _BV(EEPE)))
+    {
+      // It cannot run with interrupts off, so do its work here or this never ends
+      processISR();
+    }
+  }
+  resume();
+} // end write
+
+bool EEPROMWriter::fill(const uint16_t address, const uint16_t length, const uint8_t value)
+{
+  bool started = false;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (m_fillLength == 0)
+    {
+      m_fillAddress = address;
+      m_fillLength = length;
+      m_fillValue = value;
+      // Only write() pushes, so these are exactly the writes made before the fill
+      m_fillAhead = static_cast<uint8_t>(m_queue.available());
+      started = true;
+    }
+  }
+  if (started)
+  {
+    resume();
+  }
+  return started;
+} // end fill
+
+uint8_t EEPROMWriter::read(const uint16_t address)
+{
+  // With the interrupt paused the pop side is quiescent and the queue can be searched
+  pause();
+
+  bool pending = false;
+  uint8_t value = 0;
+  const bool filled = static_cast<uint16_t>(address - m_fillAddress) < m_fillLength;
+  const uint8_t queued = m_queue.available();
+  for (uint8_t i = 0; i < queued; ++i)
+  {
+    Write entry;
+    // The fill overwrites the writes made before it, not those made after
+    if (m_queue.peekAt(i, entry) && entry.address == address && (!filled || i >= m_fillAhead))
+    {
+      value = entry.value;
+      pending = true;
+    }
+  }
+  if (!pending && filled)
+  {
+    value = m_fillValue;
+    pending = true;
+  }
+
+  if (!pending)
+  {
+    // Waits for a running write cycle
+    value = eeprom_read_byte(reinterpret_cast<const uint8_t *>(address));
+  }
+
+  if (!m_queue.isEmpty() || m_fillLength != 0)
+  {
+    resume();
+  }
+  return value;
+} // end read
+
+bool EEPROMWriter::isIdle() const
+{
+  uint16_t fillLength;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    fillLength = m_fillLength;
+  }
+  return m_queue.isEmpty() && fillLength == 0 && !(EECR & _BV(EEPE));
+} // end isIdle
+
+void EEPROMWriter::processISR()
+{
+  for (uint8_t skipped = 0; skipped < EEPROM_WRITER_SKIPS_PER_ISR; ++skipped)
+  {
+    Write entry;
+    bool queued = m_queue.peekAt(0, entry);
+    if (queued && m_fillAhead == 0 && static_cast<uint16_t>(entry.address - m_fillAddress) < m_fillLength)
+    {
+      // Made during the fill for a cell it has not reached: the fill stores that cell first
+      queued = false;
+    }
+
+    if (queued)
+    {
+      m_queue.pop(entry);
+      if (m_fillAhead != 0)
+      {
+        --m_fillAhead;
+      }
+    }
+    else
+    {
+      if (m_fillLength == 0)
+      {
+        pause();
+        return;
+      }
+      entry.address = m_fillAddress++;
+      entry.value = m_fillValue;
+      --m_fillLength;
+    }
+
+    EEAR = entry.address;
+    EECR |= _BV(EERE);
+    if (EEDR != entry.value)
+    {
+      EEDR = entry.value;
+      // EEPE must follow EEMPE within four cycles, interrupts are off here
+      EECR |= _BV(EEMPE);
+      EECR |= _BV(EEPE);
+      return;
+    }
+  }
+  // Unchanged cells only; EE_READY is still pending and fires again
+} // end processISR
+
+void EEPROMWriter::resume()
+{
+  // Single sbi/cbi on EECR, safe against the interrupt
+  EECR |= _BV(EERIE);
+} // end resume
+
+void EEPROMWriter::pause()
+{
+  EECR &= static_cast<uint8_t>(~_BV(EERIE));
+} // end pause
+
+/**
+ * @brief EEPROM ready, start the next queued write.
+ */
+ISR(EE_READY_vect)
+{
+  MEASURE_ISR(eepromIsrStatistic)
+  {
+    eepromWriter.processISR();
+  }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file EntropyPool.cpp
+ * @brief Implementation of the background entropy pool.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Project headers
+#include "EntropyPool.h"
+
+/// Bytes of an output message, domain and counter; SipHash covers the length, which keeps
+/// outputs (5 bytes), rekeying (2) and sample blocks (8) apart
+constexpr uint8_t OUTPUT_MESSAGE_LENGTH = 5;
+/// First byte of the output messages
+constexpr uint8_t OUTPUT_DOMAIN = 'O';
+/// First byte of the rekey messages
+constexpr uint8_t REKEY_DOMAIN = 'K';
+
+EntropyPool::EntropyPool()
+    : m_pool(), m_block(), m_blockFill(0), m_poolHalf(0), m_credit(0), m_lastAdc(0), m_lastLink(0),
+      m_lastLinkSpacing(0), m_outputCount(0), m_isrTiming(0), m_isrEvents(0), m_seenIsrEvents(0)
+{
+} // end EntropyPool
+
+void EntropyPool::begin()
+{
+  pinMode(ENTROPY_ADC_PIN, INPUT);
+  // AVcc reference, right adjusted, clock F_CPU / 128
+  ADMUX = _BV(REFS0) | (ENTROPY_ADC_CHANNEL & 0x07);
+  ADCSRB = (ENTROPY_ADC_CHANNEL & 0x08) ? _BV(MUX5) : 0;
+#if ENTROPY_ADC_CHANNEL < 8
+  DIDR0 |= _BV(ENTROPY_ADC_CHANNEL);
+#else
+  DIDR2 |= _BV(ENTROPY_ADC_CHANNEL - 8);
+#endif
+  ADCSRA = _BV(ADEN) | _BV(ADSC) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+} // end begin
+
+void EntropyPool::loop()
+{
+  // A conversion takes 104 us, long done since the last call
+  if (!(ADCSRA & _BV(ADSC)))
+  {
+    const uint8_t low = ADCL;
+    (void)ADCH; // Unlocks the result registers
+    addSample(low, (low != m_lastAdc) ? ENTROPY_CREDIT_ADC : 0);
+    m_lastAdc = low;
+    ADCSRA |= _BV(ADSC);
+  }
+
+  addSample(static_cast<uint8_t>(Statistic::now()), ENTROPY_CREDIT_TICK);
+
+  const uint8_t events = m_isrEvents;
+  if (events != m_seenIsrEvents)
+  {
+    m_seenIsrEvents = events;
+    addLinkSample(m_isrTiming);
+  }
+} // end loop
+
+void EntropyPool::addTiming()
+{
+  addLinkSample(static_cast<uint8_t>(Statistic::now()));
+} // end addTiming
+
+void EntropyPool::addLinkSample(const uint8_t timing)
+{
+  // A steady sender repeats its spacing, only the jitter around it is new
+  const uint8_t spacing = timing - m_lastLink;
+  addSample(timing, (spacing != m_lastLinkSpacing) ? ENTROPY_CREDIT_LINK : 0);
+  m_lastLink = timing;
+  m_lastLinkSpacing = spacing;
+} // end addLinkSample
+
+bool EntropyPool::read(byte *const data, const uint8_t length)
+{
+  const bool ready = isReady();
+  uint8_t message[OUTPUT_MESSAGE_LENGTH];
+  message[0] = OUTPUT_DOMAIN;
+  uint8_t offset = 0;
+  while (offset < length)
+  {
+    ++m_outputCount;
+    memcpy(message + 1, &m_outputCount, sizeof(m_outputCount));
+    uint8_t block[SipHash::TAG_LENGTH];
+    SipHash::mac(m_pool, message, sizeof(message), block);
+    const uint8_t count = min(static_cast<uint8_t>(length - offset), SipHash::TAG_LENGTH);
+    memcpy(data + offset, block, count);
+    offset += count;
+  }
+  rekey();
+  return ready;
+} // end read
+
+void EntropyPool::addSample(const uint8_t sample, const uint8_t credit)
+{
+  m_block[m_blockFill++] = sample;
+  if (m_credit < ENTROPY_POOL_READY_BITS * 8U)
+  {
+    m_credit += credit;
+  }
+  if (m_blockFill < sizeof(m_block))
+  {
+    return;
+  }
+
+  // Whiten into one half of the pool, alternating
+  uint8_t mixed[SipHash::TAG_LENGTH];
+  SipHash::mac(m_pool, m_block, sizeof(m_block), mixed);
+  uint8_t *const half = m_pool + m_poolHalf * SipHash::TAG_LENGTH;
+  for (uint8_t i = 0; i < SipHash::TAG_LENGTH; ++i)
+  {
+    half[i] ^= mixed[i];
+  }
+  m_poolHalf ^= 1;
+  m_blockFill = 0;
+} // end addSample
+
+void EntropyPool::rekey()
+{
+  static_assert(sizeof(m_pool) == 2 * SipHash::TAG_LENGTH, "The pool is rekeyed in two tags");
+  uint8_t message[2] = {REKEY_DOMAIN, 0};
+  uint8_t next[sizeof(m_pool)];
+  SipHash::mac(m_pool, message, sizeof(message), next);
+  message[1] = 1;
+  SipHash::mac(m_pool, message, sizeof(message), next + SipHash::TAG_LENGTH);
+  memcpy(m_pool, next, sizeof(m_pool));
+} // end rekey
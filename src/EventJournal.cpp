@@ -0,0 +1,421 @@
+/**
+ * @file EventJournal.cpp
+ * @brief Implementation of the external EEPROM event journal.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <util/crc16.h>
+#include <stddef.h>
+
+// Third-party libraries
+#include <MemoryUsage.h>
+
+// Project headers
+#include "EventJournal.h"
+#include "Globals.h"
+#include "Utilities.h"
+
+#include "TraceLevel.h"
+#undef CLASS_TRACE_LEVEL
+#define CLASS_TRACE_LEVEL DEBUG_EVENT_JOURNAL
+#include "TraceHelper.h"
+
+/// Longest dump line, a line waits until the output has this much room
+constexpr uint8_t JOURNAL_DUMP_LINE_SIZE = 60;
+/// Milliseconds a dump waits for room before it gives up
+constexpr uint16_t JOURNAL_DUMP_STALL_MS = 5000;
+
+/**
+ * @brief Name of an event in the dump.
+ */
+static const __FlashStringHelper *eventName(const uint8_t event)
+{
+  switch (event)
+  {
+  case EventJournal::EVENT_RESET:
+    return F("reset");
+  case EventJournal::EVENT_WATCHDOG:
+    return F("watchdog");
+  case EventJournal::EVENT_LOCK:
+    return F("lock");
+  case EventJournal::EVENT_UNLOCK:
+    return F("unlock");
+  case EventJournal::EVENT_CONNECT:
+    return F("connect");
+  case EventJournal::EVENT_DISCONNECT:
+    return F("disconnect");
+  default:
+    return F("?");
+  }
+}
+
+EventJournal::EventJournal(I2C &i2c)
+    : Traceable(TraceComponent::EVENT_JOURNAL), p_i2c(&i2c), m_available(false), m_operation(NONE), m_transaction(),
+      m_retryWrite(false), m_page(), m_entries(), m_entryCount(0), m_dropped(0), m_nextPage(0), m_sequence(1), m_boot(0),
+      m_writeCycleTimer(EXT_EEPROM_WRITE_CYCLE_MS), m_flushTimer(JOURNAL_FLUSH_INTERVAL_S * 1000u),
+      m_snapshotTimer(JOURNAL_SNAPSHOT_INTERVAL_S * 1000ul), p_dumpOutput(nullptr), m_dumpFirst(0), m_dumpPages(0),
+      m_dumpLimit(0), m_dumpLoaded(false), m_dumpLines(0), m_dumpLine(0), m_dumpTimer(JOURNAL_DUMP_STALL_MS)
+{
+} // end EventJournal
+
+bool EventJournal::begin()
+{
+  p_i2c->begin();
+  p_i2c->setSpeed(true);
+  p_i2c->timeOut(80);
+
+  // A reset may have cut into a write cycle, the EEPROM acknowledges once it ends
+  SimpleTimer<uint8_t> writeCycleTimer(EXT_EEPROM_WRITE_CYCLE_MS);
+  while (p_i2c->write(EXT_EEPROM_I2C_ADDRESS) != 0 && !writeCycleTimer.isReady())
+  {
+  }
+
+  bool valid = false;
+  if (!readPage(0, valid))
+  {
+    TRACE_WARN()
+        << F("Journal EEPROM not found")
+        << endl;
+    return false;
+  }
+
+  // Without a record on page 0 the newest one is the last page, or there is none
+  uint16_t head = EXT_EEPROM_PAGE_COUNT - 1;
+  if (valid)
+  {
+    // Pages up to the newest record carry page 0's sequence number or higher
+    const uint32_t first = m_page.sequence;
+    uint16_t low = 0;
+    uint16_t high = EXT_EEPROM_PAGE_COUNT;
+    while (high - low > 1)
+    {
+      const uint16_t middle = (low + high) / 2;
+      if (!readPage(middle, valid))
+      {
+        return false;
+      }
+      if (valid && m_page.sequence >= first)
+      {
+        low = middle;
+      }
+      else
+      {
+        high = middle;
+      }
+    }
+    head = low;
+  }
+
+  if (!readPage(head, valid))
+  {
+    return false;
+  }
+  if (valid)
+  {
+    m_sequence = m_page.sequence + 1;
+    m_boot = m_page.boot + 1;
+  }
+  m_nextPage = (head + 1) % EXT_EEPROM_PAGE_COUNT;
+  m_available = true;
+
+  TRACE_INFO()
+      << F("Journal next page: ")
+      << m_nextPage
+      << F(", sequence: ")
+      << m_sequence
+      << F(", boot: ")
+      << m_boot
+      << endl;
+  return true;
+} // end begin
+
+void EventJournal::record(const Event event, const uint8_t arg, const uint16_t value)
+{
+  if (!m_available)
+  {
+    return;
+  }
+  if (m_entryCount == JOURNAL_ENTRIES_PER_PAGE)
+  {
+    ++m_dropped;
+    return;
+  }
+  if (m_entryCount == 0)
+  {
+    m_flushTimer.reset();
+  }
+
+  Entry &entry = m_entries[m_entryCount++];
+  entry.timestamp = millis();
+  entry.event = event;
+  entry.arg = arg;
+  entry.value = value;
+} // end record
+
+bool EventJournal::dump(Print &output)
+{
+  if (!m_available || p_dumpOutput != nullptr)
+  {
+    return false;
+  }
+
+  output.print(F("Journal sequence: "));
+  output.print(m_sequence);
+  output.print(F(", boot: "));
+  output.print(m_boot);
+  output.print(F(", dropped: "));
+  output.println(m_dropped);
+
+  p_dumpOutput = &output;
+  m_dumpFirst = m_nextPage;
+  m_dumpPages = 0;
+  m_dumpLimit = m_sequence;
+  m_dumpLoaded = false;
+  m_dumpLine = 0;
+  m_dumpTimer.reset();
+  return true;
+} // end dump
+
+void EventJournal::loop()
+{
+  if (!m_available)
+  {
+    return;
+  }
+
+  p_i2c->loop();
+  if (m_operation != NONE)
+  {
+    if (m_transaction.status == I2C_PENDING)
+    {
+      return;
+    }
+    finishOperation();
+  }
+
+  // The EEPROM does not answer during its write cycle
+  if (!m_writeCycleTimer.isReady())
+  {
+    return;
+  }
+
+  if (m_retryWrite)
+  {
+    // m_page is untouched since the failed write
+    m_retryWrite = false;
+    p_i2c->submit(m_transaction);
+    m_operation = WRITE;
+  }
+  else if (m_entryCount == JOURNAL_ENTRIES_PER_PAGE || (m_entryCount != 0 && m_flushTimer.isReady()))
+  {
+    startWrite(false);
+  }
+  else if (m_snapshotTimer.isEnabled() && m_snapshotTimer.isReady())
+  {
+    m_snapshotTimer.reset();
+    startWrite(true);
+  }
+  else if (p_dumpOutput != nullptr)
+  {
+    continueDump();
+  }
+} // end loop
+
+bool EventJournal::readPage(const uint16_t index, bool &valid)
+{
+  valid = false;
+  if (p_i2c->read16(EXT_EEPROM_I2C_ADDRESS, index * EXT_EEPROM_PAGE_SIZE, EXT_EEPROM_PAGE_SIZE,
+                    reinterpret_cast<uint8_t *>(&m_page)) != 0)
+  {
+    return false;
+  }
+  valid = isValid(m_page);
+  return true;
+} // end readPage
+
+void EventJournal::startWrite(const bool snapshot)
+{
+  memset(&m_page, 0, sizeof(m_page));
+  m_page.sequence = m_sequence;
+  m_page.boot = m_boot;
+  if (snapshot)
+  {
+    m_page.count = SNAPSHOT;
+    m_page.snapshot.timestamp = millis();
+    m_page.snapshot.lowestFreeRam = MemoryUsage::lowestFreeRam();
+    m_page.snapshot.loopAverage = loopStatistic.getAverage();
+    m_page.snapshot.loopMax = loopStatistic.getMax();
+    m_page.snapshot.lockLatencyMax = keyboardController.lockLatency().getMax();
+  }
+  else
+  {
+    m_page.count = m_entryCount;
+    memcpy(m_page.entries, m_entries, m_entryCount * sizeof(Entry));
+    m_entryCount = 0;
+  }
+  m_page.crc = pageCrc(m_page);
+
+  m_transaction.address = EXT_EEPROM_I2C_ADDRESS;
+  m_transaction.registerAddress = m_nextPage * EXT_EEPROM_PAGE_SIZE;
+  m_transaction.registerBytes = 2;
+  m_transaction.txData = reinterpret_cast<const uint8_t *>(&m_page);
+  m_transaction.txLength = EXT_EEPROM_PAGE_SIZE;
+  m_transaction.rxData = nullptr;
+  m_transaction.rxLength = 0;
+  m_transaction.callback = nullptr;
+  p_i2c->submit(m_transaction);
+  m_operation = WRITE;
+
+  // A dump page that was in m_page is read again
+  m_dumpLoaded = false;
+} // end startWrite
+
+void EventJournal::startDumpRead()
+{
+  m_transaction.address = EXT_EEPROM_I2C_ADDRESS;
+  m_transaction.registerAddress = ((m_dumpFirst + m_dumpPages) % EXT_EEPROM_PAGE_COUNT) * EXT_EEPROM_PAGE_SIZE;
+  m_transaction.registerBytes = 2;
+  m_transaction.txData = nullptr;
+  m_transaction.txLength = 0;
+  m_transaction.rxData = reinterpret_cast<uint8_t *>(&m_page);
+  m_transaction.rxLength = EXT_EEPROM_PAGE_SIZE;
+  m_transaction.callback = nullptr;
+  p_i2c->submit(m_transaction);
+  m_operation = DUMP_READ;
+} // end startDumpRead
+
+void EventJournal::finishOperation()
+{
+  const Operation operation = m_operation;
+  m_operation = NONE;
+  m_writeCycleTimer.reset();
+
+  if (operation == WRITE)
+  {
+    if (m_transaction.status != 0)
+    {
+      TRACE_DEBUG()
+          << F("Journal write failed: ")
+          << m_transaction.status
+          << endl;
+      m_retryWrite = true;
+      return;
+    }
+    m_nextPage = (m_nextPage + 1) % EXT_EEPROM_PAGE_COUNT;
+    ++m_sequence;
+    return;
+  }
+
+  // A failed read is repeated by the next dump step
+  if (m_transaction.status == 0)
+  {
+    // m_dumpLine survives a read again after a write
+    m_dumpLoaded = true;
+    m_dumpLines = 0;
+    if (isValid(m_page) && m_page.sequence < m_dumpLimit)
+    {
+      m_dumpLines = 1 + ((m_page.count == SNAPSHOT) ? 1 : m_page.count);
+    }
+  }
+} // end finishOperation
+
+void EventJournal::continueDump()
+{
+  if (m_dumpTimer.isReady())
+  {
+    TRACE_WARN()
+        << F("Journal dump stalled")
+        << endl;
+    p_dumpOutput = nullptr;
+    return;
+  }
+
+  if (m_dumpPages == EXT_EEPROM_PAGE_COUNT)
+  {
+    if (p_dumpOutput->availableForWrite() >= JOURNAL_DUMP_LINE_SIZE)
+    {
+      Utilities::printOK(*p_dumpOutput);
+      p_dumpOutput = nullptr;
+    }
+    return;
+  }
+
+  if (!m_dumpLoaded)
+  {
+    startDumpRead();
+    return;
+  }
+
+  while (m_dumpLine < m_dumpLines && p_dumpOutput->availableForWrite() >= JOURNAL_DUMP_LINE_SIZE)
+  {
+    printLine(*p_dumpOutput, m_dumpLine++);
+    m_dumpTimer.reset();
+  }
+  if (m_dumpLine < m_dumpLines)
+  {
+    return;
+  }
+
+  m_dumpLoaded = false;
+  m_dumpLine = 0;
+  ++m_dumpPages;
+  m_dumpTimer.reset();
+} // end continueDump
+
+void EventJournal::printLine(Print &print, const uint8_t line) const
+{
+  if (line == 0)
+  {
+    print.print(F("Record "));
+    print.print(m_page.sequence);
+    print.print(F(", boot "));
+    print.println(m_page.boot);
+    return;
+  }
+
+  if (m_page.count == SNAPSHOT)
+  {
+    const Snapshot &snapshot = m_page.snapshot;
+    print.print(F("  ["));
+    print.print(snapshot.timestamp);
+    print.print(F("] stats ram:"));
+    print.print(snapshot.lowestFreeRam);
+    print.print(F(" loop:"));
+    print.print(snapshot.loopAverage);
+    print.print('/');
+    print.print(snapshot.loopMax);
+    print.print(F(" lock:"));
+    print.println(snapshot.lockLatencyMax);
+    return;
+  }
+
+  const Entry &entry = m_page.entries[line - 1];
+  print.print(F("  ["));
+  print.print(entry.timestamp);
+  print.print(F("] "));
+  print.print(eventName(entry.event));
+  print.print(' ');
+  print.print(entry.arg);
+  print.print(' ');
+  print.println(entry.value);
+} // end printLine
+
+uint16_t EventJournal::pageCrc(const Page &page)
+{
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&page);
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 0; i < offsetof(Page, crc); ++i)
+  {
+    crc = _crc_xmodem_update(crc, bytes[i]);
+  }
+  return crc;
+} // end pageCrc
+
+bool EventJournal::isValid(const Page &page)
+{
+  return page.sequence != 0 && (page.count <= JOURNAL_ENTRIES_PER_PAGE || page.count == SNAPSHOT) &&
+         page.crc == pageCrc(page);
+} // end isValid
@@ -1,44 +1,93 @@
 #include "Globals.h"
 #include "CommandCallbacks.h"
-#include "DefaultPackageInterface.h"
 #include "CRCPackageInterface.h"
 
 //================ Global Objects Initialization ==================
 
 StatisticController statisticController;
-LEDController ledController(GREEN_LED_PIN, RED_LED_PIN);
-ezLED rxLED(LED_BUILTIN_RX_PIN);
-ezLED txLED(LED_BUILTIN_TX_PIN);
+TraceSink traceSink(Serial);
+ReportWriter reportWriter;
+LEDPatternEngine ledPatterns;
+LEDController ledController(ledPatterns, LED_CHANNEL_GREEN, LED_CHANNEL_RED);
 ButtonController buttonController(BUTTON_PIN);
-KeyboardController keyboardController(KEYBOARD_POWER_PIN, KEYBOARD_DP_PIN, KEYBOARD_DM_PIN);
+KeyboardController keyboardController;
 
-SoftSerial<SOFTWARE_SERIAL_RX_BUFFER, SOFTWARE_SERIAL_TX_BUFFER> softwareSerial(HC05_RX, HC05_TX);
-HC05 hc05(softwareSerial, HC05_KEY, HC05_STATE, HC05_RESET);
-EEPROMController eepromController(I2c);
+#if HC05_HARDWARE_UART
+Stream &streamBluetoothLink = Serial1;
+#else
+SoftSerial<HC05_RX, HC05_TX, SOFTWARE_SERIAL_RX_BUFFER, SOFTWARE_SERIAL_TX_BUFFER, SoftwareSerialFormat> softwareSerial;
+Stream &streamBluetoothLink = softwareSerial;
+#endif
+HC05 hc05(streamBluetoothLink, HC05_KEY, HC05_STATE, HC05_RESET);
+EEPROMWriter eepromWriter;
+EEPROMController eepromController(I2c, eepromWriter);
+EventJournal eventJournal(I2c);
+EntropyPool entropyPool;
 
-constexpr size_t COMMAND_PIPES_BUFFER_SIZE = 256;
-
-PipedStreamPair commandPipes(COMMAND_PIPES_BUFFER_SIZE);
-DefaultPackageInterface defaultPackageInterface(commandPipes);
+PipedStreamPairN<COMMAND_PIPES_BUFFER_SIZE> commandPipes;
+PipedStreamPairN<TELEMETRY_PIPES_BUFFER_SIZE, TELEMETRY_PIPES_RETURN_BUFFER_SIZE> telemetryPipes;
+#if LINK_BENCH
+PipedStreamPairN<BENCH_PIPES_BUFFER_SIZE> benchPipes;
+#endif
 CRCPackageInterface crcPackageInterface(commandPipes);
 
-PipedStream &streamCommander = defaultPackageInterface.getPlainStream();
+PipedStream &streamCommander = crcPackageInterface.getPlainStream();
+PipedStream &streamTelemetry = telemetryPipes.first;
+#if LINK_BENCH
+PipedStream &streamBench = benchPipes.first;
+#endif
 PipedStream &streamBluetoothData = crcPackageInterface.getEncodedStream();
-PipedStream &streamBluetoothCommand = defaultPackageInterface.getEncodedStream();
 
 //================ Statistic Objects ==================
 
+Statistic loopStatistic;
 Statistic systemStatistic;
 Statistic peripheralStatistic;
 Statistic communicationStatistic;
 Statistic applicationStatistic;
 
 const Statistic *statistics[] = {
+    &loopStatistic,
     &systemStatistic,
     &peripheralStatistic,
     &communicationStatistic,
     &applicationStatistic};
 const uint8_t lengthOfStatistics = sizeof(statistics) / sizeof(statistics[0]);
+static_assert(sizeof(statistics) / sizeof(statistics[0]) <= STALL_REGION_COUNT, "StallRecorder keeps STALL_REGION_COUNT region times");
+
+StallRecorder stallRecorder;
+#if SIM_BENCHMARK
+volatile SimProbe simProbe __attribute__((used, section(".noinit")));
+#endif
+TelemetryController telemetryController;
+#if LINK_BENCH
+BenchController benchController;
+static_assert(BENCH_PIPES_BUFFER_SIZE >= BenchController::MAX_SIZE, "Bench pipe must hold a whole payload");
+#endif
+TaskScheduler taskScheduler;
+static_assert(TELEMETRY_PIPES_BUFFER_SIZE >= TelemetryController::FRAME_SIZE, "Telemetry pipe must hold a whole frame");
+
+#if STATISTIC_ISR_LOAD
+#if !HC05_HARDWARE_UART
+IsrStatistic timer1IsrStatistic;
+IsrStatistic rxEdgeIsrStatistic;
+#endif
+IsrStatistic stateEdgeIsrStatistic;
+IsrStatistic buttonEdgeIsrStatistic;
+IsrStatistic ledTimerIsrStatistic;
+IsrStatistic eepromIsrStatistic;
+
+IsrStatistic *const isrStatistics[] = {
+#if !HC05_HARDWARE_UART
+    &timer1IsrStatistic,
+    &rxEdgeIsrStatistic,
+#endif
+    &stateEdgeIsrStatistic,
+    &buttonEdgeIsrStatistic,
+    &ledTimerIsrStatistic,
+    &eepromIsrStatistic};
+const uint8_t lengthOfIsrStatistics = sizeof(isrStatistics) / sizeof(isrStatistics[0]);
+#endif
 
 //================ Serial Commands ==================
 
@@ -47,13 +96,23 @@ const Command serCommands[] = {
     COMMAND(commandPing, "ping", NULL, "ping"),
     COMMAND(commandRam, "ram", NULL, "display ram usage"),
     COMMAND(commandStatistics, "stats", NULL, "list statistics"),
+    COMMAND(commandStalls, "stalls", NULL, "list recorded loop stalls"),
+    COMMAND(commandSetStallThreshold, "stall", ARG(ArgType::Int, 0, 65535), NULL, "set the loop stall threshold in us (0 = off)"),
+    COMMAND(commandTasks, "tasks", NULL, "list main loop tasks with run times"),
+    COMMAND(commandSetIdleSleep, "idlesleep", ARG(ArgType::Int, 0, 1), NULL, "sleep between loop passes when idle (1) or spin (0)"),
+    COMMAND(commandTelemetry, "telemetry", NULL, "send a binary telemetry burst"),
+    COMMAND(commandJournal, "journal", NULL, "dump the event journal"),
+    COMMAND(commandSetTelemetryRate, "telemetryrate", ARG(ArgType::Int, 0, 3600), ARG(ArgType::Int, 0, 3600), NULL, "set telemetry intervals in s, link and usb (0 = off)"),
+    COMMAND(commandBench, "bench", ARG(ArgType::Int, 1, 10000), ARG(ArgType::Int, 1, 64), NULL, "echo N payloads of S bytes through the app, report the link"),
     COMMAND(commandReset, "reset", NULL, "reset the keypad"),
     COMMAND(commandResetForProgramming, "resetfp", NULL, "reset the keypad for self programming"),
     COMMAND(commandVersion, "version", NULL, "display the version"),
-    COMMAND(commandListTraceables, "listtrace", NULL, "list traceable function names with levels"),
-    COMMAND(commandSetTraceLevel, "settrace", ARG(ArgType::String), ARG(ArgType::Int), NULL, "set trace level for a component")};
+    COMMAND(commandListTraceables, "listtrace", NULL, "list trace components with levels"),
+    COMMAND(commandSetTraceLevel, "settrace", ARG(ArgType::String), ARG(ArgType::Int), NULL, "set trace level for a component"),
+    COMMAND(commandSetTraceSink, "tracesink", ARG(ArgType::String), ARG(ArgType::Int, 0, 1), NULL, "trace a component through the non-blocking sink (1) or Serial (0)")};
 
-char serialCommandBuffer[16];
+// Holds the whole line, component names included
+char serialCommandBuffer[32];
 SerialCommands serialCommands(
     Serial,
     serCommands,
@@ -62,8 +121,13 @@ SerialCommands serialCommands(
     sizeof(serialCommandBuffer) / sizeof(char),
     3000);
 
+#if SERIAL_COMMANDS_STATISTICS
+CommandStatistic serCommandStatistics[sizeof(serCommands) / sizeof(Command)];
+#endif
+
 //================ Bluetooth Commands ==================
 
+// The index of each entry is its binary opcode (see CMD_BINARY_FLAG), append new commands at the end
 const Command btCommands[] = {
     COMMAND(commandHelp, "help", NULL, "list commands"),
     COMMAND(commandPing, "ping", NULL, "ping the keypad"),
@@ -71,9 +135,17 @@ const Command btCommands[] = {
     COMMAND(commandGenSeed, "seed", NULL, "generate seed"),
     COMMAND(commandCheck, "check", NULL, "check the seed"),
     COMMAND(commandState, "state", NULL, "state of the keypad"),
+    COMMAND(commandLinkStatistics, "link", NULL, "link statistics"),
     COMMAND(commandLock, "lock", ARG(ArgType::String), NULL, "lock the keypad"),
     COMMAND(commandUnlock, "unlock", ARG(ArgType::String), NULL, "unlock the keypad"),
-    COMMAND(commandVersion, "version", NULL, "display the version")};
+    COMMAND(commandVersion, "version", NULL, "display the version"),
+    COMMAND(commandTelemetry, "telemetry", NULL, "send a binary telemetry burst"),
+    COMMAND(commandJournal, "journal", NULL, "dump the event journal"),
+    COMMAND(commandChallenge, "challenge", NULL, "new lock/unlock challenge nonce"),
+    COMMAND(commandLockMac, "lockmac", ARG(ArgType::String), NULL, "lock the keypad with the challenge tag"),
+    COMMAND(commandUnlockMac, "unlockmac", ARG(ArgType::String), NULL, "unlock the keypad with the challenge tag"),
+    COMMAND(commandBench, "bench", ARG(ArgType::Int, 1, 10000), ARG(ArgType::Int, 1, 64), NULL, "echo N payloads of S bytes through the app, report the link"),
+    COMMAND(commandPingTime, "pingtime", ARG(ArgType::String), NULL, "ping echoing a host token with device timestamps in us")};
 
 char bluetoothCommandBuffer[48];
 SerialCommands bluetoothCommands(
@@ -83,3 +155,7 @@ SerialCommands bluetoothCommands(
     bluetoothCommandBuffer,
     sizeof(bluetoothCommandBuffer) / sizeof(char),
     1000);
+
+#if SERIAL_COMMANDS_STATISTICS
+CommandStatistic btCommandStatistics[sizeof(btCommands) / sizeof(Command)];
+#endif
@@ -8,17 +8,14 @@
 
 #include "Globals.h"
 #include "K810Security.h"
+#include <util/crc16.h>
+#include <SipHash.h>
 
 #include "TraceLevel.h"
 #undef CLASS_TRACE_LEVEL
 #define CLASS_TRACE_LEVEL DEBUG_K810_SECURITY
 #include "TraceHelper.h"
 
-/**
- * @brief Name of the class
- */
-const char PROGMEM K810Security::CLASS_NAME[] = "K810Security";
-
 // Bluetooth AT command constants stored in program memory
 const char PROGMEM K810Security::CMD_AT[] = "AT";                  ///< AT command
 const char PROGMEM K810Security::CMD_RMAAD[] = "AT+RMAAD";         ///< Factory reset command
@@ -29,6 +26,53 @@ const char PROGMEM K810Security::CMD_PSWD[] = "AT+PSWD=1588";      ///< Set pair
 const char PROGMEM K810Security::CMD_UART[] = "AT+UART=38400,1,0"; ///< Set UART parameters command
 const char PROGMEM K810Security::CMD_INIT[] = "AT+INIT";           ///< Initialize command
 const char PROGMEM K810Security::CMD_RESET[] = "AT+RESET";         ///< Reset command
+const char PROGMEM K810Security::CMD_UART_QUERY[] = "AT+UART?";    ///< Query UART parameters command
+const char PROGMEM K810Security::REPLY_UART[] = "+UART:38400,1,0"; ///< Reply to the UART query when CMD_UART is applied
+const char PROGMEM K810Security::CMD_UART_57600[] = "AT+UART=57600,1,0";     ///< Set the 57600 baud data mode rate
+const char PROGMEM K810Security::REPLY_UART_57600[] = "+UART:57600,1,0";     ///< Reply to the UART query at 57600 baud
+const char PROGMEM K810Security::CMD_UART_115200[] = "AT+UART=115200,1,0";   ///< Set the 115200 baud data mode rate
+const char PROGMEM K810Security::REPLY_UART_115200[] = "+UART:115200,1,0";   ///< Reply to the UART query at 115200 baud
+
+// Bluetooth AT scripts stored in program memory
+const HC05::ScriptStep PROGMEM K810Security::RESET_SCRIPT[] = {
+    {CMD_AT, nullptr, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_RMAAD, nullptr, SETTLE_FACTORY_RESET, TIMEOUT_FACTORY_RESET, HC05::SCRIPT_RETRY},
+    {CMD_ROLE, nullptr, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_CMODE, nullptr, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_NAME, nullptr, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_PSWD, nullptr, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_UART, nullptr, SETTLE_UART_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY}};
+
+// Link rate scripts; the query and reset steps alone are the start-up verify
+const HC05::ScriptStep PROGMEM K810Security::LINK_RATE_SCRIPT_38400[] = {
+    {CMD_UART, nullptr, SETTLE_UART_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_UART_QUERY, REPLY_UART, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_RESET, nullptr, 0, TIMEOUT_RESET_CMD, HC05::SCRIPT_ABORT}};
+
+const HC05::ScriptStep PROGMEM K810Security::LINK_RATE_SCRIPT_57600[] = {
+    {CMD_UART_57600, nullptr, SETTLE_UART_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_UART_QUERY, REPLY_UART_57600, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_RESET, nullptr, 0, TIMEOUT_RESET_CMD, HC05::SCRIPT_ABORT}};
+
+const HC05::ScriptStep PROGMEM K810Security::LINK_RATE_SCRIPT_115200[] = {
+    {CMD_UART_115200, nullptr, SETTLE_UART_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_UART_QUERY, REPLY_UART_115200, SETTLE_BASIC_CMD, TIMEOUT_BASIC_CMD, HC05::SCRIPT_RETRY},
+    {CMD_RESET, nullptr, 0, TIMEOUT_RESET_CMD, HC05::SCRIPT_ABORT}};
+
+const K810Security::LinkRate PROGMEM K810Security::LINK_RATES[] = {
+    {115200, BaudRate::BAUD_115200, LINK_RATE_SCRIPT_115200},
+    {57600, BaudRate::BAUD_57600, LINK_RATE_SCRIPT_57600},
+    {38400, BaudRate::BAUD_38400, LINK_RATE_SCRIPT_38400}};
+
+uint16_t K810Security::appliedConfigSteps = 0;
+uint8_t K810Security::linkRateIndex = K810Security::LINK_RATE_AT;
+bool K810Security::linkRateConfirmed = true;
+bool K810Security::linkSerialDataMode = false;
+uint32_t K810Security::linkProbeMillis = 0;
+uint16_t K810Security::linkProbeFrames = 0;
+uint16_t K810Security::linkProbeFaults = 0;
+volatile bool K810Security::fastLockArmed = false;
+bool K810Security::linkConnected = false;
 
 constexpr uint16_t BLUETOOTH_OPERATION_TIMEOUT = 60000;
 constexpr uint16_t FORMAT_OPERATION_TIMEOUT = 30000;
@@ -37,20 +81,37 @@ constexpr uint16_t FORMAT_OPERATION_TIMEOUT = 30000;
  * @brief Constructor implementation
  * Initializes the device in IDLE state and sets up Bluetooth connection timeout
  */
-K810Security::K810Security() : Traceable(PGMT(CLASS_NAME), static_cast<Level>(DEBUG_K810_SECURITY)), state(IDLE) {}
+K810Security::K810Security()
+    : Traceable(TraceComponent::K810_SECURITY), state(IDLE), bootLockedMillis(0), bootConnectableMillis(0), bootReported(false) {}
 
 //================ Bluetooth Methods ==================
 
 /**
  * @brief Handles incoming Bluetooth data
- * Routes the data to the appropriate stream based on the current mode
- * @param data The received data byte
- * @param context The context pointer
+ * Hands the data to the CRC link, which demultiplexes its channels
+ * @param data The received bytes
+ * @param length Number of received bytes
  */
-void K810Security::bluetoothDataCallback(const char data)
+void K810Security::bluetoothDataCallback(const uint8_t *data, const uint8_t length)
 {
-    PipedStream &activeStream = hc05.isDataMode() ? streamBluetoothData : streamBluetoothCommand;
-    activeStream.write(data);
+    entropyPool.addTiming();
+    streamBluetoothData.write(data, length);
+}
+
+/**
+ * @brief Runs the binary telemetry frames on the telemetry channel and USB
+ */
+void K810Security::sendTelemetry()
+{
+    // Nothing reads the channel's return direction, keep it from stalling the link
+    while (streamTelemetry.available())
+    {
+        streamTelemetry.read();
+    }
+
+    telemetryController.loop(hc05.isConnected(), Serial);
+    // Frames are written whole, the tail of one need not wait for more
+    crcPackageInterface.flush(CHANNEL_TELEMETRY);
 }
 
 /**
@@ -60,32 +121,314 @@ void K810Security::bluetoothDataCallback(const char data)
  * @param result Success status of the command
  * @param response Response text from the device
  */
-void K810Security::bluetoothCallback(const __FlashStringHelper *command, const bool result, const String &response)
+void K810Security::bluetoothCallback(const __FlashStringHelper *command, const bool result, const HC05::ResponseBuffer &response)
 {
     if (result)
     {
-        TRACE_INFO_STATIC(PGMT(CLASS_NAME)) << F("Bluetooth OK: ") << command << endl;
+        TRACE_INFO_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth OK: ") << command << endl;
     }
     else
     {
-        TRACE_ERROR_STATIC(PGMT(CLASS_NAME)) << F("Bluetooth ERROR: ") << command << F(": ") << response << '#' << endl;
+        TRACE_ERROR_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth ERROR: ") << command << F(": ") << response << '#' << endl;
     }
 }
 
 /**
- * @brief Handles Bluetooth reset command responses
- * Forces data mode on successful reset
- * @param command The command that was executed
- * @param result Success status of the command
- * @param response Response text from the device
+ * @brief Handles Bluetooth script completion
+ * Sets the data mode rate, whose script resets the module
+ * @param success Whether the script completed
+ * @param failedStep Index of the failed step
  */
-void K810Security::bluetoothResetCallback(const __FlashStringHelper *command, const bool result, const String &response)
+void K810Security::bluetoothScriptCallback(const bool success, const uint8_t failedStep)
 {
-    if (result)
+    if (success)
     {
+        TRACE_INFO_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth script OK") << endl;
+        storeConfigHashes(appliedConfigSteps);
+        runLinkRateScript(LINK_RATE_MASK_SET | LINK_RATE_MASK_QUERY | LINK_RATE_MASK_RESET, bluetoothLinkRateCallback);
+    }
+    else
+    {
+        TRACE_ERROR_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth script failed at step ") << failedStep << endl;
+    }
+    appliedConfigSteps = 0;
+}
+
+/**
+ * @brief Handles completion of the start-up configuration verify
+ * Falls back to replaying the whole configuration if the module does not match
+ * @param success Whether the script completed
+ * @param failedStep Index of the failed step
+ */
+void K810Security::bluetoothVerifyCallback(const bool success, const uint8_t failedStep)
+{
+    if (success)
+    {
+        TRACE_INFO_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth config OK") << endl;
         hc05.forceDataMode();
+        return;
+    }
+
+    // Only the rate differs: set it again, the stored configuration stays valid
+    if ((1U << failedStep) == LINK_RATE_MASK_QUERY)
+    {
+        TRACE_WARN_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth link rate mismatch, setting it again") << endl;
+        runLinkRateScript(LINK_RATE_MASK_SET | LINK_RATE_MASK_QUERY | LINK_RATE_MASK_RESET, bluetoothLinkRateCallback);
+        return;
     }
-    bluetoothCallback(command, result, response);
+
+    TRACE_WARN_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth config mismatch at step ") << failedStep << F(", replaying") << endl;
+    storeConfigHashes(0);
+    runConfigScript(STEP_MASK_AT | STEP_MASK_CONFIG);
+}
+
+/**
+ * @brief Handles completion of a link rate script
+ * Falls back to the next slower rate if the module refuses this one
+ * @param success Whether the script completed
+ * @param failedStep Index of the failed step
+ */
+void K810Security::bluetoothLinkRateCallback(const bool success, const uint8_t failedStep)
+{
+    if (success)
+    {
+        TRACE_INFO_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth link rate ") << pgm_read_dword(&LINK_RATES[linkRateIndex].baud) << endl;
+        hc05.forceDataMode();
+        return;
+    }
+
+    if (linkRateIndex == LINK_RATE_AT)
+    {
+        TRACE_ERROR_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth script failed at step ") << failedStep << endl;
+        return;
+    }
+
+    TRACE_WARN_STATIC(TraceComponent::K810_SECURITY) << F("Bluetooth link rate refused at step ") << failedStep << endl;
+    stepDownLinkRate();
+    runLinkRateScript(LINK_RATE_MASK_SET | LINK_RATE_MASK_QUERY | LINK_RATE_MASK_RESET, bluetoothLinkRateCallback);
+}
+
+/**
+ * @brief Forwards STATE pin edges to the HC05 driver
+ */
+void K810Security::hc05StateEdge()
+{
+    MEASURE_ISR(stateEdgeIsrStatistic)
+    {
+        hc05.processStateEdge();
+    }
+}
+
+/**
+ * @brief Locks the keyboard on disconnect from the STATE pin interrupt
+ * Keeps the disconnect-to-lock latency at interrupt latency instead of loop jitter
+ * @param connected Level of the STATE pin after the edge
+ */
+void K810Security::hc05StateFastLock(const bool connected)
+{
+    if (!connected && fastLockArmed)
+    {
+        keyboardController.lockFromISR(hc05.lastStateEdgeMicros());
+    }
+}
+
+/**
+ * @brief Runs the selected steps of RESET_SCRIPT
+ * @param steps Mask of RESET_SCRIPT steps to run
+ */
+void K810Security::runConfigScript(const uint16_t steps)
+{
+    appliedConfigSteps = steps & STEP_MASK_CONFIG;
+    hc05.runScript(RESET_SCRIPT, sizeof(RESET_SCRIPT) / sizeof(RESET_SCRIPT[0]), bluetoothScriptCallback, steps);
+}
+
+/**
+ * @brief Runs the script of the current link rate
+ * @param steps Mask of link rate script steps to run
+ * @param callback Function to call when the script finishes
+ */
+void K810Security::runLinkRateScript(const uint16_t steps, const HC05::ScriptCallback callback)
+{
+    const HC05::ScriptStep *script = reinterpret_cast<const HC05::ScriptStep *>(pgm_read_ptr(&LINK_RATES[linkRateIndex].script));
+    hc05.runScript(script, LINK_RATE_STEP_COUNT, callback, steps);
+}
+
+/**
+ * @brief Selects the link rate to start from
+ * A rate confirmed earlier is stored in EEPROM, without one the fastest is probed
+ */
+void K810Security::loadLinkRate()
+{
+    static_assert(sizeof(LINK_RATES) / sizeof(LINK_RATES[0]) == LINK_RATE_COUNT, "LINK_RATE_COUNT must match LINK_RATES");
+
+    const uint8_t stored = eepromWriter.read(EEPROM_HC05_BAUD_ADDRESS);
+    linkRateIndex = LINK_RATE_FASTEST;
+    linkRateConfirmed = false;
+    for (uint8_t i = LINK_RATE_FASTEST; i < LINK_RATE_COUNT; ++i)
+    {
+        if (stored == pgm_read_byte(&LINK_RATES[i].code) + 1)
+        {
+            linkRateIndex = i;
+            linkRateConfirmed = true;
+        }
+    }
+#if SIM_BENCHMARK && !HC05_HARDWARE_UART
+    if (simProbe.magic == SIM_PROBE_MAGIC)
+    {
+        // The simulator sets the rate of both modes itself
+        linkRateIndex = LINK_RATE_AT;
+    }
+#endif
+    linkRateConfirmed |= (linkRateIndex == LINK_RATE_AT);
+}
+
+/**
+ * @brief Stores the current link rate in EEPROM, the next boot starts from it
+ */
+void K810Security::storeLinkRate()
+{
+    eepromWriter.write(EEPROM_HC05_BAUD_ADDRESS, pgm_read_byte(&LINK_RATES[linkRateIndex].code) + 1);
+}
+
+/**
+ * @brief Moves to the next slower link rate
+ * The AT mode rate has nothing slower to fall back to, so it is stored as the rate that works
+ */
+void K810Security::stepDownLinkRate()
+{
+    linkRateConfirmed = (++linkRateIndex == LINK_RATE_AT);
+    if (linkRateConfirmed)
+    {
+        storeLinkRate();
+    }
+}
+
+/**
+ * @brief Retunes the serial to a link rate
+ * @param index Entry of LINK_RATES
+ */
+void K810Security::setLinkSerialRate(const uint8_t index)
+{
+#if HC05_HARDWARE_UART
+    Serial1.begin(pgm_read_dword(&LINK_RATES[index].baud));
+#else
+#if SIM_BENCHMARK
+    if (simProbe.magic == SIM_PROBE_MAGIC)
+    {
+        return;
+    }
+#endif
+    softwareSerial.begin(timer1Setup, static_cast<BaudRate>(pgm_read_byte(&LINK_RATES[index].code)));
+#endif
+}
+
+/**
+ * @brief Confirms or falls back from an unconfirmed link rate
+ * The probe starts when the peer connects; LINK_PROBE_FRAMES valid frames confirm the rate,
+ * LINK_PROBE_MAX_FAULTS rejected frames or resyncs, a disconnect or LINK_PROBE_TIMEOUT
+ * before that fall back to the next slower rate
+ */
+void K810Security::checkLinkRate()
+{
+    const CRCPackageInterface::LinkStatistic &statistic = crcPackageInterface.getLinkStatistic();
+    uint16_t faults = statistic.resyncs;
+    for (uint8_t i = 0; i < CRCPackageInterface::REJECT_REASON_COUNT; ++i)
+    {
+        faults += statistic.rejected[i];
+    }
+    const bool connected = hc05.isConnected();
+
+    if (linkProbeMillis == 0)
+    {
+        if (connected)
+        {
+            linkProbeMillis = millis();
+            linkProbeFrames = statistic.packetsReceived;
+            linkProbeFaults = faults;
+        }
+        return;
+    }
+
+    const uint16_t frames = statistic.packetsReceived - linkProbeFrames;
+    faults -= linkProbeFaults;
+    if (faults < LINK_PROBE_MAX_FAULTS)
+    {
+        if (frames >= LINK_PROBE_FRAMES)
+        {
+            linkRateConfirmed = true;
+            storeLinkRate();
+            TRACE_INFO_STATIC(TraceComponent::K810_SECURITY) << F("Link rate confirmed") << endl;
+            return;
+        }
+        if (connected && millis() - linkProbeMillis < LINK_PROBE_TIMEOUT)
+        {
+            return;
+        }
+    }
+
+    TRACE_WARN_STATIC(TraceComponent::K810_SECURITY) << F("Link rate failed: ") << frames << F(" frames, ") << faults << F(" faults") << endl;
+    linkProbeMillis = 0;
+    stepDownLinkRate();
+    hc05.clearCommandQueue();
+    runLinkRateScript(LINK_RATE_MASK_SET | LINK_RATE_MASK_QUERY | LINK_RATE_MASK_RESET, bluetoothLinkRateCallback);
+    hc05.reset();
+}
+
+/**
+ * @brief Finds configuration steps whose stored hash does not match the firmware
+ * @return Mask of RESET_SCRIPT configuration steps to replay
+ */
+uint16_t K810Security::staleConfigSteps()
+{
+    uint16_t steps = 0;
+    for (uint8_t i = 0; i < CONFIG_STEP_COUNT; ++i)
+    {
+        const uint8_t step = CONFIG_FIRST_STEP + i;
+        if (eepromWriter.read(EEPROM_HC05_CONFIG_ADDRESS + i) != configHash(step))
+        {
+            steps |= (1U << step);
+        }
+    }
+    return steps;
+}
+
+/**
+ * @brief Stores the hashes of applied configuration steps in EEPROM
+ * Steps outside the mask keep their stored hash, a zero mask invalidates all of them
+ * @param steps Mask of RESET_SCRIPT configuration steps that were applied
+ */
+void K810Security::storeConfigHashes(const uint16_t steps)
+{
+    for (uint8_t i = 0; i < CONFIG_STEP_COUNT; ++i)
+    {
+        const uint8_t step = CONFIG_FIRST_STEP + i;
+        if (steps == 0)
+        {
+            eepromWriter.write(EEPROM_HC05_CONFIG_ADDRESS + i, 0);
+        }
+        else if (steps & (1U << step))
+        {
+            eepromWriter.write(EEPROM_HC05_CONFIG_ADDRESS + i, configHash(step));
+        }
+    }
+}
+
+/**
+ * @brief Hashes the command of a configuration step
+ * Zero is reserved for "not applied", which is also what formatting leaves behind
+ * @param step Index of the step in RESET_SCRIPT
+ * @return Non-zero hash of the command text
+ */
+uint8_t K810Security::configHash(const uint8_t step)
+{
+    PGM_P command = reinterpret_cast<PGM_P>(pgm_read_ptr(&RESET_SCRIPT[step].command));
+    uint8_t hash = 0;
+    char c;
+    while ((c = pgm_read_byte(command++)))
+    {
+        hash = _crc8_ccitt_update(hash, c);
+    }
+    return (hash == 0) ? 1 : hash;
 }
 
 /**
@@ -94,11 +437,11 @@ void K810Security::bluetoothResetCallback(const __FlashStringHelper *command, co
  * @param callback Function to call when command completes
  * @param delayMs Delay before next command
  */
-void K810Security::sendBluetoothCommand(const char *cmd_progmem, HC05::CommandCallback callback, uint16_t delayMs)
+void K810Security::sendBluetoothCommand(const char *cmd_progmem, HC05::ResponseCallback callback, uint16_t delayMs)
 {
     HC05::Command cmd;
     cmd.commandText = PGMT(cmd_progmem);
-    cmd.callback = callback;
+    cmd.responseCallback = callback;
     cmd.delayMs = delayMs;
     hc05.sendCommand(cmd);
 }
@@ -110,24 +453,9 @@ void K810Security::sendBluetoothCommand(const char *cmd_progmem, HC05::CommandCa
 void K810Security::bluetoothResetSequence()
 {
     hc05.clearCommandQueue();
-    
-    // Check if the device is in command mode
-    sendBluetoothCommand(CMD_AT, bluetoothCallback, DELAY_BASIC_CMD);
-
-    // Factory reset
-    sendBluetoothCommand(CMD_RMAAD, bluetoothCallback, DELAY_FACTORY_RESET);
-
-    // Basic setup
-    sendBluetoothCommand(CMD_ROLE, bluetoothCallback, DELAY_BASIC_CMD);
-    sendBluetoothCommand(CMD_CMODE, bluetoothCallback, DELAY_BASIC_CMD);
-
-    // Device specific setup
-    sendBluetoothCommand(CMD_NAME, bluetoothCallback, DELAY_BASIC_CMD);
-    sendBluetoothCommand(CMD_PSWD, bluetoothCallback, DELAY_BASIC_CMD);
-    sendBluetoothCommand(CMD_UART, bluetoothCallback, DELAY_UART_CMD);
 
-    // Final reset
-    sendBluetoothCommand(CMD_RESET, bluetoothResetCallback, DELAY_RESET_CMD);
+    // Check command mode, forget pairings, replay changed configuration; the link rate script resets the device
+    runConfigScript(STEP_MASK_AT | STEP_MASK_RMAAD | staleConfigSteps());
 
     if (hc05.isResettingPermanently())
     {
@@ -143,11 +471,16 @@ void K810Security::bluetoothInitSequence()
 {
     hc05.clearCommandQueue();
 
-    // Check if the device is in command mode
-    sendBluetoothCommand(CMD_AT, bluetoothCallback, DELAY_BASIC_CMD);
+    const uint16_t staleSteps = staleConfigSteps();
+    if (staleSteps != 0)
+    {
+        // Firmware configuration changed, replay only what differs
+        runConfigScript(STEP_MASK_AT | staleSteps);
+        return;
+    }
 
-    // Reset the device
-    sendBluetoothCommand(CMD_RESET, bluetoothResetCallback, DELAY_FINAL_RESET);
+    // One query confirms the stored configuration and link rate are still on the module
+    runLinkRateScript(LINK_RATE_MASK_QUERY | LINK_RATE_MASK_RESET, bluetoothVerifyCallback);
 }
 
 //================ Business Logic ==================
@@ -193,6 +526,7 @@ void K810Security::handleBusinessLogic()
     {
         if (eepromController.state() == EEPROMController::IDLE)
         {            
+            KeyboardController::invalidateSecurityState();
             TRACE_INFO() << F("Formatting done") << endl;
             watchdogController.resetMCU();
         }
@@ -240,6 +574,7 @@ void K810Security::handleBusinessLogic()
         ledController.setState(LEDController::RESETTING_BLUETOOTH);
         operationTimeout.setInterval(BLUETOOTH_OPERATION_TIMEOUT);
         operationTimeout.reset();
+        telemetryController.notify(TelemetryController::EVENT_DISCONNECT_PENDING);
         bluetoothResetSequence();
         break;
 
@@ -250,6 +585,7 @@ void K810Security::handleBusinessLogic()
         ledController.setState(LEDController::FORMATTING);
         operationTimeout.setInterval(FORMAT_OPERATION_TIMEOUT);
         operationTimeout.reset();
+        telemetryController.notify(TelemetryController::EVENT_FORMAT);
         eepromController.format();
         break;
 
@@ -260,8 +596,51 @@ void K810Security::handleBusinessLogic()
     }
 }
 
+//================ Boot ==================
+
+/**
+ * @brief Runs the boot stages that wait on something
+ * - Connectable: the first time the HC05 reaches data mode
+ * - USB: the reset reason and the banner with both boot times, once a host
+ *   opens the port; Serial.dtr() does not wait like the bool operator
+ */
+void K810Security::advanceBoot()
+{
+    if (bootConnectableMillis == 0 && hc05.isDataMode())
+    {
+        bootConnectableMillis = millis();
+        TRACE_INFO() << F("Connectable after ms: ") << bootConnectableMillis << endl;
+    }
+
+    if (bootReported || !Serial.dtr())
+    {
+        return;
+    }
+    bootReported = true;
+
+    const bool checked = KeyboardController::isSeedChecked();
+    watchdogController.printResetReason(Serial);
+    Serial << F("K810 started, seed: ")
+        << (checked ? F("checked") : F("unchecked"))
+        << F(", version: ")
+        << KeyboardController::getVersion()
+        << F(", locked: ")
+        << bootLockedMillis
+        << F(" ms, connectable: ");
+    if (bootConnectableMillis != 0)
+    {
+        Serial << bootConnectableMillis << F(" ms") << endl;
+    }
+    else
+    {
+        Serial << (checked ? F("pending") : F("off")) << endl;
+    }
+}
+
 //================ Timer and ISR ==================
 
+#if !HC05_HARDWARE_UART
+
 /**
  * @brief Sets up Timer1 for software serial communication
  * Configures the timer in CTC mode for bit sampling
@@ -290,148 +669,424 @@ void K810Security::timer1Setup(const unsigned long oversampleBitPeriod)
     TIMSK1 |= (1 << OCIE1A);
 }
 
+/**
+ * @brief Gates Timer1 sampling around RX start edges
+ * While stopped, the falling edge of the start bit on HC05_RX restarts the timer
+ * @param run True to restart the timer, false to wait for a start edge
+ */
+void K810Security::timer1Gate(const bool run)
+{
+    if (run)
+    {
+        detachInterrupt(digitalPinToInterrupt(HC05_RX));
+
+        // Restart half a tick before the next compare match
+        TCNT1 = OCR1A / 2;
+        TIFR1 = (1 << OCF1A);
+        TIMSK1 |= (1 << OCIE1A);
+    }
+    else
+    {
+        TIMSK1 &= ~(1 << OCIE1A);
+        attachInterrupt(digitalPinToInterrupt(HC05_RX), rxStartEdge, FALLING);
+    }
+}
+
+/**
+ * @brief Forwards the RX start edge to the software serial
+ */
+void K810Security::rxStartEdge()
+{
+    MEASURE_ISR(rxEdgeIsrStatistic)
+    {
+        softwareSerial.processStartEdge();
+        entropyPool.addTimingFromISR();
+    }
+}
+#endif
+
+//================ Tasks ==================
+
+// Task names shown by the tasks command
+static const char TASK_NAME_WATCHDOG[] PROGMEM = "watchdog";
+static const char TASK_NAME_STATISTICS[] PROGMEM = "statistics";
+static const char TASK_NAME_OUTPUT[] PROGMEM = "output";
+static const char TASK_NAME_BOOT[] PROGMEM = "boot";
+static const char TASK_NAME_KEYBOARD[] PROGMEM = "keyboard";
+static const char TASK_NAME_LINK[] PROGMEM = "link";
+static const char TASK_NAME_TELEMETRY[] PROGMEM = "telemetry";
+static const char TASK_NAME_FAST_LOCK[] PROGMEM = "fastlock";
+static const char TASK_NAME_COMMANDS[] PROGMEM = "commands";
+static const char TASK_NAME_CONSOLE[] PROGMEM = "console";
+static const char TASK_NAME_INPUT[] PROGMEM = "input";
+static const char TASK_NAME_EEPROM[] PROGMEM = "eeprom";
+static const char TASK_NAME_ENTROPY[] PROGMEM = "entropy";
+#if LINK_BENCH
+static const char TASK_NAME_BENCH[] PROGMEM = "bench";
+#endif
+
+// The link path runs on every pass; everything else only needs servicing every 5-50 ms
+const TaskScheduler::Task PROGMEM K810Security::TASKS[] = {
+    // System monitoring
+    {TASK_NAME_WATCHDOG, taskWatchdog, &systemStatistic, 50, 50, TaskScheduler::PRIORITY_CRITICAL},
+    {TASK_NAME_STATISTICS, taskStatistics, &systemStatistic, 10, 300, TaskScheduler::PRIORITY_NORMAL},
+    {TASK_NAME_OUTPUT, taskOutput, &systemStatistic, 5, 1000, TaskScheduler::PRIORITY_NORMAL},
+    {TASK_NAME_BOOT, taskBoot, &systemStatistic, 10, 1000, TaskScheduler::PRIORITY_NORMAL},
+    // Peripheral updates
+    {TASK_NAME_KEYBOARD, taskKeyboard, &peripheralStatistic, 50, 50, TaskScheduler::PRIORITY_NORMAL},
+    // Communication processing
+    {TASK_NAME_LINK, taskLink, &communicationStatistic, 0, 1000, TaskScheduler::PRIORITY_CRITICAL},
+    {TASK_NAME_TELEMETRY, taskTelemetry, &communicationStatistic, 10, 1000, TaskScheduler::PRIORITY_NORMAL},
+    {TASK_NAME_FAST_LOCK, taskFastLock, &communicationStatistic, 0, 100, TaskScheduler::PRIORITY_CRITICAL},
+    // Application logic
+    {TASK_NAME_COMMANDS, taskCommands, &applicationStatistic, 0, 2000, TaskScheduler::PRIORITY_CRITICAL},
+    {TASK_NAME_CONSOLE, taskConsole, &applicationStatistic, 5, 2000, TaskScheduler::PRIORITY_NORMAL},
+    {TASK_NAME_INPUT, taskInput, &applicationStatistic, 10, 500, TaskScheduler::PRIORITY_NORMAL},
+    {TASK_NAME_EEPROM, taskEEPROM, &applicationStatistic, 5, 1000, TaskScheduler::PRIORITY_NORMAL},
+    // Stamps echoes on every pass, outside the communication time it reports
+#if LINK_BENCH
+    {TASK_NAME_BENCH, taskBench, &applicationStatistic, 0, 500, TaskScheduler::PRIORITY_NORMAL},
+#endif
+    {TASK_NAME_ENTROPY, taskEntropy, &systemStatistic, 5, 300, TaskScheduler::PRIORITY_NORMAL}};
+
+void K810Security::taskWatchdog(void *)
+{
+    watchdogController.loop();
+}
+
+void K810Security::taskStatistics(void *)
+{
+    statisticController.loop(Serial);
+#if STATISTIC_ISR_LOAD
+    statisticController.loopIsrStatistics(isrStatistics, lengthOfIsrStatistics);
+#endif
+}
+
+void K810Security::taskOutput(void *)
+{
+    traceSink.loop();
+    reportWriter.loop();
+#if TRACE_BINARY
+    // Drain queued trace records only as far as USB CDC takes them without blocking
+    Traceable::flush(Serial, Serial.availableForWrite());
+#endif
+}
+
+void K810Security::taskBoot(void *context)
+{
+    static_cast<K810Security *>(context)->advanceBoot();
+}
+
+void K810Security::taskKeyboard(void *)
+{
+    keyboardController.loop();
+}
+
+void K810Security::taskLink(void *)
+{
+#if !HC05_HARDWARE_UART
+    watchdogController.beat(WatchdogController::HEARTBEAT_SOFT_SERIAL);
+    softwareSerial.loop();
+#endif
+    watchdogController.beat(WatchdogController::HEARTBEAT_HC05);
+    hc05.loop();
+
+    // AT mode always runs at 38400, data mode at the link rate
+    const bool dataMode = hc05.isDataMode();
+    if (dataMode != linkSerialDataMode)
+    {
+        linkSerialDataMode = dataMode;
+        setLinkSerialRate(dataMode ? linkRateIndex : LINK_RATE_AT);
+    }
+
+    // One CRC link carries every channel; in AT mode it has nothing to do, which is progress too
+    watchdogController.beat(WatchdogController::HEARTBEAT_CRC);
+    if (dataMode)
+    {
+        crcPackageInterface.loop();
+        if (!linkRateConfirmed)
+        {
+            checkLinkRate();
+        }
+    }
+
+    // Splice encoded frames straight into the link's TX queue; the HC05 reports no room in AT mode
+    streamBluetoothData.transferTo(streamBluetoothLink, hc05.availableForWrite());
+}
+
+void K810Security::taskTelemetry(void *context)
+{
+    static_cast<K810Security *>(context)->sendTelemetry();
+}
+
+void K810Security::taskFastLock(void *)
+{
+    const bool connected = hc05.isConnected();
+    const bool seedChecked = keyboardController.isSeedChecked();
+    fastLockArmed = seedChecked && connected;
+    if (!connected && seedChecked)
+    {
+        keyboardController.lock(hc05.lastStateEdgeMicros());
+    }
+
+    if (connected != linkConnected)
+    {
+        linkConnected = connected;
+        eventJournal.record(connected ? EventJournal::EVENT_CONNECT : EventJournal::EVENT_DISCONNECT);
+        // Keeps the link's window for the app to resume after a drop
+        crcPackageInterface.setConnected(connected);
+        if (connected)
+        {
+            // Gives the peer the keyboard state without a query
+            telemetryController.notify(TelemetryController::EVENT_CONNECT);
+        }
+    }
+}
+
+/**
+ * @brief Checks whether an earlier reply is still streaming to an output
+ * @param output The command set's stream
+ * @return True while a report, a journal dump, a telemetry burst or a bench run writes to it
+ */
+static bool isReplying(const Print &output)
+{
+    return reportWriter.isWritingTo(output) || eventJournal.isDumpingTo(output) || telemetryController.isSendingTo(output)
+#if LINK_BENCH
+           || benchController.isRunningFor(output)
+#endif
+        ;
+}
+
+void K810Security::taskCommands(void *)
+{
+    // The next command waits in the pipe, its reply would land inside the stream
+    if (!isReplying(streamCommander))
+    {
+        bluetoothCommands.readSerial();
+    }
+}
+
+void K810Security::taskConsole(void *)
+{
+    if (!isReplying(Serial))
+    {
+        serialCommands.readSerial();
+    }
+}
+
+void K810Security::taskInput(void *context)
+{
+    // The button state lasts until its next loop, so the business logic reads it on the same schedule
+    buttonController.loop();
+    static_cast<K810Security *>(context)->handleBusinessLogic();
+}
+
+void K810Security::taskEEPROM(void *)
+{
+    watchdogController.beat(WatchdogController::HEARTBEAT_EEPROM);
+    eepromController.loop();
+
+    // The format owns the external EEPROM until the reset that follows it
+    if (eepromController.state() == EEPROMController::IDLE)
+    {
+        eventJournal.loop();
+    }
+}
+
+void K810Security::taskEntropy(void *)
+{
+    entropyPool.loop();
+}
+
+#if LINK_BENCH
+void K810Security::taskBench(void *)
+{
+    benchController.loop();
+}
+#endif
+
 //================ Setup ==================
 
+// Built-in RX and TX LEDs blink in turn, one second each
+static const LEDPatternEngine::Step RX_LED_PATTERN[] PROGMEM = {
+    {HIGH, 1000 / LED_PATTERN_TICK_MS}, {LOW, 1000 / LED_PATTERN_TICK_MS}, {LOW, 0}};
+static const LEDPatternEngine::Step TX_LED_PATTERN[] PROGMEM = {
+    {LOW, 1000 / LED_PATTERN_TICK_MS}, {HIGH, 1000 / LED_PATTERN_TICK_MS}, {LOW, 0}};
+
 /**
  * @brief Initializes the device and all its components
- * Sets up:
- * - Serial communication
- * - Watchdog timer
- * - Software serial
- * - Statistics controller
- * - LED indicators
- * - Bluetooth module
- * - EEPROM controller
+ * Runs the boot stages that cannot wait, without blocking:
+ * - Watchdog timer and the self-programming button check
+ * - Statistics controller and stall recorder
+ * - Lock state and LED indicators
+ * - Event journal
+ * - Software serial and Bluetooth module, which then boots from the link task
+ * - Task scheduler
+ * USB CDC is not waited for; taskBoot() prints the reset reason and the
+ * banner once a host opens the port.
  */
 void K810Security::setup()
 {
-    SimpleTimer<uint16_t> serialWaitTimeout(2000);
-    serialWaitTimeout.setInterval(2000);
-
     Serial.begin(9600);
-    while (!Serial && !serialWaitTimeout.isReady())
-        ;
+    LoopClock::tick();
+    buttonController.begin();
 
-    watchdogController.printResetReason(Serial);
     if (buttonController.isPressingRaw())
     {
         watchdogController.resetMCUForSelfProgramming();
     }
     watchdogController.enable(WDTO_500MS);
 
-    softwareSerial.begin(timer1Setup, BaudRate::BAUD_38400);
-
     statisticController.setup();
+    stallRecorder.setup();
+    entropyPool.begin();
 
-    rxLED.blink(1000, 1000);
-    txLED.blink(1000, 1000, 1000);
+    // Lock state and LEDs: the keyboard is held locked since construction
+    ledPatterns.attach(LED_CHANNEL_GREEN, GREEN_LED_PIN);
+    ledPatterns.attach(LED_CHANNEL_RED, RED_LED_PIN);
+    ledPatterns.attach(LED_CHANNEL_RX, LED_BUILTIN_RX_PIN);
+    ledPatterns.attach(LED_CHANNEL_TX, LED_BUILTIN_TX_PIN);
+    ledController.begin();
+    ledPatterns.play(LED_CHANNEL_RX, RX_LED_PATTERN);
+    ledPatterns.play(LED_CHANNEL_TX, TX_LED_PATTERN);
+    ledPatterns.begin();
 
+    // Each journal page read may take an I2C timeout when the bus hangs
     watchdogController.loop();
 
+    if (eventJournal.begin())
+    {
+        const WatchdogController::ResetReason reason = watchdogController.getResetReason();
+        eventJournal.record((reason == WatchdogController::WATCHDOG_RESET) ? EventJournal::EVENT_WATCHDOG : EventJournal::EVENT_RESET, reason);
+    }
+
+    KeyboardController::loadSecurityState();
     const bool checked = KeyboardController::isSeedChecked();
+    if (!checked)
+    {
+        keyboardController.unlock();
+    }
+    ledController.setState(checked ? LEDController::LOCKED : LEDController::UNLOCKED);
+    bootLockedMillis = millis();
+#if SIM_BENCHMARK
+    // Reference vector of the SipHash paper: key 00..0f, message 00..0e; simbench checks the tag and times mac()
+    uint8_t sipKey[SipHash::KEY_LENGTH];
+    uint8_t sipMessage[15];
+    for (uint8_t i = 0; i < sizeof(sipKey); ++i)
+    {
+        sipKey[i] = i;
+    }
+    memcpy(sipMessage, sipKey, sizeof(sipMessage));
+    uint8_t sipTag[SipHash::TAG_LENGTH];
+    SipHash::mac(sipKey, sipMessage, sizeof(sipMessage), sipTag);
+    memcpy(const_cast<uint8_t *>(simProbe.macTag), sipTag, sizeof(sipTag));
+#endif
+
+    // Bluetooth: the module resets and boots in parallel with everything else
+#if HC05_HARDWARE_UART
+    // USART1 buffers RX/TX in its own interrupt-fed rings, Timer1 stays free
+    Serial1.begin(HC05_BAUD_RATE);
+#else
+#if SIM_BENCHMARK
+    // The simulator sweeps the link speed through the probe
+    const BaudRate linkBaudRate = simProbe.magic == SIM_PROBE_MAGIC ? static_cast<BaudRate>(simProbe.baudRate) : BaudRate::BAUD_38400;
+#else
+    const BaudRate linkBaudRate = BaudRate::BAUD_38400;
+#endif
+    softwareSerial.begin(timer1Setup, linkBaudRate);
+#if HC05_RX_EDGE_TRIGGERED
+    static_assert(digitalPinToInterrupt(HC05_RX) != NOT_AN_INTERRUPT, "HC05_RX has no external interrupt");
+    softwareSerial.setTimerGate(timer1Gate);
+#endif
+#endif
+
     hc05.begin();
-    hc05.onDataReceived(bluetoothDataCallback);
+    hc05.onDataBlockReceived(bluetoothDataCallback);
+    crcPackageInterface.attachChannel(CHANNEL_TELEMETRY, telemetryPipes);
+    // Lock and unlock replies go ahead of telemetry and never wait for a window slot
+    crcPackageInterface.setChannelLane(CHANNEL_TELEMETRY, CRCPackageInterface::LANE_BULK);
+#if LINK_BENCH
+    crcPackageInterface.attachChannel(CHANNEL_BENCH, benchPipes);
+    // The bench measures what bulk data gets, commands keep their lane meanwhile
+    crcPackageInterface.setChannelLane(CHANNEL_BENCH, CRCPackageInterface::LANE_BULK);
+#endif
+    // Replies end with a line: the last partial packet leaves without the coalescing delay
+    crcPackageInterface.setLineFlush(CHANNEL_COMMAND, true);
+    // Replies never overrun the pipe, the commands behind them wait
+    bluetoothCommands.setOutputReserve(COMMAND_OUTPUT_RESERVE);
+#if SERIAL_COMMANDS_STATISTICS
+    serialCommands.setStatistics(serCommandStatistics);
+    bluetoothCommands.setStatistics(btCommandStatistics);
+#endif
+
+    static_assert(digitalPinToInterrupt(HC05_STATE) != NOT_AN_INTERRUPT, "HC05_STATE has no external interrupt");
+    hc05.useStateInterrupt(HC05_STATE_FAST_LOCK ? hc05StateFastLock : nullptr);
+    attachInterrupt(digitalPinToInterrupt(HC05_STATE), hc05StateEdge, CHANGE);
+    loadLinkRate();
     if (!checked)
     {
         hc05.reset(true);
-        keyboardController.unlock();
-        ledController.setState(LEDController::UNLOCKED);
     }
     else
     {
         bluetoothInitSequence();
     }
 
-    watchdogController.loop();
-
     // Set statistic names
+    loopStatistic.setName(F("Loop"));
     systemStatistic.setName(F("System"));
     peripheralStatistic.setName(F("Peripheral"));
     communicationStatistic.setName(F("Communication"));
     applicationStatistic.setName(F("Application"));
+#if STATISTIC_ISR_LOAD
+#if !HC05_HARDWARE_UART
+    timer1IsrStatistic.setName(F("Timer1"));
+    rxEdgeIsrStatistic.setName(F("RX edge"));
+#endif
+    stateEdgeIsrStatistic.setName(F("STATE edge"));
+    buttonEdgeIsrStatistic.setName(F("Button edge"));
+    ledTimerIsrStatistic.setName(F("LED timer"));
+    eepromIsrStatistic.setName(F("EEPROM"));
+#endif
 
-    Serial << F("K810 started, seed: ")
-        << (checked ? F("checked") : F("unchecked"))
-        << F(", version: ")
-        << KeyboardController::getVersion()
-        << endl;
+    static_assert(sizeof(TASKS) / sizeof(TASKS[0]) <= TASK_SCHEDULER_MAX_TASKS, "Raise TASK_SCHEDULER_MAX_TASKS for the task table");
+    taskScheduler.setup(TASKS, sizeof(TASKS) / sizeof(TASKS[0]), this);
 }
 
 //================ Loop ==================
 
 /**
  * @brief Main application loop
- * Handles all periodic tasks including:
- * - System monitoring (watchdog, statistics)
- * - Peripheral updates (LEDs, buttons, keyboard)
- * - Communication processing (Bluetooth, serial)
- * - Application logic
+ * Runs one pass of the task table (see TASKS):
+ * - Communication processing (Bluetooth, CRC link, fast lock) on every pass
+ * - System monitoring (watchdog, statistics, output, boot) every 5-50 ms
+ * - Peripheral updates (keyboard) every 50 ms
+ * - Application logic (commands, button, EEPROM) every pass to 10 ms
  */
 void K810Security::loop()
 {
-    MEASURE_TIME(applicationStatistic)
+    MEASURE_TIME(loopStatistic)
     {
-        // System monitoring
-        MEASURE_TIME(systemStatistic)
-        {
-            watchdogController.loop();
-            statisticController.loop(Serial);
-        }
-
-        // Peripheral updates
-        MEASURE_TIME(peripheralStatistic)
-        {
-            ledController.loop();
-            rxLED.loop();
-            txLED.loop();
-            buttonController.loop();
-            keyboardController.loop();
-        }
-
-        // Communication processing
-        MEASURE_TIME(communicationStatistic)
-        {
-            softwareSerial.loop();
-            hc05.loop();
-
-            if (hc05.isDataMode())
-            {
-                crcPackageInterface.loop();
-                if (streamBluetoothData.available())
-                {
-                    hc05.sendData(streamBluetoothData.read());
-                }
-            }
-            else
-            {
-                defaultPackageInterface.loop();
-                if (streamBluetoothCommand.available())
-                {
-                    hc05.sendData(streamBluetoothCommand.read());
-                }
-            }
-
-            if (!hc05.isConnected() && keyboardController.isSeedChecked())
-            {
-                keyboardController.lock();
-            } 
-        }
-
-        // Application logic
-        MEASURE_TIME(applicationStatistic)
-        {
-            serialCommands.readSerial();
-            bluetoothCommands.readSerial();
+        taskScheduler.loop();
+    }
 
-            eepromController.loop();
+    stallRecorder.loop();
 
-            handleBusinessLogic();
-        }
-    }
+#if SIM_BENCHMARK && !HC05_HARDWARE_UART
+    ++simProbe.loopPasses;
+    simProbe.rxErrors = softwareSerial.getRxErrorCount();
+    simProbe.rxDrift = softwareSerial.getRxDrift();
+    simProbe.packets = crcPackageInterface.getLinkStatistic().packetsReceived;
+#endif
 }
 
-// ISR needs to be outside the class
-ISR(TIMER1_COMPA_vect)
+#if !HC05_HARDWARE_UART
+// ISR needs to be outside the class; HOT_PATH like processISR(), or GCC will not inline it
+ISR(TIMER1_COMPA_vect, HOT_PATH)
 {
-    softwareSerial.processISR();
-}
\ No newline at end of file
+    MEASURE_ISR(timer1IsrStatistic)
+    {
+        softwareSerial.processISR();
+    }
+}
+#endif
\ No newline at end of file
@@ -1,5 +1,8 @@
 // Arduino core
-#include <EEPROM.h>
+#include <util/atomic.h>
+
+// Third-party libraries
+#include <SipHash.h>
 
 // Project headers
 #include "KeyboardController.h"
@@ -10,14 +13,20 @@
 #define CLASS_TRACE_LEVEL DEBUG_KEYBOARD_CONTROLLER
 #include "TraceHelper.h"
 
-KeyboardController::KeyboardController(const uint8_t keyboardPowerPin,
-                                       const uint8_t keyboardDpPin,
-                                       const uint8_t keyboardDmPin)
-    : Traceable(F("KeyboardController"), static_cast<Level>(DEBUG_KEYBOARD_CONTROLLER)), m_keyboardPowerOutput(keyboardPowerPin, OUTPUT), m_keyboardDpControl(keyboardDpPin, OUTPUT), m_keyboardDmControl(keyboardDmPin, OUTPUT), m_state(LOCKED)
+KeyboardController::SecurityState KeyboardController::security;
+bool KeyboardController::securityLoaded = false;
+KeyboardController::Challenge KeyboardController::challenge;
+
+KeyboardController::KeyboardController()
+    : Traceable(TraceComponent::KEYBOARD_CONTROLLER), m_state(LOCKED), m_lockPending(false), m_pendingLockLatency(0)
 {
-  m_keyboardPowerOutput.low();
-  m_keyboardDpControl.low();
-  m_keyboardDmControl.low();
+  m_lockLatency.setName(F("Lock latency"));
+  PowerPin::setMode(true);
+  DpPin::setMode(true);
+  DmPin::setMode(true);
+  PowerPin::low();
+  DpPin::low();
+  DmPin::low();
 } // end KeyboardController
 
 KeyboardController::State KeyboardController::state() const
@@ -25,19 +34,35 @@ KeyboardController::State KeyboardController::state() const
   return m_state;
 } // end state
 
-void KeyboardController::lock()
+void KeyboardController::lock(const uint32_t triggerMicros)
 {
   if (m_state != LOCKED)
   {
-    m_state = LOCKED;
-    m_keyboardPowerOutput.low();
-    blockUSB();
-    TRACE_INFO()
-        << F("Keyboard locked")
-        << endl;
+    lockFromISR(triggerMicros);
   } // end if
 } // end lock
 
+void KeyboardController::lockFromISR(const uint32_t triggerMicros)
+{
+  // Clear the outputs first so the data lines never drive high
+  PowerPin::low();
+  DpPin::low();
+  DmPin::low();
+  DpPin::setMode(true);
+  DmPin::setMode(true);
+  const uint32_t latency = micros() - triggerMicros;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (m_state != LOCKED)
+    {
+      m_state = LOCKED;
+      m_pendingLockLatency = latency;
+      m_lockPending = true;
+    } // end if
+  }
+} // end lockFromISR
+
 void KeyboardController::unlock(const bool releaseUSBFlag)
 {
   if (m_state != UNLOCKED)
@@ -46,8 +71,10 @@ void KeyboardController::unlock(const bool releaseUSBFlag)
     {
       releaseUSB();
     } // end if
-    m_keyboardPowerOutput.high();
+    PowerPin::high();
     m_state = UNLOCKED;
+    eventJournal.record(EventJournal::EVENT_UNLOCK);
+    telemetryController.notify(TelemetryController::EVENT_UNLOCK);
     TRACE_INFO()
         << F("Keyboard unlocked")
         << endl;
@@ -58,6 +85,33 @@ void KeyboardController::unlock(const bool releaseUSBFlag)
   } // end if
 } // end unlock
 
+void KeyboardController::loadSecurityState()
+{
+  security.salt = eepromWriter.read(EEPROM_SALT_ADDRESS);
+  security.seedChecked = eepromWriter.read(EEPROM_SEED_CHECKED_ADDRESS);
+  for (int i = 0; i < SEED_LENGTH; ++i)
+  {
+    security.seed[i] = eepromWriter.read(EEPROM_SEED_ADDRESS + i);
+  }
+  securityLoaded = true;
+} // end loadSecurityState
+
+void KeyboardController::invalidateSecurityState()
+{
+  securityLoaded = false;
+  // A tag of the old seed must not count
+  challenge.pending = false;
+} // end invalidateSecurityState
+
+KeyboardController::SecurityState &KeyboardController::securityState()
+{
+  if (!securityLoaded)
+  {
+    loadSecurityState();
+  }
+  return security;
+} // end securityState
+
 void KeyboardController::generateSeed(byte *const seedArr,
                                       const uint8_t arrLength)
 {
@@ -66,53 +120,129 @@ void KeyboardController::generateSeed(byte *const seedArr,
     return;
   }
 
-  if (EEPROM.read(EEPROM_SEED_ADDRESS) != 0)
+  SecurityState &cache = securityState();
+
+  if (cache.seed[0] == 0)
   {
-    for (int i = 0; i < SEED_LENGTH; ++i)
+    byte random[SEED_LENGTH];
+    if (!entropyPool.read(random, SEED_LENGTH))
     {
-      seedArr[i] = EEPROM.read(EEPROM_SEED_ADDRESS + i);
+      TRACE_WARN()
+          << F("Seed drawn before the entropy pool is ready")
+          << endl;
     }
 
-    return;
-  }
-
-  srand(millis());
-
-  for (int i = 0; i < SEED_LENGTH; ++i)
-  {
-    seedArr[i] = (rand() % (0xFF - 1)) + 1;
+    for (int i = 0; i < SEED_LENGTH; ++i)
+    {
+      // Zero marks an unset seed, keep every byte in 1..254 as before
+      cache.seed[i] = (random[i] % (0xFF - 1)) + 1;
 
-    EEPROM.update(EEPROM_SEED_ADDRESS + i, seedArr[i]);
+      eepromWriter.write(EEPROM_SEED_ADDRESS + i, cache.seed[i]);
+    }
   }
+
+  memcpy(seedArr, cache.seed, SEED_LENGTH);
 }
 
 byte KeyboardController::generateSalt()
 {
-  byte salt = EEPROM.read(EEPROM_SALT_ADDRESS);
+  SecurityState &cache = securityState();
 
-  if (salt != 0)
+  if (cache.salt != 0)
   {
-    return salt;
+    return cache.salt;
   }
 
-  srand(millis());
-  salt = (rand() % (0xFF - 1)) + 1;
+  byte random;
+  if (!entropyPool.read(&random, 1))
+  {
+    TRACE_WARN()
+        << F("Salt drawn before the entropy pool is ready")
+        << endl;
+  }
+  cache.salt = (random % (0xFF - 1)) + 1;
 
-  EEPROM.update(EEPROM_SALT_ADDRESS, salt);
+  eepromWriter.write(EEPROM_SALT_ADDRESS, cache.salt);
 
-  return salt;
+  return cache.salt;
 }
 
 bool KeyboardController::isSeedChecked()
 {
-  return EEPROM.read(EEPROM_SEED_CHECKED_ADDRESS) != 0;
+  return securityState().seedChecked != 0;
 }
 
 void KeyboardController::seedChecked()
 {
-  EEPROM.update(EEPROM_SEED_CHECKED_ADDRESS, true);
+  securityState().seedChecked = true;
+  eepromWriter.write(EEPROM_SEED_CHECKED_ADDRESS, true);
 }
 
+bool KeyboardController::createChallenge(byte *const nonce)
+{
+  if (!challenge.epochStepped)
+  {
+    // One EEPROM write per boot, the counter below is unique within it
+    uint32_t epoch = 0;
+    for (uint8_t i = 0; i < sizeof(epoch); ++i)
+    {
+      epoch |= static_cast<uint32_t>(eepromWriter.read(EEPROM_CHALLENGE_EPOCH_ADDRESS + i)) << (8 * i);
+    }
+    ++epoch;
+    for (uint8_t i = 0; i < sizeof(epoch); ++i)
+    {
+      eepromWriter.write(EEPROM_CHALLENGE_EPOCH_ADDRESS + i, static_cast<uint8_t>(epoch >> (8 * i)));
+    }
+    challenge.epoch = epoch;
+    challenge.count = 0;
+    challenge.epochStepped = true;
+  }
+
+  if (!challenge.epochStored)
+  {
+    // A reset before the epoch lands would boot with the old one and repeat its nonces
+    const uint32_t start = millis();
+    while (!eepromWriter.isIdle())
+    {
+      if (millis() - start >= CHALLENGE_EPOCH_WRITE_TIMEOUT_MS)
+      {
+        return false;
+      }
+    }
+    challenge.epochStored = true;
+  }
+
+  ++challenge.count;
+  memcpy(challenge.nonce, &challenge.epoch, sizeof(challenge.epoch));
+  memcpy(challenge.nonce + sizeof(challenge.epoch), &challenge.count, sizeof(challenge.count));
+  challenge.issuedMillis = millis();
+  challenge.pending = true;
+  memcpy(nonce, challenge.nonce, CHALLENGE_NONCE_LENGTH);
+  return true;
+} // end createChallenge
+
+bool KeyboardController::verifyChallenge(const ChallengeAction action, const byte *const tag)
+{
+  if (!challenge.pending)
+  {
+    return false;
+  }
+  // One tag per nonce, right or wrong
+  challenge.pending = false;
+  if (millis() - challenge.issuedMillis > CHALLENGE_TIMEOUT_MS)
+  {
+    return false;
+  }
+
+  static_assert(SEED_LENGTH == SipHash::KEY_LENGTH, "The seed is the challenge key");
+  byte message[CHALLENGE_NONCE_LENGTH + 1];
+  memcpy(message, challenge.nonce, CHALLENGE_NONCE_LENGTH);
+  message[CHALLENGE_NONCE_LENGTH] = action;
+  byte expected[SipHash::TAG_LENGTH];
+  SipHash::mac(securityState().seed, message, sizeof(message), expected);
+  return SipHash::equal(expected, tag, SipHash::TAG_LENGTH);
+} // end verifyChallenge
+
 void KeyboardController::cypherEncryption(byte *const dataArr,
                                           const uint8_t arrLength,
                                           const byte salt)
@@ -204,6 +334,25 @@ uint16_t KeyboardController::getVersion()
 
 void KeyboardController::loop()
 {
+  bool locked = false;
+  uint32_t latency = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    locked = m_lockPending;
+    latency = m_pendingLockLatency;
+    m_lockPending = false;
+  }
+  if (locked)
+  {
+    m_lockLatency.add(latency);
+    eventJournal.record(EventJournal::EVENT_LOCK, 0, (latency > 0xFFFF) ? 0xFFFF : latency);
+    telemetryController.notify(TelemetryController::EVENT_LOCK);
+    TRACE_INFO()
+        << F("Keyboard locked, latency us: ")
+        << latency
+        << endl;
+  } // end if
+
   switch (m_state) {
     case LOCKED:
       // Do nothing when locked
@@ -217,10 +366,10 @@ void KeyboardController::loop()
 
 void KeyboardController::blockUSB()
 {
-  m_keyboardDpControl.setMode(true);
-  m_keyboardDmControl.setMode(true);
-  m_keyboardDpControl.low();
-  m_keyboardDmControl.low();
+  DpPin::setMode(true);
+  DmPin::setMode(true);
+  DpPin::low();
+  DmPin::low();
   TRACE_INFO()
       << F("USB blocked")
       << endl;
@@ -228,8 +377,8 @@ void KeyboardController::blockUSB()
 
 void KeyboardController::releaseUSB()
 {
-  m_keyboardDpControl.setMode(false);
-  m_keyboardDmControl.setMode(false);
+  DpPin::setMode(false);
+  DmPin::setMode(false);
   TRACE_INFO()
       << F("USB released")
       << endl;
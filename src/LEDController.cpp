@@ -1,14 +1,35 @@
+// Arduino core
+#include <avr/pgmspace.h>
+
 // Project headers
 #include "LEDController.h"
 
-LEDController::LEDController(const uint8_t greenLEDPin,
-                             const uint8_t redLEDPin)
-    : m_greenLED(greenLEDPin), m_redLED(redLEDPin), m_state(LOCKED)
+static_assert(LED_SLOW_BLINK_DURATION / LED_PATTERN_TICK_MS <= 255, "LED_SLOW_BLINK_DURATION is too long for one step");
+static_assert(LED_FAST_BLINK_DURATION / LED_PATTERN_TICK_MS >= 1, "LED_FAST_BLINK_DURATION is shorter than a tick");
+
+static const LEDPatternEngine::Step PATTERN_OFF[] PROGMEM = {{LOW, 255}, {LOW, 0}};
+static const LEDPatternEngine::Step PATTERN_ON[] PROGMEM = {{HIGH, 255}, {LOW, 0}};
+static const LEDPatternEngine::Step PATTERN_FAST_BLINK[] PROGMEM = {
+    {HIGH, LED_FAST_BLINK_DURATION / LED_PATTERN_TICK_MS},
+    {LOW, LED_FAST_BLINK_DURATION / LED_PATTERN_TICK_MS},
+    {LOW, 0}};
+static const LEDPatternEngine::Step PATTERN_SLOW_BLINK[] PROGMEM = {
+    {HIGH, LED_SLOW_BLINK_DURATION / LED_PATTERN_TICK_MS},
+    {LOW, LED_SLOW_BLINK_DURATION / LED_PATTERN_TICK_MS},
+    {LOW, 0}};
+
+LEDController::LEDController(LEDPatternEngine &engine,
+                             const uint8_t greenChannel,
+                             const uint8_t redChannel)
+    : m_engine(engine), m_greenChannel(greenChannel), m_redChannel(redChannel), m_state(LOCKED)
 {
-  m_greenLED.turnOFF();
-  m_redLED.turnON();
 } // end LEDController
 
+void LEDController::begin()
+{
+  show();
+} // end begin
+
 LEDController::State LEDController::state() const
 {
   return m_state;
@@ -19,36 +40,36 @@ void LEDController::setState(const State state)
   if (state != m_state)
   {
     m_state = state;
-
-    switch (m_state)
-    {
-    case LOCKED:
-      m_greenLED.turnOFF();
-      m_redLED.turnON();
-      break;
-
-    case RESETTING_BLUETOOTH:
-    case FORMATTING:
-      m_greenLED.turnOFF();
-      m_redLED.blink(LED_FAST_BLINK_DURATION, LED_FAST_BLINK_DURATION);
-      break;
-
-    case CONNECTING:
-    case PRESSING:
-      m_greenLED.turnOFF();
-      m_redLED.blink(LED_SLOW_BLINK_DURATION, LED_SLOW_BLINK_DURATION);
-      break;
-
-    case UNLOCKED:
-      m_greenLED.turnON();
-      m_redLED.turnOFF();
-      break;
-    } // end switch
+    show();
   } // end if
 } // end setState
 
-void LEDController::loop()
+void LEDController::show()
 {
-  m_greenLED.loop();
-  m_redLED.loop();
-} // end loop
\ No newline at end of file
+  const LEDPatternEngine::Step *green = PATTERN_OFF;
+  const LEDPatternEngine::Step *red = PATTERN_OFF;
+
+  switch (m_state)
+  {
+  case LOCKED:
+    red = PATTERN_ON;
+    break;
+
+  case RESETTING_BLUETOOTH:
+  case FORMATTING:
+    red = PATTERN_FAST_BLINK;
+    break;
+
+  case CONNECTING:
+  case PRESSING:
+    red = PATTERN_SLOW_BLINK;
+    break;
+
+  case UNLOCKED:
+    green = PATTERN_ON;
+    break;
+  } // end switch
+
+  m_engine.play(m_greenChannel, green);
+  m_engine.play(m_redChannel, red);
+} // end show
@@ -0,0 +1,99 @@
+/**
+ * @file LEDPatternEngine.cpp
+ * @brief Implementation of the timer driven LED patterns.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+// Third-party libraries
+#include <FastPin.h>
+
+// Project headers
+#include "LEDPatternEngine.h"
+#include "Globals.h"
+
+static_assert(LED_PATTERN_TIMER4_TOP >= 1 && LED_PATTERN_TIMER4_TOP <= 255, "LED_PATTERN_TICK_MS does not fit Timer4");
+
+void LEDPatternEngine::attach(const uint8_t channel, const uint8_t pin)
+{
+  pinMode(pin, OUTPUT);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    m_channels[channel].port = portOutputRegister(digitalPinToPort(pin));
+    m_channels[channel].mask = digitalPinToBitMask(pin);
+    if (m_channels[channel].pattern != nullptr)
+    {
+      m_channels[channel].step = m_channels[channel].pattern;
+      advance(m_channels[channel]);
+    }
+  }
+} // end attach
+
+void LEDPatternEngine::begin()
+{
+  // Normal mode, outputs disconnected; the core's PWM setup is overwritten
+  TCCR4A = 0;
+  TCCR4C = 0;
+  TCCR4D = 0;
+  TCCR4E = 0;
+  TC4H = 0;
+  OCR4C = LED_PATTERN_TIMER4_TOP;
+  TC4H = 0;
+  TCNT4 = 0;
+  TCCR4B = _BV(CS43) | _BV(CS41) | _BV(CS40); // clk/1024
+  TIMSK4 = _BV(TOIE4);
+} // end begin
+
+void LEDPatternEngine::play(const uint8_t channel, const Step *pattern)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    Channel &state = m_channels[channel];
+    state.pattern = pattern;
+    state.step = pattern;
+    if (pattern != nullptr && state.port != nullptr)
+      advance(state);
+  }
+} // end play
+
+void LEDPatternEngine::processISR()
+{
+  for (uint8_t i = 0; i < LED_PATTERN_CHANNELS; ++i)
+  {
+    Channel &channel = m_channels[i];
+    if (channel.pattern == nullptr || channel.port == nullptr || --channel.ticksLeft != 0)
+      continue;
+    advance(channel);
+  }
+} // end processISR
+
+void LEDPatternEngine::advance(Channel &channel)
+{
+  uint8_t ticks = pgm_read_byte(&channel.step->ticks);
+  if (ticks == 0)
+  {
+    channel.step = channel.pattern;
+    ticks = pgm_read_byte(&channel.step->ticks);
+  }
+
+  // A main loop read-modify-write of the same port can undo this write; the next step restores it
+  FastPin::set(channel.port, channel.mask, pgm_read_byte(&channel.step->level));
+  channel.ticksLeft = ticks;
+  ++channel.step;
+} // end advance
+
+/**
+ * @brief Timer4 overflow, one pattern tick.
+ */
+ISR(TIMER4_OVF_vect)
+{
+  MEASURE_ISR(ledTimerIsrStatistic)
+  {
+    ledPatterns.processISR();
+  }
+}
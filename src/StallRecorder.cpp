@@ -0,0 +1,218 @@
+/**
+ * @file StallRecorder.cpp
+ * @brief Implementation of the loop stall recorder.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <util/atomic.h>
+
+// Project headers
+#include "StallRecorder.h"
+#include "Globals.h"
+
+/// Marks a valid persisted record, stored with its complement
+static constexpr uint16_t PERSISTED_MAGIC = 0x57A1;
+
+/// Newest record, kept across resets (placed in non-initialized memory)
+static StallRecorder::Record persistedRecord __attribute__((section(".noinit")));
+/// PERSISTED_MAGIC when persistedRecord is valid
+static uint16_t persistedMagic __attribute__((section(".noinit")));
+/// Complement of persistedMagic
+static uint16_t persistedCheck __attribute__((section(".noinit")));
+
+/**
+ * @brief Clamp a queue fill level to one byte.
+ */
+static uint8_t clampFill(const int fill)
+{
+  return fill < 0 ? 0 : (fill > UINT8_MAX ? UINT8_MAX : static_cast<uint8_t>(fill));
+}
+
+/**
+ * @brief Check whether a statistic is one of the recorded regions.
+ */
+static bool isRegion(const Statistic *const statistic)
+{
+  for (uint8_t i = 0; i < STALL_REGION_COUNT && i < lengthOfStatistics; ++i)
+  {
+    if (statistics[i] == statistic)
+      return true;
+  }
+  return false;
+}
+
+void StallRecorder::setup()
+{
+  if (persistedMagic == PERSISTED_MAGIC && persistedCheck == static_cast<uint16_t>(~PERSISTED_MAGIC))
+  {
+    Record record = persistedRecord;
+    record.flags |= FLAG_PREVIOUS_BOOT;
+    store(record);
+  }
+} // end setup
+
+void StallRecorder::loop()
+{
+  if (m_threshold != 0 && loopStatistic.getLast() >= m_threshold)
+  {
+    capture(0, WatchdogController::NO_HEARTBEAT, 0);
+  }
+} // end loop
+
+void StallRecorder::captureFromWatchdog(const uint8_t heartbeat, const bool overdue, const uint16_t address)
+{
+  capture(FLAG_WATCHDOG | (overdue ? FLAG_HEARTBEAT_OVERDUE : 0), heartbeat, address);
+}
+
+void StallRecorder::capture(const uint8_t flags, const uint8_t heartbeat, const uint16_t address)
+{
+  Record record;
+  record.timestamp = millis();
+  record.flags = flags;
+  record.region = NO_REGION;
+  record.heartbeat = heartbeat;
+  record.address = address;
+
+  // Open regions report their running time, the others their last interval
+  const Statistic *const active = Statistic::getActive();
+  // A measurement outside the table, e.g. a command, is blamed on its innermost region
+  const Statistic *region = active;
+  while (region != nullptr && !isRegion(region))
+    region = region->getParent();
+  uint16_t slowest = 0;
+  for (uint8_t i = 0; i < STALL_REGION_COUNT; ++i)
+  {
+    uint16_t time = 0;
+    if (i < lengthOfStatistics && statistics[i] != nullptr)
+    {
+      time = statistics[i]->getRunning();
+      if (time == 0)
+        time = statistics[i]->getLast();
+
+      if (statistics[i] == region)
+      {
+        record.region = i;
+      }
+    }
+    record.regionTimes[i] = time;
+
+    // After the fact, blame the slowest region below the loop
+    if (active == nullptr && i > 0 && time > slowest)
+    {
+      slowest = time;
+      record.region = i;
+    }
+  }
+
+  record.hc05State = hc05.getState();
+  record.crcIncoming = crcPackageInterface.getIncomingState();
+  record.crcOutgoing = crcPackageInterface.getOutgoingCount();
+  record.linkRx = clampFill(streamBluetoothLink.available());
+  record.linkTxFree = clampFill(streamBluetoothLink.availableForWrite());
+  record.dataPending = clampFill(streamBluetoothData.available());
+  record.usbTxFree = clampFill(Serial.availableForWrite());
+
+  store(record);
+}
+
+void StallRecorder::store(const Record &record)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    m_records[m_next] = record;
+    m_next = (m_next + 1) % STALL_RECORD_COUNT;
+    if (m_count < STALL_RECORD_COUNT)
+      ++m_count;
+
+    if (!(record.flags & FLAG_PREVIOUS_BOOT))
+    {
+      persistedRecord = record;
+      persistedMagic = PERSISTED_MAGIC;
+      persistedCheck = ~PERSISTED_MAGIC;
+    }
+  }
+}
+
+void StallRecorder::print(Print &print) const
+{
+  Utilities::printStars(print);
+  print.print(F("Stall threshold: "));
+  print.print(m_threshold);
+  print.println(F(" us"));
+
+  uint8_t count = 0;
+  uint8_t first = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    count = m_count;
+    first = (m_next + STALL_RECORD_COUNT - m_count) % STALL_RECORD_COUNT;
+  }
+
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    print.println(F("--------------------"));
+    printRecord(print, m_records[(first + i) % STALL_RECORD_COUNT]);
+  }
+  Utilities::printStars(print);
+}
+
+/**
+ * @brief Print one record as three lines: when and where, region times, link
+ * state; a fourth for watchdog records: the blamed heartbeat and the address.
+ */
+void StallRecorder::printRecord(Print &print, const Record &record)
+{
+  print.print('[');
+  print.print(record.timestamp);
+  print.print(F("] "));
+  if (record.region < lengthOfStatistics && statistics[record.region] != nullptr &&
+      statistics[record.region]->getName() != nullptr)
+  {
+    print.print(statistics[record.region]->getName());
+  }
+  else
+  {
+    print.print('?');
+  }
+  if (record.flags & FLAG_WATCHDOG)
+    print.print(F(", watchdog"));
+  if (record.flags & FLAG_PREVIOUS_BOOT)
+    print.print(F(", before reset"));
+  print.println();
+
+  for (uint8_t i = 0; i < STALL_REGION_COUNT && i < lengthOfStatistics; ++i)
+  {
+    print.print(' ');
+    const __FlashStringHelper *name = statistics[i] != nullptr ? statistics[i]->getName() : nullptr;
+    print.print(name != nullptr ? name : F("?"));
+    print.print(':');
+    print.print(record.regionTimes[i]);
+  }
+  print.println(F(" us"));
+
+  print.print(F(" hc05:"));
+  print.print(record.hc05State);
+  print.print(F(" crc:"));
+  print.print(record.crcIncoming);
+  print.print('/');
+  print.print(record.crcOutgoing);
+  print.print(F(" link rx:"));
+  print.print(record.linkRx);
+  print.print(F(" tx free:"));
+  print.print(record.linkTxFree);
+  print.print(F(" data:"));
+  print.print(record.dataPending);
+  print.print(F(" usb free:"));
+  print.println(record.usbTxFree);
+
+  if (record.flags & FLAG_WATCHDOG)
+  {
+    print.print((record.flags & FLAG_HEARTBEAT_OVERDUE) ? F(" overdue:") : F(" after:"));
+    print.print(WatchdogController::getHeartbeatName(record.heartbeat));
+    print.print(F(" pc:0x"));
+    print.println(record.address, HEX);
+  }
+}
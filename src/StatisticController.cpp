@@ -1,19 +1,27 @@
 // Arduino core
 #include <MemoryUsage.h>
+#include <StaticPool.h>
+#if MEMORY_USAGE_HEAP_TAGS
+#include <HeapAccount.h>
+#endif
 
 // Project headers
 #include "StatisticController.h"
+#include "CRCPackageInterface.h"
 #include "Utilities.h"
 
 void StatisticController::setup()
 {
   MemoryUsage::stackPaint();
+  Statistic::setupClock();
 } // end setup
 
 void StatisticController::loop(Print &print)
 {
   static bool firstRun = true;
 
+  MemoryUsage::stackScan(STACK_SCAN_BYTES);
+
   if (firstRun)
   {
     firstRun = false;
@@ -23,26 +31,109 @@ void StatisticController::loop(Print &print)
 
 void StatisticController::printStatisticTable(Print &print,
                                               const Statistic *statistics[],
-                                              const uint8_t statisticSize) const
+                                              const uint8_t statisticSize,
+                                              const CRCPackageInterface *packageInterface) const
 {
-  Utilities::printStars(print);
-  for (uint8_t i = 0; i < statisticSize; ++i)
+  for (uint8_t block = 0; printStatisticBlock(print, block, statistics, statisticSize, packageInterface); ++block)
+  {
+  }
+}
+
+bool StatisticController::printStatisticBlock(Print &print,
+                                              const uint8_t block,
+                                              const Statistic *statistics[],
+                                              const uint8_t statisticSize,
+                                              const CRCPackageInterface *packageInterface) const
+{
+  if (block == 0 || block == statisticSize + 3)
   {
-    if (statistics[i] != nullptr)
+    Utilities::printStars(print);
+  }
+  else if (block <= statisticSize)
+  {
+    const Statistic *statistic = statistics[block - 1];
+    if (statistic != nullptr)
     {
-      statistics[i]->print(print);
-      if ((i + 1) < statisticSize)
+      if (block > 1)
       {
         print.println(F("--------------------"));
       }
+      statistic->print(print);
     }
   }
+  else if (block == statisticSize + 1)
+  {
+    if (packageInterface != nullptr)
+    {
+      print.println(F("--------------------"));
+      packageInterface->printStatistic(print);
+    }
+  }
+  else if (block == statisticSize + 2)
+  {
+    print.println(F("--------------------"));
+    printRamBudget(print);
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+#if STATISTIC_ISR_LOAD
+void StatisticController::loopIsrStatistics(IsrStatistic *const statistics[], const uint8_t statisticSize)
+{
+  for (uint8_t i = 0; i < statisticSize; ++i)
+  {
+    statistics[i]->loop();
+  }
+}
+
+void StatisticController::printIsrStatisticTable(Print &print,
+                                                 IsrStatistic *const statistics[],
+                                                 const uint8_t statisticSize) const
+{
+  Utilities::printStars(print);
+  for (uint8_t i = 0; i < statisticSize; ++i)
+  {
+    statistics[i]->print(print);
+  }
   Utilities::printStars(print);
 }
+#endif
 
 void StatisticController::printRam(Print &print) const
 {
   Utilities::printStars(print);
   MemoryUsage::ramDisplay(print);
+  printRamBudget(print);
   Utilities::printStars(print);
 }
+
+void StatisticController::printRamBudget(Print &print) const
+{
+  uint8_t freeBlocks;
+  const int heapFree = MemoryUsage::heapFree(freeBlocks);
+  const int heapUsed = MemoryUsage::heapSize() - heapFree;
+
+  print.print(F("RAM free:"));
+  print.print(MemoryUsage::freeRam());
+  print.print(F(", low:"));
+  print.println(MemoryUsage::lowestFreeRam());
+  print.print(F("Heap used:"));
+  print.print(heapUsed);
+  print.print(F(", free:"));
+  print.print(heapFree);
+  print.print(F(" in "));
+  print.print(freeBlocks);
+  print.println(F(" blk"));
+  MemoryPool::printAll(print);
+#if MEMORY_USAGE_HEAP_TAGS
+  HeapAccount::print(print);
+  // String buffers, core allocations and malloc headers
+  print.print(F("Untagged:"));
+  print.print(heapUsed - static_cast<int>(HeapAccount::taggedBytes()));
+  print.println(F(" B"));
+#endif
+}
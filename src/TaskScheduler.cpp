@@ -0,0 +1,191 @@
+/**
+ * @file TaskScheduler.cpp
+ * @brief Implementation of the main loop task scheduler.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
+
+// Project headers
+#include "TaskScheduler.h"
+#include "Utilities.h"
+
+/**
+ * @brief Count one event, saturating at 0xFFFF.
+ */
+static inline void countSaturated(uint16_t &counter)
+{
+  if (counter < UINT16_MAX)
+    ++counter;
+}
+
+/**
+ * @brief Microseconds since a Statistic::now() stamp.
+ */
+static inline uint32_t elapsedUs(const uint32_t since)
+{
+  return (Statistic::now() - since) / Statistic::TICKS_PER_US;
+}
+
+void TaskScheduler::setup(const Task *tasks, const uint8_t taskCount, void *context)
+{
+  p_tasks = tasks;
+  p_context = context;
+  m_taskCount = taskCount < TASK_SCHEDULER_MAX_TASKS ? taskCount : TASK_SCHEDULER_MAX_TASKS;
+
+  LoopClock::tick();
+  const uint16_t now = LoopClock::millis16();
+  for (uint8_t i = 0; i < m_taskCount; ++i)
+  {
+    m_states[i].deadline = now + i;
+    m_states[i].deferred = false;
+  }
+  resetCounters();
+} // end setup
+
+void TaskScheduler::loop()
+{
+  LoopClock::tick();
+  const uint16_t now = LoopClock::millis16();
+  const uint32_t passStart = Statistic::now();
+  Statistic *open = nullptr;
+
+  for (uint8_t i = 0; i < m_taskCount; ++i)
+  {
+    Task task;
+    memcpy_P(&task, &p_tasks[i], sizeof(Task));
+    TaskState &state = m_states[i];
+
+    if (task.periodMs != 0 && static_cast<int16_t>(now - state.deadline) < 0)
+    {
+      continue;
+    }
+    if (task.priority == PRIORITY_NORMAL && !state.deferred && elapsedUs(passStart) >= TASK_SCHEDULER_PASS_BUDGET_US)
+    {
+      state.deferred = true;
+      countSaturated(state.deferrals);
+      continue;
+    }
+    state.deferred = false;
+
+    if (task.statistic != open)
+    {
+      if (open != nullptr)
+        open->end();
+      open = task.statistic;
+      if (open != nullptr)
+        open->start();
+    }
+
+    const uint32_t runStart = Statistic::now();
+    task.run(p_context);
+    const uint32_t runUs = elapsedUs(runStart);
+
+    const uint16_t runTime = runUs > UINT16_MAX ? UINT16_MAX : static_cast<uint16_t>(runUs);
+    if (runTime > state.maxUs)
+      state.maxUs = runTime;
+    if (runTime > task.budgetUs)
+      countSaturated(state.overruns);
+
+    if (task.periodMs != 0)
+    {
+      state.deadline += task.periodMs;
+      // A whole period behind: run once now, do not catch up
+      if (static_cast<int16_t>(now - state.deadline) >= 0)
+        state.deadline = now + task.periodMs;
+    }
+  }
+
+  if (open != nullptr)
+    open->end();
+
+  idle();
+} // end loop
+
+void TaskScheduler::idle()
+{
+#if TASK_SCHEDULER_IDLE_SLEEP
+  if (!m_idleSleep)
+    return;
+
+  const uint16_t now = millis();
+  for (uint8_t i = 0; i < m_taskCount; ++i)
+  {
+    const TaskState &state = m_states[i];
+    if (state.deferred)
+      return;
+    if (pgm_read_word(&p_tasks[i].periodMs) != 0 && static_cast<int16_t>(now - state.deadline) >= 0)
+      return;
+  }
+
+  // An interrupt landing before sleep_cpu() is served late by one Timer0 tick at most
+  const uint32_t sleepStart = Statistic::now();
+  set_sleep_mode(SLEEP_MODE_IDLE);
+  sleep_enable();
+  sleep_cpu();
+  sleep_disable();
+
+  const uint32_t sleptUs = elapsedUs(sleepStart);
+  m_idleUs = m_idleUs > UINT32_MAX - sleptUs ? UINT32_MAX : m_idleUs + sleptUs;
+#endif
+} // end idle
+
+void TaskScheduler::print(Print &print) const
+{
+  Utilities::printStars(print);
+  for (uint8_t i = 0; i < m_taskCount; ++i)
+  {
+    Task task;
+    memcpy_P(&task, &p_tasks[i], sizeof(Task));
+    const TaskState &state = m_states[i];
+
+    print.print(reinterpret_cast<const __FlashStringHelper *>(task.name));
+    print.print(F(": "));
+    if (task.periodMs == 0)
+    {
+      print.print(F("every pass"));
+    }
+    else
+    {
+      print.print(task.periodMs);
+      print.print(F(" ms"));
+    }
+    if (task.priority == PRIORITY_CRITICAL)
+      print.print(F(" critical"));
+    print.print(F(", max:"));
+    print.print(state.maxUs);
+    print.print(F(" us, budget:"));
+    print.print(task.budgetUs);
+    print.print(F(" us, over:"));
+    print.print(state.overruns);
+    print.print(F(", deferred:"));
+    print.println(state.deferrals);
+  }
+#if TASK_SCHEDULER_IDLE_SLEEP
+  const uint32_t sinceMs = millis() - m_countersSince;
+  print.print(F("Idle sleep: "));
+  print.print(m_idleSleep ? F("on") : F("off"));
+  print.print(F(", asleep:"));
+  print.print(sinceMs == 0 ? 0 : m_idleUs / 10 / sinceMs);
+  print.print(F("% of "));
+  print.print(sinceMs);
+  print.println(F(" ms"));
+#endif
+  Utilities::printStars(print);
+} // end print
+
+void TaskScheduler::resetCounters()
+{
+  for (uint8_t i = 0; i < m_taskCount; ++i)
+  {
+    m_states[i].maxUs = 0;
+    m_states[i].overruns = 0;
+    m_states[i].deferrals = 0;
+  }
+  m_idleUs = 0;
+  m_countersSince = millis();
+} // end resetCounters
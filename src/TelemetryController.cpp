@@ -0,0 +1,242 @@
+/**
+ * @file TelemetryController.cpp
+ * @brief Implementation of the binary telemetry frames.
+ *
+ * @author Aykut ÖZDEMİR
+ * @date 2025
+ */
+
+// Arduino core
+#include <util/crc16.h>
+
+// Third-party libraries
+#include <MemoryUsage.h>
+
+// Project headers
+#include "TelemetryController.h"
+#include "Globals.h"
+
+/// Bytes per statistic in a summary frame: min, average, max, self, overflows
+static constexpr uint8_t SUMMARY_STATISTIC_LENGTH = 10;
+/// Summary bytes besides the statistics: uptime, reset, RAM, count, link counters
+static constexpr uint8_t SUMMARY_FIXED_LENGTH = 10 + sizeof(CRCPackageInterface::LinkStatistic);
+/// Bytes of an event frame: header, events, lock state, sequence, CRC
+static constexpr uint8_t EVENT_FRAME_LENGTH = TelemetryController::HEADER_LENGTH + 3 + 2;
+/// Statistics that fit a summary frame
+static constexpr uint8_t SUMMARY_STATISTICS =
+    (TelemetryController::FRAME_SIZE - TelemetryController::HEADER_LENGTH - 2 - SUMMARY_FIXED_LENGTH) / SUMMARY_STATISTIC_LENGTH;
+
+#if STATISTIC_HISTOGRAM_BUCKETS
+static_assert(TelemetryController::HEADER_LENGTH + 3 + 2 * STATISTIC_HISTOGRAM_BUCKETS + 2 <= TelemetryController::FRAME_SIZE,
+              "Histogram frame does not fit FRAME_SIZE");
+#endif
+
+bool TelemetryController::request(Print &output)
+{
+  if (busy())
+  {
+    return false;
+  }
+
+  p_output = &output;
+  buildSummary();
+  return true;
+}
+
+void TelemetryController::setIntervals(const uint16_t linkSeconds, const uint16_t usbSeconds)
+{
+  m_linkTimer.setInterval(linkSeconds * 1000ul);
+  m_linkTimer.reset();
+  m_usbTimer.setInterval(usbSeconds * 1000ul);
+  m_usbTimer.reset();
+}
+
+void TelemetryController::loop(const bool linkConnected, const bool usbConnected)
+{
+  if (!busy())
+  {
+    // Events go first and only once the pipe takes the whole frame
+    if (linkConnected && m_pendingEvents != 0 && streamTelemetry.availableForWrite() >= EVENT_FRAME_LENGTH)
+    {
+      p_output = &streamTelemetry;
+      buildEvent();
+    }
+    else if (linkConnected && m_linkTimer.isEnabled() && m_linkTimer.isReady())
+    {
+      m_linkTimer.reset();
+      p_output = &streamTelemetry;
+      buildSummary();
+    }
+    else if (usbConnected && m_usbTimer.isEnabled() && m_usbTimer.isReady())
+    {
+      m_usbTimer.reset();
+      p_output = &Serial;
+      buildSummary();
+    }
+    else
+    {
+      return;
+    }
+  }
+
+  const int room = p_output->availableForWrite();
+
+  // Whole frames only on the channel, the peer may not read it at all
+  if (p_output == &streamTelemetry && m_sent == 0 && room < m_length)
+  {
+    m_histogramPending = false;
+    p_output = nullptr;
+    return;
+  }
+
+  if (room > 0)
+  {
+    uint8_t length = m_length - m_sent;
+    if (length > room)
+    {
+      length = room;
+    }
+    m_sent += p_output->write(m_frame + m_sent, length);
+  }
+
+  if (m_sent < m_length)
+  {
+    return;
+  }
+
+  if (m_histogramPending)
+  {
+    buildHistogram();
+  }
+  else
+  {
+    p_output = nullptr;
+  }
+}
+
+void TelemetryController::begin(const uint8_t type)
+{
+  m_length = 0;
+  m_sent = 0;
+  put8(SYNC_0);
+  put8(SYNC_1);
+  put8(VERSION);
+  put8(type);
+  put8(0); // Payload length, set by finish()
+}
+
+void TelemetryController::put8(const uint8_t value)
+{
+  if (m_length < FRAME_SIZE)
+  {
+    m_frame[m_length++] = value;
+  }
+}
+
+void TelemetryController::put16(const uint16_t value)
+{
+  put8(value & 0xFF);
+  put8(value >> 8);
+}
+
+void TelemetryController::put32(const uint32_t value)
+{
+  put16(value & 0xFFFF);
+  put16(value >> 16);
+}
+
+void TelemetryController::finish()
+{
+  m_frame[HEADER_LENGTH - 1] = m_length - HEADER_LENGTH;
+
+  uint16_t crc = 0xFFFF;
+  for (uint8_t i = 2; i < m_length; ++i)
+  {
+    crc = _crc_xmodem_update(crc, m_frame[i]);
+  }
+  put16(crc);
+}
+
+/**
+ * @brief Summary payload.
+ *
+ * uptime u32 ms, reset reason u8, free RAM u16, least free RAM seen (stack
+ * high-water) u16, statistic count u8, then per statistic min, average, max,
+ * self average and overflows as u16 in statistics[] order, then the
+ * LinkStatistic counters as u16 in declaration order.
+ */
+void TelemetryController::buildSummary()
+{
+  begin(TYPE_SUMMARY);
+  put32(millis());
+  put8(watchdogController.getResetReason());
+  put16(MemoryUsage::freeRam());
+  put16(MemoryUsage::lowestFreeRam());
+
+  const uint8_t count = lengthOfStatistics < SUMMARY_STATISTICS ? lengthOfStatistics : SUMMARY_STATISTICS;
+  put8(count);
+  for (uint8_t i = 0; i < count; ++i)
+  {
+    const Statistic *statistic = statistics[i];
+    put16(statistic->getMin());
+    put16(statistic->getAverage());
+    put16(statistic->getMax());
+    put16(statistic->getSelfAverage());
+    put16(statistic->getOverflows());
+  }
+
+  const CRCPackageInterface::LinkStatistic &link = crcPackageInterface.getLinkStatistic();
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&link);
+  for (uint8_t i = 0; i < sizeof(link); ++i)
+  {
+    put8(bytes[i]);
+  }
+  finish();
+  m_histogramPending = STATISTIC_HISTOGRAM_BUCKETS > 0 && lengthOfStatistics > 0;
+}
+
+/**
+ * @brief Histogram payload.
+ *
+ * statistic index u8, bits of the first bucket bound u8, bucket count u8,
+ * then the bucket counts as u16. The statistics take turns, one per burst.
+ */
+void TelemetryController::buildHistogram()
+{
+  m_histogramPending = false;
+#if STATISTIC_HISTOGRAM_BUCKETS
+  if (m_histogramIndex >= lengthOfStatistics)
+  {
+    m_histogramIndex = 0;
+  }
+  const Statistic *statistic = statistics[m_histogramIndex];
+
+  begin(TYPE_HISTOGRAM);
+  put8(m_histogramIndex);
+  put8(Statistic::FIRST_BUCKET_BITS);
+  put8(STATISTIC_HISTOGRAM_BUCKETS);
+  for (uint8_t i = 0; i < STATISTIC_HISTOGRAM_BUCKETS; ++i)
+  {
+    put16(statistic->getBucket(i));
+  }
+  finish();
+  ++m_histogramIndex;
+#endif
+}
+
+/**
+ * @brief Event payload.
+ *
+ * event bits u8 (Event, all since the previous event frame), keyboard state
+ * u8 (0 = locked, 1 = unlocked, as the state command), sequence u8, one more
+ * per event frame so the peer can tell a lost frame.
+ */
+void TelemetryController::buildEvent()
+{
+  begin(TYPE_EVENT);
+  put8(m_pendingEvents);
+  put8(keyboardController.state());
+  put8(++m_eventSequence);
+  finish();
+  m_pendingEvents = 0;
+}
@@ -14,6 +14,7 @@
 
 // Third-party libraries
 #include <SafeInterrupts.h>
+#include <LoopClock.h>
 
 // Project headers
 #include "WatchdogController.h"
@@ -38,10 +39,12 @@ volatile uint8_t resetReason __attribute__((section(".noinit")));
  * @brief Constructor for the WatchdogController class.
  *
  * Initializes the controller with a default reset reason of POWER_ON_RESET
- * and calls setup() to determine the actual reset reason.
+ * and no heartbeat supervised, and calls setup() to determine the actual
+ * reset reason.
  */
 WatchdogController::WatchdogController()
-    : m_resetReason(ResetReason::POWER_ON_RESET)
+    : m_resetReason(ResetReason::POWER_ON_RESET), m_beats(), m_armed(0),
+      m_lastBeat(NO_HEARTBEAT), m_overdue(NO_HEARTBEAT)
 {
   setup();
 }
@@ -116,7 +119,8 @@ void WatchdogController::disable()
  *
  * Sets up for a watchdog-triggered reset by setting the appropriate
  * reset reason value, enabling the watchdog with a short timeout,
- * and then enters an infinite loop to wait for the reset.
+ * and then enters an infinite loop to wait for the reset. The watchdog
+ * runs in reset-only mode, so the interrupt does not mistake it for a stall.
  */
 void WatchdogController::resetMCU()
 {
@@ -124,7 +128,7 @@ void WatchdogController::resetMCU()
 
   resetReason = SOFT_RESET_REASON_VALUE;
 
-  enable(WDTO_15MS);
+  wdt_enable(WDTO_15MS);
   while (1)
     ;
 }
@@ -179,26 +183,92 @@ void WatchdogController::printResetReason(Stream &stream) const
   Utilities::printStars(stream);
 }
 
+/**
+ * @brief Record that a supervised task runs.
+ *
+ * @param heartbeat The task that runs now.
+ */
+void WatchdogController::beat(const Heartbeat heartbeat)
+{
+  m_beats[heartbeat] = LoopClock::millis16();
+  m_armed |= static_cast<uint8_t>(1 << heartbeat);
+  m_lastBeat = heartbeat;
+}
+
+const __FlashStringHelper *WatchdogController::getHeartbeatName(const uint8_t heartbeat)
+{
+  switch (heartbeat)
+  {
+  case HEARTBEAT_SOFT_SERIAL:
+    return F("SoftSerial");
+  case HEARTBEAT_HC05:
+    return F("HC05");
+  case HEARTBEAT_CRC:
+    return F("CRC");
+  case HEARTBEAT_EEPROM:
+    return F("EEPROM");
+  default:
+    return F("?");
+  }
+}
+
 /**
  * @brief Service the watchdog timer to prevent system reset.
  *
  * This method should be called regularly in the main program loop
- * to prevent the watchdog from triggering a system reset.
+ * to prevent the watchdog from triggering a system reset. An overdue
+ * heartbeat withholds the kick; if it stays overdue, the watchdog
+ * interrupt fires and blames it.
  */
 void WatchdogController::loop()
 {
+  const uint16_t now = LoopClock::millis16();
+  for (uint8_t i = 0; i < HEARTBEAT_COUNT; ++i)
+  {
+    if ((m_armed & (1 << i)) && static_cast<uint16_t>(now - m_beats[i]) > WATCHDOG_HEARTBEAT_TIMEOUT_MS)
+    {
+      m_overdue = i;
+      return;
+    }
+  }
+
+  m_overdue = NO_HEARTBEAT;
   wdt_reset();
 }
 
 /**
- * @brief Watchdog Timer Interrupt Service Routine.
+ * @brief Save the stall context and wait for the reset.
+ *
+ * An overdue heartbeat is the stalled task. Otherwise the loop itself hung,
+ * and the heartbeat that beat last is the task it was in or had just left.
  *
- * This ISR is called when the watchdog timer triggers an interrupt.
- * It resets the watchdog counter and sets the reset reason to indicate
- * that a watchdog reset occurred.
+ * @param stackPointer SP on entry to the interrupt.
  */
-ISR(WDT_vect)
+void WatchdogController::handleTimeout(const uint8_t *stackPointer)
 {
-  wdt_reset();
+  // The return address is a big-endian word address right above SP
+  const uint16_t address = static_cast<uint16_t>(((stackPointer[1] << 8) | stackPointer[2]) << 1);
+  const bool overdue = m_overdue != NO_HEARTBEAT;
+
   resetReason = WDT_RESET_REASON_VALUE;
+  stallRecorder.captureFromWatchdog(overdue ? m_overdue : m_lastBeat, overdue, address);
+
+  // The interrupt cleared WDIE, reset without waiting out another timeout
+  wdt_enable(WDTO_15MS);
+  while (1)
+    ;
+}
+
+/**
+ * @brief Watchdog Timer Interrupt Service Routine.
+ *
+ * This ISR is called when the watchdog timer triggers an interrupt, the
+ * last step before the watchdog reset. It is naked so SP still points right
+ * below the interrupted program counter; it never returns, so no register
+ * needs saving, but compiled code expects a zero r1.
+ */
+ISR(WDT_vect, ISR_NAKED)
+{
+  asm volatile("clr __zero_reg__");
+  watchdogController.handleTimeout(reinterpret_cast<const uint8_t *>(SP));
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+import argparse
+import json
+import struct
+import sys
+
+# Frame layout, must match TelemetryController in include/TelemetryController.h
+SYNC = b'\xc3\x3c'
+VERSION = 1
+HEADER_LENGTH = 5  # sync, version, type, payload length
+TYPE_SUMMARY = 0
+TYPE_HISTOGRAM = 1
+TYPE_EVENT = 2
+
+SUMMARY_HEADER = struct.Struct('<IBHHB')  # uptime, reset reason, free RAM, least free RAM, statistic count
+SUMMARY_STATISTIC = struct.Struct('<HHHHH')  # min, average, max, self, overflows
+LINK_FIELDS = ['packetsSent', 'packetsReceived', 'retries', 'maxRetryDrops', 'nacksReceived',
+               'rejectedCrc', 'rejectedFrame', 'rejectedType', 'rejectedLength', 'resyncs', 'peakRtt']
+LINK_STATISTIC = struct.Struct('<' + 'H' * len(LINK_FIELDS))
+
+# statistics[] order in src/Globals.cpp
+STATISTIC_NAMES = ['Loop', 'System', 'Peripheral', 'Communication', 'Application']
+RESET_REASONS = ['Power-on', 'External', 'WDT', 'Soft']
+# TelemetryController::Event bits, and the keyboard state as the state command
+EVENT_NAMES = ['lock', 'unlock', 'format', 'disconnect-pending', 'connect']
+KEYBOARD_STATES = ['locked', 'unlocked']
+
+def crc16(data):
+    # CRC-16-CCITT, initial 0xFFFF, as the CRC link
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+def statistic_name(index):
+    return STATISTIC_NAMES[index] if index < len(STATISTIC_NAMES) else f'statistic {index}'
+
+def decode_summary(payload):
+    uptime, reset, free_ram, min_free_ram, count = SUMMARY_HEADER.unpack_from(payload)
+    offset = SUMMARY_HEADER.size
+    statistics = []
+    for index in range(count):
+        minimum, average, maximum, self_time, overflows = SUMMARY_STATISTIC.unpack_from(payload, offset)
+        offset += SUMMARY_STATISTIC.size
+        statistics.append({'name': statistic_name(index), 'min': minimum, 'avg': average,
+                           'max': maximum, 'self': self_time, 'over': overflows})
+    link = dict(zip(LINK_FIELDS, LINK_STATISTIC.unpack_from(payload, offset)))
+    return {
+        'type': 'summary',
+        'uptime': uptime,
+        'reset': RESET_REASONS[reset] if reset < len(RESET_REASONS) else reset,
+        'freeRam': free_ram,
+        'minFreeRam': min_free_ram,
+        'statistics': statistics,
+        'link': link,
+    }
+
+def decode_histogram(payload):
+    index, first_bits, count = struct.unpack_from('<BBB', payload)
+    buckets = list(struct.unpack_from(f'<{count}H', payload, 3))
+    # Bucket i holds intervals below 2^(first_bits + i) us
+    bounds = [(1 << (first_bits + i)) - 1 for i in range(count)]
+    return {'type': 'histogram', 'name': statistic_name(index), 'bounds': bounds, 'buckets': buckets}
+
+def decode_event(payload):
+    events, state, sequence = struct.unpack_from('<BBB', payload)
+    return {'type': 'event', 'sequence': sequence,
+            'events': [name for bit, name in enumerate(EVENT_NAMES) if events & (1 << bit)],
+            'state': KEYBOARD_STATES[state] if state < len(KEYBOARD_STATES) else state}
+
+def format_frame(frame):
+    if frame['type'] == 'summary':
+        lines = [f"[{frame['uptime']}] reset:{frame['reset']} ram free:{frame['freeRam']} min:{frame['minFreeRam']}"]
+        for s in frame['statistics']:
+            lines.append(f"  {s['name']}:{s['min']}/{s['avg']}/{s['max']} us, self:{s['self']} us, over:{s['over']}")
+        lines.append('  link ' + ' '.join(f'{k}:{v}' for k, v in frame['link'].items()))
+        return '\n'.join(lines)
+    if frame['type'] == 'event':
+        return f"  event #{frame['sequence']} {','.join(frame['events'])} keyboard:{frame['state']}"
+    pairs = ' '.join(f'<={b}:{c}' for b, c in zip(frame['bounds'], frame['buckets']))
+    return f"  {frame['name']} histogram {pairs}"
+
+class Decoder:
+    def __init__(self):
+        self.buffer = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        # Returns decoded frames and text lines; bytes outside frames are passed through as text
+        self.buffer.extend(data)
+        items = []
+        while self.buffer:
+            sync = self.buffer.find(SYNC)
+            if sync != 0:
+                chunk = self.buffer if sync < 0 else self.buffer[:sync]
+                if sync < 0 and self.buffer.endswith(SYNC[:1]):
+                    chunk = self.buffer[:-1]  # May be the start of a frame
+                items.extend(self.passthrough(chunk))
+                del self.buffer[:len(chunk)]
+                if sync < 0:
+                    break
+                continue
+
+            if len(self.buffer) < HEADER_LENGTH:
+                break
+            length = self.buffer[4]
+            end = HEADER_LENGTH + length + 2
+            if len(self.buffer) < end:
+                break
+            version, frame_type = self.buffer[2], self.buffer[3]
+            payload = bytes(self.buffer[HEADER_LENGTH:HEADER_LENGTH + length])
+            crc = struct.unpack_from('<H', self.buffer, HEADER_LENGTH + length)[0]
+            if version != VERSION or crc != crc16(self.buffer[2:HEADER_LENGTH + length]):
+                items.extend(self.passthrough(self.buffer[:1]))
+                del self.buffer[:1]
+                continue
+
+            try:
+                if frame_type == TYPE_SUMMARY:
+                    items.append(decode_summary(payload))
+                elif frame_type == TYPE_HISTOGRAM:
+                    items.append(decode_histogram(payload))
+                elif frame_type == TYPE_EVENT:
+                    items.append(decode_event(payload))
+            except struct.error:
+                pass  # Valid CRC but an unexpected layout, skip the frame
+            del self.buffer[:end]
+        return items
+
+    def passthrough(self, chunk):
+        self.text.extend(chunk)
+        lines = []
+        while b'\n' in self.text:
+            line, _, rest = self.text.partition(b'\n')
+            self.text = bytearray(rest)
+            lines.append(line.rstrip(b'\r').decode('latin-1'))
+        return lines
+
+def open_input(args):
+    if args.port:
+        import serial  # pyserial, only needed for live capture
+        port = serial.Serial(args.port, args.baud, timeout=0.1)
+        if args.request:
+            port.write(b'telemetry\r\n')
+        return lambda: port.read(256)
+    stream = open(args.input, 'rb') if args.input != '-' else sys.stdin.buffer
+    return lambda: stream.read1(256) if hasattr(stream, 'read1') else stream.read(256)
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode binary telemetry frames (TelemetryController).")
+    parser.add_argument('input', nargs='?', default='-', help='Captured stream file, - for stdin')
+    parser.add_argument('--port', type=str, help='Read live from a serial port instead (needs pyserial)')
+    parser.add_argument('--baud', type=int, default=9600, help='Serial port baud rate')
+    parser.add_argument('--request', action='store_true', help='Send the telemetry command once the port is open')
+    parser.add_argument('--json', action='store_true', help='Print one JSON object per frame, drop other text')
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    read = open_input(args)
+    while True:
+        data = read()
+        if not data:
+            if not args.port:
+                break
+            continue
+        for item in decoder.feed(data):
+            if isinstance(item, str):
+                if not args.json:
+                    print(item, flush=True)
+            elif args.json:
+                print(json.dumps(item), flush=True)
+            else:
+                print(format_frame(item), flush=True)
+
+if __name__ == "__main__":
+    main()
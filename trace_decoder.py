@@ -0,0 +1,258 @@
+import argparse
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+
+# Record layout, must match Traceable::Record in lib/Utilities/Traceable.h
+SYNC = 0xA5
+HEADER = struct.Struct('<BBBHI')  # sync, level, component, line, timestamp
+
+TAG_END = 0x00
+TAG_CHAR = 0x01
+TAG_SIGNED = 0x02
+TAG_UNSIGNED = 0x03
+TAG_FLOAT = 0x04
+TAG_FLASH = 0x05
+TAG_TEXT = 0x06
+TAG_DROPPED = 0x07
+TAG_TRUNCATED = 0x08
+
+LEVEL_NAMES = ['OFF', 'ERROR', 'WARN', 'INFO', 'DEBUG', 'TRACE']
+
+SOURCE_DIRS = ['src', 'include', 'lib']
+SOURCE_EXTENSIONS = ('.c', '.cpp', '.h', '.hpp')
+
+REGISTRY_FILE = os.path.join('include', 'TraceLevel.h')
+
+# Entries of the TRACE_COMPONENTS registry, in component ID order
+component_pattern = re.compile(r'X\((\w+),\s*"([^"]*)"')
+# Component given to Traceable/DriverBase constructors
+owner_pattern = re.compile(r'\b(?:Traceable|DriverBase)\(\s*TraceComponent::(\w+)')
+trace_pattern = re.compile(r'\bTRACE_(ERROR|WARN|INFO|DEBUG|TRACE)(_STATIC)?\(')
+
+def load_components(root):
+    # Maps component ID names to (component ID, name)
+    with open(os.path.join(root, REGISTRY_FILE), 'r') as f:
+        entries = component_pattern.findall(f.read())
+    return {key: (index, name) for index, (key, name) in enumerate(entries)}
+
+def scan_file(path, root, components):
+    with open(path, 'r', encoding='utf-8', errors='replace') as f:
+        text = f.read()
+
+    owner = owner_pattern.search(text)
+    owner_key = owner.group(1) if owner else None
+
+    sites = []
+    for match in trace_pattern.finditer(text):
+        line_start = text.rfind('\n', 0, match.start()) + 1
+        if text[line_start:match.start()].lstrip().startswith('#'):
+            continue  # Macro definitions
+
+        key = owner_key
+        if match.group(2):
+            argument = re.match(r'\s*TraceComponent::(\w+)', text[match.end():])
+            key = argument.group(1) if argument else None
+        if key not in components:
+            continue
+        component, name = components[key]
+
+        statement_end = text.find(';', match.start())
+        statement = ' '.join(text[match.start():statement_end].split())
+        sites.append({
+            'component': component,
+            'name': name,
+            'file': os.path.relpath(path, root).replace(os.sep, '/'),
+            'line': text.count('\n', 0, match.start()) + 1,
+            'level': match.group(1),
+            'statement': statement,
+        })
+    return sites
+
+def build_site_table(root):
+    components = load_components(root)
+    sites = []
+    for directory in SOURCE_DIRS:
+        for base, _, files in os.walk(os.path.join(root, directory)):
+            for name in sorted(files):
+                if name.endswith(SOURCE_EXTENSIONS):
+                    sites.extend(scan_file(os.path.join(base, name), root, components))
+    return sites
+
+def index_sites(sites):
+    names = {s['component']: s['name'] for s in sites}
+    locations = {(s['component'], s['line']): s for s in sites}
+    return names, locations
+
+def load_flash(elf_path):
+    # PROGMEM strings live in .text, so flash addresses are offsets into it
+    with tempfile.NamedTemporaryFile(suffix='.bin', delete=False) as f:
+        binary = f.name
+    try:
+        subprocess.run(['avr-objcopy', '-O', 'binary', '-j', '.text', elf_path, binary], check=True)
+        with open(binary, 'rb') as f:
+            return f.read()
+    finally:
+        os.remove(binary)
+
+def flash_string(flash, address):
+    if flash is None or address >= len(flash):
+        return f'<flash 0x{address:04x}>'
+    end = flash.find(b'\0', address)
+    return flash[address:end if end >= 0 else len(flash)].decode('latin-1')
+
+class Decoder:
+    def __init__(self, names, locations, flash, show_source):
+        self.names = names
+        self.locations = locations
+        self.flash = flash
+        self.show_source = show_source
+        self.buffer = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        # Returns decoded lines; bytes outside records are passed through as text
+        self.buffer.extend(data)
+        lines = []
+        while self.buffer:
+            if self.buffer[0] != SYNC:
+                sync = self.buffer.find(SYNC)
+                chunk = self.buffer if sync < 0 else self.buffer[:sync]
+                lines.extend(self.passthrough(chunk))
+                del self.buffer[:len(chunk)]
+                continue
+
+            result = self.parse_record()
+            if result is None:
+                break  # Wait for more bytes
+            consumed, line = result
+            if line is None:
+                lines.extend(self.passthrough(self.buffer[:1]))
+                consumed = 1
+            else:
+                lines.append(line)
+            del self.buffer[:consumed]
+        return lines
+
+    def passthrough(self, chunk):
+        self.text.extend(chunk)
+        lines = []
+        while b'\n' in self.text:
+            line, _, rest = self.text.partition(b'\n')
+            self.text = bytearray(rest)
+            lines.append(line.rstrip(b'\r').decode('latin-1'))
+        return lines
+
+    def parse_record(self):
+        # Returns (consumed, line), (consumed, None) on a false sync, or None if incomplete
+        if len(self.buffer) < HEADER.size:
+            return None
+        _, level, component, line, timestamp = HEADER.unpack_from(self.buffer)
+        if level >= len(LEVEL_NAMES):
+            return 1, None
+
+        parts = []
+        prefix = ''
+        suffix = ''
+        offset = HEADER.size
+        while True:
+            if offset >= len(self.buffer):
+                return None
+            tag = self.buffer[offset]
+            offset += 1
+            size = {TAG_CHAR: 1, TAG_SIGNED: 4, TAG_UNSIGNED: 4, TAG_FLOAT: 4,
+                    TAG_FLASH: 2, TAG_DROPPED: 2}.get(tag, 0)
+            if tag == TAG_TEXT:
+                if offset >= len(self.buffer):
+                    return None
+                size = 1 + self.buffer[offset]
+            if offset + size > len(self.buffer):
+                return None
+            payload = bytes(self.buffer[offset:offset + size])
+            offset += size
+
+            if tag == TAG_END:
+                break
+            elif tag == TAG_CHAR:
+                parts.append(payload.decode('latin-1'))
+            elif tag == TAG_SIGNED:
+                parts.append(str(struct.unpack('<i', payload)[0]))
+            elif tag == TAG_UNSIGNED:
+                parts.append(str(struct.unpack('<I', payload)[0]))
+            elif tag == TAG_FLOAT:
+                parts.append(f"{struct.unpack('<f', payload)[0]:.2f}")
+            elif tag == TAG_FLASH:
+                parts.append(flash_string(self.flash, struct.unpack('<H', payload)[0]))
+            elif tag == TAG_TEXT:
+                parts.append(payload[1:].decode('latin-1'))
+            elif tag == TAG_DROPPED:
+                prefix = f'<{struct.unpack("<H", payload)[0]} records dropped> '
+            elif tag == TAG_TRUNCATED:
+                suffix = ' <truncated>'
+            else:
+                return 1, None
+
+        name = self.names.get(component, f'component {component}')
+        header = f'[{timestamp}][{LEVEL_NAMES[level]}]({name}:{line}): '
+        decoded = prefix + header + ''.join(parts) + suffix
+        location = self.locations.get((component, line))
+        if self.show_source and location:
+            decoded += f'\n    {location["file"]}:{line}: {location["statement"]}'
+        return offset, decoded
+
+def open_input(args):
+    if args.port:
+        import serial  # pyserial, only needed for live capture
+        port = serial.Serial(args.port, args.baud, timeout=0.1)
+        return lambda: port.read(256)
+    stream = open(args.input, 'rb') if args.input != '-' else sys.stdin.buffer
+    return lambda: stream.read1(256) if hasattr(stream, 'read1') else stream.read(256)
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode binary Traceable records (TRACE_BINARY=1).")
+    parser.add_argument('input', nargs='?', default='-', help='Captured trace file, - for stdin')
+    parser.add_argument('--port', type=str, help='Read live from a serial port instead (needs pyserial)')
+    parser.add_argument('--baud', type=int, default=9600, help='Serial port baud rate')
+    parser.add_argument('--sites', type=str, default='./.pio/build/promicro16/trace_sites.json', help='Site table written at build time')
+    parser.add_argument('--elf', type=str, default='./.pio/build/promicro16/firmware.elf', help='ELF file holding the flash strings')
+    parser.add_argument('--source', action='store_true', help='Print the source statement under each record')
+    parser.add_argument('--generate', type=str, metavar='OUTPUT', help='Only write the site table for this tree and exit')
+    args = parser.parse_args()
+
+    root = os.path.dirname(os.path.abspath(__file__))
+    if args.generate:
+        with open(args.generate, 'w') as f:
+            json.dump(build_site_table(root), f, indent=1)
+        return
+
+    if os.path.exists(args.sites):
+        with open(args.sites, 'r') as f:
+            names, locations = index_sites(json.load(f))
+    else:
+        print(f"Warning: site table {args.sites} not found, scanning sources.", file=sys.stderr)
+        names, locations = index_sites(build_site_table(root))
+
+    flash = None
+    if os.path.exists(args.elf):
+        try:
+            flash = load_flash(args.elf)
+        except (OSError, subprocess.CalledProcessError) as e:
+            print(f"Warning: could not read flash strings ({e}).", file=sys.stderr)
+
+    decoder = Decoder(names, locations, flash, args.source)
+    read = open_input(args)
+    while True:
+        data = read()
+        if not data:
+            if not args.port:
+                break
+            continue
+        for line in decoder.feed(data):
+            print(line, flush=True)
+
+if __name__ == "__main__":
+    main()